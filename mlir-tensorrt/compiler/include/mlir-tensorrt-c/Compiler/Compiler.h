@@ -51,6 +51,18 @@ static inline bool mtrtCompilerClientIsNull(MTRT_CompilerClient options) {
   return !options.ptr;
 }
 
+/// Enables the persistent compilation cache of the client. Compiled
+/// executables are stored in `directory`, and the least recently used entries
+/// are evicted once the entries exceed `maxSizeInBytes` bytes.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtCompilerClientEnableCompilationCache(
+    MTRT_CompilerClient client, MTRT_StringView directory,
+    uint64_t maxSizeInBytes);
+
+/// Returns the number of hits and misses of the persistent compilation cache
+/// of the client, which must have been enabled.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtCompilerClientGetCompilationCacheStatistics(
+    MTRT_CompilerClient client, int64_t *numHits, int64_t *numMisses);
+
 //===----------------------------------------------------------------------===//
 // MTRT_StableHLOToExecutableOptions
 //===----------------------------------------------------------------------===//
@@ -28,6 +28,7 @@
 #define MLIR_TENSORRT_COMPILER_CLIENT
 
 #include "mlir-executor/Support/Status.h"
+#include "mlir-tensorrt/Compiler/CompilationCache.h"
 #include "mlir-tensorrt/Compiler/Options.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Pass/PassManager.h"
@@ -127,6 +128,17 @@ public:
   /// Return the MLIRContext associated with the client.
   mlir::MLIRContext *getContext() const { return context; }
 
+  /// Enable caching of compiled executables in `directory`, which holds at
+  /// most `maxSizeInBytes` bytes of entries. This replaces any previously
+  /// enabled cache.
+  Status enableCompilationCache(llvm::StringRef directory,
+                                uint64_t maxSizeInBytes);
+
+  /// Return the persistent compilation cache, or nullptr if it is disabled.
+  CompilationCache *getCompilationCache() const {
+    return compilationCache.get();
+  }
+
   /// Helper for setting the correct logging options on cached PassManagers.
   static void setupPassManagerLogging(mlir::PassManager &pm,
                                       const DebugOptions &options);
@@ -145,6 +157,9 @@ protected:
   /// used to create the PM.
   llvm::DenseMap<PassManagerKey, std::unique_ptr<CompilationTaskBase>>
       cachedPassManagers;
+
+  /// The persistent cache of compiled executables, if enabled.
+  std::unique_ptr<CompilationCache> compilationCache;
 };
 
 } // namespace mlirtrt::compiler
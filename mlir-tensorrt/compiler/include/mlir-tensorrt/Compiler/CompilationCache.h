@@ -0,0 +1,102 @@
+//===- CompilationCache.h ---------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declarations for a persistent, content-addressed cache of compiled
+/// executables.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_COMPILER_COMPILATIONCACHE
+#define MLIR_TENSORRT_COMPILER_COMPILATIONCACHE
+
+#include "mlir-executor/Runtime/API/API.h"
+#include "mlir-executor/Support/Status.h"
+#include "mlir/IR/BuiltinOps.h"
+#include <mutex>
+
+namespace mlirtrt::compiler {
+
+/// A `CompilationCache` stores serialized executables in a directory on disk
+/// so that compiling the same module with the same options (for example,
+/// after a service restart) does not rerun the compilation pipeline and the
+/// TensorRT engine builds.
+///
+/// Entries are addressed by a SHA-256 key that combines the module (printed
+/// in generic form without locations), the string form of the compilation
+/// options, and the versions of the compiler and of the loaded TensorRT
+/// library. Entries are written atomically (to a temporary file that is
+/// renamed), so concurrent processes may share a directory. When the total
+/// size of the entries exceeds the size limit, the least recently used
+/// entries are removed.
+class CompilationCache {
+public:
+  /// A snapshot of the counters of the cache.
+  struct Statistics {
+    int64_t numHits{0};
+    int64_t numMisses{0};
+    int64_t numInsertions{0};
+    int64_t numEvictions{0};
+  };
+
+  /// Create a cache backed by `directory`, which is created if required.
+  /// Entries are evicted once their total size exceeds `maxSizeInBytes`.
+  static StatusOr<std::unique_ptr<CompilationCache>>
+  create(llvm::StringRef directory, uint64_t maxSizeInBytes);
+
+  /// Return the key of compiling `module` with the options whose string
+  /// representation is `options`.
+  static std::string getKey(mlir::ModuleOp module, llvm::StringRef options);
+
+  /// Return the executable for `key`, or nullptr if there is no valid entry.
+  std::unique_ptr<runtime::Executable> lookup(llvm::StringRef key);
+
+  /// Store `executable` under `key` and evict entries as required.
+  Status insert(llvm::StringRef key, const runtime::Executable &executable);
+
+  /// Remove all entries.
+  Status clear();
+
+  /// Return the current values of the counters of the cache.
+  Statistics getStatistics() const;
+
+  llvm::StringRef getDirectory() const { return directory; }
+  uint64_t getMaxSizeInBytes() const { return maxSizeInBytes; }
+
+private:
+  CompilationCache(std::string directory, uint64_t maxSizeInBytes)
+      : directory(std::move(directory)), maxSizeInBytes(maxSizeInBytes) {}
+
+  /// Return the path of the entry for `key`.
+  std::string getPath(llvm::StringRef key) const;
+
+  /// Remove least recently used entries other than `keep` until the total
+  /// size of the entries is within the limit.
+  Status evict(llvm::StringRef keep);
+
+  std::string directory;
+  uint64_t maxSizeInBytes;
+
+  /// Guards `stats`.
+  mutable std::mutex statsMutex;
+  Statistics stats;
+};
+
+} // namespace mlirtrt::compiler
+
+#endif // MLIR_TENSORRT_COMPILER_COMPILATIONCACHE
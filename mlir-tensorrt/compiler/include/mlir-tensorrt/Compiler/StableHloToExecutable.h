@@ -128,6 +128,15 @@ struct StableHLOToExecutableOptions : public mlir::OptionsContext {
   /// Whether to disallow host tensors in TensorRT clusters.
   bool disallowHostTensorsInTensorRTClusters = false;
 
+  /// If positive, the maximum number of elements per tensor of the small
+  /// static tensor computations that are clustered and run on the host. Zero
+  /// disables host tensor clusters.
+  int64_t hostTensorClusterMaxNumElements = 0;
+
+  /// Whether to pack intermediate buffers into workspace allocations using the
+  /// `plan-memory-planning` pass.
+  bool enableMemoryPlanning = false;
+
   /// Entrypoint function name.
   std::string entrypoint = "main";
 
@@ -209,9 +218,10 @@ public:
   compileStableHLOToExecutable(mlir::ModuleOp module,
                                const StableHLOToExecutableOptions &options);
 
-  /// Compile a StableHLO module into a MLIR-TensorRT Runtime executable.
-  /// This is the "functional" entrypoint that will allocate a new PassManager
-  /// for a single run.
+  /// Compile a StableHLO module into a MLIR-TensorRT Runtime executable
+  /// using the cached PassManagers of `client`. If the client has a
+  /// compilation cache and the options are hashable, a cached executable is
+  /// returned when available; in that case `module` is not modified.
   static mlirtrt::StatusOr<std::unique_ptr<runtime::Executable>>
   compileStableHLOToExecutable(CompilerClient &client, mlir::ModuleOp module,
                                const StableHLOToExecutableOptions &options);
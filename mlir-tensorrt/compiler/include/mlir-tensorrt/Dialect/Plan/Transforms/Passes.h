@@ -72,7 +72,10 @@ executorOneShotModuleBufferize(ModuleOp targetOp,
 void buildPlanBufferizationPipeline(OpPassManager &pm);
 
 /// Build a post-bufferization pipeline that performs optimizations on memrefs.
-void buildPlanBufferOptimizationPipeline(OpPassManager &pm);
+/// If `enableMemoryPlanning` is set, the pipeline ends with the
+/// `plan-memory-planning` pass.
+void buildPlanBufferOptimizationPipeline(OpPassManager &pm,
+                                         bool enableMemoryPlanning = false);
 
 /// Register PassPipelines associated with the Plan dialect.
 void registerPlanDialectPipelines();
@@ -101,6 +101,25 @@ MTRT_Status mtrtCompilerClientDestroy(MTRT_CompilerClient client) {
   return mtrtStatusGetOk();
 }
 
+MTRT_Status mtrtCompilerClientEnableCompilationCache(
+    MTRT_CompilerClient client, MTRT_StringView directory,
+    uint64_t maxSizeInBytes) {
+  return wrap(unwrap(client)->enableCompilationCache(
+      llvm::StringRef(directory.data, directory.length), maxSizeInBytes));
+}
+
+MTRT_Status mtrtCompilerClientGetCompilationCacheStatistics(
+    MTRT_CompilerClient client, int64_t *numHits, int64_t *numMisses) {
+  CompilationCache *cache = unwrap(client)->getCompilationCache();
+  if (!cache)
+    return mtrtStatusCreate(MTRT_StatusCode::MTRT_StatusCode_InvalidArgument,
+                            "the compilation cache is not enabled");
+  CompilationCache::Statistics stats = cache->getStatistics();
+  *numHits = stats.numHits;
+  *numMisses = stats.numMisses;
+  return mtrtStatusGetOk();
+}
+
 //===----------------------------------------------------------------------===//
 // MTRT_StableHLOToExecutableOptions
 //===----------------------------------------------------------------------===//
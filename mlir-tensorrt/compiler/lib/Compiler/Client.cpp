@@ -54,6 +54,16 @@ CompilerClient::create(MLIRContext *context) {
 
 CompilerClient::CompilerClient(mlir::MLIRContext *context) : context(context) {}
 
+Status CompilerClient::enableCompilationCache(llvm::StringRef directory,
+                                              uint64_t maxSizeInBytes) {
+  StatusOr<std::unique_ptr<CompilationCache>> cache =
+      CompilationCache::create(directory, maxSizeInBytes);
+  if (!cache.isOk())
+    return cache.getStatus();
+  compilationCache = std::move(*cache);
+  return getOkStatus();
+}
+
 void CompilerClient::setupPassManagerLogging(mlir::PassManager &pm,
                                              const DebugOptions &options) {
   pm.enableVerifier(true);
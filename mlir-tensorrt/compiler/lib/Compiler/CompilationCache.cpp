@@ -0,0 +1,251 @@
+//===- CompilationCache.cpp -----------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the persistent compilation cache.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-tensorrt/Compiler/CompilationCache.h"
+#include "mlir-tensorrt-dialect/Utils/SHA256Stream.h"
+#include "mlir/IR/OperationSupport.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+
+#ifdef MLIR_TRT_TARGET_TENSORRT
+#include "mlir-tensorrt-dialect/Utils/TensorRTVersion.h"
+#endif
+
+using namespace mlirtrt;
+using namespace mlirtrt::compiler;
+
+#define DEBUG_TYPE "compilation-cache"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "] ")
+
+#ifndef MLIR_TENSORRT_VERSION
+#define MLIR_TENSORRT_VERSION "unknown"
+#endif
+
+/// The extension of the files that hold cache entries. Other files in the
+/// cache directory are ignored.
+static constexpr llvm::StringLiteral kEntryExtension = ".mtrtexe";
+
+namespace {
+/// A cache entry on disk.
+struct Entry {
+  std::string path;
+  uint64_t size;
+  llvm::sys::TimePoint<> lastUsed;
+};
+} // namespace
+
+/// Update the modification time of `path`, which records the last use of an
+/// entry. Failures are ignored since they only affect eviction order.
+static void touch(llvm::StringRef path) {
+  int fd;
+  if (llvm::sys::fs::openFileForRead(path, fd))
+    return;
+  (void)llvm::sys::fs::setLastAccessAndModificationTime(
+      fd, std::chrono::system_clock::now());
+  (void)llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+}
+
+/// Append the cache entries in `directory` to `entries` and return their
+/// total size.
+static StatusOr<uint64_t> listEntries(llvm::StringRef directory,
+                                      std::vector<Entry> &entries) {
+  uint64_t totalSize = 0;
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(directory, ec), end;
+       it != end && !ec; it.increment(ec)) {
+    if (llvm::sys::path::extension(it->path()) != kEntryExtension)
+      continue;
+    llvm::ErrorOr<llvm::sys::fs::basic_file_status> status = it->status();
+    // The entry may have been removed concurrently.
+    if (!status || status->type() != llvm::sys::fs::file_type::regular_file)
+      continue;
+    entries.push_back(Entry{it->path(), status->getSize(),
+                            status->getLastModificationTime()});
+    totalSize += status->getSize();
+  }
+  if (ec)
+    return getInternalErrorStatus(
+        "failed to list the compilation cache directory \"{0}\": {1}",
+        directory, ec.message());
+  return totalSize;
+}
+
+StatusOr<std::unique_ptr<CompilationCache>>
+CompilationCache::create(llvm::StringRef directory, uint64_t maxSizeInBytes) {
+  if (directory.empty())
+    return getInvalidArgStatus(
+        "the compilation cache directory must not be empty");
+  if (std::error_code ec = llvm::sys::fs::create_directories(directory))
+    return getInternalErrorStatus(
+        "failed to create the compilation cache directory \"{0}\": {1}",
+        directory, ec.message());
+  std::unique_ptr<CompilationCache> cache(
+      new CompilationCache(directory.str(), maxSizeInBytes));
+  // The directory may have been filled under a larger limit.
+  MTRT_RETURN_IF_ERROR(cache->evict(""));
+  return cache;
+}
+
+std::string CompilationCache::getKey(mlir::ModuleOp module,
+                                     llvm::StringRef options) {
+  llvm::SHA256 hasher;
+  auto addField = [&](llvm::StringRef name, llvm::StringRef value) {
+    hasher.update(name);
+    hasher.update(llvm::utostr(value.size()));
+    hasher.update(value);
+  };
+  addField("compiler", MLIR_TENSORRT_VERSION);
+#ifdef MLIR_TRT_TARGET_TENSORRT
+  addField("tensorrt",
+           mlir::tensorrt::TensorRTVersion::getLoadedVersion().getAsString());
+#endif
+  addField("options", options);
+
+  // Locations do not change the compiled program, and the generic form does
+  // not depend on custom printers.
+  hasher.update("module");
+  {
+    mlir::SHA256Stream os(hasher);
+    module->print(
+        os,
+        mlir::OpPrintingFlags().printGenericOpForm().enableDebugInfo(false));
+  }
+  std::array<uint8_t, 32> digest = hasher.final();
+  return llvm::toHex(digest, /*LowerCase=*/true);
+}
+
+std::string CompilationCache::getPath(llvm::StringRef key) const {
+  llvm::SmallString<256> path(directory);
+  llvm::sys::path::append(path, key + kEntryExtension);
+  return std::string(path);
+}
+
+std::unique_ptr<runtime::Executable>
+CompilationCache::lookup(llvm::StringRef key) {
+  std::string path = getPath(key);
+  std::unique_ptr<runtime::Executable> result;
+  if (llvm::sys::fs::exists(path)) {
+    StatusOr<std::unique_ptr<runtime::Executable>> executable =
+        runtime::Executable::loadFromFile(path);
+    if (executable.isOk()) {
+      touch(path);
+      result = std::move(*executable);
+    } else {
+      // Drop entries that cannot be loaded, e.g. because they were written
+      // by an incompatible version of the runtime.
+      LLVM_DEBUG(DBGS() << "removing invalid entry " << path << ": "
+                        << executable.getString() << "\n");
+      (void)llvm::sys::fs::remove(path);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(statsMutex);
+  if (result)
+    stats.numHits++;
+  else
+    stats.numMisses++;
+  return result;
+}
+
+Status CompilationCache::insert(llvm::StringRef key,
+                                const runtime::Executable &executable) {
+  const std::unique_ptr<runtime::ExecutableStorage> &storage =
+      executable.getStorage();
+  if (storage->size() > maxSizeInBytes) {
+    LLVM_DEBUG(DBGS() << "not caching an executable of " << storage->size()
+                      << " bytes\n");
+    return getOkStatus();
+  }
+
+  // `writeToOutput` writes to a temporary file that is renamed to `path`, so
+  // readers never observe partially written entries.
+  std::string path = getPath(key);
+  if (llvm::Error err =
+          llvm::writeToOutput(path, [&](llvm::raw_ostream &os) {
+            os.write(static_cast<const char *>(storage->data()),
+                     storage->size());
+            return llvm::Error::success();
+          }))
+    return getInternalErrorStatus(
+        "failed to write the compilation cache entry \"{0}\": {1}", path,
+        llvm::toString(std::move(err)));
+  {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.numInsertions++;
+  }
+  return evict(key);
+}
+
+Status CompilationCache::evict(llvm::StringRef keep) {
+  // Other processes may share the directory, so the entries are listed
+  // afresh instead of being tracked in memory.
+  std::vector<Entry> entries;
+  MTRT_ASSIGN_OR_RETURN(uint64_t totalSize, listEntries(directory, entries));
+  if (totalSize <= maxSizeInBytes)
+    return getOkStatus();
+
+  llvm::sort(entries, [](const Entry &lhs, const Entry &rhs) {
+    return lhs.lastUsed < rhs.lastUsed;
+  });
+  std::string keepPath = keep.empty() ? std::string() : getPath(keep);
+  int64_t numEvicted = 0;
+  for (const Entry &entry : entries) {
+    if (totalSize <= maxSizeInBytes)
+      break;
+    if (entry.path == keepPath)
+      continue;
+    LLVM_DEBUG(DBGS() << "evicting " << entry.path << "\n");
+    if (std::error_code ec = llvm::sys::fs::remove(entry.path))
+      return getInternalErrorStatus(
+          "failed to remove the compilation cache entry \"{0}\": {1}",
+          entry.path, ec.message());
+    totalSize -= entry.size;
+    numEvicted++;
+  }
+
+  std::lock_guard<std::mutex> lock(statsMutex);
+  stats.numEvictions += numEvicted;
+  return getOkStatus();
+}
+
+Status CompilationCache::clear() {
+  std::vector<Entry> entries;
+  MTRT_RETURN_IF_ERROR(listEntries(directory, entries).getStatus());
+  for (const Entry &entry : entries) {
+    if (std::error_code ec = llvm::sys::fs::remove(entry.path))
+      return getInternalErrorStatus(
+          "failed to remove the compilation cache entry \"{0}\": {1}",
+          entry.path, ec.message());
+  }
+  return getOkStatus();
+}
+
+CompilationCache::Statistics CompilationCache::getStatistics() const {
+  std::lock_guard<std::mutex> lock(statsMutex);
+  return stats;
+}
@@ -222,6 +222,16 @@ StableHLOToExecutableOptions::StableHLOToExecutableOptions(
       disallowHostTensorsInTensorRTClusters, llvm::cl::init(false),
       llvm::cl::desc("Don't allow TensorRt clusters to contain host tensor "
                      "calculations (but they can still be inputs)"));
+  addOption(
+      "plan-clustering-host-tensor-cluster-max-num-elements",
+      hostTensorClusterMaxNumElements, llvm::cl::init(0),
+      llvm::cl::desc("If positive, small static tensor computations with at "
+                     "most this many elements per tensor are compiled to host "
+                     "loops instead of TensorRT engines"));
+  addOption("plan-enable-memory-planning", enableMemoryPlanning,
+            llvm::cl::init(false),
+            llvm::cl::desc("Pack intermediate buffers into workspace "
+                           "allocations with non-overlapping lifetimes"));
   addOption("executor-index-bitwidth", executorIndexBitwidth,
             llvm::cl::init(64));
   addOption("device-compute-capability", deviceComputeCapability,
@@ -303,6 +313,8 @@ void StableHloToExecutableTask::buildStablehloClusteringPipeline(
   plan::StablehloClusteringPassOptions clusteringOpts{};
   clusteringOpts.disallowHostTensorsInTensorRTClusters =
       opts.disallowHostTensorsInTensorRTClusters;
+  clusteringOpts.hostTensorClusterMaxNumElements =
+      opts.hostTensorClusterMaxNumElements;
   clusteringOpts.entrypoint = opts.entrypoint;
   plan::buildPlanSegmentationPipeline(pm, clusteringOpts);
 
@@ -311,6 +323,10 @@ void StableHloToExecutableTask::buildStablehloClusteringPipeline(
   pm.addNestedPass<func::FuncOp>(
       std::make_unique<HloToArithDynamicPipelinePass>());
 
+  // Compile outlined funcs marked with `cluster.host_tensor` to Linalg on host
+  // tensors.
+  pm.addNestedPass<func::FuncOp>(plan::createPlanLowerHostTensorClustersPass());
+
   pm.addNestedPass<func::FuncOp>(std::make_unique<HloToStdPass>());
 
   populateExtensionPasses(pm, opts, Phase::PostClustering);
@@ -340,8 +356,9 @@ void StableHloToExecutableTask::buildPostClusteringPipeline(
   pm.addPass(plan::createPlanBufferizePass());
   pm.addPass(createMemRefCastEliminationPass());
   pm.addPass(createCanonicalizerPass());
+  pm.addNestedPass<func::FuncOp>(plan::createPlanLowerHostLinalgToLoopsPass());
   pm.addPass(bufferization::createDropEquivalentBufferResultsPass());
-  plan::buildPlanBufferOptimizationPipeline(pm);
+  plan::buildPlanBufferOptimizationPipeline(pm, opts.enableMemoryPlanning);
 
   populateExtensionPasses(pm, opts, Phase::PostBufferization);
 
@@ -457,6 +474,22 @@ StableHloToExecutableTask::compileStableHLOToExecutable(
     return getInternalErrorStatus("CompilerClient has a MLIRContext that is "
                                   "different from the ModuleOp's MLIRContext");
 
+  // Consult the persistent compilation cache. The key is computed before the
+  // pipeline lowers `module` in place. Options that cannot be hashed (e.g.
+  // because of a layer metadata callback) bypass the cache.
+  CompilationCache *cache = client.getCompilationCache();
+  std::string cacheKey;
+  if (cache && options.getHash()) {
+    std::string optionsString;
+    llvm::raw_string_ostream os(optionsString);
+    options.print(os);
+    cacheKey = CompilationCache::getKey(module, os.str());
+    if (std::unique_ptr<runtime::Executable> exe = cache->lookup(cacheKey)) {
+      LLVM_DEBUG(DBGS() << " loaded executable from the compilation cache\n");
+      return exe;
+    }
+  }
+
   LLVM_DEBUG({
     DBGS() << "compiling with options:\n";
     options.print(llvm::dbgs());
@@ -505,7 +538,15 @@ StableHloToExecutableTask::compileStableHLOToExecutable(
     llvm::DebugFlag = false;
 #endif
 
-  return std::make_unique<runtime::Executable>(std::move(*exeStorage));
+  auto exe = std::make_unique<runtime::Executable>(std::move(*exeStorage));
+  if (!cacheKey.empty()) {
+    // Failing to populate the cache does not fail the compilation.
+    Status status = cache->insert(cacheKey, *exe);
+    if (!status.isOk())
+      LLVM_DEBUG(DBGS() << " failed to cache the executable: "
+                        << status.getString() << "\n");
+  }
+  return exe;
 }
 
 //===----------------------------------------------------------------------===//
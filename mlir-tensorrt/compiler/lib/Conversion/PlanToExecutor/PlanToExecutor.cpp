@@ -169,6 +169,12 @@ static void convertArgAndResultAttrs(OpBuilder &b, func::FuncOp op) {
       op.removeArgAttr(idx, plan::PlanDialect::kResultArgAttrName);
       op.setArgAttr(idx, executor::ExecutorDialect::kResultArgAttrName, attr);
     }
+    if (auto attr =
+            op.getArgAttr(idx, plan::PlanDialect::kAliasingOutputArgAttrName)) {
+      op.removeArgAttr(idx, plan::PlanDialect::kAliasingOutputArgAttrName);
+      op.setArgAttr(idx, executor::ExecutorDialect::kAliasingOutputAttrName,
+                    attr);
+    }
   }
   for (unsigned idx = 0; idx < op.getNumResults(); idx++) {
     if (auto attr = op.getResultAttr(idx, kShapeBoundsAttrName))
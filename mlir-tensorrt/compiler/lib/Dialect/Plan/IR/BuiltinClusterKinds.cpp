@@ -18,10 +18,11 @@
 //
 //===----------------------------------------------------------------------===//
 ///
-/// Definitions for TensorRT and Host Cluster Kinds
+/// Definitions for TensorRT, Host and Host Tensor Cluster Kinds
 ///
 //===----------------------------------------------------------------------===//
 #include "mlir-executor/Transforms/Clustering/Clustering.h"
+#include "mlir-executor/Transforms/Clustering/Patterns.h"
 #include "mlir-tensorrt-dialect/TensorRT/IR/TensorRTDialect.h"
 #include "mlir-tensorrt/Conversion/StablehloScalarToArith/StablehloScalarToArith.h"
 #include "mlir-tensorrt/Conversion/StablehloToTensorRT/StablehloToTensorRT.h"
@@ -109,6 +110,117 @@ HostClusterKindAttr::getClusterFilter() const {
   return [](const Cluster &cluster) { return true; };
 }
 
+//===----------------------------------------------------------------------===//
+// HostTensorClusterKindAttr
+//===----------------------------------------------------------------------===//
+
+std::string HostTensorClusterKindAttr::getClusterKindName() const {
+  return "host_tensor";
+}
+
+int64_t HostTensorClusterKindAttr::getClusterBenefit() const {
+  return getBenefit();
+}
+
+/// Returns true if `t` is a statically shaped tensor of integers or floats
+/// with at most `maxNumElements` elements.
+static bool isSmallHostTensorType(Type t, int64_t maxNumElements) {
+  auto rtt = dyn_cast<RankedTensorType>(t);
+  return rtt && rtt.hasStaticShape() &&
+         rtt.getNumElements() <= maxNumElements &&
+         rtt.getElementType().isIntOrIndexOrFloat();
+}
+
+/// Returns true if all of the `values` are known to be required on the host.
+static bool areHostVisible(ValueRange values, DataFlowSolver &solver) {
+  return llvm::all_of(values, [&](Value v) {
+    const auto *lattice = solver.lookupState<TensorKindLattice>(v);
+    return lattice && !lattice->getValue().isUninitialized() &&
+           lattice->getValue().isHostVisible();
+  });
+}
+
+/// Returns true if `op` should be placed in a host tensor cluster. This is a
+/// size-based cost model: running a small tensor computation on the host
+/// costs a handful of loop iterations, while running it in TensorRT costs an
+/// engine launch plus a transfer of the host tensors. The computation is
+/// placed on the host only if all tensors are small and either all operands
+/// are already on the host or all results are required on the host, so that
+/// placing it on the host does not add any transfers.
+static bool shouldRunOnHostAsTensorOp(Operation *op, DataFlowSolver &solver,
+                                      int64_t maxNumElements) {
+  if (!isa<stablehlo::StablehloDialect>(op->getDialect()) ||
+      isa<stablehlo::StablehloDialect>(op->getParentOp()->getDialect()))
+    return false;
+
+  // Constants are cloned during outlining, and scalarizable operations are
+  // handled by the `#plan.host_cluster` kind.
+  if (op->hasTrait<OpTrait::ConstantLike>() ||
+      plan::detail::shouldRunOnHost(op, solver))
+    return false;
+
+  auto isSmall = [&](Type t) {
+    return isSmallHostTensorType(t, maxNumElements);
+  };
+  if (op->getNumResults() == 0 ||
+      !llvm::all_of(op->getResultTypes(), isSmall) ||
+      !llvm::all_of(op->getOperandTypes(), isSmall))
+    return false;
+
+  // Filter for the operations that the StableHLO-to-Linalg lowering supports
+  // without introducing dynamic shapes.
+  if (!op->hasTrait<OpTrait::Elementwise>() &&
+      !isa<stablehlo::BroadcastInDimOp, stablehlo::BitcastConvertOp,
+           stablehlo::ConcatenateOp, stablehlo::ConvertOp,
+           stablehlo::DynamicSliceOp, stablehlo::GatherOp, stablehlo::IotaOp,
+           stablehlo::PadOp, stablehlo::ReduceOp, stablehlo::ReshapeOp,
+           stablehlo::ReverseOp, stablehlo::SelectOp, stablehlo::SliceOp,
+           stablehlo::TransposeOp>(op))
+    return false;
+
+  if (op->getNumOperands() > 0 && areHostVisible(op->getOperands(), solver))
+    return true;
+  return areHostVisible(op->getResults(), solver);
+}
+
+ClusteringOpts HostTensorClusterKindAttr::getClusterKindOptions(
+    DataFlowSolver &solver, std::optional<int64_t> trtMajorVersion) const {
+  // Any properties used in the returned lambdas must be copied by value.
+  int64_t maxNumElements = getMaxNumElements();
+
+  ClusteringOpts opts;
+  opts.mergeIndependentClusters = [](Operation *, ClusterRange, Operation *,
+                                     ClusterRange) { return true; };
+  opts.clusterTarget = *this;
+  opts.isClusterableOp = [solver = &solver, maxNumElements](Operation *op) {
+    return shouldRunOnHostAsTensorOp(op, *solver, maxNumElements);
+  };
+  return opts;
+}
+
+std::unique_ptr<Pass> HostTensorClusterKindAttr::getClusterKindPass() const {
+  return nullptr;
+}
+
+std::optional<OutlineRegionOptions>
+HostTensorClusterKindAttr::getClusterOutliningOptions(
+    MLIRContext *ctx, SymbolTable &moduleSymbolTable) const {
+  OpBuilder b(ctx);
+  return OutlineRegionOptions{
+      /*typeConverter=*/getIdentityTypeConverter(),
+      /*shouldCloneProducer=*/shouldCloneProducer,
+      /*createFunc=*/
+      OutlineRegionOptions::getDefaultCreateFuncAndCallStubFunc(
+          moduleSymbolTable,
+          {b.getNamedAttr("cluster.host_tensor", b.getUnitAttr())},
+          "host_tensor_cluster")};
+}
+
+std::function<bool(const Cluster &)>
+HostTensorClusterKindAttr::getClusterFilter() const {
+  return [](const Cluster &cluster) { return true; };
+}
+
 //===----------------------------------------------------------------------===//
 // TensorRTClusterKindAttr
 //===----------------------------------------------------------------------===//
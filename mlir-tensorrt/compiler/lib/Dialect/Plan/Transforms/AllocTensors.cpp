@@ -532,6 +532,39 @@ updateFunctionWithNewDpsArg(func::FuncOp func, Location loc, Type argType,
   return func.getArguments().back();
 }
 
+/// Collect the arguments of `func` that are donated to a result using the
+/// `plan.aliasing_output` argument attribute, keyed by the result index.
+static FailureOr<DenseMap<unsigned, BlockArgument>>
+getDonatedArguments(func::FuncOp func) {
+  DenseMap<unsigned, BlockArgument> donatedArgs;
+  for (BlockArgument arg : func.getArguments()) {
+    Attribute attr = func.getArgAttr(arg.getArgNumber(),
+                                     PlanDialect::kAliasingOutputAttrName);
+    if (!attr)
+      continue;
+    auto indexAttr = dyn_cast<IntegerAttr>(attr);
+    if (!indexAttr || indexAttr.getInt() < 0 ||
+        indexAttr.getInt() >= func.getNumResults())
+      return func.emitError()
+             << "argument #" << arg.getArgNumber() << " has an invalid '"
+             << PlanDialect::kAliasingOutputAttrName
+             << "' attribute; expected the index of a function result";
+    unsigned resultIdx = indexAttr.getInt();
+    Type resultType = func.getResultTypes()[resultIdx];
+    if (!isa<RankedTensorType>(resultType) || arg.getType() != resultType)
+      return func.emitError()
+             << "argument #" << arg.getArgNumber() << " of type "
+             << arg.getType() << " is donated to result #" << resultIdx
+             << " of type " << resultType
+             << ", but donated arguments must be ranked tensors with the "
+                "same type as the result";
+    if (!donatedArgs.try_emplace(resultIdx, arg).second)
+      return func.emitError() << "result #" << resultIdx
+                              << " has more than one donated argument";
+  }
+  return donatedArgs;
+}
+
 /// Type for function that takes a type and an operand of a block terminator and
 /// retrieves or creates a corresponding destination block arg to achieve
 /// destination passing style.
@@ -587,6 +620,16 @@ travelUseDefChainAndUpdateUses(RewriterBase &rewriter, OpOperand &v,
     if (!isa<tensor::EmptyOp, bufferization::AllocTensorOp>(emptyOp))
       return failure();
 
+    // Allocations that were explicitly placed on the host (e.g. by
+    // `plan-lower-host-tensor-clusters`) must not be replaced by the device
+    // DPS argument. The caller copies the result into the argument instead.
+    if (auto allocOp = dyn_cast<bufferization::AllocTensorOp>(emptyOp)) {
+      auto space = dyn_cast_or_null<plan::MemorySpaceAttr>(
+          allocOp.getMemorySpaceAttr());
+      if (space && space.getValue() != plan::MemorySpace::device)
+        return failure();
+    }
+
     // Add DPS arg to the function for replacing `tensor.empty()` at this
     // use.
     FailureOr<BlockArgument> destArg =
@@ -711,14 +754,40 @@ static LogicalResult rewriteNotPrivateFuncsToDPS(RewriterBase &rewriter,
         }))
       continue;
 
+    FailureOr<DenseMap<unsigned, BlockArgument>> donatedArgs =
+        getDonatedArguments(nonPrivateFunction);
+    if (failed(donatedArgs))
+      return failure();
+
+    unsigned numOutputArgs = 0;
     if (failed(correctDestinationPassingStyleBlock(
             rewriter, &nonPrivateFunction.getBody().front(),
             /*getDpsArgument=*/
             [&](Type argType,
                 OpOperand &returnOperand) -> FailureOr<BlockArgument> {
-              return updateFunctionWithNewDpsArg(
+              FailureOr<BlockArgument> destArg = updateFunctionWithNewDpsArg(
                   nonPrivateFunction, returnOperand.get().getLoc(), argType,
                   returnOperand.getOperandNumber());
+              if (failed(destArg))
+                return failure();
+              unsigned outputIdx = numOutputArgs++;
+              BlockArgument donatedArg =
+                  donatedArgs->lookup(returnOperand.getOperandNumber());
+              if (!donatedArg)
+                return destArg;
+              // The output argument is kept so that there is one output
+              // argument per result, but the result is written in-place into
+              // the donated argument. Replace the result index by the output
+              // argument index so that the caller knows to pass the donated
+              // buffer for it.
+              nonPrivateFunction.removeArgAttr(
+                  donatedArg.getArgNumber(),
+                  PlanDialect::kAliasingOutputAttrName);
+              nonPrivateFunction.setArgAttr(
+                  donatedArg.getArgNumber(),
+                  PlanDialect::kAliasingOutputArgAttrName,
+                  rewriter.getI64IntegerAttr(outputIdx));
+              return donatedArg;
             })))
       return failure();
   }
@@ -0,0 +1,92 @@
+//===- LowerHostLinalgToLoops.cpp -----------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the `plan-lower-host-linalg-to-loops` pass.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-tensorrt/Dialect/Plan/IR/Plan.h"
+#include "mlir-tensorrt/Dialect/Plan/Transforms/Passes.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/PatternMatch.h"
+
+namespace mlir::plan {
+#define GEN_PASS_DEF_PLANLOWERHOSTLINALGTOLOOPSPASS
+#include "mlir-tensorrt/Dialect/Plan/Transforms/Passes.h.inc"
+} // namespace mlir::plan
+
+using namespace mlir;
+using namespace mlir::plan;
+
+/// Returns true if `type` is a memref in the `host` or `host_pinned` memory
+/// space.
+static bool isHostVisibleMemRef(Type type) {
+  auto memrefType = dyn_cast<MemRefType>(type);
+  if (!memrefType)
+    return false;
+  auto space =
+      dyn_cast_or_null<plan::MemorySpaceAttr>(memrefType.getMemorySpace());
+  return space && (space.getValue() == MemorySpace::host ||
+                   space.getValue() == MemorySpace::host_pinned);
+}
+
+/// Returns true if `op` operates on buffers that are all accessible from the
+/// host.
+static bool isHostLinalgOp(linalg::LinalgOp op) {
+  // Fills are lowered to memsets by the Executor conversion.
+  if (!op.hasPureBufferSemantics() || isa<linalg::FillOp>(op))
+    return false;
+  return llvm::all_of(op->getOperandTypes(), [](Type t) {
+    return !isa<ShapedType>(t) || isHostVisibleMemRef(t);
+  });
+}
+
+namespace {
+class PlanLowerHostLinalgToLoopsPass
+    : public plan::impl::PlanLowerHostLinalgToLoopsPassBase<
+          PlanLowerHostLinalgToLoopsPass> {
+public:
+  using Base::Base;
+
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+
+    SmallVector<linalg::LinalgOp> hostOps;
+    func.walk([&](linalg::LinalgOp op) {
+      if (isHostLinalgOp(op))
+        hostOps.push_back(op);
+    });
+
+    IRRewriter rewriter(&getContext());
+    for (linalg::LinalgOp op : hostOps) {
+      rewriter.setInsertionPoint(op);
+      if (failed(linalg::linalgOpToLoops(rewriter, op))) {
+        op->emitError() << "failed to lower host linalg operation to loops";
+        return signalPassFailure();
+      }
+      rewriter.eraseOp(op);
+    }
+  }
+};
+} // namespace
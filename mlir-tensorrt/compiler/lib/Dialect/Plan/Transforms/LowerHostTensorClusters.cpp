@@ -0,0 +1,101 @@
+//===- LowerHostTensorClusters.cpp ----------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the `plan-lower-host-tensor-clusters` pass.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-tensorrt/Dialect/Plan/IR/Plan.h"
+#include "mlir-tensorrt/Dialect/Plan/Transforms/Passes.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Bufferization/IR/Bufferization.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Transforms/Passes.h"
+#include "stablehlo/conversions/linalg/transforms/Passes.h"
+
+namespace mlir::plan {
+#define GEN_PASS_DEF_PLANLOWERHOSTTENSORCLUSTERSPASS
+#include "mlir-tensorrt/Dialect/Plan/Transforms/Passes.h.inc"
+} // namespace mlir::plan
+
+using namespace mlir;
+using namespace mlir::plan;
+
+/// Place the tensor computation in `func` on the host. Tensor arguments are
+/// copied into host-visible tensors and `tensor.empty` operations are replaced
+/// with host allocations so that all Linalg operations in the function
+/// bufferize to operations on host-visible buffers.
+static void placeOnHost(RewriterBase &rewriter, func::FuncOp func) {
+  auto hostSpace =
+      plan::MemorySpaceAttr::get(func.getContext(), MemorySpace::host_pinned);
+
+  rewriter.setInsertionPointToStart(&func.getBody().front());
+  for (BlockArgument arg : func.getArguments()) {
+    if (!isa<RankedTensorType>(arg.getType()) || arg.use_empty())
+      continue;
+    auto copyOp = rewriter.create<bufferization::AllocTensorOp>(
+        arg.getLoc(), arg.getType(), ValueRange{}, /*copy=*/arg,
+        /*size_hint=*/Value{}, hostSpace);
+    rewriter.replaceAllUsesExcept(arg, copyOp.getResult(), copyOp);
+  }
+
+  func.walk([&](tensor::EmptyOp op) {
+    rewriter.setInsertionPoint(op);
+    rewriter.replaceOpWithNewOp<bufferization::AllocTensorOp>(
+        op, op.getType(), op.getDynamicSizes(), /*copy=*/Value{},
+        /*size_hint=*/Value{}, hostSpace);
+  });
+}
+
+namespace {
+class PlanLowerHostTensorClustersPass
+    : public plan::impl::PlanLowerHostTensorClustersPassBase<
+          PlanLowerHostTensorClustersPass> {
+public:
+  using Base::Base;
+
+  LogicalResult initialize(MLIRContext *context) override {
+    dynamicPM = OpPassManager("func.func");
+    dynamicPM.addPass(stablehlo::createStablehloLegalizeToLinalgPass());
+    dynamicPM.addPass(createCanonicalizerPass());
+    return success();
+  }
+
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    if (!func.isPrivate() || !func->hasAttr("cluster.host_tensor"))
+      return;
+
+    if (failed(runPipeline(dynamicPM, func)))
+      return signalPassFailure();
+
+    IRRewriter rewriter(&getContext());
+    placeOnHost(rewriter, func);
+  }
+
+private:
+  OpPassManager dynamicPM;
+};
+} // namespace
@@ -0,0 +1,320 @@
+//===- MemoryPlanning.cpp -------------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the `plan-memory-planning` pass.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-tensorrt/Dialect/Plan/Analysis/BoundsAnalysis.h"
+#include "mlir-tensorrt/Dialect/Plan/IR/Plan.h"
+#include "mlir-tensorrt/Dialect/Plan/Transforms/Passes.h"
+#include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/DataFlowFramework.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Interfaces/DataLayoutInterfaces.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/Support/CheckedArithmetic.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include <functional>
+#include <limits>
+
+namespace mlir::plan {
+#define GEN_PASS_DEF_PLANMEMORYPLANNINGPASS
+#include "mlir-tensorrt/Dialect/Plan/Transforms/Passes.h.inc"
+} // namespace mlir::plan
+
+#define DEBUG_TYPE "plan-memory-planning"
+#define DBGS() llvm::dbgs() << "[" DEBUG_TYPE "] "
+
+using namespace mlir;
+using namespace mlir::plan;
+
+namespace {
+/// An allocation that is assigned a region of the workspace.
+struct PlannedBuffer {
+  memref::AllocOp allocOp;
+  memref::DeallocOp deallocOp;
+  /// Inclusive lifetime interval in the linear numbering of the function.
+  int64_t start;
+  int64_t end;
+  /// The number of bytes reserved for the buffer, which is a multiple of the
+  /// alignment.
+  int64_t size;
+  /// The byte offset assigned to the buffer within the workspace.
+  int64_t offset = 0;
+
+  bool overlapsInTime(const PlannedBuffer &other) const {
+    return start <= other.end && other.start <= end;
+  }
+};
+} // namespace
+
+/// Return true if all regions nested under `func` have at most one block.
+static bool hasOnlySingleBlockRegions(func::FuncOp func) {
+  WalkResult result = func->walk([](Operation *op) {
+    for (Region &region : op->getRegions()) {
+      if (!region.empty() && !region.hasOneBlock())
+        return WalkResult::interrupt();
+    }
+    return WalkResult::advance();
+  });
+  return !result.wasInterrupted();
+}
+
+/// Return true if the regions of all ancestors of `op` below `func` execute
+/// sequentially, so that two allocations with disjoint lifetimes are never
+/// live at the same time.
+static bool isInSequentialRegion(Operation *op, func::FuncOp func) {
+  for (Operation *parent = op->getParentOp(); parent != func;
+       parent = parent->getParentOp()) {
+    if (!isa<scf::ForOp, scf::WhileOp, scf::IfOp, scf::IndexSwitchOp,
+             scf::ExecuteRegionOp>(parent))
+      return false;
+  }
+  return true;
+}
+
+/// Return true if allocations in `memorySpace` can share memory once their
+/// lifetimes end. A `memref.dealloc` in the `host` space frees the memory
+/// synchronously, and one in the `device` space is ordered on the same stream
+/// as the work using the buffer, so reusing the memory for a later buffer is
+/// ordered after all uses of the earlier one. Frees in other spaces (e.g.
+/// `host_pinned`, which is released once pending asynchronous copies complete)
+/// give no such guarantee.
+static bool isPlannableMemorySpace(Attribute memorySpace) {
+  auto space = dyn_cast_or_null<plan::MemorySpaceAttr>(memorySpace);
+  return space && (space.getValue() == plan::MemorySpace::host ||
+                   space.getValue() == plan::MemorySpace::device);
+}
+
+/// Return the unique `memref.dealloc` of `allocOp` if it exists and is in the
+/// same block as the allocation.
+static memref::DeallocOp getUniqueDealloc(memref::AllocOp allocOp) {
+  memref::DeallocOp result;
+  for (Operation *user : allocOp->getUsers()) {
+    auto deallocOp = dyn_cast<memref::DeallocOp>(user);
+    if (!deallocOp)
+      continue;
+    if (result || deallocOp->getBlock() != allocOp->getBlock())
+      return nullptr;
+    result = deallocOp;
+  }
+  return result;
+}
+
+/// Return the upper bound of the dynamic size `v`. The shape integer range
+/// analysis reports `[0, INT32_MAX]` for dimensions without bounds
+/// information, so such ranges are treated as unbounded.
+static std::optional<int64_t> getSizeUpperBound(Value v,
+                                                DataFlowSolver &solver) {
+  APInt constant;
+  if (matchPattern(v, m_ConstantInt(&constant)))
+    return constant.getSExtValue();
+  const auto *lattice =
+      solver.lookupState<dataflow::IntegerValueRangeLattice>(v);
+  if (!lattice || lattice->getValue().isUninitialized())
+    return std::nullopt;
+  int64_t upperBound = lattice->getValue().getValue().smax().getSExtValue();
+  if (upperBound < 0 || upperBound >= std::numeric_limits<int32_t>::max())
+    return std::nullopt;
+  return upperBound;
+}
+
+/// Return the number of bytes required to hold the largest value of the
+/// type of `allocOp`, or failure if the size cannot be bounded.
+static FailureOr<int64_t>
+getAllocationSizeUpperBound(memref::AllocOp allocOp, DataFlowSolver &solver,
+                            const DataLayout &layout) {
+  MemRefType type = allocOp.getType();
+  llvm::TypeSize elementSize = layout.getTypeSize(type.getElementType());
+  if (elementSize.isScalable() || elementSize.getFixedValue() == 0)
+    return failure();
+
+  std::optional<int64_t> numBytes =
+      static_cast<int64_t>(elementSize.getFixedValue());
+  unsigned dynamicIndex = 0;
+  for (int64_t dim : type.getShape()) {
+    std::optional<int64_t> bound =
+        ShapedType::isDynamic(dim)
+            ? getSizeUpperBound(allocOp.getDynamicSizes()[dynamicIndex++],
+                                solver)
+            : dim;
+    if (!bound)
+      return failure();
+    numBytes = llvm::checkedMul(*numBytes, *bound);
+    if (!numBytes)
+      return failure();
+  }
+  return *numBytes;
+}
+
+/// Assign offsets to `buffers` so that buffers with overlapping lifetimes do
+/// not overlap in memory. Buffers are placed in order of decreasing size. Each
+/// buffer is placed in the smallest gap between the already placed buffers
+/// that are live at the same time, or after all of them if no gap is large
+/// enough. Returns the size of the workspace.
+static int64_t assignOffsets(MutableArrayRef<PlannedBuffer> buffers) {
+  SmallVector<PlannedBuffer *> order = llvm::map_to_vector(
+      buffers, [](PlannedBuffer &buffer) { return &buffer; });
+  llvm::stable_sort(order, [](PlannedBuffer *lhs, PlannedBuffer *rhs) {
+    return lhs->size > rhs->size;
+  });
+
+  int64_t workspaceSize = 0;
+  SmallVector<PlannedBuffer *> placed;
+  for (PlannedBuffer *buffer : order) {
+    SmallVector<PlannedBuffer *> live;
+    for (PlannedBuffer *other : placed) {
+      if (buffer->overlapsInTime(*other))
+        live.push_back(other);
+    }
+    llvm::sort(live, [](PlannedBuffer *lhs, PlannedBuffer *rhs) {
+      return lhs->offset < rhs->offset;
+    });
+
+    std::optional<int64_t> bestOffset;
+    int64_t bestGap = std::numeric_limits<int64_t>::max();
+    int64_t cursor = 0;
+    for (PlannedBuffer *other : live) {
+      int64_t gap = other->offset - cursor;
+      if (gap >= buffer->size && gap < bestGap) {
+        bestOffset = cursor;
+        bestGap = gap;
+      }
+      cursor = std::max(cursor, other->offset + other->size);
+    }
+    buffer->offset = bestOffset.value_or(cursor);
+    workspaceSize = std::max(workspaceSize, buffer->offset + buffer->size);
+    placed.push_back(buffer);
+  }
+  return workspaceSize;
+}
+
+namespace {
+class PlanMemoryPlanningPass
+    : public plan::impl::PlanMemoryPlanningPassBase<PlanMemoryPlanningPass> {
+public:
+  using Base::Base;
+
+  void runOnOperation() override {
+    func::FuncOp func = getOperation();
+    if (func.isExternal() || func.isDeclaration())
+      return;
+
+    if (alignment <= 0 || !llvm::isPowerOf2_64(alignment)) {
+      emitError(func.getLoc())
+          << "the " << getArgument()
+          << " pass requires the alignment to be a power of two";
+      return signalPassFailure();
+    }
+
+    // The lifetime intervals are computed over a linear numbering of the
+    // operations, which is only meaningful without unstructured control flow.
+    if (!hasOnlySingleBlockRegions(func))
+      return;
+
+    DataFlowConfig config;
+    config.setInterprocedural(false);
+    DataFlowSolver solver(config);
+    solver.load<dataflow::DeadCodeAnalysis>();
+    solver.load<ShapeIntegerRangeAnalysis>();
+    if (failed(solver.initializeAndRun(func))) {
+      func.emitError() << "failed to run shape integer range analysis";
+      return signalPassFailure();
+    }
+
+    // Number the operations in pre-order. The interval
+    // `[index(op), endIndex(op)]` covers `op` and all operations nested in it.
+    DenseMap<Operation *, int64_t> index, endIndex;
+    int64_t counter = 0;
+    std::function<void(Operation *)> number = [&](Operation *op) {
+      index[op] = counter++;
+      for (Region &region : op->getRegions()) {
+        for (Operation &nested : region.getOps())
+          number(&nested);
+      }
+      endIndex[op] = counter - 1;
+    };
+    number(func);
+
+    DataLayout layout = DataLayout::closest(func);
+    llvm::MapVector<Attribute, SmallVector<PlannedBuffer>> buffersBySpace;
+    func.walk([&](memref::AllocOp allocOp) {
+      MemRefType type = allocOp.getType();
+      int64_t requiredAlignment = allocOp.getAlignment().value_or(1);
+      if (!isPlannableMemorySpace(type.getMemorySpace()) ||
+          !type.getLayout().isIdentity() || requiredAlignment > alignment ||
+          !isInSequentialRegion(allocOp, func))
+        return;
+      memref::DeallocOp deallocOp = getUniqueDealloc(allocOp);
+      if (!deallocOp)
+        return;
+      FailureOr<int64_t> size =
+          getAllocationSizeUpperBound(allocOp, solver, layout);
+      if (failed(size))
+        return;
+      LLVM_DEBUG(DBGS() << "planning " << *size << " bytes for "
+                        << allocOp << "\n");
+      buffersBySpace[type.getMemorySpace()].push_back(PlannedBuffer{
+          allocOp, deallocOp, index[allocOp], endIndex[deallocOp],
+          static_cast<int64_t>(llvm::alignTo(*size, alignment))});
+    });
+
+    IRRewriter rewriter(&getContext());
+    Block &entryBlock = func.getBody().front();
+    for (auto &[memorySpace, buffers] : buffersBySpace) {
+      // Nothing is gained by placing a single allocation in a workspace.
+      if (buffers.size() < 2)
+        continue;
+
+      int64_t workspaceSize = assignOffsets(buffers);
+      for (const PlannedBuffer &buffer : buffers)
+        unplannedBytes += buffer.size;
+      plannedPeakBytes += workspaceSize;
+      numPlannedAllocs += buffers.size();
+
+      rewriter.setInsertionPointToStart(&entryBlock);
+      auto workspaceType =
+          MemRefType::get({workspaceSize}, rewriter.getI8Type(),
+                          MemRefLayoutAttrInterface{}, memorySpace);
+      Value workspace = rewriter.create<memref::AllocOp>(
+          func.getLoc(), workspaceType, rewriter.getI64IntegerAttr(alignment));
+      rewriter.setInsertionPoint(entryBlock.getTerminator());
+      rewriter.create<memref::DeallocOp>(func.getLoc(), workspace);
+
+      for (const PlannedBuffer &buffer : buffers) {
+        memref::AllocOp allocOp = buffer.allocOp;
+        rewriter.eraseOp(buffer.deallocOp);
+        rewriter.setInsertionPoint(allocOp);
+        Value offset = rewriter.create<arith::ConstantIndexOp>(
+            allocOp.getLoc(), buffer.offset);
+        rewriter.replaceOpWithNewOp<memref::ViewOp>(
+            allocOp, allocOp.getType(), workspace, offset,
+            allocOp.getDynamicSizes());
+      }
+    }
+  }
+};
+} // namespace
@@ -56,19 +56,31 @@ void plan::buildPlanBufferizationPipeline(OpPassManager &pm) {
   pm.addPass(plan::createPlanAllocTensorsPass());
   pm.addPass(plan::createPlanBufferizePass());
   pm.addPass(mlir::createMemRefCastEliminationPass());
+  pm.addNestedPass<func::FuncOp>(plan::createPlanLowerHostLinalgToLoopsPass());
   pm.addPass(bufferization::createDropEquivalentBufferResultsPass());
 }
 
-void plan::buildPlanBufferOptimizationPipeline(OpPassManager &pm) {
+void plan::buildPlanBufferOptimizationPipeline(OpPassManager &pm,
+                                               bool enableMemoryPlanning) {
   pm.addNestedPass<func::FuncOp>(bufferization::createBufferLoopHoistingPass());
   pm.addNestedPass<func::FuncOp>(bufferization::createBufferHoistingPass());
   bufferization::BufferDeallocationPipelineOptions opts;
   opts.privateFunctionDynamicOwnership = false;
   bufferization::buildBufferDeallocationPipeline(pm, opts);
   pm.addNestedPass<func::FuncOp>(createCanonicalizerPass());
+  if (enableMemoryPlanning)
+    pm.addNestedPass<func::FuncOp>(plan::createPlanMemoryPlanningPass());
 }
 
 namespace {
+struct BufferizePipelineCliOpts
+    : public PassPipelineOptions<BufferizePipelineCliOpts> {
+  Option<bool> enableMemoryPlanning{
+      *this, "enable-memory-planning",
+      llvm::cl::desc("pack intermediate buffers into workspace allocations"),
+      llvm::cl::init(false)};
+};
+
 struct ClusteringPipelineCliOpts
     : public PassPipelineOptions<ClusteringPipelineCliOpts> {
   Option<std::string> entrypoint{*this, "entrypoint", llvm::cl::init(""),
@@ -77,6 +89,11 @@ struct ClusteringPipelineCliOpts
       *this, "disallow-host-tensors-in-tensorrt-clusters",
       llvm::cl::desc("don't allow host tensor inputs to tensorrt clusters"),
       llvm::cl::init(false)};
+  Option<int64_t> hostTensorClusterMaxNumElements{
+      *this, "host-tensor-cluster-max-num-elements",
+      llvm::cl::desc("if positive, cluster small static tensor computations "
+                     "on the host"),
+      llvm::cl::init(0)};
   Option<int64_t> trtMajorVersion{
       *this, "trt-major-version",
       llvm::cl::desc("target TensorRT version for segmentation pipeline"),
@@ -87,13 +104,14 @@ struct ClusteringPipelineCliOpts
 // Register pipelines.
 
 void plan::registerPlanDialectPipelines() {
-  PassPipelineRegistration<> executorBufferizationPipeline(
-      "plan-bufferize-pipeline",
-      "perform bufferization and standard pre/post processing passes",
-      [](OpPassManager &pm) {
-        buildPlanBufferizationPipeline(pm);
-        buildPlanBufferOptimizationPipeline(pm);
-      });
+  PassPipelineRegistration<BufferizePipelineCliOpts>
+      executorBufferizationPipeline(
+          "plan-bufferize-pipeline",
+          "perform bufferization and standard pre/post processing passes",
+          [](OpPassManager &pm, const BufferizePipelineCliOpts &opts) {
+            buildPlanBufferizationPipeline(pm);
+            buildPlanBufferOptimizationPipeline(pm, opts.enableMemoryPlanning);
+          });
 
   PassPipelineRegistration<ClusteringPipelineCliOpts> segPipelineRegistration(
       "plan-segmentation-pipeline",
@@ -103,6 +121,8 @@ void plan::registerPlanDialectPipelines() {
         clusterOpts.trtMajorVersion = opts.trtMajorVersion;
         clusterOpts.disallowHostTensorsInTensorRTClusters =
             opts.disallowHostTensorsInTensorRTClusters;
+        clusterOpts.hostTensorClusterMaxNumElements =
+            opts.hostTensorClusterMaxNumElements;
         clusterOpts.entrypoint = opts.entrypoint;
         buildPlanSegmentationPipeline(pm, clusterOpts);
       });
@@ -275,6 +275,11 @@ public:
           module->getContext(), this->disallowHostTensorsInTensorRTClusters,
           10));
       schedule.push_back(HostClusterKindAttr::get(module->getContext(), 9));
+      // Host tensor clusters take precedence over TensorRT clusters since
+      // their cost model only accepts small computations on the host.
+      if (hostTensorClusterMaxNumElements > 0)
+        schedule.push_back(HostTensorClusterKindAttr::get(
+            module->getContext(), 11, hostTensorClusterMaxNumElements));
     }
     llvm::sort(schedule,
                [](ClusterKindAttrInterface lhs, ClusterKindAttrInterface rhs) {
@@ -284,8 +289,9 @@ public:
     for (func::FuncOp func : funcs) {
       if (failed(applyClusteringToFunc(
               rewriter, func, solver, schedule,
-              StablehloClusteringPassOptions{entrypoint, false, false,
-                                             trtMajorVersion})))
+              StablehloClusteringPassOptions{
+                  entrypoint, false, false, trtMajorVersion,
+                  hostTensorClusterMaxNumElements})))
         return signalPassFailure();
     }
 
@@ -248,6 +248,12 @@ MTRT_CAPI_EXPORTED MTRT_Status mtrtFunctionSignatureGetNumInputArgs(
     MTRT_FunctionSignature signature, int64_t *numInputArgs);
 MTRT_CAPI_EXPORTED MTRT_Status mtrtFunctionSignatureGetNumOutputArgs(
     MTRT_FunctionSignature signature, int64_t *numOutputArgs);
+/// Return in `inputIndex` the index of the input argument that is donated to
+/// the output argument `index`, or -1 if the output argument is not aliased.
+/// The buffer of a donated input must also be passed as the aliased output
+/// argument; it is consumed by the call and holds the output afterwards.
+MTRT_CAPI_EXPORTED MTRT_Status mtrtFunctionSignatureGetOutputAlias(
+    MTRT_FunctionSignature signature, int64_t index, int64_t *inputIndex);
 MTRT_CAPI_EXPORTED MTRT_Status mtrtFunctionSignatureGetArg(
     MTRT_FunctionSignature signature, int64_t index, MTRT_Type *type);
 MTRT_CAPI_EXPORTED MTRT_Status mtrtFunctionSignatureGetResult(
@@ -359,6 +359,25 @@ MLIR_CAPI_EXPORTED MTRT_Status mtrtRuntimeSessionOptionsCreate(
 MLIR_CAPI_EXPORTED MTRT_Status
 mtrtRuntimeSessionOptionsDestroy(MTRT_RuntimeSessionOptions options);
 
+/// Enable or disable profiling for sessions created with `options`. A
+/// profiling session records the calls of runtime builtins (e.g. copies,
+/// allocations, and TensorRT enqueues) made by each function it executes.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtRuntimeSessionOptionsEnableProfiling(
+    MTRT_RuntimeSessionOptions options, bool enable);
+
+/// Set the maximum number of threads that strided copies between host buffers
+/// may use in sessions created with `options`. Zero selects the hardware
+/// concurrency. The default is one.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtRuntimeSessionOptionsSetNumHostCopyThreads(
+    MTRT_RuntimeSessionOptions options, uint32_t numThreads);
+
+/// Allow sessions created with `options` to load the precompiled Lua bytecode
+/// embedded in executables instead of their source. Lua does not verify
+/// binary chunks, so this must only be enabled for trusted executables.
+MLIR_CAPI_EXPORTED MTRT_Status
+mtrtRuntimeSessionOptionsEnableExecutableBytecode(
+    MTRT_RuntimeSessionOptions options, bool enable);
+
 /// Return if the session options is null.
 static inline bool
 mtrtRuntimeSessionOptionsIsNull(MTRT_RuntimeSessionOptions options) {
@@ -401,6 +420,166 @@ MLIR_CAPI_EXPORTED MTRT_Status mtrtRuntimeSessionExecuteFunction(
     const MTRT_RuntimeValue *inArgs, size_t numInArgs,
     const MTRT_RuntimeValue *outArgs, size_t numOutArgs, MTRT_Stream stream);
 
+/// The formats in which the profile of a session can be printed.
+typedef enum MTRT_ProfileFormat {
+  /// JSON in the Chrome trace event format, with one event per call.
+  MTRT_ProfileFormat_chrome_trace = 0,
+  /// A table of the calls aggregated by function and builtin.
+  MTRT_ProfileFormat_summary = 1,
+} MTRT_ProfileFormat;
+
+/// Print the profile recorded by `session` in the given format. Returns an
+/// error if profiling was not enabled in the session options.
+MLIR_CAPI_EXPORTED MTRT_Status
+mtrtRuntimeSessionPrintProfile(MTRT_RuntimeSession session,
+                               MTRT_ProfileFormat format,
+                               MTRT_PrintCallbackInfo callback);
+
+/// Discard the profile recorded by `session`.
+MLIR_CAPI_EXPORTED MTRT_Status
+mtrtRuntimeSessionResetProfile(MTRT_RuntimeSession session);
+
+//===----------------------------------------------------------------------===//
+// MTRT_BoundFunction
+//===----------------------------------------------------------------------===//
+
+/// A public function of a RuntimeSession that has been resolved ahead of time.
+/// Executing a bound function skips the lookup and full signature validation
+/// performed by `mtrtRuntimeSessionExecuteFunction`, which makes it the
+/// preferred way to repeatedly invoke the same function.
+typedef struct MTRT_BoundFunction {
+  void *ptr;
+} MTRT_BoundFunction;
+
+/// Bind the public function with the specified name in `session`. The
+/// returned function holds a reference to the session and must be destroyed
+/// before the session.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtRuntimeSessionBindFunction(
+    MTRT_RuntimeSession session, MTRT_StringView name,
+    MTRT_BoundFunction *result);
+
+/// Destroy the bound function.
+MLIR_CAPI_EXPORTED MTRT_Status
+mtrtBoundFunctionDestroy(MTRT_BoundFunction func);
+
+/// Return if the bound function is null.
+static inline bool mtrtBoundFunctionIsNull(MTRT_BoundFunction func) {
+  return !func.ptr;
+}
+
+/// Execute the bound function. The argument conventions are the same as for
+/// `mtrtRuntimeSessionExecuteFunction`.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtBoundFunctionExecute(
+    MTRT_BoundFunction func, const MTRT_RuntimeValue *inArgs, size_t numInArgs,
+    const MTRT_RuntimeValue *outArgs, size_t numOutArgs, MTRT_Stream stream);
+
+//===----------------------------------------------------------------------===//
+// MTRT_AsyncExecution
+//===----------------------------------------------------------------------===//
+
+/// The completion handle of a function invocation started by
+/// `mtrtRuntimeSessionExecuteFunctionAsync`. Instead of blocking the calling
+/// thread while waiting for device work, the invocation is suspended and
+/// resumed by `mtrtAsyncExecutionPoll` or `mtrtAsyncExecutionWait`, which
+/// allows one thread to drive many in-flight invocations across sessions.
+typedef struct MTRT_AsyncExecution {
+  void *ptr;
+} MTRT_AsyncExecution;
+
+/// Using `session`, start executing the public function with the specified
+/// name. The argument conventions are the same as for
+/// `mtrtRuntimeSessionExecuteFunction`. The arguments must stay alive, and the
+/// returned execution must be destroyed before the session.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtRuntimeSessionExecuteFunctionAsync(
+    MTRT_RuntimeSession session, MTRT_StringView name,
+    const MTRT_RuntimeValue *inArgs, size_t numInArgs,
+    const MTRT_RuntimeValue *outArgs, size_t numOutArgs, MTRT_Stream stream,
+    MTRT_AsyncExecution *result);
+
+/// Destroy the execution. If it is not done, this waits for it first.
+MLIR_CAPI_EXPORTED MTRT_Status
+mtrtAsyncExecutionDestroy(MTRT_AsyncExecution execution);
+
+/// Return if the execution is null.
+static inline bool mtrtAsyncExecutionIsNull(MTRT_AsyncExecution execution) {
+  return !execution.ptr;
+}
+
+/// Make as much progress on the execution as possible without blocking and
+/// set `isDone` to whether it is done. Once it is done, the status of the
+/// execution is returned.
+MLIR_CAPI_EXPORTED MTRT_Status
+mtrtAsyncExecutionPoll(MTRT_AsyncExecution execution, bool *isDone);
+
+/// Block until the execution is done and return its status.
+MLIR_CAPI_EXPORTED MTRT_Status
+mtrtAsyncExecutionWait(MTRT_AsyncExecution execution);
+
+//===----------------------------------------------------------------------===//
+// MTRT_SessionPool
+//===----------------------------------------------------------------------===//
+
+/// A pool of sessions for one Executable that executes requests from many
+/// concurrent clients on its own worker threads. All functions taking a
+/// session pool may be called concurrently.
+typedef struct MTRT_SessionPool {
+  void *ptr;
+} MTRT_SessionPool;
+
+/// Callback invoked on a worker thread with the status of a completed
+/// request. The callback takes ownership of `status`.
+typedef void (*MTRT_SessionPoolCallback)(MTRT_Status status, void *userData);
+
+/// A snapshot of the counters of a session pool.
+typedef struct MTRT_SessionPoolStatistics {
+  /// The number of sessions (and worker threads).
+  int64_t numSessions;
+  /// The number of requests that are queued but not yet started.
+  int64_t queueDepth;
+  /// The number of sessions currently executing a request.
+  int64_t numBusySessions;
+  /// The number of requests that have completed.
+  int64_t numCompletedRequests;
+  /// The number of requests executed by a worker other than the one they
+  /// were queued to.
+  int64_t numStolenRequests;
+} MTRT_SessionPoolStatistics;
+
+/// Create a pool of `numSessions` sessions for `executable`, each created
+/// with `options`. The Executable must outlive the pool.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtSessionPoolCreate(
+    MTRT_RuntimeSessionOptions options, MTRT_Executable executable,
+    int32_t numSessions, MTRT_SessionPool *result);
+
+/// Destroy the pool. This waits for all queued requests to complete.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtSessionPoolDestroy(MTRT_SessionPool pool);
+
+/// Return if the session pool is null.
+static inline bool mtrtSessionPoolIsNull(MTRT_SessionPool pool) {
+  return !pool.ptr;
+}
+
+/// Queue a request to execute the public function with the specified name.
+/// The argument conventions are the same as for
+/// `mtrtRuntimeSessionExecuteFunction`. The arguments must stay alive until
+/// `callback` has been invoked with `userData`.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtSessionPoolSubmit(
+    MTRT_SessionPool pool, MTRT_StringView name,
+    const MTRT_RuntimeValue *inArgs, size_t numInArgs,
+    const MTRT_RuntimeValue *outArgs, size_t numOutArgs, MTRT_Stream stream,
+    MTRT_SessionPoolCallback callback, void *userData);
+
+/// Queue a request like `mtrtSessionPoolSubmit` and block until it completes.
+/// Returns the status of the request.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtSessionPoolExecuteFunction(
+    MTRT_SessionPool pool, MTRT_StringView name,
+    const MTRT_RuntimeValue *inArgs, size_t numInArgs,
+    const MTRT_RuntimeValue *outArgs, size_t numOutArgs, MTRT_Stream stream);
+
+/// Return the current values of the counters of the pool.
+MLIR_CAPI_EXPORTED MTRT_Status mtrtSessionPoolGetStatistics(
+    MTRT_SessionPool pool, MTRT_SessionPoolStatistics *result);
+
 //===----------------------------------------------------------------------===//
 // DLPack
 //===----------------------------------------------------------------------===//
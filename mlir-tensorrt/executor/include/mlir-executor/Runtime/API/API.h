@@ -27,6 +27,7 @@
 
 #include "dlpack/dlpack.h"
 #include "mlir-executor/Runtime/Backend/Lua/SolAdaptor.h"
+#include "mlir-executor/Runtime/Support/Profiler.h"
 #include "mlir-executor/Support/Allocators.h"
 #include "mlir-executor/Support/Status.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -35,9 +36,11 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <array>
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <shared_mutex>
 #include <string_view>
 
 #if defined(__clang__)
@@ -59,6 +62,7 @@ using PointerType = impl::PointerType;
 using PointerOwner = impl::PointerOwner;
 using TypeCode = impl::Type;
 using CallingConvention = impl::CallingConvention;
+using ConstantEncoding = impl::ConstantEncoding;
 
 class RuntimeClient;
 
@@ -372,6 +376,35 @@ public:
   /// Returns the calling convention associated with this function.
   CallingConvention getCConv() const { return view->calling_convention(); }
 
+  /// Returns true if any output argument is aliased to a donated input.
+  bool hasOutputAliases() const {
+    return view->output_aliases() && view->output_aliases()->size() > 0;
+  }
+
+  /// Returns the index of the input argument donated to the output argument
+  /// `idx`, if any. The function writes the output into the buffer of the
+  /// donated input, so callers must pass the same buffer for both.
+  std::optional<uint32_t> getOutputAlias(int64_t idx) const {
+    assert(idx < getNumOutputArgs() && "expected valid output argument index");
+    if (!hasOutputAliases() || idx >= view->output_aliases()->size())
+      return std::nullopt;
+    int32_t alias = view->output_aliases()->Get(idx);
+    if (alias < 0)
+      return std::nullopt;
+    return static_cast<uint32_t>(alias);
+  }
+
+  /// Returns the indices of the input arguments that are consumed by the
+  /// function because they are donated to an output argument.
+  llvm::SmallVector<uint32_t> getDonatedInputArgs() const {
+    llvm::SmallVector<uint32_t> donated;
+    for (unsigned i = 0, e = getNumOutputArgs(); i < e; i++) {
+      if (std::optional<uint32_t> alias = getOutputAlias(i))
+        donated.push_back(*alias);
+    }
+    return donated;
+  }
+
   const impl::FunctionSignature *view;
 };
 
@@ -399,9 +432,22 @@ public:
 
   std::string_view getName() const { return view->name()->string_view(); }
 
+  /// Return the serialized (possibly encoded) data of the constant.
   const int8_t *data() const { return view->data()->data(); }
   size_t size() const { return view->data()->size(); }
 
+  ConstantEncoding getEncoding() const { return view->encoding(); }
+
+  /// Return the size in bytes of the value of the constant.
+  size_t getDecodedSize() const {
+    return getEncoding() == ConstantEncoding::raw ? size()
+                                                  : view->decoded_size();
+  }
+
+  /// Decode the value of the constant into `dest`, which must hold
+  /// `getDecodedSize()` bytes.
+  void decode(void *dest) const;
+
 private:
   const impl::Constant *view;
 };
@@ -418,6 +464,31 @@ public:
 
   std::string_view getCode() const { return view->source()->string_view(); }
 
+  /// Return the precompiled bytecode for the code, or an empty string if the
+  /// executable does not contain bytecode.
+  std::string_view getBytecode() const {
+    if (!view->bytecode())
+      return {};
+    return std::string_view(
+        reinterpret_cast<const char *>(view->bytecode()->data()),
+        view->bytecode()->size());
+  }
+
+  /// Return the version of the Lua implementation that produced the bytecode.
+  uint32_t getBytecodeLuaVersion() const {
+    return view->bytecode_lua_version();
+  }
+
+  /// Return the LLVM bitcode for the native host backend, or an empty string
+  /// if the executable does not contain native code.
+  std::string_view getNativeCode() const {
+    if (!view->native_code())
+      return {};
+    return std::string_view(
+        reinterpret_cast<const char *>(view->native_code()->data()),
+        view->native_code()->size());
+  }
+
   size_t getNumFunctions() const { return view->functions()->size(); }
 
   FunctionView getFunction(int64_t idx) const {
@@ -462,6 +533,11 @@ protected:
 // ExecutableStorage
 //===----------------------------------------------------------------------===//
 
+/// The alignment (in bytes) of constant data in a serialized executable. This
+/// alignment holds relative to the start of the buffer, so storage that is
+/// itself aligned to at least this value allows constants to be used in place.
+static constexpr uint64_t kExecutableConstantAlignment = 64;
+
 /// A ExecutableStorage manages storage for the executable. Different concrete
 /// implementations may choose to manage the storage using e.g.
 /// `llvm::MemoryBuffer` or via a just-encoded flatbuffer-allocated buffer.
@@ -472,6 +548,7 @@ public:
   ExecutableStorage(const ExecutableStorage &) = delete;
   ExecutableStorage &operator=(const ExecutableStorage &) = delete;
 
+  /// Return a copy of the storage, or nullptr if it cannot be copied.
   virtual std::unique_ptr<ExecutableStorage> getCopy() const = 0;
 
   virtual const void *data() const = 0;
@@ -491,12 +568,15 @@ public:
   Executable(std::unique_ptr<ExecutableStorage> storage);
   Executable(Executable &&other);
 
-  std::unique_ptr<Executable> getCopy() const;
+  /// Return a copy of the executable whose storage is owned by the copy.
+  StatusOr<std::unique_ptr<Executable>> getCopy() const;
 
   ExecutableView getView() const { return ExecutableView(this->view); }
 
-  /// Read the binary data from the given file and return a deserialized
-  /// Executable.
+  /// Map the given file into memory and return a deserialized Executable.
+  /// The file is mapped read-only, so its contents (e.g. constant data) are
+  /// paged in lazily when first accessed and no copy is made. The path `-`
+  /// reads from stdin instead.
   static StatusOr<std::unique_ptr<Executable>>
   loadFromFile(std::string_view path);
 
@@ -736,10 +816,64 @@ public:
   /// one device.a
   llvm::StringRef getNcclUuid() const { return ncclUuid; }
 
+  /// Use `allocator` for the session's allocations of memory `type` (see
+  /// `AllocTracker::setCachingAllocator`).
+  void setCachingAllocator(PointerType type,
+                           std::shared_ptr<CachingAllocator> allocator) {
+    assert((type == PointerType::host || type == PointerType::device) &&
+           "only host and device allocations can be cached");
+    (type == PointerType::host ? hostAllocator : deviceAllocator) =
+        std::move(allocator);
+  }
+
+  /// Return the caching allocator to use for memory `type` or nullptr.
+  std::shared_ptr<CachingAllocator>
+  getCachingAllocator(PointerType type) const {
+    if (type == PointerType::host)
+      return hostAllocator;
+    if (type == PointerType::device)
+      return deviceAllocator;
+    return nullptr;
+  }
+
+  /// Enable or disable the session's `RuntimeProfiler`, which records the
+  /// builtins invoked by each function that the session executes.
+  void enableProfiling(bool enable = true) { profilingEnabled = enable; }
+
+  /// Return whether the session should create a `RuntimeProfiler`.
+  bool isProfilingEnabled() const { return profilingEnabled; }
+
+  /// Set the maximum number of threads that a strided copy between host
+  /// buffers may use, where zero selects the hardware concurrency. Defaults to
+  /// one, so copies run on the calling thread.
+  void setNumHostCopyThreads(unsigned numThreads) {
+    numHostCopyThreads = numThreads;
+  }
+
+  /// Return the maximum number of threads of host strided copies.
+  unsigned getNumHostCopyThreads() const { return numHostCopyThreads; }
+
+  /// Allow the session to load the precompiled Lua bytecode embedded in the
+  /// executable instead of its source. Lua does not verify binary chunks, so
+  /// this must only be enabled for trusted executables. Disabled by default.
+  void enableExecutableBytecode(bool enable = true) {
+    executableBytecodeEnabled = enable;
+  }
+
+  /// Return whether the session may load the executable's bytecode.
+  bool isExecutableBytecodeEnabled() const {
+    return executableBytecodeEnabled;
+  }
+
 private:
   int32_t numDevices;
   int32_t deviceId;
   std::string ncclUuid;
+  std::shared_ptr<CachingAllocator> hostAllocator;
+  std::shared_ptr<CachingAllocator> deviceAllocator;
+  bool profilingEnabled{false};
+  unsigned numHostCopyThreads{1};
+  bool executableBytecodeEnabled{false};
 };
 
 //===----------------------------------------------------------------------===//
@@ -754,8 +888,21 @@ private:
 /// The CoreModule instantiates an AllocTracker in each Lua context.
 /// Users in other modules can access the tracker by calling
 /// `AllocTracker::get` and passing a `sol::state_view`.
+///
+/// Unless the tracker is created with `threadSafe` set to false, all methods
+/// may be called concurrently, e.g. by threads that share a `RuntimeClient`.
+/// The map is split into shards selected by a hash of the pointer, each
+/// guarded by its own reader-writer lock, so operations on different pointers
+/// rarely contend. Queries return copies of the tracked information, since
+/// another thread may untrack the pointer at any time.
 class AllocTracker {
 public:
+  /// Create a tracker. A tracker that is only used by one thread at a time,
+  /// like the tracker of a `RuntimeSession`, can skip the locks by setting
+  /// `threadSafe` to false, which avoids the atomic operations of the locks
+  /// on every lookup.
+  explicit AllocTracker(bool threadSafe = true) : threadSafe(threadSafe) {}
+
   /// AllocTracker's destructor will free any tracked non-external allocations.
   ~AllocTracker();
 
@@ -766,8 +913,9 @@ public:
   void untrack(uintptr_t ptr);
 
   /// Retrive the information for the provided pointer. Asserts that the pointer
-  /// is tracked.
-  const PointerInfo &get(uintptr_t ptr) const;
+  /// is tracked. The information is returned by value since another thread may
+  /// untrack the pointer at any time.
+  PointerInfo get(uintptr_t ptr) const;
 
   /// Lookup the provided pointer. If the pointer is not tracked, then the
   /// `PointerInfo` fields besides `PointerInfo::ptr` will be filled with
@@ -777,11 +925,15 @@ public:
   /// Return true if the tracker's map contains `ptr`.
   bool contains(uintptr_t ptr) const;
 
-  /// Increment external reference count. Assume ptr is already being tracked.
+  /// Increment external reference count. The reference count methods below
+  /// have no effect on (or return zero values for) pointers that are not
+  /// tracked, since another thread may untrack a pointer at any time.
   void incrementExternalCount(uintptr_t ptr);
 
   /// Decrement reference count. Also, deallocates ptr when count goes to zero
-  /// and `releasedInternally` is true.
+  /// and `releasedInternally` is true. A count that is already zero, e.g.
+  /// because the pointer was re-tracked since the matching increment, is not
+  /// changed.
   void decrementExternalCount(uintptr_t ptr);
 
   /// Returns external reference count for the ptr.
@@ -794,19 +946,115 @@ public:
   /// Returns true if the ptr is released internally.
   bool isReleasedInternally(uintptr_t ptr) const;
 
+  /// Set a read-only parent tracker. Pointers not tracked by this tracker are
+  /// looked up in the parent by all queries (`get`, `lookupOrDefault`,
+  /// `contains`, `getExternalReferenceCount`, and `isReleasedInternally`).
+  /// The parent is never modified: the mutators ignore pointers that only the
+  /// parent tracks and `safeDeallocate` rejects them. The parent must outlive
+  /// this tracker.
+  void setParent(const AllocTracker *parent) { this->parent = parent; }
+
+  /// Return true if `ptr` is not tracked by this tracker but by its parent.
+  bool isTrackedByParent(uintptr_t ptr) const;
+
+  /// Serve the allocations of memory `type` that are made by
+  /// `runtime::allocate` with this tracker from `allocator`, and return them to
+  /// `allocator` in `safeDeallocate`. Only host and device memory can be
+  /// cached. Passing nullptr restores the default uncached allocation. Like
+  /// `setParent`, this must not be called concurrently with other methods.
+  void setCachingAllocator(PointerType type,
+                           std::shared_ptr<CachingAllocator> allocator);
+
+  /// Return the caching allocator used for memory `type` or nullptr.
+  CachingAllocator *getCachingAllocator(PointerType type) const;
+
+  /// Counters over the internally managed pointers of known size that are
+  /// tracked by this tracker (not the parent), for one memory type.
+  struct Statistics {
+    /// The number of pointers that have been tracked.
+    int64_t numAllocations{0};
+    /// The total size of the pointers that are currently tracked.
+    int64_t numBytes{0};
+    /// The largest value of `numBytes` that was observed.
+    int64_t peakBytes{0};
+  };
+
+  /// Return the statistics of the pointers of memory `type`.
+  Statistics getStatistics(PointerType type) const;
+
+  /// Reset the allocation counts to zero and the peaks to the bytes that are
+  /// currently tracked.
+  void resetStatistics();
+
 private:
   struct Metadata {
     std::atomic<int32_t> externalReferenceCount = {0};
     // whether we free'd/released this buffer internally.
     // if this is true then it should be truelly released and untracked
     // when decrementExternalCount causes count to go to zero
-    bool releasedInternally{false};
+    std::atomic<bool> releasedInternally{false};
     PointerInfo info;
   };
 
-  llvm::DenseMap<uintptr_t, std::unique_ptr<Metadata>> map;
+  /// A part of the map guarded by its own lock.
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    llvm::DenseMap<uintptr_t, std::unique_ptr<Metadata>> map;
+  };
+
+  static constexpr unsigned kNumShardsLog2 = 4;
+
+  /// Return the shard responsible for `ptr`.
+  Shard &getShard(uintptr_t ptr) { return shards[getShardIndex(ptr)]; }
+  const Shard &getShard(uintptr_t ptr) const {
+    return shards[getShardIndex(ptr)];
+  }
+  static unsigned getShardIndex(uintptr_t ptr) {
+    // Fibonacci hashing spreads aligned pointers over the shards.
+    return static_cast<unsigned>(
+        (static_cast<uint64_t>(ptr) * 0x9E3779B97F4A7C15ull) >>
+        (64 - kNumShardsLog2));
+  }
+
+  /// Invoke `fn` with the metadata of `ptr` in this tracker (not the parent),
+  /// or with nullptr if it is not tracked, while holding the lock of its
+  /// shard. The metadata must not be used after `fn` returns, since it is
+  /// freed when another thread untracks or re-tracks `ptr`.
+  template <typename Fn>
+  auto withMetadata(uintptr_t ptr, Fn &&fn) const;
+
+  /// Return a lock of `mutex` that is only held if the tracker is
+  /// thread-safe.
+  template <typename Lock>
+  Lock lockShard(std::shared_mutex &mutex) const {
+    return threadSafe ? Lock(mutex) : Lock(mutex, std::defer_lock);
+  }
+
+  /// The atomic counterparts of `Statistics`.
+  struct Counters {
+    std::atomic<int64_t> numAllocations{0};
+    std::atomic<int64_t> numBytes{0};
+    std::atomic<int64_t> peakBytes{0};
+  };
+
+  /// Update the counters when `info` starts or stops being tracked.
+  void recordTracked(const PointerInfo &info);
+  void recordUntracked(const PointerInfo &info);
+
+  std::array<Shard, 1 << kNumShardsLog2> shards;
+  std::array<Counters, static_cast<size_t>(PointerType::MAX) + 1> counters;
+  const AllocTracker *parent{nullptr};
+  const bool threadSafe;
+  std::shared_ptr<CachingAllocator> hostAllocator;
+  std::shared_ptr<CachingAllocator> deviceAllocator;
 };
 
+/// Create a caching allocator for memory `type`, which must be `host` or
+/// `device`. The returned allocator can be shared between the trackers of
+/// several clients and sessions.
+StatusOr<std::shared_ptr<CachingAllocator>>
+createCachingAllocator(PointerType type, CachingAllocatorOptions options = {});
+
 /// A helper that allocates buffers based on the provided pointer type. The
 /// AllocTracker will be updated so that it is aware of the allocation. The
 /// allocation size (in bytes) and alignment (optional, in bytes) are specified
@@ -860,7 +1108,8 @@ private:
 /// RuntimeSessions. A RuntimeSession does not own the Executable, it only has a
 /// read-only view to the Executable's storage (e.g. constant data, code, etc).
 /// The Executable must outlive any RuntimeSessions that are created from it
-/// (and currently no reference counting is implemented).
+/// (and currently no reference counting is implemented). A RuntimeSession must
+/// not be used by several threads at the same time.
 /// TODO: methods for accessing/setting default stream should be moved here.
 class RuntimeSession {
 public:
@@ -880,6 +1129,10 @@ public:
   /// Returns the options used to construct the session.
   const RuntimeSessionOptions &getOptions() { return options; }
 
+  /// Return the session's profiler, or nullptr if profiling is not enabled
+  /// in the session options.
+  RuntimeProfiler *getProfiler() { return profiler.get(); }
+
 protected:
   RuntimeSessionOptions options;
 
@@ -888,6 +1141,7 @@ protected:
   std::unique_ptr<PinnedMemoryAllocator> pinnedMemoryAllocator;
   std::unique_ptr<AllocTracker> allocTracker;
   std::unique_ptr<ResourceTracker> resourceTracker;
+  std::unique_ptr<RuntimeProfiler> profiler;
 };
 
 //===----------------------------------------------------------------------===//
@@ -28,6 +28,8 @@
 #include "mlir-executor/Runtime/API/API.h"
 #include "mlir-executor/Runtime/Support/Support.h"
 #include "mlir-executor/Support/Status.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include <cassert>
 #include <iostream>
@@ -38,11 +40,86 @@ namespace mlirtrt::runtime {
 // Copy utilities
 //===----------------------------------------------------------------------===//
 
+/// Return the canonical (row-major) strides, in elements, of a buffer of shape
+/// `shape`.
+llvm::SmallVector<int64_t> getCanonicalStrides(llvm::ArrayRef<int64_t> shape);
+
+/// A `StridedCopyPlan` describes a copy between two strided buffers of the
+/// same shape as a loop nest over contiguous runs of `runSize` bytes. The run
+/// at index `i` of the loop nest starts at byte offset
+/// `srcOffset + sum_d(i[d] * srcStrides[d])` of the source, and likewise for
+/// the destination. Dimensions of size one are dropped, and dimensions that
+/// are contiguous in both buffers are folded into the run or merged with the
+/// next inner dimension, so the loop nest is usually much smaller than the
+/// rank of the copied memrefs.
+struct StridedCopyPlan {
+  enum class Kind {
+    /// Nothing is copied.
+    Empty,
+    /// A single run.
+    Contiguous,
+    /// Runs along one dimension, i.e. a pitched 2-D copy.
+    Pitched2D,
+    /// Runs along two dimensions, i.e. a pitched 3-D copy.
+    Pitched3D,
+    /// Runs along three or more dimensions.
+    Generic
+  };
+
+  Kind getKind() const;
+
+  /// Return the number of runs.
+  int64_t getNumRuns() const;
+
+  /// Return the number of copied bytes.
+  int64_t getNumBytes() const { return getNumRuns() * runSize; }
+
+  /// Invoke `callback(srcOffset, dstOffset)` with the byte offsets of the
+  /// first run of each iteration of the loops other than the innermost
+  /// `numInnerLoops` loops, in row-major order.
+  void forEachRun(llvm::function_ref<void(int64_t, int64_t)> callback,
+                  unsigned numInnerLoops = 0) const;
+
+  /// The size of each run in bytes, or zero if nothing is copied.
+  int64_t runSize{0};
+  /// The byte offsets of the first run.
+  int64_t srcOffset{0};
+  int64_t dstOffset{0};
+  /// The loop nest, outermost loop first. Strides are given in bytes.
+  llvm::SmallVector<int64_t> shape;
+  llvm::SmallVector<int64_t> srcStrides;
+  llvm::SmallVector<int64_t> dstStrides;
+};
+
+/// Plan the copy of a buffer of shape `shape` and elements of `elemSize`
+/// bytes. Offsets and strides are given in elements.
+StridedCopyPlan planStridedCopy(int64_t elemSize, llvm::ArrayRef<int64_t> shape,
+                                int64_t srcOffset,
+                                llvm::ArrayRef<int64_t> srcStrides,
+                                int64_t dstOffset,
+                                llvm::ArrayRef<int64_t> dstStrides);
+
+/// Execute `plan` between the host buffers `src` and `dst`. Copies of at
+/// least `kMinStridedCopyBytesPerThread` bytes per thread are split across up
+/// to `numThreads` threads, where zero selects the hardware concurrency. The
+/// copy runs on the calling thread by default; sessions pass
+/// `RuntimeSessionOptions::getNumHostCopyThreads`.
+void executeStridedCopyOnHost(const StridedCopyPlan &plan, uintptr_t src,
+                              uintptr_t dst, unsigned numThreads = 1);
+
+/// The minimum number of bytes that `executeStridedCopyOnHost` assigns to a
+/// thread.
+constexpr int64_t kMinStridedCopyBytesPerThread = 1 << 20;
+
+/// Execute a strided copy where the strides and offsets are given in elements
+/// by invoking `memcpyFunc` on each contiguous run of the copy. The source
+/// and destination shapes must be equal.
 void executeStridedCopy(
     int64_t elemSize, uintptr_t src, int64_t srcOffset,
-    const std::vector<int64_t> &srcShape, std::vector<int64_t> &srcStrides,
-    uintptr_t dst, int64_t dstOffset, const std::vector<int64_t> &dstShape,
-    std::vector<int64_t> &dstStrides,
+    const std::vector<int64_t> &srcShape,
+    const std::vector<int64_t> &srcStrides, uintptr_t dst, int64_t dstOffset,
+    const std::vector<int64_t> &dstShape,
+    const std::vector<int64_t> &dstStrides,
     std::function<void(void *dst, void *src, size_t size)> memcpyFunc);
 
 /// Execute a strided copy where the strides and offsets are given in bytes.
@@ -53,6 +130,61 @@ void executeStridedByteCopy(
     const std::vector<int64_t> &dstByteStrides, size_t elemSizeBytes,
     std::function<void(void *dst, void *src, size_t size)> memcpyFunc);
 
+//===----------------------------------------------------------------------===//
+// Session utilities
+//===----------------------------------------------------------------------===//
+
+/// The minimum alignment of the buffers that hold the executable's constants.
+static constexpr uint64_t kMinConstantBufferByteAlignment = 8;
+
+/// If the runtime was compiled with NCCL enabled, then check for the NCCL uuid
+/// if the system has multiple GPUs.
+Status maybeCheckForValidNcclUuid(const RuntimeSessionOptions &options);
+
+/// Decode an encoded constant into a new host buffer owned by `tracker` and
+/// return the buffer's address.
+StatusOr<uintptr_t> materializeConstant(ConstantView constant,
+                                        AllocTracker &tracker);
+
+/// Constants that alias the same serialized data (see the deduplication
+/// performed by the translation) share a single buffer. They are identified
+/// by the address of their data and their decoded size.
+using ConstantDataKey = std::pair<const void *, uint64_t>;
+
+ConstantDataKey getConstantDataKey(ConstantView constant);
+
+/// Make the executable's constants available in `tracker` and invoke
+/// `setGlobal(name, ptr)` for each of them. Constants that are not suitably
+/// aligned are copied into buffers owned by `tracker`. Encoded constants are
+/// passed to `deferConstant` if it is given, otherwise they are materialized
+/// immediately.
+Status
+loadConstants(ExecutableView executable, AllocTracker &tracker,
+              llvm::function_ref<void(std::string_view, uintptr_t)> setGlobal,
+              llvm::function_ref<void(ConstantView)> deferConstant = {});
+
+/// Return the function named `name` in `executable`, or std::nullopt if there
+/// is none.
+std::optional<FunctionView> lookupFunction(ExecutableView executable,
+                                           std::string_view name);
+
+/// Check that the runtime value `runArg` matches the signature type `sigArg`.
+Status validateArgsTypesAgainstFuncArgs(const RuntimeValue *runArg,
+                                        const TypeUnionView &sigArg);
+
+/// Check that each output argument that is aliased to a donated input argument
+/// receives the same buffer as that input, and that a donated buffer is not
+/// also passed as another input argument, since the function overwrites it.
+Status validateOutputAliases(FunctionSignatureView sig,
+                             llvm::ArrayRef<RuntimeValue *> inputArgs,
+                             llvm::ArrayRef<RuntimeValue *> outputArgs);
+
+/// Check the number and types of the arguments against the signature `sig`
+/// as well as the output aliases.
+Status validateFunctionArgs(FunctionSignatureView sig,
+                            llvm::ArrayRef<RuntimeValue *> inputArgs,
+                            llvm::ArrayRef<RuntimeValue *> outputArgs);
+
 } // namespace mlirtrt::runtime
 
 #endif // MLIR_TENSORRT_RUNTIME_COMMON_COMMONRUNTIME_H
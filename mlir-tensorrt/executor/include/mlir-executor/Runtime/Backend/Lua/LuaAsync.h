@@ -0,0 +1,59 @@
+//===- LuaAsync.h -----------------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Utilities shared by the asynchronous execution driver (see
+/// `LuaAsyncExecution`) and the builtins that suspend it.
+///
+/// An asynchronous execution runs the called function in its own Lua thread.
+/// Builtins that would otherwise block the host thread until device work
+/// completes (e.g. `__cuda_stream_sync`) check whether they are running
+/// directly on such a thread, and if so yield the stream to wait on to the
+/// driver instead of blocking.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUAASYNC_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUAASYNC_H
+
+#include "mlir-executor/Runtime/Backend/Lua/SolAdaptor.h"
+
+namespace mlirtrt::runtime {
+
+/// Mark or unmark `thread` as the thread of an asynchronous execution. The
+/// mark is kept in the registry of the Lua state, keyed by the thread.
+inline void setAsyncExecutionThread(lua_State *thread, bool isAsync) {
+  if (isAsync)
+    lua_pushboolean(thread, 1);
+  else
+    lua_pushnil(thread);
+  lua_rawsetp(thread, LUA_REGISTRYINDEX, thread);
+}
+
+/// Return true if `thread` is the thread of an asynchronous execution and
+/// can currently yield. This is false for coroutines created by the program
+/// itself, so their `coro_yield`/`coro_await` protocol is never disturbed.
+inline bool isAsyncExecutionThread(lua_State *thread) {
+  bool isAsync = lua_rawgetp(thread, LUA_REGISTRYINDEX, thread) != LUA_TNIL;
+  lua_pop(thread, 1);
+  return isAsync && lua_isyieldable(thread);
+}
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUAASYNC_H
@@ -0,0 +1,113 @@
+//===- LuaBenchmark.h -------------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declarations for measuring the latency of executable functions.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUABENCHMARK_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUABENCHMARK_H
+
+#include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace mlirtrt::runtime {
+
+/// How `runBenchmark` initializes the input arguments of the function.
+enum class BenchmarkInputInit {
+  /// Zero-filled buffers and zero scalars.
+  Zeros,
+  /// Uniformly random bits. The most significant exponent bit of floats is
+  /// cleared, so that floats are finite with a magnitude below 2.
+  Random,
+  /// The raw bytes of one file per input argument.
+  File
+};
+
+/// Options for `runBenchmark`.
+struct BenchmarkOptions {
+  /// The function to execute. It must not return results.
+  std::string functionName{"main"};
+
+  /// The number of untimed executions before the timed ones.
+  int64_t numWarmupIterations{10};
+
+  /// The number of timed executions.
+  int64_t numIterations{100};
+
+  BenchmarkInputInit inputInit{BenchmarkInputInit::Random};
+
+  /// For `BenchmarkInputInit::File`, the file of each input argument in
+  /// order. A file holds the canonical (row-major) contents of a memref or
+  /// the storage bytes of a scalar.
+  std::vector<std::string> inputFiles;
+
+  /// The seed of `BenchmarkInputInit::Random`.
+  uint64_t seed{0};
+};
+
+/// Latency statistics over the timed executions, in milliseconds.
+/// Percentiles use the nearest-rank method.
+struct LatencyStatistics {
+  double min{0};
+  double max{0};
+  double mean{0};
+  double p50{0};
+  double p90{0};
+  double p99{0};
+};
+
+/// Compute the statistics of the given latencies in nanoseconds.
+LatencyStatistics computeLatencyStatistics(llvm::ArrayRef<int64_t> samplesNs);
+
+/// The results of `runBenchmark`.
+struct BenchmarkResult {
+  std::string functionName;
+  int64_t numWarmupIterations{0};
+  int64_t numIterations{0};
+  /// The wall time of all timed executions in milliseconds.
+  double totalTimeMs{0};
+  /// Timed executions per second.
+  double throughput{0};
+  LatencyStatistics latency;
+  /// The allocations made by the session during the timed executions, per
+  /// memory type. The peak includes the session's constants and globals;
+  /// the function arguments are allocated outside the session.
+  AllocTracker::Statistics hostMemory;
+  AllocTracker::Statistics pinnedHostMemory;
+  AllocTracker::Statistics deviceMemory;
+};
+
+/// Measure the latency of a function of `session`. The arguments are
+/// allocated by `client` from the function signature: dynamic extents take
+/// the largest value of the argument's `DimensionBounds`, and integer
+/// elements are clamped to the argument's `ValueBounds`. Device arguments
+/// require a device of `client`. Each execution is followed by a
+/// synchronization of the device, so latencies include the device work.
+StatusOr<BenchmarkResult> runBenchmark(RuntimeClient &client,
+                                       LuaRuntimeSession &session,
+                                       const BenchmarkOptions &options);
+
+/// Print `result` as a JSON object.
+void printBenchmarkResult(llvm::raw_ostream &os,
+                          const BenchmarkResult &result);
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUABENCHMARK_H
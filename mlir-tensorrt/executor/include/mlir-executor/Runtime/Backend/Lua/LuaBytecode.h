@@ -0,0 +1,42 @@
+//===- LuaBytecode.h --------------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Compilation of Lua source to bytecode chunks. This is shared by the
+/// executable translation, which embeds bytecode in executables, and by the
+/// Lua runtime, which compiles the source of executables without compatible
+/// bytecode.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUABYTECODE_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUABYTECODE_H
+
+#include "mlir-executor/Support/Status.h"
+#include <string>
+#include <string_view>
+
+namespace mlirtrt::runtime {
+
+/// Compile the Lua `source` to a bytecode chunk. The chunk keeps its debug
+/// information so that runtime errors still report source line numbers.
+StatusOr<std::string> compileLuaSourceToBytecode(std::string_view source);
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUABYTECODE_H
@@ -0,0 +1,191 @@
+//===- LuaDynamicBatcher.h --------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declarations for a front end to `LuaSessionPool` that coalesces concurrent
+/// requests into batches.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUADYNAMICBATCHER_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUADYNAMICBATCHER_H
+
+#include "mlir-executor/Runtime/Backend/Lua/LuaSessionPool.h"
+#include "mlir-executor/Runtime/Support/Histogram.h"
+#include <chrono>
+#include <map>
+
+namespace mlirtrt::runtime {
+
+/// Options for `LuaDynamicBatcher`.
+struct DynamicBatchingOptions {
+  /// The dimension of every memref argument along which requests are
+  /// concatenated.
+  unsigned batchDim{0};
+
+  /// The largest number of rows (extent along `batchDim`) of a batch. Zero
+  /// selects the upper bound that the function signature records for the
+  /// batch dimension. A non-zero value is clamped to that bound.
+  int64_t maxBatchSize{0};
+
+  /// The longest time that the oldest queued request of a function waits for
+  /// more requests before a partial batch is executed.
+  std::chrono::microseconds maxQueueDelay{1000};
+
+  /// Pad every batch to the maximum batch size, so that a function is always
+  /// invoked with the same shapes.
+  bool padToMaxBatchSize{false};
+
+  /// The stream on which batches are gathered, executed and scattered.
+  std::optional<CudaStream> stream{};
+};
+
+/// A `LuaDynamicBatcher` coalesces concurrent requests that call the same
+/// function into a single invocation on a `LuaSessionPool`. The memref
+/// arguments of the requests of a batch are concatenated along the batch
+/// dimension into temporary buffers, the batch is padded to the lower bound
+/// of the batch dimension (or the maximum batch size), and the slices of the
+/// outputs are copied back to the requests once the batch completes.
+///
+/// The maximum batch size is derived from the `DimensionBounds` of the
+/// function signature, or from a static extent of the batch dimension. A
+/// batch is executed once it is full, once the next queued request cannot
+/// join it, or once its oldest request has waited `maxQueueDelay`. Requests
+/// can only share a batch if their memrefs agree in everything but their
+/// batch extent, and their scalar arguments are equal. A request that does
+/// not need padding and has no partner is passed through without copies.
+///
+/// All memref arguments must have canonical (row-major) strides. Host,
+/// pinned host and unified memrefs are copied on the host; device memrefs
+/// require CUDA support. Functions that return results or alias outputs to
+/// inputs cannot be batched.
+///
+/// The pool, the client and the executable must outlive the batcher.
+/// Destroying the batcher executes all queued requests and waits for them.
+class LuaDynamicBatcher {
+public:
+  using Callback = LuaSessionPool::Callback;
+
+  /// A snapshot of the counters and histograms of the batcher.
+  struct Statistics {
+    /// The number of completed requests.
+    int64_t numRequests{0};
+    /// The number of executed batches, including pass-through requests.
+    int64_t numBatches{0};
+    /// The total number of padding rows over all batches.
+    int64_t numPaddingRows{0};
+    /// The number of request rows of each batch, excluding padding.
+    Histogram batchSize;
+    /// The time from submission to completion of each request, in
+    /// microseconds.
+    Histogram latencyUs;
+  };
+
+  ~LuaDynamicBatcher();
+
+  /// Create a batcher that executes batches on `pool`. `client` allocates the
+  /// batched buffers.
+  static StatusOr<std::unique_ptr<LuaDynamicBatcher>>
+  create(RuntimeClient &client, LuaSessionPool &pool,
+         ExecutableView executable, DynamicBatchingOptions options = {});
+
+  /// Queue a request to execute the function `name`, which has the same
+  /// contract as `executeFunctionWithLuaBackend` except that the batch
+  /// extent of the memref arguments may be smaller than the extent that the
+  /// function expects. The arguments must stay alive until `callback` has
+  /// been invoked. Invalid requests are rejected immediately.
+  Status submit(std::string_view name,
+                llvm::ArrayRef<RuntimeValue *> inputArgs,
+                llvm::ArrayRef<RuntimeValue *> outputArgs, Callback callback);
+
+  /// Queue a request like `submit` and return a future for its final status.
+  std::future<Status> submit(std::string_view name,
+                             llvm::ArrayRef<RuntimeValue *> inputArgs,
+                             llvm::ArrayRef<RuntimeValue *> outputArgs);
+
+  /// Return the current values of the counters and histograms.
+  Statistics getStatistics() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    llvm::SmallVector<RuntimeValue *> inputArgs;
+    llvm::SmallVector<RuntimeValue *> outputArgs;
+    /// The extent of the batch dimension of the memref arguments.
+    int64_t numRows;
+    Callback callback;
+    Clock::time_point submitTime;
+  };
+
+  /// The batching parameters and the queue of one function.
+  struct FunctionQueue {
+    std::string name;
+    /// The largest number of rows of a batch.
+    int64_t maxBatchSize;
+    /// The smallest number of rows that a batch is padded to.
+    int64_t minBatchSize;
+    std::deque<Request> requests;
+  };
+
+  struct Batch;
+
+  LuaDynamicBatcher(RuntimeClient &client, LuaSessionPool &pool,
+                    ExecutableView executable, DynamicBatchingOptions options);
+
+  /// Return the queue of the function `name`, creating it if required.
+  /// Requires `mutex` to be held.
+  StatusOr<FunctionQueue *> getOrCreateQueue(std::string_view name);
+
+  /// Return the number of requests at the front of `queue` that form the next
+  /// batch, and whether that batch is complete (i.e. cannot grow).
+  std::pair<size_t, bool> getNextBatchSize(const FunctionQueue &queue) const;
+
+  /// The main loop of the dispatcher thread.
+  void run();
+
+  /// Gather `requests` into a batch and submit it to the pool.
+  void launch(const FunctionQueue &queue, std::vector<Request> requests);
+
+  /// Scatter the outputs of a completed batch and complete its requests.
+  void complete(Batch &batch, Status status);
+
+  /// Complete `request` with `status` and record its statistics.
+  void finish(Request &request, Status status);
+
+  RuntimeClient &client;
+  LuaSessionPool &pool;
+  ExecutableView executable;
+  DynamicBatchingOptions options;
+
+  /// Guards the queues, `numInFlightBatches` and `shuttingDown`.
+  std::mutex mutex;
+  std::condition_variable wakeCondition;
+  std::map<std::string, std::unique_ptr<FunctionQueue>, std::less<>> queues;
+  int64_t numInFlightBatches{0};
+  bool shuttingDown{false};
+  std::thread dispatcher;
+
+  /// Guards `stats`.
+  mutable std::mutex statsMutex;
+  Statistics stats;
+};
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUADYNAMICBATCHER_H
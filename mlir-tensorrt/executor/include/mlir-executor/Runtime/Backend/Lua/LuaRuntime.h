@@ -57,26 +57,88 @@ public:
   /// https://sol2.readthedocs.io/en/latest/threading.html.
   sol::state &getLuaState() { return state; }
 
-  /// Set the primary stream for the loaded executable to use.
+  /// Set the primary stream for the loaded executable to use. Changing the
+  /// stream while asynchronous executions are in flight is rejected.
   Status setCudaStream(CudaStream stream);
 
   /// Get the primary stream for the loaded executable to use.
   CudaStream getCudaStream();
 
+  /// Return the number of asynchronous executions in the session that are not
+  /// done yet.
+  unsigned getNumInFlightExecutions() const { return numInFlightExecutions; }
+
 private:
   using RuntimeSession::RuntimeSession;
+  friend class LuaRuntimeSessionTemplate;
+  friend class LuaAsyncExecution;
 
   /// The main Lua environment state.
   sol::state state;
+  /// The number of asynchronous executions that are not done yet.
+  unsigned numInFlightExecutions{0};
+};
+
+/// A `LuaRuntimeSessionTemplate` performs the session setup work that only
+/// depends on the `Executable` once, so that many sessions for the same
+/// executable can be created cheaply (e.g. one per worker thread or model
+/// replica). The template obtains the Lua bytecode (from the executable or by
+/// compiling the Lua source) and prepares the executable's constants, including
+/// the copies of misaligned constants and their `AllocTracker` entries.
+/// Sessions created from the template load the bytecode directly, bind the
+/// shared constant buffers, and resolve them through the template's tracker
+/// instead of re-tracking them.
+///
+/// Per-session work that has side effects (registering runtime modules and
+/// running `executor_init_globals`) is still performed for each session.
+/// Creating sessions only reads the template, so sessions may be created
+/// concurrently from multiple threads. The template must outlive all sessions
+/// created from it, and the executable must outlive the template.
+class LuaRuntimeSessionTemplate {
+public:
+  /// Create a template for sessions that execute `executable`. The template
+  /// compiles the executable's source to bytecode, unless
+  /// `useExecutableBytecode` is true and the executable contains compatible
+  /// bytecode (see `RuntimeSessionOptions::enableExecutableBytecode`).
+  static StatusOr<std::unique_ptr<LuaRuntimeSessionTemplate>>
+  create(ExecutableView executable, bool useExecutableBytecode = false);
+
+  /// Create a new session from the template. This is equivalent to
+  /// `LuaRuntimeSession::create` with the template's executable.
+  StatusOr<std::unique_ptr<LuaRuntimeSession>> createSession(
+      RuntimeSessionOptions options,
+      LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs =
+          {}) const;
+
+  ExecutableView getExecutable() const { return executable; }
+
+private:
+  LuaRuntimeSessionTemplate(ExecutableView executable)
+      : executable(executable) {}
+
+  ExecutableView executable;
+  /// Tracks the constant buffers. This is the parent tracker of every session
+  /// created from the template and owns any copies of misaligned constants.
+  AllocTracker constantTracker;
+  /// Pairs of (global name, pointer) for each constant.
+  llvm::SmallVector<std::pair<std::string, uintptr_t>> constants;
+  /// The Lua bytecode loaded by each session. This refers either to the
+  /// executable's bytecode section or to `ownedBytecode`.
+  std::string_view bytecode;
+  /// Bytecode compiled by the template when the executable's bytecode is not
+  /// used.
+  std::string ownedBytecode;
 };
 
 /// Convenience method that loads the given Lua script and then executes the
 /// `main` function. It is assumed that `main` takes no arguments and returns an
 /// integer result (which is returned if the execution is successful).
+/// If `profiler` is given, the execution of `main` is recorded by it.
 /// TODO: this should take a handle to a function for streaming output/errors.
 StatusOr<int64_t> runExecutorLuaScript(
     std::string_view luaScript,
-    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs = {});
+    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs = {},
+    RuntimeProfiler *profiler = nullptr);
 
 /// Synchronously run a serialized executor Executable one time. An `Executable`
 /// is essentially a Lua script packaged with metadata and serialized constants
@@ -86,20 +148,187 @@ StatusOr<int64_t> runExecutorLuaScript(
 /// the `main` function of the embedded Lua script. It is assumed that `main`
 /// takes no arguments and returns an integer result (which is returned if the
 /// execution is successful).
+/// If `profiler` is given, the execution of `main` is recorded by it.
 /// TODO: this should take a handle to a function for
 /// streaming output/errors.
 StatusOr<int64_t> runExecutorExecutable(
     std::unique_ptr<Executable> executable,
-    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs = {});
+    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs = {},
+    RuntimeProfiler *profiler = nullptr);
 
 /// Execute a named function in the session with the specified input args and
-/// output (destination args). Returns any results.
+/// output (destination args). Returns any results. If the signature aliases an
+/// output arg to a donated input arg, the same buffer must be passed for both;
+/// the donated input is consumed and holds the output after the call. The
+/// consumed inputs are given by `FunctionSignatureView::getDonatedInputArgs`.
 StatusOr<llvm::SmallVector<std::unique_ptr<RuntimeValue>>>
 executeFunctionWithLuaBackend(LuaRuntimeSession &session, std::string_view name,
                               llvm::ArrayRef<RuntimeValue *> inputArgs,
                               llvm::ArrayRef<RuntimeValue *> outputArgs,
                               std::optional<CudaStream> stream = {});
 
+//===----------------------------------------------------------------------===//
+// LuaAsyncExecution
+//===----------------------------------------------------------------------===//
+
+class LuaAsyncExecution;
+
+/// Start executing a named function in the session. This has the same
+/// contract as `executeFunctionWithLuaBackend`, except that the function runs
+/// until it first waits for device work and the returned handle is used to
+/// drive it to completion. Errors that occur after the function has started
+/// are reported through the handle.
+StatusOr<std::unique_ptr<LuaAsyncExecution>> executeFunctionWithLuaBackendAsync(
+    LuaRuntimeSession &session, std::string_view name,
+    llvm::ArrayRef<RuntimeValue *> inputArgs,
+    llvm::ArrayRef<RuntimeValue *> outputArgs,
+    std::optional<CudaStream> stream = {});
+
+/// A `LuaAsyncExecution` is the completion handle of a function invocation
+/// started by `executeFunctionWithLuaBackendAsync`. The function runs in its
+/// own Lua coroutine. Wherever the synchronous path would block the host
+/// thread until the work enqueued on a stream completes (`cuda.stream_sync`),
+/// the coroutine is suspended instead, and it is resumed by `poll` or `wait`
+/// once that work is done. This allows a single host thread to interleave
+/// many in-flight invocations, e.g. by starting one invocation in each of
+/// several sessions and polling them in turn.
+///
+/// The handle refers to the Lua state of the session and must not outlive it.
+/// The input and output arguments must stay alive until the execution is done.
+/// Invocations in the same session share the session's stream, which is read
+/// again each time a suspended invocation resumes. Therefore, while an
+/// invocation is in flight, starting another invocation of the session on a
+/// different stream is rejected; to overlap device work on several streams,
+/// use one session per in-flight invocation. Destroying the handle of an
+/// execution that is not done waits for it. Like the session, the handle is
+/// not thread-safe.
+class LuaAsyncExecution {
+public:
+  ~LuaAsyncExecution();
+
+  /// Resume the execution as long as the work it waits for has completed,
+  /// without blocking. Returns true once the execution is done.
+  bool poll();
+
+  /// Block until the execution is done and return its final status.
+  Status wait();
+
+  /// Return true if the execution is done.
+  bool isDone() const { return status.has_value(); }
+
+  /// Return the final status of the execution. The execution must be done.
+  const Status &getStatus() const {
+    assert(isDone() && "expected the execution to be done");
+    return *status;
+  }
+
+private:
+  LuaAsyncExecution(LuaRuntimeSession &session, std::string_view name,
+                    sol::thread thread, sol::coroutine coroutine);
+
+  /// Run the coroutine until it is suspended or done.
+  void resume();
+
+  /// Update the state of the execution from the result of running the
+  /// coroutine, which is either suspended or done.
+  void update(const sol::protected_function_result &result);
+
+  /// Mark the execution as done with `result`.
+  void finish(Status result);
+
+  LuaRuntimeSession &session;
+  std::string name;
+  sol::thread thread;
+  sol::coroutine coroutine;
+  /// Event recorded on the stream the coroutine waits for while suspended.
+  uintptr_t event{0};
+  std::optional<Status> status;
+  /// The profiler of the session, if profiling is enabled. Each time the
+  /// coroutine runs is recorded as a separate call of the function.
+  RuntimeProfiler *profiler{nullptr};
+
+  friend StatusOr<std::unique_ptr<LuaAsyncExecution>>
+  executeFunctionWithLuaBackendAsync(LuaRuntimeSession &, std::string_view,
+                                     llvm::ArrayRef<RuntimeValue *>,
+                                     llvm::ArrayRef<RuntimeValue *>,
+                                     std::optional<CudaStream>);
+};
+
+//===----------------------------------------------------------------------===//
+// LuaBoundFunction
+//===----------------------------------------------------------------------===//
+
+/// A `LuaBoundFunction` is a handle to a public function of a
+/// `LuaRuntimeSession` that has been resolved ahead of time. Creating the
+/// handle looks up the Lua function object, validates that the signature can be
+/// bound, and pre-allocates the Lua tables that carry MemRef descriptors. Each
+/// call then only performs cheap kind/rank/type checks and overwrites the
+/// pointer, offset, shape and stride entries of the cached tables instead of
+/// re-running the full validation and argument marshalling performed by
+/// `executeFunctionWithLuaBackend`.
+///
+/// The handle holds a reference to the session and must not outlive it. Like
+/// the session, it is not thread-safe.
+class LuaBoundFunction {
+public:
+  /// Bind the public function `name` of `session`'s executable.
+  static StatusOr<std::unique_ptr<LuaBoundFunction>>
+  create(LuaRuntimeSession &session, std::string_view name);
+
+  /// Execute the bound function. The number of arguments and their kinds,
+  /// ranks, element types, static extents, and static strides are checked
+  /// against the values cached at bind time.
+  Status execute(llvm::ArrayRef<RuntimeValue *> inputArgs,
+                 llvm::ArrayRef<RuntimeValue *> outputArgs,
+                 std::optional<CudaStream> stream = {});
+
+  /// Return the name of the bound function.
+  std::string_view getName() const { return name; }
+
+  /// Return the signature of the bound function.
+  FunctionSignatureView getSignature() const { return signature; }
+
+private:
+  /// Information about a single argument derived from the signature when the
+  /// function is bound.
+  struct ArgSlot {
+    RuntimeValue::Kind kind;
+    /// Scalar type for scalar arguments, element type for MemRef arguments.
+    ScalarTypeCode type;
+    /// Address space of MemRef arguments.
+    PointerType addressSpace{PointerType::unknown};
+    /// Rank of MemRef arguments.
+    int64_t rank{0};
+    /// Pairs of (dimension, extent) for all static dimensions of MemRef
+    /// arguments.
+    llvm::SmallVector<std::pair<unsigned, int64_t>> staticDims;
+    /// Pairs of (dimension, stride) for all static strides of MemRef
+    /// arguments.
+    llvm::SmallVector<std::pair<unsigned, int64_t>> staticStrides;
+    /// Pre-allocated descriptor table for MemRef arguments.
+    sol::table table;
+  };
+
+  LuaBoundFunction(LuaRuntimeSession &session, std::string_view name,
+                   FunctionSignatureView signature,
+                   sol::protected_function funcObj)
+      : session(session), name(name), signature(signature),
+        funcObj(std::move(funcObj)) {}
+
+  /// Update the argument at position `idx` from `value`.
+  Status updateArg(unsigned idx, RuntimeValue *value);
+
+  LuaRuntimeSession &session;
+  std::string name;
+  FunctionSignatureView signature;
+  sol::protected_function funcObj;
+  llvm::SmallVector<ArgSlot> slots;
+  /// Arguments passed under the `unpacked` calling convention.
+  llvm::SmallVector<sol::object> args;
+  /// Aggregate passed under the `packed` calling convention.
+  sol::table packedArgs;
+};
+
 } // namespace mlirtrt::runtime
 
 #endif // MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUARUNTIME_H
@@ -0,0 +1,149 @@
+//===- LuaSessionPool.h -----------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declarations for a pool of Lua runtime sessions that serves concurrent
+/// requests for a single executable.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUASESSIONPOOL_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUASESSIONPOOL_H
+
+#include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace mlirtrt::runtime {
+
+/// A `LuaSessionPool` executes function invocations ("requests") for one
+/// executable on behalf of many concurrent clients. It owns a fixed number of
+/// worker threads, each of which exclusively owns a `LuaRuntimeSession`. All
+/// sessions are created from one `LuaRuntimeSessionTemplate`, so they share the
+/// executable's constants.
+///
+/// Requests are distributed round-robin over per-worker queues. A worker
+/// executes the requests of its own queue in order; a worker whose queue is
+/// empty steals the most recently queued request of another worker. The
+/// methods of the pool may be called concurrently from any thread.
+///
+/// The executable must outlive the pool. Destroying the pool waits for all
+/// queued requests to complete.
+class LuaSessionPool {
+public:
+  /// Callback invoked with the final status of a request. It is invoked on
+  /// the worker thread that executed the request.
+  using Callback = std::function<void(Status)>;
+
+  /// A snapshot of the counters of the pool.
+  struct Statistics {
+    /// The number of sessions (and worker threads).
+    int64_t numSessions{0};
+    /// The number of requests that are queued but not yet started.
+    int64_t queueDepth{0};
+    /// The number of sessions currently executing a request.
+    int64_t numBusySessions{0};
+    /// The number of requests that have completed, successfully or not.
+    int64_t numCompletedRequests{0};
+    /// The number of requests that were executed by a worker other than the
+    /// one they were queued to.
+    int64_t numStolenRequests{0};
+  };
+
+  ~LuaSessionPool();
+
+  /// Create a pool with `numSessions` sessions for `executable`. Each session
+  /// is created with `options` and `registerExtraLuaFuncs`.
+  static StatusOr<std::unique_ptr<LuaSessionPool>>
+  create(RuntimeSessionOptions options, ExecutableView executable,
+         unsigned numSessions,
+         LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs =
+             {});
+
+  /// Queue a request to execute the function `name`, which has the same
+  /// contract as `executeFunctionWithLuaBackend`. The arguments must stay
+  /// alive until `callback` has been invoked.
+  void submit(std::string_view name, llvm::ArrayRef<RuntimeValue *> inputArgs,
+              llvm::ArrayRef<RuntimeValue *> outputArgs, Callback callback,
+              std::optional<CudaStream> stream = {});
+
+  /// Queue a request like `submit` and return a future for its final status.
+  std::future<Status> submit(std::string_view name,
+                             llvm::ArrayRef<RuntimeValue *> inputArgs,
+                             llvm::ArrayRef<RuntimeValue *> outputArgs,
+                             std::optional<CudaStream> stream = {});
+
+  /// Return the current values of the counters of the pool.
+  Statistics getStatistics() const;
+
+  /// Return the number of sessions of the pool.
+  unsigned getNumSessions() const { return workers.size(); }
+
+private:
+  struct Request {
+    std::string name;
+    llvm::SmallVector<RuntimeValue *> inputArgs;
+    llvm::SmallVector<RuntimeValue *> outputArgs;
+    std::optional<CudaStream> stream;
+    Callback callback;
+  };
+
+  struct Worker {
+    std::unique_ptr<LuaRuntimeSession> session;
+    /// Guards `queue`.
+    std::mutex mutex;
+    std::deque<Request> queue;
+    std::thread thread;
+  };
+
+  LuaSessionPool(std::unique_ptr<LuaRuntimeSessionTemplate> sessionTemplate)
+      : sessionTemplate(std::move(sessionTemplate)) {}
+
+  /// The main loop of the worker at position `index`.
+  void run(unsigned index);
+
+  /// Take the next request for the worker at position `index` from its own
+  /// queue, or steal one from another worker. Returns false if all queues are
+  /// empty.
+  bool takeRequest(unsigned index, Request &request);
+
+  std::unique_ptr<LuaRuntimeSessionTemplate> sessionTemplate;
+  llvm::SmallVector<std::unique_ptr<Worker>> workers;
+
+  /// Guards `shuttingDown` and is used with `wakeCondition` to put idle
+  /// workers to sleep.
+  std::mutex wakeMutex;
+  std::condition_variable wakeCondition;
+  bool shuttingDown{false};
+
+  /// The worker that the next request is queued to.
+  std::atomic<unsigned> nextWorker{0};
+
+  std::atomic<int64_t> queueDepth{0};
+  std::atomic<int64_t> numBusySessions{0};
+  std::atomic<int64_t> numCompletedRequests{0};
+  std::atomic<int64_t> numStolenRequests{0};
+};
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUASESSIONPOOL_H
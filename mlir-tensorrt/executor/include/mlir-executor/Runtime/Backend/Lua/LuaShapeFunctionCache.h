@@ -0,0 +1,150 @@
+//===- LuaShapeFunctionCache.h ----------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declarations for memoized evaluation of the shape functions of an
+/// executable.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUASHAPEFUNCTIONCACHE_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUASHAPEFUNCTIONCACHE_H
+
+#include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace mlirtrt::runtime {
+
+/// A `LuaShapeFunctionCache` computes the shapes of the outputs of a function
+/// before it is executed, using the shape function that is recorded in the
+/// function's signature. Results are memoized in a bounded LRU cache that is
+/// keyed by the input shapes, so that repeated input shapes do not re-run
+/// the shape function in the interpreter.
+///
+/// For each input of the function, the shape function receives either a 1-D
+/// i64 host memref holding the shape of the input, or the input itself if
+/// the types of the two arguments match (e.g. for host shape tensors and
+/// scalars). The contents of inputs of the latter kind are part of the cache
+/// key. The shape function writes the shape of each output of the function
+/// into a 1-D i64 host memref.
+///
+/// Shape functions are evaluated on `session`, which must not be used by
+/// other threads while the cache is in use. The methods of the cache may be
+/// called concurrently; the session, the client and the executable must
+/// outlive the cache.
+class LuaShapeFunctionCache {
+public:
+  /// The shape of each output of the function.
+  using OutputShapes = llvm::SmallVector<llvm::SmallVector<int64_t>>;
+
+  /// A snapshot of the counters of the cache.
+  struct Statistics {
+    int64_t numHits{0};
+    int64_t numMisses{0};
+    int64_t numEvictions{0};
+    /// The number of cached entries.
+    int64_t numEntries{0};
+  };
+
+  /// Create a cache of at most `capacity` entries for the function
+  /// `functionName` of the executable of `session`.
+  static StatusOr<std::unique_ptr<LuaShapeFunctionCache>>
+  create(RuntimeClient &client, LuaRuntimeSession &session,
+         std::string_view functionName, size_t capacity = 64);
+
+  /// Return the output shapes of a call with the given input arguments.
+  StatusOr<OutputShapes>
+  getOutputShapes(llvm::ArrayRef<RuntimeValue *> inputArgs);
+
+  /// Return the output shapes of a call whose inputs have the given shapes.
+  /// This requires that the shape function only reads the input shapes.
+  StatusOr<OutputShapes> getOutputShapesForInputShapes(
+      llvm::ArrayRef<llvm::ArrayRef<int64_t>> inputShapes);
+
+  /// Allocate the output buffers of a call with the given input arguments
+  /// through the client. Outputs in device or unified memory are allocated
+  /// on `device`.
+  StatusOr<llvm::SmallVector<std::unique_ptr<MemRefValue>>>
+  allocateOutputs(llvm::ArrayRef<RuntimeValue *> inputArgs,
+                  std::optional<const Device *> device = {},
+                  std::optional<CudaStream> stream = {});
+
+  /// Return the current values of the counters of the cache.
+  Statistics getStatistics() const;
+
+private:
+  /// How an input of the function is passed to the shape function.
+  struct InputInfo {
+    /// If true, the input itself is passed. Otherwise, its shape is passed
+    /// as a memref of `numShapeElements` elements.
+    bool passValue;
+    int64_t numShapeElements;
+  };
+
+  /// The type of an output of the function and the size of the memref that
+  /// receives its shape.
+  struct OutputInfo {
+    ScalarType elementType;
+    PointerType addressSpace;
+    int64_t rank;
+    int64_t numShapeElements;
+  };
+
+  LuaShapeFunctionCache(RuntimeClient &client, LuaRuntimeSession &session,
+                        std::string shapeFunctionName, size_t capacity,
+                        llvm::SmallVector<InputInfo> inputs,
+                        llvm::SmallVector<OutputInfo> outputs)
+      : client(client), session(session),
+        shapeFunctionName(std::move(shapeFunctionName)), capacity(capacity),
+        inputs(std::move(inputs)), outputs(std::move(outputs)) {}
+
+  /// Return the cached output shapes for `key`, or evaluate the shape
+  /// function with the inputs `inputArgs` (which may be empty if all inputs
+  /// are passed by shape) and input shapes `inputShapes`.
+  StatusOr<OutputShapes>
+  lookupOrCompute(const std::string &key,
+                  llvm::ArrayRef<llvm::ArrayRef<int64_t>> inputShapes,
+                  llvm::ArrayRef<RuntimeValue *> inputArgs);
+
+  /// Evaluate the shape function. Requires `mutex` to be held.
+  StatusOr<OutputShapes>
+  evaluate(llvm::ArrayRef<llvm::ArrayRef<int64_t>> inputShapes,
+           llvm::ArrayRef<RuntimeValue *> inputArgs);
+
+  RuntimeClient &client;
+  LuaRuntimeSession &session;
+  std::string shapeFunctionName;
+  size_t capacity;
+  llvm::SmallVector<InputInfo> inputs;
+  llvm::SmallVector<OutputInfo> outputs;
+
+  /// Guards the cache, its counters and the use of `session`.
+  mutable std::mutex mutex;
+  /// Cached entries, most recently used first.
+  std::list<std::pair<std::string, OutputShapes>> entries;
+  std::unordered_map<std::string,
+                     std::list<std::pair<std::string, OutputShapes>>::iterator>
+      index;
+  Statistics stats;
+};
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_LUA_LUASHAPEFUNCTIONCACHE_H
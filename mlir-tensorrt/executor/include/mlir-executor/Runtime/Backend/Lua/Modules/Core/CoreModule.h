@@ -31,10 +31,12 @@ struct lua_State;
 
 namespace mlirtrt::runtime {
 
-/// Register various external functions with the given Lua state.
+/// Register various external functions with the given Lua state. Strided
+/// copies between host buffers use up to `numHostCopyThreads` threads (see
+/// `executeStridedCopyOnHost`).
 void registerExecutorCoreModuleLuaRuntimeMethods(
     lua_State *lua, PinnedMemoryAllocator *pinnedMemoryAllocator,
-    AllocTracker *allocTracker);
+    AllocTracker *allocTracker, unsigned numHostCopyThreads = 1);
 
 } // namespace mlirtrt::runtime
 
@@ -0,0 +1,59 @@
+//===- NativeABI.h ----------------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Conventions shared by the Executor-to-LLVM-IR translation and the native
+/// host runtime backend that executes the resulting code.
+///
+/// Each public function `@foo` of the translated module is accompanied by an
+/// interface function named `kInterfaceFuncPrefix + "foo"` with the C
+/// signature `void(int64_t *args, int64_t *results)`. The arguments and the
+/// results of `@foo` are flattened into sequences of scalar leaves by
+/// recursively expanding tables in order. Each leaf occupies one 8-byte slot
+/// of `args` or `results` and is stored in the low-order bytes of its slot
+/// (only little-endian hosts are supported).
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVEABI_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVEABI_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace mlirtrt::runtime::native {
+
+/// Prefix of the names of the interface functions.
+inline constexpr std::string_view kInterfaceFuncPrefix =
+    "__executor_native_iface_";
+
+/// Name of the `void(const char *msg)` function that native code calls when
+/// an `executor.assert` fails. It does not return.
+inline constexpr std::string_view kAssertFailFuncName =
+    "__executor_native_assert_fail";
+
+/// Name of the `void()` function that initializes the globals, if present.
+inline constexpr std::string_view kInitGlobalsFuncName =
+    "executor_init_globals";
+
+/// Type of the interface functions.
+using InterfaceFunc = void (*)(int64_t *args, int64_t *results);
+
+} // namespace mlirtrt::runtime::native
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVEABI_H
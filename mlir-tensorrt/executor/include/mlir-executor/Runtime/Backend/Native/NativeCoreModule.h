@@ -0,0 +1,71 @@
+//===- NativeCoreModule.h ---------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declarations for the builtins of the core runtime module as provided to
+/// native code.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVECOREMODULE_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVECOREMODULE_H
+
+#include "mlir-executor/Runtime/API/API.h"
+#include "llvm/ADT/StringMap.h"
+#include <csetjmp>
+#include <string>
+
+namespace mlirtrt::runtime::native {
+
+/// The state of a call into native code. Builtins have C signatures, so they
+/// access the session through the context of the current thread.
+struct ExecutionContext {
+  AllocTracker *allocTracker{nullptr};
+  /// The maximum number of threads of strided copies between host buffers.
+  unsigned numHostCopyThreads{1};
+  /// Where `raiseError` transfers control to.
+  std::jmp_buf errorTarget;
+  /// The message of the error raised during the call, if any.
+  std::string errorMessage;
+};
+
+/// Return the context of the call into native code that is active on the
+/// current thread. This must only be used by builtins.
+ExecutionContext &getExecutionContext();
+
+/// Set the context of the active call on the current thread and return the
+/// previous one.
+ExecutionContext *setExecutionContext(ExecutionContext *context);
+
+/// Record `status` as the error of the active call if it is an error and
+/// return true in that case.
+bool recordError(const Status &status);
+
+/// Abort the active call into native code with `message`, or with the error
+/// previously recorded by `recordError` if `message` is null. Like
+/// `luaL_error`, this does not unwind the stack, so callers must not have
+/// live objects with non-trivial destructors.
+[[noreturn]] void raiseError(const char *message = nullptr);
+
+/// Add the addresses of the core module builtins and the assertion handler
+/// to `symbols`, keyed by their names.
+void registerCoreModuleSymbols(llvm::StringMap<void *> &symbols);
+
+} // namespace mlirtrt::runtime::native
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVECOREMODULE_H
@@ -0,0 +1,103 @@
+//===- NativeRuntime.h ------------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declarations for the native host runtime backend, which executes the LLVM
+/// bitcode embedded in an executable (see `-embed-native-code`) after
+/// JIT-compiling it to machine code for the host.
+///
+/// The scope of the native backend is limited to host code, and it is meant
+/// for measuring the interpreter overhead of host-only programs against the
+/// Lua backend:
+///
+/// - Only the builtins of the core runtime module are provided as C
+///   functions. The CUDA, cuBLAS, TensorRT, and NCCL modules are not, so
+///   executables that call into them are rejected by the translation, and
+///   fail to load with an unresolved symbol error if their bitcode was
+///   produced otherwise.
+/// - The backend is only available through this C++ API, the runtime
+///   benchmark, and `executor-runner -native-backend`. `RuntimeSessionOptions`
+///   has no backend selector, so the C API and the Python bindings always use
+///   the Lua backend.
+/// - It is only built with `MLIR_EXECUTOR_TARGET_NATIVE`, which is off by
+///   default.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVERUNTIME_H
+#define MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVERUNTIME_H
+
+#include "mlir-executor/Runtime/API/API.h"
+#include "mlir-executor/Runtime/Backend/Native/NativeABI.h"
+#include "mlir-executor/Support/Status.h"
+#include <string_view>
+
+namespace llvm::orc {
+class LLJIT;
+} // namespace llvm::orc
+
+namespace mlirtrt::runtime {
+
+/// A `NativeRuntimeSession` owns the JIT-compiled code of an executable.
+/// Creating the session compiles the executable's native code, binds the
+/// addresses of the executable's constants, and runs the global initializer.
+/// Like `LuaRuntimeSession`, a session is not thread-safe.
+class NativeRuntimeSession : public RuntimeSession {
+public:
+  ~NativeRuntimeSession() override;
+
+  /// Create a new session for `executable`, which must contain native code.
+  static StatusOr<std::unique_ptr<NativeRuntimeSession>>
+  create(RuntimeSessionOptions options, ExecutableView executable);
+
+  /// Return the interface function for the public function `name`.
+  StatusOr<native::InterfaceFunc>
+  lookupInterfaceFunction(std::string_view name);
+
+private:
+  using RuntimeSession::RuntimeSession;
+
+  std::unique_ptr<llvm::orc::LLJIT> jit;
+};
+
+/// Invoke the interface function `func` of `session` with the given argument
+/// and result slots. Errors raised by the runtime builtins or by failed
+/// assertions during the call are returned as an error status.
+Status invokeNativeFunction(NativeRuntimeSession &session,
+                            native::InterfaceFunc func, int64_t *args,
+                            int64_t *results);
+
+/// Execute a named function in the session with the specified input args and
+/// output (destination args). This has the same contract as
+/// `executeFunctionWithLuaBackend`, which includes rejecting functions that
+/// return results.
+StatusOr<llvm::SmallVector<std::unique_ptr<RuntimeValue>>>
+executeFunctionWithNativeBackend(NativeRuntimeSession &session,
+                                 std::string_view name,
+                                 llvm::ArrayRef<RuntimeValue *> inputArgs,
+                                 llvm::ArrayRef<RuntimeValue *> outputArgs);
+
+/// Synchronously run the native code of a serialized executor Executable one
+/// time, like `runExecutorExecutable` does for the Lua backend. It is assumed
+/// that `main` takes no arguments and returns an i32 result.
+StatusOr<int64_t>
+runExecutorExecutableWithNativeBackend(std::unique_ptr<Executable> executable);
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_BACKEND_NATIVE_NATIVERUNTIME_H
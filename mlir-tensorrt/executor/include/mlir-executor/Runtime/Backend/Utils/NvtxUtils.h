@@ -18,12 +18,19 @@
 //
 //===----------------------------------------------------------------------===//
 ///
-/// Defines macros to add NVTX tracing to several Lua VM modules.
+/// Defines macros to add NVTX tracing to several Lua VM modules. Each range
+/// is also recorded by the `RuntimeProfiler` that is active on the calling
+/// thread, if any.
 ///
 //===----------------------------------------------------------------------===//
 #ifndef MLIR_TENSORRT_RUNTIME_BACKEND_UTILS_NVTXUTILS_H
 #define MLIR_TENSORRT_RUNTIME_BACKEND_UTILS_NVTXUTILS_H
 
+#include "mlir-executor/Runtime/Support/Profiler.h"
+
+#define ADD_RUNTIME_PROFILER_SCOPE(funcName)                                   \
+  mlirtrt::runtime::RuntimeProfiler::BuiltinScope profilerScope(funcName)
+
 #ifdef MLIR_TRT_ENABLE_NVTX
 
 #if defined(__GNUC__) || defined(__clang__)
@@ -56,30 +63,34 @@ constexpr inline nvtx3::rgb CudaModuleColor() {
 } // namespace mlirtrt::runtime
 
 #define ADD_RUNTIME_MODULE_RANGE(funcName)                                     \
+  ADD_RUNTIME_PROFILER_SCOPE(funcName);                                        \
   mlirtrt::runtime::NvtxRange r(mlirtrt::runtime::tracing::RuntimeColor(),     \
                                 funcName)
 
 #define ADD_CORE_MODULE_RANGE(funcName)                                        \
+  ADD_RUNTIME_PROFILER_SCOPE(funcName);                                        \
   mlirtrt::runtime::NvtxRange r(mlirtrt::runtime::tracing::CoreModuleColor(),  \
                                 funcName)
 
 #define ADD_TENSORRT_MODULE_RANGE(funcName)                                    \
+  ADD_RUNTIME_PROFILER_SCOPE(funcName);                                        \
   mlirtrt::runtime::NvtxRange r(                                               \
       mlirtrt::runtime::tracing::TensorRTModuleColor(), funcName)
 
 #define ADD_CUDA_MODULE_RANGE(funcName)                                        \
+  ADD_RUNTIME_PROFILER_SCOPE(funcName);                                        \
   mlirtrt::runtime::NvtxRange r(mlirtrt::runtime::tracing::CudaModuleColor(),  \
                                 funcName)
 
 #else
 
-#define ADD_RUNTIME_MODULE_RANGE(funcName)
+#define ADD_RUNTIME_MODULE_RANGE(funcName) ADD_RUNTIME_PROFILER_SCOPE(funcName)
 
-#define ADD_CORE_MODULE_RANGE(funcName)
+#define ADD_CORE_MODULE_RANGE(funcName) ADD_RUNTIME_PROFILER_SCOPE(funcName)
 
-#define ADD_TENSORRT_MODULE_RANGE(funcName)
+#define ADD_TENSORRT_MODULE_RANGE(funcName) ADD_RUNTIME_PROFILER_SCOPE(funcName)
 
-#define ADD_CUDA_MODULE_RANGE(funcName)
+#define ADD_CUDA_MODULE_RANGE(funcName) ADD_RUNTIME_PROFILER_SCOPE(funcName)
 
 #endif
 
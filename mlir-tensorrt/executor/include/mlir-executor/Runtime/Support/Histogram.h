@@ -0,0 +1,115 @@
+//===- Histogram.h ----------------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// A simple bucketed histogram for runtime statistics.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_SUPPORT_HISTOGRAM
+#define MLIR_TENSORRT_RUNTIME_SUPPORT_HISTOGRAM
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+namespace mlirtrt::runtime {
+
+/// A histogram of integer samples over buckets with fixed, inclusive upper
+/// bounds. Samples larger than the last bound are counted in an additional
+/// overflow bucket. The histogram is not thread-safe.
+class Histogram {
+public:
+  /// Create a histogram with the given sorted bucket upper bounds.
+  explicit Histogram(llvm::ArrayRef<int64_t> upperBounds = {})
+      : upperBounds(upperBounds), counts(upperBounds.size() + 1, 0) {
+    assert(llvm::is_sorted(upperBounds) && "expected sorted bucket bounds");
+  }
+
+  /// Create a histogram with the buckets 1, 2, 4, ..., 2^(numBuckets - 1).
+  static Histogram getExponential(unsigned numBuckets) {
+    llvm::SmallVector<int64_t> bounds;
+    for (unsigned i = 0; i < numBuckets; ++i)
+      bounds.push_back(int64_t(1) << i);
+    return Histogram(bounds);
+  }
+
+  /// Create a histogram with the buckets 1, 2, ..., `maxValue`.
+  static Histogram getLinear(int64_t maxValue) {
+    llvm::SmallVector<int64_t> bounds;
+    for (int64_t i = 1; i <= maxValue; ++i)
+      bounds.push_back(i);
+    return Histogram(bounds);
+  }
+
+  void record(int64_t value) {
+    counts[llvm::lower_bound(upperBounds, value) - upperBounds.begin()]++;
+    numSamples++;
+    sum += value;
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+
+  /// Return the inclusive upper bounds of the buckets.
+  llvm::ArrayRef<int64_t> getUpperBounds() const { return upperBounds; }
+
+  /// Return the number of samples of each bucket. The last entry is the
+  /// overflow bucket.
+  llvm::ArrayRef<int64_t> getCounts() const { return counts; }
+
+  int64_t getNumSamples() const { return numSamples; }
+  int64_t getSum() const { return sum; }
+  int64_t getMin() const { return numSamples ? min : 0; }
+  int64_t getMax() const { return numSamples ? max : 0; }
+  double getMean() const {
+    return numSamples ? static_cast<double>(sum) / numSamples : 0.0;
+  }
+
+  /// Return an upper estimate of the given percentile (in [0, 100]), which is
+  /// the upper bound of the bucket that contains it, or the maximum sample if
+  /// that is smaller.
+  int64_t getPercentile(double percentile) const {
+    if (numSamples == 0)
+      return 0;
+    int64_t rank = std::max<int64_t>(
+        1, static_cast<int64_t>(percentile / 100.0 * numSamples + 0.5));
+    int64_t seen = 0;
+    for (unsigned i = 0; i < upperBounds.size(); ++i) {
+      seen += counts[i];
+      if (seen >= rank)
+        return std::min(upperBounds[i], max);
+    }
+    return max;
+  }
+
+private:
+  llvm::SmallVector<int64_t> upperBounds;
+  llvm::SmallVector<int64_t> counts;
+  int64_t numSamples{0};
+  int64_t sum{0};
+  int64_t min{std::numeric_limits<int64_t>::max()};
+  int64_t max{std::numeric_limits<int64_t>::min()};
+};
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_SUPPORT_HISTOGRAM
@@ -0,0 +1,209 @@
+//===- Profiler.h -----------------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// A host-side profiler for the builtins invoked by runtime functions.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_RUNTIME_SUPPORT_PROFILER
+#define MLIR_TENSORRT_RUNTIME_SUPPORT_PROFILER
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace mlirtrt::runtime {
+
+/// The `RuntimeProfiler` records the builtins (e.g. memcpy, allocation, or
+/// TensorRT enqueue functions) that are invoked by the functions of a runtime
+/// session. For each pair of (function, builtin), it aggregates the number of
+/// calls, the inclusive host time, the number of bytes moved by copies, and
+/// the number and size of allocations. Individual calls are additionally
+/// recorded as events, which can be exported in the Chrome trace format (see
+/// `chrome://tracing` or https://ui.perfetto.dev).
+///
+/// A profiler is activated for the calling thread by a `FunctionScope`, which
+/// the runtime places around the execution of each function. Builtins are
+/// instrumented with a `BuiltinScope`; when no profiler is active, a scope
+/// only reads a thread-local pointer. The profiler may be used by multiple
+/// threads at once.
+class RuntimeProfiler {
+public:
+  /// The default maximum number of events that are stored. Statistics are
+  /// still aggregated once the limit is reached.
+  static constexpr size_t kDefaultMaxNumEvents = 1 << 20;
+
+  /// Aggregated statistics for one builtin invoked by one function, or for
+  /// the function itself.
+  struct Statistics {
+    int64_t numCalls{0};
+    /// Inclusive host time of all calls.
+    int64_t totalNs{0};
+    /// Bytes moved by copies.
+    int64_t numBytes{0};
+    int64_t numAllocations{0};
+    int64_t numAllocatedBytes{0};
+  };
+
+  enum class EventKind : uint8_t { Function, Builtin, Allocation, Free };
+
+  /// A single recorded event. Times are relative to the creation of the
+  /// profiler.
+  struct Event {
+    EventKind kind;
+    /// The name of the builtin, or the function for `Function` events.
+    const char *name;
+    /// The function that was executing.
+    const char *function;
+    uint32_t threadId;
+    int64_t startNs;
+    int64_t durationNs;
+    /// Bytes moved or allocated.
+    int64_t numBytes;
+    /// The allocated or freed pointer.
+    uintptr_t ptr;
+  };
+
+  explicit RuntimeProfiler(size_t maxNumEvents = kDefaultMaxNumEvents);
+
+  /// Activates `profiler` (if not null) for the calling thread while the scope
+  /// is alive. Builtins invoked in the scope are attributed to `function`.
+  class FunctionScope {
+  public:
+    FunctionScope(RuntimeProfiler *profiler, llvm::StringRef function);
+    ~FunctionScope();
+    FunctionScope(const FunctionScope &) = delete;
+    FunctionScope &operator=(const FunctionScope &) = delete;
+
+  private:
+    RuntimeProfiler *profiler;
+    RuntimeProfiler *prevProfiler;
+    const char *prevFunction;
+    const char *function{nullptr};
+    int64_t startNs{0};
+  };
+
+  /// Records a call of the builtin `name` if a profiler is active on the
+  /// calling thread. `name` must have static storage duration.
+  class BuiltinScope {
+  public:
+    explicit BuiltinScope(const char *name)
+        : profiler(activeState.profiler), name(name) {
+      if (profiler)
+        begin();
+    }
+    ~BuiltinScope() {
+      if (profiler)
+        end();
+    }
+    BuiltinScope(const BuiltinScope &) = delete;
+    BuiltinScope &operator=(const BuiltinScope &) = delete;
+
+  private:
+    friend class RuntimeProfiler;
+    void begin();
+    void end();
+
+    RuntimeProfiler *profiler;
+    const char *name;
+    BuiltinScope *parent{nullptr};
+    int64_t startNs{0};
+    int64_t numBytes{0};
+    int64_t numAllocations{0};
+    int64_t numAllocatedBytes{0};
+  };
+
+  /// Attribute `numBytes` moved by a copy to the innermost active builtin.
+  static void recordBytes(int64_t numBytes) {
+    if (activeState.builtin)
+      activeState.builtin->numBytes += numBytes;
+  }
+
+  /// Record the allocation of `numBytes` at `ptr` by the innermost active
+  /// builtin.
+  static void recordAllocation(uintptr_t ptr, int64_t numBytes);
+
+  /// Record that `ptr` was freed by the innermost active builtin.
+  static void recordFree(uintptr_t ptr);
+
+  /// Return the statistics of `builtin` invoked by `function`. If `builtin` is
+  /// empty, return the statistics of the function itself.
+  Statistics getStatistics(llvm::StringRef function,
+                           llvm::StringRef builtin = "") const;
+
+  /// Return a copy of the recorded events.
+  std::vector<Event> getEvents() const;
+
+  /// Return the number of events that were not stored because the limit was
+  /// reached.
+  int64_t getNumDroppedEvents() const;
+
+  /// Print the recorded events as Chrome trace JSON.
+  void printChromeTrace(llvm::raw_ostream &os) const;
+
+  /// Print a table of the aggregated statistics, ordered by function and by
+  /// decreasing inclusive time.
+  void printSummary(llvm::raw_ostream &os) const;
+
+  /// Discard all statistics and events.
+  void reset();
+
+private:
+  /// The profiling state of a thread.
+  struct ThreadState {
+    RuntimeProfiler *profiler{nullptr};
+    const char *function{nullptr};
+    BuiltinScope *builtin{nullptr};
+  };
+  static thread_local ThreadState activeState;
+
+  /// Return the nanoseconds elapsed since the creation of the profiler.
+  int64_t now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - origin)
+        .count();
+  }
+
+  /// Return a pointer to a copy of `function` owned by the profiler.
+  const char *internFunctionName(llvm::StringRef function);
+
+  /// Add `delta` to the statistics of (`function`, `builtin`) and store
+  /// `event`. The caller must hold `mutex`.
+  void record(const char *function, const char *builtin,
+              const Statistics &delta, const Event &event);
+
+  const std::chrono::steady_clock::time_point origin;
+  const size_t maxNumEvents;
+
+  mutable std::mutex mutex;
+  llvm::StringSet<> functionNames;
+  /// Statistics keyed by the (function, builtin) name pointers. The builtin
+  /// is null for the statistics of the function itself.
+  llvm::DenseMap<std::pair<const char *, const char *>, Statistics> stats;
+  std::vector<Event> events;
+  int64_t numDroppedEvents{0};
+};
+
+} // namespace mlirtrt::runtime
+
+#endif // MLIR_TENSORRT_RUNTIME_SUPPORT_PROFILER
@@ -25,7 +25,10 @@
 #define MLIR_TENSORRT_SUPPORT_ALLOCATORS_H
 
 #include "mlir-executor/Support/Status.h"
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <optional>
 
 namespace mlirtrt {
 
@@ -82,6 +85,45 @@ struct EventPool {
   StatusOr<std::unique_ptr<PoolTrackedCudaEvent>> getCudaEvent();
 };
 
+//===----------------------------------------------------------------------===//
+// AllocatorBackend
+//===----------------------------------------------------------------------===//
+
+/// The interface used by the caching and pinned memory allocators to obtain
+/// and release memory.
+class AllocatorBackend {
+public:
+  virtual ~AllocatorBackend();
+
+  /// Allocate `size` bytes aligned to `alignment`. If `stream` is given, the
+  /// allocation may be stream-ordered.
+  virtual StatusOr<uintptr_t> allocate(uint64_t size, uint32_t alignment,
+                                       std::optional<CudaStream> stream) = 0;
+
+  /// Release memory previously returned by `allocate`.
+  virtual Status deallocate(uintptr_t ptr,
+                            std::optional<CudaStream> stream) = 0;
+
+  /// Wait until no pending work can access memory of this backend. The default
+  /// does nothing, which is correct if the memory is only accessed
+  /// synchronously by the host.
+  virtual Status synchronize() { return getOkStatus(); }
+};
+
+/// Create a backend that allocates host memory using `aligned_alloc`.
+std::unique_ptr<AllocatorBackend> createHostAllocatorBackend();
+
+/// Create a backend that allocates device memory using `cudaMalloc`, or
+/// `cudaMallocAsync` when a stream is given. Returns an error if MLIR-Executor
+/// was not built with CUDA enabled.
+StatusOr<std::unique_ptr<AllocatorBackend>> createCudaDeviceAllocatorBackend();
+
+/// Create a backend that allocates page-locked host memory using
+/// `cudaHostAlloc`. Returns an error if MLIR-Executor was not built with CUDA
+/// enabled.
+StatusOr<std::unique_ptr<AllocatorBackend>>
+createCudaPinnedHostAllocatorBackend();
+
 //===----------------------------------------------------------------------===//
 // PinnedMemoryAllocator
 //===----------------------------------------------------------------------===//
@@ -92,40 +134,225 @@ struct PinnedMemoryBlock {
   size_t size{0};
 };
 
-/// An allocator that manages the creation of host-pinned memory via
-/// `cudaMallocHost` and `cudaFreeHost`. It provides a synchronous `allocate`
-/// function and an asynchronous `freeAsync` function. Note that CUDA RT does
-/// not provide asynchronous host-pinned memory deallocation in the
-/// stream-ordered API as of CUDA 12.1. We create this capability by using CUDA
-/// events to know when it is save to release an allocation back into a managed
-/// pool.
+/// The interface used by `PinnedMemoryAllocator` to find out when the work
+/// that was enqueued on a stream before a block was freed has completed.
+class StreamEventSource {
+public:
+  virtual ~StreamEventSource();
+
+  /// Record an event that completes once all work currently enqueued on
+  /// `stream` has completed.
+  virtual StatusOr<CudaEvent> record(CudaStream stream) = 0;
+
+  /// Return true if `event` has completed.
+  virtual StatusOr<bool> isComplete(CudaEvent event) = 0;
+
+  /// Release an event returned by `record`.
+  virtual void release(CudaEvent event) = 0;
+};
+
+/// Create an event source backed by pooled CUDA events. Returns an error if
+/// MLIR-Executor was not built with CUDA enabled.
+StatusOr<std::unique_ptr<StreamEventSource>> createCudaStreamEventSource();
+
+/// Options for `PinnedMemoryAllocator`.
+struct PinnedMemoryAllocatorOptions {
+  /// The size of the smallest block. Must be a power of two.
+  uint64_t minBlockSize = 256;
+  /// The size of the chunks obtained from the backend and split into blocks.
+  /// Must be a power of two multiple of `minBlockSize`. Larger requests are
+  /// served by a dedicated allocation rounded up to `minBlockSize`.
+  uint64_t chunkSize = uint64_t(8) << 20;
+  /// The maximum number of pinned bytes held by the allocator, or zero for no
+  /// limit. This includes released dedicated allocations that are cached for
+  /// reuse.
+  uint64_t maxPinnedBytes = 0;
+  /// The number of completely free chunks kept for reuse. Additional free
+  /// chunks are returned to the backend.
+  unsigned maxFreeChunks = 1;
+};
+
+/// Statistics of a `PinnedMemoryAllocator`.
+struct PinnedMemoryAllocatorStats {
+  /// The number of pinned bytes obtained from the backend.
+  uint64_t bytesReserved{0};
+  /// The number of bytes of allocated blocks, including blocks whose
+  /// release is still pending.
+  uint64_t bytesAllocated{0};
+  /// The number of chunks and dedicated allocations held by the allocator.
+  uint64_t numChunks{0};
+  /// The number of frees waiting for their stream event.
+  uint64_t numPendingFrees{0};
+  /// The number of bytes of released dedicated allocations that are cached
+  /// for reuse.
+  uint64_t bytesCachedDedicated{0};
+};
+
+/// A buddy allocator for page-locked host memory. Memory is obtained from the
+/// backend in chunks, which are split into power-of-two blocks on allocation.
+/// Freed blocks are merged with their buddies, and completely free chunks
+/// beyond `maxFreeChunks` are returned to the backend. Requests larger than a
+/// chunk get dedicated allocations, which are cached by size once released
+/// and reused by later requests of a similar size. They are only returned to
+/// the backend by `trim` or when a request would exceed the budget. The
+/// allocator refuses to hold more than `maxPinnedBytes`.
+///
+/// CUDA RT does not provide asynchronous host-pinned memory deallocation in
+/// the stream-ordered API as of CUDA 12.1. `freeAsync` records an event on
+/// the stream from the `StreamEventSource`, and the block is only released
+/// once the event has completed. Pending frees are only polled when a request
+/// cannot be served from the free blocks. The memory backend and event source
+/// are pluggable, so the allocator can be used without a GPU (e.g. in tests).
+///
+/// The allocator is thread-safe.
 class PinnedMemoryAllocator {
 public:
-  PinnedMemoryAllocator();
+  /// Create an allocator that uses `cudaHostAlloc` and CUDA events.
+  PinnedMemoryAllocator(PinnedMemoryAllocatorOptions options = {});
+  PinnedMemoryAllocator(std::unique_ptr<AllocatorBackend> backend,
+                        std::unique_ptr<StreamEventSource> eventSource,
+                        PinnedMemoryAllocatorOptions options = {});
   ~PinnedMemoryAllocator();
 
   StatusOr<PinnedMemoryBlock> allocate(size_t size);
 
   /// Free the block associated with the given pointer on the given stream. An
   /// event is pushed onto the stream and the memory won't be released into the
-  /// free pool until after the stream has lapsed.
+  /// free pool until after the stream has lapsed. If the block is freed more
+  /// than once before it is released, e.g. on several streams, it is released
+  /// once all of the recorded events have completed.
   Status freeAsync(uintptr_t ptr, CudaStream stream);
 
+  /// Release the blocks whose pending frees have completed and return all
+  /// completely free chunks and cached dedicated allocations to the backend.
+  Status trim();
+
+  /// Return a snapshot of the statistics.
+  PinnedMemoryAllocatorStats getStats() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+
+//===----------------------------------------------------------------------===//
+// CachingAllocator
+//===----------------------------------------------------------------------===//
+
+/// Options for `CachingAllocator`.
+struct CachingAllocatorOptions {
+  /// The smallest size class in bytes. Every cached block is at least this
+  /// large and a multiple of it.
+  uint64_t minBlockSize = 512;
+  /// Requests larger than this many bytes bypass the cache.
+  uint64_t maxBlockSize = uint64_t(1) << 30;
+  /// The number of size classes between consecutive powers of two. Larger
+  /// values reduce internal fragmentation at the cost of fewer cache hits.
+  unsigned classesPerPowerOfTwo = 4;
+  /// The maximum number of bytes held in the cache by free blocks. When a
+  /// freed block would exceed the cap, it is returned to the backend instead.
+  uint64_t maxCachedBytes = uint64_t(1) << 30;
+  /// If set, all cached blocks are released when the allocator is used again
+  /// after having been idle for at least this long. There is no timer: an idle
+  /// allocator keeps its cache until the next `allocate`, `deallocate` or
+  /// `trim` call.
+  std::optional<std::chrono::milliseconds> idleTrimTimeout = {};
+};
+
+/// Statistics collected by a `CachingAllocator`.
+struct CachingAllocatorStats {
+  /// The number of allocation requests.
+  uint64_t numAllocations{0};
+  /// The number of allocation requests served from the cache.
+  uint64_t numCacheHits{0};
+  /// The number of allocations made through the backend.
+  uint64_t numBackendAllocations{0};
+  /// The number of bytes requested by live allocations.
+  uint64_t bytesRequested{0};
+  /// The number of bytes of the blocks backing live allocations.
+  uint64_t bytesInUse{0};
+  /// The number of bytes held by free blocks in the cache.
+  uint64_t bytesCached{0};
+  /// The peak of `bytesInUse + bytesCached`.
+  uint64_t peakBytesReserved{0};
+  /// The number of backend synchronizations before reusing blocks that were
+  /// freed without a stream.
+  uint64_t numSynchronizations{0};
+
+  /// Return the fraction of allocation requests served from the cache.
+  double getHitRate() const {
+    return numAllocations == 0 ? 0.0
+                               : static_cast<double>(numCacheHits) /
+                                     static_cast<double>(numAllocations);
+  }
+
+  /// Return the fraction of the bytes backing live allocations that is lost
+  /// to rounding up to size classes.
+  double getFragmentation() const {
+    return bytesInUse == 0 ? 0.0
+                           : 1.0 - static_cast<double>(bytesRequested) /
+                                       static_cast<double>(bytesInUse);
+  }
+};
+
+/// An allocator that caches freed blocks in size classes and reuses them for
+/// later requests of the same size class. Sizes are rounded up to one of
+/// `classesPerPowerOfTwo` classes between consecutive powers of two.
+///
+/// Reuse is stream-ordered: a block freed on a stream is only handed out again
+/// to requests on the same stream, which is safe without additional
+/// synchronization because the work on a stream executes in order. A block
+/// freed without a stream can be handed out to any request, but work on any
+/// stream may still use it, so the backend is synchronized before the block is
+/// reused (once for all blocks freed since the last synchronization). Blocks
+/// cached for other streams are only released by `trim`, which releases all
+/// blocks synchronously since their streams may have been destroyed.
+///
+/// The allocator is thread-safe.
+class CachingAllocator {
+public:
+  CachingAllocator(std::unique_ptr<AllocatorBackend> backend,
+                   CachingAllocatorOptions options = {});
+  ~CachingAllocator();
+
+  /// Allocate at least `size` bytes aligned to `alignment`.
+  StatusOr<uintptr_t> allocate(uint64_t size, uint32_t alignment,
+                               std::optional<CudaStream> stream = {});
+
+  /// Return the block of `ptr` to the cache. `ptr` must have been returned by
+  /// `allocate`.
+  Status deallocate(uintptr_t ptr, std::optional<CudaStream> stream = {});
+
+  /// Return true if `ptr` is a live allocation of this allocator.
+  bool owns(uintptr_t ptr) const;
+
+  /// Release all cached blocks to the backend.
+  Status trim();
+
+  /// Return a snapshot of the statistics.
+  CachingAllocatorStats getStats() const;
+
+  /// Return the size class that a request of `size` bytes is rounded up to.
+  uint64_t getSizeClass(uint64_t size) const;
+
+  const CachingAllocatorOptions &getOptions() const { return options; }
+
 private:
-  EventPool eventPool;
+  struct Impl;
 
-  /// Tracks all blocks allocated by the allocator.
-  struct BlockTracker;
-  std::unique_ptr<BlockTracker> blockTracker;
+  /// Release the cached blocks if the allocator has been idle for longer than
+  /// the idle timeout. Must be called with `mutex` held.
+  Status trimIfIdle();
 
-  /// Tracks the free blocks available to the allocator.
-  struct BlockSet;
-  std::unique_ptr<BlockSet> freeBlocks;
+  /// Release all cached blocks. Must be called with `mutex` held.
+  Status trimLocked();
 
-  /// Tracks the events CUDA events that must elapse before a block can be
-  /// released back into the freeBlocksSet.
-  struct BlockEventQueue;
-  std::unique_ptr<BlockEventQueue> pendingBlockEvents;
+  std::unique_ptr<AllocatorBackend> backend;
+  CachingAllocatorOptions options;
+  mutable std::mutex mutex;
+  std::unique_ptr<Impl> impl;
+  CachingAllocatorStats stats;
+  std::chrono::steady_clock::time_point lastUse;
 };
 
 } // namespace mlirtrt
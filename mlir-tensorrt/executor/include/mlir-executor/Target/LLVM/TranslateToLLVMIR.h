@@ -0,0 +1,58 @@
+//===- TranslateToLLVMIR.h --------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Declarations for the translation of Executor IR to LLVM IR for the native
+/// host runtime backend.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_TARGET_LLVM_TRANSLATETOLLVMIR_H
+#define MLIR_TENSORRT_TARGET_LLVM_TRANSLATETOLLVMIR_H
+
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include <memory>
+
+namespace llvm {
+class LLVMContext;
+class Module;
+} // namespace llvm
+
+namespace mlir {
+
+/// Translate the given module-like op, which must contain fully lowered
+/// Executor IR (the same input accepted by the Lua translation), to an LLVM
+/// module in `context`. Executor scalar and table operations are emitted as
+/// LLVM instructions, while runtime builtins (`executor.func` declarations)
+/// become calls to external C functions that the native runtime provides.
+/// See `mlir-executor/Runtime/Backend/Native/NativeABI.h` for the interface
+/// functions that are emitted for each public function.
+///
+/// Coroutines and indirect calls are not supported.
+FailureOr<std::unique_ptr<llvm::Module>>
+translateToLLVMIR(Operation *op, llvm::LLVMContext &context);
+
+/// Register the `-mlir-to-native-llvmir` translation in MLIR translation
+/// registry.
+void registerToNativeLLVMIRTranslation();
+
+} // namespace mlir
+
+#endif // MLIR_TENSORRT_TARGET_LLVM_TRANSLATETOLLVMIR_H
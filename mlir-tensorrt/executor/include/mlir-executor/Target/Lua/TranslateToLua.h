@@ -30,8 +30,26 @@
 
 namespace mlir {
 
+/// Options that control how Lua code is emitted.
+struct TranslateToLuaOptions {
+  /// If true, scalar integer and float operations on i1, i32, i64 and f64
+  /// (and f32 where the result is exact) are emitted as native Lua operators
+  /// instead of calls to the runtime's builtin functions. Other types, such as
+  /// f16, bf16, fp8 and i4, always use the builtin functions.
+  bool emitNativeArithmetic = false;
+};
+
 /// Translate the given op to Lua script and print the script to `os`.
-LogicalResult translateToLua(Operation *op, raw_ostream &os);
+LogicalResult translateToLua(Operation *op, raw_ostream &os,
+                             const TranslateToLuaOptions &options = {});
+
+/// Register command line options that populate `TranslateToLuaOptions`. This
+/// may be called multiple times.
+void registerTranslateToLuaCLOptions();
+
+/// Return the `TranslateToLuaOptions` populated from the command line. If the
+/// options were not registered, the defaults are returned.
+TranslateToLuaOptions getTranslateToLuaOptionsFromCL();
 
 /// Register the `-mlir-to-lua` translation in MLIR translation registry.
 void registerToLuaTranslation();
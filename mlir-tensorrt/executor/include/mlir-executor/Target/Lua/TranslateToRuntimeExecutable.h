@@ -25,19 +25,34 @@
 #define MLIR_TENSORRT_TARGET_LUA_TRANSLATETORUNTIMEEXECUTABLE
 
 #include "mlir-executor/Runtime/API/API.h"
+#include "mlir-executor/Target/Lua/TranslateToLua.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 
 namespace mlir {
 
+/// Options for the translation to an Executor runtime executable.
+struct TranslateToRuntimeExecutableOptions {
+  /// Options for generating the embedded Lua source.
+  TranslateToLuaOptions luaOptions;
+  /// If true, the module is additionally translated to LLVM IR and embedded in
+  /// the executable as bitcode for the native host runtime backend. This
+  /// requires that the project is built with `MLIR_EXECUTOR_TARGET_NATIVE`.
+  bool embedNativeCode = false;
+};
+
 /// Translate the given op to an Executor runtime executable.
-LogicalResult translateToRuntimeExecutable(Operation *op, raw_ostream &os);
+LogicalResult translateToRuntimeExecutable(
+    Operation *op, raw_ostream &os,
+    const TranslateToRuntimeExecutableOptions &options = {});
 
 /// Translate the given module to a Executor runtime executable, which is
-/// returned as a serialized flatbuffer.
+/// returned as a serialized flatbuffer. The embedded code is generated
+/// according to `options`.
 FailureOr<std::unique_ptr<mlirtrt::runtime::ExecutableStorage>>
-translateToRuntimeExecutable(Operation *op);
+translateToRuntimeExecutable(
+    Operation *op, const TranslateToRuntimeExecutableOptions &options = {});
 
 /// Register the `-mlir-to-executable` translation in MLIR translation registry.
 void registerToRuntimeExecutableTranslation();
@@ -228,7 +228,13 @@ void runBFSClustering(ClusteringState &state,
                       ClusteringRootTraversalDirection rootTraversalDirection =
                           ClusteringRootTraversalDirection::PreOrder);
 
-/// Merge independent clusters.
+/// Merge independent clusters. Each cluster is greedily merged with the
+/// following clusters of its block for which `shouldTryMergeClusters` returns
+/// true, as long as the merge does not create a cycle, until a fixed point is
+/// reached. Clusters are ordered by the position of their root in the block
+/// and track the earliest position of their users, so the cycle check takes
+/// amortized constant time and the candidates of a cluster are limited to the
+/// clusters before its first user.
 void mergeIndependentClusters(
     ClusteringState &state,
     ShouldMergeIndependentClustersFn shouldTryMergeClusters);
@@ -390,6 +390,18 @@ mtrtFunctionSignatureGetNumOutputArgs(MTRT_FunctionSignature signature,
   return mtrtStatusGetOk();
 }
 
+MTRT_Status
+mtrtFunctionSignatureGetOutputAlias(MTRT_FunctionSignature signature,
+                                    int64_t index, int64_t *inputIndex) {
+  FunctionSignatureView sig(unwrap(signature));
+  if (index < 0 || index >= sig.getNumOutputArgs())
+    return mtrtStatusCreate(MTRT_StatusCode::MTRT_StatusCode_InvalidArgument,
+                            "output argument index is out of range");
+  std::optional<uint32_t> alias = sig.getOutputAlias(index);
+  *inputIndex = alias ? static_cast<int64_t>(*alias) : -1;
+  return mtrtStatusGetOk();
+}
+
 MTRT_Status getTypeHelper(TypeUnionView typeUnionView, MTRT_Type *type) {
   // Allocate the TypeUnion object, populate it by moving in the
   // concrete object, and release it to be owned by the CAPI object.
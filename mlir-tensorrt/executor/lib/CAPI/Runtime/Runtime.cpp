@@ -27,6 +27,7 @@
 #include "mlir-executor/Runtime/API/API.h"
 #include "mlir-executor/Runtime/API/ExecutableFlatbuffer.h"
 #include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaSessionPool.h"
 #include "mlir-executor/Support/Status.h"
 #include "mlir/Support/FileUtilities.h"
 #include "llvm/Support/Debug.h"
@@ -58,6 +59,11 @@ DEFINE_C_API_PTR_METHODS(MTRT_Stream, MTRT_StreamImpl)
 DEFINE_C_API_PTR_METHODS(MTRT_RuntimeValue, ::mlirtrt::runtime::RuntimeValue)
 DEFINE_C_API_PTR_METHODS(MTRT_ScalarValue, ::mlirtrt::runtime::ScalarValue)
 DEFINE_C_API_PTR_METHODS(MTRT_RuntimeClient, ::mlirtrt::runtime::RuntimeClient)
+DEFINE_C_API_PTR_METHODS(MTRT_BoundFunction,
+                         ::mlirtrt::runtime::LuaBoundFunction)
+DEFINE_C_API_PTR_METHODS(MTRT_AsyncExecution,
+                         ::mlirtrt::runtime::LuaAsyncExecution)
+DEFINE_C_API_PTR_METHODS(MTRT_SessionPool, ::mlirtrt::runtime::LuaSessionPool)
 DEFINE_C_API_PTR_METHODS(MTRT_MemRefValue, ::mlirtrt::runtime::MemRefValue)
 DEFINE_C_API_PTR_METHODS(MTRT_Device, ::mlirtrt::runtime::Device)
 DEFINE_C_API_PTR_METHODS(MTRT_DLPackManagedTensor, DLManagedTensor)
@@ -696,6 +702,25 @@ mtrtRuntimeSessionOptionsDestroy(MTRT_RuntimeSessionOptions options) {
   return mtrtStatusGetOk();
 }
 
+MTRT_Status
+mtrtRuntimeSessionOptionsEnableProfiling(MTRT_RuntimeSessionOptions options,
+                                         bool enable) {
+  unwrap(options)->enableProfiling(enable);
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtRuntimeSessionOptionsSetNumHostCopyThreads(
+    MTRT_RuntimeSessionOptions options, uint32_t numThreads) {
+  unwrap(options)->setNumHostCopyThreads(numThreads);
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtRuntimeSessionOptionsEnableExecutableBytecode(
+    MTRT_RuntimeSessionOptions options, bool enable) {
+  unwrap(options)->enableExecutableBytecode(enable);
+  return mtrtStatusGetOk();
+}
+
 //===----------------------------------------------------------------------===//
 // MTRT_RuntimeSession
 //===----------------------------------------------------------------------===//
@@ -744,6 +769,228 @@ MTRT_Status mtrtRuntimeSessionExecuteFunction(
 
   return mtrtStatusGetOk();
 }
+
+/// Return the profiler of `session` or an error if profiling is disabled.
+static StatusOr<RuntimeProfiler *> getProfiler(MTRT_RuntimeSession session) {
+  RuntimeProfiler *profiler = unwrap(session)->getProfiler();
+  if (!profiler)
+    return getInvalidArgStatus(
+        "profiling is not enabled for the session; enable it in the "
+        "session options");
+  return profiler;
+}
+
+MTRT_Status mtrtRuntimeSessionPrintProfile(MTRT_RuntimeSession session,
+                                           MTRT_ProfileFormat format,
+                                           MTRT_PrintCallbackInfo callback) {
+  StatusOr<RuntimeProfiler *> profiler = getProfiler(session);
+  if (!profiler.isOk())
+    return wrap(profiler.getStatus());
+
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  if (format == MTRT_ProfileFormat_chrome_trace)
+    (*profiler)->printChromeTrace(os);
+  else
+    (*profiler)->printSummary(os);
+  os.flush();
+  callback.callback(mtrtStringViewCreate(str.data(), str.size()),
+                    callback.userData);
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtRuntimeSessionResetProfile(MTRT_RuntimeSession session) {
+  StatusOr<RuntimeProfiler *> profiler = getProfiler(session);
+  if (!profiler.isOk())
+    return wrap(profiler.getStatus());
+  (*profiler)->reset();
+  return mtrtStatusGetOk();
+}
+
+//===----------------------------------------------------------------------===//
+// MTRT_BoundFunction
+//===----------------------------------------------------------------------===//
+
+MTRT_Status mtrtRuntimeSessionBindFunction(MTRT_RuntimeSession session,
+                                           MTRT_StringView name,
+                                           MTRT_BoundFunction *result) {
+  LuaRuntimeSession *cppSession =
+      static_cast<LuaRuntimeSession *>(unwrap(session));
+  StatusOr<std::unique_ptr<LuaBoundFunction>> func = LuaBoundFunction::create(
+      *cppSession, std::string_view(name.data, name.length));
+  if (!func.isOk())
+    return wrap(func.getStatus());
+  *result = wrap(func->release());
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtBoundFunctionDestroy(MTRT_BoundFunction func) {
+  delete unwrap(func);
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtBoundFunctionExecute(MTRT_BoundFunction func,
+                                     const MTRT_RuntimeValue *inArgs,
+                                     size_t numInArgs,
+                                     const MTRT_RuntimeValue *outArgs,
+                                     size_t numOutArgs, MTRT_Stream stream) {
+  llvm::SmallVector<RuntimeValue *> inArgValues =
+      llvm::map_to_vector(llvm::ArrayRef(inArgs, numInArgs),
+                          [](MTRT_RuntimeValue arg) { return unwrap(arg); });
+  llvm::SmallVector<RuntimeValue *> outArgValues =
+      llvm::map_to_vector(llvm::ArrayRef(outArgs, numOutArgs),
+                          [](MTRT_RuntimeValue arg) { return unwrap(arg); });
+
+  Status result = unwrap(func)->execute(
+      inArgValues, outArgValues,
+      !mtrtStreamIsNull(stream) ? std::optional(unwrap(stream)->getRawStream())
+                                : std::nullopt);
+  if (!result.isOk())
+    return wrap(result);
+  return mtrtStatusGetOk();
+}
+
+//===----------------------------------------------------------------------===//
+// MTRT_AsyncExecution
+//===----------------------------------------------------------------------===//
+
+MTRT_Status mtrtRuntimeSessionExecuteFunctionAsync(
+    MTRT_RuntimeSession session, MTRT_StringView name,
+    const MTRT_RuntimeValue *inArgs, size_t numInArgs,
+    const MTRT_RuntimeValue *outArgs, size_t numOutArgs, MTRT_Stream stream,
+    MTRT_AsyncExecution *result) {
+  LuaRuntimeSession *cppSession =
+      static_cast<LuaRuntimeSession *>(unwrap(session));
+
+  llvm::SmallVector<RuntimeValue *> inArgValues =
+      llvm::map_to_vector(llvm::ArrayRef(inArgs, numInArgs),
+                          [](MTRT_RuntimeValue arg) { return unwrap(arg); });
+  llvm::SmallVector<RuntimeValue *> outArgValues =
+      llvm::map_to_vector(llvm::ArrayRef(outArgs, numOutArgs),
+                          [](MTRT_RuntimeValue arg) { return unwrap(arg); });
+
+  StatusOr<std::unique_ptr<LuaAsyncExecution>> execution =
+      executeFunctionWithLuaBackendAsync(
+          *cppSession, std::string_view(name.data, name.length), inArgValues,
+          outArgValues,
+          !mtrtStreamIsNull(stream)
+              ? std::optional(unwrap(stream)->getRawStream())
+              : std::nullopt);
+  if (!execution.isOk())
+    return wrap(execution.getStatus());
+  *result = wrap(execution->release());
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtAsyncExecutionDestroy(MTRT_AsyncExecution execution) {
+  delete unwrap(execution);
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtAsyncExecutionPoll(MTRT_AsyncExecution execution,
+                                   bool *isDone) {
+  LuaAsyncExecution *cppExecution = unwrap(execution);
+  *isDone = cppExecution->poll();
+  if (*isDone && !cppExecution->getStatus().isOk())
+    return wrap(cppExecution->getStatus());
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtAsyncExecutionWait(MTRT_AsyncExecution execution) {
+  Status result = unwrap(execution)->wait();
+  if (!result.isOk())
+    return wrap(result);
+  return mtrtStatusGetOk();
+}
+
+//===----------------------------------------------------------------------===//
+// MTRT_SessionPool
+//===----------------------------------------------------------------------===//
+
+MTRT_Status mtrtSessionPoolCreate(MTRT_RuntimeSessionOptions options,
+                                 MTRT_Executable executable,
+                                 int32_t numSessions,
+                                 MTRT_SessionPool *result) {
+  if (numSessions <= 0)
+    return wrap(getInvalidArgStatus(
+        "the number of sessions must be positive, but got {0}", numSessions));
+  StatusOr<std::unique_ptr<LuaSessionPool>> pool = LuaSessionPool::create(
+      *unwrap(options), unwrap(executable)->getView(), numSessions);
+  if (!pool.isOk())
+    return wrap(pool.getStatus());
+  *result = wrap(pool->release());
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtSessionPoolDestroy(MTRT_SessionPool pool) {
+  delete unwrap(pool);
+  return mtrtStatusGetOk();
+}
+
+/// Convert the C API arguments of a session pool request.
+static std::pair<llvm::SmallVector<RuntimeValue *>,
+                 llvm::SmallVector<RuntimeValue *>>
+unwrapRequestArgs(const MTRT_RuntimeValue *inArgs, size_t numInArgs,
+                  const MTRT_RuntimeValue *outArgs, size_t numOutArgs) {
+  return {llvm::map_to_vector(
+              llvm::ArrayRef(inArgs, numInArgs),
+              [](MTRT_RuntimeValue arg) { return unwrap(arg); }),
+          llvm::map_to_vector(
+              llvm::ArrayRef(outArgs, numOutArgs),
+              [](MTRT_RuntimeValue arg) { return unwrap(arg); })};
+}
+
+MTRT_Status mtrtSessionPoolSubmit(MTRT_SessionPool pool, MTRT_StringView name,
+                                  const MTRT_RuntimeValue *inArgs,
+                                  size_t numInArgs,
+                                  const MTRT_RuntimeValue *outArgs,
+                                  size_t numOutArgs, MTRT_Stream stream,
+                                  MTRT_SessionPoolCallback callback,
+                                  void *userData) {
+  auto [inArgValues, outArgValues] =
+      unwrapRequestArgs(inArgs, numInArgs, outArgs, numOutArgs);
+  unwrap(pool)->submit(
+      std::string_view(name.data, name.length), inArgValues, outArgValues,
+      [callback, userData](Status status) {
+        if (callback)
+          callback(status.isOk() ? mtrtStatusGetOk() : wrap(status), userData);
+      },
+      !mtrtStreamIsNull(stream) ? std::optional(unwrap(stream)->getRawStream())
+                                : std::nullopt);
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtSessionPoolExecuteFunction(MTRT_SessionPool pool,
+                                           MTRT_StringView name,
+                                           const MTRT_RuntimeValue *inArgs,
+                                           size_t numInArgs,
+                                           const MTRT_RuntimeValue *outArgs,
+                                           size_t numOutArgs,
+                                           MTRT_Stream stream) {
+  auto [inArgValues, outArgValues] =
+      unwrapRequestArgs(inArgs, numInArgs, outArgs, numOutArgs);
+  Status result =
+      unwrap(pool)
+          ->submit(std::string_view(name.data, name.length), inArgValues,
+                   outArgValues,
+                   !mtrtStreamIsNull(stream)
+                       ? std::optional(unwrap(stream)->getRawStream())
+                       : std::nullopt)
+          .get();
+  if (!result.isOk())
+    return wrap(result);
+  return mtrtStatusGetOk();
+}
+
+MTRT_Status mtrtSessionPoolGetStatistics(MTRT_SessionPool pool,
+                                         MTRT_SessionPoolStatistics *result) {
+  LuaSessionPool::Statistics stats = unwrap(pool)->getStatistics();
+  *result = MTRT_SessionPoolStatistics{
+      stats.numSessions, stats.queueDepth, stats.numBusySessions,
+      stats.numCompletedRequests, stats.numStolenRequests};
+  return mtrtStatusGetOk();
+}
+
 //===----------------------------------------------------------------------===//
 // MTRT_RuntimeClient
 //===----------------------------------------------------------------------===//
@@ -261,7 +261,7 @@ static LogicalResult convertExecutorFunctionMetadataAttrs(
         module->getContext(), argTypes, resultTypes,
         metadata.getNumOutputArgs(), metadata.getArgBounds(),
         metadata.getResultBounds(), metadata.getShapeFunc(),
-        metadata.getCconv());
+        metadata.getCconv(), metadata.getOutputAliases());
 
     func->setAttr(ExecutorDialect::kFunctionMetadataAttrName, attr);
   }
@@ -330,6 +330,42 @@ struct ReinterpretCastOpLowering
   }
 };
 
+/// Convert `memref.view` to a descriptor whose aligned pointer is the source
+/// aligned pointer advanced by the byte shift. The allocated pointer is
+/// forwarded from the source so that the result still refers to the original
+/// allocation.
+struct ConvertView : public ConvertOpToExecutorPattern<memref::ViewOp> {
+  using ConvertOpToExecutorPattern::ConvertOpToExecutorPattern;
+
+  LogicalResult
+  matchAndRewrite(memref::ViewOp op, OpAdaptor adaptor,
+                  ConversionPatternRewriter &rewriter) const override {
+    ImplicitLocOpBuilder b(op.getLoc(), rewriter);
+    MemRefType sourceType = op.getSource().getType();
+    MemRefType memrefType = op.getType();
+    FailureOr<MemRefAllocationInformation> info =
+        getMemRefAllocationInformation(b, memrefType, adaptor.getSizes());
+    if (failed(info))
+      return rewriter.notifyMatchFailure(op, "failed to get view info");
+
+    MemRefDescriptor sourceDescriptor(adaptor.getSource(), sourceType);
+    Value basePtr = sourceDescriptor.allocatedPtr(b);
+    Value sourcePtr = sourceDescriptor.alignedPtr(b);
+    Type indexType = getTypeConverter()->getIndexType();
+    Value alignedPtr = b.create<executor::IntToPtrOp>(
+        sourcePtr.getType(),
+        b.create<executor::AddIOp>(
+            b.create<executor::PtrToIntOp>(indexType, sourcePtr),
+            adaptor.getByteShift()));
+
+    rewriter.replaceOp(
+        op, {MemRefDescriptor::fromComponents(
+                b, *getTypeConverter(), memrefType, basePtr, alignedPtr,
+                createIndexConstant(b, 0), info->sizes, info->strides)});
+    return success();
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // Global lowerings
 //===----------------------------------------------------------------------===//
@@ -538,8 +574,8 @@ void executor::populateMemRefToExecutorPatterns(
     RewritePatternSet &patterns, ExecutorTypeConverter &typeConverter,
     bool allowUncheckedMemrefCastConversion) {
   patterns.add<ConvertLoad, ConvertStore, ConvertAlloc,
-               ReinterpretCastOpLowering, ConvertExtractMetadata, ConvertDim,
-               ConvertMemRefCopy, ConvertMemRefCopyStrided2D,
+               ReinterpretCastOpLowering, ConvertView, ConvertExtractMetadata,
+               ConvertDim, ConvertMemRefCopy, ConvertMemRefCopyStrided2D,
                ConvertMemRefDealloc, ConvertMemrefGlobal,
                ConvertMemrefGetGlobal, ConvertExtractAlignedPointerAsIndex>(
       typeConverter, patterns.getContext());
@@ -34,6 +34,7 @@
 #include "mlir/Interfaces/MemorySlotInterfaces.h"
 #include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Transforms/InliningUtils.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -170,10 +171,28 @@ LogicalResult executor::FunctionMetadataAttr::verify(
     function_ref<InFlightDiagnostic()> emitError, ArrayRef<Type> args,
     ArrayRef<Type> results, int64_t nbOutArgs, ArrayRef<Attribute> argBounds,
     ArrayRef<Attribute> resBounds, FlatSymbolRefAttr shapeFuncName,
-    CallingConvention callingConvention) {
+    CallingConvention callingConvention, DenseI64ArrayAttr outputAliases) {
   if (nbOutArgs < 0)
     return emitError() << "Number of output arguments must be non-negative";
 
+  if (outputAliases) {
+    if (outputAliases.size() != nbOutArgs)
+      return emitError()
+             << "Size of output aliases and number of output args must be same";
+    int64_t numInputArgs = static_cast<int64_t>(args.size()) - nbOutArgs;
+    llvm::SmallDenseSet<int64_t> donatedArgs;
+    for (int64_t alias : outputAliases.asArrayRef()) {
+      if (alias == -1)
+        continue;
+      if (alias < 0 || alias >= numInputArgs)
+        return emitError() << "Output alias " << alias
+                           << " does not refer to an input argument";
+      if (!donatedArgs.insert(alias).second)
+        return emitError() << "Input argument " << alias
+                           << " is donated to more than one output argument";
+    }
+  }
+
   // Check sizes of arguments and bounds.
   if (args.size() != argBounds.size())
     return emitError() << "Size of args and arg bounds must be same";
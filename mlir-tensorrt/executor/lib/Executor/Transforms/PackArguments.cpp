@@ -171,7 +171,7 @@ public:
           ctx, metadata.getArgs(), metadata.getResults(),
           metadata.getNumOutputArgs(), metadata.getArgBounds(),
           metadata.getResultBounds(), metadata.getShapeFunc(),
-          CallingConvention::packed);
+          CallingConvention::packed, metadata.getOutputAliases());
       newFunc->setAttr(ExecutorDialect::kFunctionMetadataAttrName, attr);
 
       rewriter.eraseOp(func);
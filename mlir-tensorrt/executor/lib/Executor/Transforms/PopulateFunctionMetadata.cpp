@@ -61,13 +61,38 @@ static LogicalResult createFunctionMetadata(func::FuncOp funcOp) {
     resAttr.push_back(executor::getFuncResultBounds(funcOp, idx));
   }
 
+  // Input arguments donated to an output argument carry the index of that
+  // output argument.
+  SmallVector<int64_t> outputAliases(numOutputArgs, -1);
+  bool hasOutputAliases = false;
+  for (BlockArgument arg : funcOp.getArguments()) {
+    auto aliasAttr = funcOp.getArgAttrOfType<IntegerAttr>(
+        arg.getArgNumber(), ExecutorDialect::kAliasingOutputAttrName);
+    if (!aliasAttr)
+      continue;
+    int64_t outputIdx = aliasAttr.getInt();
+    if (outputIdx < 0 || outputIdx >= numOutputArgs)
+      return funcOp.emitError()
+             << "argument #" << arg.getArgNumber()
+             << " is donated to output argument #" << outputIdx
+             << ", but the function has " << numOutputArgs
+             << " output arguments";
+    outputAliases[outputIdx] = arg.getArgNumber();
+    hasOutputAliases = true;
+  }
+  DenseI64ArrayAttr outputAliasesAttr =
+      hasOutputAliases
+          ? DenseI64ArrayAttr::get(funcOp.getContext(), outputAliases)
+          : DenseI64ArrayAttr();
+
   auto shapeSymAttr = funcOp->getAttrOfType<FlatSymbolRefAttr>(
       executor::ExecutorDialect::kShapeFuncAttrName);
   auto metadataAttr = executor::FunctionMetadataAttr::getChecked(
       mlir::detail::getDefaultDiagnosticEmitFn(funcOp.getLoc()),
       funcOp.getContext(), ArrayRef<Type>(argTypes),
       ArrayRef<Type>(resultTypes), numOutputArgs, ArrayRef<Attribute>(argAttr),
-      ArrayRef<Attribute>(resAttr), shapeSymAttr, CallingConvention::unpacked);
+      ArrayRef<Attribute>(resAttr), shapeSymAttr, CallingConvention::unpacked,
+      outputAliasesAttr);
 
   if (!metadataAttr)
     return funcOp.emitError()
@@ -24,8 +24,10 @@
 #include "mlir-executor/Support/CUDAWrappers.h"
 #include "mlir-executor/Support/Status.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Threading.h"
@@ -145,6 +147,40 @@ static bool isHostVisible(PointerType type) {
   return !isDeviceVisible(type) || type == PointerType::unified;
 }
 
+//===----------------------------------------------------------------------===//
+// ConstantView
+//===----------------------------------------------------------------------===//
+
+void ConstantView::decode(void *dest) const {
+  char *out = static_cast<char *>(dest);
+  switch (getEncoding()) {
+  case ConstantEncoding::raw:
+    std::memcpy(out, data(), size());
+    return;
+  case ConstantEncoding::splat: {
+    size_t elementSize = size();
+    size_t decodedSize = getDecodedSize();
+    assert(elementSize > 0 && decodedSize % elementSize == 0 &&
+           "expected decoded size to be a multiple of the element size");
+    if (decodedSize == 0)
+      return;
+    if (elementSize == 1) {
+      std::memset(out, *data(), decodedSize);
+      return;
+    }
+    // Write the first element, then keep doubling the initialized prefix.
+    std::memcpy(out, data(), elementSize);
+    for (size_t filled = elementSize; filled < decodedSize;) {
+      size_t count = std::min(filled, decodedSize - filled);
+      std::memcpy(out + filled, out, count);
+      filled += count;
+    }
+    return;
+  }
+  }
+  llvm_unreachable("unknown constant encoding");
+}
+
 //===----------------------------------------------------------------------===//
 // ExecutableView
 //===----------------------------------------------------------------------===//
@@ -180,6 +216,26 @@ llvm::SmallVector<FunctionView> ExecutableView::getFunctions() const {
 // ExecutableStorage (Implementations)
 //===----------------------------------------------------------------------===//
 
+/// Copy `size` bytes from `data` into a new buffer whose alignment allows the
+/// constants of a serialized executable to be used in place.
+static StatusOr<std::unique_ptr<llvm::WritableMemoryBuffer>>
+copyToAlignedBuffer(const void *data, size_t size) {
+  std::unique_ptr<llvm::WritableMemoryBuffer> alignedBuffer =
+      llvm::WritableMemoryBuffer::getNewUninitMemBuffer(
+          size, "", llvm::Align(kExecutableConstantAlignment));
+  if (!alignedBuffer)
+    return getInternalErrorStatus("failed to create uninitialized memory "
+                                  "buffer of size {0} with alignment {1}",
+                                  size, kExecutableConstantAlignment);
+  std::memcpy(alignedBuffer->getBufferStart(), data, size);
+  return alignedBuffer;
+}
+
+/// Return a copy of `size` bytes at `data` as `ExecutableStorage`, or nullptr
+/// if the allocation fails.
+static std::unique_ptr<ExecutableStorage> copyToStorage(const void *data,
+                                                        size_t size);
+
 namespace {
 class ExecutableStorageMemBuffer : public ExecutableStorage {
 public:
@@ -187,9 +243,7 @@ public:
       : storage(std::move(storage)) {}
 
   std::unique_ptr<ExecutableStorage> getCopy() const final {
-    return std::make_unique<ExecutableStorageMemBuffer>(
-        llvm::MemoryBuffer::getMemBufferCopy(
-            storage->getBuffer(), storage->getBufferIdentifier() + "_copy"));
+    return copyToStorage(storage->getBufferStart(), storage->getBufferSize());
   }
   const void *data() const final { return storage->getBuffer().data(); }
   size_t size() const final { return storage->getBufferSize(); }
@@ -197,8 +251,33 @@ public:
 private:
   std::unique_ptr<llvm::MemoryBuffer> storage;
 };
+
+/// An `ExecutableStorage` backed by a read-only memory mapping of a file.
+class ExecutableStorageMappedFile : public ExecutableStorage {
+public:
+  ExecutableStorageMappedFile(llvm::sys::fs::mapped_file_region region)
+      : region(std::move(region)) {}
+
+  std::unique_ptr<ExecutableStorage> getCopy() const final {
+    return copyToStorage(region.const_data(), region.size());
+  }
+  const void *data() const final { return region.const_data(); }
+  size_t size() const final { return region.size(); }
+
+private:
+  llvm::sys::fs::mapped_file_region region;
+};
 } // namespace
 
+static std::unique_ptr<ExecutableStorage> copyToStorage(const void *data,
+                                                        size_t size) {
+  StatusOr<std::unique_ptr<llvm::WritableMemoryBuffer>> buffer =
+      copyToAlignedBuffer(data, size);
+  if (!buffer.isOk())
+    return nullptr;
+  return std::make_unique<ExecutableStorageMemBuffer>(std::move(*buffer));
+}
+
 //===----------------------------------------------------------------------===//
 // Executable
 //===----------------------------------------------------------------------===//
@@ -209,17 +288,58 @@ Executable::Executable(Executable &&other)
   this->view = impl::GetExecutable(this->storage->data());
 }
 
+/// Map the file at `path` into memory.
+static StatusOr<std::unique_ptr<ExecutableStorage>>
+mapFile(std::string_view path) {
+  llvm::Expected<llvm::sys::fs::file_t> file =
+      llvm::sys::fs::openNativeFileForRead(llvm::StringRef(path));
+  if (!file)
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "error loading executable from file: ",
+                            llvm::toString(file.takeError()));
+  auto closeFile =
+      llvm::make_scope_exit([&]() { llvm::sys::fs::closeFile(*file); });
+
+  llvm::sys::fs::file_status status;
+  if (std::error_code ec = llvm::sys::fs::status(*file, status))
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "error loading executable from file: ",
+                            ec.message());
+  if (status.getSize() == 0)
+    return getInvalidArgStatus("executable file \"{0}\" is empty",
+                               std::string(path));
+
+  std::error_code ec;
+  llvm::sys::fs::mapped_file_region region(
+      *file, llvm::sys::fs::mapped_file_region::readonly, status.getSize(),
+      /*offset=*/0, ec);
+  if (ec)
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "error mapping executable file: ", ec.message());
+  return std::unique_ptr<ExecutableStorage>(
+      std::make_unique<ExecutableStorageMappedFile>(std::move(region)));
+}
+
 StatusOr<std::unique_ptr<Executable>>
 Executable::loadFromFile(std::string_view path) {
-  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
-      llvm::MemoryBuffer::getFileOrSTDIN(path);
-  if (!buffer)
-    return getStatusWithMsg(
-        StatusCode::InternalError,
-        "error loading executable from file: ", buffer.getError().message());
+  std::unique_ptr<ExecutableStorage> storage;
+  if (path == "-") {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+        llvm::MemoryBuffer::getSTDIN();
+    if (!buffer)
+      return getStatusWithMsg(
+          StatusCode::InternalError,
+          "error loading executable from file: ", buffer.getError().message());
+    MTRT_ASSIGN_OR_RETURN(std::unique_ptr<llvm::WritableMemoryBuffer> copy,
+                          copyToAlignedBuffer((*buffer)->getBufferStart(),
+                                              (*buffer)->getBufferSize()));
+    storage = std::make_unique<ExecutableStorageMemBuffer>(std::move(copy));
+  } else {
+    MTRT_ASSIGN_OR_RETURN(storage, mapFile(path));
+  }
 
-  auto result = std::unique_ptr<Executable>(new Executable(
-      std::make_unique<ExecutableStorageMemBuffer>(std::move(*buffer))));
+  auto result =
+      std::unique_ptr<Executable>(new Executable(std::move(storage)));
 
   flatbuffers::Verifier verifier(
       reinterpret_cast<const uint8_t *>(result->getStorage()->data()),
@@ -248,17 +368,10 @@ Executable::loadFromBuffer(std::unique_ptr<llvm::MemoryBuffer> buffer) {
 
 StatusOr<std::unique_ptr<Executable>>
 Executable::loadFromUnalignedRef(llvm::ArrayRef<char> data) {
-  const llvm::Align alignment(16);
-  std::unique_ptr<llvm::WritableMemoryBuffer> alignedBuffer =
-      llvm::WritableMemoryBuffer::getNewUninitMemBuffer(data.size(), "",
-                                                        alignment);
-  // `getNewUninitMemBuffer` will return null on failure.
-  if (!alignedBuffer)
-    return getInvalidArgStatus("failed to create uninitizlied memory buffer of "
-                               "size {0} with alignment {1}",
-                               data.size(), alignment.value());
+  MTRT_ASSIGN_OR_RETURN(
+      std::unique_ptr<llvm::WritableMemoryBuffer> alignedBuffer,
+      copyToAlignedBuffer(data.data(), data.size()));
 
-  llvm::copy(data, alignedBuffer->getBuffer().begin());
   auto result = std::make_unique<Executable>(
       std::make_unique<ExecutableStorageMemBuffer>(std::move(alignedBuffer)));
 
@@ -281,14 +394,11 @@ rt::Executable::Executable(std::unique_ptr<ExecutableStorage> storage_)
 
 Executable::~Executable() {}
 
-std::unique_ptr<Executable> Executable::getCopy() const {
-  std::unique_ptr<llvm::WritableMemoryBuffer> alignedBuffer =
-      llvm::WritableMemoryBuffer::getNewUninitMemBuffer(storage->size(), "",
-                                                        llvm::Align(16));
-  std::copy_n(reinterpret_cast<const char *>(storage->data()), storage->size(),
-              alignedBuffer->getBuffer().begin());
+StatusOr<std::unique_ptr<Executable>> Executable::getCopy() const {
+  MTRT_ASSIGN_OR_RETURN(std::unique_ptr<llvm::WritableMemoryBuffer> buffer,
+                        copyToAlignedBuffer(storage->data(), storage->size()));
   return std::make_unique<Executable>(
-      std::make_unique<ExecutableStorageMemBuffer>(std::move(alignedBuffer)));
+      std::make_unique<ExecutableStorageMemBuffer>(std::move(buffer)));
 }
 
 //===----------------------------------------------------------------------===//
@@ -359,25 +469,33 @@ RuntimeSession::RuntimeSession(RuntimeSessionOptions options,
                                ExecutableView exe)
     : options(std::move(options)), executable(exe),
       pinnedMemoryAllocator(std::make_unique<PinnedMemoryAllocator>()),
-      allocTracker(std::make_unique<AllocTracker>()),
-      resourceTracker(std::make_unique<ResourceTracker>()) {}
+      allocTracker(std::make_unique<AllocTracker>(/*threadSafe=*/false)),
+      resourceTracker(std::make_unique<ResourceTracker>()) {
+  for (PointerType type : {PointerType::host, PointerType::device})
+    allocTracker->setCachingAllocator(
+        type, this->options.getCachingAllocator(type));
+  if (this->options.isProfilingEnabled())
+    profiler = std::make_unique<RuntimeProfiler>();
+}
 
 //===----------------------------------------------------------------------===//
 // AllocTracker
 //===----------------------------------------------------------------------===//
 
 AllocTracker::~AllocTracker() {
-  MTRT_DBGF("checking %u allocations", map.size());
   llvm::SmallVector<PointerInfo> ptrsToFree;
-  ptrsToFree.reserve(map.size());
-  for (const auto &[ptrVal, metadata] : map) {
-    if (metadata->info.isInternallyManaged() &&
-        metadata->externalReferenceCount.load() == 0) {
-      MTRT_DBGF("still live: 0x%lx type %d size %lu", ptrVal,
-                static_cast<int>(metadata->info.type), metadata->info.size);
-      ptrsToFree.push_back(metadata->info);
+  for (Shard &shard : shards) {
+    auto lock = lockShard<std::shared_lock<std::shared_mutex>>(shard.mutex);
+    for (const auto &[ptrVal, metadata] : shard.map) {
+      if (metadata->info.isInternallyManaged() &&
+          metadata->externalReferenceCount.load() == 0) {
+        MTRT_DBGF("still live: 0x%lx type %d size %lu", ptrVal,
+                  static_cast<int>(metadata->info.type), metadata->info.size);
+        ptrsToFree.push_back(metadata->info);
+      }
     }
   }
+  MTRT_DBGF("checked allocations, %lu still live", ptrsToFree.size());
 
   size_t totalSize = 0;
   for (const PointerInfo &ptr : ptrsToFree) {
@@ -391,107 +509,268 @@ AllocTracker::~AllocTracker() {
     MTRT_DBGF("freed %zu bytes of unfreed memory", totalSize);
 }
 
+template <typename Fn>
+auto AllocTracker::withMetadata(uintptr_t ptr, Fn &&fn) const {
+  const Shard &shard = getShard(ptr);
+  auto lock = lockShard<std::shared_lock<std::shared_mutex>>(shard.mutex);
+  auto it = shard.map.find(ptr);
+  // The metadata is only changed through atomics, so a shared lock suffices.
+  return fn(it == shard.map.end() ? nullptr : it->second.get());
+}
+
 void AllocTracker::markReleasedInternally(uintptr_t ptr) {
-  assert(llvm::is_contained(map, ptr) &&
-         llvm::formatv("Untracked pointer {0}", ptr).str().c_str());
-  std::unique_ptr<Metadata> const &metadata = map.at(ptr);
-  metadata->releasedInternally = true;
+  withMetadata(ptr, [&](Metadata *metadata) {
+    if (!metadata) {
+      MTRT_DBGF("ignoring release of untracked pointer 0x%lx", ptr);
+      return;
+    }
+    metadata->releasedInternally = true;
+  });
 }
 
 bool AllocTracker::isReleasedInternally(uintptr_t ptr) const {
-  assert(llvm::is_contained(map, ptr) &&
-         llvm::formatv("Untracked pointer {0}", ptr).str().c_str());
-  std::unique_ptr<Metadata> const &metadata = map.at(ptr);
-  return metadata->releasedInternally;
+  std::optional<bool> released =
+      withMetadata(ptr, [](Metadata *metadata) -> std::optional<bool> {
+        if (!metadata)
+          return std::nullopt;
+        return metadata->releasedInternally.load();
+      });
+  if (released)
+    return *released;
+  return parent && parent->isReleasedInternally(ptr);
 }
 
 void AllocTracker::incrementExternalCount(uintptr_t ptr) {
-  assert(llvm::is_contained(map, ptr) &&
-         llvm::formatv("Untracked pointer {0}", ptr).str().c_str());
-  std::unique_ptr<Metadata> const &metadata = map.at(ptr);
-  int32_t ref = ++metadata->externalReferenceCount;
-  MTRT_DBG("Incremented external reference for pointer %d to %d", ptr, ref);
+  withMetadata(ptr, [&](Metadata *metadata) {
+    if (!metadata) {
+      MTRT_DBGF("ignoring reference to untracked pointer 0x%lx", ptr);
+      return;
+    }
+    int32_t ref = ++metadata->externalReferenceCount;
+    MTRT_DBG("Incremented external reference for pointer %d to %d", ptr, ref);
+  });
 }
 
 void AllocTracker::decrementExternalCount(uintptr_t ptr) {
-  assert(llvm::is_contained(map, ptr) &&
-         llvm::formatv("Untracked pointer {0}", ptr).str().c_str());
-  std::unique_ptr<Metadata> const &metadata = map.at(ptr);
-  int32_t ref = --metadata->externalReferenceCount;
-  assert(ref >= 0 &&
-         llvm::formatv("External reference count cannot be negative: {0}", ref)
-             .str()
-             .c_str());
-  MTRT_DBG("Decremented external reference for pointer %d to %d", ptr, ref);
-  if (ref == 0 && metadata->releasedInternally) {
-    MTRT_DBG("External reference to an internally released pointer %d is 0, "
-             "try deallocating pointer memory of size %lu",
-             ptr, ref, metadata->info.size);
-    Status s = safeDeallocate(*this, metadata->info.ptr);
-    if (!s.isOk())
-      MTRT_DBGF("error while deallocating dangling memory: %s",
-                s.getString().c_str());
-  }
+  bool shouldDeallocate = withMetadata(ptr, [&](Metadata *metadata) {
+    if (!metadata) {
+      MTRT_DBGF("ignoring dereference of untracked pointer 0x%lx", ptr);
+      return false;
+    }
+    int32_t ref = metadata->externalReferenceCount.load();
+    do {
+      if (ref == 0) {
+        MTRT_DBGF("ignoring dereference of unreferenced pointer 0x%lx", ptr);
+        return false;
+      }
+    } while (
+        !metadata->externalReferenceCount.compare_exchange_weak(ref, ref - 1));
+    MTRT_DBG("Decremented external reference for pointer %d to %d", ptr,
+             ref - 1);
+    return ref == 1 && metadata->releasedInternally.load();
+  });
+  // The lock is released first, since `safeDeallocate` untracks the pointer.
+  if (!shouldDeallocate)
+    return;
+  MTRT_DBG("External reference to an internally released pointer %d is 0, "
+           "try deallocating pointer memory",
+           ptr);
+  Status s = safeDeallocate(*this, ptr);
+  if (!s.isOk())
+    MTRT_DBGF("error while deallocating dangling memory: %s",
+              s.getString().c_str());
 }
 
 int32_t AllocTracker::getExternalReferenceCount(uintptr_t ptr) const {
-  assert(llvm::is_contained(map, ptr) &&
-         llvm::formatv("Untracked pointer {0}", ptr).str().c_str());
-  std::unique_ptr<Metadata> const &metadata = map.at(ptr);
-  return metadata->externalReferenceCount.load();
+  std::optional<int32_t> count =
+      withMetadata(ptr, [](Metadata *metadata) -> std::optional<int32_t> {
+        if (!metadata)
+          return std::nullopt;
+        return metadata->externalReferenceCount.load();
+      });
+  if (count)
+    return *count;
+  return parent ? parent->getExternalReferenceCount(ptr) : 0;
 }
 
 void AllocTracker::track(PointerInfo info) {
-  if (info.isInternallyManaged()) {
-    // We issue an assertion error if we somehow have double-tracked this
-    // pointer (perhaps the `untrack` was not correctly called). Note that we
-    // may have previously tracked this pointer as an externally managed pointer
-    // (e.g. function argument), in which case it may have been deallocated,
-    // allowing an internal allocator to pick up that same address. That case is
-    // not an error.
-    assert((!contains(info.ptr) || get(info.ptr).isExternallyManaged()) &&
-           "an internally managed pointer should not already be tracked");
-  }
   MTRT_DBGF("AllocTracker is now tracking 0x%lx size=%lu space=%s ownership=%s",
             info.ptr, info.size, runtime::impl::EnumNamePointerType(info.type),
             runtime::impl::EnumNamePointerOwner(info.owner));
   auto value = std::make_unique<Metadata>();
-  value->externalReferenceCount.store(0);
-  value->releasedInternally = false;
   value->info = info;
-  if (!contains(info.ptr)) {
-    map.insert(std::make_pair(info.ptr, std::move(value)));
-    return;
-  }
-  untrack(info.ptr);
-  map.insert(std::make_pair(info.ptr, std::move(value)));
+
+  Shard &shard = getShard(info.ptr);
+  auto lock = lockShard<std::unique_lock<std::shared_mutex>>(shard.mutex);
+  std::unique_ptr<Metadata> &entry = shard.map[info.ptr];
+  // We issue an assertion error if we somehow have double-tracked this
+  // pointer (perhaps the `untrack` was not correctly called). Note that we
+  // may have previously tracked this pointer as an externally managed pointer
+  // (e.g. function argument), in which case it may have been deallocated,
+  // allowing an internal allocator to pick up that same address. That case is
+  // not an error.
+  assert((!info.isInternallyManaged() || !entry ||
+          entry->info.isExternallyManaged()) &&
+         "an internally managed pointer should not already be tracked");
+  if (entry)
+    recordUntracked(entry->info);
+  entry = std::move(value);
+  recordTracked(info);
 }
 
 void AllocTracker::untrack(uintptr_t ptr) {
-  assert(llvm::is_contained(map, ptr) &&
+  Shard &shard = getShard(ptr);
+  auto lock = lockShard<std::unique_lock<std::shared_mutex>>(shard.mutex);
+  auto it = shard.map.find(ptr);
+  assert(it != shard.map.end() &&
          llvm::formatv("Untracked pointer {0}", ptr).str().c_str());
-  map.erase(map.find(ptr));
+  recordUntracked(it->second->info);
+  shard.map.erase(it);
+}
+
+void AllocTracker::recordTracked(const PointerInfo &info) {
+  if (!info.isInternallyManaged() || !info.hasKnownSize())
+    return;
+  Counters &counter = counters[static_cast<size_t>(info.type)];
+  counter.numAllocations++;
+  int64_t numBytes = counter.numBytes += static_cast<int64_t>(info.size);
+  int64_t peakBytes = counter.peakBytes.load();
+  while (numBytes > peakBytes &&
+         !counter.peakBytes.compare_exchange_weak(peakBytes, numBytes))
+    ;
+}
+
+void AllocTracker::recordUntracked(const PointerInfo &info) {
+  if (!info.isInternallyManaged() || !info.hasKnownSize())
+    return;
+  counters[static_cast<size_t>(info.type)].numBytes -=
+      static_cast<int64_t>(info.size);
+}
+
+AllocTracker::Statistics AllocTracker::getStatistics(PointerType type) const {
+  const Counters &counter = counters[static_cast<size_t>(type)];
+  Statistics stats;
+  stats.numAllocations = counter.numAllocations.load();
+  stats.numBytes = counter.numBytes.load();
+  stats.peakBytes = counter.peakBytes.load();
+  return stats;
+}
+
+void AllocTracker::resetStatistics() {
+  for (Counters &counter : counters) {
+    counter.numAllocations = 0;
+    counter.peakBytes = counter.numBytes.load();
+  }
 }
 
-bool AllocTracker::contains(uintptr_t ptr) const { return map.contains(ptr); }
+bool AllocTracker::contains(uintptr_t ptr) const {
+  bool isTracked =
+      withMetadata(ptr, [](Metadata *metadata) { return metadata != nullptr; });
+  return isTracked || (parent && parent->contains(ptr));
+}
 
-const PointerInfo &AllocTracker::get(uintptr_t ptr) const {
-  auto it = map.find(ptr);
-  assert(it != map.end() && "expected valid pointer info");
-  return map.at(ptr)->info;
+bool AllocTracker::isTrackedByParent(uintptr_t ptr) const {
+  if (!parent)
+    return false;
+  bool isTracked =
+      withMetadata(ptr, [](Metadata *metadata) { return metadata != nullptr; });
+  return !isTracked && parent->contains(ptr);
+}
+
+PointerInfo AllocTracker::get(uintptr_t ptr) const {
+  std::optional<PointerInfo> info =
+      withMetadata(ptr, [](Metadata *metadata) -> std::optional<PointerInfo> {
+        if (!metadata)
+          return std::nullopt;
+        return metadata->info;
+      });
+  if (!info && parent)
+    return parent->get(ptr);
+  assert(info && "expected valid pointer info");
+  return *info;
 }
 
 PointerInfo AllocTracker::lookupOrDefault(uintptr_t ptr) const {
-  if (!contains(ptr))
-    return PointerInfo{ptr, PointerInfo::kUnknownSize, PointerType::unknown,
-                       PointerOwner::unknown};
-  return map.at(ptr)->info;
+  std::optional<PointerInfo> info =
+      withMetadata(ptr, [](Metadata *metadata) -> std::optional<PointerInfo> {
+        if (!metadata)
+          return std::nullopt;
+        return metadata->info;
+      });
+  if (info)
+    return *info;
+  if (parent)
+    return parent->lookupOrDefault(ptr);
+  return PointerInfo{ptr, PointerInfo::kUnknownSize, PointerType::unknown,
+                     PointerOwner::unknown};
+}
+
+void AllocTracker::setCachingAllocator(
+    PointerType type, std::shared_ptr<CachingAllocator> allocator) {
+  assert((type == PointerType::host || type == PointerType::device) &&
+         "only host and device allocations can be cached");
+  (type == PointerType::host ? hostAllocator : deviceAllocator) =
+      std::move(allocator);
+}
+
+CachingAllocator *AllocTracker::getCachingAllocator(PointerType type) const {
+  if (type == PointerType::host)
+    return hostAllocator.get();
+  if (type == PointerType::device)
+    return deviceAllocator.get();
+  return nullptr;
+}
+
+StatusOr<std::shared_ptr<CachingAllocator>>
+runtime::createCachingAllocator(PointerType type,
+                                CachingAllocatorOptions options) {
+  if (type == PointerType::host)
+    return std::make_shared<CachingAllocator>(createHostAllocatorBackend(),
+                                              std::move(options));
+  if (type == PointerType::device) {
+    MTRT_ASSIGN_OR_RETURN(std::unique_ptr<AllocatorBackend> backend,
+                          createCudaDeviceAllocatorBackend());
+    return std::make_shared<CachingAllocator>(std::move(backend),
+                                              std::move(options));
+  }
+  return getInvalidArgStatus("caching allocators are not supported for {0} "
+                             "memory",
+                             stringifyPointerType(type));
+}
+
+/// Allocate a buffer from the caching allocator of the tracker.
+static StatusOr<PointerInfo> allocateCached(AllocTracker &tracker,
+                                            CachingAllocator &allocator,
+                                            PointerType type, uint64_t size,
+                                            uint32_t alignment,
+                                            std::optional<CudaStream> stream) {
+  MTRT_ASSIGN_OR_RETURN(uintptr_t ptr,
+                        allocator.allocate(size, alignment, stream));
+  MTRT_DBGF("Allocated %lu cached %s bytes at 0x%lx", size,
+            stringifyPointerType(type).data(), ptr);
+  PointerInfo info{ptr, size, type, PointerOwner::internal};
+  tracker.track(info);
+  return info;
 }
 
 StatusOr<PointerInfo> runtime::allocate(AllocTracker &tracker, PointerType type,
                                         uint64_t size,
                                         std::optional<uint32_t> alignment,
                                         std::optional<CudaStream> stream) {
+  if (CachingAllocator *allocator = tracker.getCachingAllocator(type)) {
+    if (type == PointerType::host) {
+      assert(alignment && !stream &&
+             "expected alignment, no stream for host allocation");
+      return allocateCached(tracker, *allocator, type,
+                            llvm::alignTo(size, *alignment), *alignment, {});
+    }
+    // CUDA allocations are aligned to at least 256 bytes.
+    return allocateCached(tracker, *allocator, type,
+                          std::max<uint64_t>(size, 16),
+                          std::max<uint32_t>(alignment.value_or(256), 256),
+                          stream);
+  }
+
   if (type == PointerType::host) {
     assert(alignment && !stream &&
            "expected alignment, no stream for host allocation");
@@ -560,6 +839,12 @@ mlirtrt::Status runtime::safeDeallocate(AllocTracker &tracker, uintptr_t ptr,
     return mlirtrt::Status::getOk();
   }
 
+  if (tracker.isTrackedByParent(ptr))
+    return getInvalidArgStatus(
+        "cannot deallocate pointer 0x{0:x} because it is owned by the parent "
+        "allocation tracker",
+        ptr);
+
   if (tracker.getExternalReferenceCount(ptr) > 0) {
     // Destructor for external reference should truly free or delete this.
     // Defer safeDeallocate call until then.
@@ -572,17 +857,30 @@ mlirtrt::Status runtime::safeDeallocate(AllocTracker &tracker, uintptr_t ptr,
     return mlirtrt::Status::getOk();
   }
 
+  // Untrack the pointer before releasing its memory. Otherwise another thread
+  // could be handed the same address by the allocator and track it before we
+  // untrack it here.
   PointerInfo obj = tracker.get(ptr);
+  tracker.untrack(ptr);
   if (obj.owner == PointerOwner::external) {
-    MTRT_DBGF("Untracking externally managed pointer 0x%lx", ptr);
-    tracker.untrack(obj.ptr);
+    MTRT_DBGF("Untracked externally managed pointer 0x%lx", ptr);
     return mlirtrt::Status::getOk();
   }
 
+  CachingAllocator *allocator = tracker.getCachingAllocator(obj.type);
+  if (allocator && allocator->owns(ptr)) {
+    MTRT_DBGF("Returning %s memory 0x%lx to the caching allocator",
+              stringifyPointerType(obj.type).data(), ptr);
+    std::optional<CudaStream> allocStream;
+    if (obj.type == PointerType::device && stream && *stream != 0)
+      allocStream = stream;
+    MTRT_RETURN_IF_ERROR(allocator->deallocate(ptr, allocStream));
+    return Status::getOk();
+  }
+
   if (obj.type == PointerType::host) {
     MTRT_DBGF("Freeing host memory %lx", ptr);
     std::free(reinterpret_cast<void *>(obj.ptr));
-    tracker.untrack(ptr);
     return Status::getOk();
   }
 
@@ -602,7 +900,6 @@ mlirtrt::Status runtime::safeDeallocate(AllocTracker &tracker, uintptr_t ptr,
           ptr, static_cast<int32_t>(obj.type));
       RETURN_ERROR_IF_CUDART_ERROR(cudaFree(reinterpret_cast<void *>(obj.ptr)));
     }
-    tracker.untrack(ptr);
     return Status::getOk();
   }
 
@@ -798,7 +1095,13 @@ populateDevices(llvm::SmallVectorImpl<std::unique_ptr<Device>> &devices) {
   // Find the number of devices. In single-process mode, the "addressable
   // devices" is equivalent to any devices the process can view, but this
   // is not true in multi-process mode.
-  RETURN_ERROR_IF_CUDART_ERROR(cudaGetDeviceCount(&numDevices));
+  cudaError_t status = cudaGetDeviceCount(&numDevices);
+  // A machine without a GPU has no devices, but can still run host code.
+  if (status == cudaErrorNoDevice || status == cudaErrorInsufficientDriver) {
+    (void)cudaGetLastError();
+    return getOkStatus();
+  }
+  RETURN_ERROR_IF_CUDART_ERROR(status);
 
   devices.reserve(numDevices);
   for (int32_t i = 0; i < numDevices; ++i) {
@@ -1182,8 +1485,12 @@ llvm::raw_ostream &rt::print(llvm::raw_ostream &os, const Executable &exe) {
 
 llvm::raw_ostream &rt::print(llvm::raw_ostream &os,
                              const ConstantView &constant) {
-  os << "Constant<" << constant.getName() << ", " << constant.size() << " bytes"
-     << ">";
+  os << "Constant<" << constant.getName() << ", " << constant.getDecodedSize()
+     << " bytes";
+  if (constant.getEncoding() != ConstantEncoding::raw)
+    os << ", " << impl::EnumNameConstantEncoding(constant.getEncoding())
+       << " encoded in " << constant.size() << " bytes";
+  os << ">";
   return os;
 }
 llvm::raw_ostream &rt::print(llvm::raw_ostream &os, const MemRefTypeView &exe) {
@@ -1232,6 +1539,11 @@ llvm::raw_ostream &rt::print(llvm::raw_ostream &os,
   squareBraces(os, LAMBDAF(interleaveComma(os, llvm::ArrayRef(arg_bounds))));
   os << ", result_bounds=";
   squareBraces(os, LAMBDAF(interleaveComma(os, llvm::ArrayRef(result_bounds))));
+  if (signature.hasOutputAliases()) {
+    os << ", output_aliases=";
+    squareBraces(os, LAMBDAF(llvm::interleaveComma(
+                         *signature.view->output_aliases(), os)));
+  }
   os << ">";
   return os;
 }
@@ -20,105 +20,544 @@
 #include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
 #include "mlir-executor/Runtime/API/API.h"
 #include "mlir-executor/Runtime/Backend/Common/NvPtxCompilerUtils.h"
+#include "mlir-executor/Support/Allocators.h"
 #include "mlir-executor/Support/Status.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Alignment.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <thread>
 
 using namespace mlirtrt;
 namespace mrt = mlirtrt::runtime;
 using namespace mrt;
 
-void mrt::executeStridedCopy(
-    int64_t elemSize, uintptr_t src, int64_t srcOffset,
-    const std::vector<int64_t> &srcShape, std::vector<int64_t> &srcStrides,
-    uintptr_t dst, int64_t dstOffset, const std::vector<int64_t> &dstShape,
-    std::vector<int64_t> &dstStrides,
-    std::function<void(void *dst, void *src, size_t size)> memcpyFunc) {
-  // Handle edge case of empty source tensor.
-  if (std::all_of(srcShape.begin(), srcShape.end(),
-                  [](int64_t dimSize) { return dimSize == 0; }))
-    return;
+//===----------------------------------------------------------------------===//
+// Copy utilities
+//===----------------------------------------------------------------------===//
 
-  char *srcPtr = reinterpret_cast<char *>(src + srcOffset * elemSize);
-  char *dstPtr = reinterpret_cast<char *>(dst + dstOffset * elemSize);
+llvm::SmallVector<int64_t>
+mrt::getCanonicalStrides(llvm::ArrayRef<int64_t> shape) {
+  llvm::SmallVector<int64_t> strides(shape.size(), 1);
+  for (int64_t i = static_cast<int64_t>(shape.size()) - 2; i >= 0; --i)
+    strides[i] = strides[i + 1] * shape[i + 1];
+  return strides;
+}
 
-  // Handle edge case of rank-0 tensor.
-  int64_t rank = srcShape.size();
-  if (rank == 0) {
-    memcpyFunc(dstPtr, srcPtr, elemSize);
-    return;
+/// Plan a copy where the offsets and strides are given in bytes.
+static StridedCopyPlan planStridedByteCopy(int64_t elemSize,
+                                           llvm::ArrayRef<int64_t> shape,
+                                           int64_t srcOffset,
+                                           llvm::ArrayRef<int64_t> srcStrides,
+                                           int64_t dstOffset,
+                                           llvm::ArrayRef<int64_t> dstStrides) {
+  assert(srcStrides.size() == shape.size() &&
+         dstStrides.size() == shape.size() && "expected one stride per dim");
+  StridedCopyPlan plan;
+  if (llvm::is_contained(shape, 0))
+    return plan;
+
+  plan.srcOffset = srcOffset;
+  plan.dstOffset = dstOffset;
+  plan.runSize = elemSize;
+  // Walk the dimensions from the innermost one. The loop nest is built
+  // innermost loop first and reversed at the end.
+  for (int64_t d = static_cast<int64_t>(shape.size()) - 1; d >= 0; --d) {
+    if (shape[d] == 1)
+      continue;
+    // Grow the run while the dimensions are contiguous in both buffers.
+    if (plan.shape.empty() && srcStrides[d] == plan.runSize &&
+        dstStrides[d] == plan.runSize) {
+      plan.runSize *= shape[d];
+      continue;
+    }
+    // Merge the dimension with the next inner loop if it continues that loop
+    // in both buffers.
+    if (!plan.shape.empty() &&
+        srcStrides[d] == plan.shape.back() * plan.srcStrides.back() &&
+        dstStrides[d] == plan.shape.back() * plan.dstStrides.back()) {
+      plan.shape.back() *= shape[d];
+      continue;
+    }
+    plan.shape.push_back(shape[d]);
+    plan.srcStrides.push_back(srcStrides[d]);
+    plan.dstStrides.push_back(dstStrides[d]);
   }
+  std::reverse(plan.shape.begin(), plan.shape.end());
+  std::reverse(plan.srcStrides.begin(), plan.srcStrides.end());
+  std::reverse(plan.dstStrides.begin(), plan.dstStrides.end());
+  return plan;
+}
 
-  std::vector<int64_t> indices(rank, 0);
+StridedCopyPlan mrt::planStridedCopy(int64_t elemSize,
+                                     llvm::ArrayRef<int64_t> shape,
+                                     int64_t srcOffset,
+                                     llvm::ArrayRef<int64_t> srcStrides,
+                                     int64_t dstOffset,
+                                     llvm::ArrayRef<int64_t> dstStrides) {
+  auto toBytes = [&](llvm::ArrayRef<int64_t> strides) {
+    return llvm::to_vector(llvm::map_range(
+        strides, [&](int64_t stride) { return stride * elemSize; }));
+  };
+  return planStridedByteCopy(elemSize, shape, srcOffset * elemSize,
+                             toBytes(srcStrides), dstOffset * elemSize,
+                             toBytes(dstStrides));
+}
 
-  // Initialize index and scale strides.
-  for (int64_t i = 0; i < rank; ++i) {
-    srcStrides[i] *= elemSize;
-    dstStrides[i] *= elemSize;
+StridedCopyPlan::Kind StridedCopyPlan::getKind() const {
+  if (runSize == 0)
+    return Kind::Empty;
+  switch (shape.size()) {
+  case 0:
+    return Kind::Contiguous;
+  case 1:
+    return Kind::Pitched2D;
+  case 2:
+    return Kind::Pitched3D;
+  default:
+    return Kind::Generic;
   }
+}
+
+int64_t StridedCopyPlan::getNumRuns() const {
+  if (runSize == 0)
+    return 0;
+  return std::accumulate(shape.begin(), shape.end(), int64_t(1),
+                         std::multiplies<int64_t>());
+}
 
-  // The logic below comes from the original MLIR CRunner implementation of
-  // strided memref copy. It could be further optimized if any of the
-  // dimensions have unit stride.
-  int64_t readIndex = 0, writeIndex = 0;
+void StridedCopyPlan::forEachRun(
+    llvm::function_ref<void(int64_t, int64_t)> callback,
+    unsigned numInnerLoops) const {
+  if (runSize == 0)
+    return;
+  assert(numInnerLoops <= shape.size() && "too many inner loops");
+  int64_t rank = static_cast<int64_t>(shape.size()) - numInnerLoops;
+  llvm::SmallVector<int64_t> index(rank, 0);
+  int64_t src = srcOffset, dst = dstOffset;
   while (true) {
-    // Copy one element.
-    memcpyFunc(dstPtr + writeIndex, srcPtr + readIndex, elemSize);
-    for (int64_t axis = rank - 1; axis >= 0; --axis) {
-      int64_t newIndex = ++indices[axis];
-      readIndex += srcStrides[axis];
-      writeIndex += dstStrides[axis];
-      if (srcShape[axis] != newIndex)
+    callback(src, dst);
+    int64_t d = rank - 1;
+    for (; d >= 0; --d) {
+      src += srcStrides[d];
+      dst += dstStrides[d];
+      if (++index[d] != shape[d])
         break;
-      if (axis == 0)
-        return;
-      indices[axis] = 0;
-      readIndex -= srcShape[axis] * srcStrides[axis];
-      writeIndex -= dstShape[axis] * dstStrides[axis];
+      index[d] = 0;
+      src -= shape[d] * srcStrides[d];
+      dst -= shape[d] * dstStrides[d];
     }
+    if (d < 0)
+      return;
   }
 }
 
+namespace {
+/// A 16 byte element, e.g. a complex<f64>.
+struct Bytes16 {
+  uint64_t lo, hi;
+};
+} // namespace
+
+/// Copy `count` elements of type `T` with the given byte strides. The copies
+/// go through `std::memcpy` since the buffers need not be aligned; compilers
+/// lower them to plain (and, where profitable, vector) loads and stores.
+template <typename T>
+static void copyElements(char *dst, const char *src, int64_t count,
+                         int64_t dstStride, int64_t srcStride) {
+  for (int64_t i = 0; i < count; ++i) {
+    T value;
+    std::memcpy(&value, src + i * srcStride, sizeof(T));
+    std::memcpy(dst + i * dstStride, &value, sizeof(T));
+  }
+}
+
+/// Copy `count` runs of `runSize` bytes with the given byte strides.
+static void copyRuns(char *dst, const char *src, int64_t runSize,
+                     int64_t count, int64_t dstStride, int64_t srcStride) {
+  switch (runSize) {
+  case 1:
+    return copyElements<uint8_t>(dst, src, count, dstStride, srcStride);
+  case 2:
+    return copyElements<uint16_t>(dst, src, count, dstStride, srcStride);
+  case 4:
+    return copyElements<uint32_t>(dst, src, count, dstStride, srcStride);
+  case 8:
+    return copyElements<uint64_t>(dst, src, count, dstStride, srcStride);
+  case 16:
+    return copyElements<Bytes16>(dst, src, count, dstStride, srcStride);
+  default:
+    for (int64_t i = 0; i < count; ++i)
+      std::memcpy(dst + i * dstStride, src + i * srcStride, runSize);
+  }
+}
+
+/// Copy the runs of `plan` whose linear indices are in `[begin, end)`. The
+/// plan must have at least one loop.
+static void copyRunRange(const StridedCopyPlan &plan, char *dst,
+                         const char *src, int64_t begin, int64_t end) {
+  int64_t rank = plan.shape.size();
+  int64_t inner = rank - 1;
+  llvm::SmallVector<int64_t> index(rank, 0);
+  int64_t srcOffset = plan.srcOffset, dstOffset = plan.dstOffset;
+  for (int64_t d = inner, linear = begin; d >= 0; --d) {
+    index[d] = linear % plan.shape[d];
+    linear /= plan.shape[d];
+    srcOffset += index[d] * plan.srcStrides[d];
+    dstOffset += index[d] * plan.dstStrides[d];
+  }
+
+  // Copy the runs one row of the innermost loop at a time.
+  while (begin < end) {
+    int64_t count = std::min(end - begin, plan.shape[inner] - index[inner]);
+    copyRuns(dst + dstOffset, src + srcOffset, plan.runSize, count,
+             plan.dstStrides[inner], plan.srcStrides[inner]);
+    begin += count;
+    index[inner] += count;
+    srcOffset += count * plan.srcStrides[inner];
+    dstOffset += count * plan.dstStrides[inner];
+    for (int64_t d = inner; d > 0 && index[d] == plan.shape[d]; --d) {
+      index[d] = 0;
+      srcOffset += plan.srcStrides[d - 1] - plan.shape[d] * plan.srcStrides[d];
+      dstOffset += plan.dstStrides[d - 1] - plan.shape[d] * plan.dstStrides[d];
+      ++index[d - 1];
+    }
+  }
+}
+
+/// Split `[0, size)` into `numChunks` ranges and invoke `func` on each. All
+/// but the first range are processed on new threads.
+static void parallelForChunks(int64_t numChunks, int64_t size,
+                              llvm::function_ref<void(int64_t, int64_t)> func) {
+  if (numChunks <= 1) {
+    func(0, size);
+    return;
+  }
+  int64_t chunkSize = llvm::divideCeil(size, numChunks);
+  std::vector<std::thread> threads;
+  for (int64_t begin = chunkSize; begin < size; begin += chunkSize)
+    threads.emplace_back(
+        [=]() { func(begin, std::min(begin + chunkSize, size)); });
+  func(0, std::min(chunkSize, size));
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+void mrt::executeStridedCopyOnHost(const StridedCopyPlan &plan,
+                                   uintptr_t src, uintptr_t dst,
+                                   unsigned numThreads) {
+  int64_t numBytes = plan.getNumBytes();
+  if (numBytes == 0)
+    return;
+  const char *srcPtr = reinterpret_cast<const char *>(src);
+  char *dstPtr = reinterpret_cast<char *>(dst);
+
+  if (numThreads == 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  int64_t numChunks = std::clamp<int64_t>(
+      numBytes / kMinStridedCopyBytesPerThread, 1, numThreads);
+  // Runs that overlap in the destination must be written in order.
+  if (llvm::is_contained(plan.dstStrides, 0))
+    numChunks = 1;
+
+  if (plan.shape.empty()) {
+    parallelForChunks(numChunks, plan.runSize,
+                      [&](int64_t begin, int64_t end) {
+                        std::memcpy(dstPtr + plan.dstOffset + begin,
+                                    srcPtr + plan.srcOffset + begin,
+                                    end - begin);
+                      });
+    return;
+  }
+  parallelForChunks(numChunks, plan.getNumRuns(),
+                    [&](int64_t begin, int64_t end) {
+                      copyRunRange(plan, dstPtr, srcPtr, begin, end);
+                    });
+}
+
+void mrt::executeStridedCopy(
+    int64_t elemSize, uintptr_t src, int64_t srcOffset,
+    const std::vector<int64_t> &srcShape,
+    const std::vector<int64_t> &srcStrides, uintptr_t dst, int64_t dstOffset,
+    const std::vector<int64_t> &dstShape,
+    const std::vector<int64_t> &dstStrides,
+    std::function<void(void *dst, void *src, size_t size)> memcpyFunc) {
+  assert(srcShape == dstShape && "expected equal source and dest shapes");
+  (void)dstShape;
+  StridedCopyPlan plan = planStridedCopy(elemSize, srcShape, srcOffset,
+                                         srcStrides, dstOffset, dstStrides);
+  plan.forEachRun([&](int64_t srcRunOffset, int64_t dstRunOffset) {
+    memcpyFunc(reinterpret_cast<void *>(dst + dstRunOffset),
+               reinterpret_cast<void *>(src + srcRunOffset), plan.runSize);
+  });
+}
+
 void mrt::executeStridedByteCopy(
     uintptr_t src, int64_t srcOffsetBytes, const std::vector<int64_t> &srcShape,
     const std::vector<int64_t> &srcByteStrides, uintptr_t dst,
     int64_t dstOffsetBytes, const std::vector<int64_t> &dstShape,
     const std::vector<int64_t> &dstByteStrides, size_t elemSizeBytes,
     std::function<void(void *dst, void *src, size_t size)> memcpyFunc) {
-  // Handle edge case of empty source tensor.
-  if (std::all_of(srcShape.begin(), srcShape.end(),
-                  [](int64_t dimSize) { return dimSize == 0; }))
-    return;
+  assert(srcShape == dstShape && "expected equal source and dest shapes");
+  (void)dstShape;
+  StridedCopyPlan plan = planStridedByteCopy(
+      elemSizeBytes, srcShape, srcOffsetBytes, srcByteStrides, dstOffsetBytes,
+      dstByteStrides);
+  plan.forEachRun([&](int64_t srcRunOffset, int64_t dstRunOffset) {
+    memcpyFunc(reinterpret_cast<void *>(dst + dstRunOffset),
+               reinterpret_cast<void *>(src + srcRunOffset), plan.runSize);
+  });
+}
 
-  char *srcPtr = reinterpret_cast<char *>(src + srcOffsetBytes);
-  char *dstPtr = reinterpret_cast<char *>(dst + dstOffsetBytes);
+//===----------------------------------------------------------------------===//
+// Session utilities
+//===----------------------------------------------------------------------===//
 
-  // Handle edge case of rank-0 tensor.
-  int64_t rank = srcShape.size();
-  if (rank == 0) {
-    memcpyFunc(dstPtr, srcPtr, elemSizeBytes);
-    return;
+Status
+mrt::maybeCheckForValidNcclUuid(const RuntimeSessionOptions &options) {
+#if MLIR_EXECUTOR_ENABLE_NCCL
+
+  if (options.getNumDevices() > 1 && options.getNcclUuid().empty())
+    return getInternalErrorStatus(
+        "number of devices is {0} but the NCCL UUID is empty",
+        options.getNumDevices());
+
+  MTRT_DBG("creating session with DeviceID={0}/{1} UUID={2}",
+           options.getDeviceId(), options.getNumDevices(),
+           options.getNcclUuid());
+
+#endif
+  return getOkStatus();
+}
+
+StatusOr<uintptr_t> mrt::materializeConstant(ConstantView constant,
+                                             AllocTracker &tracker) {
+  MTRT_DBGF("materializing constant %s (%lu bytes)",
+            std::string(constant.getName()).c_str(),
+            constant.getDecodedSize());
+  MTRT_ASSIGN_OR_RETURN(
+      StatusOr<PointerInfo> buffer,
+      mlirtrt::runtime::allocate(
+          tracker, PointerType::host,
+          std::max<uint64_t>(constant.getDecodedSize(), 1),
+          kMinConstantBufferByteAlignment, {}));
+  constant.decode(reinterpret_cast<void *>(buffer->ptr));
+  return static_cast<uintptr_t>(buffer->ptr);
+}
+
+ConstantDataKey mrt::getConstantDataKey(ConstantView constant) {
+  return {constant.data(), constant.getDecodedSize()};
+}
+
+Status mrt::loadConstants(
+    ExecutableView executable, AllocTracker &tracker,
+    llvm::function_ref<void(std::string_view, uintptr_t)> setGlobal,
+    llvm::function_ref<void(ConstantView)> deferConstant) {
+  // TODO: eliminate this copy, we already own the executable.
+  MTRT_DBGF("loading %lu constants", executable.getConstants().size());
+  llvm::DenseMap<ConstantDataKey, uintptr_t> loaded;
+  for (ConstantView constant : executable.getConstants()) {
+    if (constant.getEncoding() != ConstantEncoding::raw && deferConstant) {
+      deferConstant(constant);
+      continue;
+    }
+
+    auto [it, inserted] = loaded.try_emplace(getConstantDataKey(constant), 0);
+    if (!inserted) {
+      setGlobal(constant.getName(), it->second);
+      continue;
+    }
+
+    if (constant.getEncoding() != ConstantEncoding::raw) {
+      MTRT_ASSIGN_OR_RETURN(it->second, materializeConstant(constant, tracker));
+      setGlobal(constant.getName(), it->second);
+      continue;
+    }
+
+    size_t bytes = constant.size();
+    if (!llvm::isAddrAligned(llvm::Align(kMinConstantBufferByteAlignment),
+                             constant.data())) {
+      MTRT_WARNV("constant (name={0}, size={1}) is not aligned to minimum "
+                 "{2} bytes copying into runtime session context",
+                 constant.getName(), constant.size(),
+                 kMinConstantBufferByteAlignment);
+      MTRT_ASSIGN_OR_RETURN(StatusOr<PointerInfo> buffer,
+                            mlirtrt::runtime::allocate(
+                                tracker, PointerType::host, bytes,
+                                kMinConstantBufferByteAlignment, {}));
+      std::memcpy(reinterpret_cast<void *>(buffer->ptr),
+                  reinterpret_cast<const void *>(constant.data()), bytes);
+      it->second = buffer->ptr;
+      setGlobal(constant.getName(), buffer->ptr);
+      continue;
+    }
+
+    // Otherwise, just use an external view.
+    it->second = reinterpret_cast<uintptr_t>(constant.data());
+    setGlobal(constant.getName(), it->second);
+    tracker.track(PointerInfo(it->second, constant.size(), PointerType::host,
+                              PointerOwner::external));
   }
+  return getOkStatus();
+}
+
+std::optional<FunctionView> mrt::lookupFunction(ExecutableView executable,
+                                                std::string_view name) {
+  for (FunctionView func : executable.getFunctions())
+    if (func.getName() == name)
+      return func;
+  return std::nullopt;
+}
 
-  std::vector<int64_t> indices(rank, 0);
+Status mrt::validateArgsTypesAgainstFuncArgs(const RuntimeValue *runArg,
+                                             const TypeUnionView &sigArg) {
+  if (sigArg.isa<MemRefTypeView>()) {
+    if (runArg->getKind() != RuntimeValue::Kind::MemRef)
+      return getInvalidArgStatus(
+          "function expects a memref type but received scalar type");
+    auto view = sigArg.get<MemRefTypeView>();
+    auto value = static_cast<const MemRefValue *>(runArg);
 
-  // The logic below comes from the original MLIR CRunner implementation of
-  // strided memref copy. It could be further optimized if any of the
-  // dimensions have unit stride.
-  int64_t readIndex = 0, writeIndex = 0;
-  while (true) {
-    // Copy one element.
-    memcpyFunc(dstPtr + writeIndex, srcPtr + readIndex, elemSizeBytes);
-    for (int64_t axis = rank - 1; axis >= 0; --axis) {
-      int64_t newIndex = ++indices[axis];
-      readIndex += srcByteStrides[axis];
-      writeIndex += dstByteStrides[axis];
-      if (srcShape[axis] != newIndex)
-        break;
-      if (axis == 0)
-        return;
-      indices[axis] = 0;
-      readIndex -= srcShape[axis] * srcByteStrides[axis];
-      writeIndex -= dstShape[axis] * dstByteStrides[axis];
+    if (view.getElementType() != *value->getScalarType())
+      return getInvalidArgStatus(
+          "function expects a memref type with element type {0} but "
+          "receieved {1}",
+          view.getElementType().getStrRef(),
+          value->getScalarType()->getStrRef());
+
+    if (view.getRank() != value->getRank())
+      return getInvalidArgStatus(
+          "function expects a memref type with rank {0} but receieved {1}",
+          view.getRank(), value->getRank());
+
+    if (view.getShape() != value->getShape()) {
+      for (unsigned i = 0; i < view.getShape().size(); ++i) {
+        if (value->getShape()[i] < 0)
+          return getInvalidArgStatus(
+              "all shape dimensions extents must be "
+              "non-negative but received shape [{0:$[, ]}]",
+              value->getShape());
+        if (view.getShape()[i] >= 0 &&
+            view.getShape()[i] != value->getShape()[i])
+          return getInvalidArgStatus(
+              "Runtime shape mismatch. Expected [{0:$[, ]}] "
+              "but received [{1:$[, ]}]",
+              view.getShape(), value->getShape());
+      }
+    }
+
+    if (view.getStrides() != value->getStrides()) {
+      for (unsigned i = 0; i < view.getStrides().size(); ++i) {
+        if (value->getStrides()[i] < 0)
+          return getInvalidArgStatus(
+              "all strides must be non-negative but received shape [{0:$[, ]}]",
+              value->getStrides());
+        if (view.getStrides()[i] >= 0 &&
+            view.getStrides()[i] != value->getStrides()[i])
+          // Allow the special case of non-canonical stride for unit dimensions
+          // See https://github.com/pytorch/pytorch/issues/99803 for more detail
+          if (value->getShape()[i] != 1 || value->getStrides()[i] != 1)
+            return getInvalidArgStatus(
+                "Runtime stride mismatch. Expected [{0:$[, ]}] "
+                "but received [{1:$[, ]}]",
+                view.getStrides(), value->getStrides());
+      }
+    }
+
+    if (view.getAddressSpace() != value->getAddressSpace())
+      return getInvalidArgStatus("function expects a memref type with "
+                                 "address space {0} but receieved {1}",
+                                 EnumNamePointerType(view.getAddressSpace()),
+                                 EnumNamePointerType(value->getAddressSpace()));
+
+  } else {
+    assert(sigArg.isa<ScalarTypeView>());
+    if (runArg->getKind() != RuntimeValue::Kind::Scalar)
+      return getInvalidArgStatus(
+          "function expects a scalar type but received memref type");
+    auto view = sigArg.get<ScalarTypeView>();
+    auto value = static_cast<const ScalarValue *>(runArg);
+
+    if (view != value->getType().getCode())
+      return getInvalidArgStatus(
+          "function expects a scalar type with element type {0} but "
+          "receieved {1}",
+          impl::EnumNameScalarTypeCode(view),
+          impl::EnumNameScalarTypeCode(value->getType().getCode()));
+  }
+  return getOkStatus();
+}
+
+Status
+mrt::validateOutputAliases(FunctionSignatureView sig,
+                           llvm::ArrayRef<RuntimeValue *> inputArgs,
+                           llvm::ArrayRef<RuntimeValue *> outputArgs) {
+  if (!sig.hasOutputAliases())
+    return getOkStatus();
+  for (unsigned i = 0; i < outputArgs.size(); ++i) {
+    std::optional<uint32_t> alias = sig.getOutputAlias(i);
+    if (!alias)
+      continue;
+    if (*alias >= inputArgs.size())
+      return getInvalidArgStatus(
+          "output argument {0} is aliased to input argument {1}, but the "
+          "function only has {2} input arguments",
+          i, *alias, inputArgs.size());
+    auto *donated = llvm::dyn_cast<MemRefValue>(inputArgs[*alias]);
+    auto *output = llvm::dyn_cast<MemRefValue>(outputArgs[i]);
+    if (!donated || !output || donated->getMemory() != output->getMemory() ||
+        donated->getOffset() != output->getOffset())
+      return getInvalidArgStatus(
+          "output argument {0} is aliased to donated input argument {1} and "
+          "must be passed the same buffer as that input",
+          i, *alias);
+    for (auto [idx, rv] : llvm::enumerate(inputArgs)) {
+      auto *memref = llvm::dyn_cast<MemRefValue>(rv);
+      if (idx != *alias && memref &&
+          memref->getMemory() == donated->getMemory())
+        return getInvalidArgStatus(
+            "input argument {0} is donated to output argument {1}, so its "
+            "buffer must not also be passed as input argument {2}",
+            *alias, i, idx);
     }
   }
+  return getOkStatus();
+}
+
+Status mrt::validateFunctionArgs(FunctionSignatureView sig,
+                                 llvm::ArrayRef<RuntimeValue *> inputArgs,
+                                 llvm::ArrayRef<RuntimeValue *> outputArgs) {
+  // Validate the number of arguments against the signature.
+  if (sig.getNumOutputArgs() != outputArgs.size())
+    return getInvalidArgStatus(
+        "function expects {0} output args (destination args) but received {1}",
+        sig.getNumOutputArgs(), outputArgs.size());
+  if (sig.getNumInputArgs() != inputArgs.size())
+    return getInvalidArgStatus("function expects {0} input args "
+                               "(non-destination args) but received {1}",
+                               sig.getNumInputArgs(), inputArgs.size());
+
+  // Validate the argument types against the signature.
+  for (unsigned i = 0; i < inputArgs.size(); ++i) {
+    auto status = validateArgsTypesAgainstFuncArgs(inputArgs[i], sig.getArg(i));
+    if (!status.isOk())
+      return getInvalidArgStatus(
+          "Input argument {0} validation failed against "
+          "corresponding function signature arg {0}. Reason: {1}",
+          i, status.getString());
+  }
+  for (unsigned i = 0; i < outputArgs.size(); ++i) {
+    auto status =
+        validateArgsTypesAgainstFuncArgs(outputArgs[i], sig.getOutputArg(i));
+    if (!status.isOk())
+      return getInvalidArgStatus(
+          "Output argument {0} validation failed against "
+          "corresponding function signature arg {1}. Reason: {2}",
+          i, i + inputArgs.size(), status.getString());
+  }
+  return validateOutputAliases(sig, inputArgs, outputArgs);
 }
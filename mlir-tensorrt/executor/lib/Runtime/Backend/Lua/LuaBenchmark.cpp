@@ -0,0 +1,476 @@
+//===- LuaBenchmark.cpp ---------------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the function latency benchmark of the Lua runtime.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Backend/Lua/LuaBenchmark.h"
+#include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
+#include "mlir-executor/Runtime/Support/Support.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+#include "cuda_runtime_api.h"
+#endif
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+
+//===----------------------------------------------------------------------===//
+// Statistics
+//===----------------------------------------------------------------------===//
+
+LatencyStatistics
+runtime::computeLatencyStatistics(llvm::ArrayRef<int64_t> samplesNs) {
+  LatencyStatistics stats;
+  if (samplesNs.empty())
+    return stats;
+  llvm::SmallVector<int64_t> sorted = llvm::to_vector(samplesNs);
+  llvm::sort(sorted);
+  auto toMs = [](int64_t ns) { return static_cast<double>(ns) / 1e6; };
+  auto getPercentile = [&](double percentile) {
+    int64_t rank = static_cast<int64_t>(
+        std::ceil(percentile * static_cast<double>(sorted.size()) / 100.0));
+    rank = std::clamp<int64_t>(rank, 1, sorted.size());
+    return toMs(sorted[rank - 1]);
+  };
+  int64_t sum = 0;
+  for (int64_t sample : sorted)
+    sum += sample;
+  stats.min = toMs(sorted.front());
+  stats.max = toMs(sorted.back());
+  stats.mean = toMs(sum) / static_cast<double>(sorted.size());
+  stats.p50 = getPercentile(50);
+  stats.p90 = getPercentile(90);
+  stats.p99 = getPercentile(99);
+  return stats;
+}
+
+//===----------------------------------------------------------------------===//
+// Argument creation
+//===----------------------------------------------------------------------===//
+
+static bool isHostAccessible(PointerType type) {
+  return type == PointerType::host || type == PointerType::pinned_host ||
+         type == PointerType::unified;
+}
+
+/// Return the size in bytes of each floating-point component of `type`, or
+/// zero if `type` is not a floating-point or complex type.
+static int64_t getFloatComponentSize(ScalarType type) {
+  switch (type.getCode()) {
+  case ScalarTypeCode::f8e4m3fn:
+    return 1;
+  case ScalarTypeCode::f16:
+  case ScalarTypeCode::bf16:
+  case ScalarTypeCode::complex32:
+    return 2;
+  case ScalarTypeCode::f32:
+  case ScalarTypeCode::complex64:
+    return 4;
+  case ScalarTypeCode::f64:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+/// Fill `numBytes` bytes of elements of `type` at `data` with random values.
+static void fillRandom(std::mt19937_64 &rng, ScalarType type, uint8_t *data,
+                       int64_t numBytes) {
+  if (type.getCode() == ScalarTypeCode::i1) {
+    for (int64_t i = 0; i < numBytes; ++i)
+      data[i] = rng() & 1;
+    return;
+  }
+  for (int64_t i = 0; i < numBytes; i += sizeof(uint64_t)) {
+    uint64_t bits = rng();
+    std::memcpy(data + i, &bits,
+                std::min<int64_t>(sizeof(uint64_t), numBytes - i));
+  }
+  // Clearing the most significant exponent bit of each (little-endian) float
+  // limits its exponent to the bias, which excludes infinities and NaNs.
+  if (int64_t componentSize = getFloatComponentSize(type)) {
+    for (int64_t i = componentSize - 1; i < numBytes; i += componentSize)
+      data[i] &= ~0x40;
+  }
+}
+
+template <typename T>
+static void clampElements(uint8_t *data, llvm::ArrayRef<int64_t> min,
+                          llvm::ArrayRef<int64_t> max) {
+  for (size_t i = 0; i < min.size(); ++i) {
+    T element;
+    std::memcpy(&element, data + i * sizeof(T), sizeof(T));
+    element = static_cast<T>(
+        std::clamp<int64_t>(static_cast<int64_t>(element), min[i], max[i]));
+    std::memcpy(data + i * sizeof(T), &element, sizeof(T));
+  }
+}
+
+/// Clamp the integer elements of type `type` at `data` to `bounds` if the
+/// bounds give one range per element.
+static void clampToValueBounds(ScalarType type, uint8_t *data,
+                               int64_t numElements,
+                               std::optional<ValueBoundsView> bounds) {
+  if (!bounds || bounds->getMin().size() != static_cast<size_t>(numElements) ||
+      bounds->getMax().size() != static_cast<size_t>(numElements))
+    return;
+  switch (type.getCode()) {
+  case ScalarTypeCode::i8:
+    return clampElements<int8_t>(data, bounds->getMin(), bounds->getMax());
+  case ScalarTypeCode::ui8:
+    return clampElements<uint8_t>(data, bounds->getMin(), bounds->getMax());
+  case ScalarTypeCode::i16:
+    return clampElements<int16_t>(data, bounds->getMin(), bounds->getMax());
+  case ScalarTypeCode::i32:
+    return clampElements<int32_t>(data, bounds->getMin(), bounds->getMax());
+  case ScalarTypeCode::i64:
+    return clampElements<int64_t>(data, bounds->getMin(), bounds->getMax());
+  default:
+    return;
+  }
+}
+
+namespace {
+/// Creates the arguments of the benchmarked function and owns their buffers.
+class ArgumentBuilder {
+public:
+  ArgumentBuilder(RuntimeClient &client, FunctionSignatureView sig,
+                  const BenchmarkOptions &options)
+      : client(client), sig(sig), options(options), rng(options.seed) {}
+
+  ~ArgumentBuilder() {
+    for (std::unique_ptr<MemRefValue> &buffer : buffers) {
+      Status status = client.deallocate(std::move(buffer));
+      if (!status.isOk())
+        MTRT_WARNV("failed to free a benchmark argument: {0}",
+                   status.getString());
+    }
+  }
+
+  /// Create all input and output arguments.
+  Status build();
+
+  llvm::SmallVector<RuntimeValue *> inputArgs;
+  llvm::SmallVector<RuntimeValue *> outputArgs;
+
+private:
+  /// Return the bounds of argument `idx` of kind `T`, if any.
+  template <typename T>
+  std::optional<T> getBounds(unsigned idx) const {
+    if (idx >= sig.getNumArgBounds() || !sig.getArgBound(idx).isa<T>())
+      return std::nullopt;
+    return sig.getArgBound(idx).get<T>();
+  }
+
+  /// Return the concrete shape of memref argument `idx`.
+  StatusOr<llvm::SmallVector<int64_t>> getShape(unsigned idx,
+                                                MemRefTypeView type) const;
+
+  /// Write the contents of input argument `idx` to `data`.
+  Status initialize(unsigned idx, ScalarType type, uint8_t *data,
+                    int64_t numElements, int64_t numBytes);
+
+  StatusOr<RuntimeValue *> createScalar(unsigned idx, ScalarTypeView type);
+  StatusOr<MemRefValue *> createMemRef(unsigned idx, MemRefTypeView type,
+                                       bool isInput);
+
+  RuntimeClient &client;
+  FunctionSignatureView sig;
+  const BenchmarkOptions &options;
+  std::mt19937_64 rng;
+  llvm::SmallVector<std::unique_ptr<MemRefValue>> buffers;
+  llvm::SmallVector<std::unique_ptr<ScalarValue>> scalars;
+};
+} // namespace
+
+StatusOr<llvm::SmallVector<int64_t>>
+ArgumentBuilder::getShape(unsigned idx, MemRefTypeView type) const {
+  llvm::SmallVector<int64_t> shape = llvm::to_vector(type.getShape());
+  std::optional<DimensionBoundsView> bounds =
+      getBounds<DimensionBoundsView>(idx);
+  for (size_t dim = 0; dim < shape.size(); ++dim) {
+    if (shape[dim] >= 0)
+      continue;
+    if (!bounds || bounds->getMax().size() != shape.size())
+      return getInvalidArgStatus(
+          "argument #{0} has a dynamic shape [{1:$[, ]}] without dimension "
+          "bounds",
+          idx, type.getShape());
+    shape[dim] = bounds->getMax()[dim];
+  }
+  return shape;
+}
+
+Status ArgumentBuilder::initialize(unsigned idx, ScalarType type,
+                                   uint8_t *data, int64_t numElements,
+                                   int64_t numBytes) {
+  switch (options.inputInit) {
+  case BenchmarkInputInit::Zeros:
+    std::memset(data, 0, numBytes);
+    break;
+  case BenchmarkInputInit::Random:
+    fillRandom(rng, type, data, numBytes);
+    break;
+  case BenchmarkInputInit::File: {
+    if (idx >= options.inputFiles.size())
+      return getInvalidArgStatus("no input file was given for argument #{0}",
+                                 idx);
+    const std::string &filename = options.inputFiles[idx];
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> file =
+        llvm::MemoryBuffer::getFile(filename, /*IsText=*/false,
+                                    /*RequiresNullTerminator=*/false);
+    if (!file)
+      return getInvalidArgStatus("failed to read input file {0}: {1}",
+                                 filename, file.getError().message());
+    if (static_cast<int64_t>((*file)->getBufferSize()) != numBytes)
+      return getInvalidArgStatus(
+          "input file {0} has {1} bytes, but argument #{2} has {3} bytes",
+          filename, (*file)->getBufferSize(), idx, numBytes);
+    std::memcpy(data, (*file)->getBufferStart(), numBytes);
+    // File contents are used as given.
+    return getOkStatus();
+  }
+  }
+  clampToValueBounds(type, data, numElements,
+                     getBounds<ValueBoundsView>(idx));
+  return getOkStatus();
+}
+
+StatusOr<RuntimeValue *> ArgumentBuilder::createScalar(unsigned idx,
+                                                       ScalarTypeView view) {
+  ScalarType type(view);
+  int64_t numBytes = llvm::divideCeil(type.getBitWidth(), 8);
+  if (numBytes > static_cast<int64_t>(sizeof(int64_t)))
+    return getInvalidArgStatus(
+        "argument #{0} has the unsupported scalar type {1}", idx,
+        type.getStrRef());
+  int64_t data = 0;
+  MTRT_RETURN_IF_ERROR(initialize(idx, type, reinterpret_cast<uint8_t *>(&data),
+                                  /*numElements=*/1, numBytes));
+  scalars.push_back(std::make_unique<ScalarValue>(data, type));
+  return scalars.back().get();
+}
+
+StatusOr<MemRefValue *> ArgumentBuilder::createMemRef(unsigned idx,
+                                                      MemRefTypeView type,
+                                                      bool isInput) {
+  MTRT_ASSIGN_OR_RETURN(llvm::SmallVector<int64_t> shape, getShape(idx, type));
+  llvm::SmallVector<int64_t> strides = getCanonicalStrides(shape);
+  ScalarType elementType = type.getElementType();
+  int64_t bitsPerElement = elementType.getBitWidth();
+  int64_t numElements = 1;
+  for (int64_t extent : shape)
+    numElements *= extent;
+  int64_t numBytes = llvm::divideCeil(numElements * bitsPerElement, 8);
+
+  PointerType addressSpace = type.getAddressSpace();
+  std::optional<const Device *> device;
+  if (!isHostAccessible(addressSpace) || addressSpace == PointerType::unified) {
+    if (client.getDevices().empty())
+      return getInvalidArgStatus(
+          "argument #{0} is in {1} memory, but no device is available", idx,
+          impl::EnumNamePointerType(addressSpace));
+    device = client.getDevices().front().get();
+  }
+
+  // Device inputs are initialized on the host and then copied.
+  bool isStaged = isInput && !isHostAccessible(addressSpace);
+  MTRT_ASSIGN_OR_RETURN(
+      std::unique_ptr<MemRefValue> buffer,
+      client.allocateMemRef(isStaged ? PointerType::host : addressSpace,
+                            bitsPerElement, shape, strides,
+                            isStaged ? std::optional<const Device *>() : device,
+                            /*stream=*/{}, elementType));
+  if (isInput)
+    MTRT_RETURN_IF_ERROR(initialize(
+        idx, elementType, static_cast<uint8_t *>(buffer->getVoidPtr()),
+        numElements, numBytes));
+  if (isStaged) {
+    MTRT_ASSIGN_OR_RETURN(std::unique_ptr<MemRefValue> deviceBuffer,
+                          client.copyToDevice(*buffer, **device, {}));
+    MTRT_RETURN_IF_ERROR(client.deallocate(std::move(buffer)));
+    buffer = std::move(deviceBuffer);
+  }
+  buffers.push_back(std::move(buffer));
+  return buffers.back().get();
+}
+
+Status ArgumentBuilder::build() {
+  if (options.inputInit == BenchmarkInputInit::File &&
+      options.inputFiles.size() != sig.getNumInputArgs())
+    return getInvalidArgStatus(
+        "expected {0} input files (one per input argument), but got {1}",
+        sig.getNumInputArgs(), options.inputFiles.size());
+
+  for (unsigned i = 0, e = sig.getNumInputArgs(); i < e; ++i) {
+    TypeUnionView arg = sig.getArg(i);
+    if (arg.isa<ScalarTypeView>()) {
+      MTRT_ASSIGN_OR_RETURN(RuntimeValue * value,
+                            createScalar(i, arg.get<ScalarTypeView>()));
+      inputArgs.push_back(value);
+      continue;
+    }
+    if (!arg.isa<MemRefTypeView>())
+      return getInvalidArgStatus("argument #{0} has an unsupported type", i);
+    MTRT_ASSIGN_OR_RETURN(
+        MemRefValue * value,
+        createMemRef(i, arg.get<MemRefTypeView>(), /*isInput=*/true));
+    inputArgs.push_back(value);
+  }
+
+  for (unsigned i = 0, e = sig.getNumOutputArgs(); i < e; ++i) {
+    // A donated input also holds the output.
+    if (std::optional<uint32_t> alias = sig.getOutputAlias(i)) {
+      outputArgs.push_back(inputArgs[*alias]);
+      continue;
+    }
+    TypeUnionView arg = sig.getOutputArg(i);
+    if (!arg.isa<MemRefTypeView>())
+      return getInvalidArgStatus(
+          "output argument #{0} has an unsupported type", i);
+    MTRT_ASSIGN_OR_RETURN(MemRefValue * value,
+                          createMemRef(sig.getNumInputArgs() + i,
+                                       arg.get<MemRefTypeView>(),
+                                       /*isInput=*/false));
+    outputArgs.push_back(value);
+  }
+  return getOkStatus();
+}
+
+//===----------------------------------------------------------------------===//
+// Benchmark
+//===----------------------------------------------------------------------===//
+
+/// Wait for all device work to complete if the client has devices.
+static Status synchronizeDevices(RuntimeClient &client) {
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  if (!client.getDevices().empty())
+    RETURN_ERROR_IF_CUDART_ERROR(cudaDeviceSynchronize());
+#endif
+  return getOkStatus();
+}
+
+StatusOr<BenchmarkResult>
+runtime::runBenchmark(RuntimeClient &client, LuaRuntimeSession &session,
+                      const BenchmarkOptions &options) {
+  if (options.numIterations <= 0 || options.numWarmupIterations < 0)
+    return getInvalidArgStatus(
+        "expected a positive number of iterations and a non-negative number "
+        "of warmup iterations");
+
+  std::optional<FunctionSignatureView> sig;
+  for (FunctionView func : session.getExecutable().getFunctions()) {
+    if (func.getName() == options.functionName)
+      sig = func.getSignature();
+  }
+  if (!sig)
+    return getInvalidArgStatus("no function named \"{0}\" found",
+                               options.functionName);
+
+  ArgumentBuilder args(client, *sig, options);
+  MTRT_RETURN_IF_ERROR(args.build());
+  MTRT_RETURN_IF_ERROR(synchronizeDevices(client));
+
+  auto execute = [&]() -> Status {
+    StatusOr<llvm::SmallVector<std::unique_ptr<RuntimeValue>>> results =
+        executeFunctionWithLuaBackend(session, options.functionName,
+                                      args.inputArgs, args.outputArgs);
+    if (!results.isOk())
+      return results.getStatus();
+    return synchronizeDevices(client);
+  };
+
+  for (int64_t i = 0; i < options.numWarmupIterations; ++i)
+    MTRT_RETURN_IF_ERROR(execute());
+
+  AllocTracker &tracker = session.getAllocTracker();
+  tracker.resetStatistics();
+  llvm::SmallVector<int64_t> samplesNs;
+  samplesNs.reserve(options.numIterations);
+  int64_t totalNs = 0;
+  for (int64_t i = 0; i < options.numIterations; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    MTRT_RETURN_IF_ERROR(execute());
+    int64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    samplesNs.push_back(durationNs);
+    totalNs += durationNs;
+  }
+
+  BenchmarkResult result;
+  result.functionName = options.functionName;
+  result.numWarmupIterations = options.numWarmupIterations;
+  result.numIterations = options.numIterations;
+  result.totalTimeMs = static_cast<double>(totalNs) / 1e6;
+  result.throughput = totalNs > 0 ? static_cast<double>(options.numIterations) /
+                                        (static_cast<double>(totalNs) / 1e9)
+                                  : 0.0;
+  result.latency = computeLatencyStatistics(samplesNs);
+  result.hostMemory = tracker.getStatistics(PointerType::host);
+  result.pinnedHostMemory = tracker.getStatistics(PointerType::pinned_host);
+  result.deviceMemory = tracker.getStatistics(PointerType::device);
+  return result;
+}
+
+void runtime::printBenchmarkResult(llvm::raw_ostream &os,
+                                   const BenchmarkResult &result) {
+  llvm::json::OStream json(os, /*IndentSize=*/2);
+  auto printMemory = [&](llvm::StringRef name,
+                         const AllocTracker::Statistics &stats) {
+    json.attributeObject(name, [&] {
+      json.attribute("allocations", stats.numAllocations);
+      json.attribute("allocations_per_iteration",
+                     static_cast<double>(stats.numAllocations) /
+                         static_cast<double>(result.numIterations));
+      json.attribute("peak_bytes", stats.peakBytes);
+    });
+  };
+  json.object([&] {
+    json.attribute("function", result.functionName);
+    json.attribute("warmup_iterations", result.numWarmupIterations);
+    json.attribute("iterations", result.numIterations);
+    json.attribute("total_time_ms", result.totalTimeMs);
+    json.attribute("throughput_per_s", result.throughput);
+    json.attributeObject("latency_ms", [&] {
+      json.attribute("min", result.latency.min);
+      json.attribute("max", result.latency.max);
+      json.attribute("mean", result.latency.mean);
+      json.attribute("p50", result.latency.p50);
+      json.attribute("p90", result.latency.p90);
+      json.attribute("p99", result.latency.p99);
+    });
+    json.attributeObject("memory", [&] {
+      printMemory("host", result.hostMemory);
+      printMemory("pinned_host", result.pinnedHostMemory);
+      printMemory("device", result.deviceMemory);
+    });
+  });
+  os << "\n";
+}
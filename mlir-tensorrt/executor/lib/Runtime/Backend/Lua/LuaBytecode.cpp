@@ -0,0 +1,55 @@
+//===- LuaBytecode.cpp ----------------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the compilation of Lua source to bytecode chunks.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Backend/Lua/LuaBytecode.h"
+#include "mlir-executor/Runtime/Backend/Lua/SolAdaptor.h"
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+
+StatusOr<std::string>
+runtime::compileLuaSourceToBytecode(std::string_view source) {
+  sol::state lua;
+  sol::load_result chunk = lua.load(source, sol::detail::default_chunk_name(),
+                                    sol::load_mode::text);
+  if (!chunk.valid()) {
+    sol::error err = chunk;
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "failed to compile lua script: ", err.what());
+  }
+  sol::protected_function func = chunk;
+  std::string bytecode;
+  func.push();
+  int result = lua_dump(
+      lua.lua_state(),
+      [](lua_State *, const void *data, size_t size, void *userData) -> int {
+        static_cast<std::string *>(userData)->append(
+            static_cast<const char *>(data), size);
+        return 0;
+      },
+      &bytecode, /*strip=*/0);
+  lua_pop(lua.lua_state(), 1);
+  if (result != 0)
+    return getInternalErrorStatus("failed to dump lua bytecode");
+  return bytecode;
+}
@@ -0,0 +1,612 @@
+//===- LuaDynamicBatcher.cpp ----------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the dynamic batching front end of the Lua runtime.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Backend/Lua/LuaDynamicBatcher.h"
+#include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
+#include "mlir-executor/Runtime/Support/Support.h"
+#include <cstring>
+
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+#include "cuda_runtime_api.h"
+#endif
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+
+//===----------------------------------------------------------------------===//
+// Row copies
+//===----------------------------------------------------------------------===//
+
+static bool isHostAccessible(PointerType type) {
+  return type == PointerType::host || type == PointerType::pinned_host ||
+         type == PointerType::unified;
+}
+
+static bool hasCanonicalStrides(const MemRefValue &value) {
+  llvm::SmallVector<int64_t> expected = getCanonicalStrides(value.getShape());
+  for (auto [dim, stride, canonical] :
+       llvm::zip_equal(value.getShape(), value.getStrides(), expected))
+    if (dim != 1 && stride != canonical)
+      return false;
+  return true;
+}
+
+namespace {
+/// Describes the rows of a canonical memref along the batch dimension as a
+/// 2D region: `height` runs of `rowSize` bytes per row, where consecutive
+/// runs are `pitch` bytes apart.
+struct RowLayout {
+  int64_t height;
+  int64_t rowSize;
+  int64_t pitch;
+};
+} // namespace
+
+static StatusOr<RowLayout> getRowLayout(const MemRefValue &value,
+                                        unsigned batchDim) {
+  llvm::ArrayRef<int64_t> shape = value.getShape();
+  int64_t height = 1, rowBits = value.getElementBitWidth();
+  for (unsigned i = 0; i < batchDim; ++i)
+    height *= shape[i];
+  for (unsigned i = batchDim + 1; i < shape.size(); ++i)
+    rowBits *= shape[i];
+  if (rowBits % 8 != 0)
+    return getInvalidArgStatus(
+        "cannot batch memrefs whose rows along the batch dimension are not a "
+        "whole number of bytes");
+  return RowLayout{height, rowBits / 8, shape[batchDim] * (rowBits / 8)};
+}
+
+/// Copy `numRows` rows, starting at row `srcRow` of `src`, to `dst` starting
+/// at row `dstRow`.
+static Status copyRows(const MemRefValue &src, int64_t srcRow,
+                       const MemRefValue &dst, int64_t dstRow,
+                       int64_t numRows, unsigned batchDim,
+                       std::optional<CudaStream> stream) {
+  MTRT_ASSIGN_OR_RETURN(RowLayout srcLayout, getRowLayout(src, batchDim));
+  MTRT_ASSIGN_OR_RETURN(RowLayout dstLayout, getRowLayout(dst, batchDim));
+  const char *srcPtr =
+      static_cast<const char *>(src.getVoidPtr()) + srcRow * srcLayout.rowSize;
+  char *dstPtr =
+      static_cast<char *>(dst.getVoidPtr()) + dstRow * dstLayout.rowSize;
+  int64_t width = numRows * srcLayout.rowSize;
+  if (isHostAccessible(src.getAddressSpace()) &&
+      isHostAccessible(dst.getAddressSpace())) {
+    for (int64_t i = 0; i < srcLayout.height; ++i)
+      std::memcpy(dstPtr + i * dstLayout.pitch, srcPtr + i * srcLayout.pitch,
+                  width);
+    return getOkStatus();
+  }
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  RETURN_ERROR_IF_CUDART_ERROR(cudaMemcpy2DAsync(
+      dstPtr, dstLayout.pitch, srcPtr, srcLayout.pitch, width,
+      srcLayout.height, cudaMemcpyDefault,
+      reinterpret_cast<cudaStream_t>(stream.value_or(0))));
+  return getOkStatus();
+#else
+  return getInvalidArgStatus(
+      "batching device memrefs requires a runtime built with CUDA support");
+#endif
+}
+
+/// Zero `numRows` rows of `dst` starting at row `row`.
+static Status zeroRows(const MemRefValue &dst, int64_t row, int64_t numRows,
+                       unsigned batchDim, std::optional<CudaStream> stream) {
+  MTRT_ASSIGN_OR_RETURN(RowLayout layout, getRowLayout(dst, batchDim));
+  char *ptr = static_cast<char *>(dst.getVoidPtr()) + row * layout.rowSize;
+  int64_t width = numRows * layout.rowSize;
+  if (isHostAccessible(dst.getAddressSpace())) {
+    for (int64_t i = 0; i < layout.height; ++i)
+      std::memset(ptr + i * layout.pitch, 0, width);
+    return getOkStatus();
+  }
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  RETURN_ERROR_IF_CUDART_ERROR(
+      cudaMemset2DAsync(ptr, layout.pitch, 0, width, layout.height,
+                        reinterpret_cast<cudaStream_t>(stream.value_or(0))));
+  return getOkStatus();
+#else
+  return getInvalidArgStatus(
+      "batching device memrefs requires a runtime built with CUDA support");
+#endif
+}
+
+//===----------------------------------------------------------------------===//
+// Request validation
+//===----------------------------------------------------------------------===//
+
+/// Check `value` against the signature type `type`, ignoring the extent of
+/// the batch dimension.
+static Status validateArg(const RuntimeValue *value, TypeUnionView type,
+                          unsigned batchDim) {
+  if (type.isa<ScalarTypeView>()) {
+    const auto *scalar = llvm::dyn_cast<ScalarValue>(value);
+    if (!scalar || scalar->getType().getCode() != type.get<ScalarTypeView>())
+      return getInvalidArgStatus("expected a scalar of type {0}",
+                                 impl::EnumNameScalarTypeCode(
+                                     type.get<ScalarTypeView>()));
+    return getOkStatus();
+  }
+
+  auto memrefType = type.get<MemRefTypeView>();
+  const auto *memref = llvm::dyn_cast<MemRefValue>(value);
+  if (!memref)
+    return getInvalidArgStatus("expected a memref");
+  if (memref->getScalarType() != memrefType.getElementType() ||
+      memref->getAddressSpace() != memrefType.getAddressSpace() ||
+      memref->getRank() != memrefType.getRank())
+    return getInvalidArgStatus(
+        "expected a memref with element type {0}, address space {1} and rank "
+        "{2}",
+        memrefType.getElementType().getStrRef(),
+        EnumNamePointerType(memrefType.getAddressSpace()),
+        memrefType.getRank());
+  for (auto [idx, expected, actual] :
+       llvm::enumerate(memrefType.getShape(), memref->getShape()))
+    if (idx != batchDim && expected >= 0 && expected != actual)
+      return getInvalidArgStatus(
+          "expected shape [{0:$[, ]}] (except for the batch dimension) but "
+          "received [{1:$[, ]}]",
+          memrefType.getShape(), memref->getShape());
+  if (!hasCanonicalStrides(*memref))
+    return getInvalidArgStatus(
+        "batched memrefs must have canonical strides but received "
+        "[{0:$[, ]}]",
+        memref->getStrides());
+  // Rows are copied relative to the start of the buffer.
+  if (memref->getOffset() != 0)
+    return getInvalidArgStatus(
+        "batched memrefs must have a zero offset but received {0}",
+        memref->getOffset());
+  return getOkStatus();
+}
+
+/// Return true if `lhs` and `rhs` can be passed in the same position of two
+/// requests of a batch.
+static bool areBatchable(const RuntimeValue *lhs, const RuntimeValue *rhs,
+                         unsigned batchDim) {
+  if (const auto *lhsScalar = llvm::dyn_cast<ScalarValue>(lhs)) {
+    const auto *rhsScalar = llvm::cast<ScalarValue>(rhs);
+    return lhsScalar->getType() == rhsScalar->getType() &&
+           lhsScalar->get<int64_t>() == rhsScalar->get<int64_t>();
+  }
+  const auto *lhsMemRef = llvm::cast<MemRefValue>(lhs);
+  const auto *rhsMemRef = llvm::cast<MemRefValue>(rhs);
+  if (lhsMemRef->getAddressSpace() != rhsMemRef->getAddressSpace() ||
+      lhsMemRef->getDevice() != rhsMemRef->getDevice())
+    return false;
+  for (auto [idx, lhsDim, rhsDim] :
+       llvm::enumerate(lhsMemRef->getShape(), rhsMemRef->getShape()))
+    if (idx != batchDim && lhsDim != rhsDim)
+      return false;
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// LuaDynamicBatcher
+//===----------------------------------------------------------------------===//
+
+/// The requests and batched buffers of a batch in flight.
+struct LuaDynamicBatcher::Batch {
+  std::vector<Request> requests;
+  /// The first row of each request in the batched buffers.
+  llvm::SmallVector<int64_t> rowOffsets;
+  /// The number of rows of all requests and of padding.
+  int64_t numRows{0};
+  int64_t numPaddingRows{0};
+  /// The batched buffer of each argument (inputs, then outputs), or null for
+  /// scalar arguments. Empty if the request is passed through.
+  llvm::SmallVector<std::unique_ptr<MemRefValue>> buffers;
+  llvm::SmallVector<RuntimeValue *> inputArgs;
+  llvm::SmallVector<RuntimeValue *> outputArgs;
+  /// Whether any batched buffer is not host-accessible.
+  bool usesDevice{false};
+};
+
+LuaDynamicBatcher::LuaDynamicBatcher(RuntimeClient &client,
+                                     LuaSessionPool &pool,
+                                     ExecutableView executable,
+                                     DynamicBatchingOptions options)
+    : client(client), pool(pool), executable(executable),
+      options(std::move(options)) {
+  stats.batchSize = Histogram::getExponential(/*numBuckets=*/16);
+  stats.latencyUs = Histogram::getExponential(/*numBuckets=*/24);
+}
+
+StatusOr<std::unique_ptr<LuaDynamicBatcher>>
+LuaDynamicBatcher::create(RuntimeClient &client, LuaSessionPool &pool,
+                          ExecutableView executable,
+                          DynamicBatchingOptions options) {
+  if (options.maxBatchSize < 0)
+    return getInvalidArgStatus("the maximum batch size must not be negative");
+  if (options.maxQueueDelay.count() < 0)
+    return getInvalidArgStatus("the maximum queue delay must not be negative");
+  auto batcher = std::unique_ptr<LuaDynamicBatcher>(
+      new LuaDynamicBatcher(client, pool, executable, std::move(options)));
+  batcher->dispatcher =
+      std::thread([self = batcher.get()]() { self->run(); });
+  return batcher;
+}
+
+LuaDynamicBatcher::~LuaDynamicBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    shuttingDown = true;
+  }
+  wakeCondition.notify_all();
+  dispatcher.join();
+
+  // The dispatcher launched all queued requests before exiting.
+  std::unique_lock<std::mutex> lock(mutex);
+  wakeCondition.wait(lock, [&]() { return numInFlightBatches == 0; });
+}
+
+StatusOr<LuaDynamicBatcher::FunctionQueue *>
+LuaDynamicBatcher::getOrCreateQueue(std::string_view name) {
+  auto it = queues.find(name);
+  if (it != queues.end())
+    return it->second.get();
+
+  std::optional<FunctionView> func = lookupFunction(executable, name);
+  if (!func)
+    return getInvalidArgStatus("no function named \"{0}\" in the executable",
+                               name);
+  FunctionSignatureView sig = func->getSignature();
+  if (sig.getNumResults() > 0 || sig.hasOutputAliases())
+    return getInvalidArgStatus("function \"{0}\" cannot be batched because it "
+                               "returns results or aliases outputs to inputs",
+                               name);
+
+  // The batch size is limited by static extents and by the dimension bounds
+  // of the batch dimension of all memref arguments.
+  const unsigned batchDim = options.batchDim;
+  int64_t maxBatchSize = std::numeric_limits<int64_t>::max();
+  int64_t minBatchSize = 1;
+  bool isBounded = false, hasMemRef = false;
+  for (unsigned i = 0, e = sig.getNumArgs(); i < e; ++i) {
+    TypeUnionView arg = sig.getArg(i);
+    if (!arg.isa<MemRefTypeView>())
+      continue;
+    auto type = arg.get<MemRefTypeView>();
+    if (type.getRank() <= batchDim)
+      return getInvalidArgStatus(
+          "argument {0} of function \"{1}\" has rank {2} and no batch "
+          "dimension {3}",
+          i, name, type.getRank(), batchDim);
+    hasMemRef = true;
+    if (int64_t extent = type.getShape()[batchDim]; extent >= 0) {
+      maxBatchSize = std::min(maxBatchSize, extent);
+      minBatchSize = std::max(minBatchSize, extent);
+      isBounded = true;
+      continue;
+    }
+    if (i >= sig.getNumArgBounds() ||
+        !sig.getArgBound(i).isa<DimensionBoundsView>())
+      continue;
+    auto bounds = sig.getArgBound(i).get<DimensionBoundsView>();
+    if (bounds.getMax().size() <= batchDim)
+      continue;
+    maxBatchSize = std::min(maxBatchSize, bounds.getMax()[batchDim]);
+    minBatchSize = std::max(minBatchSize, bounds.getMin()[batchDim]);
+    isBounded = true;
+  }
+  if (!hasMemRef)
+    return getInvalidArgStatus(
+        "function \"{0}\" has no memref arguments to batch", name);
+  if (!isBounded && options.maxBatchSize == 0)
+    return getInvalidArgStatus(
+        "the signature of function \"{0}\" does not bound batch dimension "
+        "{1}; a maximum batch size must be specified",
+        name, batchDim);
+  if (maxBatchSize < minBatchSize)
+    return getInvalidArgStatus(
+        "function \"{0}\" has inconsistent bounds for batch dimension {1}",
+        name, batchDim);
+  if (options.maxBatchSize > 0)
+    maxBatchSize = std::min(maxBatchSize, options.maxBatchSize);
+
+  auto queue = std::make_unique<FunctionQueue>();
+  queue->name = std::string(name);
+  queue->maxBatchSize = maxBatchSize;
+  queue->minBatchSize = minBatchSize;
+  MTRT_DBGF("batching function \"%s\" with batch sizes in [%ld, %ld]",
+            queue->name.c_str(), static_cast<long>(minBatchSize),
+            static_cast<long>(maxBatchSize));
+  FunctionQueue *result = queue.get();
+  queues.emplace(std::string(name), std::move(queue));
+  return result;
+}
+
+Status LuaDynamicBatcher::submit(std::string_view name,
+                                 llvm::ArrayRef<RuntimeValue *> inputArgs,
+                                 llvm::ArrayRef<RuntimeValue *> outputArgs,
+                                 Callback callback) {
+  std::unique_lock<std::mutex> lock(mutex);
+  MTRT_ASSIGN_OR_RETURN(FunctionQueue * queue, getOrCreateQueue(name));
+  lock.unlock();
+
+  // Queues are never removed, so `queue` stays valid without the lock.
+  FunctionSignatureView sig = executable.getFunction(name).getSignature();
+  if (sig.getNumInputArgs() != inputArgs.size() ||
+      sig.getNumOutputArgs() != outputArgs.size())
+    return getInvalidArgStatus(
+        "function \"{0}\" expects {1} input and {2} output args but received "
+        "{3} and {4}",
+        name, sig.getNumInputArgs(), sig.getNumOutputArgs(), inputArgs.size(),
+        outputArgs.size());
+
+  std::optional<int64_t> numRows;
+  for (unsigned i = 0, e = sig.getNumArgs(); i < e; ++i) {
+    RuntimeValue *value =
+        i < inputArgs.size() ? inputArgs[i] : outputArgs[i - inputArgs.size()];
+    Status status = validateArg(value, sig.getArg(i), options.batchDim);
+    if (!status.isOk())
+      return getInvalidArgStatus("argument {0} of function \"{1}\": {2}", i,
+                                 name, status.getString());
+    const auto *memref = llvm::dyn_cast<MemRefValue>(value);
+    if (!memref)
+      continue;
+    int64_t rows = memref->getShape()[options.batchDim];
+    if (numRows && *numRows != rows)
+      return getInvalidArgStatus(
+          "all memref arguments of a request must have the same extent along "
+          "batch dimension {0}",
+          options.batchDim);
+    numRows = rows;
+  }
+  assert(numRows && "expected a batchable function to have memref args");
+  if (*numRows < 1 || *numRows > queue->maxBatchSize)
+    return getInvalidArgStatus(
+        "the batch extent {0} of the request is outside of [1, {1}]", *numRows,
+        queue->maxBatchSize);
+
+  lock.lock();
+  queue->requests.push_back(
+      Request{llvm::SmallVector<RuntimeValue *>(inputArgs),
+              llvm::SmallVector<RuntimeValue *>(outputArgs), *numRows,
+              std::move(callback), Clock::now()});
+  wakeCondition.notify_all();
+  return getOkStatus();
+}
+
+std::future<Status>
+LuaDynamicBatcher::submit(std::string_view name,
+                          llvm::ArrayRef<RuntimeValue *> inputArgs,
+                          llvm::ArrayRef<RuntimeValue *> outputArgs) {
+  auto promise = std::make_shared<std::promise<Status>>();
+  std::future<Status> result = promise->get_future();
+  Status status = submit(
+      name, inputArgs, outputArgs,
+      [promise](Status status) { promise->set_value(std::move(status)); });
+  if (!status.isOk())
+    promise->set_value(std::move(status));
+  return result;
+}
+
+std::pair<size_t, bool>
+LuaDynamicBatcher::getNextBatchSize(const FunctionQueue &queue) const {
+  const Request &head = queue.requests.front();
+  int64_t numRows = 0;
+  size_t numRequests = 0;
+  for (const Request &request : queue.requests) {
+    bool compatible = numRows + request.numRows <= queue.maxBatchSize;
+    for (auto [lhs, rhs] : llvm::zip_equal(head.inputArgs, request.inputArgs))
+      compatible &= areBatchable(lhs, rhs, options.batchDim);
+    for (auto [lhs, rhs] : llvm::zip_equal(head.outputArgs, request.outputArgs))
+      compatible &= areBatchable(lhs, rhs, options.batchDim);
+    if (!compatible)
+      return {numRequests, true};
+    numRows += request.numRows;
+    ++numRequests;
+  }
+  return {numRequests, numRows == queue.maxBatchSize};
+}
+
+void LuaDynamicBatcher::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    std::optional<Clock::time_point> deadline;
+    bool launched = false;
+    for (auto &it : queues) {
+      FunctionQueue &queue = *it.second;
+      while (!queue.requests.empty()) {
+        auto [numRequests, isComplete] = getNextBatchSize(queue);
+        Clock::time_point expiry =
+            queue.requests.front().submitTime + options.maxQueueDelay;
+        if (!isComplete && !shuttingDown && Clock::now() < expiry) {
+          deadline = deadline ? std::min(*deadline, expiry) : expiry;
+          break;
+        }
+        std::vector<Request> requests(
+            std::make_move_iterator(queue.requests.begin()),
+            std::make_move_iterator(queue.requests.begin() + numRequests));
+        queue.requests.erase(queue.requests.begin(),
+                             queue.requests.begin() + numRequests);
+        ++numInFlightBatches;
+        launched = true;
+        lock.unlock();
+        launch(queue, std::move(requests));
+        lock.lock();
+      }
+    }
+
+    // Requests may have been queued while the lock was released, so only
+    // sleep after a scan that launched nothing.
+    if (launched)
+      continue;
+    if (shuttingDown)
+      return;
+    if (deadline)
+      wakeCondition.wait_until(lock, *deadline);
+    else
+      wakeCondition.wait(lock);
+  }
+}
+
+void LuaDynamicBatcher::launch(const FunctionQueue &queue,
+                               std::vector<Request> requests) {
+  auto batch = std::make_shared<Batch>();
+  batch->requests = std::move(requests);
+  for (const Request &request : batch->requests) {
+    batch->rowOffsets.push_back(batch->numRows);
+    batch->numRows += request.numRows;
+  }
+  int64_t batchSize = options.padToMaxBatchSize
+                          ? std::max(queue.maxBatchSize, queue.minBatchSize)
+                          : std::max(batch->numRows, queue.minBatchSize);
+  batch->numPaddingRows = batchSize - batch->numRows;
+  auto onComplete = [this, batch](Status status) {
+    complete(*batch, std::move(status));
+  };
+
+  // A lone request without padding does not need to be copied.
+  if (batch->requests.size() == 1 && batch->numPaddingRows == 0) {
+    const Request &request = batch->requests.front();
+    pool.submit(queue.name, request.inputArgs, request.outputArgs, onComplete,
+                options.stream);
+    return;
+  }
+
+  // Allocate the batched buffers and gather the inputs.
+  auto gather = [&]() -> Status {
+    const Request &head = batch->requests.front();
+    const unsigned numInputs = head.inputArgs.size();
+    for (unsigned i = 0, e = numInputs + head.outputArgs.size(); i < e; ++i) {
+      bool isInput = i < numInputs;
+      RuntimeValue *prototype =
+          isInput ? head.inputArgs[i] : head.outputArgs[i - numInputs];
+      auto *memref = llvm::dyn_cast<MemRefValue>(prototype);
+      if (!memref) {
+        batch->buffers.push_back(nullptr);
+        batch->inputArgs.push_back(prototype);
+        continue;
+      }
+
+      llvm::SmallVector<int64_t> shape(memref->getShape());
+      shape[options.batchDim] = batchSize;
+      MTRT_ASSIGN_OR_RETURN(
+          std::unique_ptr<MemRefValue> buffer,
+          client.allocateMemRef(memref->getAddressSpace(),
+                                memref->getElementBitWidth(), shape,
+                                getCanonicalStrides(shape),
+                                memref->getDevice(), options.stream,
+                                memref->getScalarType()));
+      batch->usesDevice |= !isHostAccessible(memref->getAddressSpace());
+      if (isInput) {
+        for (auto [request, rowOffset] :
+             llvm::zip_equal(batch->requests, batch->rowOffsets))
+          MTRT_RETURN_IF_ERROR(
+              copyRows(*llvm::cast<MemRefValue>(request.inputArgs[i]), 0,
+                       *buffer, rowOffset, request.numRows, options.batchDim,
+                       options.stream));
+        if (batch->numPaddingRows > 0)
+          MTRT_RETURN_IF_ERROR(zeroRows(*buffer, batch->numRows,
+                                        batch->numPaddingRows,
+                                        options.batchDim, options.stream));
+        batch->inputArgs.push_back(buffer.get());
+      } else {
+        batch->outputArgs.push_back(buffer.get());
+      }
+      batch->buffers.push_back(std::move(buffer));
+    }
+    return getOkStatus();
+  };
+
+  Status status = gather();
+  if (!status.isOk()) {
+    complete(*batch, std::move(status));
+    return;
+  }
+  pool.submit(queue.name, batch->inputArgs, batch->outputArgs, onComplete,
+              options.stream);
+}
+
+void LuaDynamicBatcher::complete(Batch &batch, Status status) {
+  if (!batch.buffers.empty()) {
+    // Scatter the slices of the batched outputs back to the requests.
+    auto scatter = [&]() -> Status {
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+      if (batch.usesDevice || options.stream)
+        RETURN_ERROR_IF_CUDART_ERROR(cudaStreamSynchronize(
+            reinterpret_cast<cudaStream_t>(options.stream.value_or(0))));
+#endif
+      const unsigned numInputs = batch.requests.front().inputArgs.size();
+      for (unsigned i = numInputs, e = batch.buffers.size(); i < e; ++i)
+        for (auto [request, rowOffset] :
+             llvm::zip_equal(batch.requests, batch.rowOffsets))
+          MTRT_RETURN_IF_ERROR(copyRows(
+              *batch.buffers[i], rowOffset,
+              *llvm::cast<MemRefValue>(request.outputArgs[i - numInputs]), 0,
+              request.numRows, options.batchDim, options.stream));
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+      if (batch.usesDevice || options.stream)
+        RETURN_ERROR_IF_CUDART_ERROR(cudaStreamSynchronize(
+            reinterpret_cast<cudaStream_t>(options.stream.value_or(0))));
+#endif
+      return getOkStatus();
+    };
+    if (status.isOk())
+      status = scatter();
+
+    for (std::unique_ptr<MemRefValue> &buffer : batch.buffers) {
+      if (!buffer)
+        continue;
+      Status freed = client.deallocate(std::move(buffer), options.stream);
+      if (status.isOk() && !freed.isOk())
+        status = std::move(freed);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.numBatches++;
+    stats.numPaddingRows += batch.numPaddingRows;
+    stats.batchSize.record(batch.numRows);
+  }
+  for (Request &request : batch.requests)
+    finish(request, status);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    --numInFlightBatches;
+  }
+  wakeCondition.notify_all();
+}
+
+void LuaDynamicBatcher::finish(Request &request, Status status) {
+  int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                        Clock::now() - request.submitTime)
+                        .count();
+  {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.numRequests++;
+    stats.latencyUs.record(latency);
+  }
+  if (request.callback)
+    request.callback(std::move(status));
+}
+
+LuaDynamicBatcher::Statistics LuaDynamicBatcher::getStatistics() const {
+  std::lock_guard<std::mutex> lock(statsMutex);
+  return stats;
+}
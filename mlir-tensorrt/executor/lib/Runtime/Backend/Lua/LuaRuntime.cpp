@@ -27,6 +27,9 @@
 #include "mlir-executor/Runtime/API/ExecutableFlatbuffer.h"
 #include "mlir-executor/Runtime/Backend/Common/CUDACommon.h"
 #include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaAsync.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaBytecode.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaErrorHandling.h"
 #include "mlir-executor/Runtime/Backend/Lua/LuaRegistration.h"
 #include "mlir-executor/Runtime/Backend/Lua/Modules/CUDA/CudaModule.h"
 #include "mlir-executor/Runtime/Backend/Lua/Modules/Core/CoreModule.h"
@@ -38,8 +41,9 @@
 #include "mlir-executor/Runtime/Support/Support.h"
 #include "mlir-executor/Support/Allocators.h"
 #include "mlir-executor/Support/Status.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
-#include "llvm/Support/Alignment.h"
+#include "llvm/ADT/StringMap.h"
 #include <memory>
 
 #if defined(__clang__)
@@ -55,8 +59,6 @@
 using namespace mlirtrt;
 using namespace mlirtrt::runtime;
 
-static constexpr uint64_t kMinConstantBufferByteAlignment = 8;
-
 #ifndef MLIR_EXECUTOR_ENABLE_NCCL
 /// Registers functions that are dependent on certain parameters like the
 /// device number and ncclUniqueId. This is usually called late just before
@@ -76,10 +78,12 @@ static void registerDefaultDeviceDependentMethods(lua_State *state,
 #endif
 
 static void registerLuaRuntimeMethodsCommon(
-    lua_State *state, PinnedMemoryAllocator *pinnedMemoryAllocator,
-    AllocTracker *allocTracker, ResourceTracker *resourceTracker) {
+    lua_State *state, const RuntimeSessionOptions &options,
+    PinnedMemoryAllocator *pinnedMemoryAllocator, AllocTracker *allocTracker,
+    ResourceTracker *resourceTracker) {
   registerExecutorCoreModuleLuaRuntimeMethods(state, pinnedMemoryAllocator,
-                                              allocTracker);
+                                              allocTracker,
+                                              options.getNumHostCopyThreads());
 
 #ifdef MLIR_EXECUTOR_ENABLE_CUDA
   registerExecutorCUDAModuleLuaRuntimeMethods(
@@ -101,8 +105,8 @@ void mlirtrt::runtime::registerLuaRuntimeMethods(
     lua_State *state, const RuntimeSessionOptions &options,
     PinnedMemoryAllocator *pinnedMemoryAllocator, AllocTracker *allocTracker,
     ResourceTracker *resourceTracker) {
-  registerLuaRuntimeMethodsCommon(state, pinnedMemoryAllocator, allocTracker,
-                                  resourceTracker);
+  registerLuaRuntimeMethodsCommon(state, options, pinnedMemoryAllocator,
+                                  allocTracker, resourceTracker);
 #ifdef MLIR_EXECUTOR_ENABLE_NCCL
   registerExecutorNCCLModuleLuaRuntimeMethods(state, resourceTracker);
   registerDeviceDependentNCCLMethods(state, options.getNumDevices(),
@@ -117,27 +121,155 @@ void mlirtrt::runtime::registerLuaRuntimeMethods(
 #endif
 }
 
-/// If the program was compiled with NCCL enabled, then check for the
-/// NCCL uuid if the system has multiple GPUs.
-static Status maybeCheckForValidNcclUuid(const RuntimeSessionOptions &options) {
-#if MLIR_EXECUTOR_ENABLE_NCCL
+//===----------------------------------------------------------------------===//
+// LuaRuntimeSession
+//===----------------------------------------------------------------------===//
 
-  if (options.getNumDevices() > 1 && options.getNcclUuid().empty())
-    return getInternalErrorStatus(
-        "number of devices is {0} but the NCCL UUID is empty",
-        options.getNumDevices());
+/// Open the standard Lua libraries and register the builtin and user-provided
+/// runtime modules in the session's Lua state.
+static void registerSessionModules(
+    LuaRuntimeSession &session,
+    const LuaRuntimeSession::LuaModuleRegistrationFunc &registerExtraLuaFuncs) {
+  sol::state &lua = session.getLuaState();
+  lua.open_libraries(sol::lib::base, sol::lib::string, sol::lib::coroutine);
 
-  MTRT_DBG("creating session with DeviceID={0}/{1} UUID={2}",
-           options.getDeviceId(), options.getNumDevices(),
-           options.getNcclUuid());
+  // Register builtin methods.
+  registerLuaRuntimeMethods(lua.lua_state(), session.getOptions(),
+                            &session.getPinnedMemorAllocator(),
+                            &session.getAllocTracker(),
+                            &session.getResourceTracker());
 
-#endif
+  // Register user-provided methods.
+  if (registerExtraLuaFuncs)
+    registerExtraLuaFuncs(lua.lua_state(), &session.getAllocTracker(),
+                          &session.getResourceTracker());
+}
+
+/// Load a Lua chunk (source or bytecode, as given by `mode`) into `lua` and
+/// run it.
+static Status loadLuaChunk(sol::state &lua, std::string_view chunk,
+                           sol::load_mode mode) {
+  sol::protected_function_result result =
+      lua.script(chunk, sol::script_pass_on_error,
+                 sol::detail::default_chunk_name(), mode);
+  if (!result.valid()) {
+    sol::error err = result;
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "failed to load lua script: ", err.what());
+  }
   return getOkStatus();
 }
 
-//===----------------------------------------------------------------------===//
-// LuaRuntimeSession
-//===----------------------------------------------------------------------===//
+/// Return the executable's precompiled bytecode if it is present and can be
+/// loaded by this runtime, otherwise return an empty string.
+static std::string_view getCompatibleBytecode(ExecutableView executable) {
+  std::string_view bytecode = executable.getBytecode();
+  if (bytecode.empty())
+    return {};
+  if (executable.getBytecodeLuaVersion() != LUA_VERSION_NUM) {
+    MTRT_DBGF("executable bytecode was produced by Lua version %u but the "
+              "runtime uses version %u, loading source instead",
+              executable.getBytecodeLuaVersion(),
+              static_cast<unsigned>(LUA_VERSION_NUM));
+    return {};
+  }
+  return bytecode;
+}
+
+/// Load the executable's code into `lua` and run it. If `useBytecode` is true,
+/// then the precompiled bytecode is used if it is compatible; the source is
+/// used as a fallback.
+static Status loadExecutableCode(sol::state &lua, ExecutableView executable,
+                                 bool useBytecode) {
+  if (std::string_view bytecode =
+          useBytecode ? getCompatibleBytecode(executable) : std::string_view();
+      !bytecode.empty()) {
+    sol::load_result chunk = lua.load(
+        bytecode, sol::detail::default_chunk_name(), sol::load_mode::binary);
+    if (chunk.valid()) {
+      sol::protected_function func = chunk;
+      sol::protected_function_result result = func();
+      if (!result.valid()) {
+        sol::error err = result;
+        return getStatusWithMsg(StatusCode::InternalError,
+                                "failed to load lua script: ", err.what());
+      }
+      return getOkStatus();
+    }
+    sol::error err = chunk;
+    MTRT_WARNV("failed to load executable bytecode, loading source instead: "
+               "{0}",
+               err.what());
+  }
+  return loadLuaChunk(lua, executable.getCode(), sol::load_mode::text);
+}
+
+/// Call the `executor_init_globals` function, if present.
+static Status initializeGlobals(sol::state &lua) {
+  sol::protected_function initGlobals = lua["executor_init_globals"];
+  if (initGlobals.get_type() != sol::type::function)
+    return getOkStatus();
+  if (!initGlobals.is<std::function<void()>>())
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "executor_init_globals function should have "
+                            "signature function<void()>");
+  sol::protected_function_result result = initGlobals();
+  if (!result.valid()) {
+    sol::error err(result);
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "failed to initialize globals: ", err.what());
+  }
+  return getOkStatus();
+}
+
+/// The name of the global table that holds the constants of the executable.
+static constexpr std::string_view kConstantsTableName = "executor_constants";
+
+/// Install a metatable on the constants table `constantsTable` that
+/// materializes each of the `constants` when it is first read. Constants are
+/// decoded into host buffers owned by `tracker`, which must outlive the Lua
+/// state. Lookups of other globals are not affected.
+static void installLazyConstantLoader(sol::state &lua,
+                                      sol::table &constantsTable,
+                                      AllocTracker &tracker,
+                                      llvm::ArrayRef<ConstantView> constants) {
+  struct LazyConstants {
+    /// Constants that have not been materialized yet.
+    llvm::StringMap<ConstantView> pending;
+    /// Buffers of materialized constants, shared between aliases.
+    llvm::DenseMap<ConstantDataKey, uintptr_t> materialized;
+  };
+  auto state = std::make_shared<LazyConstants>();
+  for (ConstantView constant : constants)
+    state->pending.try_emplace(constant.getName(), constant);
+
+  sol::table metatable = lua.create_table();
+  metatable[sol::meta_function::index] =
+      [state, &tracker](sol::this_state lstate, sol::table table,
+                        sol::stack_object key) -> sol::object {
+    sol::state_view lua(lstate);
+    if (key.get_type() != sol::type::string)
+      return sol::make_object(lua, sol::lua_nil);
+    std::string_view name = key.as<std::string_view>();
+    auto it = state->pending.find(name);
+    if (it == state->pending.end())
+      return sol::make_object(lua, sol::lua_nil);
+
+    ConstantDataKey dataKey = getConstantDataKey(it->second);
+    auto bufferIt = state->materialized.find(dataKey);
+    if (bufferIt == state->materialized.end()) {
+      StatusOr<uintptr_t> ptr = materializeConstant(it->second, tracker);
+      SET_LUA_ERROR_AND_RETURN_IF_ERROR(ptr, lstate,
+                                        sol::make_object(lua, sol::lua_nil));
+      bufferIt = state->materialized.try_emplace(dataKey, *ptr).first;
+    }
+    uintptr_t ptr = bufferIt->second;
+    state->pending.erase(it);
+    table.raw_set(name, ptr);
+    return sol::make_object(lua, ptr);
+  };
+  constantsTable[sol::metatable_key] = metatable;
+}
 
 StatusOr<std::unique_ptr<LuaRuntimeSession>>
 LuaRuntimeSession::create(RuntimeSessionOptions options,
@@ -148,75 +280,31 @@ LuaRuntimeSession::create(RuntimeSessionOptions options,
   auto session = std::unique_ptr<LuaRuntimeSession>(
       new LuaRuntimeSession(std::move(options), executable));
   sol::state &lua = session->getLuaState();
-  lua.open_libraries(sol::lib::base, sol::lib::string, sol::lib::coroutine);
-
-  // Register builtin methods.
-  registerLuaRuntimeMethods(lua.lua_state(), session->getOptions(),
-                            &session->getPinnedMemorAllocator(),
-                            &session->getAllocTracker(),
-                            &session->getResourceTracker());
-
-  // Register user-provided methods.
-  if (registerExtraLuaFuncs)
-    registerExtraLuaFuncs(session->getLuaState().lua_state(),
-                          &session->getAllocTracker(),
-                          &session->getResourceTracker());
+  registerSessionModules(*session, registerExtraLuaFuncs);
 
   // Load globals into the context.
-  // TODO: eliminate this copy, we already own the executable.
   if (session->getExecutable()) {
     ExecutableView executable = session->getExecutable();
-    MTRT_DBGF("loading %lu constants", executable.getConstants().size());
-    for (ConstantView constant : executable.getConstants()) {
-      size_t bytes = constant.size();
-      if (!llvm::isAddrAligned(llvm::Align(kMinConstantBufferByteAlignment),
-                               constant.data())) {
-        MTRT_WARNV("constant (name={0}, size={1}) is not aligned to minimum "
-                   "{2} bytes copying into runtime session context",
-                   constant.getName(), constant.size(),
-                   kMinConstantBufferByteAlignment);
-        MTRT_ASSIGN_OR_RETURN(StatusOr<PointerInfo> buffer,
-                              mlirtrt::runtime::allocate(
-                                  session->getAllocTracker(), PointerType::host,
-                                  bytes, kMinConstantBufferByteAlignment, {}));
-        std::memcpy(reinterpret_cast<void *>(buffer->ptr),
-                    reinterpret_cast<const void *>(constant.data()), bytes);
-        lua[constant.getName()] = buffer->ptr;
-        continue;
-      }
-
-      // Otherwise, just use an external view.
-      lua[constant.getName()] = reinterpret_cast<uintptr_t>(constant.data());
-      session->getAllocTracker().track(PointerInfo(
-          reinterpret_cast<uintptr_t>(constant.data()), constant.size(),
-          PointerType::host, PointerOwner::external));
-    }
+    // Encoded constants are only materialized when they are first used.
+    llvm::SmallVector<ConstantView> encodedConstants;
+    sol::table constantsTable = lua.create_named_table(kConstantsTableName);
+    MTRT_RETURN_IF_ERROR(loadConstants(
+        executable, session->getAllocTracker(),
+        [&](std::string_view name, uintptr_t ptr) {
+          constantsTable[name] = ptr;
+        },
+        [&](ConstantView constant) { encodedConstants.push_back(constant); }));
+    if (!encodedConstants.empty())
+      installLazyConstantLoader(lua, constantsTable,
+                                session->getAllocTracker(), encodedConstants);
 
     // Load the main Lua script.
-    sol::protected_function_result result =
-        lua.script(executable.getCode(), sol::script_pass_on_error);
-    if (!result.valid()) {
-      sol::error err = result;
-      return getStatusWithMsg(StatusCode::InternalError,
-                              "failed to load lua script: ", err.what());
-    }
-  }
-
-  // Call the executor_init_globals function, if present.
-  sol::protected_function initGlobals = lua["executor_init_globals"];
-  if (initGlobals.get_type() == sol::type::function) {
-    if (!initGlobals.is<std::function<void()>>())
-      return getStatusWithMsg(StatusCode::InternalError,
-                              "executor_init_globals function should have "
-                              "signature function<void()>");
-    sol::protected_function_result result = initGlobals();
-    if (!result.valid()) {
-      sol::error err(result);
-      return getStatusWithMsg(StatusCode::InternalError,
-                              "failed to initialize globals: ", err.what());
-    }
+    MTRT_RETURN_IF_ERROR(loadExecutableCode(
+        lua, executable,
+        session->getOptions().isExecutableBytecodeEnabled()));
   }
 
+  MTRT_RETURN_IF_ERROR(initializeGlobals(lua));
   return session;
 }
 
@@ -233,6 +321,13 @@ CudaStream LuaRuntimeSession::getCudaStream() {
 /// Set the primary stream for the loaded executable to use.
 Status LuaRuntimeSession::setCudaStream(CudaStream stream) {
 #ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  // Suspended executions read the stream again when they are resumed, so it
+  // must not change while any of them is in flight.
+  if (numInFlightExecutions > 0 && getCudaStream() != stream)
+    return getInvalidArgStatus(
+        "cannot switch the session to stream 0x{0:x} while {1} asynchronous "
+        "execution(s) are in flight on stream 0x{2:x}",
+        stream, numInFlightExecutions, getCudaStream());
   state["stream0"] = CudaStreamPtr(stream);
   return getOkStatus();
 #else
@@ -240,13 +335,70 @@ Status LuaRuntimeSession::setCudaStream(CudaStream stream) {
 #endif
 }
 
+//===----------------------------------------------------------------------===//
+// LuaRuntimeSessionTemplate
+//===----------------------------------------------------------------------===//
+
+StatusOr<std::unique_ptr<LuaRuntimeSessionTemplate>>
+LuaRuntimeSessionTemplate::create(ExecutableView executable,
+                                  bool useExecutableBytecode) {
+  if (!executable)
+    return getInvalidArgStatus("a session template requires an executable");
+
+  auto tmpl = std::unique_ptr<LuaRuntimeSessionTemplate>(
+      new LuaRuntimeSessionTemplate(executable));
+  MTRT_RETURN_IF_ERROR(loadConstants(
+      executable, tmpl->constantTracker,
+      [&](std::string_view name, uintptr_t ptr) {
+        tmpl->constants.emplace_back(std::string(name), ptr);
+      }));
+
+  // Reuse the executable's bytecode if allowed and it loads, otherwise compile
+  // the source.
+  if (useExecutableBytecode)
+    tmpl->bytecode = getCompatibleBytecode(executable);
+  if (!tmpl->bytecode.empty()) {
+    sol::state lua;
+    if (lua.load(tmpl->bytecode, sol::detail::default_chunk_name(),
+                 sol::load_mode::binary)
+            .valid())
+      return tmpl;
+  }
+  MTRT_ASSIGN_OR_RETURN(tmpl->ownedBytecode,
+                        compileLuaSourceToBytecode(executable.getCode()));
+  tmpl->bytecode = tmpl->ownedBytecode;
+  return tmpl;
+}
+
+StatusOr<std::unique_ptr<LuaRuntimeSession>>
+LuaRuntimeSessionTemplate::createSession(
+    RuntimeSessionOptions options,
+    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs) const {
+  MTRT_RETURN_IF_ERROR(maybeCheckForValidNcclUuid(options));
+
+  auto session = std::unique_ptr<LuaRuntimeSession>(
+      new LuaRuntimeSession(std::move(options), executable));
+  session->getAllocTracker().setParent(&constantTracker);
+  sol::state &lua = session->getLuaState();
+  registerSessionModules(*session, registerExtraLuaFuncs);
+
+  sol::table constantsTable = lua.create_named_table(kConstantsTableName);
+  for (const auto &[name, ptr] : constants)
+    constantsTable[name] = ptr;
+  MTRT_RETURN_IF_ERROR(loadLuaChunk(lua, bytecode, sol::load_mode::binary));
+
+  MTRT_RETURN_IF_ERROR(initializeGlobals(lua));
+  return session;
+}
+
 //===----------------------------------------------------------------------===//
 // Convenience Functions
 //===----------------------------------------------------------------------===//
 
 StatusOr<int64_t> mlirtrt::runtime::runExecutorLuaScript(
     std::string_view luaScript,
-    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs) {
+    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs,
+    RuntimeProfiler *profiler) {
   ADD_RUNTIME_MODULE_RANGE("runtime_runExecutorLuaScript");
 
   StatusOr<std::unique_ptr<RuntimeClient>> client = RuntimeClient::create();
@@ -282,7 +434,10 @@ StatusOr<int64_t> mlirtrt::runtime::runExecutorLuaScript(
     return getStatusWithMsg(
         StatusCode::InternalError,
         "main function should have signature function<int()>");
-  result = mainObj();
+  {
+    RuntimeProfiler::FunctionScope functionScope(profiler, "main");
+    result = mainObj();
+  }
 
   if (!result.valid()) {
     sol::error err = result;
@@ -295,7 +450,8 @@ StatusOr<int64_t> mlirtrt::runtime::runExecutorLuaScript(
 
 StatusOr<int64_t> mlirtrt::runtime::runExecutorExecutable(
     std::unique_ptr<Executable> executable,
-    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs) {
+    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs,
+    RuntimeProfiler *profiler) {
 
   StatusOr<std::unique_ptr<RuntimeClient>> client = RuntimeClient::create();
   if (!client.isOk())
@@ -326,6 +482,7 @@ StatusOr<int64_t> mlirtrt::runtime::runExecutorExecutable(
         StatusCode::InternalError,
         "main function should have signature function<int()>");
 
+  RuntimeProfiler::FunctionScope functionScope(profiler, "main");
   sol::protected_function_result result = mainObj();
   if (!result.valid()) {
     sol::error err(result);
@@ -372,189 +529,66 @@ static Status pushMemRefTableArg(sol::state_view &lua, AllocTracker &tracker,
   return getOkStatus();
 }
 
-static Status pushScalarArgument(sol::state_view &lua,
-                                 llvm::SmallVector<sol::object> &args,
-                                 const ScalarValue &value) {
+/// Create the Lua object that represents the scalar `value`.
+static StatusOr<sol::object> getScalarObject(sol::state_view &lua,
+                                             const ScalarValue &value) {
   ScalarType type = value.getType();
-  sol::object obj(nullptr);
   switch (type.getCode()) {
   case ScalarTypeCode::f8e4m3fn:
-    obj = sol::make_object(lua, value.get<__nv_fp8_e4m3>());
-    break;
+    return sol::make_object(lua, value.get<__nv_fp8_e4m3>());
   case ScalarTypeCode::f16:
-    obj = sol::make_object(lua, value.get<__half>());
-    break;
+    return sol::make_object(lua, value.get<__half>());
   case ScalarTypeCode::bf16:
-    obj = sol::make_object(lua, value.get<nv_bfloat16>());
-    break;
+    return sol::make_object(lua, value.get<nv_bfloat16>());
   case ScalarTypeCode::f32:
-    obj = sol::make_object(lua, value.get<float>());
-    break;
+    return sol::make_object(lua, value.get<float>());
   case ScalarTypeCode::f64:
-    obj = sol::make_object(lua, value.get<double>());
-    break;
+    return sol::make_object(lua, value.get<double>());
   case ScalarTypeCode::i1:
-    obj = sol::make_object(lua, value.get<int8_t>());
-    break;
   case ScalarTypeCode::i4:
-    obj = sol::make_object(lua, value.get<int8_t>());
-    break;
   case ScalarTypeCode::i8:
-    obj = sol::make_object(lua, value.get<int8_t>());
-    break;
   case ScalarTypeCode::ui8:
-    obj = sol::make_object(lua, value.get<int8_t>());
-    break;
+    return sol::make_object(lua, value.get<int8_t>());
   case ScalarTypeCode::i16:
-    obj = sol::make_object(lua, value.get<int16_t>());
-    break;
+    return sol::make_object(lua, value.get<int16_t>());
   case ScalarTypeCode::i32:
-    obj = sol::make_object(lua, value.get<int32_t>());
-    break;
+    return sol::make_object(lua, value.get<int32_t>());
   case ScalarTypeCode::i64:
-    obj = sol::make_object(lua, value.get<int64_t>());
-    break;
+    return sol::make_object(lua, value.get<int64_t>());
   default:
     return getInvalidArgStatus(
         "function input argument with scalar type {0} is unsupported",
         impl::EnumNameScalarTypeCode(type.getCode()));
   }
-  args.push_back(obj);
-  return getOkStatus();
 }
 
-static Status validateArgsTypesAgainstFuncArgs(const RuntimeValue *runArg,
-                                               const TypeUnionView &sigArg) {
-  if (sigArg.isa<MemRefTypeView>()) {
-    if (runArg->getKind() != RuntimeValue::Kind::MemRef)
-      return getInvalidArgStatus(
-          "function expects a memref type but received scalar type");
-    auto view = sigArg.get<MemRefTypeView>();
-    auto value = static_cast<const MemRefValue *>(runArg);
-
-    if (view.getElementType() != *value->getScalarType())
-      return getInvalidArgStatus(
-          "function expects a memref type with element type {0} but "
-          "receieved {1}",
-          view.getElementType().getStrRef(),
-          value->getScalarType()->getStrRef());
-
-    if (view.getRank() != value->getRank())
-      return getInvalidArgStatus(
-          "function expects a memref type with rank {0} but receieved {1}",
-          view.getRank(), value->getRank());
-
-    if (view.getShape() != value->getShape()) {
-      for (unsigned i = 0; i < view.getShape().size(); ++i) {
-        if (value->getShape()[i] < 0)
-          return getInvalidArgStatus(
-              "all shape dimensions extents must be "
-              "non-negative but received shape [{0:$[, ]}]",
-              value->getShape());
-        if (view.getShape()[i] >= 0 &&
-            view.getShape()[i] != value->getShape()[i])
-          return getInvalidArgStatus(
-              "Runtime shape mismatch. Expected [{0:$[, ]}] "
-              "but received [{1:$[, ]}]",
-              view.getShape(), value->getShape());
-      }
-    }
-
-    if (view.getStrides() != value->getStrides()) {
-      for (unsigned i = 0; i < view.getStrides().size(); ++i) {
-        if (value->getStrides()[i] < 0)
-          return getInvalidArgStatus(
-              "all strides must be non-negative but received shape [{0:$[, ]}]",
-              value->getStrides());
-        if (view.getStrides()[i] >= 0 &&
-            view.getStrides()[i] != value->getStrides()[i])
-          // Allow the special case of non-canonical stride for unit dimensions
-          // See https://github.com/pytorch/pytorch/issues/99803 for more detail
-          if (value->getShape()[i] != 1 || value->getStrides()[i] != 1)
-            return getInvalidArgStatus(
-                "Runtime stride mismatch. Expected [{0:$[, ]}] "
-                "but received [{1:$[, ]}]",
-                view.getStrides(), value->getStrides());
-      }
-    }
-
-    if (view.getAddressSpace() != value->getAddressSpace())
-      return getInvalidArgStatus("function expects a memref type with "
-                                 "address space {0} but receieved {1}",
-                                 EnumNamePointerType(view.getAddressSpace()),
-                                 EnumNamePointerType(value->getAddressSpace()));
-
-  } else {
-    assert(sigArg.isa<ScalarTypeView>());
-    if (runArg->getKind() != RuntimeValue::Kind::Scalar)
-      return getInvalidArgStatus(
-          "function expects a scalar type but received memref type");
-    auto view = sigArg.get<ScalarTypeView>();
-    auto value = static_cast<const ScalarValue *>(runArg);
-
-    if (view != value->getType().getCode())
-      return getInvalidArgStatus(
-          "function expects a scalar type with element type {0} but "
-          "receieved {1}",
-          impl::EnumNameScalarTypeCode(view),
-          impl::EnumNameScalarTypeCode(value->getType().getCode()));
-  }
+static Status pushScalarArgument(sol::state_view &lua,
+                                 llvm::SmallVector<sol::object> &args,
+                                 const ScalarValue &value) {
+  MTRT_ASSIGN_OR_RETURN(sol::object obj, getScalarObject(lua, value));
+  args.push_back(std::move(obj));
   return getOkStatus();
 }
 
-StatusOr<llvm::SmallVector<std::unique_ptr<RuntimeValue>>>
-runtime::executeFunctionWithLuaBackend(
-    LuaRuntimeSession &session, std::string_view name,
-    llvm::ArrayRef<RuntimeValue *> inputArgs,
-    llvm::ArrayRef<RuntimeValue *> outputArgs,
-    std::optional<CudaStream> stream) {
-
-  FunctionView meta = session.getExecutable().getFunction(name);
-  FunctionSignatureView sig = meta.getSignature();
-
-  // Call the main function, if present.
+/// Validate the arguments of a call to the function `name` of `session` and
+/// create the corresponding Lua arguments. If `stream` is given, it is set as
+/// the session's stream.
+static Status prepareFunctionCall(LuaRuntimeSession &session,
+                                  std::string_view name,
+                                  FunctionSignatureView sig,
+                                  llvm::ArrayRef<RuntimeValue *> inputArgs,
+                                  llvm::ArrayRef<RuntimeValue *> outputArgs,
+                                  std::optional<CudaStream> stream,
+                                  llvm::SmallVector<sol::object> &args) {
   sol::state &lua = session.getLuaState();
   AllocTracker &tracker = session.getAllocTracker();
-  sol::protected_function funcObj = lua[name];
-  if (funcObj.get_type() != sol::type::function)
-    return getStatusWithMsg(StatusCode::InternalError, "no function named \"",
-                            std::string(name), "\" found");
-
   if (sig.getNumResults() > 0)
     return getInvalidArgStatus("functions with {0} results are not supported",
                                sig.getNumResults());
 
-  // Validate the number of arguments against the signature.
-  if (sig.getNumOutputArgs() != outputArgs.size())
-    return getInvalidArgStatus(
-        "function expects {0} output args (destination args) but received {1}",
-        sig.getNumOutputArgs(), outputArgs.size());
-  if (sig.getNumInputArgs() != inputArgs.size())
-    return getInvalidArgStatus("function expects {0} input args "
-                               "(non-destination args) but received {1}",
-                               sig.getNumInputArgs(), inputArgs.size());
-
-  // Validate the inferred Lua function type here against the signature.
-  for (unsigned i = 0; i < inputArgs.size(); ++i) {
-    auto status = validateArgsTypesAgainstFuncArgs(inputArgs[i], sig.getArg(i));
-    if (!status.isOk())
-      return getInvalidArgStatus(
-          "Input argument {0} validation failed against "
-          "corresponding function signature arg {0}. Reason: {1}",
-          i, status.getString());
-  }
-  for (unsigned i = 0; i < outputArgs.size(); ++i) {
-    auto status =
-        validateArgsTypesAgainstFuncArgs(outputArgs[i], sig.getOutputArg(i));
-    if (!status.isOk())
-      return getInvalidArgStatus(
-          "Output argument {0} validation failed against "
-          "corresponding function signature arg {1}. Reason: {2}",
-          i, i + inputArgs.size(), status.getString());
-  }
+  MTRT_RETURN_IF_ERROR(validateFunctionArgs(sig, inputArgs, outputArgs));
 
   // Create the arguments.
-  llvm::SmallVector<sol::object> args;
   args.reserve(inputArgs.size() + outputArgs.size());
   for (auto [idx, rv] : llvm::enumerate(inputArgs)) {
     if (MemRefValue *memref = llvm::dyn_cast<MemRefValue>(rv)) {
@@ -583,7 +617,31 @@ runtime::executeFunctionWithLuaBackend(
 
   if (stream)
     RETURN_STATUS_IF_ERROR(session.setCudaStream(*stream));
+  return getOkStatus();
+}
 
+StatusOr<llvm::SmallVector<std::unique_ptr<RuntimeValue>>>
+runtime::executeFunctionWithLuaBackend(
+    LuaRuntimeSession &session, std::string_view name,
+    llvm::ArrayRef<RuntimeValue *> inputArgs,
+    llvm::ArrayRef<RuntimeValue *> outputArgs,
+    std::optional<CudaStream> stream) {
+
+  FunctionView meta = session.getExecutable().getFunction(name);
+  FunctionSignatureView sig = meta.getSignature();
+
+  // Call the main function, if present.
+  sol::state &lua = session.getLuaState();
+  sol::protected_function funcObj = lua[name];
+  if (funcObj.get_type() != sol::type::function)
+    return getStatusWithMsg(StatusCode::InternalError, "no function named \"",
+                            std::string(name), "\" found");
+
+  llvm::SmallVector<sol::object> args;
+  MTRT_RETURN_IF_ERROR(prepareFunctionCall(session, name, sig, inputArgs,
+                                           outputArgs, stream, args));
+
+  RuntimeProfiler::FunctionScope functionScope(session.getProfiler(), name);
   // If the number of arguments exceed a particular threshold, then
   // we pass arguments packed into a table, otherwise we pass as arguments.
   sol::protected_function_result result =
@@ -600,3 +658,361 @@ runtime::executeFunctionWithLuaBackend(
 
   return llvm::SmallVector<std::unique_ptr<RuntimeValue>>{};
 }
+
+//===----------------------------------------------------------------------===//
+// LuaAsyncExecution
+//===----------------------------------------------------------------------===//
+
+LuaAsyncExecution::LuaAsyncExecution(LuaRuntimeSession &session,
+                                     std::string_view name,
+                                     sol::thread thread,
+                                     sol::coroutine coroutine)
+    : session(session), name(name), thread(std::move(thread)),
+      coroutine(std::move(coroutine)) {
+  setAsyncExecutionThread(this->thread.thread_state(), true);
+  session.numInFlightExecutions++;
+}
+
+LuaAsyncExecution::~LuaAsyncExecution() {
+  // Device work enqueued by a suspended execution may still use the
+  // arguments, so the execution must be completed first.
+  if (!isDone())
+    (void)wait();
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  if (event)
+    cudaEventDestroy(reinterpret_cast<cudaEvent_t>(event));
+#endif
+}
+
+void LuaAsyncExecution::finish(Status result) {
+  setAsyncExecutionThread(thread.thread_state(), false);
+  session.numInFlightExecutions--;
+  status = std::move(result);
+}
+
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+/// Record `event` on `stream`, creating the event if it does not exist yet.
+static Status recordStreamEvent(uintptr_t &event, cudaStream_t stream) {
+  if (!event) {
+    cudaEvent_t newEvent{nullptr};
+    RETURN_ERROR_IF_CUDART_ERROR(
+        cudaEventCreateWithFlags(&newEvent, cudaEventDisableTiming));
+    event = reinterpret_cast<uintptr_t>(newEvent);
+  }
+  RETURN_ERROR_IF_CUDART_ERROR(
+      cudaEventRecord(reinterpret_cast<cudaEvent_t>(event), stream));
+  return getOkStatus();
+}
+#endif
+
+void LuaAsyncExecution::update(const sol::protected_function_result &result) {
+  if (!result.valid()) {
+    sol::error err = result;
+    return finish(getStatusWithMsg(StatusCode::InternalError,
+                                   "failed to run function \"", name,
+                                   "\": ", err.what()));
+  }
+  if (result.status() != sol::call_status::yielded)
+    return finish(getOkStatus());
+
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  // The coroutine waits for the work enqueued on the stream it yielded. The
+  // event is recorded before any other work can be enqueued on the stream.
+  Status recorded = recordStreamEvent(event, result.get<CudaStreamPtr>());
+  if (!recorded.isOk())
+    return finish(std::move(recorded));
+#else
+  finish(getInternalErrorStatus(
+      "function \"{0}\" was suspended, but the runtime was not compiled with "
+      "CUDA support",
+      name));
+#endif
+}
+
+void LuaAsyncExecution::resume() {
+  RuntimeProfiler::FunctionScope functionScope(profiler, name);
+  update(coroutine());
+}
+
+bool LuaAsyncExecution::poll() {
+  while (!isDone()) {
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+    cudaError_t err = cudaEventQuery(reinterpret_cast<cudaEvent_t>(event));
+    if (err == cudaErrorNotReady)
+      return false;
+    if (err != cudaSuccess) {
+      finish(getInternalErrorStatus(
+          "failed to wait for the device work of function \"{0}\": {1}",
+          name, cudaGetErrorString(err)));
+      break;
+    }
+#endif
+    resume();
+  }
+  return true;
+}
+
+Status LuaAsyncExecution::wait() {
+  while (!isDone()) {
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+    cudaError_t err =
+        cudaEventSynchronize(reinterpret_cast<cudaEvent_t>(event));
+    if (err != cudaSuccess) {
+      finish(getInternalErrorStatus(
+          "failed to wait for the device work of function \"{0}\": {1}",
+          name, cudaGetErrorString(err)));
+      break;
+    }
+#endif
+    resume();
+  }
+  return *status;
+}
+
+StatusOr<std::unique_ptr<LuaAsyncExecution>>
+runtime::executeFunctionWithLuaBackendAsync(
+    LuaRuntimeSession &session, std::string_view name,
+    llvm::ArrayRef<RuntimeValue *> inputArgs,
+    llvm::ArrayRef<RuntimeValue *> outputArgs,
+    std::optional<CudaStream> stream) {
+  FunctionView meta = session.getExecutable().getFunction(name);
+  FunctionSignatureView sig = meta.getSignature();
+
+  // The function runs on its own Lua thread so that it can be suspended
+  // independently of other executions in the session.
+  sol::thread thread =
+      sol::thread::create(session.getLuaState().lua_state());
+  sol::state_view threadState = thread.state();
+  sol::coroutine coroutine = threadState[name];
+  if (coroutine.get_type() != sol::type::function)
+    return getStatusWithMsg(StatusCode::InternalError, "no function named \"",
+                            std::string(name), "\" found");
+
+  llvm::SmallVector<sol::object> args;
+  MTRT_RETURN_IF_ERROR(prepareFunctionCall(session, name, sig, inputArgs,
+                                           outputArgs, stream, args));
+
+  auto execution = std::unique_ptr<LuaAsyncExecution>(
+      new LuaAsyncExecution(session, name, std::move(thread),
+                            std::move(coroutine)));
+  execution->profiler = session.getProfiler();
+  RuntimeProfiler::FunctionScope functionScope(execution->profiler, name);
+  execution->update(sig.getCConv() == CallingConvention::unpacked
+                        ? execution->coroutine(sol::as_args(args))
+                        : execution->coroutine(args));
+  return execution;
+}
+
+//===----------------------------------------------------------------------===//
+// LuaBoundFunction
+//===----------------------------------------------------------------------===//
+
+StatusOr<std::unique_ptr<LuaBoundFunction>>
+LuaBoundFunction::create(LuaRuntimeSession &session, std::string_view name) {
+  ExecutableView executable = session.getExecutable();
+  if (!executable)
+    return getInvalidArgStatus(
+        "cannot bind function \"{0}\" in a session without an executable",
+        name);
+
+  std::optional<FunctionView> meta;
+  for (FunctionView func : executable.getFunctions()) {
+    if (func.getName() == name) {
+      meta = func;
+      break;
+    }
+  }
+  if (!meta)
+    return getInvalidArgStatus("no public function named \"{0}\" found", name);
+  FunctionSignatureView sig = meta->getSignature();
+
+  sol::state &lua = session.getLuaState();
+  sol::protected_function funcObj = lua[name];
+  if (funcObj.get_type() != sol::type::function)
+    return getStatusWithMsg(StatusCode::InternalError, "no function named \"",
+                            std::string(name), "\" found");
+
+  if (sig.getNumResults() > 0)
+    return getInvalidArgStatus("functions with {0} results are not supported",
+                               sig.getNumResults());
+
+  auto boundFunc = std::unique_ptr<LuaBoundFunction>(
+      new LuaBoundFunction(session, name, sig, std::move(funcObj)));
+
+  // Populate the argument slots. MemRef descriptor tables are created once
+  // here and only their contents are updated on each call.
+  unsigned numArgs = sig.getNumArgs();
+  boundFunc->slots.reserve(numArgs);
+  boundFunc->args.reserve(numArgs);
+  if (sig.getCConv() == CallingConvention::packed)
+    boundFunc->packedArgs = lua.create_table(numArgs, 0);
+  for (unsigned i = 0; i < numArgs; ++i) {
+    TypeUnionView arg = sig.getArg(i);
+    ArgSlot slot;
+    if (arg.isa<MemRefTypeView>()) {
+      auto view = arg.get<MemRefTypeView>();
+      slot.kind = RuntimeValue::Kind::MemRef;
+      slot.type = view.getElementType().getCode();
+      slot.addressSpace = view.getAddressSpace();
+      slot.rank = view.getRank();
+      for (auto [dim, extent] : llvm::enumerate(view.getShape()))
+        if (extent >= 0)
+          slot.staticDims.emplace_back(dim, extent);
+      for (auto [dim, stride] : llvm::enumerate(view.getStrides()))
+        if (stride >= 0)
+          slot.staticStrides.emplace_back(dim, stride);
+      slot.table = lua.create_table(3 + 2 * slot.rank, 0);
+      boundFunc->args.push_back(slot.table);
+    } else if (arg.isa<ScalarTypeView>()) {
+      if (sig.isOutputArg(i))
+        return getInvalidArgStatus(
+            "output (destination) argument #{0} of function \"{1}\" is not a "
+            "MemRef",
+            i - sig.getNumInputArgs() + 1, name);
+      slot.kind = RuntimeValue::Kind::Scalar;
+      slot.type = arg.get<ScalarTypeView>();
+      boundFunc->args.push_back(sol::make_object(lua, sol::lua_nil));
+    } else {
+      return getInvalidArgStatus(
+          "argument #{0} of function \"{1}\" has a type that cannot be bound; "
+          "arguments must be either MemRefs or scalars",
+          i + 1, name);
+    }
+    if (boundFunc->packedArgs.valid())
+      boundFunc->packedArgs.raw_set(i + 1, boundFunc->args.back());
+    boundFunc->slots.push_back(std::move(slot));
+  }
+
+  return boundFunc;
+}
+
+Status LuaBoundFunction::updateArg(unsigned idx, RuntimeValue *value) {
+  ArgSlot &slot = slots[idx];
+  if (value->getKind() != slot.kind)
+    return getInvalidArgStatus(
+        "argument #{0} of function \"{1}\" expects a {2} but received a {3}",
+        idx + 1, name,
+        slot.kind == RuntimeValue::Kind::MemRef ? "memref" : "scalar",
+        slot.kind == RuntimeValue::Kind::MemRef ? "scalar" : "memref");
+
+  sol::state &lua = session.getLuaState();
+  if (auto *scalar = llvm::dyn_cast<ScalarValue>(value)) {
+    if (scalar->getType().getCode() != slot.type)
+      return getInvalidArgStatus(
+          "argument #{0} of function \"{1}\" expects scalar type {2} but "
+          "received {3}",
+          idx + 1, name, impl::EnumNameScalarTypeCode(slot.type),
+          impl::EnumNameScalarTypeCode(scalar->getType().getCode()));
+    MTRT_ASSIGN_OR_RETURN(args[idx], getScalarObject(lua, *scalar));
+    if (packedArgs.valid())
+      packedArgs.raw_set(idx + 1, args[idx]);
+    return getOkStatus();
+  }
+
+  auto *memref = llvm::cast<MemRefValue>(value);
+  if (memref->getRank() != slot.rank)
+    return getInvalidArgStatus(
+        "argument #{0} of function \"{1}\" expects a memref of rank {2} but "
+        "received rank {3}",
+        idx + 1, name, slot.rank, memref->getRank());
+  if (!memref->getScalarType() ||
+      memref->getScalarType()->getCode() != slot.type)
+    return getInvalidArgStatus(
+        "argument #{0} of function \"{1}\" expects a memref with element "
+        "type {2}",
+        idx + 1, name, impl::EnumNameScalarTypeCode(slot.type));
+  if (memref->getAddressSpace() != slot.addressSpace)
+    return getInvalidArgStatus(
+        "argument #{0} of function \"{1}\" expects a memref in address space "
+        "{2} but received {3}",
+        idx + 1, name, EnumNamePointerType(slot.addressSpace),
+        EnumNamePointerType(memref->getAddressSpace()));
+
+  llvm::ArrayRef<int64_t> shape = memref->getShape();
+  for (auto [dim, extent] : slot.staticDims)
+    if (shape[dim] != extent)
+      return getInvalidArgStatus(
+          "Runtime shape mismatch for argument #{0} of function \"{1}\": "
+          "expected extent {2} in dimension {3} but received [{4:$[, ]}]",
+          idx + 1, name, extent, dim, shape);
+
+  llvm::ArrayRef<int64_t> strides = memref->getStrides();
+  if (llvm::any_of(shape, [](int64_t extent) { return extent < 0; }))
+    return getInvalidArgStatus(
+        "argument #{0} of function \"{1}\": all shape dimensions extents "
+        "must be non-negative but received shape [{2:$[, ]}]",
+        idx + 1, name, shape);
+  if (llvm::any_of(strides, [](int64_t stride) { return stride < 0; }))
+    return getInvalidArgStatus(
+        "argument #{0} of function \"{1}\": all strides must be "
+        "non-negative but received strides [{2:$[, ]}]",
+        idx + 1, name, strides);
+  for (auto [dim, stride] : slot.staticStrides) {
+    if (strides[dim] == stride)
+      continue;
+    // Allow the special case of non-canonical stride for unit dimensions
+    // See https://github.com/pytorch/pytorch/issues/99803 for more detail
+    if (shape[dim] == 1 && strides[dim] == 1)
+      continue;
+    return getInvalidArgStatus(
+        "Runtime stride mismatch for argument #{0} of function \"{1}\": "
+        "expected stride {2} in dimension {3} but received [{4:$[, ]}]",
+        idx + 1, name, stride, dim, strides);
+  }
+
+  uintptr_t ptr = memref->getMemory();
+  assert(ptr != 0 && "expected non-null pointer");
+  sol::table &table = slot.table;
+  table.raw_set(1, ptr, 2, ptr, 3, memref->getOffset());
+  for (auto [i, dim] : llvm::enumerate(shape))
+    table.raw_set(4 + i, dim);
+  for (auto [i, stride] : llvm::enumerate(strides))
+    table.raw_set(4 + slot.rank + i, stride);
+
+  // Only update the tracker if it does not already hold an identical external
+  // reference; re-tracking allocates and replaces the metadata entry.
+  AllocTracker &tracker = session.getAllocTracker();
+  PointerInfo info = memref->getPointerInfo(PointerOwner::external);
+  PointerInfo tracked = tracker.lookupOrDefault(ptr);
+  if (!tracked.isExternallyManaged() || tracked.size != info.size ||
+      tracked.type != info.type)
+    tracker.track(info);
+  return getOkStatus();
+}
+
+Status LuaBoundFunction::execute(llvm::ArrayRef<RuntimeValue *> inputArgs,
+                                 llvm::ArrayRef<RuntimeValue *> outputArgs,
+                                 std::optional<CudaStream> stream) {
+  if (signature.getNumOutputArgs() != outputArgs.size())
+    return getInvalidArgStatus(
+        "function expects {0} output args (destination args) but received {1}",
+        signature.getNumOutputArgs(), outputArgs.size());
+  if (signature.getNumInputArgs() != inputArgs.size())
+    return getInvalidArgStatus("function expects {0} input args "
+                               "(non-destination args) but received {1}",
+                               signature.getNumInputArgs(), inputArgs.size());
+
+  // Check the aliases first so that a rejected call does not update any
+  // argument.
+  MTRT_RETURN_IF_ERROR(validateOutputAliases(signature, inputArgs, outputArgs));
+  for (auto [idx, rv] : llvm::enumerate(inputArgs))
+    MTRT_RETURN_IF_ERROR(updateArg(idx, rv));
+  for (auto [idx, rv] : llvm::enumerate(outputArgs))
+    MTRT_RETURN_IF_ERROR(updateArg(inputArgs.size() + idx, rv));
+
+  if (stream)
+    RETURN_STATUS_IF_ERROR(session.setCudaStream(*stream));
+
+  RuntimeProfiler::FunctionScope functionScope(session.getProfiler(), name);
+  sol::protected_function_result result =
+      signature.getCConv() == CallingConvention::unpacked
+          ? funcObj(sol::as_args(args))
+          : funcObj(packedArgs);
+  if (!result.valid()) {
+    sol::error err(result);
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "failed to run function \"", name, "\": ",
+                            err.what());
+  }
+  return getOkStatus();
+}
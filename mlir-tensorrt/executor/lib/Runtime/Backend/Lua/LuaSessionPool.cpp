@@ -0,0 +1,190 @@
+//===- LuaSessionPool.cpp -------------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the pool of Lua runtime sessions.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Backend/Lua/LuaSessionPool.h"
+#include "mlir-executor/Runtime/Support/Support.h"
+
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+#include "cuda_runtime_api.h"
+#endif
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+
+StatusOr<std::unique_ptr<LuaSessionPool>> LuaSessionPool::create(
+    RuntimeSessionOptions options, ExecutableView executable,
+    unsigned numSessions,
+    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs) {
+  if (numSessions == 0)
+    return getInvalidArgStatus("a session pool requires at least one session");
+
+  MTRT_ASSIGN_OR_RETURN(
+      std::unique_ptr<LuaRuntimeSessionTemplate> tmpl,
+      LuaRuntimeSessionTemplate::create(
+          executable, options.isExecutableBytecodeEnabled()));
+  auto pool =
+      std::unique_ptr<LuaSessionPool>(new LuaSessionPool(std::move(tmpl)));
+
+  // Create all sessions before starting any worker, so that a failure does
+  // not leave threads behind.
+  for (unsigned i = 0; i < numSessions; ++i) {
+    auto worker = std::make_unique<Worker>();
+    MTRT_ASSIGN_OR_RETURN(worker->session,
+                          pool->sessionTemplate->createSession(
+                              options, registerExtraLuaFuncs));
+    pool->workers.push_back(std::move(worker));
+  }
+
+  // Workers use the CUDA device that is current on the creating thread.
+  int32_t device = 0;
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  RETURN_ERROR_IF_CUDART_ERROR(cudaGetDevice(&device));
+#endif
+  for (unsigned i = 0; i < numSessions; ++i)
+    pool->workers[i]->thread = std::thread([self = pool.get(), i, device]() {
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+      cudaSetDevice(device);
+#else
+      (void)device;
+#endif
+      self->run(i);
+    });
+  return pool;
+}
+
+LuaSessionPool::~LuaSessionPool() {
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    shuttingDown = true;
+  }
+  wakeCondition.notify_all();
+  for (std::unique_ptr<Worker> &worker : workers)
+    if (worker->thread.joinable())
+      worker->thread.join();
+}
+
+void LuaSessionPool::submit(std::string_view name,
+                            llvm::ArrayRef<RuntimeValue *> inputArgs,
+                            llvm::ArrayRef<RuntimeValue *> outputArgs,
+                            Callback callback,
+                            std::optional<CudaStream> stream) {
+  Request request{std::string(name),
+                  llvm::SmallVector<RuntimeValue *>(inputArgs),
+                  llvm::SmallVector<RuntimeValue *>(outputArgs), stream,
+                  std::move(callback)};
+  Worker &worker = *workers[nextWorker.fetch_add(1, std::memory_order_relaxed) %
+                            workers.size()];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.queue.push_back(std::move(request));
+  }
+  queueDepth.fetch_add(1);
+
+  // Notify while holding the mutex, so that a worker cannot miss the request
+  // between checking the queue depth and going to sleep.
+  std::lock_guard<std::mutex> lock(wakeMutex);
+  wakeCondition.notify_one();
+}
+
+std::future<Status>
+LuaSessionPool::submit(std::string_view name,
+                       llvm::ArrayRef<RuntimeValue *> inputArgs,
+                       llvm::ArrayRef<RuntimeValue *> outputArgs,
+                       std::optional<CudaStream> stream) {
+  auto promise = std::make_shared<std::promise<Status>>();
+  std::future<Status> result = promise->get_future();
+  submit(
+      name, inputArgs, outputArgs,
+      [promise](Status status) { promise->set_value(std::move(status)); },
+      stream);
+  return result;
+}
+
+bool LuaSessionPool::takeRequest(unsigned index, Request &request) {
+  // Requests of the worker's own queue are executed in order.
+  {
+    Worker &worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.queue.empty()) {
+      request = std::move(worker.queue.front());
+      worker.queue.pop_front();
+      return true;
+    }
+  }
+
+  // Steal from the other end of the queues of the other workers, starting
+  // with the next one, so that thieves and owners rarely contend.
+  for (unsigned i = 1, e = workers.size(); i < e; ++i) {
+    Worker &victim = *workers[(index + i) % e];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.queue.empty())
+      continue;
+    request = std::move(victim.queue.back());
+    victim.queue.pop_back();
+    numStolenRequests.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void LuaSessionPool::run(unsigned index) {
+  LuaRuntimeSession &session = *workers[index]->session;
+  while (true) {
+    Request request;
+    if (takeRequest(index, request)) {
+      queueDepth.fetch_sub(1);
+      numBusySessions.fetch_add(1, std::memory_order_relaxed);
+      Status status =
+          executeFunctionWithLuaBackend(session, request.name,
+                                        request.inputArgs, request.outputArgs,
+                                        request.stream)
+              .getStatus();
+      MTRT_DBGF("session pool worker %u completed request for \"%s\"", index,
+                request.name.c_str());
+      numBusySessions.fetch_sub(1, std::memory_order_relaxed);
+      numCompletedRequests.fetch_add(1, std::memory_order_relaxed);
+      if (request.callback)
+        request.callback(std::move(status));
+      continue;
+    }
+
+    // All queues are empty. Sleep until a request is queued, or exit once the
+    // pool shuts down and no requests remain.
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wakeCondition.wait(
+        lock, [&]() { return queueDepth.load() > 0 || shuttingDown; });
+    if (shuttingDown && queueDepth.load() <= 0)
+      return;
+  }
+}
+
+LuaSessionPool::Statistics LuaSessionPool::getStatistics() const {
+  Statistics stats;
+  stats.numSessions = workers.size();
+  stats.queueDepth = queueDepth.load(std::memory_order_relaxed);
+  stats.numBusySessions = numBusySessions.load(std::memory_order_relaxed);
+  stats.numCompletedRequests =
+      numCompletedRequests.load(std::memory_order_relaxed);
+  stats.numStolenRequests = numStolenRequests.load(std::memory_order_relaxed);
+  return stats;
+}
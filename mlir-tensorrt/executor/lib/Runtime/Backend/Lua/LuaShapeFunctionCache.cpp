@@ -0,0 +1,332 @@
+//===- LuaShapeFunctionCache.cpp ------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the memoized evaluation of shape functions.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Backend/Lua/LuaShapeFunctionCache.h"
+#include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
+#include "mlir-executor/Runtime/Support/Support.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+
+/// Return true if `type` is a 1-D i64 host memref with a static extent, which
+/// is the type that shape functions use for shapes.
+static bool isShapeMemRefType(TypeUnionView type) {
+  if (!type.isa<MemRefTypeView>())
+    return false;
+  auto memrefType = type.get<MemRefTypeView>();
+  return memrefType.getRank() == 1 && memrefType.getShape()[0] >= 0 &&
+         memrefType.getElementType() == ScalarType(ScalarTypeCode::i64) &&
+         memrefType.getAddressSpace() == PointerType::host;
+}
+
+/// Return true if values of type `lhs` can be passed for arguments of type
+/// `rhs`.
+static bool isSameType(TypeUnionView lhs, TypeUnionView rhs) {
+  if (lhs.isa<ScalarTypeView>() && rhs.isa<ScalarTypeView>())
+    return impl::ScalarTypeCode(lhs.get<ScalarTypeView>()) ==
+           impl::ScalarTypeCode(rhs.get<ScalarTypeView>());
+  if (!lhs.isa<MemRefTypeView>() || !rhs.isa<MemRefTypeView>())
+    return false;
+  auto lhsType = lhs.get<MemRefTypeView>();
+  auto rhsType = rhs.get<MemRefTypeView>();
+  return lhsType.getElementType() == rhsType.getElementType() &&
+         lhsType.getRank() == rhsType.getRank() &&
+         lhsType.getAddressSpace() == rhsType.getAddressSpace();
+}
+
+static void appendToKey(std::string &key, const void *data, size_t size) {
+  key.append(static_cast<const char *>(data), size);
+}
+
+static void appendToKey(std::string &key, llvm::ArrayRef<int64_t> shape) {
+  int64_t rank = shape.size();
+  appendToKey(key, &rank, sizeof(rank));
+  appendToKey(key, shape.data(), shape.size() * sizeof(int64_t));
+}
+
+StatusOr<std::unique_ptr<LuaShapeFunctionCache>>
+LuaShapeFunctionCache::create(RuntimeClient &client,
+                              LuaRuntimeSession &session,
+                              std::string_view functionName,
+                              size_t capacity) {
+  if (capacity == 0)
+    return getInvalidArgStatus("the shape function cache capacity must be "
+                               "positive");
+  ExecutableView executable = session.getExecutable();
+  std::optional<FunctionView> func = lookupFunction(executable, functionName);
+  if (!func)
+    return getInvalidArgStatus("no function named \"{0}\" in the executable",
+                               functionName);
+  FunctionSignatureView sig = func->getSignature();
+  std::optional<std::string_view> shapeFunctionName =
+      sig.getShapeFunctionName();
+  if (!shapeFunctionName || shapeFunctionName->empty())
+    return getInvalidArgStatus("function \"{0}\" has no shape function",
+                               functionName);
+  std::optional<FunctionView> shapeFunc =
+      lookupFunction(executable, *shapeFunctionName);
+  if (!shapeFunc)
+    return getInvalidArgStatus(
+        "shape function \"{0}\" of function \"{1}\" is not in the executable",
+        *shapeFunctionName, functionName);
+  FunctionSignatureView shapeSig = shapeFunc->getSignature();
+
+  // Determine how each input is passed to the shape function.
+  if (shapeSig.getNumInputArgs() != sig.getNumInputArgs() ||
+      shapeSig.getNumResults() != 0)
+    return getInvalidArgStatus(
+        "shape function \"{0}\" does not match the signature of function "
+        "\"{1}\"",
+        *shapeFunctionName, functionName);
+  llvm::SmallVector<InputInfo> inputs;
+  for (unsigned i = 0, e = sig.getNumInputArgs(); i < e; ++i) {
+    TypeUnionView arg = sig.getArg(i);
+    TypeUnionView shapeArg = shapeSig.getArg(i);
+    if (isSameType(shapeArg, arg)) {
+      inputs.push_back(InputInfo{/*passValue=*/true, /*numShapeElements=*/0});
+      continue;
+    }
+    if (!arg.isa<MemRefTypeView>() || !isShapeMemRefType(shapeArg))
+      return getInvalidArgStatus(
+          "argument {0} of shape function \"{1}\" is neither a shape nor the "
+          "corresponding input",
+          i, *shapeFunctionName);
+    inputs.push_back(InputInfo{
+        /*passValue=*/false,
+        /*numShapeElements=*/shapeArg.get<MemRefTypeView>().getShape()[0]});
+  }
+
+  // The outputs of the function are its destination arguments followed by its
+  // results. The shape function has one destination argument per output.
+  llvm::SmallVector<TypeUnionView> outputTypes;
+  for (unsigned i = 0, e = sig.getNumOutputArgs(); i < e; ++i)
+    outputTypes.push_back(sig.getOutputArg(i));
+  llvm::append_range(outputTypes, sig.getResults());
+  if (shapeSig.getNumOutputArgs() != outputTypes.size())
+    return getInvalidArgStatus(
+        "shape function \"{0}\" computes {1} shapes but function \"{2}\" has "
+        "{3} outputs",
+        *shapeFunctionName, shapeSig.getNumOutputArgs(), functionName,
+        outputTypes.size());
+  llvm::SmallVector<OutputInfo> outputs;
+  for (auto [idx, type] : llvm::enumerate(outputTypes)) {
+    TypeUnionView shapeType = shapeSig.getOutputArg(idx);
+    if (!type.isa<MemRefTypeView>() || !isShapeMemRefType(shapeType))
+      return getInvalidArgStatus(
+          "output {0} of function \"{1}\" is not a memref with a shape "
+          "computed by its shape function",
+          idx, functionName);
+    auto memrefType = type.get<MemRefTypeView>();
+    int64_t numShapeElements = shapeType.get<MemRefTypeView>().getShape()[0];
+    if (numShapeElements < memrefType.getRank())
+      return getInvalidArgStatus(
+          "shape function \"{0}\" computes {1} dimensions for output {2} of "
+          "rank {3}",
+          *shapeFunctionName, numShapeElements, idx, memrefType.getRank());
+    outputs.push_back(OutputInfo{memrefType.getElementType(),
+                                 memrefType.getAddressSpace(),
+                                 memrefType.getRank(), numShapeElements});
+  }
+
+  return std::unique_ptr<LuaShapeFunctionCache>(new LuaShapeFunctionCache(
+      client, session, std::string(*shapeFunctionName), capacity,
+      std::move(inputs), std::move(outputs)));
+}
+
+StatusOr<LuaShapeFunctionCache::OutputShapes>
+LuaShapeFunctionCache::getOutputShapes(
+    llvm::ArrayRef<RuntimeValue *> inputArgs) {
+  if (inputArgs.size() != inputs.size())
+    return getInvalidArgStatus("expected {0} input arguments but received {1}",
+                               inputs.size(), inputArgs.size());
+
+  std::string key;
+  llvm::SmallVector<llvm::ArrayRef<int64_t>> inputShapes;
+  for (auto [idx, info, arg] : llvm::enumerate(inputs, inputArgs)) {
+    if (auto *scalar = llvm::dyn_cast<ScalarValue>(arg)) {
+      if (!info.passValue)
+        return getInvalidArgStatus("input argument {0} must be a memref", idx);
+      int64_t value = scalar->get<int64_t>();
+      appendToKey(key, &value, sizeof(value));
+      inputShapes.push_back({});
+      continue;
+    }
+    auto *memref = llvm::cast<MemRefValue>(arg);
+    appendToKey(key, memref->getShape());
+    inputShapes.push_back(memref->getShape());
+    if (!info.passValue)
+      continue;
+
+    // The shape function reads the contents of this input.
+    if (memref->getAddressSpace() != PointerType::host &&
+        memref->getAddressSpace() != PointerType::pinned_host &&
+        memref->getAddressSpace() != PointerType::unified)
+      return getInvalidArgStatus(
+          "input argument {0} is read by the shape function and must be "
+          "host-accessible",
+          idx);
+    // The contents start at the offset of the memref and are laid out
+    // according to its strides, so both are part of the key.
+    int64_t offset = memref->getOffset();
+    appendToKey(key, &offset, sizeof(offset));
+    appendToKey(key, memref->getStrides());
+    appendToKey(key,
+                static_cast<const char *>(memref->getVoidPtr()) +
+                    offset * llvm::divideCeil(memref->getElementBitWidth(), 8),
+                memref->getTotalFootprintInBytes());
+  }
+  return lookupOrCompute(key, inputShapes, inputArgs);
+}
+
+StatusOr<LuaShapeFunctionCache::OutputShapes>
+LuaShapeFunctionCache::getOutputShapesForInputShapes(
+    llvm::ArrayRef<llvm::ArrayRef<int64_t>> inputShapes) {
+  if (inputShapes.size() != inputs.size())
+    return getInvalidArgStatus("expected {0} input shapes but received {1}",
+                               inputs.size(), inputShapes.size());
+  std::string key;
+  for (auto [idx, info, shape] : llvm::enumerate(inputs, inputShapes)) {
+    if (info.passValue)
+      return getInvalidArgStatus(
+          "the shape function reads the contents of input argument {0}, so "
+          "output shapes cannot be computed from input shapes alone",
+          idx);
+    appendToKey(key, shape);
+  }
+  return lookupOrCompute(key, inputShapes, {});
+}
+
+StatusOr<LuaShapeFunctionCache::OutputShapes>
+LuaShapeFunctionCache::lookupOrCompute(
+    const std::string &key,
+    llvm::ArrayRef<llvm::ArrayRef<int64_t>> inputShapes,
+    llvm::ArrayRef<RuntimeValue *> inputArgs) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = index.find(key);
+  if (it != index.end()) {
+    stats.numHits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+  }
+
+  stats.numMisses++;
+  MTRT_ASSIGN_OR_RETURN(OutputShapes shapes, evaluate(inputShapes, inputArgs));
+  if (entries.size() >= capacity) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+    stats.numEvictions++;
+  }
+  entries.emplace_front(key, shapes);
+  index.emplace(key, entries.begin());
+  stats.numEntries = entries.size();
+  return shapes;
+}
+
+StatusOr<LuaShapeFunctionCache::OutputShapes> LuaShapeFunctionCache::evaluate(
+    llvm::ArrayRef<llvm::ArrayRef<int64_t>> inputShapes,
+    llvm::ArrayRef<RuntimeValue *> inputArgs) {
+  auto createShapeMemRef = [&](llvm::SmallVector<int64_t> &storage) {
+    return client.createExternalMemRef(
+        PointerType::host, 64, reinterpret_cast<uintptr_t>(storage.data()), 0,
+        {static_cast<int64_t>(storage.size())}, {1}, {},
+        ScalarType(ScalarTypeCode::i64));
+  };
+
+  // Shapes are passed in host buffers that live for the duration of the
+  // call. Rank-0 inputs pass a single unused element.
+  llvm::SmallVector<llvm::SmallVector<int64_t>> storage;
+  storage.reserve(inputs.size() + outputs.size());
+  llvm::SmallVector<std::unique_ptr<MemRefValue>> memrefs;
+  llvm::SmallVector<RuntimeValue *> shapeInputs, shapeOutputs;
+  for (auto [idx, info] : llvm::enumerate(inputs)) {
+    if (info.passValue) {
+      shapeInputs.push_back(inputArgs[idx]);
+      continue;
+    }
+    llvm::ArrayRef<int64_t> shape = inputShapes[idx];
+    if (static_cast<int64_t>(shape.size()) > info.numShapeElements)
+      return getInvalidArgStatus(
+          "input argument {0} has rank {1} but the shape function expects "
+          "at most {2} dimensions",
+          idx, shape.size(), info.numShapeElements);
+    llvm::SmallVector<int64_t> &dims =
+        storage.emplace_back(info.numShapeElements, 0);
+    llvm::copy(shape, dims.begin());
+    MTRT_ASSIGN_OR_RETURN(std::unique_ptr<MemRefValue> memref,
+                          createShapeMemRef(dims));
+    shapeInputs.push_back(memref.get());
+    memrefs.push_back(std::move(memref));
+  }
+  for (const OutputInfo &info : outputs) {
+    llvm::SmallVector<int64_t> &dims =
+        storage.emplace_back(info.numShapeElements, 0);
+    MTRT_ASSIGN_OR_RETURN(std::unique_ptr<MemRefValue> memref,
+                          createShapeMemRef(dims));
+    shapeOutputs.push_back(memref.get());
+    memrefs.push_back(std::move(memref));
+  }
+
+  MTRT_RETURN_IF_ERROR(executeFunctionWithLuaBackend(
+                           session, shapeFunctionName, shapeInputs,
+                           shapeOutputs)
+                           .getStatus());
+
+  // The output shapes are in the last `outputs.size()` buffers.
+  OutputShapes shapes;
+  size_t firstOutput = storage.size() - outputs.size();
+  for (auto [idx, info] : llvm::enumerate(outputs))
+    shapes.push_back(llvm::SmallVector<int64_t>(
+        llvm::ArrayRef(storage[firstOutput + idx]).take_front(info.rank)));
+  return shapes;
+}
+
+StatusOr<llvm::SmallVector<std::unique_ptr<MemRefValue>>>
+LuaShapeFunctionCache::allocateOutputs(
+    llvm::ArrayRef<RuntimeValue *> inputArgs,
+    std::optional<const Device *> device, std::optional<CudaStream> stream) {
+  MTRT_ASSIGN_OR_RETURN(OutputShapes shapes, getOutputShapes(inputArgs));
+  llvm::SmallVector<std::unique_ptr<MemRefValue>> buffers;
+  for (auto [idx, info, shape] : llvm::enumerate(outputs, shapes)) {
+    bool onDevice = info.addressSpace == PointerType::device ||
+                    info.addressSpace == PointerType::unified;
+    if (onDevice && !device)
+      return getInvalidArgStatus(
+          "output {0} is a device buffer, so a device must be specified", idx);
+    MTRT_ASSIGN_OR_RETURN(
+        std::unique_ptr<MemRefValue> buffer,
+        client.allocateMemRef(info.addressSpace,
+                              info.elementType.getBitWidth(), shape,
+                              getCanonicalStrides(shape),
+                              onDevice ? device : std::nullopt, stream,
+                              info.elementType));
+    buffers.push_back(std::move(buffer));
+  }
+  return buffers;
+}
+
+LuaShapeFunctionCache::Statistics
+LuaShapeFunctionCache::getStatistics() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
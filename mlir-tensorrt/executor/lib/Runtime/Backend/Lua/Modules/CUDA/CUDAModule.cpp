@@ -28,6 +28,7 @@
 #include "mlir-executor/Runtime/Backend/Common/CUDACommon.h"
 #include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
 #include "mlir-executor/Runtime/Backend/Common/NvPtxCompilerUtils.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaAsync.h"
 #include "mlir-executor/Runtime/Backend/Lua/LuaErrorHandling.h"
 #include "mlir-executor/Runtime/Backend/Lua/Modules/Utils/MemRefUtils.h"
 #include "mlir-executor/Runtime/Backend/Utils/NvtxUtils.h"
@@ -74,6 +75,81 @@ static StatusOr<int32_t> getDevice(int32_t deviceNumber) {
   return deviceNumber;
 }
 
+/// Return true if rows of `width` bytes may be copied with the pitches
+/// `srcPitch` and `dstPitch`.
+static bool isValidPitchedCopy(int64_t width, int64_t srcPitch,
+                               int64_t dstPitch) {
+  return srcPitch >= width && dstPitch >= width;
+}
+
+/// Enqueue the copy described by `plan` on `stream`. Contiguous copies use a
+/// single `cudaMemcpyAsync`, 3-D copies whose outer strides are multiples of
+/// the row pitches use `cudaMemcpy3DAsync`, and all other copies are issued
+/// as one `cudaMemcpy2DAsync` per row of the innermost loop.
+static cudaError_t enqueueStridedCopy(const StridedCopyPlan &plan,
+                                      uintptr_t src, uintptr_t dst,
+                                      cudaMemcpyKind kind,
+                                      cudaStream_t stream) {
+  auto getPtr = [](uintptr_t base, int64_t offset) {
+    return reinterpret_cast<void *>(base + offset);
+  };
+  switch (plan.getKind()) {
+  case StridedCopyPlan::Kind::Empty:
+    return cudaSuccess;
+  case StridedCopyPlan::Kind::Contiguous:
+    return cudaMemcpyAsync(getPtr(dst, plan.dstOffset),
+                           getPtr(src, plan.srcOffset), plan.runSize, kind,
+                           stream);
+  default:
+    break;
+  }
+
+  int64_t rank = plan.shape.size();
+  int64_t height = plan.shape[rank - 1];
+  int64_t srcPitch = plan.srcStrides[rank - 1];
+  int64_t dstPitch = plan.dstStrides[rank - 1];
+
+  // A 3-D copy addresses slices through multiples of the row pitch.
+  if (plan.getKind() == StridedCopyPlan::Kind::Pitched3D &&
+      isValidPitchedCopy(plan.runSize, srcPitch, dstPitch) &&
+      plan.srcStrides[0] % srcPitch == 0 &&
+      plan.dstStrides[0] % dstPitch == 0 &&
+      plan.srcStrides[0] / srcPitch >= height &&
+      plan.dstStrides[0] / dstPitch >= height) {
+    cudaMemcpy3DParms params = {};
+    params.srcPtr = make_cudaPitchedPtr(getPtr(src, plan.srcOffset), srcPitch,
+                                        plan.runSize,
+                                        plan.srcStrides[0] / srcPitch);
+    params.dstPtr = make_cudaPitchedPtr(getPtr(dst, plan.dstOffset), dstPitch,
+                                        plan.runSize,
+                                        plan.dstStrides[0] / dstPitch);
+    params.extent = make_cudaExtent(plan.runSize, height, plan.shape[0]);
+    params.kind = kind;
+    return cudaMemcpy3DAsync(&params, stream);
+  }
+
+  cudaError_t result = cudaSuccess;
+  if (isValidPitchedCopy(plan.runSize, srcPitch, dstPitch)) {
+    plan.forEachRun(
+        [&](int64_t srcOffset, int64_t dstOffset) {
+          if (result == cudaSuccess)
+            result = cudaMemcpy2DAsync(getPtr(dst, dstOffset), dstPitch,
+                                       getPtr(src, srcOffset), srcPitch,
+                                       plan.runSize, height, kind, stream);
+        },
+        /*numInnerLoops=*/1);
+    return result;
+  }
+
+  // Negative or overlapping pitches cannot be expressed as pitched copies.
+  plan.forEachRun([&](int64_t srcOffset, int64_t dstOffset) {
+    if (result == cudaSuccess)
+      result = cudaMemcpyAsync(getPtr(dst, dstOffset), getPtr(src, srcOffset),
+                               plan.runSize, kind, stream);
+  });
+  return result;
+}
+
 static void registerCudaOps(sol::state_view &lua, AllocTracker *allocTracker,
                             PinnedMemoryAllocator *pinnedMemoryAllocator,
                             ResourceTracker *resourceTracker) {
@@ -179,20 +255,16 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
       const auto *dstShapeAndStridesPtr =
           reinterpret_cast<const int64_t *>(dstShapeAndStrides);
 
-      std::vector<int64_t> srcShape(srcShapeAndStridesPtr,
-                                    srcShapeAndStridesPtr + rank);
-      std::vector<int64_t> srcStrides(srcShapeAndStridesPtr + rank,
-                                      srcShapeAndStridesPtr + 2 * rank);
-      std::vector<int64_t> dstShape(dstShapeAndStridesPtr,
-                                    dstShapeAndStridesPtr + rank);
-      std::vector<int64_t> dstStrides(dstShapeAndStridesPtr + rank,
-                                      dstShapeAndStridesPtr + 2 * rank);
-
-      executeStridedCopy(elemSize, srcPointer, srcOffset, srcShape, srcStrides,
-                         dstPointer, dstOffset, dstShape, dstStrides,
-                         [&](void *dst, void *src, size_t size) {
-                           cudaMemcpyAsync(dst, src, size, kind, stream);
-                         });
+      llvm::ArrayRef<int64_t> srcShape(srcShapeAndStridesPtr, rank);
+      llvm::ArrayRef<int64_t> srcStrides(srcShapeAndStridesPtr + rank, rank);
+      llvm::ArrayRef<int64_t> dstStrides(dstShapeAndStridesPtr + rank, rank);
+
+      StridedCopyPlan plan = planStridedCopy(
+          elemSize, srcShape, srcOffset, srcStrides, dstOffset, dstStrides);
+      RuntimeProfiler::recordBytes(plan.getNumBytes());
+      SET_LUA_ERROR_IF_CUDART_ERROR(
+          enqueueStridedCopy(plan, srcPointer, dstPointer, kind, stream),
+          state);
     };
   };
 
@@ -226,9 +298,18 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
     return reinterpret_cast<uintptr_t>(stream);
   };
 
-  lua["__cuda_stream_sync"] = [](sol::this_state state, CudaStreamPtr stream) {
+  // This is a raw C function so that it can yield: on the thread of an
+  // asynchronous execution, the stream is handed to the driver, which resumes
+  // the thread once the stream's work has completed.
+  lua["__cuda_stream_sync"] = +[](lua_State *state) -> int {
+    if (isAsyncExecutionThread(state)) {
+      lua_settop(state, 1);
+      return lua_yield(state, 1);
+    }
     ADD_CUDA_MODULE_RANGE("cuda_stream_sync");
+    CudaStreamPtr stream = sol::stack::get<CudaStreamPtr>(state, 1);
     SET_LUA_ERROR_IF_CUDART_ERROR(cudaStreamSynchronize(stream), state);
+    return 0;
   };
 
   lua["__cuda_stream_destroy"] = [](sol::this_state state,
@@ -308,6 +389,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
     StatusOr<PointerInfo> info = allocate(*allocTracker, PointerType::device,
                                           numBytes, alignment, stream);
     SET_LUA_ERROR_AND_RETURN_IF_ERROR(info, state, 0);
+    RuntimeProfiler::recordAllocation(info->ptr, numBytes);
     return info->ptr;
   };
 
@@ -332,6 +414,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
           state, 0);
     }
     tracker.track(info);
+    RuntimeProfiler::recordAllocation(info.ptr, info.size);
     return info.ptr;
   };
 
@@ -354,6 +437,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
     }
     MTRT_DBGF("executor_memcpy host-host %lu bytes src %lx + %lu dst %lx + %lu",
               numBytes, src, srcOffset, dst, destOffset);
+    RuntimeProfiler::recordBytes(numBytes);
     std::memcpy(dstPtr, srcPtr, numBytes);
   };
 
@@ -365,6 +449,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
     PointerInfo info = tracker.get(ptr);
     MTRT_DBGF("executor_dealloc_host_pinned %lu bytes @ %lx", info.size,
               info.ptr);
+    RuntimeProfiler::recordFree(ptr);
     SET_LUA_ERROR_IF_ERROR(pinnedMemoryAllocator->freeAsync(info.ptr, stream),
                            state);
     tracker.untrack(ptr);
@@ -377,6 +462,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
     AllocTracker &tracker = *allocTracker;
     PointerInfo info = tracker.get(ptr);
     assert(info.isDeviceVisible() && "expected device-visible pointer");
+    RuntimeProfiler::recordFree(ptr);
     SET_LUA_ERROR_IF_CUDART_ERROR(
         cudaFreeAsync(reinterpret_cast<void *>(ptr), stream), state);
     tracker.untrack(ptr);
@@ -402,6 +488,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
                  "src and/or dst buffers are insufficiently sized");
         }
 #endif
+        RuntimeProfiler::recordBytes(numBytes);
         SET_LUA_ERROR_IF_CUDART_ERROR(cudaMemcpyAsync(dstPtr, srcPtr, numBytes,
                                                       cudaMemcpyHostToDevice,
                                                       stream),
@@ -428,6 +515,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
                  "src and/or dst buffers are insufficiently sized");
         }
 #endif
+        RuntimeProfiler::recordBytes(numBytes);
         SET_LUA_ERROR_IF_CUDART_ERROR(cudaMemcpyAsync(dstPtr, srcPtr, numBytes,
                                                       cudaMemcpyDeviceToHost,
                                                       stream),
@@ -454,6 +542,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
                  "src and/or dst buffers are insufficiently sized");
         }
 #endif
+        RuntimeProfiler::recordBytes(numBytes);
         SET_LUA_ERROR_IF_CUDART_ERROR(cudaMemcpyAsync(dstPtr, srcPtr, numBytes,
                                                       cudaMemcpyHostToDevice,
                                                       stream),
@@ -476,6 +565,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
         }
 #endif
         MTRT_DBGF("executor_memcpy device-host %lu bytes", numBytes);
+        RuntimeProfiler::recordBytes(numBytes);
         SET_LUA_ERROR_IF_CUDART_ERROR(cudaMemcpyAsync(dstPtr, srcPtr, numBytes,
                                                       cudaMemcpyDeviceToHost,
                                                       stream),
@@ -500,6 +590,7 @@ registerCudaMemoryManagementOps(sol::state_view &lua,
     MTRT_DBGF(
         "executor_memcpy device-device %lu bytes from %lx + %lu to %lx to %lu",
         numBytes, src, srcOffset, dest, destOffset);
+    RuntimeProfiler::recordBytes(numBytes);
     SET_LUA_ERROR_IF_CUDART_ERROR(cudaMemcpyAsync(dstPtr, srcPtr, numBytes,
                                                   cudaMemcpyDeviceToDevice,
                                                   stream),
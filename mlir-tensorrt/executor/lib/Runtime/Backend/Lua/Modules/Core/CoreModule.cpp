@@ -147,7 +147,7 @@ static bool checkAccessBounds(lua_State *state, const AllocTracker &tracker,
 //===----------------------------------------------------------------------===//
 void mlirtrt::runtime::registerExecutorCoreModuleLuaRuntimeMethods(
     lua_State *luaState, PinnedMemoryAllocator *pinnedMemoryAllocator,
-    AllocTracker *allocTracker) {
+    AllocTracker *allocTracker, unsigned numHostCopyThreads) {
   sol::state_view lua(luaState);
 
   lua["__check_for_function"] = [](sol::this_state state,
@@ -777,6 +777,7 @@ void mlirtrt::runtime::registerExecutorCoreModuleLuaRuntimeMethods(
   lua["_dealloc"] = [allocTracker](sol::this_state state, uintptr_t ptr) {
     ADD_CORE_MODULE_RANGE("core_dealloc");
     MTRT_DBGF("dealloc ptr @ 0x%lx", ptr);
+    RuntimeProfiler::recordFree(ptr);
     SET_LUA_ERROR_AND_RETURN_IF_ERROR(safeDeallocate(*allocTracker, ptr),
                                       state, );
   };
@@ -788,6 +789,7 @@ void mlirtrt::runtime::registerExecutorCoreModuleLuaRuntimeMethods(
     StatusOr<PointerInfo> buffer =
         allocate(*allocTracker, PointerType::host, bytes, alignment, {});
     SET_LUA_ERROR_AND_RETURN_IF_ERROR(buffer, state, 0);
+    RuntimeProfiler::recordAllocation(buffer->ptr, bytes);
     return buffer->ptr;
   };
 
@@ -811,6 +813,7 @@ void mlirtrt::runtime::registerExecutorCoreModuleLuaRuntimeMethods(
     }
     MTRT_DBGF("executor_memcpy host-host %lu bytes src %lx + %lu dst %lx + %lu",
               numBytes, src, srcOffset, dst, destOffset);
+    RuntimeProfiler::recordBytes(numBytes);
     std::memcpy(dstPtr, srcPtr, numBytes);
   };
 
@@ -939,10 +942,10 @@ void mlirtrt::runtime::registerExecutorCoreModuleLuaRuntimeMethods(
     if (!dstData)
       return;
 
-    executeStridedCopy(
-        elemSize, srcData, srcOffset, srcShape, srcStrides, dstData, dstOffset,
-        dstShape, dstStrides,
-        [](void *dst, void *src, size_t size) { std::memcpy(dst, src, size); });
+    StridedCopyPlan plan = planStridedCopy(elemSize, srcShape, srcOffset,
+                                           srcStrides, dstOffset, dstStrides);
+    RuntimeProfiler::recordBytes(plan.getNumBytes());
+    executeStridedCopyOnHost(plan, srcData, dstData, numHostCopyThreads);
   };
 
   //===----------------------------------------------------------------------===//
@@ -0,0 +1,408 @@
+//===- NativeCoreModule.cpp -----------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Executor Core module builtins for the native runtime backend. The
+/// semantics follow the Lua implementation in `CoreModule.cpp`, restricted to
+/// the types that the native backend supports.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Backend/Native/NativeCoreModule.h"
+#include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
+#include "mlir-executor/Runtime/Backend/Native/NativeABI.h"
+#include "mlir-executor/Runtime/Support/Support.h"
+#include "mlir-executor/Support/Status.h"
+#include "llvm/Support/FormatVariadic.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::native;
+
+static thread_local ExecutionContext *activeContext = nullptr;
+
+ExecutionContext &native::getExecutionContext() {
+  assert(activeContext && "expected an active call into native code");
+  return *activeContext;
+}
+
+ExecutionContext *native::setExecutionContext(ExecutionContext *context) {
+  return std::exchange(activeContext, context);
+}
+
+bool native::recordError(const Status &status) {
+  if (status.isOk())
+    return false;
+  getExecutionContext().errorMessage = status.getString();
+  return true;
+}
+
+void native::raiseError(const char *message) {
+  ExecutionContext &context = getExecutionContext();
+  if (message)
+    context.errorMessage = message;
+  std::longjmp(context.errorTarget, 1);
+}
+
+//===----------------------------------------------------------------------===//
+// Templated helpers
+//===----------------------------------------------------------------------===//
+
+/// Negation operator for in unary op definitions below.
+template <typename T>
+static T negate(T x) {
+  return -x;
+}
+
+template <typename IntType>
+static IntType alignToImpl(IntType arg, uint32_t alignment) {
+  typename std::make_unsigned<IntType>::type bump =
+      static_cast<typename std::make_unsigned<IntType>::type>(arg) + alignment -
+      1;
+  return static_cast<IntType>(bump - bump % alignment);
+}
+
+/// Check that an access of an `ElementType` at `basePtr + offset` is in
+/// bounds if `basePtr` is tracked. Returns false and records the error
+/// otherwise.
+template <typename ElementType>
+static bool checkAccessBounds(uintptr_t basePtr, uint64_t offset) {
+#ifndef NDEBUG
+  const AllocTracker &tracker = *getExecutionContext().allocTracker;
+  if (!tracker.contains(basePtr))
+    return true;
+  const PointerInfo &info = tracker.get(basePtr);
+  if (!info.isHostVisible())
+    return !recordError(getInvalidArgStatus(
+        "attempting to access memory {0} + {1} which is not host-visible",
+        reinterpret_cast<void *>(basePtr), offset));
+  if (offset + sizeof(ElementType) > info.size)
+    return !recordError(getInvalidArgStatus(
+        "attempting to access memory in range [{0} + {1}, {0} + {2}), "
+        "which will access memory out of bounds (size of allocation is {3})",
+        reinterpret_cast<void *>(basePtr), offset,
+        offset + sizeof(ElementType), info.size));
+#endif
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Memory operations
+//===----------------------------------------------------------------------===//
+
+/// Perform the host allocation and record any error. Returns 0 on failure.
+static uintptr_t allocateHost(size_t bytes, unsigned alignment) {
+  StatusOr<PointerInfo> buffer =
+      allocate(*getExecutionContext().allocTracker, PointerType::host, bytes,
+               alignment, {});
+  if (recordError(buffer.getStatus()))
+    return 0;
+  return buffer->ptr;
+}
+
+static uintptr_t coreAlloc(size_t bytes, unsigned alignment) {
+  MTRT_DBGF("executor_alloc: %lu bytes align(%u)", bytes, alignment);
+  uintptr_t ptr = allocateHost(bytes, alignment);
+  if (!ptr)
+    raiseError();
+  return ptr;
+}
+
+static void coreDealloc(uintptr_t ptr) {
+  MTRT_DBGF("dealloc ptr @ 0x%lx", ptr);
+  if (recordError(safeDeallocate(*getExecutionContext().allocTracker, ptr)))
+    raiseError();
+}
+
+static void coreMemcpy(uintptr_t src, size_t srcOffset, uintptr_t dst,
+                       size_t destOffset, size_t numBytes) {
+  MTRT_DBGF("executor_memcpy host-host %lu bytes src %lx + %lu dst %lx + %lu",
+            numBytes, src, srcOffset, dst, destOffset);
+  std::memcpy(reinterpret_cast<void *>(dst + destOffset),
+              reinterpret_cast<void *>(src + srcOffset), numBytes);
+}
+
+template <typename T>
+static void coreMemset(uintptr_t pointer, size_t offset, size_t numBytes,
+                       T fillInt) {
+  MTRT_DBGF("memset%lu @ 0x%lx, %lu bytes", sizeof(T) * 8, pointer, numBytes);
+  T *buffer = reinterpret_cast<T *>(pointer + offset);
+  std::fill(buffer, buffer + numBytes / sizeof(T), fillInt);
+}
+
+/// Read the unpacked memref `(allocatedPtr, alignedPtr, offset, shape...,
+/// strides...)` of rank `rank` from `args` and return the aligned pointer.
+static uintptr_t readMemRef(va_list &args, int32_t rank, int64_t &offset,
+                            std::vector<int64_t> &shape,
+                            std::vector<int64_t> &strides) {
+  (void)va_arg(args, uintptr_t);
+  uintptr_t aligned = va_arg(args, uintptr_t);
+  offset = va_arg(args, int64_t);
+  shape.resize(rank);
+  strides.resize(rank);
+  for (int64_t &dim : shape)
+    dim = va_arg(args, int64_t);
+  for (int64_t &stride : strides)
+    stride = va_arg(args, int64_t);
+  return aligned;
+}
+
+/// Generic strided copy operation. The variadic arguments contain the source
+/// and destination memrefs in unpacked form.
+static void coreStridedMemrefCopy(int32_t rank, int32_t elemSize, ...) {
+  va_list args;
+  va_start(args, elemSize);
+  int64_t srcOffset = 0, dstOffset = 0;
+  std::vector<int64_t> srcShape, srcStrides, dstShape, dstStrides;
+  uintptr_t srcData = readMemRef(args, rank, srcOffset, srcShape, srcStrides);
+  uintptr_t dstData = readMemRef(args, rank, dstOffset, dstShape, dstStrides);
+  va_end(args);
+  StridedCopyPlan plan = planStridedCopy(elemSize, srcShape, srcOffset,
+                                         srcStrides, dstOffset, dstStrides);
+  executeStridedCopyOnHost(plan, srcData, dstData,
+                           getExecutionContext().numHostCopyThreads);
+}
+
+static void coreAssertFail(const char *message) {
+  // Format into a fixed buffer since `raiseError` does not run destructors.
+  char buffer[512];
+  std::snprintf(buffer, sizeof(buffer), "assertion failed: %s", message);
+  raiseError(buffer);
+}
+
+//===----------------------------------------------------------------------===//
+// Executor - Core operations
+//===----------------------------------------------------------------------===//
+
+void native::registerCoreModuleSymbols(llvm::StringMap<void *> &symbols) {
+  auto add = [&](llvm::StringRef name, auto *func) {
+    symbols[name] = reinterpret_cast<void *>(func);
+  };
+
+  add(kAssertFailFuncName, coreAssertFail);
+
+  //===--------------------------------------------------------------------===//
+  // host memory ops
+  //===--------------------------------------------------------------------===//
+
+  add("executor_alloc", coreAlloc);
+  add("_dealloc", coreDealloc);
+  add("executor_memcpy", coreMemcpy);
+  add("__memset_32", coreMemset<uint32_t>);
+  add("__memset_16", coreMemset<uint16_t>);
+  add("__memset_8", coreMemset<uint8_t>);
+  add("_strided_memref_copy", coreStridedMemrefCopy);
+
+// Create a method `_load_[suffix]` that loads a value of type `type`.
+#define DEFINE_LOAD_METHOD(suffix, type)                                       \
+  add("_load_" #suffix, +[](uintptr_t pointer, size_t offset) -> type {        \
+    MTRT_DBGF("executor_load_" #suffix " %lx + %lu", pointer, offset);         \
+    return *reinterpret_cast<type *>(pointer + offset);                        \
+  })
+
+// Create a method `_store_[suffix]` that stores a value of type `type`.
+#define DEFINE_STORE_METHOD(suffix, type)                                      \
+  add("_store_" #suffix, +[](uintptr_t pointer, size_t offset, type value) {   \
+    MTRT_DBGF("executor_store_" #suffix " %lx + %lu", pointer, offset);        \
+    if (!checkAccessBounds<type>(pointer, offset))                             \
+      raiseError();                                                            \
+    *reinterpret_cast<type *>(pointer + offset) = value;                       \
+  })
+
+#define DEFINE_LOAD_STORE_METHODS(suffix, type)                                \
+  DEFINE_LOAD_METHOD(suffix, type);                                            \
+  DEFINE_STORE_METHOD(suffix, type)
+
+  DEFINE_LOAD_STORE_METHODS(ptr_host, uintptr_t);
+  DEFINE_LOAD_STORE_METHODS(ptr_host_pinned, uintptr_t);
+  DEFINE_LOAD_STORE_METHODS(ptr_device, uintptr_t);
+  DEFINE_LOAD_STORE_METHODS(f64, double);
+  DEFINE_LOAD_STORE_METHODS(f32, float);
+  DEFINE_LOAD_STORE_METHODS(i64, int64_t);
+  DEFINE_LOAD_STORE_METHODS(i32, int32_t);
+  DEFINE_LOAD_STORE_METHODS(i16, int16_t);
+  DEFINE_LOAD_STORE_METHODS(i8, int8_t);
+  DEFINE_LOAD_STORE_METHODS(i1, int8_t);
+
+#undef DEFINE_LOAD_STORE_METHODS
+#undef DEFINE_STORE_METHOD
+#undef DEFINE_LOAD_METHOD
+
+  //===--------------------------------------------------------------------===//
+  // Cast operations
+  //===--------------------------------------------------------------------===//
+
+#define DEFINE_CAST_METHOD(name, inpSuffix, resSuffix, inpType, resType)       \
+  add("_" #name "_" #inpSuffix "_" #resSuffix,                                 \
+      +[](inpType input) -> resType { return static_cast<resType>(input); })
+
+#define DEFINE_SITOFP_METHODS(inpSuffix, inpType)                              \
+  DEFINE_CAST_METHOD(sitofp, inpSuffix, f32, inpType, float);                  \
+  DEFINE_CAST_METHOD(sitofp, inpSuffix, f64, inpType, double);                 \
+  DEFINE_CAST_METHOD(fptosi, f32, inpSuffix, float, inpType);                  \
+  DEFINE_CAST_METHOD(fptosi, f64, inpSuffix, double, inpType)
+
+  DEFINE_SITOFP_METHODS(i8, int8_t);
+  DEFINE_SITOFP_METHODS(i16, int16_t);
+  DEFINE_SITOFP_METHODS(i32, int32_t);
+  DEFINE_SITOFP_METHODS(i64, int64_t);
+
+#undef DEFINE_SITOFP_METHODS
+
+#define DEFINE_IEXT_METHOD(inpSuffix, resSuffix, inpType, resType)             \
+  DEFINE_CAST_METHOD(siext, inpSuffix, resSuffix, inpType, resType);           \
+  add("_zext_" #inpSuffix "_" #resSuffix, +[](inpType input) -> resType {      \
+    return static_cast<resType>(                                               \
+        static_cast<std::make_unsigned_t<inpType>>(input));                    \
+  })
+
+  DEFINE_IEXT_METHOD(i32, i64, int32_t, int64_t);
+  DEFINE_IEXT_METHOD(i8, i32, int8_t, int32_t);
+  DEFINE_IEXT_METHOD(i8, i64, int8_t, int64_t);
+
+#undef DEFINE_IEXT_METHOD
+
+  // An i1 is passed as an int8_t holding 0 or 1, so it is zero-extended and
+  // sign-extended the same way (the Lua implementation does the same).
+#define DEFINE_I1_EXT_METHOD(resSuffix, resType)                               \
+  DEFINE_CAST_METHOD(zext, i1, resSuffix, int8_t, resType);                    \
+  DEFINE_CAST_METHOD(siext, i1, resSuffix, int8_t, resType)
+
+  DEFINE_I1_EXT_METHOD(i8, int8_t);
+  DEFINE_I1_EXT_METHOD(i32, int32_t);
+  DEFINE_I1_EXT_METHOD(i64, int64_t);
+
+#undef DEFINE_I1_EXT_METHOD
+
+#define DEFINE_TRUNC_METHOD(resSuffix, inpSuffix, resType, inpType)            \
+  DEFINE_CAST_METHOD(trunc, i##inpSuffix, i##resSuffix, inpType, resType)
+
+  DEFINE_TRUNC_METHOD(32, 64, int32_t, int64_t);
+  DEFINE_TRUNC_METHOD(16, 64, int16_t, int64_t);
+  DEFINE_TRUNC_METHOD(8, 64, int8_t, int64_t);
+  DEFINE_TRUNC_METHOD(16, 32, int16_t, int32_t);
+  DEFINE_TRUNC_METHOD(8, 32, int8_t, int32_t);
+
+#undef DEFINE_TRUNC_METHOD
+
+  add("_trunc_i64_i1",
+      +[](int64_t input) -> int8_t { return static_cast<int8_t>(input & 1); });
+  add("_trunc_i32_i1",
+      +[](int32_t input) -> int8_t { return static_cast<int8_t>(input & 1); });
+  add("_trunc_i8_i1",
+      +[](int8_t input) -> int8_t { return static_cast<int8_t>(input & 1); });
+
+  DEFINE_CAST_METHOD(ptrtoint, i64, i32, uintptr_t, uint32_t);
+  DEFINE_CAST_METHOD(ptrtoint, i64, i64, uintptr_t, uint64_t);
+  DEFINE_CAST_METHOD(inttoptr, i64, i32, int32_t, uintptr_t);
+  DEFINE_CAST_METHOD(inttoptr, i64, i64, int64_t, uintptr_t);
+
+#undef DEFINE_CAST_METHOD
+
+  add("_alignto_i64", alignToImpl<int64_t>);
+  add("_alignto_i32", alignToImpl<int32_t>);
+
+  //===--------------------------------------------------------------------===//
+  // Min/Max operations
+  //===--------------------------------------------------------------------===//
+
+#define DEFINE_MIN_MAX(suffix, type)                                           \
+  add("_smin_" #suffix,                                                        \
+      +[](type lhs, type rhs) -> type { return std::min(lhs, rhs); });         \
+  add("_smax_" #suffix,                                                        \
+      +[](type lhs, type rhs) -> type { return std::max(lhs, rhs); })
+
+  DEFINE_MIN_MAX(i8, int8_t);
+  DEFINE_MIN_MAX(i16, int16_t);
+  DEFINE_MIN_MAX(i32, int32_t);
+  DEFINE_MIN_MAX(i64, int64_t);
+
+#undef DEFINE_MIN_MAX
+
+#define DEFINE_FMAX_METHOD(suffix, type)                                       \
+  add("_fmax_" #suffix,                                                        \
+      +[](type lhs, type rhs) -> type { return std::fmax(lhs, rhs); });        \
+  add("_fmin_" #suffix,                                                        \
+      +[](type lhs, type rhs) -> type { return std::fmin(lhs, rhs); })
+
+  DEFINE_FMAX_METHOD(f64, double);
+  DEFINE_FMAX_METHOD(f32, float);
+
+#undef DEFINE_FMAX_METHOD
+
+  //===--------------------------------------------------------------------===//
+  // Builtin Math Ops
+  //===--------------------------------------------------------------------===//
+
+#define DEFINE_UNARY_OP_(name, suffix, type, op)                               \
+  add("_" #name "_" #suffix, +[](type inp) -> type { return op(inp); })
+
+#define DEFINE_BINARY_OP_(name, suffix, type, op)                              \
+  add("_" #name "_" #suffix,                                                   \
+      +[](type lhs, type rhs) -> type { return op(lhs, rhs); })
+
+  DEFINE_UNARY_OP_(absi, i64, int64_t, std::abs);
+  DEFINE_UNARY_OP_(absi, i32, int32_t, std::abs);
+  DEFINE_UNARY_OP_(absi, i16, int16_t, std::abs);
+  DEFINE_UNARY_OP_(absi, i8, int8_t, std::abs);
+
+#define DEFINE_FLOAT_UNARY_OP(name, op)                                        \
+  DEFINE_UNARY_OP_(name, f32, float, op);                                      \
+  DEFINE_UNARY_OP_(name, f64, double, op)
+
+  DEFINE_FLOAT_UNARY_OP(absf, std::abs);
+  DEFINE_FLOAT_UNARY_OP(cbrt, std::cbrt);
+  DEFINE_FLOAT_UNARY_OP(ceil, std::ceil);
+  DEFINE_FLOAT_UNARY_OP(cos, std::cos);
+  DEFINE_FLOAT_UNARY_OP(sin, std::sin);
+  DEFINE_FLOAT_UNARY_OP(erf, std::erf);
+  DEFINE_FLOAT_UNARY_OP(exp, std::exp);
+  DEFINE_FLOAT_UNARY_OP(exp2, std::exp2);
+  DEFINE_FLOAT_UNARY_OP(expm1, std::expm1);
+  DEFINE_FLOAT_UNARY_OP(floor, std::floor);
+  DEFINE_FLOAT_UNARY_OP(log, std::log);
+  DEFINE_FLOAT_UNARY_OP(log10, std::log10);
+  DEFINE_FLOAT_UNARY_OP(log1p, std::log1p);
+  DEFINE_FLOAT_UNARY_OP(log2, std::log2);
+  DEFINE_FLOAT_UNARY_OP(negf, negate);
+  DEFINE_FLOAT_UNARY_OP(sqrt, std::sqrt);
+  DEFINE_FLOAT_UNARY_OP(tan, std::tan);
+  DEFINE_FLOAT_UNARY_OP(tanh, std::tanh);
+  DEFINE_FLOAT_UNARY_OP(round, std::round);
+
+#undef DEFINE_FLOAT_UNARY_OP
+
+#define DEFINE_FLOAT_BINARY_OP(name, op)                                       \
+  DEFINE_BINARY_OP_(name, f32, float, op);                                     \
+  DEFINE_BINARY_OP_(name, f64, double, op)
+
+  DEFINE_FLOAT_BINARY_OP(atan2, std::atan2);
+  DEFINE_FLOAT_BINARY_OP(copysign, std::copysign);
+  DEFINE_FLOAT_BINARY_OP(powf, std::pow);
+
+#undef DEFINE_FLOAT_BINARY_OP
+#undef DEFINE_BINARY_OP_
+#undef DEFINE_UNARY_OP_
+}
@@ -0,0 +1,321 @@
+//===- NativeRuntime.cpp --------------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the native host runtime backend.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Backend/Native/NativeRuntime.h"
+#include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
+#include "mlir-executor/Runtime/Backend/Native/NativeCoreModule.h"
+#include "mlir-executor/Runtime/Support/Support.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetMachine.h"
+#include <csetjmp>
+#include <mutex>
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+
+namespace orc = llvm::orc;
+
+static Status getStatusFromError(llvm::Error error) {
+  return getInternalErrorStatus("{0}", llvm::toString(std::move(error)));
+}
+
+static void initializeNativeTarget() {
+  static std::once_flag flag;
+  std::call_once(flag, [] {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+  });
+}
+
+/// Run the default O2 pipeline on `module`.
+static void optimizeModule(llvm::Module &module, llvm::TargetMachine &tm) {
+  llvm::LoopAnalysisManager lam;
+  llvm::FunctionAnalysisManager fam;
+  llvm::CGSCCAnalysisManager cgam;
+  llvm::ModuleAnalysisManager mam;
+  llvm::PassBuilder pb(&tm);
+  pb.registerModuleAnalyses(mam);
+  pb.registerCGSCCAnalyses(cgam);
+  pb.registerFunctionAnalyses(fam);
+  pb.registerLoopAnalyses(lam);
+  pb.crossRegisterProxies(lam, fam, cgam, mam);
+  llvm::ModulePassManager mpm =
+      pb.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2);
+  mpm.run(module, mam);
+}
+
+/// Call `func` with the execution context for `session` active. The entry
+/// point is either an interface function (`iface`) or the global initializer
+/// (`init`). Errors raised by builtins transfer control back here.
+static Status invokeWithContext(NativeRuntimeSession &session,
+                                native::InterfaceFunc iface, void (*init)(),
+                                int64_t *args, int64_t *results) {
+  native::ExecutionContext context;
+  context.allocTracker = &session.getAllocTracker();
+  context.numHostCopyThreads = session.getOptions().getNumHostCopyThreads();
+  native::ExecutionContext *previous = native::setExecutionContext(&context);
+  if (setjmp(context.errorTarget) == 0) {
+    if (iface)
+      iface(args, results);
+    else
+      init();
+    native::setExecutionContext(previous);
+    return getOkStatus();
+  }
+  native::setExecutionContext(previous);
+  return getStatusWithMsg(StatusCode::InternalError, context.errorMessage);
+}
+
+//===----------------------------------------------------------------------===//
+// NativeRuntimeSession
+//===----------------------------------------------------------------------===//
+
+NativeRuntimeSession::~NativeRuntimeSession() = default;
+
+StatusOr<std::unique_ptr<NativeRuntimeSession>>
+NativeRuntimeSession::create(RuntimeSessionOptions options,
+                             ExecutableView executable) {
+  if (!executable || executable.getNativeCode().empty())
+    return getInvalidArgStatus(
+        "the executable does not contain native code; it must be translated "
+        "with native code embedded");
+  MTRT_RETURN_IF_ERROR(maybeCheckForValidNcclUuid(options));
+  initializeNativeTarget();
+
+  auto session = std::unique_ptr<NativeRuntimeSession>(
+      new NativeRuntimeSession(std::move(options), executable));
+
+  // Parse and optimize the module for the host.
+  auto context = std::make_unique<llvm::LLVMContext>();
+  std::string_view code = executable.getNativeCode();
+  llvm::Expected<std::unique_ptr<llvm::Module>> module =
+      llvm::parseBitcodeFile(
+          llvm::MemoryBufferRef(llvm::StringRef(code.data(), code.size()),
+                                executable.getName()),
+          *context);
+  if (!module)
+    return getStatusFromError(module.takeError());
+
+  llvm::Expected<orc::JITTargetMachineBuilder> jtmb =
+      orc::JITTargetMachineBuilder::detectHost();
+  if (!jtmb)
+    return getStatusFromError(jtmb.takeError());
+  jtmb->setCodeGenOptLevel(llvm::CodeGenOptLevel::Default);
+  llvm::Expected<std::unique_ptr<llvm::TargetMachine>> tm =
+      jtmb->createTargetMachine();
+  if (!tm)
+    return getStatusFromError(tm.takeError());
+  (*module)->setDataLayout((*tm)->createDataLayout());
+  (*module)->setTargetTriple((*tm)->getTargetTriple().str());
+  optimizeModule(**module, **tm);
+
+  llvm::Expected<std::unique_ptr<orc::LLJIT>> jit =
+      orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(*jtmb)).create();
+  if (!jit)
+    return getStatusFromError(jit.takeError());
+  session->jit = std::move(*jit);
+
+  // Provide the builtins and, for functions like `printf`, the symbols of the
+  // current process.
+  orc::JITDylib &dylib = session->jit->getMainJITDylib();
+  llvm::StringMap<void *> builtins;
+  native::registerCoreModuleSymbols(builtins);
+  orc::SymbolMap symbols;
+  for (const auto &entry : builtins)
+    symbols[session->jit->mangleAndIntern(entry.getKey())] = {
+        orc::ExecutorAddr::fromPtr(entry.getValue()),
+        llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+  if (llvm::Error err = dylib.define(orc::absoluteSymbols(std::move(symbols))))
+    return getStatusFromError(std::move(err));
+  llvm::Expected<std::unique_ptr<orc::DynamicLibrarySearchGenerator>>
+      processSymbols = orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          session->jit->getDataLayout().getGlobalPrefix());
+  if (!processSymbols)
+    return getStatusFromError(processSymbols.takeError());
+  dylib.addGenerator(std::move(*processSymbols));
+
+  if (llvm::Error err = session->jit->addIRModule(orc::ThreadSafeModule(
+          std::move(*module), std::move(context))))
+    return getStatusFromError(std::move(err));
+
+  // Store the addresses of the constants in the globals of the same name.
+  llvm::SmallVector<std::pair<std::string, uintptr_t>> constants;
+  MTRT_RETURN_IF_ERROR(
+      loadConstants(executable, session->getAllocTracker(),
+                    [&](std::string_view name, uintptr_t ptr) {
+                      constants.emplace_back(std::string(name), ptr);
+                    }));
+  for (const auto &[name, ptr] : constants) {
+    llvm::Expected<orc::ExecutorAddr> global = session->jit->lookup(name);
+    if (!global)
+      return getStatusFromError(global.takeError());
+    *global->toPtr<uintptr_t *>() = ptr;
+  }
+
+  // Run the global initializer, if present.
+  llvm::Expected<orc::ExecutorAddr> init = session->jit->lookup(
+      llvm::StringRef(native::kInitGlobalsFuncName.data(),
+                      native::kInitGlobalsFuncName.size()));
+  if (!init) {
+    llvm::consumeError(init.takeError());
+    return session;
+  }
+  MTRT_RETURN_IF_ERROR(invokeWithContext(*session, nullptr,
+                                         init->toPtr<void (*)()>(), nullptr,
+                                         nullptr));
+  return session;
+}
+
+StatusOr<native::InterfaceFunc>
+NativeRuntimeSession::lookupInterfaceFunction(std::string_view name) {
+  std::string symbol = std::string(native::kInterfaceFuncPrefix);
+  symbol += name;
+  llvm::Expected<orc::ExecutorAddr> func = jit->lookup(symbol);
+  if (!func) {
+    llvm::consumeError(func.takeError());
+    return getStatusWithMsg(StatusCode::InternalError, "no function named \"",
+                            std::string(name), "\" found");
+  }
+  return func->toPtr<native::InterfaceFunc>();
+}
+
+Status runtime::invokeNativeFunction(NativeRuntimeSession &session,
+                                     native::InterfaceFunc func,
+                                     int64_t *args, int64_t *results) {
+  return invokeWithContext(session, func, nullptr, args, results);
+}
+
+//===----------------------------------------------------------------------===//
+// Function execution
+//===----------------------------------------------------------------------===//
+
+/// Append the slots of the unpacked memref `value`, which are
+/// (allocated_ptr, aligned_ptr, offset, [shape list], [stride list]), and
+/// inform `tracker` that the buffer is managed outside the session.
+static void pushMemRefSlots(AllocTracker &tracker,
+                            llvm::SmallVectorImpl<int64_t> &slots,
+                            const MemRefValue &value) {
+  uintptr_t ptr = value.getMemory();
+  assert(ptr != 0 && "expected non-null pointer");
+  slots.push_back(static_cast<int64_t>(ptr));
+  slots.push_back(static_cast<int64_t>(ptr));
+  slots.push_back(value.getOffset());
+  llvm::append_range(slots, value.getShape());
+  llvm::append_range(slots, value.getStrides());
+  tracker.track(value.getPointerInfo(PointerOwner::external));
+}
+
+/// Append the slot of the scalar `value`. Scalars are held in the low-order
+/// bytes of their slot, which is also how `ScalarValue` stores them.
+static Status pushScalarSlot(llvm::SmallVectorImpl<int64_t> &slots,
+                             const ScalarValue &value) {
+  switch (value.getType().getCode()) {
+  case ScalarTypeCode::f32:
+  case ScalarTypeCode::f64:
+  case ScalarTypeCode::i1:
+  case ScalarTypeCode::i8:
+  case ScalarTypeCode::i16:
+  case ScalarTypeCode::i32:
+  case ScalarTypeCode::i64:
+    slots.push_back(value.get<int64_t>());
+    return getOkStatus();
+  default:
+    return getInvalidArgStatus(
+        "function input argument with scalar type {0} is unsupported by the "
+        "native backend",
+        impl::EnumNameScalarTypeCode(value.getType().getCode()));
+  }
+}
+
+StatusOr<llvm::SmallVector<std::unique_ptr<RuntimeValue>>>
+runtime::executeFunctionWithNativeBackend(
+    NativeRuntimeSession &session, std::string_view name,
+    llvm::ArrayRef<RuntimeValue *> inputArgs,
+    llvm::ArrayRef<RuntimeValue *> outputArgs) {
+  MTRT_ASSIGN_OR_RETURN(native::InterfaceFunc func,
+                        session.lookupInterfaceFunction(name));
+
+  FunctionSignatureView sig =
+      session.getExecutable().getFunction(name).getSignature();
+  if (sig.getNumResults() > 0)
+    return getInvalidArgStatus("functions with {0} results are not supported",
+                               sig.getNumResults());
+
+  MTRT_RETURN_IF_ERROR(validateFunctionArgs(sig, inputArgs, outputArgs));
+
+  AllocTracker &tracker = session.getAllocTracker();
+  llvm::SmallVector<int64_t> args;
+  for (auto [idx, rv] : llvm::enumerate(inputArgs)) {
+    if (MemRefValue *memref = llvm::dyn_cast<MemRefValue>(rv)) {
+      pushMemRefSlots(tracker, args, *memref);
+      continue;
+    }
+    if (ScalarValue *scalar = llvm::dyn_cast<ScalarValue>(rv)) {
+      MTRT_RETURN_IF_ERROR(pushScalarSlot(args, *scalar));
+      continue;
+    }
+    return getInvalidArgStatus(
+        "input argument #{0} to function {1} has an unsupported type; "
+        "arguments must be either MemRefs or scalars",
+        idx + 1, name);
+  }
+  for (auto [idx, rv] : llvm::enumerate(outputArgs)) {
+    if (MemRefValue *memref = llvm::dyn_cast<MemRefValue>(rv)) {
+      pushMemRefSlots(tracker, args, *memref);
+      continue;
+    }
+    return getInvalidArgStatus("output (destination) argument #{0} to function "
+                               "{1} has an unsupported type; "
+                               "destination arguments must be MemRefs",
+                               idx + 1, name);
+  }
+
+  Status status = invokeNativeFunction(session, func, args.data(), nullptr);
+  if (!status.isOk())
+    return getStatusWithMsg(StatusCode::InternalError,
+                            "failed to run function \"", std::string(name),
+                            "\": ", status.getString());
+  return llvm::SmallVector<std::unique_ptr<RuntimeValue>>{};
+}
+
+StatusOr<int64_t> runtime::runExecutorExecutableWithNativeBackend(
+    std::unique_ptr<Executable> executable) {
+  MTRT_ASSIGN_OR_RETURN(
+      std::unique_ptr<NativeRuntimeSession> session,
+      NativeRuntimeSession::create(RuntimeSessionOptions(),
+                                   executable->getView()));
+  MTRT_ASSIGN_OR_RETURN(native::InterfaceFunc mainFunc,
+                        session->lookupInterfaceFunction("main"));
+  int64_t result = 0;
+  MTRT_RETURN_IF_ERROR(
+      invokeNativeFunction(*session, mainFunc, nullptr, &result));
+  return static_cast<int32_t>(result);
+}
@@ -0,0 +1,288 @@
+//===- Profiler.cpp -------------------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the runtime profiler.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Support/Profiler.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include <atomic>
+
+using namespace mlirtrt::runtime;
+
+thread_local RuntimeProfiler::ThreadState RuntimeProfiler::activeState;
+
+/// Return a small integer that identifies the calling thread in traces.
+static uint32_t getThreadId() {
+  static std::atomic<uint32_t> nextThreadId{0};
+  thread_local uint32_t threadId = nextThreadId++;
+  return threadId;
+}
+
+static void accumulate(RuntimeProfiler::Statistics &lhs,
+                       const RuntimeProfiler::Statistics &rhs) {
+  lhs.numCalls += rhs.numCalls;
+  lhs.totalNs += rhs.totalNs;
+  lhs.numBytes += rhs.numBytes;
+  lhs.numAllocations += rhs.numAllocations;
+  lhs.numAllocatedBytes += rhs.numAllocatedBytes;
+}
+
+RuntimeProfiler::RuntimeProfiler(size_t maxNumEvents)
+    : origin(std::chrono::steady_clock::now()), maxNumEvents(maxNumEvents) {}
+
+const char *RuntimeProfiler::internFunctionName(llvm::StringRef function) {
+  std::lock_guard<std::mutex> lock(mutex);
+  // The keys of a `StringSet` are null-terminated and have stable addresses.
+  return functionNames.insert(function).first->getKeyData();
+}
+
+void RuntimeProfiler::record(const char *function, const char *builtin,
+                             const Statistics &delta, const Event &event) {
+  accumulate(stats[{function, builtin}], delta);
+  if (events.size() < maxNumEvents)
+    events.push_back(event);
+  else
+    numDroppedEvents++;
+}
+
+//===----------------------------------------------------------------------===//
+// Scopes
+//===----------------------------------------------------------------------===//
+
+RuntimeProfiler::FunctionScope::FunctionScope(RuntimeProfiler *profiler,
+                                              llvm::StringRef function)
+    : profiler(profiler), prevProfiler(activeState.profiler),
+      prevFunction(activeState.function) {
+  if (!profiler)
+    return;
+  this->function = profiler->internFunctionName(function);
+  activeState = ThreadState{profiler, this->function, nullptr};
+  startNs = profiler->now();
+}
+
+RuntimeProfiler::FunctionScope::~FunctionScope() {
+  if (!profiler)
+    return;
+  int64_t durationNs = profiler->now() - startNs;
+  // The builtin is reset as well since a Lua error may unwind past a
+  // `BuiltinScope` without running its destructor.
+  activeState = ThreadState{prevProfiler, prevFunction, nullptr};
+
+  Statistics stats;
+  stats.numCalls = 1;
+  stats.totalNs = durationNs;
+  Event event{EventKind::Function, function,   function, getThreadId(),
+              startNs,             durationNs, 0,        0};
+  std::lock_guard<std::mutex> lock(profiler->mutex);
+  profiler->record(function, nullptr, stats, event);
+}
+
+void RuntimeProfiler::BuiltinScope::begin() {
+  parent = activeState.builtin;
+  activeState.builtin = this;
+  startNs = profiler->now();
+}
+
+void RuntimeProfiler::BuiltinScope::end() {
+  int64_t durationNs = profiler->now() - startNs;
+  activeState.builtin = parent;
+
+  Statistics stats;
+  stats.numCalls = 1;
+  stats.totalNs = durationNs;
+  stats.numBytes = numBytes;
+  stats.numAllocations = numAllocations;
+  stats.numAllocatedBytes = numAllocatedBytes;
+  Event event{EventKind::Builtin, name,    activeState.function,
+              getThreadId(),      startNs, durationNs,
+              numBytes,           /*ptr=*/0};
+  std::lock_guard<std::mutex> lock(profiler->mutex);
+  profiler->record(activeState.function, name, stats, event);
+}
+
+void RuntimeProfiler::recordAllocation(uintptr_t ptr, int64_t numBytes) {
+  BuiltinScope *builtin = activeState.builtin;
+  if (!builtin)
+    return;
+  builtin->numAllocations++;
+  builtin->numAllocatedBytes += numBytes;
+
+  RuntimeProfiler *profiler = builtin->profiler;
+  Event event{EventKind::Allocation, builtin->name,   activeState.function,
+              getThreadId(),         profiler->now(), /*durationNs=*/0,
+              numBytes,              ptr};
+  std::lock_guard<std::mutex> lock(profiler->mutex);
+  profiler->record(activeState.function, builtin->name, Statistics(), event);
+}
+
+void RuntimeProfiler::recordFree(uintptr_t ptr) {
+  BuiltinScope *builtin = activeState.builtin;
+  if (!builtin)
+    return;
+  RuntimeProfiler *profiler = builtin->profiler;
+  Event event{EventKind::Free, builtin->name,   activeState.function,
+              getThreadId(),   profiler->now(), /*durationNs=*/0,
+              /*numBytes=*/0,  ptr};
+  std::lock_guard<std::mutex> lock(profiler->mutex);
+  profiler->record(activeState.function, builtin->name, Statistics(), event);
+}
+
+//===----------------------------------------------------------------------===//
+// Queries and printing
+//===----------------------------------------------------------------------===//
+
+RuntimeProfiler::Statistics
+RuntimeProfiler::getStatistics(llvm::StringRef function,
+                               llvm::StringRef builtin) const {
+  // The same builtin name may be stored at different addresses (e.g. by
+  // different modules), so the names are compared by value.
+  Statistics result;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (const auto &[key, value] : stats) {
+    if (function == key.first &&
+        builtin == (key.second ? llvm::StringRef(key.second) : ""))
+      accumulate(result, value);
+  }
+  return result;
+}
+
+std::vector<RuntimeProfiler::Event> RuntimeProfiler::getEvents() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return events;
+}
+
+int64_t RuntimeProfiler::getNumDroppedEvents() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return numDroppedEvents;
+}
+
+void RuntimeProfiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  // Function names are kept since active scopes may refer to them.
+  stats.clear();
+  events.clear();
+  numDroppedEvents = 0;
+}
+
+void RuntimeProfiler::printChromeTrace(llvm::raw_ostream &os) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  llvm::json::OStream json(os);
+  json.object([&] {
+    json.attribute("displayTimeUnit", "ns");
+    json.attributeArray("traceEvents", [&] {
+      for (const Event &event : events) {
+        json.object([&] {
+          bool isMemoryEvent = event.kind == EventKind::Allocation ||
+                               event.kind == EventKind::Free;
+          json.attribute("name", isMemoryEvent
+                                     ? (event.kind == EventKind::Free
+                                            ? "free"
+                                            : "alloc")
+                                     : event.name);
+          json.attribute("cat", event.kind == EventKind::Function ? "function"
+                                : isMemoryEvent                   ? "memory"
+                                                                  : "builtin");
+          json.attribute("ph", isMemoryEvent ? "i" : "X");
+          json.attribute("pid", 0);
+          json.attribute("tid", static_cast<int64_t>(event.threadId));
+          // Chrome trace timestamps are in microseconds.
+          json.attribute("ts", static_cast<double>(event.startNs) / 1e3);
+          if (isMemoryEvent)
+            json.attribute("s", "t");
+          else
+            json.attribute("dur", static_cast<double>(event.durationNs) / 1e3);
+          if (event.kind == EventKind::Function)
+            return;
+          json.attributeObject("args", [&] {
+            json.attribute("function", event.function);
+            if (isMemoryEvent) {
+              json.attribute("builtin", event.name);
+              json.attribute("ptr", "0x" + llvm::utohexstr(event.ptr));
+            }
+            if (event.kind != EventKind::Free)
+              json.attribute("bytes", event.numBytes);
+          });
+        });
+      }
+    });
+    json.attributeObject("otherData", [&] {
+      json.attribute("droppedEvents", numDroppedEvents);
+    });
+  });
+}
+
+void RuntimeProfiler::printSummary(llvm::raw_ostream &os) const {
+  struct FunctionSummary {
+    Statistics stats;
+    llvm::StringMap<Statistics> builtins;
+  };
+  llvm::StringMap<FunctionSummary> functions;
+  int64_t numDropped;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &[key, value] : stats) {
+      FunctionSummary &summary = functions[key.first];
+      accumulate(key.second ? summary.builtins[key.second] : summary.stats,
+                 value);
+    }
+    numDropped = numDroppedEvents;
+  }
+
+  const char *format = "{0,-40} {1,10} {2,12} {3,12} {4,14} {5,8} {6,14}\n";
+  os << llvm::formatv(format, "function / builtin", "calls", "total (ms)",
+                      "avg (us)", "bytes", "allocs", "alloc bytes");
+  auto printRow = [&](llvm::StringRef name, const Statistics &row) {
+    double totalMs = static_cast<double>(row.totalNs) / 1e6;
+    double avgUs =
+        row.numCalls ? static_cast<double>(row.totalNs) / row.numCalls / 1e3
+                     : 0.0;
+    os << llvm::formatv(format, name, row.numCalls,
+                        llvm::formatv("{0:f3}", totalMs).str(),
+                        llvm::formatv("{0:f3}", avgUs).str(), row.numBytes,
+                        row.numAllocations, row.numAllocatedBytes);
+  };
+
+  llvm::SmallVector<llvm::StringRef> functionNames =
+      llvm::to_vector(functions.keys());
+  llvm::sort(functionNames);
+  for (llvm::StringRef function : functionNames) {
+    const FunctionSummary &summary = functions[function];
+    printRow(function, summary.stats);
+
+    llvm::SmallVector<const llvm::StringMapEntry<Statistics> *> builtins;
+    for (const llvm::StringMapEntry<Statistics> &entry : summary.builtins)
+      builtins.push_back(&entry);
+    llvm::sort(builtins, [](const auto *lhs, const auto *rhs) {
+      if (lhs->getValue().totalNs != rhs->getValue().totalNs)
+        return lhs->getValue().totalNs > rhs->getValue().totalNs;
+      return lhs->getKey() < rhs->getKey();
+    });
+    for (const llvm::StringMapEntry<Statistics> *entry : builtins)
+      printRow(("  " + entry->getKey()).str(), entry->getValue());
+  }
+  if (numDropped > 0)
+    os << llvm::formatv("({0} events were dropped from the trace)\n",
+                        numDropped);
+}
@@ -24,10 +24,15 @@
 #include "mlir-executor/Support/Allocators.h"
 #include "mlir-executor/Support/Status.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/bit.h"
+#include "llvm/Support/Alignment.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
 #include <deque>
+#include <limits>
+#include <map>
 #include <set>
 
 #ifdef MLIR_EXECUTOR_ENABLE_CUDA
@@ -97,203 +102,783 @@ StatusOr<std::unique_ptr<PoolTrackedCudaEvent>> EventPool::getCudaEvent() {
 }
 
 //===----------------------------------------------------------------------===//
-// PinnedMemoryAllocator
+// AllocatorBackend
 //===----------------------------------------------------------------------===//
 
+AllocatorBackend::~AllocatorBackend() = default;
+
 namespace {
-/// Encapsulates a block of memory allocated by the pooling allocator.
-struct Block {
-  /// The byte size of the block.
-  size_t size{0};
-  /// The pointer to the start of the block.
-  uintptr_t ptr{0};
-  /// The number of pending events that must lapse before this block can be
-  /// returned to the free pool.
-  unsigned pendingEvents{0};
+class HostAllocatorBackend : public AllocatorBackend {
+public:
+  StatusOr<uintptr_t> allocate(uint64_t size, uint32_t alignment,
+                               std::optional<CudaStream> stream) final {
+    assert(!stream && "host allocations cannot be stream-ordered");
+    void *mem = ::aligned_alloc(alignment, llvm::alignTo(size, alignment));
+    if (!mem)
+      return getInternalErrorStatus("failed to allocate memory on host");
+    return reinterpret_cast<uintptr_t>(mem);
+  }
+
+  Status deallocate(uintptr_t ptr, std::optional<CudaStream> stream) final {
+    std::free(reinterpret_cast<void *>(ptr));
+    return getOkStatus();
+  }
 };
 
-/// A functor that compares blocks. For use with `std::set`.
-struct BlockComparison {
-  bool operator()(const Block *lhs, const Block *rhs) const {
-    if (lhs->size != rhs->size)
-      return lhs->size < rhs->size;
-    return lhs->ptr < rhs->ptr;
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+class CudaDeviceAllocatorBackend : public AllocatorBackend {
+public:
+  StatusOr<uintptr_t> allocate(uint64_t size, uint32_t alignment,
+                               std::optional<CudaStream> stream) final {
+    // CUDA allocations are aligned to at least 256 bytes.
+    void *mem{nullptr};
+    if (stream) {
+      RETURN_ERROR_IF_CUDART_ERROR(cudaMallocAsync(
+          &mem, size, reinterpret_cast<cudaStream_t>(*stream)));
+    } else {
+      RETURN_ERROR_IF_CUDART_ERROR(cudaMalloc(&mem, size));
+    }
+    return reinterpret_cast<uintptr_t>(mem);
   }
 
-  using is_transparent = void;
-  bool operator()(const Block *lhs, Block rhs) const {
-    if (lhs->size != rhs.size)
-      return lhs->size < rhs.size;
-    return lhs->ptr < rhs.ptr;
+  Status deallocate(uintptr_t ptr, std::optional<CudaStream> stream) final {
+    if (stream) {
+      RETURN_ERROR_IF_CUDART_ERROR(
+          cudaFreeAsync(reinterpret_cast<void *>(ptr),
+                        reinterpret_cast<cudaStream_t>(*stream)));
+    } else {
+      RETURN_ERROR_IF_CUDART_ERROR(cudaFree(reinterpret_cast<void *>(ptr)));
+    }
+    return getOkStatus();
   }
-  bool operator()(Block lhs, const Block *rhs) const {
-    if (lhs.size != rhs->size)
-      return lhs.size < rhs->size;
-    return lhs.ptr < rhs->ptr;
+
+  Status synchronize() final {
+    RETURN_ERROR_IF_CUDART_ERROR(cudaDeviceSynchronize());
+    return getOkStatus();
   }
 };
-} // namespace
 
-struct PinnedMemoryAllocator::BlockSet {
-  template <typename... Args>
-  auto insert(Args &&...args) {
-    return set.insert(std::forward<Args>(args)...);
+class CudaPinnedHostAllocatorBackend : public AllocatorBackend {
+public:
+  StatusOr<uintptr_t> allocate(uint64_t size, uint32_t alignment,
+                               std::optional<CudaStream> stream) final {
+    // Page-locked allocations are page aligned.
+    void *mem{nullptr};
+    RETURN_ERROR_IF_CUDART_ERROR(
+        cudaHostAlloc(&mem, size, cudaHostAllocDefault));
+    return reinterpret_cast<uintptr_t>(mem);
+  }
+
+  Status deallocate(uintptr_t ptr, std::optional<CudaStream> stream) final {
+    RETURN_ERROR_IF_CUDART_ERROR(cudaFreeHost(reinterpret_cast<void *>(ptr)));
+    return getOkStatus();
+  }
+
+  Status synchronize() final {
+    RETURN_ERROR_IF_CUDART_ERROR(cudaDeviceSynchronize());
+    return getOkStatus();
   }
-  std::set<Block *, BlockComparison> set;
 };
+#endif
+} // namespace
 
-struct PinnedMemoryAllocator::BlockEventQueue {
-  /// A BlockEvent is a pair (cudaEvent, Block*) that represents a dependency of
-  /// Block* on cudaDevent before the block can be released into the free pool.
-  using BlockEvent = std::pair<std::unique_ptr<PoolTrackedCudaEvent>, Block *>;
+std::unique_ptr<AllocatorBackend> mlirtrt::createHostAllocatorBackend() {
+  return std::make_unique<HostAllocatorBackend>();
+}
 
-  /// The queue of BlockEvents currently in play. New BlockEvents go into the
-  /// front.
-  std::deque<BlockEvent> eventQueue;
+StatusOr<std::unique_ptr<AllocatorBackend>>
+mlirtrt::createCudaDeviceAllocatorBackend() {
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  return std::unique_ptr<AllocatorBackend>(
+      std::make_unique<CudaDeviceAllocatorBackend>());
+#else
+  return getInternalErrorStatus(
+      "MLIR-Executor was not built with CUDA enabled");
+#endif
+}
 
-  /// If the event queue is non-empty, return the oldest event.
-  std::optional<BlockEvent> getNextOldestBlockEvent() {
-    if (eventQueue.empty())
-      return {};
-    BlockEvent event = std::move(eventQueue.back());
-    eventQueue.pop_back();
-    return event;
-  }
+StatusOr<std::unique_ptr<AllocatorBackend>>
+mlirtrt::createCudaPinnedHostAllocatorBackend() {
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  return std::unique_ptr<AllocatorBackend>(
+      std::make_unique<CudaPinnedHostAllocatorBackend>());
+#else
+  return getInternalErrorStatus(
+      "MLIR-Executor was not built with CUDA enabled");
+#endif
+}
 
-  /// Checks the event queue, and if a block can be freed, move it into
-  /// `freeBlocks`.
-  Status checkForFreeBlocks(
-      std::unique_ptr<PinnedMemoryAllocator::BlockSet> &freeBlocks);
-};
+//===----------------------------------------------------------------------===//
+// StreamEventSource
+//===----------------------------------------------------------------------===//
+
+StreamEventSource::~StreamEventSource() = default;
 
-Status PinnedMemoryAllocator::BlockEventQueue::checkForFreeBlocks(
-    std::unique_ptr<PinnedMemoryAllocator::BlockSet> &freeBlocks) {
 #ifdef MLIR_EXECUTOR_ENABLE_CUDA
-  while (std::optional<BlockEvent> blockEvent = getNextOldestBlockEvent()) {
-    auto &[eventPtr, block] = *blockEvent;
-    cudaError_t status =
-        cudaEventQuery(reinterpret_cast<cudaEvent_t>(eventPtr->getEvent()));
+namespace {
+/// An event source that records pooled CUDA events.
+class CudaStreamEventSource : public StreamEventSource {
+public:
+  StatusOr<CudaEvent> record(CudaStream stream) final {
+    StatusOr<std::unique_ptr<PoolTrackedCudaEvent>> event =
+        eventPool.getCudaEvent();
+    if (!event.isOk())
+      return event.getStatus();
+    CudaEvent handle = (*event)->getEvent();
+    RETURN_ERROR_IF_CUDART_ERROR(
+        cudaEventRecord(reinterpret_cast<cudaEvent_t>(handle),
+                        reinterpret_cast<cudaStream_t>(stream)));
+    activeEvents.try_emplace(handle, std::move(*event));
+    return handle;
+  }
+
+  StatusOr<bool> isComplete(CudaEvent event) final {
+    cudaError_t status = cudaEventQuery(reinterpret_cast<cudaEvent_t>(event));
     if (status == cudaErrorNotReady) {
       (void)cudaGetLastError();
-      eventQueue.emplace_back(std::move(*blockEvent));
-      return getOkStatus();
+      return false;
     }
     RETURN_ERROR_IF_CUDART_ERROR(status);
-
-    // Decrement use and push block if available.
-    if (--block->pendingEvents == 0)
-      freeBlocks->insert(block);
+    return true;
   }
-  return getOkStatus();
+
+  /// Releasing the pool-tracked event returns it to the pool.
+  void release(CudaEvent event) final { activeEvents.erase(event); }
+
+private:
+  EventPool eventPool;
+  llvm::DenseMap<CudaEvent, std::unique_ptr<PoolTrackedCudaEvent>>
+      activeEvents;
+};
+} // namespace
+#endif
+
+StatusOr<std::unique_ptr<StreamEventSource>>
+mlirtrt::createCudaStreamEventSource() {
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  return std::unique_ptr<StreamEventSource>(
+      std::make_unique<CudaStreamEventSource>());
 #else
   return getInternalErrorStatus(
       "MLIR-Executor was not built with CUDA enabled");
 #endif
 }
 
-static void cudaFreeHostWrapper(uintptr_t ptr) {
-#ifdef MLIR_EXECUTOR_ENABLE_CUDA
-  cudaError_t err = cudaFreeHost(reinterpret_cast<void *>(ptr));
-  if (err != cudaSuccess) {
-    llvm::errs() << llvm::formatv("'cudaFreeHost' error: ({0}) {1}\n",
-                                  cudaGetErrorName(err),
-                                  cudaGetErrorString(err));
-    return;
+//===----------------------------------------------------------------------===//
+// PinnedMemoryAllocator
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// A region of pinned memory obtained from the backend.
+struct Chunk {
+  uintptr_t base{0};
+  uint64_t size{0};
+  /// A dedicated chunk holds a single allocation and is never split.
+  bool dedicated{false};
+};
+
+/// An allocated block.
+struct AllocatedBlock {
+  uint64_t size{0};
+  bool dedicated{false};
+  /// The number of pending frees that must complete before this block can be
+  /// released.
+  unsigned pendingEvents{0};
+};
+} // namespace
+
+struct PinnedMemoryAllocator::Impl {
+  Impl(std::unique_ptr<AllocatorBackend> backend,
+       std::unique_ptr<StreamEventSource> eventSource,
+       PinnedMemoryAllocatorOptions options)
+      : backend(std::move(backend)), eventSource(std::move(eventSource)),
+        options(std::move(options)),
+        maxOrder(llvm::Log2_64(this->options.chunkSize /
+                               this->options.minBlockSize)),
+        freeLists(maxOrder + 1) {
+    assert(llvm::isPowerOf2_64(this->options.minBlockSize) &&
+           llvm::isPowerOf2_64(this->options.chunkSize) &&
+           this->options.chunkSize >= this->options.minBlockSize &&
+           "expected power of two block and chunk sizes");
   }
-#else
-  llvm_unreachable("attempted to call cudaFreeHost, but MLIR-Executor was not "
-                   "built with CUDA enabled");
-#endif
+
+  ~Impl();
+
+  uint64_t getBlockSize(unsigned order) const {
+    return options.minBlockSize << order;
+  }
+
+  /// Return the chunk containing `ptr`.
+  Chunk &getChunk(uintptr_t ptr) {
+    auto it = chunks.upper_bound(ptr);
+    assert(it != chunks.begin() && "expected pointer within a chunk");
+    return std::prev(it)->second;
+  }
+
+  /// Take a free block of the given order, splitting a larger block if
+  /// required.
+  std::optional<uintptr_t> takeFreeBlock(unsigned order);
+
+  /// Obtain `size` bytes from the backend while respecting the budget.
+  StatusOr<uintptr_t> reserve(uint64_t size);
+
+  /// Release the block at `ptr`, merging it with free buddies.
+  Status releaseBlock(uintptr_t ptr);
+
+  /// Return the free chunk at `base` to the backend.
+  Status releaseChunk(uintptr_t base);
+
+  /// Release free chunks to the backend until at most `numToKeep` remain.
+  Status releaseFreeChunks(unsigned numToKeep);
+
+  /// Take a cached dedicated block of at least `size` bytes that wastes less
+  /// than `size` bytes.
+  std::optional<uintptr_t> takeCachedDedicatedBlock(uint64_t size);
+
+  /// Return cached dedicated blocks to the backend, largest first, until at
+  /// most `bytesToKeep` bytes remain cached.
+  Status releaseCachedDedicatedBlocks(uint64_t bytesToKeep);
+
+  /// Release the blocks whose events have completed.
+  Status processPendingFrees();
+
+  std::unique_ptr<AllocatorBackend> backend;
+  std::unique_ptr<StreamEventSource> eventSource;
+  PinnedMemoryAllocatorOptions options;
+  /// The order of a whole chunk.
+  unsigned maxOrder;
+  /// All chunks, keyed by base address.
+  std::map<uintptr_t, Chunk> chunks;
+  /// The addresses of the free blocks of each order. Allocation prefers low
+  /// addresses, which keeps the high chunks free so they can be released.
+  llvm::SmallVector<std::set<uintptr_t>> freeLists;
+  /// Released dedicated blocks keyed by size. They are kept for later
+  /// requests of a similar size, which avoids pinning and unpinning memory
+  /// for every large transfer, and are only returned to the backend by `trim`
+  /// or when the budget requires it.
+  std::multimap<uint64_t, uintptr_t> cachedDedicatedBlocks;
+  /// All allocated blocks, including the ones with pending frees.
+  llvm::DenseMap<uintptr_t, AllocatedBlock> allocatedBlocks;
+  /// Pairs of (event, block) for blocks that are released once the event has
+  /// completed.
+  std::deque<std::pair<CudaEvent, uintptr_t>> pendingFrees;
+  uint64_t bytesReserved{0};
+  uint64_t bytesAllocated{0};
+  uint64_t bytesCachedDedicated{0};
+
+  /// Guards all of the state above. Host-to-device copies may be issued
+  /// concurrently, e.g. from several Python threads.
+  std::mutex mutex;
+};
+
+PinnedMemoryAllocator::Impl::~Impl() {
+  ALLOC_DBGF("[PinnedMemoryAllocator] releasing %lu chunks", chunks.size());
+  for (auto &[event, ptr] : pendingFrees)
+    eventSource->release(event);
+  for (auto &[base, chunk] : chunks) {
+    Status status = backend->deallocate(base, {});
+    if (!status.isOk())
+      llvm::errs() << "error while releasing pinned memory: "
+                   << status.getString() << "\n";
+  }
+}
+
+std::optional<uintptr_t>
+PinnedMemoryAllocator::Impl::takeFreeBlock(unsigned order) {
+  for (unsigned k = order; k <= maxOrder; ++k) {
+    if (freeLists[k].empty())
+      continue;
+    uintptr_t ptr = *freeLists[k].begin();
+    freeLists[k].erase(freeLists[k].begin());
+    // Split the block, keeping the lower half and freeing the upper half.
+    while (k > order) {
+      --k;
+      freeLists[k].insert(ptr + getBlockSize(k));
+    }
+    return ptr;
+  }
+  return {};
+}
+
+StatusOr<uintptr_t> PinnedMemoryAllocator::Impl::reserve(uint64_t size) {
+  if (options.maxPinnedBytes > 0 &&
+      bytesReserved + size > options.maxPinnedBytes) {
+    MTRT_RETURN_IF_ERROR(processPendingFrees());
+    MTRT_RETURN_IF_ERROR(releaseFreeChunks(0));
+    uint64_t available = options.maxPinnedBytes -
+                         std::min(options.maxPinnedBytes, bytesReserved);
+    if (size > available)
+      MTRT_RETURN_IF_ERROR(releaseCachedDedicatedBlocks(
+          bytesCachedDedicated -
+          std::min(bytesCachedDedicated, size - available)));
+    if (bytesReserved + size > options.maxPinnedBytes)
+      return getInternalErrorStatus(
+          "allocating {0} bytes of pinned memory would exceed the budget of "
+          "{1} bytes ({2} bytes in use)",
+          size, options.maxPinnedBytes, bytesReserved);
+  }
+  MTRT_ASSIGN_OR_RETURN(uintptr_t ptr, backend->allocate(size, 4096, {}));
+  bytesReserved += size;
+  ALLOC_DBGF("[PinnedMemoryAllocator] reserved %lu bytes at 0x%lx", size, ptr);
+  return ptr;
+}
+
+Status PinnedMemoryAllocator::Impl::releaseChunk(uintptr_t base) {
+  auto it = chunks.find(base);
+  assert(it != chunks.end() && "expected a chunk");
+  uint64_t size = it->second.size;
+  if (!it->second.dedicated)
+    freeLists[maxOrder].erase(base);
+  chunks.erase(it);
+  bytesReserved -= size;
+  ALLOC_DBGF("[PinnedMemoryAllocator] releasing %lu bytes at 0x%lx", size,
+             base);
+  return backend->deallocate(base, {});
+}
+
+Status PinnedMemoryAllocator::Impl::releaseFreeChunks(unsigned numToKeep) {
+  while (freeLists[maxOrder].size() > numToKeep)
+    MTRT_RETURN_IF_ERROR(releaseChunk(*freeLists[maxOrder].rbegin()));
+  return getOkStatus();
 }
 
-struct PinnedMemoryAllocator::BlockTracker {
-  std::set<Block *, BlockComparison> blocks;
-  llvm::DenseMap<uintptr_t, Block *> pointerToBlock;
+std::optional<uintptr_t>
+PinnedMemoryAllocator::Impl::takeCachedDedicatedBlock(uint64_t size) {
+  auto it = cachedDedicatedBlocks.lower_bound(size);
+  if (it == cachedDedicatedBlocks.end() || it->first - size >= size)
+    return {};
+  uintptr_t ptr = it->second;
+  bytesCachedDedicated -= it->first;
+  cachedDedicatedBlocks.erase(it);
+  return ptr;
+}
 
-  ~BlockTracker() {
+Status PinnedMemoryAllocator::Impl::releaseCachedDedicatedBlocks(
+    uint64_t bytesToKeep) {
+  while (bytesCachedDedicated > bytesToKeep) {
+    auto it = std::prev(cachedDedicatedBlocks.end());
+    uintptr_t ptr = it->second;
+    bytesCachedDedicated -= it->first;
+    cachedDedicatedBlocks.erase(it);
+    MTRT_RETURN_IF_ERROR(releaseChunk(ptr));
+  }
+  return getOkStatus();
+}
+
+Status PinnedMemoryAllocator::Impl::releaseBlock(uintptr_t ptr) {
+  auto it = allocatedBlocks.find(ptr);
+  assert(it != allocatedBlocks.end() && "expected an allocated block");
+  AllocatedBlock block = it->second;
+  allocatedBlocks.erase(it);
+  bytesAllocated -= block.size;
+  if (block.dedicated) {
+    cachedDedicatedBlocks.emplace(block.size, ptr);
+    bytesCachedDedicated += block.size;
+    return getOkStatus();
+  }
+
+  const Chunk &chunk = getChunk(ptr);
+  unsigned order = llvm::Log2_64(block.size / options.minBlockSize);
+  while (order < maxOrder) {
+    uintptr_t buddy = chunk.base + ((ptr - chunk.base) ^ getBlockSize(order));
+    auto buddyIt = freeLists[order].find(buddy);
+    if (buddyIt == freeLists[order].end())
+      break;
+    freeLists[order].erase(buddyIt);
+    ptr = std::min(ptr, buddy);
+    ++order;
+  }
+  freeLists[order].insert(ptr);
+  if (order == maxOrder)
+    return releaseFreeChunks(options.maxFreeChunks);
+  return getOkStatus();
+}
 
-    ALLOC_DBGF(
-        "[PinnedMemoryAllocator] Releasing block tracker that has %lu blocks",
-        blocks.size());
-    for (Block *block : blocks) {
-      ALLOC_DBGF("[PinnedMemoryAllocator] releasing block %lu of size %lu",
-                 block->ptr, block->size);
-      cudaFreeHostWrapper(block->ptr);
+Status PinnedMemoryAllocator::Impl::processPendingFrees() {
+  std::deque<std::pair<CudaEvent, uintptr_t>> stillPending;
+  Status result = getOkStatus();
+  while (!pendingFrees.empty()) {
+    auto [event, ptr] = pendingFrees.front();
+    pendingFrees.pop_front();
+    StatusOr<bool> complete = eventSource->isComplete(event);
+    if (!complete.isOk() || !*complete) {
+      if (!complete.isOk())
+        result = complete.getStatus();
+      stillPending.emplace_back(event, ptr);
+      continue;
     }
+    eventSource->release(event);
+    // A block that was freed on several streams is released once all of the
+    // events have completed.
+    auto blockIt = allocatedBlocks.find(ptr);
+    assert(blockIt != allocatedBlocks.end() && "expected an allocated block");
+    if (--blockIt->second.pendingEvents > 0)
+      continue;
+    Status status = releaseBlock(ptr);
+    if (!status.isOk())
+      result = std::move(status);
   }
-};
+  pendingFrees = std::move(stillPending);
+  return result;
+}
+
+PinnedMemoryAllocator::PinnedMemoryAllocator(
+    PinnedMemoryAllocatorOptions options) {
+  StatusOr<std::unique_ptr<AllocatorBackend>> backend =
+      createCudaPinnedHostAllocatorBackend();
+  StatusOr<std::unique_ptr<StreamEventSource>> eventSource =
+      createCudaStreamEventSource();
+  // Without CUDA, the allocator has no backend and all requests fail.
+  if (backend.isOk() && eventSource.isOk())
+    impl = std::make_unique<Impl>(std::move(*backend), std::move(*eventSource),
+                                  std::move(options));
+}
 
-PinnedMemoryAllocator::PinnedMemoryAllocator()
-    : blockTracker(std::make_unique<BlockTracker>()),
-      freeBlocks(std::make_unique<BlockSet>()),
-      pendingBlockEvents(std::make_unique<BlockEventQueue>()) {}
+PinnedMemoryAllocator::PinnedMemoryAllocator(
+    std::unique_ptr<AllocatorBackend> backend,
+    std::unique_ptr<StreamEventSource> eventSource,
+    PinnedMemoryAllocatorOptions options)
+    : impl(std::make_unique<Impl>(std::move(backend), std::move(eventSource),
+                                  std::move(options))) {}
 
 PinnedMemoryAllocator::~PinnedMemoryAllocator() {}
 
 StatusOr<PinnedMemoryBlock> PinnedMemoryAllocator::allocate(size_t size) {
-#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  if (!impl)
+    return getInternalErrorStatus(
+        "MLIR-Executor was not built with CUDA enabled");
   if (size == 0)
     return PinnedMemoryBlock{0, 0};
+  std::lock_guard<std::mutex> lock(impl->mutex);
+
+  // Requests larger than a chunk get a dedicated allocation, preferably one
+  // that was released earlier.
+  if (size > impl->options.chunkSize) {
+    uint64_t blockSize = llvm::alignTo(size, impl->options.minBlockSize);
+    std::optional<uintptr_t> cached =
+        impl->takeCachedDedicatedBlock(blockSize);
+    if (!cached && !impl->pendingFrees.empty()) {
+      MTRT_RETURN_IF_ERROR(impl->processPendingFrees());
+      cached = impl->takeCachedDedicatedBlock(blockSize);
+    }
+    uintptr_t ptr;
+    if (cached) {
+      ptr = *cached;
+      blockSize = impl->chunks.at(ptr).size;
+    } else {
+      MTRT_ASSIGN_OR_RETURN(ptr, impl->reserve(blockSize));
+      impl->chunks.try_emplace(ptr, Chunk{ptr, blockSize, /*dedicated=*/true});
+    }
+    impl->allocatedBlocks.try_emplace(
+        ptr, AllocatedBlock{blockSize, /*dedicated=*/true});
+    impl->bytesAllocated += blockSize;
+    ALLOC_DBGF("[PinnedMemoryAllocator] allocated dedicated block 0x%lx of "
+               "size %lu",
+               ptr, blockSize);
+    return PinnedMemoryBlock{ptr, blockSize};
+  }
 
-  Status processEventsResult =
-      pendingBlockEvents->checkForFreeBlocks(freeBlocks);
-  if (!processEventsResult.isOk())
-    return processEventsResult.getStatus();
-
-  // Return the smallest size block that meets the specified size.
-  auto lowerBound = freeBlocks->set.lower_bound(Block{size, 0, 0});
-  if (lowerBound != freeBlocks->set.end()) {
-    Block *result = *lowerBound;
-    freeBlocks->set.erase(result);
-    ALLOC_DBGF("re-using block %lu of size %lu", result->ptr, result->size);
-    return PinnedMemoryBlock{result->ptr, result->size};
+  uint64_t blockSize =
+      llvm::PowerOf2Ceil(std::max<uint64_t>(size, impl->options.minBlockSize));
+  unsigned order = llvm::Log2_64(blockSize / impl->options.minBlockSize);
+  std::optional<uintptr_t> ptr = impl->takeFreeBlock(order);
+  // Only poll the pending frees if the free blocks cannot serve the request.
+  if (!ptr && !impl->pendingFrees.empty()) {
+    MTRT_RETURN_IF_ERROR(impl->processPendingFrees());
+    ptr = impl->takeFreeBlock(order);
+  }
+  if (!ptr) {
+    MTRT_ASSIGN_OR_RETURN(uintptr_t base,
+                          impl->reserve(impl->options.chunkSize));
+    impl->chunks.try_emplace(
+        base, Chunk{base, impl->options.chunkSize, /*dedicated=*/false});
+    impl->freeLists[impl->maxOrder].insert(base);
+    ptr = impl->takeFreeBlock(order);
+    assert(ptr && "expected a free block in the new chunk");
   }
 
-  // Allocate the block and insert it into the list of tracked blocks. Round up
-  // to the nearest power of two since we want to create a nice distribution of
-  // block-sizes for reuse.
-  size_t allocatedSize = llvm::PowerOf2Ceil(size);
-  void *allocatedPtr{nullptr};
-  RETURN_ERROR_IF_CUDART_ERROR(
-      cudaHostAlloc(&allocatedPtr, allocatedSize, cudaHostAllocDefault));
-  Block *result =
-      new Block{allocatedSize, reinterpret_cast<uintptr_t>(allocatedPtr), 0};
-  ALLOC_DBGF("allocated new block %lu of size %lu (rounded up from %lu)",
-             result->ptr, result->size, size);
-  blockTracker->blocks.insert(result);
-  blockTracker->pointerToBlock.insert({result->ptr, result});
-  return PinnedMemoryBlock{result->ptr, result->size};
-#else
-  return getInternalErrorStatus(
-      "MLIR-Executor was not built with CUDA enabled");
-#endif
+  impl->allocatedBlocks.try_emplace(*ptr, AllocatedBlock{blockSize, false});
+  impl->bytesAllocated += blockSize;
+  ALLOC_DBGF("[PinnedMemoryAllocator] allocated block 0x%lx of size %lu "
+             "(rounded up from %lu)",
+             *ptr, blockSize, size);
+  return PinnedMemoryBlock{*ptr, blockSize};
 }
 
-// Free the given block.
 Status PinnedMemoryAllocator::freeAsync(uintptr_t ptr, CudaStream stream) {
-#ifdef MLIR_EXECUTOR_ENABLE_CUDA
   if (ptr == 0)
     return getOkStatus();
+  if (!impl)
+    return getInternalErrorStatus(
+        "MLIR-Executor was not built with CUDA enabled");
+  std::lock_guard<std::mutex> lock(impl->mutex);
+  auto it = impl->allocatedBlocks.find(ptr);
+  if (it == impl->allocatedBlocks.end())
+    return getInvalidArgStatus(
+        "pointer 0x{0:x} was not allocated by the pinned memory allocator",
+        ptr);
+
+  // The block won't be released until the work enqueued on the stream has
+  // completed.
+  MTRT_ASSIGN_OR_RETURN(CudaEvent event, impl->eventSource->record(stream));
+  ALLOC_DBGF("[PinnedMemoryAllocator] enqueuing asynchronous free of block "
+             "0x%lx on stream 0x%lx using event 0x%lx",
+             ptr, stream, event);
+  it->second.pendingEvents++;
+  impl->pendingFrees.emplace_back(event, ptr);
+  return getOkStatus();
+}
+
+Status PinnedMemoryAllocator::trim() {
+  if (!impl)
+    return getOkStatus();
+  std::lock_guard<std::mutex> lock(impl->mutex);
+  MTRT_RETURN_IF_ERROR(impl->processPendingFrees());
+  MTRT_RETURN_IF_ERROR(impl->releaseCachedDedicatedBlocks(0));
+  return impl->releaseFreeChunks(0);
+}
+
+PinnedMemoryAllocatorStats PinnedMemoryAllocator::getStats() const {
+  if (!impl)
+    return {};
+  std::lock_guard<std::mutex> lock(impl->mutex);
+  PinnedMemoryAllocatorStats stats;
+  stats.bytesReserved = impl->bytesReserved;
+  stats.bytesAllocated = impl->bytesAllocated;
+  stats.numChunks = impl->chunks.size();
+  stats.numPendingFrees = impl->pendingFrees.size();
+  stats.bytesCachedDedicated = impl->bytesCachedDedicated;
+  return stats;
+}
+
+//===----------------------------------------------------------------------===//
+// CachingAllocator
+//===----------------------------------------------------------------------===//
+
+/// Key used for free lists of blocks that were freed synchronously.
+static constexpr uint64_t kSynchronousStreamKey =
+    std::numeric_limits<uint64_t>::max();
+
+static uint64_t getStreamKey(std::optional<CudaStream> stream) {
+  return stream ? static_cast<uint64_t>(*stream) : kSynchronousStreamKey;
+}
+
+namespace {
+/// A live allocation of a `CachingAllocator`.
+struct LiveBlock {
+  /// The byte size of the block.
+  uint64_t size;
+  /// The number of bytes requested by the allocation.
+  uint64_t requestedSize;
+  /// The alignment the block was allocated with.
+  uint32_t alignment;
+  /// Whether the block returns to the cache when deallocated.
+  bool cacheable;
+};
 
-  Block *block = blockTracker->pointerToBlock.lookup(ptr);
-  assert(block && "expected valid block");
-  // If this block is associated with a stream, then we create an event to track
-  // the dependency. It won't be released until the dependency is met.
-  StatusOr<std::unique_ptr<PoolTrackedCudaEvent>> event =
-      eventPool.getCudaEvent();
-  RETURN_ERROR_IF_CUDART_ERROR(
-      cudaEventRecord(reinterpret_cast<cudaEvent_t>((*event)->getEvent()),
-                      reinterpret_cast<cudaStream_t>(stream)));
-  block->pendingEvents++;
-  // Add the event and block to processing list.
-  ALLOC_DBGF("enqueing asynchronously free of block %lu on stream %lu using "
-             "stream %lu",
-             block->ptr, reinterpret_cast<uintptr_t>(stream),
-             reinterpret_cast<uintptr_t>((*event)->getEvent()));
-  pendingBlockEvents->eventQueue.emplace_front(std::move(*event), block);
+/// A block held in the cache.
+struct FreeBlock {
+  uintptr_t ptr;
+  uint32_t alignment;
+  /// The number of backend synchronizations before the block was freed.
+  uint64_t syncEpoch;
+};
+} // namespace
+
+struct CachingAllocator::Impl {
+  /// All live allocations.
+  llvm::DenseMap<uintptr_t, LiveBlock> liveBlocks;
+  /// Free blocks keyed by (stream key, size class).
+  llvm::DenseMap<std::pair<uint64_t, uint64_t>, llvm::SmallVector<FreeBlock>>
+      freeBlocks;
+
+  /// Pop a free block of class `size` cached for `streamKey` that is aligned
+  /// to `alignment`.
+  std::optional<FreeBlock> pop(uint64_t streamKey, uint64_t size,
+                               uint32_t alignment) {
+    auto it = freeBlocks.find({streamKey, size});
+    if (it == freeBlocks.end())
+      return {};
+    llvm::SmallVector<FreeBlock> &blocks = it->second;
+    for (auto blockIt = blocks.rbegin(); blockIt != blocks.rend(); ++blockIt) {
+      if (!llvm::isAligned(llvm::Align(alignment), blockIt->ptr))
+        continue;
+      FreeBlock block = *blockIt;
+      blocks.erase(std::next(blockIt).base());
+      return block;
+    }
+    return {};
+  }
+};
+
+CachingAllocator::CachingAllocator(std::unique_ptr<AllocatorBackend> backend,
+                                   CachingAllocatorOptions options)
+    : backend(std::move(backend)), options(std::move(options)),
+      impl(std::make_unique<Impl>()),
+      lastUse(std::chrono::steady_clock::now()) {
+  assert(this->options.minBlockSize > 0 &&
+         llvm::isPowerOf2_64(this->options.minBlockSize) &&
+         "expected the minimum block size to be a power of two");
+  assert(this->options.classesPerPowerOfTwo > 0 &&
+         "expected at least one size class per power of two");
+}
+
+CachingAllocator::~CachingAllocator() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!impl->liveBlocks.empty())
+    ALLOC_DBGF("[CachingAllocator] destroyed with %u live allocations",
+               impl->liveBlocks.size());
+  Status status = trimLocked();
+  if (!status.isOk())
+    ALLOC_DBGF("[CachingAllocator] error while releasing cached blocks: %s",
+               status.getString().c_str());
+}
+
+uint64_t CachingAllocator::getSizeClass(uint64_t size) const {
+  if (size <= options.minBlockSize)
+    return options.minBlockSize;
+  uint64_t step = std::max<uint64_t>(
+      llvm::bit_floor(size) / options.classesPerPowerOfTwo,
+      options.minBlockSize);
+  return llvm::alignTo(size, step);
+}
+
+StatusOr<uintptr_t>
+CachingAllocator::allocate(uint64_t size, uint32_t alignment,
+                           std::optional<CudaStream> stream) {
+  std::lock_guard<std::mutex> lock(mutex);
+  MTRT_RETURN_IF_ERROR(trimIfIdle());
+  stats.numAllocations++;
+
+  bool cacheable = size <= options.maxBlockSize;
+  uint64_t blockSize = cacheable ? getSizeClass(size) : size;
+  blockSize = llvm::alignTo(std::max<uint64_t>(blockSize, 1), alignment);
+
+  std::optional<FreeBlock> block;
+  if (cacheable) {
+    bool isSynchronousBlock = !stream;
+    block = impl->pop(getStreamKey(stream), blockSize, alignment);
+    // Blocks that were freed synchronously can be used on any stream.
+    if (!block && stream) {
+      block = impl->pop(kSynchronousStreamKey, blockSize, alignment);
+      isSynchronousBlock = true;
+    }
+    // A block freed without a stream may still be used by work on any stream.
+    // Deallocating it through the backend would have waited for that work, so
+    // synchronize before the first reuse of a block freed since the last
+    // synchronization.
+    if (block && isSynchronousBlock &&
+        block->syncEpoch == stats.numSynchronizations) {
+      Status status = backend->synchronize();
+      if (!status.isOk()) {
+        impl->freeBlocks[{kSynchronousStreamKey, blockSize}].push_back(*block);
+        return status;
+      }
+      stats.numSynchronizations++;
+    }
+  }
+
+  uintptr_t ptr;
+  if (block) {
+    ptr = block->ptr;
+    alignment = block->alignment;
+    stats.numCacheHits++;
+    stats.bytesCached -= blockSize;
+    ALLOC_DBGF("[CachingAllocator] re-using block 0x%lx of size %lu", ptr,
+               blockSize);
+  } else {
+    StatusOr<uintptr_t> result =
+        backend->allocate(blockSize, alignment, stream);
+    if (!result.isOk() && stats.bytesCached > 0) {
+      // Allocation failures may be caused by memory held in the cache, so
+      // release the cache and retry once.
+      MTRT_RETURN_IF_ERROR(trimLocked());
+      MTRT_ASSIGN_OR_RETURN(ptr,
+                            backend->allocate(blockSize, alignment, stream));
+    } else {
+      MTRT_ASSIGN_OR_RETURN(ptr, std::move(result));
+    }
+    stats.numBackendAllocations++;
+    ALLOC_DBGF("[CachingAllocator] allocated block 0x%lx of size %lu", ptr,
+               blockSize);
+  }
+
+  impl->liveBlocks.try_emplace(
+      ptr, LiveBlock{blockSize, size, alignment, cacheable});
+  stats.bytesRequested += size;
+  stats.bytesInUse += blockSize;
+  stats.peakBytesReserved = std::max(stats.peakBytesReserved,
+                                     stats.bytesInUse + stats.bytesCached);
+  return ptr;
+}
+
+Status CachingAllocator::deallocate(uintptr_t ptr,
+                                    std::optional<CudaStream> stream) {
+  std::lock_guard<std::mutex> lock(mutex);
+  MTRT_RETURN_IF_ERROR(trimIfIdle());
+
+  auto it = impl->liveBlocks.find(ptr);
+  if (it == impl->liveBlocks.end())
+    return getInvalidArgStatus(
+        "pointer 0x{0:x} was not allocated by the caching allocator", ptr);
+  LiveBlock block = it->second;
+  impl->liveBlocks.erase(it);
+  stats.bytesRequested -= block.requestedSize;
+  stats.bytesInUse -= block.size;
+
+  if (!block.cacheable ||
+      stats.bytesCached + block.size > options.maxCachedBytes) {
+    ALLOC_DBGF("[CachingAllocator] releasing block 0x%lx of size %lu", ptr,
+               block.size);
+    return backend->deallocate(ptr, stream);
+  }
+
+  impl->freeBlocks[{getStreamKey(stream), block.size}].push_back(
+      FreeBlock{ptr, block.alignment, stats.numSynchronizations});
+  stats.bytesCached += block.size;
   return getOkStatus();
-#else
-  return getInternalErrorStatus(
-      "MLIR-Executor was not built with CUDA enabled");
-#endif
-}
\ No newline at end of file
+}
+
+bool CachingAllocator::owns(uintptr_t ptr) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return impl->liveBlocks.contains(ptr);
+}
+
+Status CachingAllocator::trim() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return trimLocked();
+}
+
+Status CachingAllocator::trimIfIdle() {
+  auto now = std::chrono::steady_clock::now();
+  bool idle =
+      options.idleTrimTimeout && now - lastUse >= *options.idleTrimTimeout;
+  lastUse = now;
+  if (!idle || stats.bytesCached == 0)
+    return getOkStatus();
+  ALLOC_DBGF("[CachingAllocator] releasing %lu cached bytes after idling",
+             stats.bytesCached);
+  return trimLocked();
+}
+
+Status CachingAllocator::trimLocked() {
+  Status result = getOkStatus();
+  for (auto &[key, blocks] : impl->freeBlocks) {
+    uint64_t size = key.second;
+    // The streams that blocks were freed on may have been destroyed, so
+    // blocks are released synchronously, which also waits for pending work.
+    for (const FreeBlock &block : blocks) {
+      Status status = backend->deallocate(block.ptr, std::nullopt);
+      if (!status.isOk())
+        result = std::move(status);
+      stats.bytesCached -= size;
+    }
+  }
+  impl->freeBlocks.clear();
+  return result;
+}
+
+CachingAllocatorStats CachingAllocator::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
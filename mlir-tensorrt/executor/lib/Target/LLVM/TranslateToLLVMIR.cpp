@@ -0,0 +1,951 @@
+//===- TranslateToLLVMIR.cpp ----------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the translation of Executor IR to LLVM IR.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Target/LLVM/TranslateToLLVMIR.h"
+#include "mlir-executor/Executor/IR/Executor.h"
+#include "mlir-executor/Runtime/Backend/Native/NativeABI.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/DLTI/DLTI.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/Tools/mlir-translate/Translation.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+
+using namespace mlir;
+namespace native = mlirtrt::runtime::native;
+
+namespace {
+/// Helper class for emitting LLVM IR for a module of Executor IR. Functions
+/// defined in the module use the LLVM types of their Executor types directly:
+/// integers and floats map to the LLVM scalar types, pointers, string literals
+/// and opaque objects map to `ptr`, and tables map to literal structs.
+/// External functions (the runtime builtins) use the C ABI, which only differs
+/// in that `i1` is passed as `i8`.
+class LLVMEmitter {
+public:
+  explicit LLVMEmitter(llvm::Module &module)
+      : module(module), ctx(module.getContext()), builder(ctx) {}
+
+  /// Emit LLVM IR for a "module-like" operation.
+  LogicalResult emitModule(Operation &op);
+
+private:
+  FailureOr<llvm::Type *> convertType(Location loc, Type type);
+
+  /// Convert `type` for use in the signature of an external function.
+  FailureOr<llvm::Type *> convertExternalType(Location loc, Type type);
+
+  /// Declare the LLVM function for a `func.func` or `executor.func`.
+  LogicalResult declareFunction(Operation *op, StringRef name,
+                                TypeRange argTypes, TypeRange resultTypes,
+                                bool isVarArg, bool isExternal,
+                                bool isPrivate);
+
+  LogicalResult declareGlobal(executor::GlobalOp op);
+
+  LogicalResult emitFunction(func::FuncOp func);
+
+  /// Emit the interface function of `func` (see `NativeABI.h`).
+  void emitInterfaceFunction(func::FuncOp func);
+
+  LogicalResult emitOperation(Operation &op);
+
+  LogicalResult emitCall(Operation *op, StringRef calleeName,
+                         ValueRange operands);
+  LogicalResult emitPrint(executor::PrintOp op);
+  void emitAssert(executor::AssertOp op);
+
+  /// Emit a call to the assertion failure handler with `msg` that is executed
+  /// if `cond` is false. Code emitted afterwards runs only if `cond` is true.
+  void emitCheck(llvm::Value *cond, StringRef msg);
+
+  /// Emit the LLVM binary operation `opcode`. Signed division and remainder
+  /// check that the divisor is valid and shift amounts are clamped to the bit
+  /// width, since LLVM leaves these cases undefined.
+  llvm::Value *emitBinaryOp(llvm::Instruction::BinaryOps opcode,
+                            llvm::Value *lhs, llvm::Value *rhs);
+
+  /// Check that `lhs` can be divided by `rhs` without dividing by zero or
+  /// overflowing.
+  void emitSignedDivisionCheck(llvm::Value *lhs, llvm::Value *rhs);
+  void addBranchOperands(Block *dest, ValueRange operands);
+
+  /// Load a value of `type` from consecutive slots of `slots`, starting at
+  /// `slot`, and advance `slot` past the slots that were read.
+  llvm::Value *loadFromSlots(llvm::Type *type, llvm::Value *slots,
+                             unsigned &slot);
+
+  /// Store `value` to consecutive slots of `slots`, starting at `slot`, and
+  /// advance `slot` past the slots that were written.
+  void storeToSlots(llvm::Value *value, llvm::Value *slots, unsigned &slot);
+
+  llvm::Value *lookup(Value value) const {
+    llvm::Value *result = valueMapping.lookup(value);
+    assert(result && "value is not mapped");
+    return result;
+  }
+
+  void setResult(Operation *op, llvm::Value *value) {
+    valueMapping[op->getResult(0)] = value;
+  }
+
+  llvm::Module &module;
+  llvm::LLVMContext &ctx;
+  llvm::IRBuilder<> builder;
+
+  /// Map from MLIR values to their LLVM values within the current function.
+  DenseMap<Value, llvm::Value *> valueMapping;
+
+  /// Map from MLIR blocks to their LLVM blocks within the current function.
+  DenseMap<Block *, llvm::BasicBlock *> blockMapping;
+
+  /// The name of the function that initializes the globals, if any. It is
+  /// private in the IR but must be visible to the runtime.
+  StringRef initGlobalsFuncName;
+};
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// Types
+//===----------------------------------------------------------------------===//
+
+FailureOr<llvm::Type *> LLVMEmitter::convertType(Location loc, Type type) {
+  if (auto intType = dyn_cast<IntegerType>(type))
+    return builder.getIntNTy(intType.getWidth());
+  if (type.isF64())
+    return builder.getDoubleTy();
+  if (type.isF32())
+    return builder.getFloatTy();
+  if (type.isF16())
+    return builder.getHalfTy();
+  if (type.isBF16())
+    return builder.getBFloatTy();
+  if (isa<executor::PointerType, executor::StrLiteralType,
+          executor::ExecutorOpaqueType>(type))
+    return builder.getPtrTy();
+  if (auto tableType = dyn_cast<executor::TableType>(type)) {
+    SmallVector<llvm::Type *> elementTypes;
+    for (Type elementType : tableType.getBody()) {
+      FailureOr<llvm::Type *> converted = convertType(loc, elementType);
+      if (failed(converted))
+        return failure();
+      elementTypes.push_back(*converted);
+    }
+    return llvm::StructType::get(ctx, elementTypes);
+  }
+  return emitError(loc) << "type " << type
+                        << " is not supported by the native backend";
+}
+
+FailureOr<llvm::Type *> LLVMEmitter::convertExternalType(Location loc,
+                                                         Type type) {
+  if (isa<executor::TableType>(type))
+    return emitError(loc) << "passing tables to external functions is not "
+                             "supported by the native backend";
+  if (type.isInteger(1))
+    return builder.getInt8Ty();
+  return convertType(loc, type);
+}
+
+//===----------------------------------------------------------------------===//
+// Module-level declarations
+//===----------------------------------------------------------------------===//
+
+LogicalResult LLVMEmitter::declareFunction(Operation *op, StringRef name,
+                                           TypeRange argTypes,
+                                           TypeRange resultTypes,
+                                           bool isVarArg, bool isExternal,
+                                           bool isPrivate) {
+  auto convert = [&](Type type) {
+    return isExternal ? convertExternalType(op->getLoc(), type)
+                      : convertType(op->getLoc(), type);
+  };
+
+  SmallVector<llvm::Type *> llvmArgTypes;
+  for (Type type : argTypes) {
+    FailureOr<llvm::Type *> converted = convert(type);
+    if (failed(converted))
+      return failure();
+    llvmArgTypes.push_back(*converted);
+  }
+
+  llvm::Type *resultType = builder.getVoidTy();
+  if (resultTypes.size() == 1) {
+    FailureOr<llvm::Type *> converted = convert(resultTypes.front());
+    if (failed(converted))
+      return failure();
+    resultType = *converted;
+  } else if (resultTypes.size() > 1) {
+    if (isExternal)
+      return op->emitOpError("external functions with multiple results are "
+                             "not supported by the native backend");
+    SmallVector<llvm::Type *> llvmResultTypes;
+    for (Type type : resultTypes) {
+      FailureOr<llvm::Type *> converted = convert(type);
+      if (failed(converted))
+        return failure();
+      llvmResultTypes.push_back(*converted);
+    }
+    resultType = llvm::StructType::get(ctx, llvmResultTypes);
+  }
+
+  llvm::Function::Create(
+      llvm::FunctionType::get(resultType, llvmArgTypes, isVarArg),
+      isPrivate && !isExternal ? llvm::GlobalValue::InternalLinkage
+                               : llvm::GlobalValue::ExternalLinkage,
+      name, module);
+  return success();
+}
+
+/// Return the LLVM constant for a scalar attribute, or nullptr if `attr` is
+/// not an integer or float attribute.
+static llvm::Constant *getScalarConstant(llvm::Type *type, Attribute attr) {
+  if (auto intAttr = dyn_cast<IntegerAttr>(attr))
+    return llvm::ConstantInt::get(type, intAttr.getValue());
+  if (auto floatAttr = dyn_cast<FloatAttr>(attr))
+    return llvm::ConstantFP::get(type, floatAttr.getValue());
+  return nullptr;
+}
+
+LogicalResult LLVMEmitter::declareGlobal(executor::GlobalOp op) {
+  FailureOr<llvm::Type *> type = convertType(op.getLoc(), op.getType());
+  if (failed(type))
+    return failure();
+  llvm::Constant *init = llvm::Constant::getNullValue(*type);
+  if (TypedAttr initialValue = op.getInitialValueAttr()) {
+    init = getScalarConstant(*type, initialValue);
+    if (!init)
+      return op.emitOpError("only scalar initial values are supported by the "
+                            "native backend");
+  }
+  // Globals are visible to the runtime so that it can access them by name,
+  // e.g. to set the session's stream.
+  new llvm::GlobalVariable(module, *type, /*isConstant=*/false,
+                           llvm::GlobalValue::ExternalLinkage, init,
+                           op.getSymName());
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Functions
+//===----------------------------------------------------------------------===//
+
+LogicalResult LLVMEmitter::emitFunction(func::FuncOp func) {
+  llvm::Function *fn = module.getFunction(func.getName());
+  Region &body = func.getBody();
+  valueMapping.clear();
+  blockMapping.clear();
+
+  // Blocks are emitted in an order in which each block is preceded by its
+  // dominators, so that the definitions of all values used in a block have
+  // been emitted. Block arguments become PHI nodes that are created up front.
+  SmallVector<Block *> blocks;
+  if (body.hasOneBlock()) {
+    blocks.push_back(&body.front());
+  } else {
+    DominanceInfo domInfo(func);
+    for (auto *node : llvm::depth_first(domInfo.getRootNode(&body)))
+      blocks.push_back(node->getBlock());
+  }
+
+  for (Block *block : blocks) {
+    llvm::BasicBlock *llvmBlock = llvm::BasicBlock::Create(ctx, "", fn);
+    blockMapping[block] = llvmBlock;
+    if (block->isEntryBlock()) {
+      for (auto [arg, llvmArg] : llvm::zip(block->getArguments(), fn->args()))
+        valueMapping[arg] = &llvmArg;
+      continue;
+    }
+    builder.SetInsertPoint(llvmBlock);
+    for (BlockArgument arg : block->getArguments()) {
+      FailureOr<llvm::Type *> type = convertType(arg.getLoc(), arg.getType());
+      if (failed(type))
+        return failure();
+      valueMapping[arg] =
+          builder.CreatePHI(*type, block->getNumPredecessors());
+    }
+  }
+
+  for (Block *block : blocks) {
+    builder.SetInsertPoint(blockMapping[block]);
+    for (Operation &op : *block) {
+      if (failed(emitOperation(op)))
+        return failure();
+    }
+  }
+  return success();
+}
+
+llvm::Value *LLVMEmitter::loadFromSlots(llvm::Type *type, llvm::Value *slots,
+                                        unsigned &slot) {
+  if (auto *structType = dyn_cast<llvm::StructType>(type)) {
+    llvm::Value *result = llvm::PoisonValue::get(structType);
+    for (auto [idx, elementType] : llvm::enumerate(structType->elements()))
+      result = builder.CreateInsertValue(
+          result, loadFromSlots(elementType, slots, slot), idx);
+    return result;
+  }
+  llvm::Value *ptr =
+      builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(), slots, slot++);
+  return builder.CreateLoad(type, ptr);
+}
+
+void LLVMEmitter::storeToSlots(llvm::Value *value, llvm::Value *slots,
+                               unsigned &slot) {
+  if (auto *structType = dyn_cast<llvm::StructType>(value->getType())) {
+    for (unsigned i = 0, e = structType->getNumElements(); i < e; ++i)
+      storeToSlots(builder.CreateExtractValue(value, i), slots, slot);
+    return;
+  }
+  llvm::Value *ptr =
+      builder.CreateConstInBoundsGEP1_64(builder.getInt64Ty(), slots, slot++);
+  builder.CreateStore(value, ptr);
+}
+
+void LLVMEmitter::emitInterfaceFunction(func::FuncOp func) {
+  llvm::Function *fn = module.getFunction(func.getName());
+  auto *ifaceType = llvm::FunctionType::get(
+      builder.getVoidTy(), {builder.getPtrTy(), builder.getPtrTy()},
+      /*isVarArg=*/false);
+  StringRef prefix(native::kInterfaceFuncPrefix.data(),
+                   native::kInterfaceFuncPrefix.size());
+  llvm::Function *iface =
+      llvm::Function::Create(ifaceType, llvm::GlobalValue::ExternalLinkage,
+                             prefix + func.getName(), module);
+  builder.SetInsertPoint(llvm::BasicBlock::Create(ctx, "", iface));
+
+  unsigned slot = 0;
+  SmallVector<llvm::Value *> args;
+  for (llvm::Type *argType : fn->getFunctionType()->params())
+    args.push_back(loadFromSlots(argType, iface->getArg(0), slot));
+  llvm::CallInst *call = builder.CreateCall(fn, args);
+  slot = 0;
+  if (!call->getType()->isVoidTy())
+    storeToSlots(call, iface->getArg(1), slot);
+  builder.CreateRetVoid();
+}
+
+//===----------------------------------------------------------------------===//
+// Operations
+//===----------------------------------------------------------------------===//
+
+static llvm::CmpInst::Predicate getPredicate(executor::ICmpType type) {
+  switch (type) {
+  case executor::ICmpType::eq:
+    return llvm::CmpInst::ICMP_EQ;
+  case executor::ICmpType::ne:
+    return llvm::CmpInst::ICMP_NE;
+  case executor::ICmpType::slt:
+    return llvm::CmpInst::ICMP_SLT;
+  case executor::ICmpType::sgt:
+    return llvm::CmpInst::ICMP_SGT;
+  case executor::ICmpType::sle:
+    return llvm::CmpInst::ICMP_SLE;
+  case executor::ICmpType::sge:
+    return llvm::CmpInst::ICMP_SGE;
+  case executor::ICmpType::ult:
+    return llvm::CmpInst::ICMP_ULT;
+  case executor::ICmpType::ugt:
+    return llvm::CmpInst::ICMP_UGT;
+  }
+  llvm_unreachable("unknown ICmpType");
+}
+
+static llvm::CmpInst::Predicate getPredicate(executor::FCmpType type) {
+  switch (type) {
+  case executor::FCmpType::_false:
+    return llvm::CmpInst::FCMP_FALSE;
+  case executor::FCmpType::oeq:
+    return llvm::CmpInst::FCMP_OEQ;
+  case executor::FCmpType::ogt:
+    return llvm::CmpInst::FCMP_OGT;
+  case executor::FCmpType::oge:
+    return llvm::CmpInst::FCMP_OGE;
+  case executor::FCmpType::olt:
+    return llvm::CmpInst::FCMP_OLT;
+  case executor::FCmpType::ole:
+    return llvm::CmpInst::FCMP_OLE;
+  case executor::FCmpType::one:
+    return llvm::CmpInst::FCMP_ONE;
+  case executor::FCmpType::ord:
+    return llvm::CmpInst::FCMP_ORD;
+  case executor::FCmpType::ueq:
+    return llvm::CmpInst::FCMP_UEQ;
+  case executor::FCmpType::ugt:
+    return llvm::CmpInst::FCMP_UGT;
+  case executor::FCmpType::uge:
+    return llvm::CmpInst::FCMP_UGE;
+  case executor::FCmpType::ult:
+    return llvm::CmpInst::FCMP_ULT;
+  case executor::FCmpType::ule:
+    return llvm::CmpInst::FCMP_ULE;
+  case executor::FCmpType::une:
+    return llvm::CmpInst::FCMP_UNE;
+  case executor::FCmpType::uno:
+    return llvm::CmpInst::FCMP_UNO;
+  case executor::FCmpType::_true:
+    return llvm::CmpInst::FCMP_TRUE;
+  }
+  llvm_unreachable("unknown FCmpType");
+}
+
+/// Return the binary opcode that implements `op`, if `op` maps to an LLVM
+/// binary operation (see `LLVMEmitter::emitBinaryOp`).
+static std::optional<llvm::Instruction::BinaryOps>
+getBinaryOpcode(Operation *op) {
+  using BinaryOps = llvm::Instruction::BinaryOps;
+  return llvm::TypeSwitch<Operation *, std::optional<BinaryOps>>(op)
+      .Case([](executor::AddIOp) { return BinaryOps::Add; })
+      .Case([](executor::SubIOp) { return BinaryOps::Sub; })
+      .Case([](executor::MulIOp) { return BinaryOps::Mul; })
+      .Case([](executor::SDivIOp) { return BinaryOps::SDiv; })
+      // `executor.sremi` has the semantic of `APInt::srem` (see its folder).
+      .Case([](executor::SRemIOp) { return BinaryOps::SRem; })
+      .Case([](executor::ShiftLeftIOp) { return BinaryOps::Shl; })
+      .Case([](executor::ShiftRightArithmeticIOp) { return BinaryOps::AShr; })
+      .Case([](executor::ShiftRightLogicalIOp) { return BinaryOps::LShr; })
+      .Case([](executor::BitwiseAndIOp) { return BinaryOps::And; })
+      .Case([](executor::BitwiseOrIOp) { return BinaryOps::Or; })
+      .Case([](executor::BitwiseXOrIOp) { return BinaryOps::Xor; })
+      .Case([](executor::AddFOp) { return BinaryOps::FAdd; })
+      .Case([](executor::SubFOp) { return BinaryOps::FSub; })
+      .Case([](executor::MulFOp) { return BinaryOps::FMul; })
+      .Case([](executor::DivFOp) { return BinaryOps::FDiv; })
+      .Default([](Operation *) { return std::nullopt; });
+}
+
+/// Promote a variadic argument the way C does for calls to variadic
+/// functions. Integers narrower than 64 bits are additionally extended to
+/// i64, which is how the runtime builtins read them.
+static llvm::Value *promoteVarArg(llvm::IRBuilder<> &builder,
+                                  llvm::Value *value) {
+  llvm::Type *type = value->getType();
+  if (type->isIntegerTy(1))
+    return builder.CreateZExt(value, builder.getInt64Ty());
+  if (type->isIntegerTy() && type->getIntegerBitWidth() < 64)
+    return builder.CreateSExt(value, builder.getInt64Ty());
+  if (type->isFloatingPointTy() && !type->isDoubleTy())
+    return builder.CreateFPExt(value, builder.getDoubleTy());
+  return value;
+}
+
+LogicalResult LLVMEmitter::emitCall(Operation *op, StringRef calleeName,
+                                    ValueRange operands) {
+  llvm::Function *callee = module.getFunction(calleeName);
+  if (!callee)
+    return op->emitOpError() << "callee @" << calleeName
+                             << " is not declared in the module";
+  llvm::FunctionType *fnType = callee->getFunctionType();
+  bool isExternal = callee->isDeclaration();
+
+  SmallVector<llvm::Value *> args;
+  for (auto [idx, operand] : llvm::enumerate(operands)) {
+    llvm::Value *arg = lookup(operand);
+    if (idx >= fnType->getNumParams())
+      arg = promoteVarArg(builder, arg);
+    else if (arg->getType() != fnType->getParamType(idx))
+      arg = builder.CreateZExt(arg, fnType->getParamType(idx));
+    args.push_back(arg);
+  }
+
+  llvm::CallInst *call = builder.CreateCall(callee, args);
+  if (op->getNumResults() == 1) {
+    llvm::Value *result = call;
+    if (isExternal && op->getResult(0).getType().isInteger(1))
+      result = builder.CreateTrunc(result, builder.getInt1Ty());
+    setResult(op, result);
+    return success();
+  }
+  for (OpResult result : op->getResults())
+    valueMapping[result] =
+        builder.CreateExtractValue(call, result.getResultNumber());
+  return success();
+}
+
+/// Rewrite the `string.format` style `format` of an `executor.print` for C
+/// `printf`. Integer arguments are passed as i64, so the integer conversions
+/// get the `ll` length modifier. Float arguments are passed as double, which
+/// the float conversions expect.
+static FailureOr<std::string> convertPrintFormat(executor::PrintOp op,
+                                                 StringRef format) {
+  std::string result;
+  for (size_t i = 0, e = format.size(); i < e; ++i) {
+    result.push_back(format[i]);
+    if (format[i] != '%')
+      continue;
+    if (i + 1 < e && format[i + 1] == '%') {
+      result.push_back(format[++i]);
+      continue;
+    }
+    // Copy the flags, width and precision.
+    while (++i < e && StringRef("-+ #0123456789.").contains(format[i]))
+      result.push_back(format[i]);
+    if (i == e)
+      return op.emitOpError() << "invalid format string \"" << format << "\"";
+    if (StringRef("diouxX").contains(format[i]))
+      result += "ll";
+    result.push_back(format[i]);
+  }
+  return result;
+}
+
+LogicalResult LLVMEmitter::emitPrint(executor::PrintOp op) {
+  std::string format;
+  if (std::optional<StringRef> opFormat = op.getFormat()) {
+    FailureOr<std::string> converted = convertPrintFormat(op, *opFormat);
+    if (failed(converted))
+      return failure();
+    format = std::move(*converted);
+  } else {
+    // Without a format, the values are separated by tabs, like Lua `print`.
+    llvm::raw_string_ostream os(format);
+    llvm::interleave(
+        op.getArguments(), os,
+        [&](Value v) {
+          if (isa<executor::StrLiteralType>(v.getType()))
+            os << "%s";
+          else if (isa<FloatType>(v.getType()))
+            os << "%.14g";
+          else
+            os << "%lld";
+        },
+        "\t");
+  }
+  format += "\n";
+
+  SmallVector<llvm::Value *> args = {builder.CreateGlobalString(format)};
+  for (Value v : op.getArguments()) {
+    llvm::Value *arg = lookup(v);
+    if (isa<executor::PointerType>(v.getType()))
+      arg = builder.CreatePtrToInt(arg, builder.getInt64Ty());
+    args.push_back(promoteVarArg(builder, arg));
+  }
+  llvm::FunctionCallee printf = module.getOrInsertFunction(
+      "printf", llvm::FunctionType::get(builder.getInt32Ty(),
+                                        {builder.getPtrTy()},
+                                        /*isVarArg=*/true));
+  builder.CreateCall(printf, args);
+  return success();
+}
+
+void LLVMEmitter::emitAssert(executor::AssertOp op) {
+  emitCheck(lookup(op.getArg()), op.getMsg());
+}
+
+void LLVMEmitter::emitCheck(llvm::Value *cond, StringRef msg) {
+  llvm::FunctionCallee assertFail = module.getOrInsertFunction(
+      StringRef(native::kAssertFailFuncName.data(),
+                native::kAssertFailFuncName.size()),
+      llvm::FunctionType::get(builder.getVoidTy(), {builder.getPtrTy()},
+                              /*isVarArg=*/false));
+  cast<llvm::Function>(assertFail.getCallee())->setDoesNotReturn();
+
+  llvm::Function *fn = builder.GetInsertBlock()->getParent();
+  auto *failBlock = llvm::BasicBlock::Create(ctx, "assert.fail", fn);
+  auto *contBlock = llvm::BasicBlock::Create(ctx, "assert.cont", fn);
+  builder.CreateCondBr(cond, contBlock, failBlock);
+  builder.SetInsertPoint(failBlock);
+  builder.CreateCall(assertFail, {builder.CreateGlobalString(msg)});
+  builder.CreateUnreachable();
+  builder.SetInsertPoint(contBlock);
+}
+
+void LLVMEmitter::emitSignedDivisionCheck(llvm::Value *lhs, llvm::Value *rhs) {
+  llvm::Type *type = lhs->getType();
+  emitCheck(builder.CreateICmpNE(rhs, llvm::ConstantInt::get(type, 0)),
+            "integer division by zero");
+  llvm::Value *minValue = llvm::ConstantInt::get(
+      type, llvm::APInt::getSignedMinValue(type->getIntegerBitWidth()));
+  emitCheck(builder.CreateNot(builder.CreateAnd(
+                builder.CreateICmpEQ(lhs, minValue),
+                builder.CreateICmpEQ(rhs, llvm::ConstantInt::getAllOnesValue(
+                                              type)))),
+            "integer overflow in signed division");
+}
+
+llvm::Value *LLVMEmitter::emitBinaryOp(llvm::Instruction::BinaryOps opcode,
+                                       llvm::Value *lhs, llvm::Value *rhs) {
+  using BinaryOps = llvm::Instruction::BinaryOps;
+  llvm::Type *type = lhs->getType();
+  switch (opcode) {
+  case BinaryOps::SDiv:
+    emitSignedDivisionCheck(lhs, rhs);
+    return builder.CreateSDiv(lhs, rhs);
+  case BinaryOps::SRem: {
+    emitCheck(builder.CreateICmpNE(rhs, llvm::ConstantInt::get(type, 0)),
+              "integer division by zero");
+    // The remainder of a division by -1 is zero, but `srem` is undefined
+    // if the quotient overflows, so divide by 1 instead.
+    llvm::Value *minusOne = llvm::ConstantInt::getAllOnesValue(type);
+    rhs = builder.CreateSelect(builder.CreateICmpEQ(rhs, minusOne),
+                               llvm::ConstantInt::get(type, 1), rhs);
+    return builder.CreateSRem(lhs, rhs);
+  }
+  case BinaryOps::Shl:
+  case BinaryOps::LShr: {
+    // Shifting out all bits yields zero. `select` does not propagate the
+    // poison value of the shift that is not chosen.
+    llvm::Value *bitWidth =
+        llvm::ConstantInt::get(type, type->getIntegerBitWidth());
+    return builder.CreateSelect(builder.CreateICmpUGE(rhs, bitWidth),
+                                llvm::ConstantInt::get(type, 0),
+                                builder.CreateBinOp(opcode, lhs, rhs));
+  }
+  case BinaryOps::AShr: {
+    // Shifting out all bits yields the sign bit in every position.
+    llvm::Value *maxShift =
+        llvm::ConstantInt::get(type, type->getIntegerBitWidth() - 1);
+    return builder.CreateAShr(
+        lhs, builder.CreateSelect(builder.CreateICmpUGT(rhs, maxShift),
+                                  maxShift, rhs));
+  }
+  default:
+    return builder.CreateBinOp(opcode, lhs, rhs);
+  }
+}
+
+void LLVMEmitter::addBranchOperands(Block *dest, ValueRange operands) {
+  for (auto [arg, operand] : llvm::zip(dest->getArguments(), operands))
+    cast<llvm::PHINode>(lookup(arg))
+        ->addIncoming(lookup(operand), builder.GetInsertBlock());
+}
+
+LogicalResult LLVMEmitter::emitOperation(Operation &op) {
+  if (std::optional<llvm::Instruction::BinaryOps> opcode =
+          getBinaryOpcode(&op)) {
+    setResult(&op, emitBinaryOp(*opcode, lookup(op.getOperand(0)),
+                                lookup(op.getOperand(1))));
+    return success();
+  }
+
+  auto convertResultType = [&]() {
+    return convertType(op.getLoc(), op.getResult(0).getType());
+  };
+
+  return llvm::TypeSwitch<Operation *, LogicalResult>(&op)
+      .Case([&](executor::ConstantOp op) -> LogicalResult {
+        FailureOr<llvm::Type *> type = convertResultType();
+        if (failed(type))
+          return failure();
+        llvm::Constant *value = getScalarConstant(*type, op.getValue());
+        if (!value)
+          return op.emitOpError("unsupported constant value");
+        setResult(op, value);
+        return success();
+      })
+      .Case([&](executor::SFloorDivIOp op) {
+        // Round the quotient towards negative infinity when the remainder is
+        // non-zero and the operands have different signs.
+        llvm::Value *lhs = lookup(op.getLhs());
+        llvm::Value *rhs = lookup(op.getRhs());
+        emitSignedDivisionCheck(lhs, rhs);
+        llvm::Value *zero = llvm::ConstantInt::get(lhs->getType(), 0);
+        llvm::Value *rem = builder.CreateSRem(lhs, rhs);
+        llvm::Value *adjust = builder.CreateAnd(
+            builder.CreateICmpNE(rem, zero),
+            builder.CreateICmpSLT(builder.CreateXor(rem, rhs), zero));
+        setResult(op, builder.CreateSub(
+                          builder.CreateSDiv(lhs, rhs),
+                          builder.CreateZExt(adjust, lhs->getType())));
+        return success();
+      })
+      .Case([&](executor::ICmpOp op) {
+        setResult(op, builder.CreateICmp(getPredicate(op.getPredicate()),
+                                         lookup(op.getLhs()),
+                                         lookup(op.getRhs())));
+        return success();
+      })
+      .Case([&](executor::FCmpOp op) {
+        setResult(op, builder.CreateFCmp(getPredicate(op.getPredicate()),
+                                         lookup(op.getLhs()),
+                                         lookup(op.getRhs())));
+        return success();
+      })
+      .Case([&](executor::SelectOp op) {
+        setResult(op, builder.CreateSelect(lookup(op.getPredicate()),
+                                           lookup(op.getTrueValue()),
+                                           lookup(op.getFalseValue())));
+        return success();
+      })
+      .Case([&](executor::BitcastOp op) -> LogicalResult {
+        FailureOr<llvm::Type *> type = convertResultType();
+        if (failed(type))
+          return failure();
+        setResult(op, builder.CreateBitCast(lookup(op.getInput()), *type));
+        return success();
+      })
+      .Case([&](executor::AbsFOp op) {
+        setResult(op, builder.CreateUnaryIntrinsic(
+                          llvm::Intrinsic::fabs, lookup(op->getOperand(0))));
+        return success();
+      })
+      .Case([&](executor::CopysignOp op) {
+        setResult(op, builder.CreateBinaryIntrinsic(
+                          llvm::Intrinsic::copysign, lookup(op->getOperand(0)),
+                          lookup(op->getOperand(1))));
+        return success();
+      })
+      .Case([&](executor::CreateTableOp op) -> LogicalResult {
+        FailureOr<llvm::Type *> type = convertResultType();
+        if (failed(type))
+          return failure();
+        llvm::Value *table = llvm::PoisonValue::get(*type);
+        for (auto [idx, v] : llvm::enumerate(op.getInit()))
+          table = builder.CreateInsertValue(table, lookup(v), idx);
+        setResult(op, table);
+        return success();
+      })
+      .Case([&](executor::ExtractTableValueOp op) {
+        setResult(op, builder.CreateExtractValue(lookup(op.getTable()),
+                                                 op.getIndex()));
+        return success();
+      })
+      .Case([&](executor::InsertTableValueOp op) {
+        setResult(op, builder.CreateInsertValue(lookup(op.getTable()),
+                                                lookup(op.getValue()),
+                                                op.getIndex()));
+        return success();
+      })
+      .Case([&](executor::DynamicExtractTableValueOp op) -> LogicalResult {
+        // The table is spilled to the stack and indexed as an array, which
+        // requires that all elements have the same type.
+        auto tableType = cast<executor::TableType>(op.getTable().getType());
+        if (tableType.getBody().empty() ||
+            !llvm::all_equal(tableType.getBody()))
+          return op.emitOpError("requires a table with elements of a single "
+                                "type in the native backend");
+        FailureOr<llvm::Type *> elementType = convertResultType();
+        if (failed(elementType))
+          return failure();
+        llvm::Value *table = lookup(op.getTable());
+        llvm::Function *fn = builder.GetInsertBlock()->getParent();
+        llvm::IRBuilder<> allocaBuilder(&fn->getEntryBlock(),
+                                        fn->getEntryBlock().begin());
+        llvm::Value *spill = allocaBuilder.CreateAlloca(table->getType());
+        builder.CreateStore(table, spill);
+        llvm::Value *ptr = builder.CreateInBoundsGEP(
+            llvm::ArrayType::get(*elementType, tableType.getBody().size()),
+            spill, {builder.getInt64(0), lookup(op.getIndex())});
+        setResult(op, builder.CreateLoad(*elementType, ptr));
+        return success();
+      })
+      .Case([&](executor::StrLiteralOp op) {
+        setResult(op, builder.CreateGlobalString(op.getValue()));
+        return success();
+      })
+      .Case([&](executor::GetGlobalOp op) {
+        llvm::GlobalVariable *global = module.getNamedGlobal(op.getName());
+        setResult(op, builder.CreateLoad(global->getValueType(), global));
+        return success();
+      })
+      .Case([&](executor::SetGlobalOp op) {
+        builder.CreateStore(lookup(op.getValue()),
+                            module.getNamedGlobal(op.getName()));
+        return success();
+      })
+      .Case([&](executor::ConstantResourceLoadOp op) {
+        setResult(op, builder.CreateLoad(builder.getPtrTy(),
+                                         module.getNamedGlobal(op.getName())));
+        return success();
+      })
+      .Case([&](executor::PrintOp op) { return emitPrint(op); })
+      .Case([&](executor::AssertOp op) {
+        emitAssert(op);
+        return success();
+      })
+      .Case([&](executor::CallOp op) {
+        return emitCall(op, op.getCallee(), op.getArgs());
+      })
+      .Case([&](func::CallOp op) {
+        return emitCall(op, op.getCallee(), op.getOperands());
+      })
+      .Case([&](func::ReturnOp op) {
+        if (op.getNumOperands() == 0) {
+          builder.CreateRetVoid();
+          return success();
+        }
+        if (op.getNumOperands() == 1) {
+          builder.CreateRet(lookup(op.getOperand(0)));
+          return success();
+        }
+        llvm::Type *resultType =
+            builder.GetInsertBlock()->getParent()->getReturnType();
+        llvm::Value *result = llvm::PoisonValue::get(resultType);
+        for (auto [idx, v] : llvm::enumerate(op.getOperands()))
+          result = builder.CreateInsertValue(result, lookup(v), idx);
+        builder.CreateRet(result);
+        return success();
+      })
+      .Case([&](cf::BranchOp op) {
+        addBranchOperands(op.getDest(), op.getDestOperands());
+        builder.CreateBr(blockMapping[op.getDest()]);
+        return success();
+      })
+      .Case([&](cf::CondBranchOp op) {
+        // A PHI node can only have one incoming value per predecessor, so
+        // branches with identical successors select the operands instead.
+        llvm::Value *condition = lookup(op.getCondition());
+        if (op.getTrueDest() == op.getFalseDest()) {
+          for (auto [arg, trueValue, falseValue] :
+               llvm::zip(op.getTrueDest()->getArguments(),
+                         op.getTrueDestOperands(), op.getFalseDestOperands()))
+            cast<llvm::PHINode>(lookup(arg))
+                ->addIncoming(builder.CreateSelect(condition,
+                                                   lookup(trueValue),
+                                                   lookup(falseValue)),
+                              builder.GetInsertBlock());
+          builder.CreateBr(blockMapping[op.getTrueDest()]);
+          return success();
+        }
+        addBranchOperands(op.getTrueDest(), op.getTrueDestOperands());
+        addBranchOperands(op.getFalseDest(), op.getFalseDestOperands());
+        builder.CreateCondBr(condition, blockMapping[op.getTrueDest()],
+                             blockMapping[op.getFalseDest()]);
+        return success();
+      })
+      .Case<executor::CoroAwaitOp, executor::CoroCreateOp,
+            executor::CoroYieldOp, func::CallIndirectOp>([&](Operation *op) {
+        return op->emitOpError("is not supported by the native backend");
+      })
+      .Default([&](Operation *op) {
+        return op->emitOpError("unable to translate op to LLVM IR");
+      });
+}
+
+//===----------------------------------------------------------------------===//
+// Module
+//===----------------------------------------------------------------------===//
+
+static bool isModuleLike(Operation &op) {
+  return op.hasTrait<OpTrait::IsIsolatedFromAbove>() &&
+         op.hasTrait<OpTrait::SymbolTable>() && op.getNumRegions() == 1 &&
+         op.getRegion(0).hasOneBlock();
+}
+
+LogicalResult LLVMEmitter::emitModule(Operation &op) {
+  if (auto initFunc = op.getAttrOfType<FlatSymbolRefAttr>(
+          executor::getExecutorGlobalInitializerFuncNameAttr()))
+    initGlobalsFuncName = initFunc.getValue();
+
+  // Declare all symbols first so that uses may precede definitions.
+  Block &body = op.getRegion(0).front();
+  for (Operation &nested : body) {
+    LogicalResult result =
+        llvm::TypeSwitch<Operation *, LogicalResult>(&nested)
+            .Case([&](func::FuncOp func) {
+              return declareFunction(
+                  func, func.getName(), func.getArgumentTypes(),
+                  func.getResultTypes(), /*isVarArg=*/false,
+                  /*isExternal=*/func.isDeclaration(),
+                  func.isPrivate() && func.getName() != initGlobalsFuncName);
+            })
+            .Case([&](executor::FuncOp func) -> LogicalResult {
+              if (!func.isDeclaration())
+                return func.emitOpError(
+                    "expected all executor.func to be declarations");
+              executor::ExecutorFunctionType type = func.getFunctionType();
+              return declareFunction(func, func.getName(), type.getArgs(),
+                                     type.getResults(),
+                                     /*isVarArg=*/!!type.getTrailingVarArg(),
+                                     /*isExternal=*/true, /*isPrivate=*/true);
+            })
+            .Case([&](executor::GlobalOp global) {
+              return declareGlobal(global);
+            })
+            .Case([&](executor::ConstantResourceOp resource) {
+              // The runtime stores the address of the constant's data in the
+              // global when the code is loaded.
+              new llvm::GlobalVariable(
+                  module, builder.getPtrTy(), /*isConstant=*/false,
+                  llvm::GlobalValue::ExternalLinkage,
+                  llvm::ConstantPointerNull::get(builder.getPtrTy()),
+                  resource.getSymName());
+              return success();
+            })
+            .Default([&](Operation *nested) {
+              return nested->emitOpError(
+                  "unable to translate op to LLVM IR");
+            });
+    if (failed(result))
+      return failure();
+  }
+
+  for (auto func : body.getOps<func::FuncOp>()) {
+    if (func.isDeclaration())
+      continue;
+    if (failed(emitFunction(func)))
+      return failure();
+    if (!func.isPrivate())
+      emitInterfaceFunction(func);
+  }
+
+  std::string error;
+  llvm::raw_string_ostream os(error);
+  if (llvm::verifyModule(module, &os))
+    return emitError(op.getLoc())
+           << "translation produced invalid LLVM IR: " << os.str();
+  return success();
+}
+
+FailureOr<std::unique_ptr<llvm::Module>>
+mlir::translateToLLVMIR(Operation *op, llvm::LLVMContext &context) {
+  if (!isModuleLike(*op))
+    return emitError(op->getLoc()) << "expected module-like operation";
+  StringRef name = op->hasAttr(SymbolTable::getSymbolAttrName())
+                       ? SymbolTable::getSymbolName(op).strref()
+                       : "unnamed-module";
+  auto module = std::make_unique<llvm::Module>(name, context);
+  LLVMEmitter emitter(*module);
+  if (failed(emitter.emitModule(*op)))
+    return failure();
+  return module;
+}
+
+void mlir::registerToNativeLLVMIRTranslation() {
+  TranslateFromMLIRRegistration registration(
+      "mlir-to-native-llvmir",
+      "translate from MLIR to LLVM IR for the native host runtime backend",
+      [](Operation *op, llvm::raw_ostream &output) -> LogicalResult {
+        llvm::LLVMContext context;
+        FailureOr<std::unique_ptr<llvm::Module>> module =
+            translateToLLVMIR(op, context);
+        if (failed(module))
+          return failure();
+        (*module)->print(output, /*AAW=*/nullptr);
+        return success();
+      },
+      [](DialectRegistry &registry) {
+        // clang-format off
+        registry.insert<func::FuncDialect,
+                        cf::ControlFlowDialect,
+                        executor::ExecutorDialect,
+                        DLTIDialect>();
+        // clang-format on
+      });
+}
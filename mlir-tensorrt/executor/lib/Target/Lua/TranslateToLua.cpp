@@ -33,7 +33,9 @@
 #include "llvm/ADT/ScopedHashTable.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include <stack>
 
@@ -45,7 +47,8 @@ namespace {
 /// common components without the code duplication here.
 class LuaEmitter {
 public:
-  explicit LuaEmitter(MLIRContext *ctx, raw_ostream &os);
+  explicit LuaEmitter(MLIRContext *ctx, raw_ostream &os,
+                      const TranslateToLuaOptions &options = {});
 
   /// Emit Lua ofr a "module-like" operation. This creates a new scope for all
   /// resources. It is expected that this is only used as the top-level
@@ -149,6 +152,7 @@ protected:
 
   MLIRContext *ctx;
   raw_indented_ostream os;
+  TranslateToLuaOptions options;
 };
 } // namespace
 
@@ -610,12 +614,13 @@ static LogicalResult printOperation(LuaEmitter &emitter,
   return success();
 }
 
-/// Translate `executor.load_constant_resource`.
+/// Translate `executor.load_constant_resource`. The runtime provides the
+/// constants of the executable in the `executor_constants` table.
 static LogicalResult printOperation(LuaEmitter &emitter,
                                     executor::ConstantResourceLoadOp op) {
   if (failed(emitter.emitAssignPrefix(op)))
     return failure();
-  emitter << op.getName() << ";\n";
+  emitter << "executor_constants." << op.getName() << ";\n";
   return success();
 }
 
@@ -683,11 +688,286 @@ static LogicalResult printOperation(LuaEmitter &emitter, executor::FuncOp op) {
   return success();
 }
 
+//===----------------------------------------------------------------------===//
+// Native arithmetic
+//===----------------------------------------------------------------------===//
+
+// When `TranslateToLuaOptions::emitNativeArithmetic` is set, scalar ops whose
+// semantic can be reproduced exactly with Lua 5.4 integer and float operators
+// are emitted inline instead of calling the builtins registered by the core
+// runtime module. Each builtin call crosses the Lua/C++ boundary, which
+// dominates the cost of shape computations. The expressions below mirror the
+// C++ implementations in `CoreModule.cpp`. Integers of all widths are held as
+// sign-extended Lua integers and i1 values are held as 0 or 1. Floats are held
+// as doubles, so f32 is only handled where the result does not need rounding.
+
+static bool isNativeIntegerType(Type type) {
+  return type.isInteger(1) || type.isInteger(32) || type.isInteger(64);
+}
+
+static bool isNativeFloatType(Type type, bool allowF32 = false) {
+  return type.isF64() || (allowF32 && type.isF32());
+}
+
+static std::string getTypeString(Type type) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os << type;
+  return os.str();
+}
+
+/// Wrap the integer Lua expression `expr` to the range of a signed 32 bit
+/// integer.
+static std::string wrapToI32(StringRef expr) {
+  return llvm::formatv("(((({0}) + 0x80000000) & 0xFFFFFFFF) - 0x80000000)",
+                       expr);
+}
+
+/// Convert the Lua boolean expression `expr` to an i1 value.
+static std::string boolToI1(StringRef expr) {
+  return llvm::formatv("(({0}) and 1 or 0)", expr);
+}
+
+static std::optional<std::string>
+getNativeICmpExpr(executor::ICmpOp op, StringRef lhs, StringRef rhs) {
+  Type type = op.getLhs().getType();
+  if (!isNativeIntegerType(type))
+    return std::nullopt;
+
+  // Unsigned comparisons are performed on the zero-extended i32 value or, for
+  // i64, after flipping the sign bit.
+  auto toUnsigned = [&](StringRef value) -> std::string {
+    if (type.isInteger(64))
+      return llvm::formatv("({0} ~ 0x8000000000000000)", value);
+    if (type.isInteger(32))
+      return llvm::formatv("({0} & 0xFFFFFFFF)", value);
+    return value.str();
+  };
+
+  switch (op.getPredicate()) {
+  case executor::ICmpType::eq:
+    return boolToI1(llvm::formatv("{0} == {1}", lhs, rhs).str());
+  case executor::ICmpType::ne:
+    return boolToI1(llvm::formatv("{0} ~= {1}", lhs, rhs).str());
+  case executor::ICmpType::slt:
+    return boolToI1(llvm::formatv("{0} < {1}", lhs, rhs).str());
+  case executor::ICmpType::sgt:
+    return boolToI1(llvm::formatv("{0} > {1}", lhs, rhs).str());
+  case executor::ICmpType::sle:
+    return boolToI1(llvm::formatv("{0} <= {1}", lhs, rhs).str());
+  case executor::ICmpType::sge:
+    return boolToI1(llvm::formatv("{0} >= {1}", lhs, rhs).str());
+  case executor::ICmpType::ult:
+    return boolToI1(
+        llvm::formatv("{0} < {1}", toUnsigned(lhs), toUnsigned(rhs)).str());
+  case executor::ICmpType::ugt:
+    return boolToI1(
+        llvm::formatv("{0} > {1}", toUnsigned(lhs), toUnsigned(rhs)).str());
+  }
+  return std::nullopt;
+}
+
+static std::optional<std::string>
+getNativeFCmpExpr(executor::FCmpOp op, StringRef lhs, StringRef rhs) {
+  if (!isNativeFloatType(op.getLhs().getType(), /*allowF32=*/true))
+    return std::nullopt;
+
+  // Lua comparisons involving NaN are false (except for `~=`), which matches
+  // the ordered predicates. Unordered predicates negate the inverse ordered
+  // comparison.
+  StringRef format;
+  switch (op.getPredicate()) {
+  case executor::FCmpType::_false:
+    return std::string("0");
+  case executor::FCmpType::_true:
+    return std::string("1");
+  case executor::FCmpType::oeq:
+    format = "{0} == {1}";
+    break;
+  case executor::FCmpType::ogt:
+    format = "{0} > {1}";
+    break;
+  case executor::FCmpType::oge:
+    format = "{0} >= {1}";
+    break;
+  case executor::FCmpType::olt:
+    format = "{0} < {1}";
+    break;
+  case executor::FCmpType::ole:
+    format = "{0} <= {1}";
+    break;
+  case executor::FCmpType::one:
+    format = "{0} < {1} or {0} > {1}";
+    break;
+  case executor::FCmpType::ord:
+    format = "{0} == {0} and {1} == {1}";
+    break;
+  case executor::FCmpType::ueq:
+    format = "not ({0} < {1} or {0} > {1})";
+    break;
+  case executor::FCmpType::ugt:
+    format = "not ({0} <= {1})";
+    break;
+  case executor::FCmpType::uge:
+    format = "not ({0} < {1})";
+    break;
+  case executor::FCmpType::ult:
+    format = "not ({0} >= {1})";
+    break;
+  case executor::FCmpType::ule:
+    format = "not ({0} > {1})";
+    break;
+  case executor::FCmpType::une:
+    format = "{0} ~= {1}";
+    break;
+  case executor::FCmpType::uno:
+    format = "{0} ~= {0} or {1} ~= {1}";
+    break;
+  }
+  if (format.empty())
+    return std::nullopt;
+  return boolToI1(llvm::formatv(format.data(), lhs, rhs).str());
+}
+
+/// Return the native expression for a call to a runtime builtin that is
+/// produced by `executor-lower-to-runtime-builtins`.
+static std::optional<std::string>
+getNativeBuiltinCallExpr(LuaEmitter &emitter, executor::CallOp op) {
+  if (op->getNumResults() != 1 || op->getNumOperands() == 0)
+    return std::nullopt;
+  StringRef callee = op.getCallee();
+  Type type = op->getOperand(0).getType();
+  Type resultType = op->getResult(0).getType();
+  StringRef operand = emitter.getVariableName(op->getOperand(0));
+
+  if (op->getNumOperands() == 1) {
+    // `executor.sitofp` is exact only when converting to f64.
+    if ((type.isInteger(32) || type.isInteger(64)) && resultType.isF64() &&
+        callee == "_sitofp_" + getTypeString(type) + "_f64")
+      return llvm::formatv("{0} + 0.0", operand).str();
+    return std::nullopt;
+  }
+
+  if (op->getNumOperands() != 2 || op->getOperand(1).getType() != type ||
+      resultType != type)
+    return std::nullopt;
+  StringRef lhs = operand;
+  StringRef rhs = emitter.getVariableName(op->getOperand(1));
+  if (!callee.consume_back("_" + getTypeString(type)))
+    return std::nullopt;
+
+  // These mirror `std::max` and `std::min`, including the NaN behavior.
+  bool isIntMinMax = (type.isInteger(32) || type.isInteger(64)) &&
+                     (callee == "_smax" || callee == "_smin");
+  bool isFloatMinMax = isNativeFloatType(type, /*allowF32=*/true) &&
+                       (callee == "_fmax" || callee == "_fmin");
+  if (!isIntMinMax && !isFloatMinMax)
+    return std::nullopt;
+  if (callee.ends_with("max"))
+    return llvm::formatv("({0} < {1}) and {1} or {0}", lhs, rhs).str();
+  return llvm::formatv("({1} < {0}) and {1} or {0}", lhs, rhs).str();
+}
+
+/// Return a Lua expression that computes the single result of `op` with
+/// native Lua operators, or std::nullopt if `op` must be emitted normally.
+static std::optional<std::string> getNativeArithmeticExpr(LuaEmitter &emitter,
+                                                          Operation *op) {
+  auto getOperand = [&](unsigned idx) {
+    return emitter.getVariableName(op->getOperand(idx));
+  };
+  auto isI32 = [](Type t) { return t.isInteger(32); };
+  auto isI32OrI64 = [](Type t) { return t.isInteger(32) || t.isInteger(64); };
+  using ResultT = std::optional<std::string>;
+
+  return llvm::TypeSwitch<Operation *, ResultT>(op)
+      .Case<executor::ICmpOp>([&](executor::ICmpOp op) {
+        return getNativeICmpExpr(op, getOperand(0), getOperand(1));
+      })
+      .Case<executor::FCmpOp>([&](executor::FCmpOp op) {
+        return getNativeFCmpExpr(op, getOperand(0), getOperand(1));
+      })
+      .Case<executor::SelectOp>([&](executor::SelectOp op) -> ResultT {
+        // Every value of these types is truthy, so `and`/`or` is a valid
+        // conditional expression.
+        Type type = op.getType();
+        if (!isNativeIntegerType(type) &&
+            !isNativeFloatType(type, /*allowF32=*/true))
+          return std::nullopt;
+        return llvm::formatv("({0} ~= 0) and {1} or {2}", getOperand(0),
+                             getOperand(1), getOperand(2))
+            .str();
+      })
+      .Case<executor::BitwiseAndIOp, executor::BitwiseOrIOp,
+            executor::BitwiseXOrIOp>([&](auto op) -> ResultT {
+        if (!isNativeIntegerType(op.getType()))
+          return std::nullopt;
+        Operation *bitwiseOp = op.getOperation();
+        StringRef symbol = isa<executor::BitwiseAndIOp>(bitwiseOp)  ? "&"
+                           : isa<executor::BitwiseOrIOp>(bitwiseOp) ? "|"
+                                                                    : "~";
+        return llvm::formatv("{0} {1} {2}", getOperand(0), symbol,
+                             getOperand(1))
+            .str();
+      })
+      .Case<executor::ShiftLeftIOp>([&](executor::ShiftLeftIOp op) -> ResultT {
+        if (!isI32OrI64(op.getType()))
+          return std::nullopt;
+        std::string expr =
+            llvm::formatv("{0} << {1}", getOperand(0), getOperand(1));
+        return isI32(op.getType()) ? wrapToI32(expr) : expr;
+      })
+      .Case<executor::ShiftRightLogicalIOp>(
+          [&](executor::ShiftRightLogicalIOp op) -> ResultT {
+            if (!isI32OrI64(op.getType()))
+              return std::nullopt;
+            if (!isI32(op.getType()))
+              return llvm::formatv("{0} >> {1}", getOperand(0), getOperand(1))
+                  .str();
+            return wrapToI32(llvm::formatv("({0} & 0xFFFFFFFF) >> {1}",
+                                           getOperand(0), getOperand(1))
+                                 .str());
+          })
+      .Case<executor::ShiftRightArithmeticIOp>(
+          [&](executor::ShiftRightArithmeticIOp op) -> ResultT {
+            // Lua only has a logical right shift. Shifting the complement of
+            // a negative value shifts in ones.
+            if (!isI32OrI64(op.getType()))
+              return std::nullopt;
+            return llvm::formatv(
+                       "({0} >= 0) and ({0} >> {1}) or ~(~{0} >> {1})",
+                       getOperand(0), getOperand(1))
+                .str();
+          })
+      .Case<executor::SDivIOp>([&](executor::SDivIOp op) -> ResultT {
+        // Lua's `//` rounds towards negative infinity. Adjust the quotient to
+        // round towards zero when the remainder is non-zero and the operands
+        // have different signs.
+        if (!isI32OrI64(op.getType()))
+          return std::nullopt;
+        return llvm::formatv(
+                   "{0} // {1} + ((({0} % {1} ~= 0) and (({0} ~ {1}) < 0)) and "
+                   "1 or 0)",
+                   getOperand(0), getOperand(1))
+            .str();
+      })
+      .Case<executor::DivFOp>([&](executor::DivFOp op) -> ResultT {
+        if (!isNativeFloatType(op.getType()))
+          return std::nullopt;
+        return llvm::formatv("{0} / {1}", getOperand(0), getOperand(1)).str();
+      })
+      .Case<executor::CallOp>([&](executor::CallOp op) {
+        return getNativeBuiltinCallExpr(emitter, op);
+      })
+      .Default([](Operation *) { return std::nullopt; });
+}
+
 //===----------------------------------------------------------------------===//
 // LuaEmitter implementation
 //===----------------------------------------------------------------------===//
 
-LuaEmitter::LuaEmitter(MLIRContext *ctx, raw_ostream &os) : ctx(ctx), os(os) {
+LuaEmitter::LuaEmitter(MLIRContext *ctx, raw_ostream &os,
+                       const TranslateToLuaOptions &options)
+    : ctx(ctx), os(os), options(options) {
   localsInScopeCount.push(0);
   labelInScopeCount.push(0);
   globalsInScopeCount.push(0);
@@ -868,6 +1148,15 @@ LogicalResult LuaEmitter::emitOperation(Operation &op) {
     return success();
 
   if (isa<executor::ExecutorDialect>(op.getDialect())) {
+    if (options.emitNativeArithmetic) {
+      if (std::optional<std::string> expr =
+              getNativeArithmeticExpr(*this, &op)) {
+        if (failed(emitAssignPrefix(&op)))
+          return failure();
+        os << *expr << ";\n";
+        return success();
+      }
+    }
     return llvm::TypeSwitch<Operation *, LogicalResult>(&op)
         .Case<executor::FuncOp, executor::CallOp, executor::ConstantOp>(
             [&](auto op) { return printOperation(*this, op); })
@@ -933,8 +1222,9 @@ LogicalResult LuaEmitter::emitOperation(Operation &op) {
       });
 }
 
-LogicalResult mlir::translateToLua(Operation *op, raw_ostream &os) {
-  LuaEmitter luaEmitter(op->getContext(), os);
+LogicalResult mlir::translateToLua(Operation *op, raw_ostream &os,
+                                   const TranslateToLuaOptions &options) {
+  LuaEmitter luaEmitter(op->getContext(), os, options);
   if (isa<FunctionOpInterface>(op))
     return luaEmitter.emitOperation(*op);
   if (isModuleLike(*op))
@@ -944,11 +1234,39 @@ LogicalResult mlir::translateToLua(Operation *op, raw_ostream &os) {
          << "expected FunctionOpInterface or Module-like operation";
 }
 
+namespace {
+/// Command line options for the translations that emit Lua.
+struct TranslateToLuaCLOptions {
+  llvm::cl::opt<bool> emitNativeArithmetic{
+      "lua-native-arithmetic",
+      llvm::cl::desc("emit native Lua operators for scalar arithmetic "
+                     "instead of calls to runtime builtins where possible"),
+      llvm::cl::init(false)};
+};
+} // namespace
+
+static llvm::ManagedStatic<TranslateToLuaCLOptions> clOptions;
+
+void mlir::registerTranslateToLuaCLOptions() {
+  // Construct the options so that they are registered with the parser.
+  *clOptions;
+}
+
+TranslateToLuaOptions mlir::getTranslateToLuaOptionsFromCL() {
+  TranslateToLuaOptions options;
+  if (!clOptions.isConstructed())
+    return options;
+  options.emitNativeArithmetic = clOptions->emitNativeArithmetic;
+  return options;
+}
+
 void mlir::registerToLuaTranslation() {
+  registerTranslateToLuaCLOptions();
   TranslateFromMLIRRegistration registration(
       "mlir-to-lua", "translate from MLIR to Lua",
       [](Operation *op, llvm::raw_ostream &output) {
-        return mlir::translateToLua(op, output);
+        return mlir::translateToLua(op, output,
+                                    getTranslateToLuaOptionsFromCL());
       },
       [](DialectRegistry &registry) {
         // clang-format off
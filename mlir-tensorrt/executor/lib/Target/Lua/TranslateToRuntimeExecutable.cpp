@@ -25,6 +25,7 @@
 #include "mlir-executor/Executor/IR/Executor.h"
 #include "mlir-executor/Runtime/API/API.h"
 #include "mlir-executor/Runtime/API/ExecutableFlatbuffer.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaBytecode.h"
 #include "mlir-executor/Target/Lua/TranslateToLua.h"
 #include "mlir/Dialect/ControlFlow/IR/ControlFlow.h"
 #include "mlir/Dialect/DLTI/DLTI.h"
@@ -33,12 +34,32 @@
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/DialectResourceBlobManager.h"
 #include "mlir/Tools/mlir-translate/Translation.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemAlloc.h"
+#include "llvm/Support/xxhash.h"
+
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+#include "mlir-executor/Target/LLVM/TranslateToLLVMIR.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
 
 using namespace mlir;
 namespace rt = mlirtrt::runtime;
 
+#define DEBUG_TYPE "translate-to-runtime-executable"
+
+STATISTIC(NumConstantsDeduplicated,
+          "Number of constants whose data aliases an identical constant");
+STATISTIC(NumConstantBytesDeduplicated,
+          "Number of constant bytes saved by deduplication");
+
 static size_t constexpr kBitsPerByte = 8;
 
 namespace {
@@ -52,16 +73,63 @@ using Offset = fb::Offset<T>;
 template <typename T>
 using Offset64 = fb::Offset64<T>;
 
-/// Describes a 64bit offset pair.
-template <typename T1, typename T2>
-using Offset64Pair = std::pair<Offset64<T1>, Offset64<T2>>;
-
 /// Describes a 32bit offset for an item serialized as a union.
 template <typename T1>
 using UnionOffset = std::pair<T1, Offset<void>>;
 
+/// A flatbuffer allocator that aligns buffers to
+/// `rt::kExecutableConstantAlignment`. Together with the builder's minimum
+/// buffer alignment, this ensures that constants are also aligned in memory
+/// when the serialized buffer is used directly.
+class AlignedAllocator : public fb::Allocator {
+public:
+  uint8_t *allocate(size_t size) final {
+    return static_cast<uint8_t *>(
+        llvm::allocate_buffer(size, rt::kExecutableConstantAlignment));
+  }
+  void deallocate(uint8_t *p, size_t size) final {
+    llvm::deallocate_buffer(p, size, rt::kExecutableConstantAlignment);
+  }
+};
+
 class FBBuilder : public fb::FlatBufferBuilder64 {
 public:
+  FBBuilder()
+      : fb::FlatBufferBuilder64(/*initial_size=*/1024, new AlignedAllocator(),
+                                /*own_allocator=*/true,
+                                rt::kExecutableConstantAlignment) {}
+
+  /// Serialize constant data into the 64 bit section. The data is aligned to
+  /// `rt::kExecutableConstantAlignment` so that the runtime can always use it
+  /// in place. Constant data is deduplicated by content: if identical data was
+  /// already serialized, the offset of the existing vector is returned so that
+  /// all constants with that content alias a single copy.
+  Offset64<fb::Vector64<int8_t>> serializeConstant(ArrayRef<int8_t> data) {
+    uint64_t hash = llvm::xxh3_64bits(ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+    SmallVector<Offset64<fb::Vector64<int8_t>>, 1> &candidates =
+        serializedConstants[hash];
+    for (Offset64<fb::Vector64<int8_t>> offset : candidates) {
+      if (getSerializedConstant(offset) != data)
+        continue;
+      ++NumConstantsDeduplicated;
+      NumConstantBytesDeduplicated += data.size();
+      return offset;
+    }
+
+    this->ForceVectorAlignment64(data.size(), sizeof(int8_t),
+                                 rt::kExecutableConstantAlignment);
+    Offset64<fb::Vector64<int8_t>> offset =
+        this->CreateVector64(data.data(), data.size());
+    candidates.push_back(offset);
+    return offset;
+  }
+
+  Offset64<fb::Vector64<int8_t>> serializeConstant(ArrayRef<char> data) {
+    return serializeConstant(ArrayRef<int8_t>(
+        reinterpret_cast<const int8_t *>(data.data()), data.size()));
+  }
+
   template <typename T>
   auto serialize(const std::vector<T> &span) {
     return this->CreateVector(span);
@@ -77,17 +145,21 @@ public:
     return this->serialize(ArrayRef<T>(span));
   }
 
-  template <typename T>
-  auto serialize64(mlir::ArrayRef<T> span) {
-    return this->CreateVector64(span.data(), span.size());
+private:
+  /// Return the contents of a constant vector previously serialized into the
+  /// (unfinished) buffer. Offsets are relative to the end of the buffer.
+  ArrayRef<int8_t>
+  getSerializedConstant(Offset64<fb::Vector64<int8_t>> offset) const {
+    const auto *vector = reinterpret_cast<const fb::Vector64<int8_t> *>(
+        this->GetCurrentBufferPointer() + this->GetSize() - offset.o);
+    return ArrayRef<int8_t>(vector->data(), vector->size());
   }
-};
 
-template <>
-auto FBBuilder::serialize64(mlir::ArrayRef<char> span) {
-  return this->CreateVector<int8_t, fb::Offset64, fb::Vector64>(
-      reinterpret_cast<const int8_t *>(span.data()), span.size());
-}
+  /// Maps the hash of the serialized constant data to the offsets of the
+  /// vectors with that hash.
+  llvm::DenseMap<uint64_t, SmallVector<Offset64<fb::Vector64<int8_t>>, 1>>
+      serializedConstants;
+};
 
 /// An implementation of `ExecutableStorage` that just uses a
 /// `flatbuffers::DetachedBuffer`. This allows us to avoid a copy of the
@@ -106,6 +178,14 @@ private:
   flatbuffers::DetachedBuffer storage;
 };
 
+/// The serialized data of a constant and how it is encoded.
+struct EncodedConstantData {
+  Offset64<fb::Vector64<int8_t>> data;
+  rt::ConstantEncoding encoding{rt::ConstantEncoding::raw};
+  /// The decoded size in bytes, only used if `encoding` is not `raw`.
+  uint64_t decodedSize{0};
+};
+
 } // namespace
 
 /// Translate the scalar type into the equivalent flatbuffer API object.
@@ -141,30 +221,37 @@ static FailureOr<rt::ScalarTypeCode> translateScalarType(Type t) {
   return failure();
 }
 
-/// Serialize `elAttr` to `output` if `elAttr` is a splat-type attribute.
-static FailureOr<Offset64<fb::Vector64<int8_t>>>
+/// Serialize `elAttr` to `output` if `elAttr` is a splat-type attribute. Only
+/// a single element is stored and the constant uses the `splat` encoding.
+static FailureOr<EncodedConstantData>
 serializeDenseSplatElementsAttr(FBBuilder &fbBuilder,
                                 SplatElementsAttr elAttr) {
+  // Empty attributes are splats, but have no data to store.
+  if (elAttr.getNumElements() == 0)
+    return EncodedConstantData{fbBuilder.serializeConstant(ArrayRef<int8_t>())};
+
+  SmallVector<int8_t> element;
+  if (elAttr.getElementType().isInteger(1)) {
+    element.push_back(elAttr.getSplatValue<bool>() ? 1 : 0);
+  } else if (elAttr.getElementType().isInteger(4)) {
+    element.push_back(
+        static_cast<int8_t>(elAttr.getSplatValue<APInt>().getSExtValue()));
+  } else {
+    ArrayRef<char> data = elAttr.getRawData();
+    element.assign(data.begin(), data.end());
+  }
 
-  if (elAttr.getElementType().isInteger(1))
-    return fbBuilder.CreateVector64(std::vector<int8_t>(
-        elAttr.getNumElements(), elAttr.getSplatValue<bool>() ? 1 : 0));
-
-  if (elAttr.getElementType().isInteger(4))
-    return fbBuilder.CreateVector64(std::vector<int8_t>(
-        elAttr.getNumElements(),
-        static_cast<int8_t>(elAttr.getSplatValue<APInt>().getSExtValue())));
-
-  auto data = elAttr.getRawData();
-  std::vector<int8_t> output;
-  output.reserve(data.size() * elAttr.getNumElements());
-  for (int64_t i = 0; i < elAttr.getNumElements(); i++)
-    llvm::append_range(output, data);
-  return fbBuilder.CreateVector64(output);
+  EncodedConstantData result;
+  result.data = fbBuilder.serializeConstant(element);
+  if (elAttr.getNumElements() > 1) {
+    result.encoding = rt::ConstantEncoding::splat;
+    result.decodedSize = element.size() * elAttr.getNumElements();
+  }
+  return result;
 }
 
 /// Serialize `elAttr` to `output` if `elAttr` is not a splat-type attribute.
-static FailureOr<Offset64<fb::Vector64<int8_t>>>
+static FailureOr<EncodedConstantData>
 serializeDenseElementsAttr(FBBuilder &fbBuilder,
                            DenseIntOrFPElementsAttr elAttr) {
   if (elAttr.isSplat())
@@ -178,27 +265,28 @@ serializeDenseElementsAttr(FBBuilder &fbBuilder,
              << "requested serialization of " << elAttr.getType()
              << ", but for complex element types, only "
                 "complex<f32> and complex<f64> are supported";
-    return fbBuilder.serialize64(elAttr.getRawData());
+    return EncodedConstantData{
+        fbBuilder.serializeConstant(elAttr.getRawData())};
   }
 
   if (elAttr.getElementType().isInteger(1)) {
     auto range = llvm::map_range(elAttr.getValues<bool>(), [](bool inp) {
       return static_cast<int8_t>(inp);
     });
-    return fbBuilder.CreateVector64(
-        std::vector<int8_t>(range.begin(), range.end()));
+    return EncodedConstantData{fbBuilder.serializeConstant(
+        std::vector<int8_t>(range.begin(), range.end()))};
   }
   if (elAttr.getElementType().isInteger(4)) {
     auto range = llvm::map_range(elAttr.getValues<APInt>(), [](APInt inp) {
       return static_cast<int8_t>(inp.getSExtValue());
     });
-    return fbBuilder.CreateVector64(
-        std::vector<int8_t>(range.begin(), range.end()));
+    return EncodedConstantData{fbBuilder.serializeConstant(
+        std::vector<int8_t>(range.begin(), range.end()))};
   }
   if (elAttr.getElementType().getIntOrFloatBitWidth() % kBitsPerByte != 0)
     return failure();
 
-  return fbBuilder.serialize64(elAttr.getRawData());
+  return EncodedConstantData{fbBuilder.serializeConstant(elAttr.getRawData())};
 }
 
 /// Return the number of bits required per element of `t` for MLIR
@@ -234,7 +322,7 @@ static size_t getExpectedSerializedSize(Type type) {
 /// a load/store convention), for e.g. boolean constants or i4 types, etc. It
 /// also assumes the endianness matches the host.
 /// TODO: Can we replace this with something more robust from upstream?
-static FailureOr<Offset64Pair<fb::String, fb::Vector64<int8_t>>>
+static FailureOr<std::pair<Offset64<fb::String>, EncodedConstantData>>
 serializeElementsAttr(FBBuilder &fbBuilder, StringRef symbolName,
                       ElementsAttr attr) {
   auto name = fbBuilder.CreateString<Offset64>(symbolName.str());
@@ -254,7 +342,8 @@ serializeElementsAttr(FBBuilder &fbBuilder, StringRef symbolName,
     ArrayRef<char> data = handle.getResource()->getBlob()->getData();
     if (data.size() != getExpectedSerializedSize(typedAttr.getType()))
       return retError("unexpected serialization size");
-    return std::make_pair(name, fbBuilder.serialize64(data));
+    return std::make_pair(
+        name, EncodedConstantData{fbBuilder.serializeConstant(data)});
   }
 
   // Encode dense elements attrs.
@@ -463,13 +552,18 @@ translateSignature(FBBuilder &fbBuilder,
           ? fbBuilder.CreateString(metadata.getShapeFunc().getAttr().str())
           : fbBuilder.CreateString("");
 
+  SmallVector<int32_t> outputAliases;
+  if (DenseI64ArrayAttr aliases = metadata.getOutputAliases())
+    llvm::append_range(outputAliases, aliases.asArrayRef());
+
   return rt::impl::CreateFunctionSignature(
       fbBuilder, fbBuilder.serialize(argVariantTypes),
       fbBuilder.serialize(argOffsets), fbBuilder.serialize(resultVariantTypes),
       fbBuilder.serialize(resultOffsets), metadata.getNumOutputArgs(), fbBounds,
       fbBoundsOffsets, fbBuilder.serialize(resBounds),
       fbBuilder.serialize(resBoundsOffsets), shapeFuncSym,
-      translateCallingConvention(metadata.getCconv()));
+      translateCallingConvention(metadata.getCconv()),
+      fbBuilder.serialize(outputAliases));
 }
 
 /// Return a sanitized version of a symbol name by replacing special characters
@@ -480,8 +574,30 @@ static std::string sanitizeName(StringRef name) {
   return llvm::join(segments, "_");
 }
 
+/// Translate `op` to LLVM IR for the native host runtime backend and return
+/// the serialized bitcode.
+static FailureOr<std::string> translateToNativeBitcode(Operation *op) {
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+  llvm::LLVMContext context;
+  FailureOr<std::unique_ptr<llvm::Module>> module =
+      translateToLLVMIR(op, context);
+  if (failed(module))
+    return emitError(op->getLoc(), "LLVM IR translation failed");
+  std::string bitcode;
+  llvm::raw_string_ostream os(bitcode);
+  llvm::WriteBitcodeToFile(**module, os);
+  os.flush();
+  return bitcode;
+#else
+  return emitError(op->getLoc())
+         << "cannot embed native code: the project was built without "
+            "native backend support (MLIR_EXECUTOR_TARGET_NATIVE=OFF)";
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
+}
+
 FailureOr<std::unique_ptr<mlirtrt::runtime::ExecutableStorage>>
-mlir::translateToRuntimeExecutable(Operation *op) {
+mlir::translateToRuntimeExecutable(
+    Operation *op, const TranslateToRuntimeExecutableOptions &options) {
 
   FBBuilder fbBuilder;
 
@@ -514,7 +630,7 @@ mlir::translateToRuntimeExecutable(Operation *op) {
   // data value attached to it, then serialize that constant data in the
   // executable as a Constant. These go into the 64bit section. We serialize the
   // string with the data in the 64 bit section.
-  SmallVector<Offset64Pair<fb::String, fb::Vector64<int8_t>>> constData;
+  SmallVector<std::pair<Offset64<fb::String>, EncodedConstantData>> constData;
   for (auto resourceOp :
        op->getRegion(0).getOps<executor::ConstantResourceOp>()) {
 
@@ -532,18 +648,36 @@ mlir::translateToRuntimeExecutable(Operation *op) {
   //===----------------------------------------------------------------------===//
   SmallVector<Offset<rt::impl::Constant>> constantOffsets;
   constantOffsets.reserve(constData.size());
-  for (const auto &[strOffset, dataOffset] : constData)
-    constantOffsets.push_back(
-        rt::impl::CreateConstant(fbBuilder, strOffset, dataOffset));
+  for (const auto &[strOffset, data] : constData)
+    constantOffsets.push_back(rt::impl::CreateConstant(
+        fbBuilder, strOffset, data.data, data.encoding, data.decodedSize));
 
   std::string sourceString;
   {
     llvm::raw_string_ostream ss(sourceString);
-    if (failed(mlir::translateToLua(op, ss)))
+    if (failed(mlir::translateToLua(op, ss, options.luaOptions)))
       return emitError(op->getLoc(), "Lua translation failed");
   }
   Offset<fb::String> sourceStrOffset = fbBuilder.CreateString(sourceString);
 
+  // Precompile the source so that runtimes can skip parsing it.
+  mlirtrt::StatusOr<std::string> bytecode =
+      rt::compileLuaSourceToBytecode(sourceString);
+  if (!bytecode.isOk())
+    return emitError(op->getLoc()) << bytecode.getStatus().getString();
+  auto bytecodeOffset = fbBuilder.serialize(ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(bytecode->data()), bytecode->size()));
+
+  Offset<fb::Vector<uint8_t>> nativeCodeOffset = 0;
+  if (options.embedNativeCode) {
+    FailureOr<std::string> nativeCode = translateToNativeBitcode(op);
+    if (failed(nativeCode))
+      return failure();
+    nativeCodeOffset = fbBuilder.serialize(ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(nativeCode->data()),
+        nativeCode->size()));
+  }
+
   // Loop over all functions and collect metadata (function names and
   // signatures) that we will embed in the executable.
   SmallVector<Offset<rt::impl::Function>> funcOffsets;
@@ -590,6 +724,10 @@ mlir::translateToRuntimeExecutable(Operation *op) {
   exeBuilder.add_functions(vecFuncOffsets);
   exeBuilder.add_constants(constVecOffsets);
   exeBuilder.add_source(sourceStrOffset);
+  exeBuilder.add_bytecode(bytecodeOffset);
+  exeBuilder.add_bytecode_lua_version(LUA_VERSION_NUM);
+  if (!nativeCodeOffset.IsNull())
+    exeBuilder.add_native_code(nativeCodeOffset);
   exeBuilder.add_name(nameOffset);
   fbBuilder.Finish(exeBuilder.Finish());
 
@@ -608,10 +746,11 @@ mlir::translateToRuntimeExecutable(Operation *op) {
   return result;
 }
 
-LogicalResult mlir::translateToRuntimeExecutable(Operation *op,
-                                                 raw_ostream &os) {
+LogicalResult mlir::translateToRuntimeExecutable(
+    Operation *op, raw_ostream &os,
+    const TranslateToRuntimeExecutableOptions &options) {
   FailureOr<std::unique_ptr<mlirtrt::runtime::ExecutableStorage>> storage =
-      translateToRuntimeExecutable(op);
+      translateToRuntimeExecutable(op, options);
   if (failed(storage) || !*storage)
     return failure();
 
@@ -620,12 +759,31 @@ LogicalResult mlir::translateToRuntimeExecutable(Operation *op,
   return success();
 }
 
+namespace {
+struct TranslateToRuntimeExecutableCLOptions {
+  llvm::cl::opt<bool> embedNativeCode{
+      "embed-native-code",
+      llvm::cl::desc("embed LLVM bitcode for the native host runtime backend "
+                     "in the executable"),
+      llvm::cl::init(false)};
+};
+} // namespace
+
+static llvm::ManagedStatic<TranslateToRuntimeExecutableCLOptions>
+    exeClOptions;
+
 void mlir::registerToRuntimeExecutableTranslation() {
+  registerTranslateToLuaCLOptions();
+  // Construct the options so that they are registered with the parser.
+  *exeClOptions;
   TranslateFromMLIRRegistration registration(
       "mlir-to-runtime-executable",
       "translate from MLIR to Executor runtime executable",
       [](Operation *op, llvm::raw_ostream &output) {
-        return translateToRuntimeExecutable(op, output);
+        TranslateToRuntimeExecutableOptions options;
+        options.luaOptions = getTranslateToLuaOptionsFromCL();
+        options.embedNativeCode = exeClOptions->embedNativeCode;
+        return translateToRuntimeExecutable(op, output, options);
       },
       [](DialectRegistry &registry) {
         registry.insert<func::FuncDialect, cf::ControlFlowDialect,
@@ -19,8 +19,13 @@
 //===----------------------------------------------------------------------===//
 #include "mlir-executor/Tools/ExecutorRunnerMain.h"
 #include "mlir-executor/Runtime/API/API.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaBenchmark.h"
 #include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+#include "mlir-executor/Runtime/Backend/Native/NativeRuntime.h"
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
 #include "mlir-executor/Runtime/Support/MPI.h"
+#include "mlir-executor/Runtime/Support/Profiler.h"
 #include "mlir-executor/Support/CUDAWrappers.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Location.h"
@@ -94,6 +99,12 @@ struct Options {
                                       cl::desc("Dump function signature"),
                                       cl::init(false)};
 
+  cl::opt<bool> dumpConstants{
+      "dump-constants",
+      cl::desc("Dump the constants of the executable and the offsets of their "
+               "data in the executable"),
+      cl::init(false)};
+
   cl::opt<std::string> outputSplitMarker{
       "output-split-marker",
       llvm::cl::desc("Split marker to use for merging the ouput"),
@@ -105,11 +116,75 @@ struct Options {
       cl::values(clEnumValN(Lua, "lua", "interpret the input as Lua code")),
       cl::values(clEnumValN(ExecutorRuntimeExecutable, "rtexe",
                             "load the input file as an Executor executable"))};
+
+  cl::opt<bool> nativeBackend{
+      "native-backend",
+      cl::desc("Run the native code embedded in the executable (see "
+               "-embed-native-code) instead of its Lua code"),
+      cl::init(false)};
+
+  cl::opt<std::string> profileOutputFilename{
+      "profile-output",
+      cl::desc("Profile the runtime builtins invoked by the program and write "
+               "a Chrome trace of the calls to the given file"),
+      cl::value_desc("filename"), cl::init("")};
+
+  cl::opt<bool> profileSummary{
+      "profile-summary",
+      cl::desc("Profile the runtime builtins invoked by the program and print "
+               "a summary of the calls to stderr"),
+      cl::init(false)};
+
+  cl::opt<bool> benchmark{
+      "benchmark",
+      cl::desc("Instead of running 'main' once, measure the latency of a "
+               "function of the executable and print the results as JSON"),
+      cl::init(false)};
+
+  cl::opt<std::string> benchmarkFunction{
+      "benchmark-function", cl::desc("The function to benchmark"),
+      cl::init("main")};
+
+  cl::opt<unsigned> benchmarkWarmupIterations{
+      "benchmark-warmup-iterations",
+      cl::desc("The number of untimed executions before the timed ones"),
+      cl::init(10)};
+
+  cl::opt<unsigned> benchmarkIterations{
+      "benchmark-iterations", cl::desc("The number of timed executions"),
+      cl::init(100)};
+
+  cl::opt<BenchmarkInputInit> benchmarkInputs{
+      "benchmark-inputs", cl::init(BenchmarkInputInit::Random),
+      cl::desc("How to initialize the inputs of the benchmarked function"),
+      cl::values(clEnumValN(BenchmarkInputInit::Zeros, "zeros",
+                            "fill the inputs with zeros")),
+      cl::values(clEnumValN(BenchmarkInputInit::Random, "random",
+                            "fill the inputs with random values")),
+      cl::values(clEnumValN(BenchmarkInputInit::File, "file",
+                            "read the inputs from --benchmark-input-file"))};
+
+  cl::list<std::string> benchmarkInputFiles{
+      "benchmark-input-file",
+      cl::desc("A file with the raw contents of an input argument; given "
+               "once per input argument in order"),
+      cl::value_desc("filename")};
+
+  cl::opt<unsigned> benchmarkSeed{
+      "benchmark-seed", cl::desc("The seed of random benchmark inputs"),
+      cl::init(0)};
 };
 } // namespace
 
 static LogicalResult initializeCudaRuntime() {
 #ifdef MLIR_EXECUTOR_ENABLE_CUDA
+  // Host-only programs can still run on a machine without a GPU.
+  int numDevices = 0;
+  if (cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0) {
+    (void)cudaGetLastError();
+    return success();
+  }
+
   int device = 0;
   // Context must be created for the correct device we will be using in this
   // process. Currently, assume direct mapping from local rank -> device.
@@ -137,6 +212,31 @@ static LogicalResult initializeCudaRuntime() {
   return success();
 }
 
+/// Measure the latency of a function of `executable` and print the results to
+/// `os`.
+static mlirtrt::Status benchmarkExecutable(
+    std::unique_ptr<mlirtrt::runtime::Executable> executable,
+    const BenchmarkOptions &options,
+    LuaRuntimeSession::LuaModuleRegistrationFunc registerExtraLuaFuncs,
+    llvm::raw_ostream &os) {
+  MTRT_ASSIGN_OR_RETURN(std::unique_ptr<RuntimeClient> client,
+                        RuntimeClient::create());
+#ifdef MLIR_EXECUTOR_ENABLE_NCCL
+  MTRT_ASSIGN_OR_RETURN(RuntimeSessionOptions sessionOptions,
+                        RuntimeSessionOptions::createUsingSingleHostMpi());
+#else
+  RuntimeSessionOptions sessionOptions;
+#endif
+  MTRT_ASSIGN_OR_RETURN(
+      std::unique_ptr<LuaRuntimeSession> session,
+      LuaRuntimeSession::create(sessionOptions, executable->getView(),
+                                std::move(registerExtraLuaFuncs)));
+  MTRT_ASSIGN_OR_RETURN(BenchmarkResult result,
+                        runBenchmark(*client, *session, options));
+  printBenchmarkResult(os, result);
+  return getOkStatus();
+}
+
 LogicalResult executor::ExecutorRunnerMain(
     int argc, char **argv, std::function<void()> postInitCallback,
     mlirtrt::runtime::LuaRuntimeSession::LuaModuleRegistrationFunc
@@ -188,15 +288,27 @@ LogicalResult executor::ExecutorRunnerMain(
   if (failed(initializeCudaRuntime()))
     return failure();
 
+  std::unique_ptr<RuntimeProfiler> profiler;
+  if (!options.profileOutputFilename.empty() || options.profileSummary)
+    profiler = std::make_unique<RuntimeProfiler>();
+
   // Read the buffer as a Lua script and execute.
   auto processBuffer = [&](std::unique_ptr<llvm::MemoryBuffer> input,
                            llvm::raw_ostream &os) -> LogicalResult {
     if (options.inputType == Lua) {
+      if (options.benchmark)
+        return emitError(UnknownLoc::get(&context))
+               << "--benchmark requires an executable input";
+      if (options.nativeBackend)
+        return emitError(UnknownLoc::get(&context))
+               << "--native-backend requires an executable input";
       assert(!options.dumpFunctionSignature &&
              "Can not dump function signature for Lua input type.");
+      assert(!options.dumpConstants &&
+             "Can not dump constants for Lua input type.");
       mlirtrt::StatusOr<int64_t> result =
-          mlirtrt::runtime::runExecutorLuaScript(input->getBuffer(),
-                                                 registerExtraLuaFuncs);
+          mlirtrt::runtime::runExecutorLuaScript(
+              input->getBuffer(), registerExtraLuaFuncs, profiler.get());
       if (!result.isOk())
         return emitError(UnknownLoc::get(&context)) << result.getString();
       return success(*result == 0);
@@ -224,9 +336,63 @@ LogicalResult executor::ExecutorRunnerMain(
       return success();
     }
 
+    if (options.dumpConstants) {
+      // Constants that share data have the same offset.
+      auto *base = static_cast<const char *>(
+          executable->get()->getStorage()->data());
+      for (mlirtrt::runtime::ConstantView constant :
+           executable->get()->getConstants()) {
+        mlirtrt::runtime::print(llvm::outs(), constant);
+        llvm::outs() << " at offset "
+                     << reinterpret_cast<const char *>(constant.data()) - base
+                     << "\n";
+      }
+      return success();
+    }
+
+    if (options.nativeBackend) {
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+      if (options.benchmark || profiler)
+        return emitError(UnknownLoc::get(&context))
+               << "--native-backend does not support benchmarking or "
+                  "profiling";
+      mlirtrt::StatusOr<int64_t> executionResult =
+          mlirtrt::runtime::runExecutorExecutableWithNativeBackend(
+              std::move(*executable));
+      if (!executionResult.isOk())
+        return emitError(UnknownLoc::get(&context))
+               << "failed to load and run executable: "
+               << executionResult.getString();
+      return success();
+#else
+      return emitError(UnknownLoc::get(&context))
+             << "--native-backend requires a runtime built with native "
+                "backend support (MLIR_EXECUTOR_TARGET_NATIVE=OFF)";
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
+    }
+
+    if (options.benchmark) {
+      BenchmarkOptions benchmarkOptions;
+      benchmarkOptions.functionName = options.benchmarkFunction;
+      benchmarkOptions.numWarmupIterations = options.benchmarkWarmupIterations;
+      benchmarkOptions.numIterations = options.benchmarkIterations;
+      benchmarkOptions.inputInit = options.benchmarkInputs;
+      benchmarkOptions.inputFiles.assign(options.benchmarkInputFiles.begin(),
+                                         options.benchmarkInputFiles.end());
+      benchmarkOptions.seed = options.benchmarkSeed;
+      mlirtrt::Status status =
+          benchmarkExecutable(std::move(*executable), benchmarkOptions,
+                              registerExtraLuaFuncs, os);
+      if (!status.isOk())
+        return emitError(UnknownLoc::get(&context))
+               << "failed to benchmark executable: " << status.getString();
+      return success();
+    }
+
     mlirtrt::StatusOr<int64_t> executionResult =
         mlirtrt::runtime::runExecutorExecutable(
-            std::move(*executable), std::move(registerExtraLuaFuncs));
+            std::move(*executable), std::move(registerExtraLuaFuncs),
+            profiler.get());
     if (!executionResult.isOk())
       return emitError(UnknownLoc::get(&context))
              << "failed to load and run executable: "
@@ -240,5 +406,17 @@ LogicalResult executor::ExecutorRunnerMain(
                                          options.outputSplitMarker)))
     return failure();
   output->keep();
+
+  if (profiler && options.profileSummary)
+    profiler->printSummary(llvm::errs());
+  if (profiler && !options.profileOutputFilename.empty()) {
+    std::unique_ptr<llvm::ToolOutputFile> traceOutput =
+        openOutputFile(options.profileOutputFilename, &errorMessage);
+    if (!traceOutput)
+      return emitError(loc)
+             << "failed to open profile output file: " << errorMessage;
+    profiler->printChromeTrace(traceOutput->os());
+    traceOutput->keep();
+  }
   return success();
 }
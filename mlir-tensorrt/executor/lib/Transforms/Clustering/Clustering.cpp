@@ -24,8 +24,10 @@
 #include "mlir/IR/OpDefinition.h"
 #include "mlir/Transforms/OneToNTypeConversion.h"
 #include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/MapVector.h"
 
 #include <algorithm>
+#include <limits>
 #include <queue>
 
 #define DEBUG_TYPE "clustering"
@@ -263,46 +265,223 @@ void mlir::runBFSClustering(
   }
 }
 
+namespace {
+/// A graph over the clusters of a block that is used to merge independent
+/// clusters. The nodes are the clusters and the position of a node is the
+/// position of its root in the block. Since a cluster is materialized at its
+/// root, merging a producer cluster into a later consumer cluster is legal iff
+/// no user of the producer outside of the two clusters is placed before the
+/// consumer root (see `obeyDominanceProperty`). A user in another cluster of
+/// the block is placed at the root of that cluster, any other user at its
+/// ancestor in the block.
+///
+/// Each node keeps the placements of its users in a min-heap, so the legality
+/// check is a comparison of the top of the heap with the consumer position.
+/// Merges only move user clusters to later positions, so stale entries are
+/// updated lazily once they reach the top of the heap, and heaps are merged
+/// smaller into larger.
+class BlockClusterGraph {
+public:
+  BlockClusterGraph(ClusteringState &state, Block *block,
+                    ArrayRef<Operation *> roots);
+
+  /// Merge each cluster with the following clusters of the block for which
+  /// the merge is legal and `shouldTryMergeClusters` returns true. Returns
+  /// true if any clusters were merged.
+  bool mergeClusters(ShouldMergeIndependentClustersFn shouldTryMergeClusters);
+
+private:
+  static constexpr unsigned kNoNode = std::numeric_limits<unsigned>::max();
+
+  /// A user placement: the position in the block and the user node, or
+  /// `kNoNode` for users that are not in a cluster of the block.
+  using Placement = std::pair<int64_t, unsigned>;
+
+  unsigned findLeader(unsigned node);
+
+  /// Return the earliest position of a user of `node` outside of its cluster.
+  int64_t getFirstUserPosition(unsigned node);
+
+  /// Merge the cluster `producer` into the later cluster `consumer`.
+  void merge(unsigned producer, unsigned consumer);
+
+  ClusterRange getCluster(unsigned node) const {
+    return llvm::make_range(state.ec.findLeader(roots[node]),
+                            state.ec.member_end());
+  }
+
+  ClusteringState &state;
+
+  /// The root operation and its position in the block of each node. The
+  /// consumer remains the leader of merged clusters, so the root of a node
+  /// that leads a cluster does not change.
+  SmallVector<Operation *> roots;
+  SmallVector<int64_t> positions;
+
+  /// The union-find forest of the nodes.
+  SmallVector<unsigned> leaders;
+
+  /// The min-heap of user placements of each leader node.
+  SmallVector<SmallVector<Placement, 0>> users;
+
+  /// A doubly linked list of the leader nodes in block order.
+  SmallVector<unsigned> next;
+  SmallVector<unsigned> prev;
+  unsigned head = 0;
+};
+} // namespace
+
+BlockClusterGraph::BlockClusterGraph(ClusteringState &state, Block *block,
+                                     ArrayRef<Operation *> blockRoots)
+    : state(state), roots(blockRoots.begin(), blockRoots.end()) {
+  DenseMap<Operation *, int64_t> opPositions;
+  for (auto [idx, op] : llvm::enumerate(*block))
+    opPositions[&op] = idx;
+
+  DenseMap<Operation *, unsigned> nodes;
+  for (auto [idx, root] : llvm::enumerate(roots)) {
+    nodes[root] = idx;
+    positions.push_back(opPositions.lookup(root));
+    leaders.push_back(idx);
+    next.push_back(idx + 1 < roots.size() ? idx + 1 : kNoNode);
+    prev.push_back(idx > 0 ? idx - 1 : kNoNode);
+  }
+  head = roots.empty() ? kNoNode : 0;
+
+  users.resize(roots.size());
+  for (unsigned idx = 0, e = roots.size(); idx < e; ++idx) {
+    Operation *root = roots[idx];
+    SmallVector<Placement, 0> &placements = users[idx];
+    state.runOnEquivalenceClass(root, [&](Operation *member, Operation *) {
+      for (Operation *user : member->getUsers()) {
+        auto userRootIt = state.ec.findLeader(user);
+        if (userRootIt != state.ec.member_end()) {
+          if (*userRootIt == root)
+            continue;
+          if ((*userRootIt)->getBlock() == block) {
+            unsigned userNode = nodes.lookup(*userRootIt);
+            placements.emplace_back(positions[userNode], userNode);
+            continue;
+          }
+        }
+        if (Operation *ancestor = block->findAncestorOpInBlock(*user)) {
+          placements.emplace_back(opPositions.lookup(ancestor), kNoNode);
+          continue;
+        }
+        // A user outside of the block is legal for any consumer iff the block
+        // dominates it.
+        if (!state.domInfo.properlyDominates(member, user))
+          placements.emplace_back(std::numeric_limits<int64_t>::min(),
+                                  kNoNode);
+      }
+    });
+    // A sorted range is a valid min-heap.
+    llvm::sort(placements);
+    placements.erase(std::unique(placements.begin(), placements.end()),
+                     placements.end());
+  }
+}
+
+unsigned BlockClusterGraph::findLeader(unsigned node) {
+  while (leaders[node] != node) {
+    leaders[node] = leaders[leaders[node]];
+    node = leaders[node];
+  }
+  return node;
+}
+
+int64_t BlockClusterGraph::getFirstUserPosition(unsigned node) {
+  SmallVector<Placement, 0> &heap = users[node];
+  while (!heap.empty()) {
+    auto [position, user] = heap.front();
+    if (user == kNoNode)
+      return position;
+    unsigned userLeader = findLeader(user);
+    if (userLeader != node && positions[userLeader] == position)
+      return position;
+    // The user cluster was merged, either into a later cluster or into this
+    // one. Update or drop the placement.
+    std::pop_heap(heap.begin(), heap.end(), std::greater<Placement>());
+    heap.pop_back();
+    if (userLeader == node)
+      continue;
+    heap.emplace_back(positions[userLeader], userLeader);
+    std::push_heap(heap.begin(), heap.end(), std::greater<Placement>());
+  }
+  return std::numeric_limits<int64_t>::max();
+}
+
+void BlockClusterGraph::merge(unsigned producer, unsigned consumer) {
+  state.ec.unionSets(roots[consumer], roots[producer]);
+  leaders[producer] = consumer;
+
+  if (prev[producer] != kNoNode)
+    next[prev[producer]] = next[producer];
+  else
+    head = next[producer];
+  if (next[producer] != kNoNode)
+    prev[next[producer]] = prev[producer];
+
+  if (users[consumer].size() < users[producer].size())
+    std::swap(users[consumer], users[producer]);
+  SmallVector<Placement, 0> &heap = users[consumer];
+  for (const Placement &placement : users[producer]) {
+    heap.push_back(placement);
+    std::push_heap(heap.begin(), heap.end(), std::greater<Placement>());
+  }
+  users[producer] = {};
+}
+
+bool BlockClusterGraph::mergeClusters(
+    ShouldMergeIndependentClustersFn shouldTryMergeClusters) {
+  bool changed = false;
+  // Nodes that are merged keep their `next` link, so the walk may visit nodes
+  // that are no longer leaders.
+  for (unsigned node = head; node != kNoNode; node = next[node]) {
+    if (leaders[node] != node)
+      continue;
+    unsigned current = node;
+    int64_t firstUserPosition = getFirstUserPosition(current);
+    // Any later cluster is placed after a user of the current cluster, so
+    // merging with it would create a cycle.
+    for (unsigned other = next[current];
+         other != kNoNode && positions[other] <= firstUserPosition;
+         other = next[other]) {
+      if (!shouldTryMergeClusters(roots[current], getCluster(current),
+                                  roots[other], getCluster(other)))
+        continue;
+      LLVM_DEBUG(DBGS() << "[Target: " << state.opts.clusterTarget
+                        << "] combined clusters " << current << ", " << other
+                        << "\n");
+      merge(current, other);
+      changed = true;
+      current = other;
+      firstUserPosition = getFirstUserPosition(current);
+    }
+  }
+  return changed;
+}
+
 void mlir::mergeIndependentClusters(
     ClusteringState &state,
     ShouldMergeIndependentClustersFn shouldTryMergeClusters) {
   assert(shouldTryMergeClusters &&
          "expected valid function shouldTryMergeClusters");
-  // This function loops over all clusters and tries to merges them, then does
-  // it again until a fixed point is reached. In certain situations, one trip
-  // through all pairs won't merge all clusters (ie. after trip through all
-  // pairs of clusters, the changes made will open up new merging
-  // opportunities), which is why we need to do it repeatedly.
-  bool numClustersChanged = true;
-  while (numClustersChanged) {
-    numClustersChanged = false;
-    SmallVector<Operation *> allRoots = state.getClusterRoots(/*sorted=*/true);
+  // Only clusters of the same block can be merged, and merges in one block do
+  // not affect the others.
+  llvm::MapVector<Block *, SmallVector<Operation *>> blockRoots;
+  for (Operation *root : state.getClusterRoots(/*sorted=*/true))
+    blockRoots[root->getBlock()].push_back(root);
+
+  for (auto &[block, roots] : blockRoots) {
     LLVM_DEBUG(DBGS() << "[Target: " << state.opts.clusterTarget
-                      << "] Attempting to merge all pairs of clusters\n");
-    for (size_t i = 0; i < allRoots.size(); ++i) {
-      // Roots may have changed in previous iteration.
-      if (state.ec.getLeaderValue(allRoots[i]) != allRoots[i])
-        continue;
-      for (size_t j = i + 1; j < allRoots.size(); ++j) {
-        // Roots may have changed in previous iteration.
-        if (state.ec.getLeaderValue(allRoots[j]) != allRoots[j])
-          continue;
-        if (shouldTryMergeClusters &&
-            !shouldTryMergeClusters(
-                allRoots[i],
-                llvm::make_range(state.ec.findLeader(allRoots[i]),
-                                 state.ec.member_end()),
-                allRoots[j],
-                llvm::make_range(state.ec.findLeader(allRoots[j]),
-                                 state.ec.member_end())))
-          continue;
-        if (succeeded(state.unionClusters(allRoots[i], allRoots[j]))) {
-          numClustersChanged = true;
-          LLVM_DEBUG(DBGS()
-                     << "[Target: " << state.opts.clusterTarget
-                     << "] combined clusters " << i << ", " << j << "\n");
-        }
-      }
+                      << "] Attempting to merge " << roots.size()
+                      << " clusters of a block\n");
+    BlockClusterGraph graph(state, block, roots);
+    // One trip through all clusters won't necessarily merge all clusters (ie.
+    // the changes made will open up new merging opportunities), which is why
+    // we need to do it until a fixed point is reached.
+    while (graph.mergeClusters(shouldTryMergeClusters)) {
     }
   }
 }
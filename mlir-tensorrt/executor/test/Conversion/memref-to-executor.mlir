@@ -317,6 +317,33 @@ func.func @reinterpret_cast_memref_dynamic(
 
 // -----
 
+func.func @memref_view(%arg0: memref<1024xi8, #executor.memory_type<device>>,
+                       %arg1: index, %arg2: index)
+    -> memref<?x4xf32, #executor.memory_type<device>> {
+  %0 = memref.view %arg0[%arg1][%arg2]
+    : memref<1024xi8, #executor.memory_type<device>> to memref<?x4xf32, #executor.memory_type<device>>
+  return %0 : memref<?x4xf32, #executor.memory_type<device>>
+}
+
+// CHECK-LABEL: @memref_view
+//  CHECK-SAME: (%[[arg0:.+]]: memref<1024xi8, {{.*}}>, %[[arg1:.+]]: index, %[[arg2:.+]]: index)
+//   CHECK-DAG:     %[[c0_i32:.+]] = executor.constant 0 : i32
+//   CHECK-DAG:     %[[c1_i32:.+]] = executor.constant 1 : i32
+//   CHECK-DAG:     %[[c4_i32:.+]] = executor.constant 4 : i32
+//   CHECK-DAG:     %[[v0:.+]] = builtin.unrealized_conversion_cast %[[arg0]] :
+//   CHECK-DAG:     %[[v1:.+]] = builtin.unrealized_conversion_cast %[[arg1]] : index to i32
+//   CHECK-DAG:     %[[v2:.+]] = builtin.unrealized_conversion_cast %[[arg2]] : index to i32
+//   CHECK-DAG:     %[[v3:.+]] = executor.table.get %[[v0]][0] :
+//   CHECK-DAG:     %[[v4:.+]] = executor.table.get %[[v0]][1] :
+//       CHECK:     %[[v5:.+]] = executor.ptrtoint %[[v4]] : (!executor.ptr<device>) -> i32
+//       CHECK:     %[[v6:.+]] = executor.addi %[[v5]], %[[v1]] : i32
+//       CHECK:     %[[v7:.+]] = executor.inttoptr %[[v6]] : (i32) -> !executor.ptr<device>
+//       CHECK:     %[[v8:.+]] = executor.table.create(%[[v3]], %[[v7]], %[[c0_i32]], %[[v2]], %[[c4_i32]], %[[c4_i32]], %[[c1_i32]] :
+//       CHECK:     %[[v9:.+]] = builtin.unrealized_conversion_cast %[[v8]]
+//       CHECK:     return %[[v9]] :
+
+// -----
+
 func.func @dynamic_copy(%arg0: memref<?x?xi32, #executor.memory_type<host>>, %arg1: memref<?x?xi32, #executor.memory_type<host>>) {
   memref.copy %arg0, %arg1 : memref<?x?xi32, #executor.memory_type<host>> to memref<?x?xi32, #executor.memory_type<host>>
   return
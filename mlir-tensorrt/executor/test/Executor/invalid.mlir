@@ -308,3 +308,17 @@ func.func @coro_await() -> (i32) {
   %0:2 = executor.coro_await %coro (%c0, %c0_f32 : i32, f32) : (f32, i32) -> i32
   return %0#1 : i32
 }
+
+// -----
+
+// expected-error @below {{Output alias 1 does not refer to an input argument}}
+func.func public @main(%arg0: memref<1xf32>, %arg1: memref<1xf32>) attributes {executor.function_metadata = #executor.func_meta<[memref<1xf32>, memref<1xf32>], [], num_output_args = 1, output_aliases = array<i64: 1>>} {
+  return
+}
+
+// -----
+
+// expected-error @below {{Input argument 0 is donated to more than one output argument}}
+func.func public @main(%arg0: memref<1xf32>, %arg1: memref<1xf32>, %arg2: memref<1xf32>) attributes {executor.function_metadata = #executor.func_meta<[memref<1xf32>, memref<1xf32>, memref<1xf32>], [], num_output_args = 2, output_aliases = array<i64: 0, 0>>} {
+  return
+}
@@ -557,6 +557,20 @@ func.func @func_metadata3(%arg0: !executor.table<i32, i32>) -> i32 attributes {
 
 // -----
 
+func.func @func_metadata_output_aliases(
+  %arg0: !executor.ptr<device>, %arg1: !executor.ptr<device>, %arg2: i64,
+  %arg3: !executor.ptr<device>, %arg4: !executor.ptr<device>, %arg5: i64) attributes {
+    executor.function_metadata = #executor.func_meta<[memref<4xf32>, memref<4xf32>], [],
+                                                      num_output_args=1, output_aliases=array<i64: 0>>
+} {
+  return
+}
+
+// CHECK-LABEL: @func_metadata_output_aliases
+//  CHECK-SAME: #executor.func_meta<[memref<4xf32>, memref<4xf32>], [], num_output_args = 1, output_aliases = array<i64: 0>>
+
+// -----
+
 func.func @func_metadata4(%arg0: i32, %arg1: i32) -> i32 attributes {
     executor.function_metadata = #executor.func_meta<[i32, i32], [i32], num_output_args=1>
 } {
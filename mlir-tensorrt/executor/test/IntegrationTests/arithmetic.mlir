@@ -7,6 +7,9 @@
 // RUN: executor-translate -mlir-to-runtime-executable %t.mlir \
 // RUN:   | executor-runner -input-type=rtexe | FileCheck %s
 
+// RUN: executor-translate -mlir-to-runtime-executable -lua-native-arithmetic \
+// RUN:   %t.mlir | executor-runner -input-type=rtexe | FileCheck %s
+
 func.func @test_addi(%arg0: i64, %arg1: i64) {
   %0 = executor.addi %arg0, %arg1 : i64
   executor.print "%d addi %d = %d"(%arg0, %arg1, %0 : i64, i64, i64)
@@ -294,3 +294,23 @@ func.func @nested_clusters(%arg0: tensor<10xf32>,
 //       MERGE: call @cluster_5
 //       MERGE: return
 
+
+// -----
+
+// Clusters 0 and 1 are merged, but the result cannot be merged with cluster 2
+// since a user of cluster 0 is placed between them.
+
+func.func @merge_independent_clusters_user_between(%arg0: tensor<10xf32>)
+    -> (tensor<10xf32>, tensor<10xf32>) {
+  %0 = arith.addf %arg0, %arg0 {__cluster_id__ = 0 : i64} : tensor<10xf32>
+  %1 = arith.mulf %arg0, %arg0 {__cluster_id__ = 1 : i64} : tensor<10xf32>
+  %2 = "some_dialect.some_op"(%0) : (tensor<10xf32>) -> tensor<10xf32>
+  %3 = arith.addf %2, %1 {__cluster_id__ = 2 : i64} : tensor<10xf32>
+  return %3, %1 : tensor<10xf32>, tensor<10xf32>
+}
+
+// ONLYM-LABEL: @merge_independent_clusters_user_between
+//  ONLYM-NEXT:   %[[v0:.+]]:2 = call @cluster(
+//  ONLYM-NEXT:   %[[v1:.+]] = "some_dialect.some_op"(%[[v0]]#0)
+//  ONLYM-NEXT:   %[[v2:.+]] = call @cluster_0(
+//  ONLYM-NEXT:   return %[[v2]], %[[v0]]#1
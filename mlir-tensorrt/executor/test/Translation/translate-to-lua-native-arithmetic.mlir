@@ -0,0 +1,172 @@
+// RUN:  executor-opt %s -split-input-file -executor-lower-to-runtime-builtins | \
+// RUN:   executor-translate -mlir-to-lua -lua-native-arithmetic | FileCheck %s
+
+// RUN:  executor-opt %s -split-input-file -executor-lower-to-runtime-builtins | \
+// RUN:   executor-translate -mlir-to-runtime-executable -lua-native-arithmetic
+
+func.func @icmp_slt_i64(%arg0: i64, %arg1: i64) -> i1
+  attributes{executor.function_metadata=#executor.func_meta<[i64, i64],[i1], num_output_args = 0>}{
+  %0 = executor.icmp <slt> %arg0, %arg1 : i64
+  return %0 : i1
+}
+// CHECK-LABEL: function icmp_slt_i64
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = (([[v1]] < [[v2]]) and 1 or 0);
+//  CHECK-NEXT:     return [[v3]];
+//  CHECK-NEXT: end
+
+// -----
+
+func.func @icmp_ult_i32(%arg0: i32, %arg1: i32) -> i1
+  attributes{executor.function_metadata=#executor.func_meta<[i32, i32],[i1], num_output_args = 0>}{
+  %0 = executor.icmp <ult> %arg0, %arg1 : i32
+  return %0 : i1
+}
+// CHECK-LABEL: function icmp_ult_i32
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = ((([[v1]] & 0xFFFFFFFF) < ([[v2]] & 0xFFFFFFFF)) and 1 or 0);
+
+// -----
+
+func.func @icmp_ugt_i64(%arg0: i64, %arg1: i64) -> i1
+  attributes{executor.function_metadata=#executor.func_meta<[i64, i64],[i1], num_output_args = 0>}{
+  %0 = executor.icmp <ugt> %arg0, %arg1 : i64
+  return %0 : i1
+}
+// CHECK-LABEL: function icmp_ugt_i64
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = ((([[v1]] ~ 0x8000000000000000) > ([[v2]] ~ 0x8000000000000000)) and 1 or 0);
+
+// -----
+
+func.func @fcmp_uge_f64(%arg0: f64, %arg1: f64) -> i1
+  attributes{executor.function_metadata=#executor.func_meta<[f64, f64],[i1], num_output_args = 0>}{
+  %0 = executor.fcmp <uge> %arg0, %arg1 : f64
+  return %0 : i1
+}
+// CHECK-LABEL: function fcmp_uge_f64
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = ((not ([[v1]] < [[v2]])) and 1 or 0);
+
+// -----
+
+func.func @select_i64(%arg0: i1, %arg1: i64, %arg2: i64) -> i64
+  attributes{executor.function_metadata=#executor.func_meta<[i1, i64, i64],[i64], num_output_args = 0>}{
+  %0 = executor.select %arg0, %arg1, %arg2 : i64
+  return %0 : i64
+}
+// CHECK-LABEL: function select_i64
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]], [[v3:.+]])
+//  CHECK-NEXT:     local [[v4:.+]] <const> = ([[v1]] ~= 0) and [[v2]] or [[v3]];
+
+// -----
+
+func.func @sdivi_i32(%arg0: i32, %arg1: i32) -> i32
+  attributes{executor.function_metadata=#executor.func_meta<[i32, i32],[i32], num_output_args = 0>}{
+  %0 = executor.sdivi %arg0, %arg1 : i32
+  return %0 : i32
+}
+// CHECK-LABEL: function sdivi_i32
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = [[v1]] // [[v2]] + ((([[v1]] % [[v2]] ~= 0) and (([[v1]] ~ [[v2]]) < 0)) and 1 or 0);
+
+// -----
+
+func.func @shift_left_i32(%arg0: i32, %arg1: i32) -> i32
+  attributes{executor.function_metadata=#executor.func_meta<[i32, i32],[i32], num_output_args = 0>}{
+  %0 = executor.shift_lefti %arg0, %arg1 : i32
+  return %0 : i32
+}
+// CHECK-LABEL: function shift_left_i32
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = (((([[v1]] << [[v2]]) + 0x80000000) & 0xFFFFFFFF) - 0x80000000);
+
+// -----
+
+func.func @shift_right_arithmetic_i64(%arg0: i64, %arg1: i64) -> i64
+  attributes{executor.function_metadata=#executor.func_meta<[i64, i64],[i64], num_output_args = 0>}{
+  %0 = executor.shift_right_arithmetici %arg0, %arg1 : i64
+  return %0 : i64
+}
+// CHECK-LABEL: function shift_right_arithmetic_i64
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = ([[v1]] >= 0) and ([[v1]] >> [[v2]]) or ~(~[[v1]] >> [[v2]]);
+
+// -----
+
+func.func @bitwise_andi_i1(%arg0: i1, %arg1: i1) -> i1
+  attributes{executor.function_metadata=#executor.func_meta<[i1, i1],[i1], num_output_args = 0>}{
+  %0 = executor.bitwise_andi %arg0, %arg1 : i1
+  return %0 : i1
+}
+// CHECK-LABEL: function bitwise_andi_i1
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = [[v1]] & [[v2]];
+
+// -----
+
+func.func @max_f32(%arg0: f32, %arg1: f32) -> f32
+  attributes{executor.function_metadata=#executor.func_meta<[f32, f32],[f32], num_output_args = 0>}{
+  %0 = executor.fmax %arg0, %arg1 : f32
+  return %0 : f32
+}
+// CHECK-LABEL: function max_f32
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = ([[v1]] < [[v2]]) and [[v2]] or [[v1]];
+
+// -----
+
+func.func @min_i64(%arg0: i64, %arg1: i64) -> i64
+  attributes{executor.function_metadata=#executor.func_meta<[i64, i64],[i64], num_output_args = 0>}{
+  %0 = executor.smin %arg0, %arg1 : i64
+  return %0 : i64
+}
+// CHECK-LABEL: function min_i64
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = ([[v2]] < [[v1]]) and [[v2]] or [[v1]];
+
+// -----
+
+func.func @sitofp_i32_f64(%arg0: i32) -> f64
+  attributes{executor.function_metadata=#executor.func_meta<[i32],[f64], num_output_args = 0>}{
+  %0 = executor.sitofp %arg0 : i32 to f64
+  return %0 : f64
+}
+// CHECK-LABEL: function sitofp_i32_f64
+//  CHECK-SAME: ([[v1:.+]])
+//  CHECK-NEXT:     local [[v2:.+]] <const> = [[v1]] + 0.0;
+
+// -----
+
+// Types that need C++ semantics keep using the runtime builtins.
+
+func.func @sitofp_i32_f32(%arg0: i32) -> f32
+  attributes{executor.function_metadata=#executor.func_meta<[i32],[f32], num_output_args = 0>}{
+  %0 = executor.sitofp %arg0 : i32 to f32
+  return %0 : f32
+}
+// CHECK-LABEL: function sitofp_i32_f32
+//  CHECK-SAME: ([[v1:.+]])
+//  CHECK-NEXT:     local [[v2:.+]] <const> = _sitofp_i32_f32([[v1]]);
+
+// -----
+
+func.func @max_f16(%arg0: f16, %arg1: f16) -> f16
+  attributes{executor.function_metadata=#executor.func_meta<[f16, f16],[f16], num_output_args = 0>}{
+  %0 = executor.fmax %arg0, %arg1 : f16
+  return %0 : f16
+}
+// CHECK-LABEL: function max_f16
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = _fmax_f16([[v1]], [[v2]]);
+
+// -----
+
+func.func @divf_f32(%arg0: f32, %arg1: f32) -> f32
+  attributes{executor.function_metadata=#executor.func_meta<[f32, f32],[f32], num_output_args = 0>}{
+  %0 = executor.divf %arg0, %arg1 : f32
+  return %0 : f32
+}
+// CHECK-LABEL: function divf_f32
+//  CHECK-SAME: ([[v1:.+]], [[v2:.+]])
+//  CHECK-NEXT:     local [[v3:.+]] <const> = _divf_f32([[v1]], [[v2]]);
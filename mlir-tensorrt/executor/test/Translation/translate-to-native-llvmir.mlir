@@ -0,0 +1,182 @@
+// REQUIRES: native-backend
+// RUN:  executor-opt %s -split-input-file -executor-lower-to-runtime-builtins | \
+// RUN:   executor-translate -split-input-file -mlir-to-native-llvmir | FileCheck %s
+
+// RUN:  executor-opt %s -split-input-file -executor-lower-to-runtime-builtins | \
+// RUN:   executor-translate -split-input-file -mlir-to-runtime-executable -embed-native-code
+
+func.func @sfloor_divi(%arg0: i64, %arg1: i64) -> i64
+  attributes{executor.function_metadata=#executor.func_meta<[i64, i64],[i64], num_output_args = 0>}{
+  %0 = executor.sfloor_divi %arg0, %arg1 : i64
+  return %0 : i64
+}
+
+// CHECK-LABEL: define i64 @sfloor_divi
+//  CHECK-SAME: (i64 %[[v0:.+]], i64 %[[v1:.+]])
+//       CHECK:   %[[nz:.+]] = icmp ne i64 %[[v1]], 0
+//       CHECK:   br i1 %[[nz]]
+//       CHECK:   call void @__executor_native_assert_fail
+//       CHECK:   icmp eq i64 %[[v0]], -9223372036854775808
+//       CHECK:   icmp eq i64 %[[v1]], -1
+//       CHECK:   call void @__executor_native_assert_fail
+//       CHECK:   %[[rem:.+]] = srem i64 %[[v0]], %[[v1]]
+//       CHECK:   %[[div:.+]] = sdiv i64 %[[v0]], %[[v1]]
+//       CHECK:   %[[res:.+]] = sub i64 %[[div]], %{{.+}}
+//       CHECK:   ret i64 %[[res]]
+
+// CHECK-LABEL: define void @__executor_native_iface_sfloor_divi
+//  CHECK-SAME: (ptr %[[args:.+]], ptr %[[results:.+]])
+//       CHECK:   %[[a0:.+]] = load i64, ptr %{{.+}}
+//       CHECK:   %[[p1:.+]] = getelementptr inbounds i64, ptr %[[args]], i64 1
+//       CHECK:   %[[a1:.+]] = load i64, ptr %[[p1]]
+//       CHECK:   %[[r:.+]] = call i64 @sfloor_divi(i64 %[[a0]], i64 %[[a1]])
+//       CHECK:   store i64 %[[r]], ptr %{{.+}}
+//       CHECK:   ret void
+
+// -----
+
+func.func @abs_f32(%arg0 : f32) -> f32
+  attributes{executor.function_metadata=#executor.func_meta<[f32],[f32], num_output_args = 0>}{
+  %0 = executor.absf %arg0 : f32
+  return %0: f32
+}
+
+// CHECK-LABEL: define float @abs_f32
+//  CHECK-SAME: (float %[[v0:.+]])
+//       CHECK:   %[[v1:.+]] = call float @_absf_f32(float %[[v0]])
+//       CHECK:   ret float %[[v1]]
+//       CHECK: declare float @_absf_f32(float)
+
+// -----
+
+func.func @icmp_select(%arg0: i32, %arg1: i32) -> i32
+  attributes{executor.function_metadata=#executor.func_meta<[i32, i32],[i32], num_output_args = 0>}{
+  %0 = executor.icmp <ult> %arg0, %arg1 : i32
+  %1 = executor.select %0, %arg0, %arg1 : i32
+  return %1 : i32
+}
+
+// CHECK-LABEL: define i32 @icmp_select
+//  CHECK-SAME: (i32 %[[v0:.+]], i32 %[[v1:.+]])
+//       CHECK:   %[[v2:.+]] = icmp ult i32 %[[v0]], %[[v1]]
+//       CHECK:   %[[v3:.+]] = select i1 %[[v2]], i32 %[[v0]], i32 %[[v1]]
+//       CHECK:   ret i32 %[[v3]]
+
+// -----
+
+!descriptor = !executor.table<i64, i64, i64, i64>
+
+func.func @dynamic_extract(%arg0: i64, %arg1: i64, %arg2: i64, %arg3: i64, %index: i32) -> (!descriptor, i64)
+    attributes {executor.function_metadata = #executor.func_meta<[i64, i64, i64, i64, i32],[memref<4xi32>, i64], num_output_args = 0>} {
+  %0 = executor.table.create (%arg0, %arg1, %arg2, %arg3 : i64, i64, i64, i64): !descriptor
+  %1 = executor.table.dynamic_get %0[%index] : (!descriptor, i32) -> i64
+  return %0, %1 : !descriptor, i64
+}
+
+// CHECK-LABEL: define { { i64, i64, i64, i64 }, i64 } @dynamic_extract
+//       CHECK:   %[[spill:.+]] = alloca { i64, i64, i64, i64 }
+//       CHECK:   insertvalue { i64, i64, i64, i64 }
+//       CHECK:   store { i64, i64, i64, i64 } %{{.+}}, ptr %[[spill]]
+//       CHECK:   %[[p:.+]] = getelementptr inbounds [4 x i64], ptr %[[spill]], i64 0, i32 %{{.+}}
+//       CHECK:   load i64, ptr %[[p]]
+
+// CHECK-LABEL: define void @__executor_native_iface_dynamic_extract
+//       CHECK:   call { { i64, i64, i64, i64 }, i64 } @dynamic_extract
+//   CHECK-COUNT-5: store i64
+
+// -----
+
+func.func @loop(%arg0: i64) -> i64
+  attributes{executor.function_metadata=#executor.func_meta<[i64],[i64], num_output_args = 0>}{
+  %c0 = executor.constant 0 : i64
+  %c1 = executor.constant 1 : i64
+  cf.br ^bb1(%c0, %c0 : i64, i64)
+^bb1(%i: i64, %acc: i64):
+  %cond = executor.icmp <slt> %i, %arg0 : i64
+  cf.cond_br %cond, ^bb2, ^bb3
+^bb2:
+  %next = executor.addi %i, %c1 : i64
+  %sum = executor.addi %acc, %i : i64
+  cf.br ^bb1(%next, %sum : i64, i64)
+^bb3:
+  return %acc : i64
+}
+
+// CHECK-LABEL: define i64 @loop
+//       CHECK:   br label %[[header:.+]]
+//       CHECK: [[header]]:
+//  CHECK-NEXT:   %[[i:.+]] = phi i64 [ 0, %{{.+}} ], [ %{{.+}}, %{{.+}} ]
+//  CHECK-NEXT:   %[[acc:.+]] = phi i64 [ 0, %{{.+}} ], [ %{{.+}}, %{{.+}} ]
+//       CHECK:   icmp slt i64 %[[i]], %{{.+}}
+
+// -----
+
+func.func @test_assert(%arg0: i1) {
+  executor.assert %arg0, "assertion message"
+  return
+}
+
+// CHECK-LABEL: define void @test_assert
+//  CHECK-SAME: (i1 %[[v0:.+]])
+//       CHECK:   br i1 %[[v0]], label %[[cont:.+]], label %[[fail:.+]]
+//       CHECK: [[fail]]:
+//  CHECK-NEXT:   call void @__executor_native_assert_fail(ptr @{{.+}})
+//  CHECK-NEXT:   unreachable
+//       CHECK: [[cont]]:
+//  CHECK-NEXT:   ret void
+
+// -----
+
+func.func @sdivi_sremi(%arg0: i32, %arg1: i32) -> (i32, i32)
+  attributes{executor.function_metadata=#executor.func_meta<[i32, i32],[i32, i32], num_output_args = 0>}{
+  %0 = executor.sdivi %arg0, %arg1 : i32
+  %1 = executor.sremi %arg0, %arg1 : i32
+  return %0, %1 : i32, i32
+}
+
+// CHECK-LABEL: define { i32, i32 } @sdivi_sremi
+//  CHECK-SAME: (i32 %[[v0:.+]], i32 %[[v1:.+]])
+//       CHECK:   %[[nz:.+]] = icmp ne i32 %[[v1]], 0
+//       CHECK:   br i1 %[[nz]], label %[[cont:.+]], label %[[fail:.+]]
+//       CHECK: [[fail]]:
+//  CHECK-NEXT:   call void @__executor_native_assert_fail(ptr @{{.+}})
+//  CHECK-NEXT:   unreachable
+//       CHECK: [[cont]]:
+//  CHECK-NEXT:   %[[min:.+]] = icmp eq i32 %[[v0]], -2147483648
+//  CHECK-NEXT:   %[[neg1:.+]] = icmp eq i32 %[[v1]], -1
+//  CHECK-NEXT:   %[[ovf:.+]] = and i1 %[[min]], %[[neg1]]
+//  CHECK-NEXT:   %[[ok:.+]] = xor i1 %[[ovf]], true
+//  CHECK-NEXT:   br i1 %[[ok]], label %[[cont1:.+]], label %[[fail1:.+]]
+//       CHECK: [[fail1]]:
+//  CHECK-NEXT:   call void @__executor_native_assert_fail(ptr @{{.+}})
+//  CHECK-NEXT:   unreachable
+//       CHECK: [[cont1]]:
+//  CHECK-NEXT:   %[[div:.+]] = sdiv i32 %[[v0]], %[[v1]]
+//  CHECK-NEXT:   %[[nz2:.+]] = icmp ne i32 %[[v1]], 0
+//  CHECK-NEXT:   br i1 %[[nz2]], label %[[cont2:.+]], label %{{.+}}
+//       CHECK: [[cont2]]:
+//  CHECK-NEXT:   %[[isNeg1:.+]] = icmp eq i32 %[[v1]], -1
+//  CHECK-NEXT:   %[[divisor:.+]] = select i1 %[[isNeg1]], i32 1, i32 %[[v1]]
+//  CHECK-NEXT:   %[[rem:.+]] = srem i32 %[[v0]], %[[divisor]]
+
+// -----
+
+func.func @shifts(%arg0: i32, %arg1: i32) -> (i32, i32, i32)
+  attributes{executor.function_metadata=#executor.func_meta<[i32, i32],[i32, i32, i32], num_output_args = 0>}{
+  %0 = executor.shift_lefti %arg0, %arg1 : i32
+  %1 = executor.shift_right_logicali %arg0, %arg1 : i32
+  %2 = executor.shift_right_arithmetici %arg0, %arg1 : i32
+  return %0, %1, %2 : i32, i32, i32
+}
+
+// CHECK-LABEL: define { i32, i32, i32 } @shifts
+//  CHECK-SAME: (i32 %[[v0:.+]], i32 %[[v1:.+]])
+//       CHECK:   %[[big:.+]] = icmp uge i32 %[[v1]], 32
+//       CHECK:   %[[shl:.+]] = shl i32 %[[v0]], %[[v1]]
+//       CHECK:   select i1 %[[big]], i32 0, i32 %[[shl]]
+//       CHECK:   %[[big1:.+]] = icmp uge i32 %[[v1]], 32
+//       CHECK:   %[[lshr:.+]] = lshr i32 %[[v0]], %[[v1]]
+//       CHECK:   select i1 %[[big1]], i32 0, i32 %[[lshr]]
+//       CHECK:   %[[big2:.+]] = icmp ugt i32 %[[v1]], 31
+//       CHECK:   %[[amount:.+]] = select i1 %[[big2]], i32 31, i32 %[[v1]]
+//       CHECK:   ashr i32 %[[v0]], %[[amount]]
@@ -0,0 +1,10 @@
+// REQUIRES: debug-print
+// RUN: executor-translate %s -mlir-to-runtime-executable -stats \
+// RUN:  -o /dev/null 2>&1 | FileCheck %s
+
+executor.constant_resource @first dense<[1, 2, 3, 4, 5, 6, 7, 8]> : vector<8xi8>
+executor.constant_resource @other dense<[8, 7, 6, 5, 4, 3, 2, 1]> : vector<8xi8>
+executor.constant_resource @second dense<[1, 2, 3, 4, 5, 6, 7, 8]> : vector<8xi8>
+
+// CHECK: 8 translate-to-runtime-executable - Number of constant bytes saved by deduplication
+// CHECK: 1 translate-to-runtime-executable - Number of constants whose data aliases an identical constant
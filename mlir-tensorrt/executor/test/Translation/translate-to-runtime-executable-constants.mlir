@@ -0,0 +1,12 @@
+// RUN: executor-translate %s -mlir-to-runtime-executable | \
+// RUN:  executor-runner -dump-constants -input-type=rtexe | FileCheck %s
+
+executor.constant_resource @first dense<[1, 2, 3, 4, 5, 6, 7, 8]> : vector<8xi8>
+executor.constant_resource @other dense<[8, 7, 6, 5, 4, 3, 2, 1]> : vector<8xi8>
+executor.constant_resource @second dense<[1, 2, 3, 4, 5, 6, 7, 8]> : vector<8xi8>
+
+// Constants with identical data share a single copy of it.
+
+//      CHECK: Constant<first, 8 bytes> at offset [[OFFSET:[0-9]+]]
+// CHECK-NEXT: Constant<other, 8 bytes> at offset {{[0-9]+}}
+// CHECK-NEXT: Constant<second, 8 bytes> at offset [[OFFSET]]
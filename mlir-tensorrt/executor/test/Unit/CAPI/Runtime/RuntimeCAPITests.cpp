@@ -9,6 +9,7 @@
 //===----------------------------------------------------------------------===//
 #include "mlir-executor-c/Common/Common.h"
 #include "mlir-executor-c/Runtime/Runtime.h"
+#include "mlir-executor/Runtime/API/ExecutableFlatbuffer.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "gtest/gtest.h"
 #include <numeric>
@@ -265,3 +266,97 @@ TEST(RuntimeCAPI, TestMemRefType) {
   MTRT_MemRefType memrefType = mtrtTypeGetMemRefType(type);
   ASSERT_FALSE(mtrtMemRefTypeIsNull(memrefType));
 }
+
+/// Serialize an executable with a single function `func` that takes
+/// `numInputArgs` i32 scalar inputs and one host memref output argument, which
+/// is aliased as described by `outputAliases`.
+static std::vector<char> buildExecutable(int64_t numInputArgs,
+                                         std::vector<int32_t> outputAliases) {
+  namespace fb = flatbuffers;
+  namespace impl = mlirtrt::runtime::impl;
+  fb::FlatBufferBuilder64 fbBuilder;
+
+  std::vector<fb::Offset<void>> argTypes;
+  std::vector<impl::Type> argTypeCodes;
+  for (int64_t i = 0; i < numInputArgs; ++i) {
+    argTypes.push_back(
+        impl::CreateScalarType(fbBuilder, impl::ScalarTypeCode::i32).Union());
+    argTypeCodes.push_back(impl::Type::ScalarType);
+  }
+  argTypes.push_back(impl::CreateMemRefType(
+                         fbBuilder, impl::ScalarTypeCode::i32,
+                         fbBuilder.CreateVector(std::vector<int64_t>{4}),
+                         fbBuilder.CreateVector(std::vector<int64_t>{1}),
+                         impl::PointerType::host)
+                         .Union());
+  argTypeCodes.push_back(impl::Type::MemRefType);
+  std::vector<fb::Offset<void>> argBounds;
+  for (size_t i = 0; i < argTypes.size(); ++i)
+    argBounds.push_back(impl::CreateNoneBounds(fbBuilder).Union());
+  std::vector<impl::Bounds> argBoundsCodes(argTypes.size(),
+                                           impl::Bounds::NoneBounds);
+
+  auto signature = impl::CreateFunctionSignature(
+      fbBuilder, fbBuilder.CreateVector(argTypeCodes),
+      fbBuilder.CreateVector(argTypes),
+      fbBuilder.CreateVector(std::vector<impl::Type>{}),
+      fbBuilder.CreateVector(std::vector<fb::Offset<void>>{}),
+      /*num_output_args=*/1, fbBuilder.CreateVector(argBoundsCodes),
+      fbBuilder.CreateVector(argBounds),
+      fbBuilder.CreateVector(std::vector<impl::Bounds>{}),
+      fbBuilder.CreateVector(std::vector<fb::Offset<void>>{}),
+      fbBuilder.CreateString(""), impl::CallingConvention::unpacked,
+      fbBuilder.CreateVector(outputAliases));
+  std::vector<fb::Offset<impl::Function>> functions = {
+      impl::CreateFunction(fbBuilder, fbBuilder.CreateString("func"),
+                           signature)};
+
+  auto constantsOffset =
+      fbBuilder.CreateVector(std::vector<fb::Offset<impl::Constant>>{});
+  auto functionsOffset = fbBuilder.CreateVector(functions);
+  auto gridShapeOffset = fbBuilder.CreateVector(std::vector<uint32_t>{1, 1});
+  auto sourceOffset = fbBuilder.CreateString("function func() end");
+  auto nameOffset = fbBuilder.CreateString("capi_test");
+  impl::ExecutableBuilder exeBuilder(fbBuilder);
+  exeBuilder.add_process_grid_shape(gridShapeOffset);
+  exeBuilder.add_functions(functionsOffset);
+  exeBuilder.add_constants(constantsOffset);
+  exeBuilder.add_source(sourceOffset);
+  exeBuilder.add_name(nameOffset);
+  fbBuilder.Finish(exeBuilder.Finish());
+
+  const char *data =
+      reinterpret_cast<const char *>(fbBuilder.GetBufferPointer());
+  return std::vector<char>(data, data + fbBuilder.GetSize());
+}
+
+TEST(RuntimeCAPI, TestFunctionSignatureGetOutputAlias) {
+  for (auto [outputAliases, expectedAlias] :
+       {std::make_pair(std::vector<int32_t>{}, -1),
+        std::make_pair(std::vector<int32_t>{-1}, -1),
+        std::make_pair(std::vector<int32_t>{1}, 1)}) {
+    std::vector<char> buffer = buildExecutable(2, outputAliases);
+    MTRT_Executable executable{nullptr};
+    MTRT_Status status = mtrtExecutableCreate(
+        MTRT_StringView{buffer.data(), buffer.size()}, &executable);
+    ASSERT_TRUE(mtrtStatusIsOk(status));
+
+    MTRT_FunctionSignature signature =
+        mtrtGetFunctionSignature(executable, "func");
+    ASSERT_FALSE(mtrtFunctionSignatureIsNull(signature));
+
+    int64_t inputIndex{0};
+    status = mtrtFunctionSignatureGetOutputAlias(signature, 0, &inputIndex);
+    ASSERT_TRUE(mtrtStatusIsOk(status));
+    EXPECT_EQ(inputIndex, expectedAlias);
+
+    // Out of range output argument indices are rejected.
+    for (int64_t index : {-1, 1}) {
+      status = mtrtFunctionSignatureGetOutputAlias(signature, index,
+                                                   &inputIndex);
+      EXPECT_FALSE(mtrtStatusIsOk(status));
+      mtrtStatusDestroy(status);
+    }
+    mtrtExecutableDestroy(executable);
+  }
+}
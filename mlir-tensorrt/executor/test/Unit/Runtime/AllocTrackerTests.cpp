@@ -0,0 +1,202 @@
+//===- AllocTrackerTests.cpp  ---------------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for AllocTracker, including concurrent use from multiple
+/// threads.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/API/API.h"
+#include "gtest/gtest.h"
+#include <thread>
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+
+static PointerInfo getExternalHostPointer(uintptr_t ptr, uint64_t size = 64) {
+  return PointerInfo(ptr, size, PointerType::host, PointerOwner::external);
+}
+
+TEST(AllocTracker, TrackAndUntrack) {
+  AllocTracker tracker;
+  tracker.track(getExternalHostPointer(0x1000));
+  EXPECT_TRUE(tracker.contains(0x1000));
+  EXPECT_FALSE(tracker.contains(0x2000));
+  EXPECT_EQ(tracker.get(0x1000).size, 64u);
+  EXPECT_EQ(tracker.lookupOrDefault(0x2000).type, PointerType::unknown);
+
+  // Re-tracking a pointer replaces its information.
+  tracker.track(getExternalHostPointer(0x1000, 128));
+  EXPECT_EQ(tracker.get(0x1000).size, 128u);
+
+  tracker.untrack(0x1000);
+  EXPECT_FALSE(tracker.contains(0x1000));
+}
+
+TEST(AllocTracker, TrackAndUntrackWithoutLocks) {
+  AllocTracker tracker(/*threadSafe=*/false);
+  tracker.track(getExternalHostPointer(0x1000));
+  EXPECT_TRUE(tracker.contains(0x1000));
+  EXPECT_EQ(tracker.get(0x1000).size, 64u);
+  tracker.incrementExternalCount(0x1000);
+  EXPECT_EQ(tracker.getExternalReferenceCount(0x1000), 1);
+  tracker.untrack(0x1000);
+  EXPECT_FALSE(tracker.contains(0x1000));
+}
+
+TEST(AllocTracker, ParentLookup) {
+  AllocTracker parent;
+  parent.track(getExternalHostPointer(0x1000));
+  AllocTracker child;
+  child.setParent(&parent);
+  EXPECT_TRUE(child.contains(0x1000));
+  EXPECT_EQ(child.get(0x1000).size, 64u);
+  EXPECT_TRUE(child.isTrackedByParent(0x1000));
+  EXPECT_FALSE(parent.isTrackedByParent(0x1000));
+}
+
+TEST(AllocTracker, ParentQueriesAndMutators) {
+  AllocTracker parent;
+  parent.track(getExternalHostPointer(0x1000));
+  parent.incrementExternalCount(0x1000);
+  parent.markReleasedInternally(0x1000);
+  AllocTracker child;
+  child.setParent(&parent);
+
+  // Queries follow the parent.
+  EXPECT_EQ(child.getExternalReferenceCount(0x1000), 1);
+  EXPECT_TRUE(child.isReleasedInternally(0x1000));
+
+  // Mutators do not modify the parent.
+  child.incrementExternalCount(0x1000);
+  child.decrementExternalCount(0x1000);
+  EXPECT_EQ(parent.getExternalReferenceCount(0x1000), 1);
+
+  // Deallocating a pointer owned by the parent is rejected.
+  Status status = safeDeallocate(child, 0x1000);
+  EXPECT_FALSE(status.isOk());
+  EXPECT_TRUE(parent.contains(0x1000));
+
+  // A pointer tracked by the child shadows the parent.
+  child.track(getExternalHostPointer(0x1000, 128));
+  EXPECT_FALSE(child.isTrackedByParent(0x1000));
+  EXPECT_EQ(child.getExternalReferenceCount(0x1000), 0);
+  EXPECT_TRUE(safeDeallocate(child, 0x1000).isOk());
+  EXPECT_TRUE(child.isTrackedByParent(0x1000));
+}
+
+/// Many threads concurrently track, look up, and untrack their own pointers
+/// while updating the reference counts of pointers shared by all threads.
+TEST(AllocTracker, ConcurrentStress) {
+  constexpr unsigned kNumThreads = 8;
+  constexpr unsigned kNumIterations = 2000;
+  constexpr unsigned kNumShared = 16;
+
+  AllocTracker tracker;
+  for (unsigned i = 0; i < kNumShared; ++i)
+    tracker.track(getExternalHostPointer(0x100000 + i * 256));
+
+  std::vector<std::thread> threads;
+  std::atomic<unsigned> numErrors = 0;
+  for (unsigned t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      uintptr_t base = 0x10000000 + uintptr_t(t) * 0x1000000;
+      for (unsigned i = 0; i < kNumIterations; ++i) {
+        uintptr_t ptr = base + i * 64;
+        tracker.track(getExternalHostPointer(ptr, i));
+        if (!tracker.contains(ptr) || tracker.get(ptr).size != i)
+          ++numErrors;
+
+        uintptr_t shared = 0x100000 + (i % kNumShared) * 256;
+        tracker.incrementExternalCount(shared);
+        if (!tracker.contains(shared))
+          ++numErrors;
+        tracker.decrementExternalCount(shared);
+
+        if (i % 2 == 0)
+          tracker.untrack(ptr);
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(numErrors.load(), 0u);
+  for (unsigned i = 0; i < kNumShared; ++i)
+    EXPECT_EQ(tracker.getExternalReferenceCount(0x100000 + i * 256), 0);
+  for (unsigned t = 0; t < kNumThreads; ++t) {
+    uintptr_t base = 0x10000000 + uintptr_t(t) * 0x1000000;
+    for (unsigned i = 0; i < kNumIterations; ++i)
+      EXPECT_EQ(tracker.contains(base + i * 64), i % 2 == 1);
+  }
+}
+
+/// One thread repeatedly tracks and untracks a pointer while other threads
+/// update and query its reference count. Calls on the pointer while it is
+/// not tracked have no effect, and no call may use freed metadata.
+TEST(AllocTracker, ConcurrentRetrackAndReferenceCount) {
+  constexpr unsigned kNumThreads = 4;
+  constexpr unsigned kNumIterations = 20000;
+  constexpr uintptr_t kPtr = 0x1000;
+
+  AllocTracker tracker;
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&]() {
+      for (unsigned i = 0; i < kNumIterations; ++i) {
+        tracker.incrementExternalCount(kPtr);
+        EXPECT_GE(tracker.getExternalReferenceCount(kPtr), 0);
+        EXPECT_FALSE(tracker.isReleasedInternally(kPtr));
+        PointerInfo info = tracker.lookupOrDefault(kPtr);
+        EXPECT_TRUE(info.type == PointerType::unknown || info.size >= 64);
+        tracker.decrementExternalCount(kPtr);
+      }
+    });
+  }
+  for (unsigned i = 0; i < kNumIterations; ++i) {
+    tracker.track(getExternalHostPointer(kPtr, 64 + i % 2));
+    if (i % 3 == 0)
+      tracker.track(getExternalHostPointer(kPtr, 128));
+    tracker.untrack(kPtr);
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  EXPECT_FALSE(tracker.contains(kPtr));
+  tracker.track(getExternalHostPointer(kPtr));
+  EXPECT_EQ(tracker.getExternalReferenceCount(kPtr), 0);
+  tracker.decrementExternalCount(kPtr);
+  EXPECT_EQ(tracker.getExternalReferenceCount(kPtr), 0);
+}
+
+TEST(AllocTracker, Statistics) {
+  AllocTracker tracker;
+  // External pointers are not counted.
+  tracker.track(getExternalHostPointer(0x1000));
+
+  StatusOr<PointerInfo> first =
+      allocate(tracker, PointerType::host, 64, /*alignment=*/16, {});
+  ASSERT_TRUE(first.isOk()) << first.getStatus().getString();
+  StatusOr<PointerInfo> second =
+      allocate(tracker, PointerType::host, 128, /*alignment=*/16, {});
+  ASSERT_TRUE(second.isOk()) << second.getStatus().getString();
+  ASSERT_TRUE(safeDeallocate(tracker, first->ptr).isOk());
+
+  AllocTracker::Statistics stats = tracker.getStatistics(PointerType::host);
+  EXPECT_EQ(stats.numAllocations, 2);
+  EXPECT_EQ(stats.numBytes, 128);
+  EXPECT_EQ(stats.peakBytes, 192);
+  EXPECT_EQ(tracker.getStatistics(PointerType::device).numAllocations, 0);
+
+  tracker.resetStatistics();
+  stats = tracker.getStatistics(PointerType::host);
+  EXPECT_EQ(stats.numAllocations, 0);
+  EXPECT_EQ(stats.peakBytes, 128);
+
+  ASSERT_TRUE(safeDeallocate(tracker, second->ptr).isOk());
+  stats = tracker.getStatistics(PointerType::host);
+  EXPECT_EQ(stats.numBytes, 0);
+  EXPECT_EQ(stats.peakBytes, 128);
+}
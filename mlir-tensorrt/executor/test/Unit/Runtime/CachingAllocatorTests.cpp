@@ -0,0 +1,292 @@
+//===- CachingAllocatorTests.cpp  -----------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for the size-class caching allocator. Only the host backend is
+/// exercised so that the tests do not require a GPU.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/API/API.h"
+#include "mlir-executor/Support/Allocators.h"
+#include "gtest/gtest.h"
+#include <thread>
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+
+namespace {
+/// A host backend that counts the calls made by the caching allocator.
+class CountingBackend : public AllocatorBackend {
+public:
+  CountingBackend(int64_t &numLiveAllocations)
+      : numLiveAllocations(numLiveAllocations) {}
+
+  StatusOr<uintptr_t> allocate(uint64_t size, uint32_t alignment,
+                               std::optional<CudaStream> stream) final {
+    numLiveAllocations++;
+    return host->allocate(size, alignment, {});
+  }
+
+  Status deallocate(uintptr_t ptr, std::optional<CudaStream> stream) final {
+    numLiveAllocations--;
+    return host->deallocate(ptr, {});
+  }
+
+private:
+  int64_t &numLiveAllocations;
+  std::unique_ptr<AllocatorBackend> host = createHostAllocatorBackend();
+};
+
+/// A host backend that records synchronizations and the streams passed to
+/// `deallocate`.
+class RecordingBackend : public AllocatorBackend {
+public:
+  struct Calls {
+    int64_t numSynchronizations = 0;
+    std::vector<std::optional<CudaStream>> deallocationStreams;
+  };
+
+  RecordingBackend(Calls &calls) : calls(calls) {}
+
+  StatusOr<uintptr_t> allocate(uint64_t size, uint32_t alignment,
+                               std::optional<CudaStream> stream) final {
+    return host->allocate(size, alignment, {});
+  }
+
+  Status deallocate(uintptr_t ptr, std::optional<CudaStream> stream) final {
+    calls.deallocationStreams.push_back(stream);
+    return host->deallocate(ptr, {});
+  }
+
+  Status synchronize() final {
+    calls.numSynchronizations++;
+    return getOkStatus();
+  }
+
+private:
+  Calls &calls;
+  std::unique_ptr<AllocatorBackend> host = createHostAllocatorBackend();
+};
+} // namespace
+
+static std::unique_ptr<CachingAllocator>
+createCountingAllocator(int64_t &numLiveAllocations,
+                        CachingAllocatorOptions options = {}) {
+  return std::make_unique<CachingAllocator>(
+      std::make_unique<CountingBackend>(numLiveAllocations),
+      std::move(options));
+}
+
+TEST(CachingAllocator, SizeClasses) {
+  CachingAllocator allocator(createHostAllocatorBackend());
+  EXPECT_EQ(allocator.getSizeClass(1), 512u);
+  EXPECT_EQ(allocator.getSizeClass(512), 512u);
+  EXPECT_EQ(allocator.getSizeClass(513), 1024u);
+  EXPECT_EQ(allocator.getSizeClass(4096), 4096u);
+  EXPECT_EQ(allocator.getSizeClass(4097), 5120u);
+  EXPECT_EQ(allocator.getSizeClass(7000), 7168u);
+  EXPECT_EQ(allocator.getSizeClass(1 << 20), 1u << 20);
+}
+
+TEST(CachingAllocator, ReuseFreedBlock) {
+  int64_t numLive = 0;
+  std::unique_ptr<CachingAllocator> allocator =
+      createCountingAllocator(numLive);
+
+  StatusOr<uintptr_t> first = allocator->allocate(1000, 16);
+  ASSERT_TRUE(first.isOk());
+  EXPECT_TRUE(allocator->owns(*first));
+  ASSERT_TRUE(allocator->deallocate(*first).isOk());
+  EXPECT_FALSE(allocator->owns(*first));
+
+  // A request of the same size class reuses the cached block.
+  StatusOr<uintptr_t> second = allocator->allocate(900, 16);
+  ASSERT_TRUE(second.isOk());
+  EXPECT_EQ(*first, *second);
+  EXPECT_EQ(numLive, 1);
+
+  CachingAllocatorStats stats = allocator->getStats();
+  EXPECT_EQ(stats.numAllocations, 2u);
+  EXPECT_EQ(stats.numCacheHits, 1u);
+  EXPECT_EQ(stats.numBackendAllocations, 1u);
+  EXPECT_DOUBLE_EQ(stats.getHitRate(), 0.5);
+  EXPECT_EQ(stats.bytesInUse, 1024u);
+  EXPECT_EQ(stats.bytesRequested, 900u);
+  EXPECT_EQ(stats.bytesCached, 0u);
+  EXPECT_GT(stats.getFragmentation(), 0.0);
+
+  ASSERT_TRUE(allocator->deallocate(*second).isOk());
+  EXPECT_EQ(allocator->getStats().bytesCached, 1024u);
+  ASSERT_TRUE(allocator->trim().isOk());
+  EXPECT_EQ(allocator->getStats().bytesCached, 0u);
+  EXPECT_EQ(numLive, 0);
+}
+
+TEST(CachingAllocator, StreamOrderedReuse) {
+  int64_t numLive = 0;
+  std::unique_ptr<CachingAllocator> allocator =
+      createCountingAllocator(numLive);
+
+  StatusOr<uintptr_t> ptr = allocator->allocate(2048, 64, CudaStream(1));
+  ASSERT_TRUE(ptr.isOk());
+  ASSERT_TRUE(allocator->deallocate(*ptr, CudaStream(1)).isOk());
+
+  // A block freed on one stream is not handed to another stream or to a
+  // synchronous request.
+  StatusOr<uintptr_t> other = allocator->allocate(2048, 64, CudaStream(2));
+  ASSERT_TRUE(other.isOk());
+  EXPECT_NE(*ptr, *other);
+  StatusOr<uintptr_t> sync = allocator->allocate(2048, 64);
+  ASSERT_TRUE(sync.isOk());
+  EXPECT_NE(*ptr, *sync);
+
+  // It is reused by the stream it was freed on.
+  StatusOr<uintptr_t> same = allocator->allocate(2048, 64, CudaStream(1));
+  ASSERT_TRUE(same.isOk());
+  EXPECT_EQ(*ptr, *same);
+
+  // Blocks freed synchronously can be used on any stream.
+  ASSERT_TRUE(allocator->deallocate(*sync).isOk());
+  StatusOr<uintptr_t> fromSync = allocator->allocate(2048, 64, CudaStream(2));
+  ASSERT_TRUE(fromSync.isOk());
+  EXPECT_EQ(*sync, *fromSync);
+
+  for (uintptr_t p : {*other, *same, *fromSync})
+    ASSERT_TRUE(allocator->deallocate(p).isOk());
+  ASSERT_TRUE(allocator->trim().isOk());
+  EXPECT_EQ(numLive, 0);
+}
+
+TEST(CachingAllocator, SynchronousFreeSynchronizesBeforeReuse) {
+  RecordingBackend::Calls calls;
+  CachingAllocator allocator(std::make_unique<RecordingBackend>(calls));
+
+  StatusOr<uintptr_t> first = allocator.allocate(2048, 64);
+  StatusOr<uintptr_t> second = allocator.allocate(2048, 64);
+  ASSERT_TRUE(first.isOk() && second.isOk());
+  ASSERT_TRUE(allocator.deallocate(*first).isOk());
+  ASSERT_TRUE(allocator.deallocate(*second).isOk());
+  EXPECT_EQ(calls.numSynchronizations, 0);
+
+  // Work on any stream may still use a block freed without a stream, so the
+  // first reuse synchronizes the backend. That also covers the other block
+  // freed before the synchronization.
+  StatusOr<uintptr_t> reused = allocator.allocate(2048, 64, CudaStream(1));
+  ASSERT_TRUE(reused.isOk());
+  EXPECT_EQ(calls.numSynchronizations, 1);
+  StatusOr<uintptr_t> reusedSync = allocator.allocate(2048, 64);
+  ASSERT_TRUE(reusedSync.isOk());
+  EXPECT_EQ(calls.numSynchronizations, 1);
+  EXPECT_EQ(allocator.getStats().numSynchronizations, 1u);
+
+  // Blocks freed again need another synchronization.
+  ASSERT_TRUE(allocator.deallocate(*reusedSync).isOk());
+  StatusOr<uintptr_t> again = allocator.allocate(2048, 64);
+  ASSERT_TRUE(again.isOk());
+  EXPECT_EQ(*again, *reusedSync);
+  EXPECT_EQ(calls.numSynchronizations, 2);
+
+  // Stream-ordered reuse does not synchronize.
+  ASSERT_TRUE(allocator.deallocate(*reused, CudaStream(1)).isOk());
+  StatusOr<uintptr_t> sameStream = allocator.allocate(2048, 64, CudaStream(1));
+  ASSERT_TRUE(sameStream.isOk());
+  EXPECT_EQ(*sameStream, *reused);
+  EXPECT_EQ(calls.numSynchronizations, 2);
+
+  ASSERT_TRUE(allocator.deallocate(*again).isOk());
+  ASSERT_TRUE(allocator.deallocate(*sameStream, CudaStream(1)).isOk());
+}
+
+TEST(CachingAllocator, TrimReleasesBlocksSynchronously) {
+  RecordingBackend::Calls calls;
+  CachingAllocator allocator(std::make_unique<RecordingBackend>(calls));
+
+  // The streams that cached blocks were freed on may have been destroyed by
+  // the time the cache is trimmed, so no stream is passed to the backend.
+  for (CudaStream stream : {CudaStream(1), CudaStream(2)}) {
+    StatusOr<uintptr_t> ptr = allocator.allocate(4096, 64, stream);
+    ASSERT_TRUE(ptr.isOk());
+    ASSERT_TRUE(allocator.deallocate(*ptr, stream).isOk());
+  }
+  ASSERT_TRUE(allocator.trim().isOk());
+  ASSERT_EQ(calls.deallocationStreams.size(), 2u);
+  for (const std::optional<CudaStream> &stream : calls.deallocationStreams)
+    EXPECT_FALSE(stream.has_value());
+}
+
+TEST(CachingAllocator, HighWaterCap) {
+  int64_t numLive = 0;
+  CachingAllocatorOptions options;
+  options.maxCachedBytes = 1024;
+  std::unique_ptr<CachingAllocator> allocator =
+      createCountingAllocator(numLive, options);
+
+  StatusOr<uintptr_t> a = allocator->allocate(1024, 16);
+  StatusOr<uintptr_t> b = allocator->allocate(1024, 16);
+  ASSERT_TRUE(a.isOk() && b.isOk());
+  ASSERT_TRUE(allocator->deallocate(*a).isOk());
+  // Caching the second block would exceed the cap, so it is released.
+  ASSERT_TRUE(allocator->deallocate(*b).isOk());
+  EXPECT_EQ(allocator->getStats().bytesCached, 1024u);
+  EXPECT_EQ(numLive, 1);
+}
+
+TEST(CachingAllocator, LargeAllocationsBypassCache) {
+  int64_t numLive = 0;
+  CachingAllocatorOptions options;
+  options.maxBlockSize = 4096;
+  std::unique_ptr<CachingAllocator> allocator =
+      createCountingAllocator(numLive, options);
+
+  StatusOr<uintptr_t> ptr = allocator->allocate(8192, 16);
+  ASSERT_TRUE(ptr.isOk());
+  ASSERT_TRUE(allocator->deallocate(*ptr).isOk());
+  EXPECT_EQ(numLive, 0);
+  EXPECT_EQ(allocator->getStats().bytesCached, 0u);
+}
+
+TEST(CachingAllocator, TrimOnIdle) {
+  int64_t numLive = 0;
+  CachingAllocatorOptions options;
+  options.idleTrimTimeout = std::chrono::milliseconds(1);
+  std::unique_ptr<CachingAllocator> allocator =
+      createCountingAllocator(numLive, options);
+
+  StatusOr<uintptr_t> ptr = allocator->allocate(1024, 16);
+  ASSERT_TRUE(ptr.isOk());
+  ASSERT_TRUE(allocator->deallocate(*ptr).isOk());
+  EXPECT_EQ(numLive, 1);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  StatusOr<uintptr_t> next = allocator->allocate(64, 16);
+  ASSERT_TRUE(next.isOk());
+  // The cached block was released before serving the request.
+  EXPECT_EQ(allocator->getStats().numCacheHits, 0u);
+  EXPECT_EQ(numLive, 1);
+  ASSERT_TRUE(allocator->deallocate(*next).isOk());
+}
+
+TEST(CachingAllocator, RuntimeAllocateUsesTrackerAllocator) {
+  StatusOr<std::shared_ptr<CachingAllocator>> allocator =
+      createCachingAllocator(PointerType::host);
+  ASSERT_TRUE(allocator.isOk());
+
+  AllocTracker tracker;
+  tracker.setCachingAllocator(PointerType::host, *allocator);
+  StatusOr<PointerInfo> first =
+      runtime::allocate(tracker, PointerType::host, 100, 16, {});
+  ASSERT_TRUE(first.isOk());
+  EXPECT_TRUE(tracker.contains(first->ptr));
+  EXPECT_TRUE((*allocator)->owns(first->ptr));
+  ASSERT_TRUE(safeDeallocate(tracker, first->ptr).isOk());
+  EXPECT_FALSE(tracker.contains(first->ptr));
+
+  StatusOr<PointerInfo> second =
+      runtime::allocate(tracker, PointerType::host, 100, 16, {});
+  ASSERT_TRUE(second.isOk());
+  EXPECT_EQ(first->ptr, second->ptr);
+  EXPECT_EQ((*allocator)->getStats().numCacheHits, 1u);
+  ASSERT_TRUE(safeDeallocate(tracker, second->ptr).isOk());
+}
@@ -0,0 +1,187 @@
+//===- ExecutableConstantTests.cpp ----------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for loading executables and their constants. The tests use
+/// executables that are serialized directly with the flatbuffer API, so they
+/// do not require a compiler or a GPU.
+///
+//===----------------------------------------------------------------------===//
+#include "ExecutableTestUtils.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::test;
+
+/// Return constants whose sizes do not preserve the alignment of the data
+/// that follows them.
+static std::vector<TestConstant> getOddSizedConstants() {
+  return {{"c0", {1, 2, 3}},
+          {"c1", std::vector<int8_t>(100, 7)},
+          {"c2", {4, 5, 6, 7, 8}}};
+}
+
+/// Return the bytes of `constant` after decoding.
+static std::vector<int8_t> getDecodedData(const TestConstant &constant) {
+  if (constant.encoding == ConstantEncoding::raw)
+    return constant.data;
+  std::vector<int8_t> result;
+  while (result.size() < constant.decodedSize)
+    result.insert(result.end(), constant.data.begin(), constant.data.end());
+  return result;
+}
+
+namespace {
+class ExecutableConstantTest : public ::testing::Test {
+protected:
+  void TearDown() override {
+    if (!path.empty())
+      llvm::sys::fs::remove(path);
+  }
+
+  /// Write `bytes` to a temporary file and load it with `loadFromFile`.
+  std::unique_ptr<Executable> writeAndLoad(std::string_view bytes) {
+    int fd;
+    std::error_code ec =
+        llvm::sys::fs::createTemporaryFile("executable", "mtrtexe", fd, path);
+    EXPECT_FALSE(ec) << ec.message();
+    if (ec)
+      return nullptr;
+    {
+      llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+      os << bytes;
+    }
+    StatusOr<std::unique_ptr<Executable>> exe =
+        Executable::loadFromFile(path.str());
+    EXPECT_TRUE(exe.isOk()) << exe.getStatus().getString();
+    if (!exe.isOk())
+      return nullptr;
+    return std::move(*exe);
+  }
+
+  llvm::SmallString<128> path;
+};
+} // namespace
+
+TEST_F(ExecutableConstantTest, MappedConstantsAreAlignedAndUsedInPlace) {
+  std::vector<TestConstant> constants = getOddSizedConstants();
+  std::unique_ptr<Executable> executable =
+      writeAndLoad(serializeExecutable("", constants));
+  ASSERT_TRUE(executable);
+
+  // The constants point into the mapped file, not into a copy.
+  auto *begin = static_cast<const char *>(executable->getStorage()->data());
+  const char *end = begin + executable->getStorage()->size();
+  llvm::SmallVector<ConstantView> views = executable->getConstants();
+  ASSERT_EQ(views.size(), constants.size());
+  for (auto [view, constant] : llvm::zip_equal(views, constants)) {
+    auto *data = reinterpret_cast<const char *>(view.data());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % kExecutableConstantAlignment,
+              0u)
+        << view.getName();
+    EXPECT_TRUE(data >= begin && data + view.size() <= end) << view.getName();
+    EXPECT_EQ(std::memcmp(data, constant.data.data(), constant.data.size()),
+              0);
+  }
+
+  // A session binds the constants in place instead of copying them.
+  StatusOr<std::unique_ptr<LuaRuntimeSession>> session =
+      LuaRuntimeSession::create(
+          RuntimeSessionOptions(/*numDevices=*/1, /*deviceId=*/0),
+          executable->getView());
+  ASSERT_TRUE(session.isOk()) << session.getStatus().getString();
+  for (ConstantView view : views)
+    EXPECT_EQ(getConstantAddress(**session, view.getName()),
+              reinterpret_cast<uintptr_t>(view.data()))
+        << view.getName();
+}
+
+TEST_F(ExecutableConstantTest, FailedAlignedCopyIsReported) {
+  // The size of the copy overflows the size of the aligned buffer, so the
+  // allocation fails before any data is read.
+  char data = 0;
+  StatusOr<std::unique_ptr<Executable>> exe =
+      Executable::loadFromUnalignedRef(llvm::ArrayRef<char>(
+          &data, std::numeric_limits<size_t>::max() - 8));
+  ASSERT_FALSE(exe.isOk());
+  EXPECT_EQ(exe.getStatus().getCode(), StatusCode::InternalError);
+}
+
+TEST_F(ExecutableConstantTest, DecodeConstants) {
+  std::vector<TestConstant> constants = {
+      {"raw", {1, 2, 3, 4, 5}},
+      {"byte_splat", {9}, ConstantEncoding::splat, 33},
+      // The decoded size is not a power of two multiple of the element.
+      {"splat", {1, 2, 3}, ConstantEncoding::splat, 3 * 11},
+      {"empty_splat", {1, 2, 3, 4}, ConstantEncoding::splat, 0}};
+  std::unique_ptr<Executable> executable =
+      loadExecutable(serializeExecutable("", constants));
+  ASSERT_TRUE(executable);
+  llvm::SmallVector<ConstantView> views = executable->getConstants();
+  ASSERT_EQ(views.size(), constants.size());
+
+  // Decode into a buffer that is larger than the constant, so that writes
+  // past the decoded size are detected.
+  constexpr int8_t kCanary = 0x55;
+  constexpr size_t kPadding = 16;
+  for (auto [view, constant] : llvm::zip_equal(views, constants)) {
+    std::vector<int8_t> expected = getDecodedData(constant);
+    ASSERT_EQ(view.getDecodedSize(), expected.size()) << constant.name;
+    std::vector<int8_t> buffer(expected.size() + kPadding, kCanary);
+    view.decode(buffer.data());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buffer.begin()))
+        << constant.name;
+    EXPECT_TRUE(std::all_of(buffer.begin() + expected.size(), buffer.end(),
+                            [](int8_t v) { return v == kCanary; }))
+        << constant.name;
+  }
+}
+
+TEST_F(ExecutableConstantTest, EncodedConstantsAreMaterializedOnFirstUse) {
+  std::vector<TestConstant> constants = {
+      {"raw", {1, 2, 3, 4}},
+      {"splat", {1, 2, 3, 4}, ConstantEncoding::splat, 4 * 25},
+      {"splat_alias", {1, 2, 3, 4}, ConstantEncoding::splat, 4 * 25}};
+  std::unique_ptr<Executable> executable =
+      loadExecutable(serializeExecutable("", constants));
+  ASSERT_TRUE(executable);
+  StatusOr<std::unique_ptr<LuaRuntimeSession>> session =
+      LuaRuntimeSession::create(
+          RuntimeSessionOptions(/*numDevices=*/1, /*deviceId=*/0),
+          executable->getView());
+  ASSERT_TRUE(session.isOk()) << session.getStatus().getString();
+  sol::table table = (*session)->getLuaState()["executor_constants"];
+
+  // Raw constants are bound when the session is created, encoded constants
+  // are not.
+  EXPECT_EQ(table.raw_get<sol::object>("raw").get_type(), sol::type::number);
+  EXPECT_EQ(table.raw_get<sol::object>("splat").get_type(), sol::type::lua_nil);
+  EXPECT_EQ(table.raw_get<sol::object>("splat_alias").get_type(),
+            sol::type::lua_nil);
+
+  // The first access decodes the constant into a buffer owned by the session.
+  uintptr_t ptr = getConstantAddress(**session, "splat");
+  ASSERT_NE(ptr, 0u);
+  std::vector<int8_t> expected = getDecodedData(constants[1]);
+  EXPECT_EQ(std::memcmp(reinterpret_cast<const void *>(ptr), expected.data(),
+                        expected.size()),
+            0);
+  EXPECT_TRUE((*session)->getAllocTracker().contains(ptr));
+  EXPECT_EQ(table.raw_get<uintptr_t>("splat"), ptr);
+
+  // Later accesses return the same buffer, and so do constants with the same
+  // data.
+  EXPECT_EQ(getConstantAddress(**session, "splat"), ptr);
+  EXPECT_EQ(getConstantAddress(**session, "splat_alias"), ptr);
+
+  // Unknown names are still nil.
+  EXPECT_EQ(getConstantAddress(**session, "unknown"), 0u);
+}
@@ -0,0 +1,101 @@
+//===- ExecutableTestUtils.h ------------------------------------*- C++ -*-===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Utilities for unit tests of executables with constants. The executables
+/// are serialized directly with the flatbuffer API, so that the tests do not
+/// require a compiler.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_EXECUTOR_TEST_UNIT_RUNTIME_EXECUTABLETESTUTILS
+#define MLIR_EXECUTOR_TEST_UNIT_RUNTIME_EXECUTABLETESTUTILS
+
+#include "mlir-executor/Runtime/API/API.h"
+#include "mlir-executor/Runtime/API/ExecutableFlatbuffer.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+#include "llvm/ADT/STLExtras.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mlirtrt::runtime::test {
+
+/// A constant of an executable serialized by `serializeExecutable`.
+struct TestConstant {
+  std::string name;
+  std::vector<int8_t> data;
+  ConstantEncoding encoding = ConstantEncoding::raw;
+  /// The decoded size of constants that are not `raw`.
+  uint64_t decodedSize = 0;
+};
+
+/// Serialize an executable with the Lua `source`, the given `constants`, and
+/// no functions. Like the translation, the data of each constant is aligned
+/// to `kExecutableConstantAlignment`.
+inline std::string serializeExecutable(std::string_view source,
+                                       llvm::ArrayRef<TestConstant> constants) {
+  namespace fb = flatbuffers;
+  fb::FlatBufferBuilder64 fbBuilder;
+
+  // The names and data of the constants are in the 64 bit region, which must
+  // be serialized first.
+  std::vector<std::pair<fb::Offset64<fb::String>,
+                        fb::Offset64<fb::Vector64<int8_t>>>>
+      constantData;
+  for (const TestConstant &constant : constants) {
+    auto name = fbBuilder.CreateString<fb::Offset64>(constant.name);
+    fbBuilder.ForceVectorAlignment64(constant.data.size(), sizeof(int8_t),
+                                     kExecutableConstantAlignment);
+    auto data =
+        fbBuilder.CreateVector64(constant.data.data(), constant.data.size());
+    constantData.emplace_back(name, data);
+  }
+
+  std::vector<fb::Offset<impl::Constant>> constantOffsets;
+  for (auto [constant, offsets] : llvm::zip_equal(constants, constantData))
+    constantOffsets.push_back(
+        impl::CreateConstant(fbBuilder, offsets.first, offsets.second,
+                             constant.encoding, constant.decodedSize));
+  auto constantsOffset = fbBuilder.CreateVector(constantOffsets);
+  auto functionsOffset =
+      fbBuilder.CreateVector(std::vector<fb::Offset<impl::Function>>{});
+  auto gridShapeOffset = fbBuilder.CreateVector(std::vector<uint32_t>{1, 1});
+  auto sourceOffset = fbBuilder.CreateString(source.data(), source.size());
+  auto nameOffset = fbBuilder.CreateString("constants_test");
+  impl::ExecutableBuilder exeBuilder(fbBuilder);
+  exeBuilder.add_process_grid_shape(gridShapeOffset);
+  exeBuilder.add_functions(functionsOffset);
+  exeBuilder.add_constants(constantsOffset);
+  exeBuilder.add_source(sourceOffset);
+  exeBuilder.add_name(nameOffset);
+  fbBuilder.Finish(exeBuilder.Finish());
+  return std::string(
+      reinterpret_cast<const char *>(fbBuilder.GetBufferPointer()),
+      fbBuilder.GetSize());
+}
+
+/// Load the serialized executable `bytes`.
+inline std::unique_ptr<Executable> loadExecutable(std::string_view bytes) {
+  StatusOr<std::unique_ptr<Executable>> exe =
+      Executable::loadFromUnalignedRef(
+          llvm::ArrayRef<char>(bytes.data(), bytes.size()));
+  EXPECT_TRUE(exe.isOk()) << exe.getStatus().getString();
+  if (!exe.isOk())
+    return nullptr;
+  return std::move(*exe);
+}
+
+/// Return the address that `session` binds to the constant `name`, or zero
+/// if there is none. This materializes the constant if it is encoded.
+inline uintptr_t getConstantAddress(LuaRuntimeSession &session,
+                                    std::string_view name) {
+  return session.getLuaState()["executor_constants"][name].get_or<uintptr_t>(
+      0);
+}
+
+} // namespace mlirtrt::runtime::test
+
+#endif // MLIR_EXECUTOR_TEST_UNIT_RUNTIME_EXECUTABLETESTUTILS
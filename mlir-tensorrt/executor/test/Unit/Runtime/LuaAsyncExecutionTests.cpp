@@ -0,0 +1,161 @@
+//===- LuaAsyncExecutionTests.cpp -----------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for asynchronous executions of the Lua backend. The tests use a
+/// small executable built directly with the flatbuffer API whose function
+/// synchronizes the session's stream, which suspends an asynchronous
+/// execution. They require a GPU and are skipped if none is available.
+///
+//===----------------------------------------------------------------------===//
+#include "LuaTestUtils.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+#include "cuda_runtime_api.h"
+#endif
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::test;
+
+#ifdef MLIR_EXECUTOR_ENABLE_CUDA
+
+static constexpr int64_t kNumElements = 4;
+
+/// Build an executable containing `add_one(a, b)`, which stores `a + 1` into
+/// `b` between two synchronizations of the session's stream.
+static std::unique_ptr<Executable> buildSyncingExecutable() {
+  std::string source = R"(
+function executor_init_globals()
+  stream0 = __cuda_stream_create()
+end
+function add_one(a, b)
+  __cuda_stream_sync(stream0)
+  for i = 0, a[4] - 1 do
+    _store_i64(b[2], (b[3] + i) * 8, _load_i64(a[2], (a[3] + i) * 8) + 1)
+  end
+  __cuda_stream_sync(stream0)
+end
+)";
+  fb::FlatBufferBuilder64 fbBuilder;
+  auto signature = createMemRefSignature(
+      fbBuilder, {createMemRefType(fbBuilder, {kNumElements}),
+                  createMemRefType(fbBuilder, {kNumElements})});
+  return finishExecutable(
+      fbBuilder, "async_test", source,
+      {impl::CreateFunction(fbBuilder, fbBuilder.CreateString("add_one"),
+                            signature)});
+}
+
+namespace {
+class LuaAsyncExecutionTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    int numDevices = 0;
+    if (cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0)
+      GTEST_SKIP() << "no CUDA device available";
+
+    executable = buildSyncingExecutable();
+    ASSERT_TRUE(executable);
+    StatusOr<std::unique_ptr<RuntimeClient>> clientOr = RuntimeClient::create();
+    ASSERT_TRUE(clientOr.isOk()) << clientOr.getStatus().getString();
+    client = std::move(*clientOr);
+    StatusOr<std::unique_ptr<LuaRuntimeSession>> sessionOr =
+        LuaRuntimeSession::create(
+            RuntimeSessionOptions(/*numDevices=*/1, /*deviceId=*/0),
+            executable->getView());
+    ASSERT_TRUE(sessionOr.isOk()) << sessionOr.getStatus().getString();
+    session = std::move(*sessionOr);
+    ASSERT_EQ(cudaStreamCreate(&otherStream), cudaSuccess);
+  }
+
+  void TearDown() override {
+    if (otherStream)
+      cudaStreamDestroy(otherStream);
+  }
+
+  StatusOr<std::unique_ptr<LuaAsyncExecution>>
+  start(AddOneRequest &request, std::optional<CudaStream> stream = {}) {
+    return executeFunctionWithLuaBackendAsync(
+        *session, "add_one", {request.inputMemRef.get()},
+        {request.outputMemRef.get()}, stream);
+  }
+
+  std::unique_ptr<Executable> executable;
+  std::unique_ptr<RuntimeClient> client;
+  std::unique_ptr<LuaRuntimeSession> session;
+  cudaStream_t otherStream{nullptr};
+};
+} // namespace
+
+TEST_F(LuaAsyncExecutionTest, PollAndWait) {
+  std::vector<AddOneRequest> requests = createRequests(
+      *client, std::vector<std::vector<int64_t>>(2, {kNumElements}));
+
+  // Both executions are suspended at their first stream synchronization.
+  StatusOr<std::unique_ptr<LuaAsyncExecution>> first = start(requests[0]);
+  ASSERT_TRUE(first.isOk()) << first.getStatus().getString();
+  StatusOr<std::unique_ptr<LuaAsyncExecution>> second = start(requests[1]);
+  ASSERT_TRUE(second.isOk()) << second.getStatus().getString();
+  EXPECT_FALSE((*first)->isDone());
+  EXPECT_FALSE((*second)->isDone());
+  EXPECT_EQ(session->getNumInFlightExecutions(), 2u);
+
+  // Polling resumes the first execution through both synchronizations.
+  while (!(*first)->poll()) {
+  }
+  ASSERT_TRUE((*first)->getStatus().isOk())
+      << (*first)->getStatus().getString();
+  requests[0].check();
+  EXPECT_EQ(session->getNumInFlightExecutions(), 1u);
+
+  Status status = (*second)->wait();
+  ASSERT_TRUE(status.isOk()) << status.getString();
+  requests[1].check();
+  EXPECT_EQ(session->getNumInFlightExecutions(), 0u);
+}
+
+TEST_F(LuaAsyncExecutionTest, RejectsStreamChangeWhileInFlight) {
+  std::vector<AddOneRequest> requests = createRequests(
+      *client, std::vector<std::vector<int64_t>>(3, {kNumElements}));
+  CudaStream sessionStream = session->getCudaStream();
+  CudaStream other = reinterpret_cast<CudaStream>(otherStream);
+
+  StatusOr<std::unique_ptr<LuaAsyncExecution>> first = start(requests[0]);
+  ASSERT_TRUE(first.isOk()) << first.getStatus().getString();
+  ASSERT_FALSE((*first)->isDone());
+
+  // Another invocation on a different stream would switch the stream of the
+  // suspended execution, so it is rejected. The session's stream is kept.
+  StatusOr<std::unique_ptr<LuaAsyncExecution>> rejected =
+      start(requests[1], other);
+  ASSERT_FALSE(rejected.isOk());
+  EXPECT_EQ(rejected.getStatus().getCode(), StatusCode::InvalidArgument);
+  EXPECT_FALSE(executeFunctionWithLuaBackend(
+                   *session, "add_one", {requests[1].inputMemRef.get()},
+                   {requests[1].outputMemRef.get()}, other)
+                   .isOk());
+  EXPECT_EQ(session->getCudaStream(), sessionStream);
+
+  // Passing the session's own stream is fine.
+  StatusOr<std::unique_ptr<LuaAsyncExecution>> sameStream =
+      start(requests[1], sessionStream);
+  ASSERT_TRUE(sameStream.isOk()) << sameStream.getStatus().getString();
+  ASSERT_TRUE((*first)->wait().isOk());
+  ASSERT_TRUE((*sameStream)->wait().isOk());
+  requests[0].check();
+  requests[1].check();
+
+  // Once no execution is in flight, the stream can be changed again.
+  StatusOr<std::unique_ptr<LuaAsyncExecution>> third =
+      start(requests[2], other);
+  ASSERT_TRUE(third.isOk()) << third.getStatus().getString();
+  ASSERT_TRUE((*third)->wait().isOk());
+  requests[2].check();
+  EXPECT_EQ(session->getCudaStream(), other);
+}
+
+#endif // MLIR_EXECUTOR_ENABLE_CUDA
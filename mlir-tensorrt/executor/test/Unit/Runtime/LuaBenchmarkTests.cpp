@@ -0,0 +1,202 @@
+//===- LuaBenchmarkTests.cpp ----------------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for the function benchmark of the Lua runtime. The tests use a
+/// host-only executable that is built directly with the flatbuffer API, so
+/// they do not require a compiler or a GPU.
+///
+//===----------------------------------------------------------------------===//
+#include "LuaTestUtils.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaBenchmark.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <random>
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::test;
+
+/// `scale(a, n, b)` stores `a * n` into `b`, where `a` is a host memref of
+/// shape `? x 2` (at most `3 x 2`), `n` is a scalar in [1, 4] and `b` is a
+/// host memref of shape `3 x 2`, all of type i64. Each call allocates and
+/// frees a 64 byte temporary buffer.
+static constexpr const char *kSource = R"(
+function scale(a, n, b)
+  local tmp = executor_alloc(64, 16)
+  for i = 0, a[4] * a[5] - 1 do
+    _store_i64(b[2], (b[3] + i) * 8, _load_i64(a[2], (a[3] + i) * 8) * n)
+  end
+  _dealloc(tmp)
+end
+)";
+
+static std::unique_ptr<Executable> buildScaleExecutable() {
+  fb::FlatBufferBuilder64 fbBuilder;
+
+  std::vector<fb::Offset<void>> argTypes = {
+      createMemRefType(fbBuilder, {-1, 2}),
+      impl::CreateScalarType(fbBuilder, impl::ScalarTypeCode::i64).Union(),
+      createMemRefType(fbBuilder, {3, 2})};
+  std::vector<impl::Type> argTypeCodes = {impl::Type::MemRefType,
+                                          impl::Type::ScalarType,
+                                          impl::Type::MemRefType};
+  std::vector<fb::Offset<void>> argBounds = {
+      impl::CreateDimensionBounds(
+          fbBuilder, fbBuilder.CreateVector(std::vector<int64_t>{1, 2}),
+          fbBuilder.CreateVector(std::vector<int64_t>{3, 2}))
+          .Union(),
+      impl::CreateValueBounds(fbBuilder,
+                              fbBuilder.CreateVector(std::vector<int64_t>{1}),
+                              fbBuilder.CreateVector(std::vector<int64_t>{4}))
+          .Union(),
+      impl::CreateNoneBounds(fbBuilder).Union()};
+  std::vector<impl::Bounds> argBoundsCodes = {impl::Bounds::DimensionBounds,
+                                              impl::Bounds::ValueBounds,
+                                              impl::Bounds::NoneBounds};
+
+  auto signature =
+      createSignature(fbBuilder, std::move(argTypeCodes), std::move(argTypes),
+                      std::move(argBoundsCodes), std::move(argBounds));
+  return finishExecutable(
+      fbBuilder, "benchmark_test", kSource,
+      {impl::CreateFunction(fbBuilder, fbBuilder.CreateString("scale"),
+                            signature)});
+}
+
+/// Write `data` to a new temporary file and return its path.
+static std::string writeTemporaryFile(llvm::ArrayRef<int64_t> data) {
+  int fd;
+  llvm::SmallString<128> path;
+  std::error_code error =
+      llvm::sys::fs::createTemporaryFile("benchmark", "bin", fd, path);
+  EXPECT_FALSE(error) << error.message();
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  os.write(reinterpret_cast<const char *>(data.data()),
+           data.size() * sizeof(int64_t));
+  return std::string(path);
+}
+
+namespace {
+class LuaBenchmarkTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    executable = buildScaleExecutable();
+    ASSERT_TRUE(executable);
+    StatusOr<std::unique_ptr<RuntimeClient>> clientOr = RuntimeClient::create();
+    ASSERT_TRUE(clientOr.isOk()) << clientOr.getStatus().getString();
+    client = std::move(*clientOr);
+    StatusOr<std::unique_ptr<LuaRuntimeSession>> sessionOr =
+        LuaRuntimeSession::create(RuntimeSessionOptions(1, 0),
+                                  executable->getView());
+    ASSERT_TRUE(sessionOr.isOk()) << sessionOr.getStatus().getString();
+    session = std::move(*sessionOr);
+  }
+
+  BenchmarkOptions getOptions() const {
+    BenchmarkOptions options;
+    options.functionName = "scale";
+    options.numWarmupIterations = 2;
+    options.numIterations = 5;
+    return options;
+  }
+
+  std::unique_ptr<Executable> executable;
+  std::unique_ptr<RuntimeClient> client;
+  std::unique_ptr<LuaRuntimeSession> session;
+};
+} // namespace
+
+TEST(LuaBenchmark, ComputesLatencyStatistics) {
+  std::vector<int64_t> samplesNs(100);
+  for (int64_t i = 0; i < 100; ++i)
+    samplesNs[i] = (i + 1) * 1000000;
+  std::shuffle(samplesNs.begin(), samplesNs.end(), std::mt19937(0));
+
+  LatencyStatistics stats = computeLatencyStatistics(samplesNs);
+  EXPECT_DOUBLE_EQ(stats.min, 1.0);
+  EXPECT_DOUBLE_EQ(stats.max, 100.0);
+  EXPECT_DOUBLE_EQ(stats.mean, 50.5);
+  EXPECT_DOUBLE_EQ(stats.p50, 50.0);
+  EXPECT_DOUBLE_EQ(stats.p90, 90.0);
+  EXPECT_DOUBLE_EQ(stats.p99, 99.0);
+
+  stats = computeLatencyStatistics({3000000});
+  EXPECT_DOUBLE_EQ(stats.p50, 3.0);
+  EXPECT_DOUBLE_EQ(stats.p99, 3.0);
+}
+
+TEST_F(LuaBenchmarkTest, RunsHostOnlyFunction) {
+  for (BenchmarkInputInit init :
+       {BenchmarkInputInit::Random, BenchmarkInputInit::Zeros}) {
+    BenchmarkOptions options = getOptions();
+    options.inputInit = init;
+    StatusOr<BenchmarkResult> result =
+        runBenchmark(*client, *session, options);
+    ASSERT_TRUE(result.isOk()) << result.getStatus().getString();
+    EXPECT_EQ(result->numIterations, 5);
+    EXPECT_LE(result->latency.min, result->latency.p50);
+    EXPECT_LE(result->latency.p50, result->latency.p99);
+    EXPECT_LE(result->latency.p99, result->latency.max);
+    EXPECT_GT(result->throughput, 0.0);
+    // Only the temporary buffer is allocated by the session.
+    EXPECT_EQ(result->hostMemory.numAllocations, 5);
+    EXPECT_EQ(result->hostMemory.peakBytes, 64);
+    EXPECT_EQ(result->deviceMemory.numAllocations, 0);
+  }
+}
+
+TEST_F(LuaBenchmarkTest, ReadsInputFiles) {
+  std::string a = writeTemporaryFile({1, 2, 3, 4, 5, 6});
+  std::string n = writeTemporaryFile({2});
+  BenchmarkOptions options = getOptions();
+  options.inputInit = BenchmarkInputInit::File;
+  options.inputFiles = {a, n};
+  StatusOr<BenchmarkResult> result = runBenchmark(*client, *session, options);
+  EXPECT_TRUE(result.isOk()) << result.getStatus().getString();
+
+  // The files must match the arguments.
+  options.inputFiles = {a};
+  EXPECT_FALSE(runBenchmark(*client, *session, options).isOk());
+  options.inputFiles = {n, n};
+  EXPECT_FALSE(runBenchmark(*client, *session, options).isOk());
+
+  llvm::sys::fs::remove(a);
+  llvm::sys::fs::remove(n);
+}
+
+TEST_F(LuaBenchmarkTest, RejectsInvalidOptions) {
+  BenchmarkOptions options = getOptions();
+  options.functionName = "missing";
+  EXPECT_FALSE(runBenchmark(*client, *session, options).isOk());
+
+  options = getOptions();
+  options.numIterations = 0;
+  EXPECT_FALSE(runBenchmark(*client, *session, options).isOk());
+}
+
+TEST_F(LuaBenchmarkTest, PrintsJson) {
+  StatusOr<BenchmarkResult> result =
+      runBenchmark(*client, *session, getOptions());
+  ASSERT_TRUE(result.isOk()) << result.getStatus().getString();
+
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  printBenchmarkResult(os, *result);
+  llvm::Expected<llvm::json::Value> json = llvm::json::parse(os.str());
+  ASSERT_TRUE(static_cast<bool>(json)) << llvm::toString(json.takeError());
+
+  const llvm::json::Object *object = json->getAsObject();
+  ASSERT_NE(object, nullptr);
+  EXPECT_EQ(*object->getString("function"), "scale");
+  EXPECT_EQ(*object->getInteger("iterations"), 5);
+  EXPECT_NE(object->getObject("latency_ms")->get("p99"), nullptr);
+  EXPECT_EQ(*object->getObject("memory")
+                 ->getObject("host")
+                 ->getInteger("allocations"),
+            5);
+}
@@ -0,0 +1,150 @@
+//===- LuaBoundFunctionTests.cpp ------------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for the argument checks performed by LuaBoundFunction. The tests
+/// use a small host-only executable that is built directly with the flatbuffer
+/// API, so they do not require a compiler or a GPU.
+///
+//===----------------------------------------------------------------------===//
+#include "LuaTestUtils.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::test;
+
+static constexpr int64_t kNumElements = 4;
+
+/// Build an executable containing `add_one` on memrefs of shape `1x4` with
+/// canonical strides. The output argument of `add_one` is aliased as
+/// described by `outputAliases`.
+static std::unique_ptr<Executable>
+buildExecutable(std::vector<int32_t> outputAliases = {}) {
+  return buildAddOneExecutable({1, kNumElements}, {}, {},
+                               std::move(outputAliases));
+}
+
+namespace {
+class LuaBoundFunctionTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    executable = buildExecutable();
+    ASSERT_TRUE(executable);
+    StatusOr<std::unique_ptr<RuntimeClient>> clientOr = RuntimeClient::create();
+    ASSERT_TRUE(clientOr.isOk()) << clientOr.getStatus().getString();
+    client = std::move(*clientOr);
+
+    StatusOr<std::unique_ptr<LuaRuntimeSession>> sessionOr =
+        LuaRuntimeSession::create(options, executable->getView());
+    ASSERT_TRUE(sessionOr.isOk()) << sessionOr.getStatus().getString();
+    session = std::move(*sessionOr);
+
+    StatusOr<std::unique_ptr<LuaBoundFunction>> funcOr =
+        LuaBoundFunction::create(*session, "add_one");
+    ASSERT_TRUE(funcOr.isOk()) << funcOr.getStatus().getString();
+    func = std::move(*funcOr);
+
+    input.resize(kNumElements);
+    std::iota(input.begin(), input.end(), 0);
+    output.assign(kNumElements, 0);
+  }
+
+  std::unique_ptr<MemRefValue> createMemRef(std::vector<int64_t> &data,
+                                            std::vector<int64_t> strides) {
+    return test::createMemRef(*client, data, {1, kNumElements}, strides);
+  }
+
+  RuntimeSessionOptions options{/*numDevices=*/1, /*deviceId=*/0};
+  std::unique_ptr<Executable> executable;
+  std::unique_ptr<RuntimeClient> client;
+  std::unique_ptr<LuaRuntimeSession> session;
+  std::unique_ptr<LuaBoundFunction> func;
+  std::vector<int64_t> input;
+  std::vector<int64_t> output;
+};
+} // namespace
+
+TEST_F(LuaBoundFunctionTest, AcceptsCanonicalStrides) {
+  std::unique_ptr<MemRefValue> in = createMemRef(input, {kNumElements, 1});
+  std::unique_ptr<MemRefValue> out = createMemRef(output, {kNumElements, 1});
+  Status status = func->execute({in.get()}, {out.get()});
+  ASSERT_TRUE(status.isOk()) << status.getString();
+  for (int64_t i = 0; i < kNumElements; ++i)
+    EXPECT_EQ(output[i], input[i] + 1);
+}
+
+TEST_F(LuaBoundFunctionTest, AcceptsUnitStrideOfUnitDimension) {
+  std::unique_ptr<MemRefValue> in = createMemRef(input, {1, 1});
+  std::unique_ptr<MemRefValue> out = createMemRef(output, {kNumElements, 1});
+  Status status = func->execute({in.get()}, {out.get()});
+  ASSERT_TRUE(status.isOk()) << status.getString();
+  for (int64_t i = 0; i < kNumElements; ++i)
+    EXPECT_EQ(output[i], input[i] + 1);
+}
+
+TEST_F(LuaBoundFunctionTest, RejectsStrideMismatch) {
+  std::unique_ptr<MemRefValue> out = createMemRef(output, {kNumElements, 1});
+  for (std::vector<int64_t> strides :
+       {std::vector<int64_t>{2 * kNumElements, 1},
+        std::vector<int64_t>{kNumElements, 2}}) {
+    std::vector<int64_t> padded(2 * kNumElements, 0);
+    std::unique_ptr<MemRefValue> in = createMemRef(padded, strides);
+    Status status = func->execute({in.get()}, {out.get()});
+    ASSERT_FALSE(status.isOk());
+    EXPECT_NE(status.getString().find("Runtime stride mismatch"),
+              std::string::npos)
+        << status.getString();
+  }
+  EXPECT_EQ(output, std::vector<int64_t>(kNumElements, 0));
+}
+
+TEST_F(LuaBoundFunctionTest, ChecksOutputAliases) {
+  std::unique_ptr<Executable> aliasExecutable =
+      buildExecutable(/*outputAliases=*/{0});
+  ASSERT_TRUE(aliasExecutable);
+  StatusOr<std::unique_ptr<LuaRuntimeSession>> aliasSession =
+      LuaRuntimeSession::create(options, aliasExecutable->getView());
+  ASSERT_TRUE(aliasSession.isOk()) << aliasSession.getStatus().getString();
+  StatusOr<std::unique_ptr<LuaBoundFunction>> aliasFunc =
+      LuaBoundFunction::create(**aliasSession, "add_one");
+  ASSERT_TRUE(aliasFunc.isOk()) << aliasFunc.getStatus().getString();
+
+  // The output must be passed the buffer of the donated input.
+  std::unique_ptr<MemRefValue> in = createMemRef(input, {kNumElements, 1});
+  std::unique_ptr<MemRefValue> out = createMemRef(output, {kNumElements, 1});
+  Status status = (*aliasFunc)->execute({in.get()}, {out.get()});
+  ASSERT_FALSE(status.isOk());
+  EXPECT_NE(status.getString().find("must be passed the same buffer"),
+            std::string::npos)
+      << status.getString();
+
+  // Passing the donated buffer for both arguments updates it in place.
+  std::unique_ptr<MemRefValue> inPlace = createMemRef(input, {kNumElements, 1});
+  status = (*aliasFunc)->execute({in.get()}, {inPlace.get()});
+  ASSERT_TRUE(status.isOk()) << status.getString();
+  for (int64_t i = 0; i < kNumElements; ++i)
+    EXPECT_EQ(input[i], i + 1);
+}
+
+TEST_F(LuaBoundFunctionTest, RejectsOutOfRangeOutputAliases) {
+  std::unique_ptr<Executable> aliasExecutable =
+      buildExecutable(/*outputAliases=*/{1});
+  ASSERT_TRUE(aliasExecutable);
+  StatusOr<std::unique_ptr<LuaRuntimeSession>> aliasSession =
+      LuaRuntimeSession::create(options, aliasExecutable->getView());
+  ASSERT_TRUE(aliasSession.isOk()) << aliasSession.getStatus().getString();
+  StatusOr<std::unique_ptr<LuaBoundFunction>> aliasFunc =
+      LuaBoundFunction::create(**aliasSession, "add_one");
+  ASSERT_TRUE(aliasFunc.isOk()) << aliasFunc.getStatus().getString();
+
+  std::unique_ptr<MemRefValue> in = createMemRef(input, {kNumElements, 1});
+  std::unique_ptr<MemRefValue> out = createMemRef(input, {kNumElements, 1});
+  Status status = (*aliasFunc)->execute({in.get()}, {out.get()});
+  ASSERT_FALSE(status.isOk());
+  EXPECT_NE(status.getString().find("only has 1 input arguments"),
+            std::string::npos)
+      << status.getString();
+}
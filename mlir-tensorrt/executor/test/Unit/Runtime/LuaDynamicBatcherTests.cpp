@@ -0,0 +1,162 @@
+//===- LuaDynamicBatcherTests.cpp -----------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for LuaDynamicBatcher. The tests use a host-only executable
+/// with a dynamic batch dimension that is built directly with the flatbuffer
+/// API, so they do not require a compiler or a GPU.
+///
+//===----------------------------------------------------------------------===//
+#include "LuaTestUtils.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaDynamicBatcher.h"
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::test;
+
+static constexpr int64_t kRowSize = 2;
+static constexpr int64_t kMaxBatchSize = 4;
+
+namespace {
+class LuaDynamicBatcherTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    executable = buildAddOneExecutable({-1, kRowSize}, {1, kRowSize},
+                                       {kMaxBatchSize, kRowSize});
+    ASSERT_TRUE(executable);
+    StatusOr<std::unique_ptr<RuntimeClient>> clientOr = RuntimeClient::create();
+    ASSERT_TRUE(clientOr.isOk()) << clientOr.getStatus().getString();
+    client = std::move(*clientOr);
+    StatusOr<std::unique_ptr<LuaSessionPool>> poolOr =
+        LuaSessionPool::create(RuntimeSessionOptions(1, 0),
+                               executable->getView(), 2);
+    ASSERT_TRUE(poolOr.isOk()) << poolOr.getStatus().getString();
+    pool = std::move(*poolOr);
+  }
+
+  std::unique_ptr<LuaDynamicBatcher>
+  createBatcher(DynamicBatchingOptions options) {
+    StatusOr<std::unique_ptr<LuaDynamicBatcher>> batcher =
+        LuaDynamicBatcher::create(*client, *pool, executable->getView(),
+                                  std::move(options));
+    EXPECT_TRUE(batcher.isOk()) << batcher.getStatus().getString();
+    return std::move(*batcher);
+  }
+
+  /// Create requests with the given number of rows.
+  std::vector<AddOneRequest> createRequests(llvm::ArrayRef<int64_t> rows) {
+    std::vector<std::vector<int64_t>> shapes;
+    for (int64_t numRows : rows)
+      shapes.push_back({numRows, kRowSize});
+    return test::createRequests(*client, shapes);
+  }
+
+  static void submitAndCheck(LuaDynamicBatcher &batcher,
+                             std::vector<AddOneRequest> &requests) {
+    std::vector<std::future<Status>> futures;
+    for (AddOneRequest &request : requests)
+      futures.push_back(batcher.submit("add_one", {request.inputMemRef.get()},
+                                       {request.outputMemRef.get()}));
+    for (std::future<Status> &future : futures) {
+      Status status = future.get();
+      EXPECT_TRUE(status.isOk()) << status.getString();
+    }
+    for (const AddOneRequest &request : requests)
+      request.check();
+  }
+
+  std::unique_ptr<Executable> executable;
+  std::unique_ptr<RuntimeClient> client;
+  std::unique_ptr<LuaSessionPool> pool;
+};
+} // namespace
+
+TEST_F(LuaDynamicBatcherTest, CoalescesRequestsIntoFullBatches) {
+  // With a long queue delay, batches are only executed once they are full.
+  DynamicBatchingOptions options;
+  options.maxQueueDelay = std::chrono::seconds(10);
+  std::unique_ptr<LuaDynamicBatcher> batcher = createBatcher(options);
+
+  std::vector<AddOneRequest> requests =
+      createRequests({1, 1, 1, 1, 2, 1, 1});
+  submitAndCheck(*batcher, requests);
+
+  LuaDynamicBatcher::Statistics stats = batcher->getStatistics();
+  EXPECT_EQ(stats.numRequests, 7);
+  EXPECT_EQ(stats.numBatches, 2);
+  EXPECT_EQ(stats.numPaddingRows, 0);
+  EXPECT_EQ(stats.batchSize.getNumSamples(), 2);
+  EXPECT_EQ(stats.batchSize.getMin(), kMaxBatchSize);
+  EXPECT_EQ(stats.latencyUs.getNumSamples(), 7);
+}
+
+TEST_F(LuaDynamicBatcherTest, PadsPartialBatches) {
+  DynamicBatchingOptions options;
+  options.maxQueueDelay = std::chrono::microseconds(100);
+  options.padToMaxBatchSize = true;
+  std::unique_ptr<LuaDynamicBatcher> batcher = createBatcher(options);
+
+  std::vector<AddOneRequest> requests = createRequests({1, 2});
+  submitAndCheck(*batcher, requests);
+
+  // However the requests were split into batches, each batch was padded to
+  // the maximum batch size.
+  LuaDynamicBatcher::Statistics stats = batcher->getStatistics();
+  EXPECT_EQ(stats.numRequests, 2);
+  EXPECT_EQ(stats.numPaddingRows, stats.numBatches * kMaxBatchSize - 3);
+}
+
+TEST_F(LuaDynamicBatcherTest, ExecutesPartialBatchesAfterDelay) {
+  DynamicBatchingOptions options;
+  options.maxQueueDelay = std::chrono::microseconds(100);
+  std::unique_ptr<LuaDynamicBatcher> batcher = createBatcher(options);
+
+  std::vector<AddOneRequest> requests = createRequests({3});
+  submitAndCheck(*batcher, requests);
+  EXPECT_EQ(batcher->getStatistics().numBatches, 1);
+}
+
+TEST_F(LuaDynamicBatcherTest, RejectsInvalidRequests) {
+  std::unique_ptr<LuaDynamicBatcher> batcher = createBatcher({});
+  std::vector<AddOneRequest> requests =
+      createRequests({kMaxBatchSize + 1, 1});
+
+  // The batch extent exceeds the upper bound of the signature.
+  Status status = batcher->submit("add_one", {requests[0].inputMemRef.get()},
+                                  {requests[0].outputMemRef.get()}, {});
+  EXPECT_FALSE(status.isOk());
+
+  // The function does not exist.
+  status = batcher->submit("add_two", {requests[1].inputMemRef.get()},
+                           {requests[1].outputMemRef.get()}, {});
+  EXPECT_FALSE(status.isOk());
+
+  // The number of arguments is wrong.
+  std::future<Status> future =
+      batcher->submit("add_one", {}, {requests[1].outputMemRef.get()});
+  EXPECT_FALSE(future.get().isOk());
+}
+
+TEST_F(LuaDynamicBatcherTest, RejectsMemRefsWithOffsets) {
+  std::unique_ptr<LuaDynamicBatcher> batcher = createBatcher({});
+  std::vector<AddOneRequest> requests = createRequests({1});
+
+  // A view of the input that starts one row into a larger buffer.
+  std::vector<int64_t> data(2 * kRowSize, 1);
+  std::unique_ptr<MemRefValue> offsetMemRef =
+      createMemRef(*client, data, {1, kRowSize}, {}, /*offset=*/kRowSize);
+  ASSERT_TRUE(offsetMemRef);
+
+  std::future<Status> future = batcher->submit(
+      "add_one", {offsetMemRef.get()}, {requests[0].outputMemRef.get()});
+  Status status = future.get();
+  EXPECT_FALSE(status.isOk());
+  EXPECT_NE(status.getString().find("zero offset"), std::string::npos)
+      << status.getString();
+  future = batcher->submit("add_one", {requests[0].inputMemRef.get()},
+                           {offsetMemRef.get()});
+  EXPECT_FALSE(future.get().isOk());
+  EXPECT_EQ(requests[0].output, std::vector<int64_t>(kRowSize, 0));
+}
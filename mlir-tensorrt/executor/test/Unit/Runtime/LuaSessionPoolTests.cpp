@@ -0,0 +1,104 @@
+//===- LuaSessionPoolTests.cpp --------------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for LuaSessionPool. The tests use a small host-only executable
+/// that is built directly with the flatbuffer API, so they do not require a
+/// compiler or a GPU.
+///
+//===----------------------------------------------------------------------===//
+#include "LuaTestUtils.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaSessionPool.h"
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::test;
+
+static constexpr int64_t kNumElements = 4;
+
+namespace {
+class LuaSessionPoolTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    executable = buildAddOneExecutable({kNumElements});
+    ASSERT_TRUE(executable);
+    StatusOr<std::unique_ptr<RuntimeClient>> clientOr = RuntimeClient::create();
+    ASSERT_TRUE(clientOr.isOk()) << clientOr.getStatus().getString();
+    client = std::move(*clientOr);
+  }
+
+  std::vector<AddOneRequest> createRequests(unsigned count) {
+    return test::createRequests(
+        *client, std::vector<std::vector<int64_t>>(count, {kNumElements}));
+  }
+
+  static void checkResults(llvm::ArrayRef<AddOneRequest> requests) {
+    for (const AddOneRequest &request : requests)
+      request.check();
+  }
+
+  RuntimeSessionOptions options{/*numDevices=*/1, /*deviceId=*/0};
+  std::unique_ptr<Executable> executable;
+  std::unique_ptr<RuntimeClient> client;
+};
+} // namespace
+
+TEST_F(LuaSessionPoolTest, RequiresAtLeastOneSession) {
+  StatusOr<std::unique_ptr<LuaSessionPool>> pool =
+      LuaSessionPool::create(options, executable->getView(), 0);
+  EXPECT_FALSE(pool.isOk());
+}
+
+TEST_F(LuaSessionPoolTest, ExecuteWithFutures) {
+  StatusOr<std::unique_ptr<LuaSessionPool>> pool =
+      LuaSessionPool::create(options, executable->getView(), 4);
+  ASSERT_TRUE(pool.isOk()) << pool.getStatus().getString();
+  EXPECT_EQ((*pool)->getNumSessions(), 4u);
+
+  std::vector<AddOneRequest> requests = createRequests(64);
+  std::vector<std::future<Status>> futures;
+  for (AddOneRequest &request : requests)
+    futures.push_back((*pool)->submit("add_one", {request.inputMemRef.get()},
+                                      {request.outputMemRef.get()}));
+  for (std::future<Status> &future : futures) {
+    Status status = future.get();
+    EXPECT_TRUE(status.isOk()) << status.getString();
+  }
+  checkResults(requests);
+
+  LuaSessionPool::Statistics stats = (*pool)->getStatistics();
+  EXPECT_EQ(stats.numSessions, 4);
+  EXPECT_EQ(stats.queueDepth, 0);
+  EXPECT_EQ(stats.numCompletedRequests, 64);
+  EXPECT_LE(stats.numStolenRequests, 64);
+}
+
+TEST_F(LuaSessionPoolTest, ExecuteWithCallbacks) {
+  std::vector<AddOneRequest> requests = createRequests(32);
+  std::atomic<int64_t> numSucceeded{0};
+  std::atomic<int64_t> numFailed{0};
+  {
+    StatusOr<std::unique_ptr<LuaSessionPool>> pool =
+        LuaSessionPool::create(options, executable->getView(), 3);
+    ASSERT_TRUE(pool.isOk()) << pool.getStatus().getString();
+    for (AddOneRequest &request : requests)
+      (*pool)->submit("add_one", {request.inputMemRef.get()},
+                      {request.outputMemRef.get()}, [&](Status status) {
+                        (status.isOk() ? numSucceeded : numFailed)++;
+                      });
+
+    // A request with the wrong number of arguments fails without affecting
+    // the other requests.
+    (*pool)->submit("add_one", {}, {requests[0].outputMemRef.get()},
+                    [&](Status status) {
+                      (status.isOk() ? numSucceeded : numFailed)++;
+                    });
+
+    // Destroying the pool waits for all queued requests.
+  }
+  EXPECT_EQ(numSucceeded.load(), 32);
+  EXPECT_EQ(numFailed.load(), 1);
+  checkResults(requests);
+}
@@ -0,0 +1,107 @@
+//===- LuaSessionTemplateTests.cpp ----------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for LuaRuntimeSessionTemplate. The tests use executables that
+/// are serialized directly with the flatbuffer API, so they do not require a
+/// compiler or a GPU.
+///
+//===----------------------------------------------------------------------===//
+#include "ExecutableTestUtils.h"
+#include <cstring>
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::test;
+
+namespace {
+class LuaSessionTemplateTest : public ::testing::Test {
+protected:
+  void createTemplate(llvm::ArrayRef<TestConstant> constants) {
+    executable = loadExecutable(serializeExecutable("", constants));
+    ASSERT_TRUE(executable);
+    StatusOr<std::unique_ptr<LuaRuntimeSessionTemplate>> tmplOr =
+        LuaRuntimeSessionTemplate::create(executable->getView());
+    ASSERT_TRUE(tmplOr.isOk()) << tmplOr.getStatus().getString();
+    tmpl = std::move(*tmplOr);
+  }
+
+  std::unique_ptr<LuaRuntimeSession> createSession() {
+    StatusOr<std::unique_ptr<LuaRuntimeSession>> session = tmpl->createSession(
+        RuntimeSessionOptions(/*numDevices=*/1, /*deviceId=*/0));
+    EXPECT_TRUE(session.isOk()) << session.getStatus().getString();
+    if (!session.isOk())
+      return nullptr;
+    return std::move(*session);
+  }
+
+  /// Check that `ptr` holds the data of `constant`.
+  static void checkData(uintptr_t ptr, const TestConstant &constant) {
+    ASSERT_NE(ptr, 0u);
+    EXPECT_EQ(std::memcmp(reinterpret_cast<const void *>(ptr),
+                          constant.data.data(), constant.data.size()),
+              0);
+  }
+
+  std::unique_ptr<Executable> executable;
+  std::unique_ptr<LuaRuntimeSessionTemplate> tmpl;
+};
+} // namespace
+
+TEST_F(LuaSessionTemplateTest, SessionsShareConstants) {
+  std::vector<TestConstant> constants = {{"c0", {1, 2, 3, 4, 5, 6, 7, 8}},
+                                         {"c1", {9, 10, 11, 12}}};
+  createTemplate(constants);
+  std::unique_ptr<LuaRuntimeSession> first = createSession();
+  std::unique_ptr<LuaRuntimeSession> second = createSession();
+  ASSERT_TRUE(first && second);
+
+  // Both sessions bind the buffers of the template instead of their own.
+  for (const TestConstant &constant : constants) {
+    uintptr_t ptr = getConstantAddress(*first, constant.name);
+    checkData(ptr, constant);
+    EXPECT_EQ(getConstantAddress(*second, constant.name), ptr);
+    EXPECT_TRUE(first->getAllocTracker().isTrackedByParent(ptr));
+    EXPECT_TRUE(second->getAllocTracker().isTrackedByParent(ptr));
+  }
+}
+
+TEST_F(LuaSessionTemplateTest, ParentOwnedConstantsCannotBeFreed) {
+  std::vector<TestConstant> constants = {{"c0", {1, 2, 3, 4, 5, 6, 7, 8}}};
+  createTemplate(constants);
+  std::unique_ptr<LuaRuntimeSession> first = createSession();
+  std::unique_ptr<LuaRuntimeSession> second = createSession();
+  ASSERT_TRUE(first && second);
+
+  // The template owns the constant, so a session must not free it.
+  uintptr_t ptr = getConstantAddress(*first, "c0");
+  Status status = safeDeallocate(first->getAllocTracker(), ptr);
+  EXPECT_EQ(status.getCode(), StatusCode::InvalidArgument)
+      << status.getString();
+
+  // The constant is still tracked and usable by every session.
+  EXPECT_TRUE(first->getAllocTracker().contains(ptr));
+  EXPECT_TRUE(second->getAllocTracker().contains(ptr));
+  checkData(getConstantAddress(*second, "c0"), constants.front());
+}
+
+TEST_F(LuaSessionTemplateTest, SplatConstantsAreShared) {
+  std::vector<TestConstant> constants = {
+      {"splat", {1, 2, 3}, ConstantEncoding::splat, 3 * 7}};
+  createTemplate(constants);
+  std::unique_ptr<LuaRuntimeSession> first = createSession();
+  std::unique_ptr<LuaRuntimeSession> second = createSession();
+  ASSERT_TRUE(first && second);
+
+  // The template decodes the constant once, and every session binds it.
+  TestConstant decoded = {"splat", {}};
+  for (unsigned i = 0; i < 7; ++i)
+    decoded.data.insert(decoded.data.end(), {1, 2, 3});
+  uintptr_t ptr = getConstantAddress(*first, "splat");
+  checkData(ptr, decoded);
+  EXPECT_EQ(getConstantAddress(*second, "splat"), ptr);
+  EXPECT_TRUE(first->getAllocTracker().isTrackedByParent(ptr));
+  EXPECT_TRUE(second->getAllocTracker().isTrackedByParent(ptr));
+}
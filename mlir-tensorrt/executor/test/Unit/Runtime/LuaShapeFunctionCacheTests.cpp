@@ -0,0 +1,210 @@
+//===- LuaShapeFunctionCacheTests.cpp -------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for LuaShapeFunctionCache. The tests use a host-only executable
+/// with a shape function that is built directly with the flatbuffer API, so
+/// they do not require a compiler or a GPU.
+///
+//===----------------------------------------------------------------------===//
+#include "LuaTestUtils.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaShapeFunctionCache.h"
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+using namespace mlirtrt::runtime::test;
+
+/// `main_get_shapes(s, r)` computes the shape `[2 * s[0], s[1]]` of the
+/// output of `main`, which is not meant to be executed.
+static constexpr const char *kSource = R"(
+function main(a, b)
+end
+
+function main_get_shapes(s, r)
+  _store_i64(r[2], r[3] * 8, 2 * _load_i64(s[2], s[3] * 8))
+  _store_i64(r[2], (r[3] + 1) * 8, _load_i64(s[2], (s[3] + 1) * 8))
+end
+)";
+
+/// Build an executable with `main(a, b)`, where `a` and `b` are host memrefs
+/// of shape `? x 2` and type i64, and its shape function `main_get_shapes`.
+static std::unique_ptr<Executable> buildExecutable() {
+  fb::FlatBufferBuilder64 fbBuilder;
+
+  auto mainSignature = createMemRefSignature(
+      fbBuilder,
+      {createMemRefType(fbBuilder, {-1, 2}),
+       createMemRefType(fbBuilder, {-1, 2})},
+      "main_get_shapes");
+  auto shapeSignature = createMemRefSignature(
+      fbBuilder,
+      {createMemRefType(fbBuilder, {2}), createMemRefType(fbBuilder, {2})});
+  return finishExecutable(
+      fbBuilder, "shape_function_cache_test", kSource,
+      {impl::CreateFunction(fbBuilder, fbBuilder.CreateString("main"),
+                            mainSignature),
+       impl::CreateFunction(fbBuilder,
+                            fbBuilder.CreateString("main_get_shapes"),
+                            shapeSignature)});
+}
+
+namespace {
+class LuaShapeFunctionCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    executable = buildExecutable();
+    ASSERT_TRUE(executable);
+    StatusOr<std::unique_ptr<RuntimeClient>> clientOr = RuntimeClient::create();
+    ASSERT_TRUE(clientOr.isOk()) << clientOr.getStatus().getString();
+    client = std::move(*clientOr);
+    StatusOr<std::unique_ptr<LuaRuntimeSession>> sessionOr =
+        LuaRuntimeSession::create(RuntimeSessionOptions(1, 0),
+                                  executable->getView());
+    ASSERT_TRUE(sessionOr.isOk()) << sessionOr.getStatus().getString();
+    session = std::move(*sessionOr);
+  }
+
+  std::unique_ptr<LuaShapeFunctionCache> createCache(size_t capacity) {
+    StatusOr<std::unique_ptr<LuaShapeFunctionCache>> cache =
+        LuaShapeFunctionCache::create(*client, *session, "main", capacity);
+    EXPECT_TRUE(cache.isOk()) << cache.getStatus().getString();
+    return std::move(*cache);
+  }
+
+  std::unique_ptr<MemRefValue> createInput(int64_t numRows) {
+    data.resize(std::max<size_t>(data.size(), numRows * 2));
+    return createMemRef(*client, data, {numRows, 2});
+  }
+
+  std::unique_ptr<Executable> executable;
+  std::unique_ptr<RuntimeClient> client;
+  std::unique_ptr<LuaRuntimeSession> session;
+  std::vector<int64_t> data = std::vector<int64_t>(64);
+};
+} // namespace
+
+TEST_F(LuaShapeFunctionCacheTest, MemoizesOutputShapes) {
+  std::unique_ptr<LuaShapeFunctionCache> cache = createCache(4);
+  std::unique_ptr<MemRefValue> input = createInput(3);
+
+  for (int i = 0; i < 3; ++i) {
+    StatusOr<LuaShapeFunctionCache::OutputShapes> shapes =
+        cache->getOutputShapes({input.get()});
+    ASSERT_TRUE(shapes.isOk()) << shapes.getStatus().getString();
+    ASSERT_EQ(shapes->size(), 1u);
+    EXPECT_EQ((*shapes)[0], llvm::SmallVector<int64_t>({6, 2}));
+  }
+
+  LuaShapeFunctionCache::Statistics stats = cache->getStatistics();
+  EXPECT_EQ(stats.numMisses, 1);
+  EXPECT_EQ(stats.numHits, 2);
+  EXPECT_EQ(stats.numEntries, 1);
+}
+
+TEST_F(LuaShapeFunctionCacheTest, EvictsLeastRecentlyUsedEntries) {
+  std::unique_ptr<LuaShapeFunctionCache> cache = createCache(2);
+  auto getShapes = [&](int64_t numRows) {
+    llvm::SmallVector<int64_t> shape = {numRows, 2};
+    StatusOr<LuaShapeFunctionCache::OutputShapes> shapes =
+        cache->getOutputShapesForInputShapes({shape});
+    EXPECT_TRUE(shapes.isOk()) << shapes.getStatus().getString();
+    EXPECT_EQ((*shapes)[0], llvm::SmallVector<int64_t>({2 * numRows, 2}));
+  };
+
+  getShapes(1);
+  getShapes(2);
+  // Touch `1` so that `2` is the least recently used entry.
+  getShapes(1);
+  getShapes(3);
+  getShapes(1);
+  LuaShapeFunctionCache::Statistics stats = cache->getStatistics();
+  EXPECT_EQ(stats.numMisses, 3);
+  EXPECT_EQ(stats.numHits, 2);
+  EXPECT_EQ(stats.numEvictions, 1);
+  EXPECT_EQ(stats.numEntries, 2);
+
+  // `2` was evicted.
+  getShapes(2);
+  EXPECT_EQ(cache->getStatistics().numMisses, 4);
+}
+
+TEST_F(LuaShapeFunctionCacheTest, AllocatesOutputs) {
+  std::unique_ptr<LuaShapeFunctionCache> cache = createCache(4);
+  std::unique_ptr<MemRefValue> input = createInput(5);
+
+  StatusOr<llvm::SmallVector<std::unique_ptr<MemRefValue>>> outputs =
+      cache->allocateOutputs({input.get()});
+  ASSERT_TRUE(outputs.isOk()) << outputs.getStatus().getString();
+  ASSERT_EQ(outputs->size(), 1u);
+  std::unique_ptr<MemRefValue> &output = (*outputs)[0];
+  EXPECT_EQ(output->getAddressSpace(), PointerType::host);
+  EXPECT_EQ(output->getShape(), llvm::ArrayRef<int64_t>({10, 2}));
+  EXPECT_EQ(output->getStrides(), llvm::ArrayRef<int64_t>({2, 1}));
+  EXPECT_EQ(output->getElementBitWidth(), 64);
+  EXPECT_TRUE(client->deallocate(std::move(output)).isOk());
+}
+
+TEST_F(LuaShapeFunctionCacheTest, RejectsInvalidUses) {
+  // The shape function has no shape function of its own.
+  EXPECT_FALSE(
+      LuaShapeFunctionCache::create(*client, *session, "main_get_shapes")
+          .isOk());
+  EXPECT_FALSE(
+      LuaShapeFunctionCache::create(*client, *session, "missing").isOk());
+  EXPECT_FALSE(
+      LuaShapeFunctionCache::create(*client, *session, "main", 0).isOk());
+
+  std::unique_ptr<LuaShapeFunctionCache> cache = createCache(4);
+  EXPECT_FALSE(cache->getOutputShapes({}).isOk());
+  EXPECT_FALSE(cache->getOutputShapesForInputShapes({}).isOk());
+}
+
+TEST_F(LuaShapeFunctionCacheTest, DistinguishesInputValuesByOffset) {
+  // `value(a, b)` has an output of shape `[a[0]]`, so its shape function
+  // reads the contents of `a`.
+  static constexpr const char *kValueSource = R"(
+function value(a, b)
+end
+
+function value_get_shapes(a, r)
+  _store_i64(r[2], r[3] * 8, _load_i64(a[2], a[3] * 8))
+end
+)";
+  fb::FlatBufferBuilder64 fbBuilder;
+  auto valueSignature = createMemRefSignature(
+      fbBuilder,
+      {createMemRefType(fbBuilder, {-1}), createMemRefType(fbBuilder, {-1})},
+      "value_get_shapes");
+  auto shapeSignature = createMemRefSignature(
+      fbBuilder,
+      {createMemRefType(fbBuilder, {-1}), createMemRefType(fbBuilder, {1})});
+  std::unique_ptr<Executable> valueExecutable = finishExecutable(
+      fbBuilder, "shape_function_value_test", kValueSource,
+      {impl::CreateFunction(fbBuilder, fbBuilder.CreateString("value"),
+                            valueSignature),
+       impl::CreateFunction(fbBuilder,
+                            fbBuilder.CreateString("value_get_shapes"),
+                            shapeSignature)});
+  ASSERT_TRUE(valueExecutable);
+  StatusOr<std::unique_ptr<LuaRuntimeSession>> valueSession =
+      LuaRuntimeSession::create(RuntimeSessionOptions(1, 0),
+                                valueExecutable->getView());
+  ASSERT_TRUE(valueSession.isOk()) << valueSession.getStatus().getString();
+  StatusOr<std::unique_ptr<LuaShapeFunctionCache>> cache =
+      LuaShapeFunctionCache::create(*client, **valueSession, "value", 4);
+  ASSERT_TRUE(cache.isOk()) << cache.getStatus().getString();
+
+  // Two views of the same buffer that only differ in their offset.
+  std::vector<int64_t> values = {2, 3};
+  for (int64_t offset : {0, 1}) {
+    std::unique_ptr<MemRefValue> input =
+        createMemRef(*client, values, {1}, {}, offset);
+    StatusOr<LuaShapeFunctionCache::OutputShapes> shapes =
+        (*cache)->getOutputShapes({input.get()});
+    ASSERT_TRUE(shapes.isOk()) << shapes.getStatus().getString();
+    EXPECT_EQ((*shapes)[0], llvm::SmallVector<int64_t>({values[offset]}));
+  }
+  EXPECT_EQ((*cache)->getStatistics().numMisses, 2);
+}
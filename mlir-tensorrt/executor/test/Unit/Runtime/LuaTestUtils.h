@@ -0,0 +1,226 @@
+//===- LuaTestUtils.h -------------------------------------------*- C++ -*-===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Utilities shared by the Lua runtime unit tests. They build small host-only
+/// executables directly with the flatbuffer API, so that the tests do not
+/// require a compiler or a GPU, and create host memrefs and requests for them.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_EXECUTOR_TEST_UNIT_RUNTIME_LUATESTUTILS
+#define MLIR_EXECUTOR_TEST_UNIT_RUNTIME_LUATESTUTILS
+
+#include "mlir-executor/Runtime/API/API.h"
+#include "mlir-executor/Runtime/API/ExecutableFlatbuffer.h"
+#include "llvm/ADT/STLExtras.h"
+#include "gtest/gtest.h"
+#include <functional>
+#include <numeric>
+#include <string>
+#include <string_view>
+
+namespace mlirtrt::runtime::test {
+
+namespace fb = flatbuffers;
+
+/// Return the canonical (row-major) strides of `shape`. Strides that depend
+/// on a dynamic extent are dynamic (-1).
+inline std::vector<int64_t> getCanonicalStrides(llvm::ArrayRef<int64_t> shape) {
+  std::vector<int64_t> strides(shape.size(), 1);
+  for (int64_t i = static_cast<int64_t>(shape.size()) - 2; i >= 0; --i)
+    strides[i] = shape[i + 1] < 0 || strides[i + 1] < 0
+                     ? -1
+                     : strides[i + 1] * shape[i + 1];
+  return strides;
+}
+
+/// Create the type of a host memref of i64 elements. If `strides` is empty,
+/// the canonical strides of `shape` are used.
+inline fb::Offset<void> createMemRefType(fb::FlatBufferBuilder64 &fbBuilder,
+                                         llvm::ArrayRef<int64_t> shape,
+                                         llvm::ArrayRef<int64_t> strides = {}) {
+  std::vector<int64_t> stridesVec = strides.empty()
+                                        ? getCanonicalStrides(shape)
+                                        : std::vector<int64_t>(strides);
+  return impl::CreateMemRefType(fbBuilder, impl::ScalarTypeCode::i64,
+                                fbBuilder.CreateVector(shape.vec()),
+                                fbBuilder.CreateVector(stridesVec),
+                                impl::PointerType::host)
+      .Union();
+}
+
+/// Create the signature of a function with one output argument (the last
+/// argument) and no results. If `argBounds` is empty, no argument has bounds.
+inline fb::Offset<impl::FunctionSignature>
+createSignature(fb::FlatBufferBuilder64 &fbBuilder,
+                std::vector<impl::Type> argTypeCodes,
+                std::vector<fb::Offset<void>> argTypes,
+                std::vector<impl::Bounds> argBoundsCodes = {},
+                std::vector<fb::Offset<void>> argBounds = {},
+                std::string_view shapeFunctionName = "",
+                std::vector<int32_t> outputAliases = {}) {
+  if (argBounds.empty()) {
+    for (size_t i = 0; i < argTypes.size(); ++i)
+      argBounds.push_back(impl::CreateNoneBounds(fbBuilder).Union());
+    argBoundsCodes.assign(argTypes.size(), impl::Bounds::NoneBounds);
+  }
+  return impl::CreateFunctionSignature(
+      fbBuilder, fbBuilder.CreateVector(argTypeCodes),
+      fbBuilder.CreateVector(argTypes),
+      fbBuilder.CreateVector(std::vector<impl::Type>{}),
+      fbBuilder.CreateVector(std::vector<fb::Offset<void>>{}),
+      /*num_output_args=*/1, fbBuilder.CreateVector(argBoundsCodes),
+      fbBuilder.CreateVector(argBounds),
+      fbBuilder.CreateVector(std::vector<impl::Bounds>{}),
+      fbBuilder.CreateVector(std::vector<fb::Offset<void>>{}),
+      fbBuilder.CreateString(shapeFunctionName.data(),
+                             shapeFunctionName.size()),
+      impl::CallingConvention::unpacked, fbBuilder.CreateVector(outputAliases));
+}
+
+/// Create the signature of a function whose arguments are all memrefs of the
+/// given types and that has no bounds.
+inline fb::Offset<impl::FunctionSignature>
+createMemRefSignature(fb::FlatBufferBuilder64 &fbBuilder,
+                      std::vector<fb::Offset<void>> argTypes,
+                      std::string_view shapeFunctionName = "") {
+  std::vector<impl::Type> argTypeCodes(argTypes.size(),
+                                       impl::Type::MemRefType);
+  return createSignature(fbBuilder, std::move(argTypeCodes),
+                         std::move(argTypes), {}, {}, shapeFunctionName);
+}
+
+/// Finish building an executable called `name` that contains `functions`
+/// and the Lua `source`, and load it.
+inline std::unique_ptr<Executable>
+finishExecutable(fb::FlatBufferBuilder64 &fbBuilder, std::string_view name,
+                 std::string_view source,
+                 std::vector<fb::Offset<impl::Function>> functions) {
+  auto constantsOffset =
+      fbBuilder.CreateVector(std::vector<fb::Offset<impl::Constant>>{});
+  auto functionsOffset = fbBuilder.CreateVector(functions);
+  auto gridShapeOffset = fbBuilder.CreateVector(std::vector<uint32_t>{1, 1});
+  auto sourceOffset = fbBuilder.CreateString(source.data(), source.size());
+  auto nameOffset = fbBuilder.CreateString(name.data(), name.size());
+  impl::ExecutableBuilder exeBuilder(fbBuilder);
+  exeBuilder.add_process_grid_shape(gridShapeOffset);
+  exeBuilder.add_functions(functionsOffset);
+  exeBuilder.add_constants(constantsOffset);
+  exeBuilder.add_source(sourceOffset);
+  exeBuilder.add_name(nameOffset);
+  fbBuilder.Finish(exeBuilder.Finish());
+
+  StatusOr<std::unique_ptr<Executable>> exe =
+      Executable::loadFromUnalignedRef(llvm::ArrayRef<char>(
+          reinterpret_cast<const char *>(fbBuilder.GetBufferPointer()),
+          fbBuilder.GetSize()));
+  EXPECT_TRUE(exe.isOk()) << exe.getStatus().getString();
+  if (!exe.isOk())
+    return nullptr;
+  return std::move(*exe);
+}
+
+/// Build an executable containing `add_one(a, b)`, which stores `a + 1` into
+/// `b`. `a` and `b` are host memrefs of type i64 with the given `shape` and
+/// its canonical strides. If `minShape` and `maxShape` are given, they are
+/// the dimension bounds of both arguments. The output argument is aliased as
+/// described by `outputAliases`.
+inline std::unique_ptr<Executable>
+buildAddOneExecutable(llvm::ArrayRef<int64_t> shape,
+                      llvm::ArrayRef<int64_t> minShape = {},
+                      llvm::ArrayRef<int64_t> maxShape = {},
+                      std::vector<int32_t> outputAliases = {}) {
+  // A memref is passed as the table `{allocated, aligned, offset, shape...,
+  // strides...}`.
+  std::string numElements = "a[4]";
+  for (size_t i = 1; i < shape.size(); ++i)
+    numElements += " * a[" + std::to_string(4 + i) + "]";
+  std::string source = "function add_one(a, b)\n"
+                       "  for i = 0, " +
+                       numElements +
+                       " - 1 do\n"
+                       "    _store_i64(b[2], (b[3] + i) * 8, "
+                       "_load_i64(a[2], (a[3] + i) * 8) + 1)\n"
+                       "  end\n"
+                       "end\n";
+
+  fb::FlatBufferBuilder64 fbBuilder;
+  std::vector<fb::Offset<void>> argTypes;
+  std::vector<fb::Offset<void>> argBounds;
+  std::vector<impl::Bounds> argBoundsCodes;
+  for (unsigned i = 0; i < 2; ++i) {
+    argTypes.push_back(createMemRefType(fbBuilder, shape));
+    if (minShape.empty())
+      continue;
+    argBounds.push_back(
+        impl::CreateDimensionBounds(fbBuilder,
+                                    fbBuilder.CreateVector(minShape.vec()),
+                                    fbBuilder.CreateVector(maxShape.vec()))
+            .Union());
+    argBoundsCodes.push_back(impl::Bounds::DimensionBounds);
+  }
+  auto signature = createSignature(
+      fbBuilder, std::vector<impl::Type>(2, impl::Type::MemRefType),
+      std::move(argTypes), std::move(argBoundsCodes), std::move(argBounds),
+      "", std::move(outputAliases));
+  return finishExecutable(
+      fbBuilder, "add_one_test", source,
+      {impl::CreateFunction(fbBuilder, fbBuilder.CreateString("add_one"),
+                            signature)});
+}
+
+/// Create a host memref of i64 elements that views `data`. If `strides` is
+/// empty, the canonical strides of `shape` are used.
+inline std::unique_ptr<MemRefValue>
+createMemRef(RuntimeClient &client, std::vector<int64_t> &data,
+             llvm::ArrayRef<int64_t> shape,
+             llvm::ArrayRef<int64_t> strides = {}, int64_t offset = 0) {
+  std::vector<int64_t> stridesVec = strides.empty()
+                                        ? getCanonicalStrides(shape)
+                                        : std::vector<int64_t>(strides);
+  StatusOr<std::unique_ptr<MemRefValue>> memref = client.createExternalMemRef(
+      PointerType::host, 64, reinterpret_cast<uintptr_t>(data.data()), offset,
+      shape, stridesVec, {}, ScalarType(ScalarTypeCode::i64));
+  EXPECT_TRUE(memref.isOk()) << memref.getStatus().getString();
+  if (!memref.isOk())
+    return nullptr;
+  return std::move(*memref);
+}
+
+/// The host buffers and memrefs of one call of `add_one`.
+struct AddOneRequest {
+  std::vector<int64_t> input;
+  std::vector<int64_t> output;
+  std::unique_ptr<MemRefValue> inputMemRef;
+  std::unique_ptr<MemRefValue> outputMemRef;
+
+  /// Check that `output` holds the result of `add_one`.
+  void check() const {
+    for (auto [in, out] : llvm::zip_equal(input, output))
+      EXPECT_EQ(out, in + 1);
+  }
+};
+
+/// Create one request for each shape in `shapes`. The input of the i-th
+/// request counts up from `10 * i` and its output is zero.
+inline std::vector<AddOneRequest>
+createRequests(RuntimeClient &client,
+               llvm::ArrayRef<std::vector<int64_t>> shapes) {
+  std::vector<AddOneRequest> requests(shapes.size());
+  for (auto [idx, request, shape] : llvm::enumerate(requests, shapes)) {
+    int64_t numElements = std::accumulate(shape.begin(), shape.end(),
+                                          int64_t{1}, std::multiplies<>());
+    request.input.resize(numElements);
+    std::iota(request.input.begin(), request.input.end(), idx * 10);
+    request.output.assign(numElements, 0);
+    request.inputMemRef = createMemRef(client, request.input, shape);
+    request.outputMemRef = createMemRef(client, request.output, shape);
+  }
+  return requests;
+}
+
+} // namespace mlirtrt::runtime::test
+
+#endif // MLIR_EXECUTOR_TEST_UNIT_RUNTIME_LUATESTUTILS
@@ -0,0 +1,313 @@
+//===- PinnedMemoryAllocatorTests.cpp  ------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for the buddy allocator used for page-locked host memory. The
+/// tests use host memory and a fake event source, so no GPU is required.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Support/Allocators.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace mlirtrt;
+
+namespace {
+/// An event source whose events complete when the test says so.
+class FakeEventSource : public StreamEventSource {
+public:
+  FakeEventSource(llvm::DenseSet<CudaEvent> &completed)
+      : completed(completed) {}
+
+  StatusOr<CudaEvent> record(CudaStream stream) final {
+    return CudaEvent(nextEvent++);
+  }
+  StatusOr<bool> isComplete(CudaEvent event) final {
+    return completed.contains(event);
+  }
+  void release(CudaEvent event) final {}
+
+private:
+  llvm::DenseSet<CudaEvent> &completed;
+  CudaEvent nextEvent = 1;
+};
+
+/// An event source whose events complete immediately.
+class CompletedEventSource : public StreamEventSource {
+public:
+  StatusOr<CudaEvent> record(CudaStream stream) final { return CudaEvent(1); }
+  StatusOr<bool> isComplete(CudaEvent event) final { return true; }
+  void release(CudaEvent event) final {}
+};
+
+class PinnedMemoryAllocatorTest : public ::testing::Test {
+protected:
+  std::unique_ptr<PinnedMemoryAllocator>
+  createAllocator(PinnedMemoryAllocatorOptions options = {}) {
+    return std::make_unique<PinnedMemoryAllocator>(
+        createHostAllocatorBackend(),
+        std::make_unique<FakeEventSource>(completed), options);
+  }
+
+  /// Free `ptr` and complete the recorded event immediately.
+  void freeAndComplete(PinnedMemoryAllocator &allocator, uintptr_t ptr) {
+    ASSERT_TRUE(allocator.freeAsync(ptr, /*stream=*/0).isOk());
+    completed.insert(++numEvents);
+  }
+
+  llvm::DenseSet<CudaEvent> completed;
+  CudaEvent numEvents = 0;
+};
+} // namespace
+
+static PinnedMemoryAllocatorOptions getSmallChunkOptions() {
+  PinnedMemoryAllocatorOptions options;
+  options.minBlockSize = 256;
+  options.chunkSize = 4096;
+  return options;
+}
+
+TEST_F(PinnedMemoryAllocatorTest, SplitAndMerge) {
+  std::unique_ptr<PinnedMemoryAllocator> allocator =
+      createAllocator(getSmallChunkOptions());
+
+  // Four 1 KiB blocks fit into one chunk.
+  llvm::SmallVector<uintptr_t> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    StatusOr<PinnedMemoryBlock> block = allocator->allocate(1000);
+    ASSERT_TRUE(block.isOk());
+    EXPECT_EQ(block->size, 1024u);
+    ptrs.push_back(block->ptr);
+  }
+  EXPECT_EQ(allocator->getStats().numChunks, 1u);
+  EXPECT_EQ(allocator->getStats().bytesReserved, 4096u);
+
+  for (uintptr_t ptr : ptrs)
+    freeAndComplete(*allocator, ptr);
+
+  // Once the frees complete, the blocks merge back into a whole chunk that
+  // can serve a chunk-sized request.
+  StatusOr<PinnedMemoryBlock> whole = allocator->allocate(4096);
+  ASSERT_TRUE(whole.isOk());
+  EXPECT_EQ(whole->ptr, *std::min_element(ptrs.begin(), ptrs.end()));
+  EXPECT_EQ(allocator->getStats().numChunks, 1u);
+  EXPECT_EQ(allocator->getStats().numPendingFrees, 0u);
+}
+
+TEST_F(PinnedMemoryAllocatorTest, PendingFreesAreNotReused) {
+  std::unique_ptr<PinnedMemoryAllocator> allocator =
+      createAllocator(getSmallChunkOptions());
+
+  StatusOr<PinnedMemoryBlock> first = allocator->allocate(4096);
+  ASSERT_TRUE(first.isOk());
+  ASSERT_TRUE(allocator->freeAsync(first->ptr, /*stream=*/0).isOk());
+  EXPECT_EQ(allocator->getStats().numPendingFrees, 1u);
+
+  // The event has not completed, so a new chunk is required.
+  StatusOr<PinnedMemoryBlock> second = allocator->allocate(4096);
+  ASSERT_TRUE(second.isOk());
+  EXPECT_NE(first->ptr, second->ptr);
+  EXPECT_EQ(allocator->getStats().numChunks, 2u);
+
+  completed.insert(1);
+  ASSERT_TRUE(allocator->freeAsync(second->ptr, /*stream=*/0).isOk());
+  completed.insert(2);
+  StatusOr<PinnedMemoryBlock> third = allocator->allocate(4096);
+  ASSERT_TRUE(third.isOk());
+  EXPECT_TRUE(third->ptr == first->ptr || third->ptr == second->ptr);
+}
+
+TEST_F(PinnedMemoryAllocatorTest, RepeatedFreesReleaseOnce) {
+  std::unique_ptr<PinnedMemoryAllocator> allocator =
+      createAllocator(getSmallChunkOptions());
+
+  StatusOr<PinnedMemoryBlock> block = allocator->allocate(1024);
+  ASSERT_TRUE(block.isOk());
+  // Free the block on two streams, e.g. because it was used by both.
+  ASSERT_TRUE(allocator->freeAsync(block->ptr, /*stream=*/1).isOk());
+  ASSERT_TRUE(allocator->freeAsync(block->ptr, /*stream=*/2).isOk());
+  EXPECT_EQ(allocator->getStats().numPendingFrees, 2u);
+
+  // The block is not released until both events have completed.
+  completed.insert(1);
+  ASSERT_TRUE(allocator->trim().isOk());
+  EXPECT_EQ(allocator->getStats().bytesAllocated, 1024u);
+  EXPECT_EQ(allocator->getStats().numChunks, 1u);
+
+  // Releasing it once returns the whole chunk exactly once.
+  completed.insert(2);
+  ASSERT_TRUE(allocator->trim().isOk());
+  EXPECT_EQ(allocator->getStats().bytesAllocated, 0u);
+  EXPECT_EQ(allocator->getStats().numPendingFrees, 0u);
+  EXPECT_EQ(allocator->getStats().numChunks, 0u);
+  EXPECT_EQ(allocator->getStats().bytesReserved, 0u);
+
+  // The block is no longer allocated.
+  EXPECT_FALSE(allocator->freeAsync(block->ptr, /*stream=*/1).isOk());
+
+  // Blocks handed out afterwards are distinct.
+  StatusOr<PinnedMemoryBlock> first = allocator->allocate(1024);
+  StatusOr<PinnedMemoryBlock> second = allocator->allocate(1024);
+  ASSERT_TRUE(first.isOk() && second.isOk());
+  EXPECT_NE(first->ptr, second->ptr);
+}
+
+TEST_F(PinnedMemoryAllocatorTest, DedicatedAllocationsAreNotRoundedUp) {
+  PinnedMemoryAllocatorOptions options = getSmallChunkOptions();
+  std::unique_ptr<PinnedMemoryAllocator> allocator = createAllocator(options);
+
+  // A request larger than a chunk is only rounded up to the minimum block
+  // size instead of the next power of two.
+  StatusOr<PinnedMemoryBlock> block = allocator->allocate(4096 + 100);
+  ASSERT_TRUE(block.isOk());
+  EXPECT_EQ(block->size, 4096u + 256u);
+  EXPECT_EQ(allocator->getStats().bytesReserved, 4096u + 256u);
+
+  // Released dedicated allocations are cached until the allocator is
+  // trimmed.
+  freeAndComplete(*allocator, block->ptr);
+  ASSERT_TRUE(allocator->trim().isOk());
+  EXPECT_EQ(allocator->getStats().bytesReserved, 0u);
+  EXPECT_EQ(allocator->getStats().numChunks, 0u);
+}
+
+TEST_F(PinnedMemoryAllocatorTest, DedicatedAllocationsAreReused) {
+  std::unique_ptr<PinnedMemoryAllocator> allocator =
+      createAllocator(getSmallChunkOptions());
+
+  StatusOr<PinnedMemoryBlock> first = allocator->allocate(3 * 4096);
+  ASSERT_TRUE(first.isOk());
+  freeAndComplete(*allocator, first->ptr);
+
+  // The next request of the same size reuses the released block instead of
+  // pinning new memory.
+  StatusOr<PinnedMemoryBlock> second = allocator->allocate(3 * 4096);
+  ASSERT_TRUE(second.isOk());
+  EXPECT_EQ(second->ptr, first->ptr);
+  EXPECT_EQ(second->size, first->size);
+  EXPECT_EQ(allocator->getStats().bytesReserved, 3u * 4096u);
+  EXPECT_EQ(allocator->getStats().numChunks, 1u);
+
+  // A cached block is only reused by requests that do not waste most of it.
+  freeAndComplete(*allocator, second->ptr);
+  StatusOr<PinnedMemoryBlock> small = allocator->allocate(4096 + 256);
+  ASSERT_TRUE(small.isOk());
+  EXPECT_NE(small->ptr, first->ptr);
+  EXPECT_EQ(allocator->getStats().bytesCachedDedicated, 3u * 4096u);
+  EXPECT_EQ(allocator->getStats().numChunks, 2u);
+
+  freeAndComplete(*allocator, small->ptr);
+  ASSERT_TRUE(allocator->trim().isOk());
+  EXPECT_EQ(allocator->getStats().bytesCachedDedicated, 0u);
+  EXPECT_EQ(allocator->getStats().bytesReserved, 0u);
+}
+
+TEST_F(PinnedMemoryAllocatorTest, CachedDedicatedAllocationsRespectBudget) {
+  PinnedMemoryAllocatorOptions options = getSmallChunkOptions();
+  options.maxPinnedBytes = 4 * 4096;
+  std::unique_ptr<PinnedMemoryAllocator> allocator = createAllocator(options);
+
+  StatusOr<PinnedMemoryBlock> large = allocator->allocate(3 * 4096);
+  ASSERT_TRUE(large.isOk());
+  freeAndComplete(*allocator, large->ptr);
+  EXPECT_EQ(allocator->getStats().bytesReserved, 3u * 4096u);
+
+  // The cached block is too small to be reused and is returned to the
+  // backend to make room for the new request.
+  StatusOr<PinnedMemoryBlock> larger = allocator->allocate(4 * 4096);
+  ASSERT_TRUE(larger.isOk());
+  EXPECT_EQ(allocator->getStats().bytesCachedDedicated, 0u);
+  EXPECT_EQ(allocator->getStats().bytesReserved, 4u * 4096u);
+  EXPECT_EQ(allocator->getStats().numChunks, 1u);
+}
+
+TEST_F(PinnedMemoryAllocatorTest, FreeChunksAreReleased) {
+  PinnedMemoryAllocatorOptions options = getSmallChunkOptions();
+  options.maxFreeChunks = 1;
+  std::unique_ptr<PinnedMemoryAllocator> allocator = createAllocator(options);
+
+  llvm::SmallVector<uintptr_t> ptrs;
+  for (int i = 0; i < 3; ++i) {
+    StatusOr<PinnedMemoryBlock> block = allocator->allocate(4096);
+    ASSERT_TRUE(block.isOk());
+    ptrs.push_back(block->ptr);
+  }
+  EXPECT_EQ(allocator->getStats().numChunks, 3u);
+  for (uintptr_t ptr : ptrs)
+    freeAndComplete(*allocator, ptr);
+
+  // Processing the completed frees keeps a single free chunk, which serves
+  // the next request.
+  StatusOr<PinnedMemoryBlock> next = allocator->allocate(256);
+  ASSERT_TRUE(next.isOk());
+  EXPECT_EQ(allocator->getStats().numChunks, 1u);
+
+  // Trimming returns all free chunks.
+  freeAndComplete(*allocator, next->ptr);
+  ASSERT_TRUE(allocator->trim().isOk());
+  EXPECT_EQ(allocator->getStats().numChunks, 0u);
+  EXPECT_EQ(allocator->getStats().bytesAllocated, 0u);
+}
+
+TEST_F(PinnedMemoryAllocatorTest, Budget) {
+  PinnedMemoryAllocatorOptions options = getSmallChunkOptions();
+  options.maxPinnedBytes = 8192;
+  std::unique_ptr<PinnedMemoryAllocator> allocator = createAllocator(options);
+
+  StatusOr<PinnedMemoryBlock> a = allocator->allocate(4096);
+  StatusOr<PinnedMemoryBlock> b = allocator->allocate(4096);
+  ASSERT_TRUE(a.isOk() && b.isOk());
+  EXPECT_FALSE(allocator->allocate(256).isOk());
+
+  // Completed frees make room within the budget.
+  freeAndComplete(*allocator, a->ptr);
+  StatusOr<PinnedMemoryBlock> c = allocator->allocate(256);
+  ASSERT_TRUE(c.isOk());
+  EXPECT_EQ(allocator->getStats().bytesReserved, 8192u);
+}
+
+TEST_F(PinnedMemoryAllocatorTest, ConcurrentAllocations) {
+  PinnedMemoryAllocator allocator(createHostAllocatorBackend(),
+                                  std::make_unique<CompletedEventSource>(),
+                                  getSmallChunkOptions());
+
+  // Each thread fills its blocks with its own byte, so blocks that are handed
+  // out twice are detected.
+  constexpr int kNumThreads = 4;
+  std::vector<std::thread> threads;
+  std::vector<int> numErrors(kNumThreads, 0);
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 1000; ++i) {
+        size_t size = 256 << (i % 6);
+        StatusOr<PinnedMemoryBlock> block = allocator.allocate(size);
+        if (!block.isOk()) {
+          numErrors[t]++;
+          continue;
+        }
+        auto *data = reinterpret_cast<unsigned char *>(block->ptr);
+        std::memset(data, t, size);
+        if (std::any_of(data, data + size,
+                        [&](unsigned char c) { return c != t; }))
+          numErrors[t]++;
+        if (!allocator.freeAsync(block->ptr, /*stream=*/0).isOk())
+          numErrors[t]++;
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+
+  for (int errors : numErrors)
+    EXPECT_EQ(errors, 0);
+  ASSERT_TRUE(allocator.trim().isOk());
+  EXPECT_EQ(allocator.getStats().bytesAllocated, 0u);
+  EXPECT_EQ(allocator.getStats().numPendingFrees, 0u);
+  EXPECT_EQ(allocator.getStats().bytesReserved, 0u);
+}
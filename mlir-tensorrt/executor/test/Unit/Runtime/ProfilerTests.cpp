@@ -0,0 +1,210 @@
+//===- ProfilerTests.cpp --------------------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for the runtime profiler.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Support/Profiler.h"
+#include "llvm/Support/JSON.h"
+#include "gtest/gtest.h"
+#include <thread>
+
+using namespace mlirtrt::runtime;
+
+using EventKind = RuntimeProfiler::EventKind;
+
+/// Simulate a copy builtin that moves `numBytes`.
+static void copyBuiltin(int64_t numBytes) {
+  RuntimeProfiler::BuiltinScope scope("copy");
+  RuntimeProfiler::recordBytes(numBytes);
+}
+
+/// Simulate an allocation builtin.
+static void allocBuiltin(uintptr_t ptr, int64_t numBytes) {
+  RuntimeProfiler::BuiltinScope scope("alloc");
+  RuntimeProfiler::recordAllocation(ptr, numBytes);
+}
+
+/// Simulate a deallocation builtin.
+static void freeBuiltin(uintptr_t ptr) {
+  RuntimeProfiler::BuiltinScope scope("free");
+  RuntimeProfiler::recordFree(ptr);
+}
+
+TEST(RuntimeProfiler, IgnoresBuiltinsOutsideOfFunctions) {
+  RuntimeProfiler profiler;
+  copyBuiltin(16);
+  {
+    // A scope without a profiler does not activate profiling.
+    RuntimeProfiler::FunctionScope scope(nullptr, "main");
+    copyBuiltin(16);
+  }
+  EXPECT_EQ(profiler.getStatistics("main", "copy").numCalls, 0);
+  EXPECT_TRUE(profiler.getEvents().empty());
+}
+
+TEST(RuntimeProfiler, AggregatesBuiltinCalls) {
+  RuntimeProfiler profiler;
+  for (int i = 0; i < 2; ++i) {
+    RuntimeProfiler::FunctionScope scope(&profiler, "main");
+    allocBuiltin(0x1000, 64);
+    copyBuiltin(64);
+    copyBuiltin(32);
+    freeBuiltin(0x1000);
+  }
+  {
+    RuntimeProfiler::FunctionScope scope(&profiler, "other");
+    copyBuiltin(8);
+  }
+
+  RuntimeProfiler::Statistics main = profiler.getStatistics("main");
+  EXPECT_EQ(main.numCalls, 2);
+  EXPECT_GE(main.totalNs, 0);
+
+  RuntimeProfiler::Statistics copy = profiler.getStatistics("main", "copy");
+  EXPECT_EQ(copy.numCalls, 4);
+  EXPECT_EQ(copy.numBytes, 192);
+  EXPECT_EQ(copy.numAllocations, 0);
+  EXPECT_LE(copy.totalNs, main.totalNs);
+
+  RuntimeProfiler::Statistics alloc = profiler.getStatistics("main", "alloc");
+  EXPECT_EQ(alloc.numCalls, 2);
+  EXPECT_EQ(alloc.numAllocations, 2);
+  EXPECT_EQ(alloc.numAllocatedBytes, 128);
+
+  EXPECT_EQ(profiler.getStatistics("other", "copy").numBytes, 8);
+  EXPECT_EQ(profiler.getStatistics("other", "alloc").numCalls, 0);
+
+  // Per iteration: 4 builtins, one allocation, one free and the function.
+  std::vector<RuntimeProfiler::Event> events = profiler.getEvents();
+  ASSERT_EQ(events.size(), 2u * 7u + 2u);
+  EXPECT_EQ(events[0].kind, EventKind::Allocation);
+  EXPECT_EQ(events[0].ptr, 0x1000u);
+  EXPECT_EQ(events[0].numBytes, 64);
+  EXPECT_EQ(events[1].kind, EventKind::Builtin);
+  EXPECT_STREQ(events[1].name, "alloc");
+  EXPECT_STREQ(events[1].function, "main");
+  EXPECT_EQ(events[6].kind, EventKind::Function);
+  EXPECT_STREQ(events[6].name, "main");
+  // Builtins are nested in their function.
+  EXPECT_GE(events[1].startNs, events[6].startNs);
+  EXPECT_LE(events[1].startNs + events[1].durationNs,
+            events[6].startNs + events[6].durationNs);
+
+  profiler.reset();
+  EXPECT_EQ(profiler.getStatistics("main").numCalls, 0);
+  EXPECT_TRUE(profiler.getEvents().empty());
+}
+
+TEST(RuntimeProfiler, NestedFunctionScopes) {
+  RuntimeProfiler outer, inner;
+  {
+    RuntimeProfiler::FunctionScope outerScope(&outer, "outer");
+    {
+      RuntimeProfiler::FunctionScope innerScope(&inner, "inner");
+      copyBuiltin(1);
+    }
+    // The outer profiler is restored once the inner scope ends.
+    copyBuiltin(2);
+  }
+  EXPECT_EQ(inner.getStatistics("inner", "copy").numBytes, 1);
+  EXPECT_EQ(outer.getStatistics("outer", "copy").numBytes, 2);
+  EXPECT_EQ(outer.getStatistics("inner", "copy").numCalls, 0);
+}
+
+TEST(RuntimeProfiler, LimitsNumberOfEvents) {
+  RuntimeProfiler profiler(/*maxNumEvents=*/4);
+  {
+    RuntimeProfiler::FunctionScope scope(&profiler, "main");
+    for (int i = 0; i < 10; ++i)
+      copyBuiltin(1);
+  }
+  EXPECT_EQ(profiler.getEvents().size(), 4u);
+  EXPECT_EQ(profiler.getNumDroppedEvents(), 7);
+  // Statistics are still complete.
+  EXPECT_EQ(profiler.getStatistics("main", "copy").numCalls, 10);
+}
+
+TEST(RuntimeProfiler, ConcurrentFunctions) {
+  RuntimeProfiler profiler;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&profiler] {
+      for (int i = 0; i < 100; ++i) {
+        RuntimeProfiler::FunctionScope scope(&profiler, "main");
+        copyBuiltin(4);
+      }
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  EXPECT_EQ(profiler.getStatistics("main").numCalls, 400);
+  EXPECT_EQ(profiler.getStatistics("main", "copy").numBytes, 1600);
+}
+
+TEST(RuntimeProfiler, PrintsChromeTrace) {
+  RuntimeProfiler profiler;
+  {
+    RuntimeProfiler::FunctionScope scope(&profiler, "main");
+    allocBuiltin(0xabc0, 64);
+    copyBuiltin(64);
+  }
+
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  profiler.printChromeTrace(os);
+  llvm::Expected<llvm::json::Value> trace = llvm::json::parse(os.str());
+  ASSERT_TRUE(static_cast<bool>(trace)) << llvm::toString(trace.takeError());
+
+  const llvm::json::Array *events =
+      trace->getAsObject()->getArray("traceEvents");
+  ASSERT_NE(events, nullptr);
+  ASSERT_EQ(events->size(), 4u);
+
+  const llvm::json::Object *alloc = (*events)[0].getAsObject();
+  EXPECT_EQ(*alloc->getString("name"), "alloc");
+  EXPECT_EQ(*alloc->getString("ph"), "i");
+  EXPECT_EQ(*alloc->getObject("args")->getString("ptr"), "0xABC0");
+  EXPECT_EQ(*alloc->getObject("args")->getInteger("bytes"), 64);
+
+  const llvm::json::Object *copy = (*events)[2].getAsObject();
+  EXPECT_EQ(*copy->getString("name"), "copy");
+  EXPECT_EQ(*copy->getString("ph"), "X");
+  EXPECT_NE(copy->get("dur"), nullptr);
+  EXPECT_EQ(*copy->getObject("args")->getString("function"), "main");
+  EXPECT_EQ(*copy->getObject("args")->getInteger("bytes"), 64);
+
+  EXPECT_EQ(*(*events)[3].getAsObject()->getString("cat"), "function");
+}
+
+TEST(RuntimeProfiler, PrintsSummary) {
+  RuntimeProfiler profiler;
+  {
+    RuntimeProfiler::FunctionScope scope(&profiler, "main");
+    copyBuiltin(64);
+    allocBuiltin(0x1000, 32);
+  }
+
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  profiler.printSummary(os);
+  llvm::SmallVector<llvm::StringRef> lines;
+  llvm::StringRef(os.str()).trim().split(lines, '\n');
+  ASSERT_EQ(lines.size(), 4u);
+  EXPECT_TRUE(lines[0].starts_with("function / builtin"));
+  EXPECT_TRUE(lines[1].starts_with("main "));
+  // Builtins are indented below their function.
+  EXPECT_TRUE(lines[2].starts_with("  "));
+  EXPECT_TRUE(lines[3].starts_with("  "));
+  llvm::StringRef copyLine =
+      lines[2].contains("copy") ? lines[2] : lines[3];
+  llvm::SmallVector<llvm::StringRef> columns;
+  copyLine.split(columns, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  ASSERT_EQ(columns.size(), 7u);
+  EXPECT_EQ(columns[0], "copy");
+  EXPECT_EQ(columns[1], "1");
+  EXPECT_EQ(columns[4], "64");
+}
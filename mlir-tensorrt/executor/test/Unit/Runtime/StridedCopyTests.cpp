@@ -0,0 +1,189 @@
+//===- StridedCopyTests.cpp -----------------------------------------------===//
+//
+// Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Unit tests for the strided copy planner and the host copy kernels.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <numeric>
+#include <random>
+
+using namespace mlirtrt::runtime;
+
+using Kind = StridedCopyPlan::Kind;
+
+/// Copy one element at a time, which is the reference implementation.
+static void copyElementwise(int64_t elemSize, const char *src,
+                            int64_t srcOffset,
+                            const std::vector<int64_t> &srcStrides, char *dst,
+                            int64_t dstOffset,
+                            const std::vector<int64_t> &dstStrides,
+                            const std::vector<int64_t> &shape) {
+  int64_t numElements = std::accumulate(shape.begin(), shape.end(), int64_t(1),
+                                        std::multiplies<int64_t>());
+  for (int64_t linear = 0; linear < numElements; ++linear) {
+    int64_t srcIdx = srcOffset, dstIdx = dstOffset, rem = linear;
+    for (int64_t d = static_cast<int64_t>(shape.size()) - 1; d >= 0; --d) {
+      srcIdx += (rem % shape[d]) * srcStrides[d];
+      dstIdx += (rem % shape[d]) * dstStrides[d];
+      rem /= shape[d];
+    }
+    std::memcpy(dst + dstIdx * elemSize, src + srcIdx * elemSize, elemSize);
+  }
+}
+
+/// Return the strides of a buffer of shape `shape` whose dimensions are laid
+/// out in the order `perm` (outermost first), with `padding` extra elements
+/// per dimension. Sets `size` to the number of elements of the buffer.
+static std::vector<int64_t> getStrides(const std::vector<int64_t> &shape,
+                                       const std::vector<int64_t> &perm,
+                                       int64_t padding, int64_t &size) {
+  std::vector<int64_t> strides(shape.size());
+  size = 1;
+  for (auto it = perm.rbegin(); it != perm.rend(); ++it) {
+    strides[*it] = size;
+    size *= shape[*it] + padding;
+  }
+  return strides;
+}
+
+TEST(StridedCopyPlanTest, CoalescesContiguousCopy) {
+  StridedCopyPlan plan =
+      planStridedCopy(4, {2, 3, 4}, 5, {12, 4, 1}, 7, {12, 4, 1});
+  EXPECT_EQ(plan.getKind(), Kind::Contiguous);
+  EXPECT_EQ(plan.runSize, 96);
+  EXPECT_EQ(plan.srcOffset, 20);
+  EXPECT_EQ(plan.dstOffset, 28);
+  EXPECT_EQ(plan.getNumRuns(), 1);
+  EXPECT_EQ(plan.getNumBytes(), 96);
+}
+
+TEST(StridedCopyPlanTest, HandlesEmptyAndScalarCopies) {
+  EXPECT_EQ(planStridedCopy(4, {2, 0, 4}, 0, {0, 4, 1}, 0, {0, 4, 1})
+                .getKind(),
+            Kind::Empty);
+  StridedCopyPlan plan = planStridedCopy(8, {}, 1, {}, 2, {});
+  EXPECT_EQ(plan.getKind(), Kind::Contiguous);
+  EXPECT_EQ(plan.runSize, 8);
+}
+
+TEST(StridedCopyPlanTest, DetectsPitchedCopies) {
+  // A slice of the first 8 columns of a 16 x 16 matrix. The unit dimension
+  // is dropped.
+  StridedCopyPlan plan =
+      planStridedCopy(2, {1, 16, 8}, 0, {256, 16, 1}, 0, {128, 8, 1});
+  EXPECT_EQ(plan.getKind(), Kind::Pitched2D);
+  EXPECT_EQ(plan.runSize, 16);
+  EXPECT_EQ(plan.shape, llvm::SmallVector<int64_t>({16}));
+  EXPECT_EQ(plan.srcStrides, llvm::SmallVector<int64_t>({32}));
+  EXPECT_EQ(plan.dstStrides, llvm::SmallVector<int64_t>({16}));
+
+  // The outer two dimensions are contiguous in both buffers and merge.
+  plan = planStridedCopy(1, {3, 4, 8}, 0, {64, 16, 1}, 0, {32, 8, 1});
+  EXPECT_EQ(plan.getKind(), Kind::Pitched2D);
+  EXPECT_EQ(plan.shape, llvm::SmallVector<int64_t>({12}));
+
+  // A slice of a slice.
+  plan = planStridedCopy(4, {3, 4, 8}, 0, {128, 16, 1}, 0, {32, 8, 1});
+  EXPECT_EQ(plan.getKind(), Kind::Pitched3D);
+  EXPECT_EQ(plan.runSize, 32);
+  EXPECT_EQ(plan.getNumRuns(), 12);
+}
+
+TEST(StridedCopyPlanTest, TransposeCopiesElements) {
+  StridedCopyPlan plan = planStridedCopy(4, {8, 4}, 0, {1, 8}, 0, {4, 1});
+  EXPECT_EQ(plan.getKind(), Kind::Pitched3D);
+  EXPECT_EQ(plan.runSize, 4);
+  EXPECT_EQ(plan.getNumRuns(), 32);
+}
+
+TEST(StridedCopyPlanTest, EnumeratesRuns) {
+  StridedCopyPlan plan =
+      planStridedCopy(1, {2, 3, 4}, 0, {32, 8, 1}, 0, {12, 4, 1});
+  std::vector<std::pair<int64_t, int64_t>> runs;
+  plan.forEachRun(
+      [&](int64_t src, int64_t dst) { runs.emplace_back(src, dst); },
+      /*numInnerLoops=*/1);
+  EXPECT_EQ(runs, (std::vector<std::pair<int64_t, int64_t>>{{0, 0}, {32, 12}}));
+
+  int64_t numRuns = 0;
+  plan.forEachRun([&](int64_t, int64_t) { ++numRuns; });
+  EXPECT_EQ(numRuns, plan.getNumRuns());
+}
+
+TEST(StridedCopyTest, HostCopyMatchesElementwiseCopy) {
+  std::mt19937 rng(0);
+  for (int iter = 0; iter < 500; ++iter) {
+    int64_t rank = rng() % 5;
+    int64_t elemSize = std::vector<int64_t>{1, 2, 3, 4, 8, 16}[rng() % 6];
+    std::vector<int64_t> shape(rank);
+    for (int64_t &dim : shape)
+      dim = 1 + rng() % 6;
+    auto getLayout = [&](int64_t &size) {
+      std::vector<int64_t> perm(rank);
+      std::iota(perm.begin(), perm.end(), 0);
+      if (rng() % 2)
+        std::shuffle(perm.begin(), perm.end(), rng);
+      return getStrides(shape, perm, rng() % 2, size);
+    };
+    int64_t srcSize, dstSize;
+    std::vector<int64_t> srcStrides = getLayout(srcSize);
+    std::vector<int64_t> dstStrides = getLayout(dstSize);
+    int64_t srcOffset = rng() % 3, dstOffset = rng() % 3;
+
+    std::vector<char> src((srcSize + srcOffset) * elemSize);
+    for (char &byte : src)
+      byte = static_cast<char>(rng());
+    std::vector<char> expected((dstSize + dstOffset) * elemSize, 0);
+    copyElementwise(elemSize, src.data(), srcOffset, srcStrides,
+                    expected.data(), dstOffset, dstStrides, shape);
+
+    StridedCopyPlan plan = planStridedCopy(elemSize, shape, srcOffset,
+                                           srcStrides, dstOffset, dstStrides);
+    std::vector<char> actual(expected.size(), 0);
+    executeStridedCopyOnHost(plan, reinterpret_cast<uintptr_t>(src.data()),
+                             reinterpret_cast<uintptr_t>(actual.data()));
+    ASSERT_EQ(actual, expected) << "iteration " << iter;
+
+    std::fill(actual.begin(), actual.end(), 0);
+    executeStridedCopy(elemSize, reinterpret_cast<uintptr_t>(src.data()),
+                       srcOffset, shape, srcStrides,
+                       reinterpret_cast<uintptr_t>(actual.data()), dstOffset,
+                       shape, dstStrides, [](void *dst, void *src, size_t n) {
+                         std::memcpy(dst, src, n);
+                       });
+    ASSERT_EQ(actual, expected) << "iteration " << iter;
+  }
+}
+
+TEST(StridedCopyTest, MultithreadedHostCopy) {
+  // Copies that are large enough to be split across threads.
+  const std::vector<int64_t> shape = {512, 1024};
+  int64_t size = 512 * 1024;
+  std::vector<float> src(2 * size);
+  std::iota(src.begin(), src.end(), 0.0f);
+
+  for (auto [srcStrides, dstStrides] :
+       {std::make_pair(std::vector<int64_t>{1024, 1},
+                       std::vector<int64_t>{1024, 1}),
+        std::make_pair(std::vector<int64_t>{1, 512},
+                       std::vector<int64_t>{1024, 1}),
+        std::make_pair(std::vector<int64_t>{2048, 1},
+                       std::vector<int64_t>{1024, 1})}) {
+    std::vector<float> expected(size), actual(size);
+    copyElementwise(sizeof(float), reinterpret_cast<const char *>(src.data()),
+                    0, srcStrides, reinterpret_cast<char *>(expected.data()),
+                    0, dstStrides, shape);
+    StridedCopyPlan plan =
+        planStridedCopy(sizeof(float), shape, 0, srcStrides, 0, dstStrides);
+    executeStridedCopyOnHost(plan, reinterpret_cast<uintptr_t>(src.data()),
+                             reinterpret_cast<uintptr_t>(actual.data()),
+                             /*numThreads=*/4);
+    EXPECT_EQ(actual, expected);
+  }
+}
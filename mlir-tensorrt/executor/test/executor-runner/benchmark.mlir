@@ -0,0 +1,32 @@
+// RUN: executor-opt %s -convert-executor-to-executor | \
+// RUN:   executor-translate -mlir-to-runtime-executable | \
+// RUN:   executor-runner -input-type=rtexe --benchmark --benchmark-function=noop \
+// RUN:     --benchmark-warmup-iterations=1 --benchmark-iterations=5 | FileCheck %s
+// RUN: executor-opt %s -convert-executor-to-executor | \
+// RUN:   executor-translate -mlir-to-runtime-executable | \
+// RUN:   executor-runner -input-type=rtexe --benchmark --benchmark-function=noop \
+// RUN:     --benchmark-inputs=zeros | FileCheck %s --check-prefix=ZEROS
+
+func.func public @noop() attributes {executor.function_metadata = #executor.func_meta<[memref<?x4xf32, #executor.memory_type<host>> {#executor.dim_bounds<min = [1, 4], max = [8, 4]>}, i32 {unit}, memref<8x4xf32, #executor.memory_type<host>> {unit}], [], num_output_args = 1>} {
+  return
+}
+
+//      CHECK: "function": "noop",
+// CHECK-NEXT: "warmup_iterations": 1,
+// CHECK-NEXT: "iterations": 5,
+// CHECK-NEXT: "total_time_ms":
+// CHECK-NEXT: "throughput_per_s":
+// CHECK-NEXT: "latency_ms": {
+// CHECK-NEXT: "min":
+// CHECK-NEXT: "max":
+// CHECK-NEXT: "mean":
+// CHECK-NEXT: "p50":
+// CHECK-NEXT: "p90":
+// CHECK-NEXT: "p99":
+//      CHECK: "memory": {
+// CHECK-NEXT: "host": {
+// CHECK-NEXT: "allocations": 0,
+// CHECK-NEXT: "allocations_per_iteration": 0,
+// CHECK-NEXT: "peak_bytes": 0
+
+// ZEROS: "iterations": 100,
@@ -0,0 +1,28 @@
+// REQUIRES: native-backend
+// RUN: executor-opt %s -executor-lowering-pipeline | \
+// RUN:   executor-translate -mlir-to-runtime-executable -embed-native-code | \
+// RUN:   not executor-runner -input-type=rtexe -native-backend 2>%t.err | \
+// RUN:   FileCheck %s
+// RUN: FileCheck %s --check-prefix=ERR < %t.err
+
+func.func @main() -> i32 {
+  %c0 = executor.constant 0 : i32
+  %c1 = executor.constant 1 : i32
+  %c2 = executor.constant 2 : i32
+  %c5 = executor.constant 5 : i32
+  %c40 = executor.constant 40 : i32
+  %cm8 = executor.constant -8 : i32
+  %shl = executor.shift_lefti %c5, %c2 : i32
+  %shl_big = executor.shift_lefti %c1, %c40 : i32
+  %lshr_big = executor.shift_right_logicali %cm8, %c40 : i32
+  %ashr_big = executor.shift_right_arithmetici %cm8, %c40 : i32
+  executor.print "shl=%d shl_big=%d lshr_big=%d ashr_big=%d"(%shl, %shl_big, %lshr_big, %ashr_big : i32, i32, i32, i32)
+  %div = executor.sdivi %c5, %c0 : i32
+  executor.print "div=%d"(%div : i32)
+  return %c0 : i32
+}
+
+//      CHECK: shl=20 shl_big=0 lshr_big=0 ashr_big=-1
+//  CHECK-NOT: div=
+
+// ERR: failed to load and run executable: {{.*}}integer division by zero
@@ -0,0 +1,28 @@
+-- RUN: executor-runner %s --profile-summary 2>&1 | FileCheck %s
+-- RUN: executor-runner %s --profile-output=%t.json
+-- RUN: FileCheck %s --check-prefix=TRACE < %t.json
+
+function main()
+  local src = executor_alloc(64, 16)
+  local dst = executor_alloc(64, 16)
+  for i = 1, 3 do
+    executor_memcpy(src, 0, dst, 0, 64)
+  end
+  _dealloc(src)
+  _dealloc(dst)
+  return 0
+end
+
+-- CHECK: function / builtin {{ +}}calls {{ +}}total (ms) {{ +}}avg (us) {{ +}}bytes {{ +}}allocs {{ +}}alloc bytes
+-- CHECK-NEXT: {{^}}main {{ +}}1 {{ +}}
+-- CHECK-DAG: {{^}}  core_memcpy {{ +}}3 {{ +[0-9.]+ +[0-9.]+ +}}192 {{ +}}0 {{ +}}0
+-- CHECK-DAG: {{^}}  core_alloc {{ +}}2 {{ +[0-9.]+ +[0-9.]+ +}}0 {{ +}}2 {{ +}}128
+-- CHECK-DAG: {{^}}  core_dealloc {{ +}}2 {{ +[0-9.]+ +[0-9.]+ +}}0 {{ +}}0 {{ +}}0
+
+-- TRACE: {"displayTimeUnit":"ns","traceEvents":[
+-- TRACE-SAME: {"name":"alloc","cat":"memory","ph":"i",{{.*}}"args":{"function":"main","builtin":"core_alloc","ptr":"0x{{[0-9A-F]+}}","bytes":64}}
+-- TRACE-SAME: {"name":"core_alloc","cat":"builtin","ph":"X",
+-- TRACE-SAME: {"name":"core_memcpy","cat":"builtin","ph":"X",{{.*}}"args":{"function":"main","bytes":64}}
+-- TRACE-SAME: {"name":"free","cat":"memory","ph":"i",
+-- TRACE-SAME: {"name":"main","cat":"function","ph":"X",
+-- TRACE-SAME: "otherData":{"droppedEvents":0}}
@@ -0,0 +1,626 @@
+//===- RuntimeBenchmarkMain.cpp -------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Microbenchmarks for the executor runtime. The optional input is a
+/// serialized executable (e.g. produced by
+/// `executor-translate -mlir-to-runtime-executable`). Arguments for the
+/// benchmarked function are allocated from its signature; dynamic extents are
+/// set to 1. Benchmarks that do not require an executable run on generated
+/// programs or allocation patterns.
+///
+//===----------------------------------------------------------------------===//
+#include "benchmark/benchmark.h"
+#include "mlir-executor/Runtime/API/API.h"
+#include "mlir-executor/Runtime/API/ExecutableFlatbuffer.h"
+#include "mlir-executor/Runtime/Backend/Common/CommonRuntime.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaBytecode.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaDynamicBatcher.h"
+#include "mlir-executor/Runtime/Backend/Lua/LuaRuntime.h"
+#include "mlir-executor/Runtime/Backend/Lua/Modules/Core/CoreModule.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormatVariadic.h"
+#include <cmath>
+#include <random>
+
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+#include "mlir-executor/Runtime/Backend/Native/NativeRuntime.h"
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
+
+using namespace mlirtrt;
+using namespace mlirtrt::runtime;
+namespace cl = llvm::cl;
+
+static cl::opt<std::string> inputExecutable("executable",
+                                            cl::desc("Executable file"),
+                                            cl::init(""));
+static cl::opt<std::string> functionName("function",
+                                         cl::desc("Function to benchmark"),
+                                         cl::init("main"));
+
+static void checkStatus(const Status &status) {
+  if (!status.isOk())
+    llvm::report_fatal_error(llvm::Twine(status.getString()));
+}
+
+template <typename T>
+static T checkStatus(StatusOr<T> &&statusOr) {
+  checkStatus(statusOr.getStatus());
+  return std::move(*statusOr);
+}
+
+namespace {
+/// Holds the state shared by all benchmarks: the loaded executable, a client
+/// used to allocate arguments, and the arguments themselves.
+struct BenchmarkEnv {
+  std::unique_ptr<Executable> executable;
+  std::unique_ptr<RuntimeClient> client;
+  llvm::SmallVector<std::unique_ptr<RuntimeValue>> argStorage;
+  llvm::SmallVector<RuntimeValue *> inputArgs;
+  llvm::SmallVector<RuntimeValue *> outputArgs;
+
+  std::unique_ptr<LuaRuntimeSession> createSession() const {
+    return checkStatus(LuaRuntimeSession::create(
+        RuntimeSessionOptions(/*numDevices=*/1, /*deviceId=*/0),
+        executable->getView()));
+  }
+};
+} // namespace
+
+/// Allocate an argument matching the given signature type.
+static std::unique_ptr<RuntimeValue> createArg(RuntimeClient &client,
+                                               TypeUnionView type) {
+  if (type.isa<ScalarTypeView>())
+    return std::make_unique<ScalarValue>(
+        0, ScalarType(type.get<ScalarTypeView>()));
+
+  if (!type.isa<MemRefTypeView>())
+    llvm::report_fatal_error("unsupported argument type");
+  auto memrefType = type.get<MemRefTypeView>();
+  llvm::SmallVector<int64_t> shape(memrefType.getShape());
+  for (int64_t &dim : shape)
+    dim = dim < 0 ? 1 : dim;
+  llvm::SmallVector<int64_t> strides(shape.size(), 1);
+  for (int64_t i = static_cast<int64_t>(shape.size()) - 2; i >= 0; --i)
+    strides[i] = strides[i + 1] * shape[i + 1];
+
+  std::optional<const Device *> device;
+  PointerType addressSpace = memrefType.getAddressSpace();
+  if (addressSpace == PointerType::device ||
+      addressSpace == PointerType::unified) {
+    if (client.getDevices().empty())
+      llvm::report_fatal_error("no devices available to allocate arguments");
+    device = client.getDevices().front().get();
+  }
+  return checkStatus(client.allocateMemRef(
+      addressSpace, memrefType.getElementType().getBitWidth(), shape, strides,
+      device, /*stream=*/{}, memrefType.getElementType()));
+}
+
+/// Benchmark the default path, which validates and marshals all arguments on
+/// every call.
+static void BM_executeFunction(benchmark::State &state, BenchmarkEnv *env) {
+  std::unique_ptr<LuaRuntimeSession> session = env->createSession();
+  for (auto _ : state)
+    checkStatus(executeFunctionWithLuaBackend(*session,
+                                              functionName.getValue(),
+                                              env->inputArgs, env->outputArgs)
+                    .getStatus());
+}
+
+/// Benchmark a function bound ahead of time.
+static void BM_executeBoundFunction(benchmark::State &state,
+                                    BenchmarkEnv *env) {
+  std::unique_ptr<LuaRuntimeSession> session = env->createSession();
+  std::unique_ptr<LuaBoundFunction> func =
+      checkStatus(LuaBoundFunction::create(*session, functionName.getValue()));
+  for (auto _ : state)
+    checkStatus(func->execute(env->inputArgs, env->outputArgs));
+}
+
+/// Benchmark the throughput of `state.range(0)` sessions that are driven by a
+/// single thread. With `async`, the invocations of all sessions are in flight
+/// at the same time and the thread polls them in turn; otherwise they are
+/// executed one after another.
+static void BM_executeFunctionSessions(benchmark::State &state,
+                                       BenchmarkEnv *env, bool async) {
+  llvm::SmallVector<std::unique_ptr<LuaRuntimeSession>> sessions;
+  for (int64_t i = 0; i < state.range(0); ++i)
+    sessions.push_back(env->createSession());
+
+  llvm::SmallVector<std::unique_ptr<LuaAsyncExecution>> executions;
+  for (auto _ : state) {
+    if (!async) {
+      for (std::unique_ptr<LuaRuntimeSession> &session : sessions)
+        checkStatus(executeFunctionWithLuaBackend(
+                        *session, functionName.getValue(), env->inputArgs,
+                        env->outputArgs)
+                        .getStatus());
+      continue;
+    }
+
+    executions.clear();
+    for (std::unique_ptr<LuaRuntimeSession> &session : sessions)
+      executions.push_back(checkStatus(executeFunctionWithLuaBackendAsync(
+          *session, functionName.getValue(), env->inputArgs,
+          env->outputArgs)));
+    for (bool done = false; !done;) {
+      done = true;
+      for (std::unique_ptr<LuaAsyncExecution> &execution : executions)
+        done &= execution->poll();
+    }
+    for (std::unique_ptr<LuaAsyncExecution> &execution : executions)
+      checkStatus(execution->getStatus());
+  }
+  state.SetItemsProcessed(state.iterations() * sessions.size());
+}
+
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+/// Benchmark executing the function with the native backend.
+static void BM_executeFunctionNative(benchmark::State &state,
+                                     BenchmarkEnv *env) {
+  std::unique_ptr<NativeRuntimeSession> session =
+      checkStatus(NativeRuntimeSession::create(
+          RuntimeSessionOptions(/*numDevices=*/1, /*deviceId=*/0),
+          env->executable->getView()));
+  for (auto _ : state)
+    checkStatus(executeFunctionWithNativeBackend(*session,
+                                                 functionName.getValue(),
+                                                 env->inputArgs,
+                                                 env->outputArgs)
+                    .getStatus());
+}
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
+
+/// Benchmark creating a session from scratch.
+static void BM_createSession(benchmark::State &state, BenchmarkEnv *env) {
+  for (auto _ : state)
+    benchmark::DoNotOptimize(env->createSession());
+}
+
+/// Benchmark creating a session from a session template.
+static void BM_createSessionFromTemplate(benchmark::State &state,
+                                         BenchmarkEnv *env) {
+  std::unique_ptr<LuaRuntimeSessionTemplate> tmpl = checkStatus(
+      LuaRuntimeSessionTemplate::create(env->executable->getView()));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(checkStatus(tmpl->createSession(
+        RuntimeSessionOptions(/*numDevices=*/1, /*deviceId=*/0))));
+}
+
+/// Generate a Lua program with `numFunctions` functions that resemble the
+/// code produced by the Lua translation.
+static std::string generateLuaProgram(int64_t numFunctions) {
+  std::string program;
+  llvm::raw_string_ostream os(program);
+  for (int64_t i = 0; i < numFunctions; ++i)
+    os << llvm::formatv(R"(
+function func{0}(arg0, arg1)
+  local v0 = arg0 + {0}
+  local v1 = arg1 * v0
+  if v1 > v0 then
+    v1 = v1 - v0
+  end
+  for i = 0, 16 do
+    v0 = v0 + i * v1
+  end
+  return v0, v1
+end
+)",
+                        i);
+  return program;
+}
+
+/// Benchmark loading a generated program from source.
+static void BM_loadLuaSource(benchmark::State &state) {
+  std::string source = generateLuaProgram(state.range(0));
+  for (auto _ : state) {
+    sol::state lua;
+    benchmark::DoNotOptimize(lua.script(source));
+  }
+}
+
+/// Benchmark loading a generated program from precompiled bytecode.
+static void BM_loadLuaBytecode(benchmark::State &state) {
+  StatusOr<std::string> bytecode =
+      compileLuaSourceToBytecode(generateLuaProgram(state.range(0)));
+  if (!bytecode.isOk()) {
+    state.SkipWithError(bytecode.getStatus().getString().c_str());
+    return;
+  }
+  for (auto _ : state) {
+    sol::state lua;
+    benchmark::DoNotOptimize(lua.script(
+        *bytecode, sol::detail::default_chunk_name(), sol::load_mode::binary));
+  }
+}
+
+/// Generate a Lua function `shape_fn` that performs `numIterations` rounds of
+/// the scalar integer ops typical of shape computations. If `native` is true,
+/// the ops are written the way the `-lua-native-arithmetic` translation option
+/// emits them, otherwise they call the core module builtins.
+static std::string generateShapeFunction(int64_t numIterations, bool native) {
+  const char *body = native ? R"(
+    local c = ((a < b) and 1 or 0)
+    local m = (a < b) and b or a
+    local t = m + 7
+    local q = t // 8 + (((t % 8 ~= 0) and ((t ~ 8) < 0)) and 1 or 0)
+    local s = (c ~= 0) and q or b
+    local l = s << 1
+    a = (l + i) & 65535
+)"
+                            : R"(
+    local c = _icmp_slt_i64(a, b)
+    local m = _smax_i64(a, b)
+    local t = m + 7
+    local q = _sdivi_i64(t, 8)
+    local s = _select(c, q, b)
+    local l = _shift_lefti_i64(s, 1)
+    a = _bitwise_andi_i64(l + i, 65535)
+)";
+  return llvm::formatv(R"(
+function shape_fn(a, b)
+  for i = 1, {0} do{1}  end
+  return a
+end
+)",
+                       numIterations, body);
+}
+
+/// Benchmark a shape function with `state.range(0)` iterations that either
+/// calls the runtime builtins or uses native Lua arithmetic.
+static void BM_shapeFunction(benchmark::State &state, bool native) {
+  sol::state lua;
+  AllocTracker tracker;
+  registerExecutorCoreModuleLuaRuntimeMethods(
+      lua.lua_state(), /*pinnedMemoryAllocator=*/nullptr, &tracker);
+  sol::protected_function_result loaded =
+      lua.safe_script(generateShapeFunction(state.range(0), native),
+                      sol::script_pass_on_error);
+  if (!loaded.valid())
+    llvm::report_fatal_error("failed to load generated shape function");
+  sol::protected_function func = lua["shape_fn"];
+  for (auto _ : state)
+    benchmark::DoNotOptimize(func(1000, 3).get<int64_t>());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Build a host-only executable with a function `add_one(a, b)` that stores
+/// `a + 1` into `b`. Both arguments are i64 memrefs of shape `? x rowSize`
+/// whose batch dimension is bounded by `maxBatchSize`.
+static std::unique_ptr<Executable>
+buildBatchedHostExecutable(int64_t rowSize, int64_t maxBatchSize) {
+  namespace fb = flatbuffers;
+  fb::FlatBufferBuilder64 fbBuilder;
+  std::vector<fb::Offset<void>> argTypes, argBounds;
+  for (unsigned i = 0; i < 2; ++i) {
+    argTypes.push_back(
+        impl::CreateMemRefType(
+            fbBuilder, impl::ScalarTypeCode::i64,
+            fbBuilder.CreateVector(std::vector<int64_t>{-1, rowSize}),
+            fbBuilder.CreateVector(std::vector<int64_t>{rowSize, 1}),
+            impl::PointerType::host)
+            .Union());
+    argBounds.push_back(
+        impl::CreateDimensionBounds(
+            fbBuilder, fbBuilder.CreateVector(std::vector<int64_t>{1, rowSize}),
+            fbBuilder.CreateVector(
+                std::vector<int64_t>{maxBatchSize, rowSize}))
+            .Union());
+  }
+  auto signature = impl::CreateFunctionSignature(
+      fbBuilder,
+      fbBuilder.CreateVector(std::vector<impl::Type>(
+          2, impl::Type::MemRefType)),
+      fbBuilder.CreateVector(argTypes),
+      fbBuilder.CreateVector(std::vector<impl::Type>{}),
+      fbBuilder.CreateVector(std::vector<fb::Offset<void>>{}),
+      /*num_output_args=*/1,
+      fbBuilder.CreateVector(std::vector<impl::Bounds>(
+          2, impl::Bounds::DimensionBounds)),
+      fbBuilder.CreateVector(argBounds),
+      fbBuilder.CreateVector(std::vector<impl::Bounds>{}),
+      fbBuilder.CreateVector(std::vector<fb::Offset<void>>{}),
+      fbBuilder.CreateString(""), impl::CallingConvention::unpacked,
+      fbBuilder.CreateVector(std::vector<int32_t>{}));
+  std::vector<fb::Offset<impl::Function>> functions = {impl::CreateFunction(
+      fbBuilder, fbBuilder.CreateString("add_one"), signature)};
+
+  auto constantsOffset =
+      fbBuilder.CreateVector(std::vector<fb::Offset<impl::Constant>>{});
+  auto functionsOffset = fbBuilder.CreateVector(functions);
+  auto gridShapeOffset = fbBuilder.CreateVector(std::vector<uint32_t>{1, 1});
+  auto sourceOffset = fbBuilder.CreateString(R"(
+function add_one(a, b)
+  for i = 0, a[4] * a[5] - 1 do
+    _store_i64(b[2], (b[3] + i) * 8, _load_i64(a[2], (a[3] + i) * 8) + 1)
+  end
+end
+)");
+  impl::ExecutableBuilder exeBuilder(fbBuilder);
+  exeBuilder.add_process_grid_shape(gridShapeOffset);
+  exeBuilder.add_functions(functionsOffset);
+  exeBuilder.add_constants(constantsOffset);
+  exeBuilder.add_source(sourceOffset);
+  fbBuilder.Finish(exeBuilder.Finish());
+  return checkStatus(Executable::loadFromUnalignedRef(llvm::ArrayRef<char>(
+      reinterpret_cast<const char *>(fbBuilder.GetBufferPointer()),
+      fbBuilder.GetSize())));
+}
+
+/// Benchmark `state.range(0)` concurrent single-row requests to a generated
+/// host-only function on a pool of 2 sessions. The requests are either
+/// submitted to the pool directly or coalesced by a dynamic batcher.
+static void BM_dynamicBatching(benchmark::State &state, bool batched) {
+  static constexpr int64_t kRowSize = 16;
+  const int64_t numRequests = state.range(0);
+  std::unique_ptr<Executable> executable =
+      buildBatchedHostExecutable(kRowSize, /*maxBatchSize=*/numRequests);
+  std::unique_ptr<RuntimeClient> client =
+      checkStatus(RuntimeClient::create());
+  std::unique_ptr<LuaSessionPool> pool = checkStatus(LuaSessionPool::create(
+      RuntimeSessionOptions(/*numDevices=*/1, /*deviceId=*/0),
+      executable->getView(), /*numSessions=*/2));
+  DynamicBatchingOptions options;
+  options.maxQueueDelay = std::chrono::microseconds(200);
+  std::unique_ptr<LuaDynamicBatcher> batcher = checkStatus(
+      LuaDynamicBatcher::create(*client, *pool, executable->getView(),
+                                options));
+
+  std::vector<int64_t> data(2 * numRequests * kRowSize, 1);
+  llvm::SmallVector<std::unique_ptr<MemRefValue>> memrefs;
+  for (int64_t i = 0; i < 2 * numRequests; ++i)
+    memrefs.push_back(checkStatus(client->createExternalMemRef(
+        PointerType::host, 64,
+        reinterpret_cast<uintptr_t>(data.data() + i * kRowSize), 0,
+        {1, kRowSize}, {kRowSize, 1}, {}, ScalarType(ScalarTypeCode::i64))));
+
+  std::vector<std::future<Status>> futures;
+  for (auto _ : state) {
+    futures.clear();
+    for (int64_t i = 0; i < numRequests; ++i) {
+      RuntimeValue *input = memrefs[2 * i].get();
+      RuntimeValue *output = memrefs[2 * i + 1].get();
+      futures.push_back(batched ? batcher->submit("add_one", input, output)
+                                : pool->submit("add_one", input, output));
+    }
+    for (std::future<Status> &future : futures)
+      checkStatus(future.get());
+  }
+  state.SetItemsProcessed(state.iterations() * numRequests);
+
+  LuaDynamicBatcher::Statistics stats = batcher->getStatistics();
+  state.counters["mean_batch_size"] = stats.batchSize.getMean();
+  state.counters["p99_latency_us"] =
+      static_cast<double>(stats.latencyUs.getPercentile(99));
+}
+
+namespace {
+/// An event source whose events complete immediately. This allows
+/// benchmarking the pinned memory allocator without a GPU.
+class ImmediateEventSource : public StreamEventSource {
+public:
+  StatusOr<CudaEvent> record(CudaStream stream) final {
+    return CudaEvent(++numEvents);
+  }
+  StatusOr<bool> isComplete(CudaEvent event) final { return true; }
+  void release(CudaEvent event) final {}
+
+private:
+  CudaEvent numEvents = 0;
+};
+} // namespace
+
+/// Benchmark the pinned memory allocator on a mix of request sizes up to
+/// `state.range(0)` bytes, keeping up to 16 allocations live. Host memory
+/// stands in for page-locked memory.
+static void BM_pinnedMemoryAllocator(benchmark::State &state) {
+  PinnedMemoryAllocator allocator(createHostAllocatorBackend(),
+                                  std::make_unique<ImmediateEventSource>());
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<size_t> sizeDist(1, state.range(0));
+  llvm::SmallVector<uintptr_t> live;
+  for (auto _ : state) {
+    live.push_back(checkStatus(allocator.allocate(sizeDist(rng))).ptr);
+    if (live.size() < 16)
+      continue;
+    size_t idx = rng() % live.size();
+    checkStatus(allocator.freeAsync(live[idx], /*stream=*/0));
+    live[idx] = live.back();
+    live.pop_back();
+  }
+  PinnedMemoryAllocatorStats stats = allocator.getStats();
+  state.counters["bytes_reserved"] = static_cast<double>(stats.bytesReserved);
+  state.counters["bytes_allocated"] =
+      static_cast<double>(stats.bytesAllocated);
+}
+
+/// Benchmark concurrent `AllocTracker` lookups of 4096 tracked pointers. Each
+/// thread also tracks and untracks a pointer of its own every 64 lookups. A
+/// tracker that is not thread-safe is only benchmarked on a single thread.
+static void BM_allocTrackerLookup(benchmark::State &state, bool threadSafe) {
+  static constexpr unsigned kNumPointers = 4096;
+  auto createTracker = [](bool threadSafe) {
+    auto *tracker = new AllocTracker(threadSafe);
+    for (unsigned i = 0; i < kNumPointers; ++i)
+      tracker->track(PointerInfo(0x10000 + i * 256, 256, PointerType::host,
+                                 PointerOwner::external));
+    return tracker;
+  };
+  static AllocTracker *sharedTracker = createTracker(/*threadSafe=*/true);
+  static AllocTracker *unsynchronizedTracker =
+      createTracker(/*threadSafe=*/false);
+  AllocTracker *tracker = threadSafe ? sharedTracker : unsynchronizedTracker;
+
+  uintptr_t own = 0x100000000 + uintptr_t(state.thread_index()) * 64;
+  unsigned i = state.thread_index();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        tracker->lookupOrDefault(0x10000 + (i % kNumPointers) * 256));
+    if (++i % 64 == 0) {
+      tracker->track(
+          PointerInfo(own, 64, PointerType::host, PointerOwner::external));
+      tracker->untrack(own);
+    }
+  }
+}
+
+namespace {
+/// The layout of the source of a strided copy benchmark. The destination is
+/// always contiguous.
+enum class CopyLayout {
+  /// The source is contiguous.
+  Contiguous,
+  /// The source is the transpose of a contiguous buffer.
+  Transposed,
+  /// The source is the first half of each innermost row of a contiguous
+  /// buffer.
+  Sliced
+};
+} // namespace
+
+/// Benchmark a host strided copy of about 2^20 elements of `state.range(1)`
+/// bytes with rank `state.range(0)` on up to `state.range(2)` threads, where
+/// zero selects all hardware threads.
+static void BM_stridedCopy(benchmark::State &state, CopyLayout layout) {
+  int64_t rank = state.range(0);
+  int64_t elemSize = state.range(1);
+  unsigned numThreads = state.range(2);
+  int64_t dimSize = std::llround(std::pow(double(1 << 20), 1.0 / rank));
+  std::vector<int64_t> shape(rank, dimSize);
+  std::vector<int64_t> dstStrides(rank, 1);
+  for (int64_t d = rank - 2; d >= 0; --d)
+    dstStrides[d] = dstStrides[d + 1] * shape[d + 1];
+  int64_t numElements = dstStrides[0] * shape[0];
+
+  // All dimensions have the same size, so reversing the strides yields a
+  // transposed layout.
+  std::vector<int64_t> srcStrides = dstStrides;
+  int64_t numSrcElements = numElements;
+  if (layout == CopyLayout::Transposed) {
+    std::reverse(srcStrides.begin(), srcStrides.end());
+  } else if (layout == CopyLayout::Sliced) {
+    for (int64_t d = 0; d < rank - 1; ++d)
+      srcStrides[d] *= 2;
+    numSrcElements *= 2;
+  }
+
+  std::vector<char> src(numSrcElements * elemSize);
+  std::vector<char> dst(numElements * elemSize);
+  for (auto _ : state) {
+    StridedCopyPlan plan =
+        planStridedCopy(elemSize, shape, 0, srcStrides, 0, dstStrides);
+    executeStridedCopyOnHost(plan, reinterpret_cast<uintptr_t>(src.data()),
+                             reinterpret_cast<uintptr_t>(dst.data()),
+                             numThreads);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * numElements * elemSize);
+}
+
+int main(int argc, char *argv[]) {
+  benchmark::Initialize(&argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+
+  benchmark::RegisterBenchmark("load_lua_source", BM_loadLuaSource)
+      ->RangeMultiplier(8)
+      ->Range(64, 4096);
+  benchmark::RegisterBenchmark("load_lua_bytecode", BM_loadLuaBytecode)
+      ->RangeMultiplier(8)
+      ->Range(64, 4096);
+  benchmark::RegisterBenchmark("shape_function_builtins", BM_shapeFunction,
+                               /*native=*/false)
+      ->RangeMultiplier(16)
+      ->Range(16, 4096);
+  benchmark::RegisterBenchmark("shape_function_native", BM_shapeFunction,
+                               /*native=*/true)
+      ->RangeMultiplier(16)
+      ->Range(16, 4096);
+  benchmark::RegisterBenchmark("pinned_memory_allocator",
+                               BM_pinnedMemoryAllocator)
+      ->RangeMultiplier(16)
+      ->Range(4096, 16 << 20);
+  benchmark::RegisterBenchmark("alloc_tracker_lookup", BM_allocTrackerLookup,
+                               /*threadSafe=*/true)
+      ->ThreadRange(1, 8);
+  benchmark::RegisterBenchmark("alloc_tracker_lookup_unsynchronized",
+                               BM_allocTrackerLookup, /*threadSafe=*/false);
+  benchmark::RegisterBenchmark("dynamic_batching_off", BM_dynamicBatching,
+                               /*batched=*/false)
+      ->RangeMultiplier(4)
+      ->Range(1, 64)
+      ->UseRealTime();
+  benchmark::RegisterBenchmark("dynamic_batching_on", BM_dynamicBatching,
+                               /*batched=*/true)
+      ->RangeMultiplier(4)
+      ->Range(1, 64)
+      ->UseRealTime();
+  for (auto [name, layout] :
+       {std::make_pair("strided_copy_contiguous", CopyLayout::Contiguous),
+        std::make_pair("strided_copy_transposed", CopyLayout::Transposed),
+        std::make_pair("strided_copy_sliced", CopyLayout::Sliced)})
+    benchmark::RegisterBenchmark(name, BM_stridedCopy, layout)
+        ->ArgsProduct({{2, 3, 4}, {1, 4, 8}, {1, 0}})
+        ->UseRealTime();
+
+  if (inputExecutable.empty()) {
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+  }
+
+  BenchmarkEnv env;
+  env.executable =
+      checkStatus(Executable::loadFromFile(inputExecutable.getValue()));
+  env.client = checkStatus(RuntimeClient::create());
+
+  FunctionSignatureView sig =
+      env.executable->getFunction(functionName.getValue()).getSignature();
+  for (unsigned i = 0, e = sig.getNumArgs(); i < e; ++i) {
+    env.argStorage.push_back(createArg(*env.client, sig.getArg(i)));
+    if (sig.isOutputArg(i))
+      env.outputArgs.push_back(env.argStorage.back().get());
+    else
+      env.inputArgs.push_back(env.argStorage.back().get());
+  }
+
+  benchmark::RegisterBenchmark("execute_function", BM_executeFunction, &env);
+  benchmark::RegisterBenchmark("execute_bound_function",
+                               BM_executeBoundFunction, &env);
+  benchmark::RegisterBenchmark("execute_function_sessions_sync",
+                               BM_executeFunctionSessions, &env,
+                               /*async=*/false)
+      ->RangeMultiplier(2)
+      ->Range(1, 8);
+  benchmark::RegisterBenchmark("execute_function_sessions_async",
+                               BM_executeFunctionSessions, &env,
+                               /*async=*/true)
+      ->RangeMultiplier(2)
+      ->Range(1, 8);
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+  if (!env.executable->getView().getNativeCode().empty())
+    benchmark::RegisterBenchmark("execute_function_native",
+                                 BM_executeFunctionNative, &env);
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
+  benchmark::RegisterBenchmark("create_session", BM_createSession, &env);
+  benchmark::RegisterBenchmark("create_session_from_template",
+                               BM_createSessionFromTemplate, &env);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
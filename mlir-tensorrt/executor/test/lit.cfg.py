@@ -67,5 +67,8 @@ config.num_cuda_devices = gpu_tools.get_num_cuda_devices()
 if config.enable_assertions:
     config.available_features.add("debug-print")
 
+if config.enable_native:
+    config.available_features.add("native-backend")
+
 for i in range(config.num_cuda_devices):
     config.available_features.add(f"host-has-at-least-{i+1}-gpus")
@@ -21,9 +21,16 @@
 #include "mlir-executor/Target/Lua/TranslateToRuntimeExecutable.h"
 #include "mlir/Tools/mlir-translate/MlirTranslateMain.h"
 
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+#include "mlir-executor/Target/LLVM/TranslateToLLVMIR.h"
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
+
 int main(int argc, char **argv) {
   mlir::registerToLuaTranslation();
   mlir::registerToRuntimeExecutableTranslation();
+#ifdef MLIR_EXECUTOR_TARGET_NATIVE
+  mlir::registerToNativeLLVMIRTranslation();
+#endif // MLIR_EXECUTOR_TARGET_NATIVE
   return failed(mlir::mlirTranslateMain(
       argc, argv, "MLIR-Executor Translation Testing Tool"));
 }
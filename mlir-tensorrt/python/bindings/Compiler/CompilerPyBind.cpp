@@ -238,7 +238,29 @@ PYBIND11_MODULE(_api, m) {
         MTRT_Status s = mtrtCompilerClientCreate(context, &client);
         THROW_IF_MTRT_ERROR(s);
         return new PyCompilerClient(client);
-      }));
+      }))
+      .def(
+          "enable_compilation_cache",
+          [](PyCompilerClient &self, const std::string &directory,
+             uint64_t maxSizeInBytes) {
+            THROW_IF_MTRT_ERROR(mtrtCompilerClientEnableCompilationCache(
+                self, mtrtStringViewCreate(directory.c_str(), directory.size()),
+                maxSizeInBytes));
+          },
+          py::arg("directory"), py::arg("max_size_in_bytes") = 1ull << 30,
+          "enables caching of compiled executables in the given directory")
+      .def(
+          "get_compilation_cache_statistics",
+          [](PyCompilerClient &self) {
+            int64_t numHits = 0, numMisses = 0;
+            THROW_IF_MTRT_ERROR(mtrtCompilerClientGetCompilationCacheStatistics(
+                self, &numHits, &numMisses));
+            py::dict result;
+            result["hits"] = numHits;
+            result["misses"] = numMisses;
+            return result;
+          },
+          "returns the numbers of hits and misses of the compilation cache");
 
   py::class_<PyStableHLOToExecutableOptions>(m, "StableHLOToExecutableOptions",
                                              py::module_local())
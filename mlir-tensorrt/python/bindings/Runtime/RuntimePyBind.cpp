@@ -26,7 +26,10 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include <exception>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <stdexcept>
 #include <string_view>
@@ -235,6 +238,59 @@ public:
 
   static constexpr auto kMethodTable = mlirtrt::CAPITable<MTRT_RuntimeSession>{
       mtrtRuntimeSessionIsNull, mtrtRuntimeSessionDestroy};
+
+  /// Serializes the uses of the session, which is not thread-safe, once the
+  /// GIL is released. It is shared with the bound functions and executions
+  /// that run on the session.
+  std::shared_ptr<std::mutex> mutex = std::make_shared<std::mutex>();
+};
+
+/// Python wrapper around MTRT_BoundFunction.
+class PyBoundFunction
+    : public PyMTRTWrapper<PyBoundFunction, MTRT_BoundFunction> {
+public:
+  using Base::Base;
+  DECLARE_WRAPPER_CONSTRUCTORS(PyBoundFunction)
+
+  static constexpr auto kMethodTable = mlirtrt::CAPITable<MTRT_BoundFunction>{
+      mtrtBoundFunctionIsNull, mtrtBoundFunctionDestroy};
+
+  /// Destroying the function releases state owned by the session, so it is
+  /// serialized with the other uses of the session.
+  ~PyBoundFunction() {
+    if (!sessionMutex || mtrtBoundFunctionIsNull(obj))
+      return;
+    std::lock_guard<std::mutex> lock(*sessionMutex);
+    mtrtBoundFunctionDestroy(obj);
+    release();
+  }
+
+  /// The mutex of the session of the function.
+  std::shared_ptr<std::mutex> sessionMutex;
+};
+
+/// Python wrapper around MTRT_AsyncExecution.
+class PyAsyncExecution
+    : public PyMTRTWrapper<PyAsyncExecution, MTRT_AsyncExecution> {
+public:
+  using Base::Base;
+  DECLARE_WRAPPER_CONSTRUCTORS(PyAsyncExecution)
+
+  static constexpr auto kMethodTable = mlirtrt::CAPITable<MTRT_AsyncExecution>{
+      mtrtAsyncExecutionIsNull, mtrtAsyncExecutionDestroy};
+
+  /// Destroying the execution releases state owned by the session, so it is
+  /// serialized with the other uses of the session.
+  ~PyAsyncExecution() {
+    if (!sessionMutex || mtrtAsyncExecutionIsNull(obj))
+      return;
+    std::lock_guard<std::mutex> lock(*sessionMutex);
+    mtrtAsyncExecutionDestroy(obj);
+    release();
+  }
+
+  /// The mutex of the session of the execution.
+  std::shared_ptr<std::mutex> sessionMutex;
 };
 
 /// Python wrapper around MTRT_RuntimeClient.
@@ -248,8 +304,101 @@ public:
       mtrtRuntimeClientIsNull, mtrtRuntimeClientDestroy};
 };
 
+/// A handle to a runtime operation that runs on a background thread without
+/// holding the GIL. `result` blocks until the operation is done and returns
+/// its result; awaiting the handle does the same without blocking the event
+/// loop.
+class PyRuntimeFuture {
+public:
+  /// Start `work` on a new thread. `work` must not use Python objects.
+  /// `makeResult` creates the result once `work` has succeeded and holds the
+  /// Python objects that `work` uses.
+  PyRuntimeFuture(std::function<MTRT_Status()> work,
+                  std::function<py::object()> makeResult)
+      : future(std::async(std::launch::async, std::move(work))),
+        makeResult(std::move(makeResult)) {}
+  PyRuntimeFuture(const PyRuntimeFuture &) = delete;
+  PyRuntimeFuture &operator=(const PyRuntimeFuture &) = delete;
+
+  ~PyRuntimeFuture() {
+    // The operation must finish before the objects that it uses are
+    // released. Results that were never retrieved are destroyed here.
+    try {
+      (void)getResult();
+    } catch (...) {
+    }
+  }
+
+  bool isDone() const {
+    return !future.valid() || future.wait_for(std::chrono::seconds(0)) ==
+                                  std::future_status::ready;
+  }
+
+  void wait() {
+    if (!future.valid())
+      return;
+    py::gil_scoped_release release;
+    future.wait();
+  }
+
+  py::object getResult() {
+    if (future.valid()) {
+      wait();
+      MTRT_Status s = future.get();
+      if (mtrtStatusIsOk(s))
+        result = makeResult();
+      else
+        error = PyMTRTCError(s).getMessage();
+      makeResult = nullptr;
+    }
+    if (error)
+      throw MTRTException(*error);
+    return result;
+  }
+
+private:
+  std::future<MTRT_Status> future;
+  std::function<py::object()> makeResult;
+  py::object result = py::none();
+  std::optional<std::string> error;
+};
+
 } // namespace
 
+//===----------------------------------------------------------------------===//
+// Utilities for calling into the runtime from multiple Python threads.
+//===----------------------------------------------------------------------===//
+
+/// Invoke `func` without holding the GIL so that other Python threads can run
+/// while the runtime blocks, e.g. on a stream synchronization or an engine
+/// deserialization. `func` must not use Python objects. If `mutex` is given,
+/// it is held during the call.
+static MTRT_Status callWithoutGIL(llvm::function_ref<MTRT_Status()> func,
+                                  std::mutex *mutex = nullptr) {
+  py::gil_scoped_release release;
+  if (!mutex)
+    return func();
+  std::lock_guard<std::mutex> lock(*mutex);
+  return func();
+}
+
+/// Return the iterator of `__await__` for a handle whose blocking method
+/// `blockingFunc` returns its result. The method runs on the default executor
+/// of the running event loop, which is possible since it releases the GIL.
+static py::object awaitInExecutor(py::object blockingFunc) {
+  py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+  return loop.attr("run_in_executor")(py::none(), blockingFunc)
+      .attr("__await__")();
+}
+
+/// Wrap `memref` in a Python object that keeps `client` alive.
+static py::object wrapMemRef(MTRT_MemRefValue memref, py::handle client) {
+  py::object result = py::cast(new PyMemRefValue(memref),
+                               py::return_value_policy::take_ownership);
+  py::detail::keep_alive_impl(result, client);
+  return result;
+}
+
 //===----------------------------------------------------------------------===//
 // Utilities for buffer protocol interop.
 // The functions in this section were based on the utility functions in
@@ -334,10 +483,13 @@ static std::unique_ptr<PyMemRefValue> createMemRef(
     strides[idx] = strides[idx + 1] * shape[idx + 1];
 
   MTRT_MemRefValue result{nullptr};
-  s = mtrtMemRefCreate(client, addressSpace, bytesPerElement * 8, shape.size(),
-                       shape.data(), strides.data(),
-                       device ? *device : mtrtDeviceGetNull(),
-                       stream ? *stream : mtrtStreamGetNull(), dtype, &result);
+  s = callWithoutGIL([&]() {
+    return mtrtMemRefCreate(client, addressSpace, bytesPerElement * 8,
+                            shape.size(), shape.data(), strides.data(),
+                            device ? *device : mtrtDeviceGetNull(),
+                            stream ? *stream : mtrtStreamGetNull(), dtype,
+                            &result);
+  });
   THROW_IF_MTRT_ERROR(s);
   return std::make_unique<PyMemRefValue>(result);
 }
@@ -475,14 +627,18 @@ static std::unique_ptr<PyMemRefValue> getMemRefFromHostBufferProtocol(
 
   if (addressSpace == MTRT_PointerType::MTRT_PointerType_host) {
     MTRT_MemRefValue result{nullptr};
-    s = mtrtCopyFromHostToHost(hostView, &result);
+    s = callWithoutGIL(
+        [&]() { return mtrtCopyFromHostToHost(hostView, &result); });
     THROW_IF_MTRT_ERROR(s);
     return std::make_unique<PyMemRefValue>(result);
   }
 
   MTRT_MemRefValue result{nullptr};
-  s = mtrtCopyFromHostToDevice(hostView, device ? *device : mtrtDeviceGetNull(),
-                               stream ? *stream : mtrtStreamGetNull(), &result);
+  s = callWithoutGIL([&]() {
+    return mtrtCopyFromHostToDevice(
+        hostView, device ? *device : mtrtDeviceGetNull(),
+        stream ? *stream : mtrtStreamGetNull(), &result);
+  });
   THROW_IF_MTRT_ERROR(s);
   return std::make_unique<PyMemRefValue>(result);
 }
@@ -694,14 +850,16 @@ PYBIND11_MODULE(_api, m) {
   py::class_<PyStream>(m, "Stream", py::module_local())
       .def_property_readonly(MTRT_PYTHON_CAPI_PTR_ATTR, &PyStream::getCapsule)
       .def("sync", [](PyStream &stream) {
-        MTRT_Status s = mtrtStreamSynchronize(stream);
+        MTRT_Status s =
+            callWithoutGIL([&]() { return mtrtStreamSynchronize(stream); });
         THROW_IF_MTRT_ERROR(s);
       });
 
   py::class_<PyRuntimeClient>(m, "RuntimeClient", py::module_local())
       .def(py::init<>([]() {
         MTRT_RuntimeClient client{nullptr};
-        MTRT_Status s = mtrtRuntimeClientCreate(&client);
+        MTRT_Status s =
+            callWithoutGIL([&]() { return mtrtRuntimeClientCreate(&client); });
         THROW_IF_MTRT_ERROR(s);
         return new PyRuntimeClient(client);
       }))
@@ -866,22 +1024,47 @@ PYBIND11_MODULE(_api, m) {
           [](PyRuntimeClient &self, PyMemRefValue &hostMemRef, PyDevice &device,
              std::optional<MTRT_Stream> stream) {
             MTRT_MemRefValue deviceMemRef{nullptr};
-            MTRT_Status s = mtrtCopyFromHostToDevice(
-                hostMemRef, device, stream ? *stream : mtrtStreamGetNull(),
-                &deviceMemRef);
+            MTRT_Status s = callWithoutGIL([&]() {
+              return mtrtCopyFromHostToDevice(
+                  hostMemRef, device, stream ? *stream : mtrtStreamGetNull(),
+                  &deviceMemRef);
+            });
             THROW_IF_MTRT_ERROR(s);
             return new PyMemRefValue(deviceMemRef);
           },
           py::arg("host_memref"), py::arg("device"),
           py::arg("stream") = py::none(), py::keep_alive<0, 1>())
+      .def(
+          "copy_to_device_async",
+          [](py::object self, py::object hostMemRef, PyDevice &device,
+             std::optional<MTRT_Stream> stream) {
+            MTRT_MemRefValue source = py::cast<PyMemRefValue &>(hostMemRef);
+            MTRT_Device cDevice = device;
+            MTRT_Stream cStream = stream ? *stream : mtrtStreamGetNull();
+            auto result = std::make_shared<MTRT_MemRefValue>();
+            return new PyRuntimeFuture(
+                [=]() {
+                  return mtrtCopyFromHostToDevice(source, cDevice, cStream,
+                                                  result.get());
+                },
+                [result, self, hostMemRef]() {
+                  return wrapMemRef(*result, self);
+                });
+          },
+          py::arg("host_memref"), py::arg("device"),
+          py::arg("stream") = py::none(),
+          "Start copying the host memref to a new memref on the device and "
+          "return a `RuntimeFuture` of the new memref")
       .def(
           "copy_to_host",
           [](PyRuntimeClient &self, PyMemRefValue &deviceMemRef,
              std::optional<MTRT_Stream> stream) {
             MTRT_MemRefValue hostMemRef{nullptr};
-            MTRT_Status s = mtrtCopyFromDeviceToNewHostMemRef(
-                deviceMemRef, stream ? *stream : mtrtStreamGetNull(),
-                &hostMemRef);
+            MTRT_Status s = callWithoutGIL([&]() {
+              return mtrtCopyFromDeviceToNewHostMemRef(
+                  deviceMemRef, stream ? *stream : mtrtStreamGetNull(),
+                  &hostMemRef);
+            });
             THROW_IF_MTRT_ERROR(s);
             return new PyMemRefValue(hostMemRef);
           },
@@ -891,13 +1074,55 @@ PYBIND11_MODULE(_api, m) {
           "copy_to_host",
           [](PyRuntimeClient &self, PyMemRefValue &deviceMemRef,
              PyMemRefValue &hostMemRef, std::optional<MTRT_Stream> stream) {
-            MTRT_Status s = mtrtCopyFromDeviceToExistingHostMemRef(
-                deviceMemRef, hostMemRef,
-                stream ? *stream : mtrtStreamGetNull());
+            MTRT_Status s = callWithoutGIL([&]() {
+              return mtrtCopyFromDeviceToExistingHostMemRef(
+                  deviceMemRef, hostMemRef,
+                  stream ? *stream : mtrtStreamGetNull());
+            });
             THROW_IF_MTRT_ERROR(s);
           },
           py::arg("device_memref"), py::arg("existing_host_memref"),
           py::arg("stream") = py::none())
+      .def(
+          "copy_to_host_async",
+          [](py::object self, py::object deviceMemRef,
+             std::optional<MTRT_Stream> stream) {
+            MTRT_MemRefValue source = py::cast<PyMemRefValue &>(deviceMemRef);
+            MTRT_Stream cStream = stream ? *stream : mtrtStreamGetNull();
+            auto result = std::make_shared<MTRT_MemRefValue>();
+            return new PyRuntimeFuture(
+                [=]() {
+                  return mtrtCopyFromDeviceToNewHostMemRef(source, cStream,
+                                                           result.get());
+                },
+                [result, self, deviceMemRef]() {
+                  return wrapMemRef(*result, self);
+                });
+          },
+          py::arg("device_memref"), py::arg("stream") = py::none(),
+          "Start copying the device memref to a new host memref and return a "
+          "`RuntimeFuture` of the new memref")
+      .def(
+          "copy_to_host_async",
+          [](PyRuntimeClient &self, py::object deviceMemRef,
+             py::object hostMemRef, std::optional<MTRT_Stream> stream) {
+            MTRT_MemRefValue source = py::cast<PyMemRefValue &>(deviceMemRef);
+            MTRT_MemRefValue dest = py::cast<PyMemRefValue &>(hostMemRef);
+            MTRT_Stream cStream = stream ? *stream : mtrtStreamGetNull();
+            return new PyRuntimeFuture(
+                [=]() {
+                  return mtrtCopyFromDeviceToExistingHostMemRef(source, dest,
+                                                                cStream);
+                },
+                // The captures keep the memrefs alive until the copy is done.
+                [deviceMemRef, hostMemRef]() -> py::object {
+                  return py::none();
+                });
+          },
+          py::arg("device_memref"), py::arg("existing_host_memref"),
+          py::arg("stream") = py::none(),
+          "Start copying the device memref into the host memref and return a "
+          "`RuntimeFuture` of None")
       .def("external_reference_count",
            [](PyRuntimeClient &self, uintptr_t ptr) {
              int32_t externalRefCount;
@@ -928,21 +1153,37 @@ PYBIND11_MODULE(_api, m) {
   py::class_<PyRuntimeSessionOptions>(m, "RuntimeSessionOptions",
                                       py::module_local())
       .def(py::init<>([](int32_t numDevices, int32_t deviceId,
-                         std::string ncclUuid) -> PyRuntimeSessionOptions * {
+                         std::string ncclUuid, bool enableProfiling,
+                         uint32_t numHostCopyThreads,
+                         bool enableExecutableBytecode)
+                          -> PyRuntimeSessionOptions * {
              MTRT_RuntimeSessionOptions options;
              MTRT_Status s = mtrtRuntimeSessionOptionsCreate(
                  numDevices, deviceId,
                  MTRT_StringView{ncclUuid.data(), ncclUuid.size()}, &options);
              THROW_IF_MTRT_ERROR(s);
-             return new PyRuntimeSessionOptions(options);
+             auto result = std::make_unique<PyRuntimeSessionOptions>(options);
+             THROW_IF_MTRT_ERROR(mtrtRuntimeSessionOptionsEnableProfiling(
+                 options, enableProfiling));
+             THROW_IF_MTRT_ERROR(mtrtRuntimeSessionOptionsSetNumHostCopyThreads(
+                 options, numHostCopyThreads));
+             THROW_IF_MTRT_ERROR(
+                 mtrtRuntimeSessionOptionsEnableExecutableBytecode(
+                     options, enableExecutableBytecode));
+             return result.release();
            }),
            py::arg("num_devices") = 1, py::arg("device_id") = 0,
-           py::arg("nccl_uuid") = py::str(""));
+           py::arg("nccl_uuid") = py::str(""),
+           py::arg("enable_profiling") = false,
+           py::arg("num_host_copy_threads") = 1,
+           py::arg("enable_executable_bytecode") = false);
 
   py::class_<PyRuntimeSession>(m, "RuntimeSession", py::module_local())
       .def(py::init<>([](PyRuntimeSessionOptions &options, PyExecutable &exe) {
              MTRT_RuntimeSession session;
-             MTRT_Status s = mtrtRuntimeSessionCreate(options, exe, &session);
+             MTRT_Status s = callWithoutGIL([&]() {
+               return mtrtRuntimeSessionCreate(options, exe, &session);
+             });
              THROW_IF_MTRT_ERROR(s);
              return new PyRuntimeSession(session);
            }),
@@ -957,13 +1198,162 @@ PYBIND11_MODULE(_api, m) {
             auto inArgsGeneric = llvm::map_to_vector(inArgs, convertArgType);
             auto outArgsGeneric = llvm::map_to_vector(outArgs, convertArgType);
 
-            MTRT_Status s = mtrtRuntimeSessionExecuteFunction(
-                self, nameRef, inArgsGeneric.data(), inArgsGeneric.size(),
-                outArgsGeneric.data(), outArgsGeneric.size(),
-                stream ? *stream : mtrtStreamGetNull());
+            MTRT_Status s = callWithoutGIL(
+                [&]() {
+                  return mtrtRuntimeSessionExecuteFunction(
+                      self, nameRef, inArgsGeneric.data(), inArgsGeneric.size(),
+                      outArgsGeneric.data(), outArgsGeneric.size(),
+                      stream ? *stream : mtrtStreamGetNull());
+                },
+                self.mutex.get());
             THROW_IF_MTRT_ERROR(s);
           },
           py::arg("name"), py::arg("in_args"), py::arg("out_args"),
+          py::arg("stream") = py::none())
+      .def(
+          "bind_function",
+          [](PyRuntimeSession &self, std::string name) {
+            MTRT_StringView nameRef{name.data(), name.size()};
+            MTRT_BoundFunction func;
+            MTRT_Status s = callWithoutGIL(
+                [&]() {
+                  return mtrtRuntimeSessionBindFunction(self, nameRef, &func);
+                },
+                self.mutex.get());
+            THROW_IF_MTRT_ERROR(s);
+            auto *result = new PyBoundFunction(func);
+            result->sessionMutex = self.mutex;
+            return result;
+          },
+          py::arg("name"), py::keep_alive<0, 1>(),
+          "Resolve the named function ahead of time so that it can be "
+          "executed repeatedly with minimal per-call overhead")
+      .def(
+          "execute_function_async",
+          [](PyRuntimeSession &self, std::string name,
+             std::vector<py::object> inArgs, std::vector<py::object> outArgs,
+             std::optional<MTRT_Stream> stream) {
+            MTRT_StringView nameRef{name.data(), name.size()};
+
+            auto inArgsGeneric = llvm::map_to_vector(inArgs, convertArgType);
+            auto outArgsGeneric = llvm::map_to_vector(outArgs, convertArgType);
+
+            MTRT_AsyncExecution execution;
+            MTRT_Status s = callWithoutGIL(
+                [&]() {
+                  return mtrtRuntimeSessionExecuteFunctionAsync(
+                      self, nameRef, inArgsGeneric.data(), inArgsGeneric.size(),
+                      outArgsGeneric.data(), outArgsGeneric.size(),
+                      stream ? *stream : mtrtStreamGetNull(), &execution);
+                },
+                self.mutex.get());
+            THROW_IF_MTRT_ERROR(s);
+            auto *result = new PyAsyncExecution(execution);
+            result->sessionMutex = self.mutex;
+            return result;
+          },
+          py::arg("name"), py::arg("in_args"), py::arg("out_args"),
+          py::arg("stream") = py::none(), py::keep_alive<0, 1>(),
+          py::keep_alive<0, 3>(), py::keep_alive<0, 4>(),
+          "Start executing the named function and return an "
+          "`AsyncExecution` handle. Instead of blocking while waiting for "
+          "device work, the function is suspended until the handle is "
+          "polled or waited on")
+      .def(
+          "get_profile",
+          [](PyRuntimeSession &self, const std::string &format) {
+            MTRT_ProfileFormat profileFormat;
+            if (format == "summary")
+              profileFormat = MTRT_ProfileFormat_summary;
+            else if (format == "chrome_trace")
+              profileFormat = MTRT_ProfileFormat_chrome_trace;
+            else
+              throw std::invalid_argument(
+                  "expected the profile format to be \"summary\" or "
+                  "\"chrome_trace\"");
+            StringStreamAdaptor ss;
+            MTRT_Status s = callWithoutGIL(
+                [&]() {
+                  return mtrtRuntimeSessionPrintProfile(self, profileFormat,
+                                                        ss.getCallback());
+                },
+                self.mutex.get());
+            THROW_IF_MTRT_ERROR(s);
+            return ss.str();
+          },
+          py::arg("format") = "summary",
+          "Return the profile of the runtime builtins called by the "
+          "session's functions, either as a summary table (\"summary\") or "
+          "as Chrome trace JSON (\"chrome_trace\"). Profiling must be "
+          "enabled in the session options")
+      .def(
+          "reset_profile",
+          [](PyRuntimeSession &self) {
+            MTRT_Status s = callWithoutGIL(
+                [&]() { return mtrtRuntimeSessionResetProfile(self); },
+                self.mutex.get());
+            THROW_IF_MTRT_ERROR(s);
+          },
+          "Discard the profile recorded by the session");
+
+  py::class_<PyAsyncExecution>(m, "AsyncExecution", py::module_local())
+      .def(
+          "poll",
+          [](PyAsyncExecution &self) {
+            bool isDone = false;
+            MTRT_Status s = callWithoutGIL(
+                [&]() { return mtrtAsyncExecutionPoll(self, &isDone); },
+                self.sessionMutex.get());
+            THROW_IF_MTRT_ERROR(s);
+            return isDone;
+          },
+          "Make progress without blocking and return whether the execution "
+          "is done")
+      .def(
+          "wait",
+          [](PyAsyncExecution &self) {
+            MTRT_Status s =
+                callWithoutGIL([&]() { return mtrtAsyncExecutionWait(self); },
+                               self.sessionMutex.get());
+            THROW_IF_MTRT_ERROR(s);
+          },
+          "Block until the execution is done")
+      .def("__await__", [](py::object self) {
+        return awaitInExecutor(self.attr("wait"));
+      });
+
+  py::class_<PyRuntimeFuture>(m, "RuntimeFuture", py::module_local())
+      .def("done", &PyRuntimeFuture::isDone,
+           "Return whether the operation is done")
+      .def("wait", &PyRuntimeFuture::wait,
+           "Block until the operation is done")
+      .def("result", &PyRuntimeFuture::getResult,
+           "Block until the operation is done and return its result, or "
+           "raise its error")
+      .def("__await__", [](py::object self) {
+        return awaitInExecutor(self.attr("result"));
+      });
+
+  py::class_<PyBoundFunction>(m, "BoundFunction", py::module_local())
+      .def(
+          "execute",
+          [](PyBoundFunction &self, std::vector<py::object> inArgs,
+             std::vector<py::object> outArgs,
+             std::optional<MTRT_Stream> stream) {
+            auto inArgsGeneric = llvm::map_to_vector(inArgs, convertArgType);
+            auto outArgsGeneric = llvm::map_to_vector(outArgs, convertArgType);
+
+            MTRT_Status s = callWithoutGIL(
+                [&]() {
+                  return mtrtBoundFunctionExecute(
+                      self, inArgsGeneric.data(), inArgsGeneric.size(),
+                      outArgsGeneric.data(), outArgsGeneric.size(),
+                      stream ? *stream : mtrtStreamGetNull());
+                },
+                self.sessionMutex.get());
+            THROW_IF_MTRT_ERROR(s);
+          },
+          py::arg("in_args"), py::arg("out_args"),
           py::arg("stream") = py::none());
 
   py::class_<PyGlobalDebugFlag>(m, "GlobalDebug", py::module_local())
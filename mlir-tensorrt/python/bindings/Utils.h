@@ -568,6 +568,19 @@ static inline void populateFunctionBindingInModule(py::module &m) {
       "returns the name of the MLIR-TensorRT function in the same executable "
       "that computes the result shapes from "
       "the input shapes if available, otherwise it runs None");
+  signature.def(
+      "get_output_alias",
+      [](PyFunctionSignature &self, int index) -> std::optional<int64_t> {
+        int64_t inputIndex = -1;
+        MTRT_Status s =
+            mtrtFunctionSignatureGetOutputAlias(self, index, &inputIndex);
+        THROW_IF_MTRT_ERROR(s);
+        if (inputIndex < 0)
+          return std::nullopt;
+        return inputIndex;
+      },
+      "returns the index of the input argument that is donated to the given "
+      "output argument, or None if the output argument is not aliased");
 }
 
 /// This function declares a `PyExecutable` on the given Python module object.
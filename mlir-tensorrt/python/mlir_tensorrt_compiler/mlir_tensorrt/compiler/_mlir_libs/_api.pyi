@@ -38,6 +38,17 @@ __all__ = [
 
 class CompilerClient:
     def __init__(self, arg0: Context) -> None: ...
+    def enable_compilation_cache(
+        self, directory: str, max_size_in_bytes: int = 1073741824
+    ) -> None:
+        """
+        enables caching of compiled executables in the given directory
+        """
+
+    def get_compilation_cache_statistics(self) -> dict:
+        """
+        returns the numbers of hits and misses of the compilation cache
+        """
 
 class Executable:
     def __init__(self, buffer: str) -> None:
@@ -204,6 +215,11 @@ class PyFunctionSignature:
     def get_num_output_args(self) -> int: ...
     def get_num_res_bounds(self) -> int: ...
     def get_num_results(self) -> int: ...
+    def get_output_alias(self, arg0: int) -> int | None:
+        """
+        returns the index of the input argument that is donated to the given output argument, or None if the output argument is not aliased
+        """
+
     def get_res_bound(self, arg0: int) -> PyBounds: ...
     def get_result(self, arg0: int) -> Type: ...
     def get_shape_func_name(self) -> str | None:
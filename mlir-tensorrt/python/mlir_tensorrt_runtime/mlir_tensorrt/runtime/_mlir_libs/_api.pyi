@@ -13,6 +13,7 @@ __all__ = [
     "PyBounds",
     "PyFunctionSignature",
     "RuntimeClient",
+    "RuntimeFuture",
     "RuntimeSession",
     "RuntimeSessionOptions",
     "RuntimeValue",
@@ -150,6 +151,11 @@ class PyFunctionSignature:
     def get_num_output_args(self) -> int: ...
     def get_num_res_bounds(self) -> int: ...
     def get_num_results(self) -> int: ...
+    def get_output_alias(self, arg0: int) -> int | None:
+        """
+        returns the index of the input argument that is donated to the given output argument, or None if the output argument is not aliased
+        """
+
     def get_res_bound(self, arg0: int) -> PyBounds: ...
     def get_result(self, arg0: int) -> Type: ...
     def get_shape_func_name(self) -> str | None:
@@ -165,6 +171,16 @@ class RuntimeClient:
         device: Device,
         stream: Stream | None = None,
     ) -> MemRefValue: ...
+    def copy_to_device_async(
+        self,
+        host_memref: MemRefValue,
+        device: Device,
+        stream: Stream | None = None,
+    ) -> RuntimeFuture:
+        """
+        Start copying the host memref to a new memref on the device and return a `RuntimeFuture` of the new memref
+        """
+
     @typing.overload
     def copy_to_host(
         self, device_memref: MemRefValue, stream: Stream | None = None
@@ -176,6 +192,24 @@ class RuntimeClient:
         existing_host_memref: MemRefValue,
         stream: Stream | None = None,
     ) -> None: ...
+    @typing.overload
+    def copy_to_host_async(
+        self, device_memref: MemRefValue, stream: Stream | None = None
+    ) -> RuntimeFuture:
+        """
+        Start copying the device memref to a new host memref and return a `RuntimeFuture` of the new memref
+        """
+
+    @typing.overload
+    def copy_to_host_async(
+        self,
+        device_memref: MemRefValue,
+        existing_host_memref: MemRefValue,
+        stream: Stream | None = None,
+    ) -> RuntimeFuture:
+        """
+        Start copying the device memref into the host memref and return a `RuntimeFuture` of None
+        """
     def create_device_memref_view(
         self, ptr: int, shape: list[int], dtype: ScalarTypeCode, device: Device
     ) -> MemRefValue: ...
@@ -209,6 +243,23 @@ class RuntimeClient:
     def create_stream(self) -> Stream: ...
     def get_devices(self) -> list[Device]: ...
 
+class RuntimeFuture:
+    def __await__(self) -> typing.Generator[typing.Any, None, typing.Any]: ...
+    def done(self) -> bool:
+        """
+        Return whether the operation is done
+        """
+
+    def result(self) -> typing.Any:
+        """
+        Block until the operation is done and return its result, or raise its error
+        """
+
+    def wait(self) -> None:
+        """
+        Block until the operation is done
+        """
+
 class RuntimeSession:
     def __init__(
         self, options: RuntimeSessionOptions, executable: Executable
@@ -220,10 +271,25 @@ class RuntimeSession:
         out_args: list[typing.Any],
         stream: Stream | None = None,
     ) -> None: ...
+    def get_profile(self, format: str = "summary") -> str:
+        """
+        Return the profile of the runtime builtins called by the session's functions, either as a summary table ("summary") or as Chrome trace JSON ("chrome_trace"). Profiling must be enabled in the session options
+        """
+
+    def reset_profile(self) -> None:
+        """
+        Discard the profile recorded by the session
+        """
 
 class RuntimeSessionOptions:
     def __init__(
-        self, num_devices: int = 1, device_id: int = 0, nccl_uuid: str = ""
+        self,
+        num_devices: int = 1,
+        device_id: int = 0,
+        nccl_uuid: str = "",
+        enable_profiling: bool = False,
+        num_host_copy_threads: int = 1,
+        enable_executable_bytecode: bool = False,
     ) -> None: ...
 
 class RuntimeValue:
@@ -24,6 +24,7 @@
 #include "mlir-tensorrt-dialect/Target/TensorRTEncodingOpInterface/NetworkEncoder.h"
 #include "mlir-tensorrt-dialect/Utils/Options.h"
 #include "mlir/Support/LogicalResult.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/raw_ostream.h"
 
 #if defined(__GNUC__) || defined(__clang__)
@@ -121,6 +122,20 @@ struct TensorRTTranslationOptions {
   /// hash.
   std::string loadTensorRTEnginesFromDirectory;
 
+  //===----------------------------------------------------------------------===//
+  // Engine cache options
+  //===----------------------------------------------------------------------===//
+
+  /// Reuse engines of structurally identical functions that were built with
+  /// the same builder options, within and across compilations in the same
+  /// process.
+  bool enableEngineCache = false;
+
+  /// If not empty, persist the engine cache to the specified directory so
+  /// that engines are also reused across processes. Implies
+  /// `enableEngineCache`.
+  std::string engineCacheDirectory;
+
   /// Add command line options to mlir::OptionsContext and configure struct to
   /// serve as backend storage for the options.
   void addToOptions(mlir::OptionsContext &context) {
@@ -134,6 +149,10 @@ struct TensorRTTranslationOptions {
                       llvm::cl::init(""));
     context.addOption("tensorrt-layer-info-dir", saveTensorRTLayerInfoDirectory,
                       llvm::cl::init(""));
+    context.addOption("tensorrt-engine-cache", enableEngineCache,
+                      llvm::cl::init(false));
+    context.addOption("tensorrt-engine-cache-dir", engineCacheDirectory,
+                      llvm::cl::init(""));
     context.addOptionWithParser<ByteSizeParser>(
         "tensorrt-workspace-memory-pool-limit", workspaceMemoryPoolLimit,
         llvm::cl::init(std::nullopt));
@@ -222,6 +241,49 @@ private:
   std::mutex lock;
 };
 
+/// A cache of serialized TensorRT engines that is keyed on a structural hash
+/// of the translated function (ignoring its name and locations, but including
+/// the shape profiles of its arguments), the builder options that affect the
+/// engine, the TensorRT version, and the compute capability of the target
+/// device. Engines are kept in memory and, if a directory is given, persisted
+/// to `<key>.engine` files that are written atomically. This allows identical
+/// clusters (e.g. repeated transformer blocks) and clusters that did not
+/// change since a previous compilation to skip the engine build.
+class TensorRTEngineCache {
+public:
+  explicit TensorRTEngineCache(std::string directory = "")
+      : directory(std::move(directory)) {}
+
+  /// The maximum number of caches that `getSharedCache` retains.
+  static constexpr unsigned kMaxSharedCaches = 8;
+
+  /// Return the cache shared by all users in the process that persist to
+  /// `directory` (or that only use memory if `directory` is empty). At most
+  /// `kMaxSharedCaches` caches are retained; the least recently requested one
+  /// is released first, so a later request for its directory returns a new
+  /// cache that reloads persisted engines from disk.
+  static std::shared_ptr<TensorRTEngineCache>
+  getSharedCache(llvm::StringRef directory);
+
+  /// Return the key of building `op` with `options` using `builderContext`.
+  static std::string getKey(mlir::FunctionOpInterface op,
+                            const TensorRTTranslationOptions &options,
+                            const TensorRTBuilderContext &builderContext);
+
+  /// Return the engine for `key`, or nullptr if none is cached.
+  std::shared_ptr<const std::vector<char>> lookup(llvm::StringRef key);
+
+  /// Cache `engine` under `key`. Failures to persist the engine are reported
+  /// as warnings at `loc`.
+  void insert(llvm::StringRef key, llvm::ArrayRef<char> engine,
+              Location loc);
+
+private:
+  std::string directory;
+  std::mutex lock;
+  llvm::StringMap<std::shared_ptr<const std::vector<char>>> engines;
+};
+
 /// Given the function-like `op`, try to translate it into a TensorRT engine and
 /// return the serialized engine data. If `verbose` is true, it prints the
 /// TensorRT builder logs to stderr. This function expects that the
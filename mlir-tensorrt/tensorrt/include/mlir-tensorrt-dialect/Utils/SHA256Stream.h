@@ -0,0 +1,50 @@
+//===- SHA256Stream.h -------------------------------------------*- C++ -*-===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// A raw_ostream that feeds its output into a SHA-256 hasher.
+///
+//===----------------------------------------------------------------------===//
+#ifndef MLIR_TENSORRT_DIALECT_UTILS_SHA256STREAM
+#define MLIR_TENSORRT_DIALECT_UTILS_SHA256STREAM
+
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace mlir {
+
+/// A stream that feeds everything written to it into a SHA-256 hasher, so
+/// that large IR (e.g. modules or functions with large weights) can be hashed
+/// by printing it without materializing its assembly.
+class SHA256Stream : public llvm::raw_ostream {
+public:
+  explicit SHA256Stream(llvm::SHA256 &hasher);
+
+private:
+  void write_impl(const char *ptr, size_t size) override;
+
+  uint64_t current_pos() const override { return pos; }
+
+  llvm::SHA256 &hasher;
+  uint64_t pos{0};
+};
+
+} // namespace mlir
+
+#endif // MLIR_TENSORRT_DIALECT_UTILS_SHA256STREAM
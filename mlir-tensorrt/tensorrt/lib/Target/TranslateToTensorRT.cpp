@@ -27,6 +27,7 @@
 #include "mlir-tensorrt-dialect/TensorRT/IR/TensorRTDialect.h"
 #include "mlir-tensorrt-dialect/TensorRT/Utils/Utils.h"
 #include "mlir-tensorrt-dialect/Utils/NvInferAdaptor.h"
+#include "mlir-tensorrt-dialect/Utils/SHA256Stream.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/TypeUtilities.h"
@@ -46,6 +47,7 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
@@ -169,6 +171,20 @@ struct TensorRTTranslationCLFlags {
       llvm::cl::value_desc("pluginPathToSerialize"),
       llvm::cl::cat(optCategory)};
 
+  //===----------------------------------------------------------------------===//
+  // Engine Cache
+  //===----------------------------------------------------------------------===//
+  llvm::cl::opt<bool> enableEngineCache{
+      "tensorrt-engine-cache",
+      llvm::cl::desc("reuse TensorRT engines of structurally identical "
+                     "functions within and across compilations"),
+      llvm::cl::init(false), llvm::cl::cat(optCategory)};
+  llvm::cl::opt<std::string> engineCacheDirectory{
+      "tensorrt-engine-cache-dir",
+      llvm::cl::desc("directory where the TensorRT engine cache is persisted; "
+                     "implies -tensorrt-engine-cache"),
+      llvm::cl::init(""), llvm::cl::cat(optCategory)};
+
   //===----------------------------------------------------------------------===//
   // Engine Inspector and Debugging
   //===----------------------------------------------------------------------===//
@@ -232,6 +248,9 @@ TensorRTTranslationOptions TensorRTTranslationOptions::fromCLFlags() {
       clTensorRTTranslationOptions->saveTensorRTEngines;
   options.loadTensorRTEnginesFromDirectory =
       clTensorRTTranslationOptions->loadTensorRTEngines;
+  options.enableEngineCache = clTensorRTTranslationOptions->enableEngineCache;
+  options.engineCacheDirectory =
+      clTensorRTTranslationOptions->engineCacheDirectory;
 
   return options;
 }
@@ -338,6 +357,127 @@ void TensorRTSerializedTimingCache::write(llvm::raw_ostream &os) {
   os.write(data.data(), data.size());
 }
 
+//===----------------------------------------------------------------------===//
+// TensorRTEngineCache
+//===----------------------------------------------------------------------===//
+
+std::shared_ptr<TensorRTEngineCache>
+TensorRTEngineCache::getSharedCache(StringRef directory) {
+  // The registry is ordered from least to most recently used. Evicting a
+  // cache only drops the registry's reference; current users keep it alive.
+  static std::mutex registryLock;
+  static std::vector<std::shared_ptr<TensorRTEngineCache>> registry;
+  std::scoped_lock<std::mutex> g(registryLock);
+  auto it = llvm::find_if(registry, [&](const auto &cache) {
+    return cache->directory == directory;
+  });
+  std::shared_ptr<TensorRTEngineCache> cache;
+  if (it != registry.end()) {
+    cache = std::move(*it);
+    registry.erase(it);
+  } else {
+    cache = std::make_shared<TensorRTEngineCache>(directory.str());
+    if (registry.size() >= kMaxSharedCaches) {
+      LLVM_DEBUG(DBGS() << "evicting shared TensorRT engine cache for '"
+                        << registry.front()->directory << "'\n");
+      registry.erase(registry.begin());
+    }
+  }
+  registry.push_back(cache);
+  return cache;
+}
+
+std::string
+TensorRTEngineCache::getKey(FunctionOpInterface op,
+                            const TensorRTTranslationOptions &options,
+                            const TensorRTBuilderContext &builderContext) {
+  llvm::SHA256 hasher;
+  {
+    SHA256Stream os(hasher);
+
+    // The builder configuration and the target device.
+    int32_t device = builderContext.getCudaDeviceNumber();
+    int smMajor = 0, smMinor = 0;
+    (void)cudaDeviceGetAttribute(&smMajor, cudaDevAttrComputeCapabilityMajor,
+                                 device);
+    (void)cudaDeviceGetAttribute(&smMinor, cudaDevAttrComputeCapabilityMinor,
+                                 device);
+    os << "tensorrt=" << builderContext.getTensorRTVersion().getAsString()
+       << ";sm=" << smMajor << "." << smMinor
+       << ";opt-level=" << options.tensorrtBuilderOptLevel
+       << ";fp16=" << options.forceEnableFP16
+       << ";obey-precision=" << options.obeyPrecisionConstraints
+       << ";strongly-typed=" << options.enableStronglyTyped
+       << ";detailed-profiling="
+       << (!options.saveTensorRTEnginesToDirectory.empty() ||
+           !options.saveTensorRTLayerInfoDirectory.empty())
+       << ";workspace=";
+    if (options.workspaceMemoryPoolLimit)
+      os << *options.workspaceMemoryPoolLimit;
+    for (const std::string &path : options.pluginPathsToSerialize)
+      os << ";plugin=" << path;
+    os << "\n";
+
+    // The function, including the shape profiles of its arguments. The name
+    // is replaced so that identical functions share an engine, and locations
+    // are omitted.
+    Operation *clone = op->clone();
+    SymbolTable::setSymbolName(clone, "engine");
+    clone->print(
+        os, OpPrintingFlags().printGenericOpForm().enableDebugInfo(false));
+    clone->destroy();
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::shared_ptr<const std::vector<char>>
+TensorRTEngineCache::lookup(StringRef key) {
+  std::scoped_lock<std::mutex> g(lock);
+  auto it = engines.find(key);
+  if (it != engines.end())
+    return it->second;
+  if (directory.empty())
+    return nullptr;
+
+  llvm::SmallString<128> path(directory);
+  llvm::sys::path::append(path, key + ".engine");
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                  /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return nullptr;
+  LLVM_DEBUG(DBGS() << "loaded TensorRT engine from " << path << "\n");
+  auto engine = std::make_shared<const std::vector<char>>(
+      (*buffer)->getBufferStart(), (*buffer)->getBufferEnd());
+  engines[key] = engine;
+  return engine;
+}
+
+void TensorRTEngineCache::insert(StringRef key, ArrayRef<char> engine,
+                                 Location loc) {
+  std::scoped_lock<std::mutex> g(lock);
+  engines[key] =
+      std::make_shared<const std::vector<char>>(engine.begin(), engine.end());
+  if (directory.empty())
+    return;
+
+  if (std::error_code ec = llvm::sys::fs::create_directories(directory)) {
+    emitWarning(loc) << "could not create TensorRT engine cache directory '"
+                     << directory << "': " << ec.message();
+    return;
+  }
+  // `writeToOutput` renames a temporary file, so concurrent compilations
+  // never observe partially written engines.
+  llvm::SmallString<128> path(directory);
+  llvm::sys::path::append(path, key + ".engine");
+  if (llvm::Error err = llvm::writeToOutput(path, [&](llvm::raw_ostream &os) {
+        os.write(engine.data(), engine.size());
+        return llvm::Error::success();
+      }))
+    emitWarning(loc) << "failed to write TensorRT engine to '" << path
+                     << "': " << llvm::toString(std::move(err));
+}
+
 //===----------------------------------------------------------------------===//
 // Core TensorRT Translation Entrypoint
 //===----------------------------------------------------------------------===//
@@ -629,9 +769,9 @@ static llvm::SmallString<128> getEngineFileName(func::FuncOp func,
 
 /// Write the `serializedEngine` to a file at the given directory. The filename
 /// is calculated from the function name and the hash of the function.
-static LogicalResult saveTensorRTEngineToFile(
-    func::FuncOp func, StringRef directoryPath,
-    const std::unique_ptr<nvinfer1::IHostMemory> &serializedEngine) {
+static LogicalResult saveTensorRTEngineToFile(func::FuncOp func,
+                                              StringRef directoryPath,
+                                              ArrayRef<char> serializedEngine) {
   if (failed(createDirectories(func.getLoc(), directoryPath)))
     return failure();
   llvm::SmallString<128> fileName = getEngineFileName(func, directoryPath);
@@ -642,8 +782,7 @@ static LogicalResult saveTensorRTEngineToFile(
     emitError(func.getLoc()) << "failed to open " << fileName << ": " << error;
     return failure();
   }
-  of->os().write(static_cast<char *>(serializedEngine->data()),
-                 serializedEngine->size());
+  of->os().write(serializedEngine.data(), serializedEngine.size());
   if (of->os().has_error()) {
     emitError(func.getLoc()) << "failed to write TensorRT engine to "
                              << fileName << ": " << of->os().error().message();
@@ -757,6 +896,12 @@ public:
       this->timingCache =
           loadSerializedTimingCache(translationOptions.timingCachePath);
 
+    bool enableEngineCache = translationOptions.enableEngineCache ||
+                             !translationOptions.engineCacheDirectory.empty();
+    if (!this->engineCache && enableEngineCache)
+      this->engineCache = TensorRTEngineCache::getSharedCache(
+          translationOptions.engineCacheDirectory);
+
     return success();
   }
 
@@ -803,16 +948,40 @@ public:
         continue;
       }
 
-      FailureOr<TensorRTEngineResult> engineResult =
-          buildFunction(func, *builderContext, *timingCache, translationOptions,
-                        layerMetadataCallback);
-      if (failed(engineResult) || !engineResult->serializedEngine) {
-        func.emitError() << "failed to translate function '" << func.getName()
-                         << "' to a TensorRT engine";
-        return signalPassFailure();
+      // Reuse the engine of a structurally identical function if one was
+      // cached. Engines with custom layer metadata are not shared.
+      std::string cacheKey;
+      std::shared_ptr<const std::vector<char>> cachedEngine;
+      if (engineCache && !layerMetadataCallback) {
+        cacheKey = TensorRTEngineCache::getKey(func, translationOptions,
+                                               *builderContext);
+        cachedEngine = engineCache->lookup(cacheKey);
+      }
+
+      std::unique_ptr<nvinfer1::IHostMemory> builtEngine;
+      ArrayRef<char> serializedEngine;
+      if (cachedEngine) {
+        LLVM_DEBUG(DBGS() << "reusing cached engine for function '"
+                          << func.getName() << "'\n");
+        numEngineCacheHits++;
+        serializedEngine = *cachedEngine;
+      } else {
+        FailureOr<TensorRTEngineResult> engineResult =
+            buildFunction(func, *builderContext, *timingCache,
+                          translationOptions, layerMetadataCallback);
+        if (failed(engineResult) || !engineResult->serializedEngine) {
+          func.emitError() << "failed to translate function '"
+                           << func.getName() << "' to a TensorRT engine";
+          return signalPassFailure();
+        }
+        builtEngine = std::move(engineResult->serializedEngine);
+        serializedEngine =
+            ArrayRef<char>(static_cast<const char *>(builtEngine->data()),
+                           builtEngine->size());
+        numEnginesBuilt++;
+        if (!cacheKey.empty())
+          engineCache->insert(cacheKey, serializedEngine, func.getLoc());
       }
-      const std::unique_ptr<nvinfer1::IHostMemory> &serializedEngine =
-          engineResult->serializedEngine;
 
       if (!translationOptions.saveTensorRTEnginesToDirectory.empty() &&
           failed(saveTensorRTEngineToFile(
@@ -824,8 +993,8 @@ public:
         std::unique_ptr<nvinfer1::IRuntime> runtime{
             nvinfer1::createInferRuntime(*builderContext->getLogger())};
         std::unique_ptr<nvinfer1::ICudaEngine> cudaEngine{
-            runtime->deserializeCudaEngine(serializedEngine->data(),
-                                           serializedEngine->size())};
+            runtime->deserializeCudaEngine(serializedEngine.data(),
+                                           serializedEngine.size())};
         auto inspector = std::unique_ptr<nvinfer1::IEngineInspector>(
             cudaEngine->createEngineInspector());
         llvm::SmallString<128> fileName =
@@ -854,11 +1023,11 @@ public:
       // Attach the engine as an attribute on the function.
       auto engineAttr = DenseElementsAttr::get(
           RankedTensorType::get(
-              {static_cast<int64_t>(serializedEngine->size())},
+              {static_cast<int64_t>(serializedEngine.size())},
               IntegerType::get(&getContext(), 8)),
           llvm::ArrayRef<int8_t>(
-              reinterpret_cast<const int8_t *>(serializedEngine->data()),
-              serializedEngine->size()));
+              reinterpret_cast<const int8_t *>(serializedEngine.data()),
+              serializedEngine.size()));
       func->setAttr("tensorrt.engine", engineAttr);
     }
 
@@ -880,6 +1049,10 @@ private:
   /// and reused over translation calls.
   std::shared_ptr<TensorRTSerializedTimingCache> timingCache{nullptr};
 
+  /// The cache of serialized engines, if enabled. It is shared with other
+  /// instances of the pass in the process.
+  std::shared_ptr<TensorRTEngineCache> engineCache{nullptr};
+
   /// Options affecting TensorRT translation.
   TensorRTTranslationOptions translationOptions;
 
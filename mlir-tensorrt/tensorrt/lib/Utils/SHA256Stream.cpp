@@ -0,0 +1,36 @@
+//===- SHA256Stream.cpp ---------------------------------------------------===//
+//
+// SPDX-FileCopyrightText: Copyright 2024 NVIDIA CORPORATION & AFFILIATES.
+// All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//===----------------------------------------------------------------------===//
+///
+/// Implementation of the SHA-256 hashing stream.
+///
+//===----------------------------------------------------------------------===//
+#include "mlir-tensorrt-dialect/Utils/SHA256Stream.h"
+
+using namespace mlir;
+
+SHA256Stream::SHA256Stream(llvm::SHA256 &hasher) : hasher(hasher) {
+  SetUnbuffered();
+}
+
+void SHA256Stream::write_impl(const char *ptr, size_t size) {
+  hasher.update(
+      llvm::ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(ptr), size));
+  pos += size;
+}
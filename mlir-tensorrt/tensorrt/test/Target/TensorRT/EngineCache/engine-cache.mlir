@@ -0,0 +1,36 @@
+// RUN: rm -rf %t || true
+// RUN: mkdir %t
+// RUN: %pick-one-gpu tensorrt-opt %s -pass-pipeline="builtin.module(tensorrt.module(translate-tensorrt-to-engine))" \
+// RUN:  --mlir-elide-elementsattrs-if-larger=32 --mlir-pass-statistics \
+// RUN:  -tensorrt-builder-opt-level=0 \
+// RUN:  --tensorrt-engine-cache-dir=%t 2>&1 | FileCheck %s --check-prefix=FIRST
+// RUN: %pick-one-gpu tensorrt-opt %s -pass-pipeline="builtin.module(tensorrt.module(translate-tensorrt-to-engine))" \
+// RUN:  --mlir-elide-elementsattrs-if-larger=32 --mlir-pass-statistics \
+// RUN:  -tensorrt-builder-opt-level=0 \
+// RUN:  --tensorrt-engine-cache-dir=%t 2>&1 | FileCheck %s --check-prefix=SECOND
+
+// `func1` and `func2` only differ in their names, so they share an engine.
+// The second run reuses all engines persisted by the first run.
+
+tensorrt.module @sub_module {
+  func.func @func1(%arg0: tensor<2x10xf32>) -> tensor<2x10xf32> {
+    %0 = tensorrt.activation {activationType = #tensorrt.activation_type<kRELU>} %arg0 : tensor<2x10xf32>
+    return %0 : tensor<2x10xf32>
+  }
+  func.func @func2(%arg0: tensor<2x10xf32>) -> tensor<2x10xf32> {
+    %0 = tensorrt.activation {activationType = #tensorrt.activation_type<kRELU>} %arg0 : tensor<2x10xf32>
+    return %0 : tensor<2x10xf32>
+  }
+  func.func @func3(%arg0: tensor<2x10xf32>) -> tensor<2x10xf32> {
+    %0 = tensorrt.activation {activationType = #tensorrt.activation_type<kTANH>} %arg0 : tensor<2x10xf32>
+    return %0 : tensor<2x10xf32>
+  }
+}
+
+// FIRST-LABEL: TranslateToTensorRTEnginePass
+//   FIRST-DAG: (S) 1 num-engine-cache-hits
+//   FIRST-DAG: (S) 2 num-engines-built
+
+// SECOND-LABEL: TranslateToTensorRTEnginePass
+//   SECOND-DAG: (S) 3 num-engine-cache-hits
+//   SECOND-DAG: (S) 0 num-engines-built
@@ -110,3 +110,13 @@ func.func @shape_func(%arg0: memref<2xi32>, %arg1: memref<2xi32> {plan.result_ar
 // CHECK-LABEL: func.func @func_metadata_conversion
 //  CHECK-SAME: (%{{.+}}: memref<?xi32> {executor.result_arg}) attributes {executor.shape_func = @shape_func}
 //       CHECK: func.func @shape_func(%{{.+}}: memref<2xi32>, %{{.+}}: memref<2xi32> {executor.result_arg})
+
+// -----
+
+func.func @aliasing_output_conversion(%arg0: memref<10xf32> {plan.aliasing_output_arg = 0 : i64},
+                                      %arg1: memref<10xf32> {plan.result_arg}) {
+  return
+}
+
+// CHECK-LABEL: func.func @aliasing_output_conversion
+//  CHECK-SAME: (%{{.+}}: memref<10xf32> {executor.aliasing_output = 0 : i64}, %{{.+}}: memref<10xf32> {executor.result_arg})
@@ -0,0 +1,67 @@
+// RUN: mlir-tensorrt-opt %s -split-input-file \
+// RUN:  -stablehlo-clustering="entrypoint=" -plan-outline-clusters \
+// RUN: | FileCheck %s
+
+builtin.module attributes {
+  plan.cluster_kinds = [
+    #plan.host_tensor_cluster<benefit = 1, max_num_elements = 64>,
+    #plan.host_cluster<benefit = 0>
+  ]
+} {
+  func.func @small_host_tensors(%arg0: tensor<16xi32> {tensorrt.host_tensor},
+                                %arg1: tensor<16xi32> {tensorrt.host_tensor})
+      -> (tensor<4x4xi32> {tensorrt.host_tensor}) {
+    %0 = stablehlo.add %arg0, %arg1 : tensor<16xi32>
+    %1 = stablehlo.reshape %0 : (tensor<16xi32>) -> tensor<4x4xi32>
+    return %1 : tensor<4x4xi32>
+  }
+}
+
+// CHECK-LABEL: func.func @small_host_tensors
+//  CHECK-SAME: (%[[arg0:.+]]: tensor<16xi32> {tensorrt.host_tensor}, %[[arg1:.+]]: tensor<16xi32> {tensorrt.host_tensor})
+//       CHECK:     %[[v0:.+]] = call @host_tensor_cluster(%[[arg0]], %[[arg1]]) : (tensor<16xi32>, tensor<16xi32>) -> tensor<4x4xi32>
+//       CHECK:     return %[[v0]]
+// CHECK-LABEL: private @host_tensor_cluster
+//  CHECK-SAME: (%[[arg0:.+]]: tensor<16xi32>, %[[arg1:.+]]: tensor<16xi32>) -> tensor<4x4xi32> attributes {cluster.host_tensor}
+//       CHECK:     %[[v0:.+]] = stablehlo.add %[[arg0]], %[[arg1]] : tensor<16xi32>
+//       CHECK:     %[[v1:.+]] = stablehlo.reshape %[[v0]] : (tensor<16xi32>) -> tensor<4x4xi32>
+//       CHECK:     return %[[v1]]
+
+// -----
+
+builtin.module attributes {
+  plan.cluster_kinds = [
+    #plan.host_tensor_cluster<benefit = 1, max_num_elements = 64>,
+    #plan.host_cluster<benefit = 0>
+  ]
+} {
+  func.func @large_host_tensors(%arg0: tensor<256xi32> {tensorrt.host_tensor},
+                                %arg1: tensor<256xi32> {tensorrt.host_tensor})
+      -> (tensor<256xi32> {tensorrt.host_tensor}) {
+    %0 = stablehlo.add %arg0, %arg1 : tensor<256xi32>
+    return %0 : tensor<256xi32>
+  }
+}
+
+// CHECK-LABEL: func.func @large_host_tensors
+//   CHECK-NOT:     call @host_tensor_cluster
+//       CHECK:     stablehlo.add
+
+// -----
+
+builtin.module attributes {
+  plan.cluster_kinds = [
+    #plan.host_tensor_cluster<benefit = 1, max_num_elements = 64>,
+    #plan.host_cluster<benefit = 0>
+  ]
+} {
+  func.func @small_device_tensors(%arg0: tensor<16xi32>, %arg1: tensor<16xi32>)
+      -> tensor<16xi32> {
+    %0 = stablehlo.add %arg0, %arg1 : tensor<16xi32>
+    return %0 : tensor<16xi32>
+  }
+}
+
+// CHECK-LABEL: func.func @small_device_tensors
+//   CHECK-NOT:     call @host_tensor_cluster
+//       CHECK:     stablehlo.add
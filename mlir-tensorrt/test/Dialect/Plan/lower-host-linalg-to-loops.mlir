@@ -0,0 +1,42 @@
+// RUN: mlir-tensorrt-opt %s -split-input-file -plan-lower-host-linalg-to-loops | FileCheck %s
+
+#map = affine_map<(d0) -> (d0)>
+
+func.func @host_generic(%arg0: memref<16xi32, #plan.memory_space<host_pinned>>,
+                        %arg1: memref<16xi32, #plan.memory_space<host>>) {
+  linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]}
+      ins(%arg0 : memref<16xi32, #plan.memory_space<host_pinned>>)
+      outs(%arg1 : memref<16xi32, #plan.memory_space<host>>) {
+  ^bb0(%in: i32, %out: i32):
+    %0 = arith.addi %in, %in : i32
+    linalg.yield %0 : i32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @host_generic
+//  CHECK-SAME: (%[[arg0:.+]]: memref<16xi32, #plan.memory_space<host_pinned>>, %[[arg1:.+]]: memref<16xi32, #plan.memory_space<host>>)
+//   CHECK-NOT:     linalg.generic
+//       CHECK:     scf.for %[[i:.+]] =
+//       CHECK:       %[[v0:.+]] = memref.load %[[arg0]][%[[i]]]
+//       CHECK:       %[[v1:.+]] = arith.addi %[[v0]], %[[v0]] : i32
+//       CHECK:       memref.store %[[v1]], %[[arg1]][%[[i]]]
+
+// -----
+
+#map = affine_map<(d0) -> (d0)>
+
+func.func @device_generic(%arg0: memref<16xi32, #plan.memory_space<host_pinned>>,
+                          %arg1: memref<16xi32, #plan.memory_space<device>>) {
+  linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]}
+      ins(%arg0 : memref<16xi32, #plan.memory_space<host_pinned>>)
+      outs(%arg1 : memref<16xi32, #plan.memory_space<device>>) {
+  ^bb0(%in: i32, %out: i32):
+    linalg.yield %in : i32
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @device_generic
+//   CHECK-NOT:     scf.for
+//       CHECK:     linalg.generic
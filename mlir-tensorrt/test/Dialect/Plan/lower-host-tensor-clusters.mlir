@@ -0,0 +1,28 @@
+// RUN: mlir-tensorrt-opt %s -split-input-file -plan-lower-host-tensor-clusters | FileCheck %s
+
+func.func private @host_tensor_cluster(%arg0: tensor<16xi32>, %arg1: tensor<16xi32>) -> tensor<16xi32>
+    attributes {cluster.host_tensor} {
+  %0 = stablehlo.add %arg0, %arg1 : tensor<16xi32>
+  %1 = stablehlo.multiply %0, %arg1 : tensor<16xi32>
+  return %1 : tensor<16xi32>
+}
+
+// CHECK-LABEL: func.func private @host_tensor_cluster
+//  CHECK-SAME: (%[[arg0:.+]]: tensor<16xi32>, %[[arg1:.+]]: tensor<16xi32>)
+//   CHECK-DAG:     %[[v0:.+]] = bufferization.alloc_tensor() copy(%[[arg0]]) {memory_space = #plan.memory_space<host_pinned>} : tensor<16xi32>
+//   CHECK-DAG:     %[[v1:.+]] = bufferization.alloc_tensor() copy(%[[arg1]]) {memory_space = #plan.memory_space<host_pinned>} : tensor<16xi32>
+//       CHECK:     bufferization.alloc_tensor() {memory_space = #plan.memory_space<host_pinned>} : tensor<16xi32>
+//       CHECK:     linalg.generic
+//   CHECK-NOT:     stablehlo.
+//   CHECK-NOT:     tensor.empty
+//       CHECK:     return
+
+// -----
+
+func.func private @not_a_host_tensor_cluster(%arg0: tensor<16xi32>, %arg1: tensor<16xi32>) -> tensor<16xi32> {
+  %0 = stablehlo.add %arg0, %arg1 : tensor<16xi32>
+  return %0 : tensor<16xi32>
+}
+
+// CHECK-LABEL: func.func private @not_a_host_tensor_cluster
+//  CHECK-NEXT:     stablehlo.add
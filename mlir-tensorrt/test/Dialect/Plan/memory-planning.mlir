@@ -0,0 +1,122 @@
+// RUN: mlir-tensorrt-opt %s -split-input-file -plan-memory-planning | FileCheck %s
+
+!host_memref = memref<256xf32, #plan.memory_space<host>>
+
+func.func @reuse_disjoint_lifetimes(%arg0: !host_memref, %arg1: !host_memref) {
+  %0 = memref.alloc() : !host_memref
+  memref.copy %arg0, %0 : !host_memref to !host_memref
+  %1 = memref.alloc() : !host_memref
+  memref.copy %0, %1 : !host_memref to !host_memref
+  memref.dealloc %0 : !host_memref
+  %2 = memref.alloc() : !host_memref
+  memref.copy %1, %2 : !host_memref to !host_memref
+  memref.dealloc %1 : !host_memref
+  memref.copy %2, %arg1 : !host_memref to !host_memref
+  memref.dealloc %2 : !host_memref
+  return
+}
+
+// CHECK-LABEL: func.func @reuse_disjoint_lifetimes
+//  CHECK-SAME: (%[[arg0:.+]]: memref<256xf32, #plan.memory_space<host>>, %[[arg1:.+]]: memref<256xf32, #plan.memory_space<host>>)
+//       CHECK:     %[[ws:.+]] = memref.alloc() {alignment = 256 : i64} : memref<2048xi8, #plan.memory_space<host>>
+//       CHECK:     %[[c0:.+]] = arith.constant 0 : index
+//       CHECK:     %[[v0:.+]] = memref.view %[[ws]][%[[c0]]][] : memref<2048xi8, #plan.memory_space<host>> to memref<256xf32, #plan.memory_space<host>>
+//       CHECK:     memref.copy %[[arg0]], %[[v0]]
+//       CHECK:     %[[c1024:.+]] = arith.constant 1024 : index
+//       CHECK:     %[[v1:.+]] = memref.view %[[ws]][%[[c1024]]][]
+//       CHECK:     memref.copy %[[v0]], %[[v1]]
+//   CHECK-NOT:     memref.dealloc
+//       CHECK:     %[[c0_0:.+]] = arith.constant 0 : index
+//       CHECK:     %[[v2:.+]] = memref.view %[[ws]][%[[c0_0]]][]
+//       CHECK:     memref.copy %[[v1]], %[[v2]]
+//       CHECK:     memref.copy %[[v2]], %[[arg1]]
+//       CHECK:     memref.dealloc %[[ws]]
+//       CHECK:     return
+
+// -----
+
+!device_memref = memref<?x64xf32, #plan.memory_space<device>>
+
+func.func @bounded_dynamic_shapes(
+    %arg0: index {tensorrt.value_bounds = #tensorrt.shape_profile<min = [1], opt = [2], max = [4]>},
+    %arg1: !device_memref) {
+  %0 = memref.alloc(%arg0) : !device_memref
+  memref.copy %arg1, %0 : !device_memref to !device_memref
+  %1 = memref.alloc(%arg0) : !device_memref
+  memref.copy %0, %1 : !device_memref to !device_memref
+  memref.dealloc %0 : !device_memref
+  memref.dealloc %1 : !device_memref
+  return
+}
+
+// CHECK-LABEL: func.func @bounded_dynamic_shapes
+//  CHECK-SAME: (%[[arg0:.+]]: index {{.*}}, %[[arg1:.+]]: memref<?x64xf32, #plan.memory_space<device>>)
+//       CHECK:     %[[ws:.+]] = memref.alloc() {alignment = 256 : i64} : memref<2048xi8, #plan.memory_space<device>>
+//       CHECK:     %[[c0:.+]] = arith.constant 0 : index
+//       CHECK:     %[[v0:.+]] = memref.view %[[ws]][%[[c0]]][%[[arg0]]] : memref<2048xi8, #plan.memory_space<device>> to memref<?x64xf32, #plan.memory_space<device>>
+//       CHECK:     %[[c1024:.+]] = arith.constant 1024 : index
+//       CHECK:     %[[v1:.+]] = memref.view %[[ws]][%[[c1024]]][%[[arg0]]]
+//       CHECK:     memref.copy %[[v0]], %[[v1]]
+//  CHECK-NEXT:     memref.dealloc %[[ws]]
+//  CHECK-NEXT:     return
+
+// -----
+
+!device_memref = memref<?x64xf32, #plan.memory_space<device>>
+
+func.func @unbounded_dynamic_shapes(%arg0: index, %arg1: !device_memref) {
+  %0 = memref.alloc(%arg0) : !device_memref
+  memref.copy %arg1, %0 : !device_memref to !device_memref
+  %1 = memref.alloc(%arg0) : !device_memref
+  memref.copy %0, %1 : !device_memref to !device_memref
+  memref.dealloc %0 : !device_memref
+  memref.dealloc %1 : !device_memref
+  return
+}
+
+// CHECK-LABEL: func.func @unbounded_dynamic_shapes
+//   CHECK-NOT:     memref.view
+//       CHECK:     memref.alloc(%{{.+}}) : memref<?x64xf32, #plan.memory_space<device>>
+//       CHECK:     memref.alloc(%{{.+}}) : memref<?x64xf32, #plan.memory_space<device>>
+
+// -----
+
+!host_memref = memref<256xf32, #plan.memory_space<host>>
+
+func.func @parallel_region(%arg0: !host_memref, %arg1: !host_memref) {
+  scf.forall (%i) in (4) {
+    %0 = memref.alloc() : !host_memref
+    memref.copy %arg0, %0 : !host_memref to !host_memref
+    memref.dealloc %0 : !host_memref
+    %1 = memref.alloc() : !host_memref
+    memref.copy %arg1, %1 : !host_memref to !host_memref
+    memref.dealloc %1 : !host_memref
+  }
+  return
+}
+
+// CHECK-LABEL: func.func @parallel_region
+//   CHECK-NOT:     memref.view
+
+// -----
+
+!pinned_memref = memref<256xf32, #plan.memory_space<host_pinned>>
+
+func.func @host_pinned_not_planned(%arg0: !pinned_memref, %arg1: !pinned_memref) {
+  %0 = memref.alloc() : !pinned_memref
+  memref.copy %arg0, %0 : !pinned_memref to !pinned_memref
+  %1 = memref.alloc() : !pinned_memref
+  memref.copy %0, %1 : !pinned_memref to !pinned_memref
+  memref.dealloc %0 : !pinned_memref
+  memref.copy %1, %arg1 : !pinned_memref to !pinned_memref
+  memref.dealloc %1 : !pinned_memref
+  return
+}
+
+// CHECK-LABEL: func.func @host_pinned_not_planned
+//   CHECK-NOT:     memref.view
+//       CHECK:     %[[v0:.+]] = memref.alloc() : memref<256xf32, #plan.memory_space<host_pinned>>
+//       CHECK:     %[[v1:.+]] = memref.alloc() : memref<256xf32, #plan.memory_space<host_pinned>>
+//       CHECK:     memref.dealloc %[[v0]]
+//       CHECK:     memref.dealloc %[[v1]]
+//   CHECK-NOT:     memref.view
@@ -0,0 +1,31 @@
+// RUN: mlir-tensorrt-opt %s -split-input-file -plan-alloc-tensors -verify-diagnostics
+
+// expected-error @below {{Failed to convert non-private functions to DPS}}
+module {
+  // expected-error @below {{argument #0 of type 'tensor<10xf32>' is donated to result #0 of type 'tensor<20xf32>', but donated arguments must be ranked tensors with the same type as the result}}
+  func.func @donated_type_mismatch(%arg0: tensor<10xf32> {plan.aliasing_output = 0 : i64}) -> tensor<20xf32> {
+    %0 = tensor.empty() : tensor<20xf32>
+    return %0 : tensor<20xf32>
+  }
+}
+
+// -----
+
+// expected-error @below {{Failed to convert non-private functions to DPS}}
+module {
+  // expected-error @below {{result #0 has more than one donated argument}}
+  func.func @donated_twice(%arg0: tensor<10xf32> {plan.aliasing_output = 0 : i64},
+                           %arg1: tensor<10xf32> {plan.aliasing_output = 0 : i64}) -> tensor<10xf32> {
+    return %arg0 : tensor<10xf32>
+  }
+}
+
+// -----
+
+// expected-error @below {{Failed to convert non-private functions to DPS}}
+module {
+  // expected-error @below {{argument #0 has an invalid 'plan.aliasing_output' attribute; expected the index of a function result}}
+  func.func @donated_out_of_range(%arg0: tensor<10xf32> {plan.aliasing_output = 1 : i64}) -> tensor<10xf32> {
+    return %arg0 : tensor<10xf32>
+  }
+}
@@ -53,6 +53,29 @@ func.func @test_simple_dps(%arg0: tensor<10xf32>) -> tensor<10xf32> {
 
 // -----
 
+#map = affine_map<(d0)->(d0)>
+func.func @test_host_alloc_dps(%arg0: tensor<10xf32>) -> tensor<10xf32> {
+  %empty = bufferization.alloc_tensor() {memory_space = #plan.memory_space<host_pinned>} : tensor<10xf32>
+  %0 = linalg.generic {
+    iterator_types = ["parallel"],
+    indexing_maps = [#map, #map]
+  } ins(%arg0: tensor<10xf32>) outs(%empty: tensor<10xf32>) {
+    ^bb0(%a: f32, %b: f32):
+      %r = arith.negf %a : f32
+      linalg.yield %r : f32
+  } -> tensor<10xf32>
+  return %0 : tensor<10xf32>
+}
+
+// CHECK-LABEL: @test_host_alloc_dps
+//  CHECK-SAME: (%[[arg0:.+]]: tensor<10xf32>, %[[arg1:.+]]: tensor<10xf32> {plan.result_arg}) -> tensor<10xf32>
+//       CHECK: %[[v0:.+]] = bufferization.alloc_tensor() {memory_space = #plan.memory_space<host_pinned>} : tensor<10xf32>
+//       CHECK: %[[v1:.+]] = linalg.generic {{.*}} ins(%[[arg0]] : tensor<10xf32>) outs(%[[v0]] : tensor<10xf32>)
+//       CHECK: %[[v2:.+]] = bufferization.materialize_in_destination %[[v1]] in %[[arg1]]
+//       CHECK: return %[[v2]] : tensor<10xf32>
+
+// -----
+
 #map = affine_map<(d0)->(d0)>
 func.func @test_two_returns(%arg0: tensor<10xf32>, %arg1: tensor<10xf32>) -> (tensor<10xf32>, tensor<10xf32>) {
   %empty = tensor.empty () : tensor<10xf32>
@@ -76,6 +99,29 @@ func.func @test_two_returns(%arg0: tensor<10xf32>, %arg1: tensor<10xf32>) -> (te
 
 // -----
 
+#map = affine_map<(d0)->(d0)>
+func.func @test_donated_arg(%arg0: tensor<10xf32>, %arg1: tensor<10xf32> {plan.aliasing_output = 1 : i64}) -> (tensor<10xf32>, tensor<10xf32>) {
+  %empty = tensor.empty () : tensor<10xf32>
+  %0, %1 = linalg.generic {
+    iterator_types = ["parallel"],
+    indexing_maps = [#map, #map, #map, #map]
+  } ins(%arg0, %arg1: tensor<10xf32>, tensor<10xf32>) outs(%empty, %empty: tensor<10xf32>, tensor<10xf32>) {
+    ^bb0(%a: f32, %b: f32, %c: f32, %d: f32):
+      %r1 = arith.negf %a : f32
+      %r2 = arith.negf %b : f32
+      linalg.yield %r1, %r2 : f32, f32
+  } -> (tensor<10xf32>, tensor<10xf32>)
+  return %0, %1 : tensor<10xf32>, tensor<10xf32>
+}
+
+// CHECK-LABEL: @test_donated_arg
+//  CHECK-SAME: (%[[arg0:.+]]: tensor<10xf32>, %[[arg1:.+]]: tensor<10xf32> {plan.aliasing_output_arg = 1 : i64}, %[[arg2:.+]]: tensor<10xf32> {plan.result_arg}, %[[arg3:.+]]: tensor<10xf32> {plan.result_arg})
+//   CHECK-NOT: bufferization.alloc_tensor()
+//       CHECK: %[[v0:.+]]:2 = linalg.generic {{.*}} ins(%[[arg0]], %[[arg1]] : {{.*}}) outs(%[[arg2]], %[[arg1]] : {{.*}})
+//       CHECK: return %[[v0]]#0, %[[v0]]#1 : tensor<10xf32>, tensor<10xf32>
+
+// -----
+
 #map = affine_map<(d0)->(d0)>
 module @test_no_dps_return {
   func.func @main(%arg0: tensor<10xf32>, %arg1: tensor<10xf32>) -> tensor<10xf32> {
@@ -4,27 +4,35 @@
 //
 //===----------------------------------------------------------------------===//
 ///
-/// Tests that benchmark the clustering transform.
+/// Tests that benchmark the clustering transform. The `clustering_test`
+/// benchmark runs the StableHLO clustering pipeline on the `--source` file, if
+/// given. The `generated_graph_*` benchmarks run the generic clustering on
+/// randomly generated graphs of increasing size to track scaling.
 ///
 //===----------------------------------------------------------------------===//
 #include "benchmark/benchmark.h"
+#include "mlir-executor/Transforms/Clustering/Clustering.h"
 #include "mlir-tensorrt/Dialect/Plan/Transforms/Passes.h"
 #include "mlir-tensorrt/Registration/RegisterMlirTensorRtDialects.h"
 #include "mlir-tensorrt/Registration/RegisterMlirTensorRtPasses.h"
 #include "mlir-tensorrt/Transforms/Passes.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
 #include "mlir/IR/DialectRegistry.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/Parser/Parser.h"
 #include "mlir/Pass/PassManager.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <random>
 
 using namespace mlir;
 using namespace mlir::plan;
 namespace cl = llvm::cl;
 
 static cl::opt<std::string> inputSourceFile("source", cl::desc("Source file"),
-                                            cl::Required);
+                                            cl::init(""));
 
 auto BM_test = [](benchmark::State &state, MLIRContext *ctx) {
   mlir::PassManager pm(ctx);
@@ -48,14 +56,110 @@ auto BM_test = [](benchmark::State &state, MLIRContext *ctx) {
   }
 };
 
+/// Build a function with a random DAG of `numOps` elementwise ops. Each op uses
+/// one or two of the previous 16 values. `arith.addf` ops are clusterable and
+/// the `arith.mulf` ops in between break the graph into many small clusters
+/// with paths between them, which is the worst case for merging independent
+/// clusters.
+static OwningOpRef<ModuleOp> buildGeneratedGraph(MLIRContext *ctx,
+                                                 int64_t numOps) {
+  ctx->loadDialect<arith::ArithDialect, func::FuncDialect>();
+  OpBuilder b(ctx);
+  Location loc = b.getUnknownLoc();
+  OwningOpRef<ModuleOp> module = ModuleOp::create(loc);
+  b.setInsertionPointToEnd(module->getBody());
+  auto type = RankedTensorType::get({16}, b.getF32Type());
+  auto func = b.create<func::FuncOp>(
+      loc, "main", b.getFunctionType({type}, {type, type}));
+  b.setInsertionPointToEnd(func.addEntryBlock());
+
+  std::mt19937 rng(0);
+  SmallVector<Value> values{func.getArgument(0)};
+  for (int64_t i = 0; i < numOps; ++i) {
+    std::uniform_int_distribution<size_t> dist(
+        values.size() > 16 ? values.size() - 16 : 0, values.size() - 1);
+    Value lhs = values[dist(rng)];
+    Value rhs = rng() % 2 ? values[dist(rng)] : lhs;
+    if (rng() % 4 == 0)
+      values.push_back(b.create<arith::MulFOp>(loc, lhs, rhs).getResult());
+    else
+      values.push_back(b.create<arith::AddFOp>(loc, lhs, rhs).getResult());
+  }
+  b.create<func::ReturnOp>(
+      loc, ValueRange{values.back(), values[values.size() / 2]});
+  return module;
+}
+
+static ClusteringOpts getGeneratedGraphClusteringOpts() {
+  ClusteringOpts opts;
+  opts.isClusterableOp = [](Operation *op) { return isa<arith::AddFOp>(op); };
+  // Only grow clusters along single-use edges so that many independent
+  // clusters are left for merging.
+  opts.shouldGrowClusterFn = [](Operation *producer, ClusterRange,
+                                Operation *, ClusterRange) {
+    return producer->hasOneUse();
+  };
+  return opts;
+}
+
+/// Benchmark `analyzeAndClusterOperations` on a generated graph.
+static void BM_generatedGraphClustering(benchmark::State &state,
+                                        MLIRContext *ctx) {
+  OwningOpRef<ModuleOp> module = buildGeneratedGraph(ctx, state.range(0));
+  func::FuncOp func = *module->getOps<func::FuncOp>().begin();
+  ClusteringOpts opts = getGeneratedGraphClusteringOpts();
+  for (auto _ : state) {
+    FailureOr<SmallVector<Cluster>> clusters =
+        analyzeAndClusterOperations(func, opts);
+    if (failed(clusters))
+      llvm_unreachable("failed to cluster operations");
+    benchmark::DoNotOptimize(clusters->size());
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+/// Benchmark only `mergeIndependentClusters` on a generated graph.
+static void BM_generatedGraphMergeIndependentClusters(benchmark::State &state,
+                                                      MLIRContext *ctx) {
+  OwningOpRef<ModuleOp> module = buildGeneratedGraph(ctx, state.range(0));
+  func::FuncOp func = *module->getOps<func::FuncOp>().begin();
+  ClusteringOpts opts = getGeneratedGraphClusteringOpts();
+  int64_t numClusters = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    ClusteringState clusteringState(func, opts);
+    populateSizeOneClusters(clusteringState, func, opts.isClusterableOp);
+    runBFSClustering(clusteringState, opts.shouldGrowClusterFn);
+    numClusters = clusteringState.getClusterRoots().size();
+    state.ResumeTiming();
+    mergeIndependentClusters(clusteringState, opts.mergeIndependentClusters);
+  }
+  state.counters["input_clusters"] = numClusters;
+  state.SetComplexityN(state.range(0));
+}
+
 int main(int argc, char *argv[]) {
   DialectRegistry registry;
   registerAllMlirTensorRtDialects(registry);
   tensorrt::registerAllMlirTensorRtPasses();
   MLIRContext context(registry);
-  benchmark::RegisterBenchmark("clustering_test", BM_test, &context);
   benchmark::Initialize(&argc, argv);
   llvm::cl::ParseCommandLineOptions(argc, argv);
+  if (!inputSourceFile.empty())
+    benchmark::RegisterBenchmark("clustering_test", BM_test, &context);
+  benchmark::RegisterBenchmark("generated_graph_clustering",
+                               BM_generatedGraphClustering, &context)
+      ->RangeMultiplier(4)
+      ->Range(1 << 10, 1 << 16)
+      ->Unit(benchmark::kMillisecond)
+      ->Complexity();
+  benchmark::RegisterBenchmark("generated_graph_merge_independent_clusters",
+                               BM_generatedGraphMergeIndependentClusters,
+                               &context)
+      ->RangeMultiplier(4)
+      ->Range(1 << 10, 1 << 16)
+      ->Unit(benchmark::kMillisecond)
+      ->Complexity();
   benchmark::RunSpecifiedBenchmarks();
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+# RUN: %PYTHON %s | FileCheck %s
+import mlir_tensorrt.compiler.api as compiler
+import mlir_tensorrt.compiler.ir as ir
+import mlir_tensorrt.runtime.api as runtime
+import numpy as np
+
+ASM = """
+func.func @main(%arg0: tensor<2x3x4xf32>) -> tensor<2x3x4xf32> {
+  %1 = stablehlo.add %arg0, %arg0 : (tensor<2x3x4xf32>, tensor<2x3x4xf32>) -> tensor<2x3x4xf32>
+  func.return %1 : tensor<2x3x4xf32>
+}
+"""
+
+
+def async_execution():
+    with ir.Context() as context:
+        m = ir.Module.parse(ASM)
+        client = compiler.CompilerClient(context)
+        opts = compiler.StableHLOToExecutableOptions(
+            client,
+            ["--tensorrt-builder-opt-level=3", "--tensorrt-strongly-typed=false"],
+        )
+        exe = compiler.compiler_stablehlo_to_executable(client, m.operation, opts)
+
+    client = runtime.RuntimeClient()
+    devices = client.get_devices()
+
+    if len(devices) == 0:
+        return
+
+    # Use one session and stream per in-flight request so that their device
+    # work can overlap.
+    num_requests = 4
+    session_options = runtime.RuntimeSessionOptions(num_devices=1, device_id=0)
+    sessions = [
+        runtime.RuntimeSession(session_options, exe) for _ in range(num_requests)
+    ]
+    streams = [client.create_stream() for _ in range(num_requests)]
+
+    inputs = [
+        client.create_memref(
+            np.full((2, 3, 4), i, dtype=np.float32).data,
+            device=devices[0],
+            stream=streams[i],
+        )
+        for i in range(num_requests)
+    ]
+    outputs = [
+        client.create_memref(
+            np.zeros(shape=(2, 3, 4), dtype=np.float32).data,
+            device=devices[0],
+            stream=streams[i],
+        )
+        for i in range(num_requests)
+    ]
+
+    executions = [
+        sessions[i].execute_function_async(
+            "main", in_args=[inputs[i]], out_args=[outputs[i]], stream=streams[i]
+        )
+        for i in range(num_requests)
+    ]
+
+    # Drive all requests from this thread.
+    pending = list(executions)
+    while pending:
+        pending = [e for e in pending if not e.poll()]
+
+    for i in range(num_requests):
+        data = np.asarray(client.copy_to_host(outputs[i], stream=streams[i]))
+        streams[i].sync()
+        print(data[0, 0, 0])
+
+    # Errors are reported when the execution is started.
+    try:
+        sessions[0].execute_function_async(
+            "main", in_args=[], out_args=[outputs[0]], stream=streams[0]
+        )
+    except Exception as e:
+        print("Exception caught: ", e)
+
+    # Waiting on a finished execution returns immediately.
+    executions[0].wait()
+
+
+if __name__ == "__main__":
+    async_execution()
+
+# CHECK: 0.0
+# CHECK-NEXT: 2.0
+# CHECK-NEXT: 4.0
+# CHECK-NEXT: 6.0
+# CHECK: Exception caught: {{.*}}
@@ -0,0 +1,89 @@
+# RUN: %PYTHON %s | FileCheck %s
+import mlir_tensorrt.compiler.api as compiler
+import mlir_tensorrt.compiler.ir as ir
+import mlir_tensorrt.runtime.api as runtime
+import numpy as np
+
+ASM = """
+func.func @main(%arg0: tensor<2x3x4xf32>) -> tensor<2x3x4xf32> {
+  %1 = stablehlo.add %arg0, %arg0 : (tensor<2x3x4xf32>, tensor<2x3x4xf32>) -> tensor<2x3x4xf32>
+  func.return %1 : tensor<2x3x4xf32>
+}
+"""
+
+
+def bound_function():
+    with ir.Context() as context:
+        m = ir.Module.parse(ASM)
+        client = compiler.CompilerClient(context)
+        opts = compiler.StableHLOToExecutableOptions(
+            client,
+            ["--tensorrt-builder-opt-level=3", "--tensorrt-strongly-typed=false"],
+        )
+        exe = compiler.compiler_stablehlo_to_executable(client, m.operation, opts)
+
+    client = runtime.RuntimeClient()
+    stream = client.create_stream()
+    devices = client.get_devices()
+
+    if len(devices) == 0:
+        return
+
+    session_options = runtime.RuntimeSessionOptions(num_devices=1, device_id=0)
+    session = runtime.RuntimeSession(session_options, exe)
+
+    try:
+        session.bind_function("does_not_exist")
+    except Exception as e:
+        print("Exception caught: ", e)
+
+    main = session.bind_function("main")
+
+    arg0 = client.create_memref(
+        np.arange(0.0, 24.0, dtype=np.float32).reshape(2, 3, 4).data,
+        device=devices[0],
+        stream=stream,
+    )
+    arg1 = client.create_memref(
+        np.zeros(shape=(2, 3, 4), dtype=np.float32).data,
+        device=devices[0],
+        stream=stream,
+    )
+    arg2 = client.create_memref(
+        np.zeros(shape=(2, 3, 4), dtype=np.float32).data,
+        device=devices[0],
+        stream=stream,
+    )
+
+    # Execute with different buffers to check that pointers are updated
+    # between calls.
+    main.execute(in_args=[arg0], out_args=[arg1], stream=stream)
+    main.execute(in_args=[arg1], out_args=[arg2], stream=stream)
+    data = np.asarray(client.copy_to_host(arg2, stream=stream))
+    stream.sync()
+    print(data)
+
+    # Mismatched shapes are rejected.
+    bad_arg = client.create_memref(
+        np.zeros(shape=(4, 3, 2), dtype=np.float32).data,
+        device=devices[0],
+        stream=stream,
+    )
+    try:
+        main.execute(in_args=[bad_arg], out_args=[arg1], stream=stream)
+    except Exception as e:
+        print("Exception caught: ", e)
+
+
+if __name__ == "__main__":
+    bound_function()
+
+#      CHECK: Exception caught: {{.*}}no public function named "does_not_exist" found
+#      CHECK:   [ 0.  4.  8. 12.]
+# CHECK-NEXT:   [16. 20. 24. 28.]
+# CHECK-NEXT:   [32. 36. 40. 44.]]
+# CHECK-NEXT:
+# CHECK-NEXT:   [48. 52. 56. 60.]
+# CHECK-NEXT:   [64. 68. 72. 76.]
+# CHECK-NEXT:   [80. 84. 88. 92.]]]
+#      CHECK: Exception caught: {{.*}}Runtime shape mismatch for argument #1
@@ -0,0 +1,152 @@
+# RUN: %PYTHON %s --iterations 20 | FileCheck %s
+"""
+Measures the throughput of `execute_function` when requests are issued from
+several Python threads, each with its own session and stream. The runtime
+releases the GIL while it executes, so the throughput should scale with the
+number of threads until the device is saturated. Run with a larger
+`--iterations` to use this as a benchmark.
+"""
+import argparse
+import threading
+import time
+
+import mlir_tensorrt.compiler.api as compiler
+import mlir_tensorrt.compiler.ir as ir
+import mlir_tensorrt.runtime.api as runtime
+import numpy as np
+
+ASM = """
+func.func @main(%arg0: tensor<256x256xf32>) -> tensor<256x256xf32> {
+  %0 = stablehlo.dot_general %arg0, %arg0, contracting_dims = [1] x [0] : (tensor<256x256xf32>, tensor<256x256xf32>) -> tensor<256x256xf32>
+  %1 = stablehlo.add %0, %arg0 : tensor<256x256xf32>
+  func.return %1 : tensor<256x256xf32>
+}
+"""
+
+
+def compile_executable():
+    with ir.Context() as context:
+        m = ir.Module.parse(ASM)
+        client = compiler.CompilerClient(context)
+        opts = compiler.StableHLOToExecutableOptions(
+            client,
+            ["--tensorrt-builder-opt-level=0", "--tensorrt-strongly-typed=false"],
+        )
+        return compiler.compiler_stablehlo_to_executable(client, m.operation, opts)
+
+
+def run_worker(client, device, exe, iterations, barrier):
+    session = runtime.RuntimeSession(runtime.RuntimeSessionOptions(), exe)
+    stream = client.create_stream()
+    data = np.ones((256, 256), dtype=np.float32)
+    arg = client.create_memref(data, device=device, stream=stream)
+    result = client.create_memref(data, device=device, stream=stream)
+    host_result = client.create_memref(np.zeros_like(data))
+    stream.sync()
+
+    barrier.wait()
+    for _ in range(iterations):
+        session.execute_function(
+            "main", in_args=[arg], out_args=[result], stream=stream
+        )
+        client.copy_to_host(result, host_result, stream=stream)
+        stream.sync()
+
+
+def measure(client, device, exe, num_threads, iterations):
+    # Workers set up their sessions before the clock starts.
+    barrier = threading.Barrier(num_threads + 1)
+    threads = [
+        threading.Thread(
+            target=run_worker, args=(client, device, exe, iterations, barrier)
+        )
+        for _ in range(num_threads)
+    ]
+    for thread in threads:
+        thread.start()
+    barrier.wait()
+    start = time.perf_counter()
+    for thread in threads:
+        thread.join()
+    elapsed = time.perf_counter() - start
+    return num_threads * iterations / elapsed
+
+
+def run_shared_session_worker(client, device, session, iterations, errors):
+    try:
+        check_shared_session_worker(client, device, session, iterations)
+    except Exception as e:
+        errors.append(e)
+
+
+def check_shared_session_worker(client, device, session, iterations):
+    stream = client.create_stream()
+    data = np.ones((256, 256), dtype=np.float32)
+    arg = client.create_memref(data, device=device, stream=stream)
+    result = client.create_memref(data, device=device, stream=stream)
+    for _ in range(iterations):
+        session.bind_function("main").execute(
+            in_args=[arg], out_args=[result], stream=stream
+        )
+        session.execute_function(
+            "main", in_args=[arg], out_args=[result], stream=stream
+        )
+        session.get_profile()
+        session.reset_profile()
+    host_result = np.asarray(client.copy_to_host(result, stream=stream))
+    stream.sync()
+    assert np.all(host_result == 257.0)
+
+
+def check_shared_session(client, device, exe, iterations):
+    """Every session entry point is serialized when threads share a session."""
+    session = runtime.RuntimeSession(
+        runtime.RuntimeSessionOptions(enable_profiling=True), exe
+    )
+    errors = []
+    threads = [
+        threading.Thread(
+            target=run_shared_session_worker,
+            args=(client, device, session, iterations, errors),
+        )
+        for _ in range(4)
+    ]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    print("shared session:", "ok" if not errors else errors)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--iterations", type=int, default=1000)
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4, 8])
+    args = parser.parse_args()
+
+    exe = compile_executable()
+    client = runtime.RuntimeClient()
+    devices = client.get_devices()
+    if len(devices) == 0:
+        return
+
+    baseline = None
+    for num_threads in args.threads:
+        throughput = measure(client, devices[0], exe, num_threads, args.iterations)
+        baseline = baseline or throughput
+        print(
+            f"threads: {num_threads} requests/s: {throughput:.1f} "
+            f"speedup: {throughput / baseline:.2f}"
+        )
+
+    check_shared_session(client, devices[0], exe, args.iterations)
+
+
+if __name__ == "__main__":
+    main()
+
+# CHECK: threads: 1 requests/s: {{.*}} speedup: 1.00
+# CHECK-NEXT: threads: 2 requests/s: {{.*}} speedup:
+# CHECK-NEXT: threads: 4 requests/s: {{.*}} speedup:
+# CHECK-NEXT: threads: 8 requests/s: {{.*}} speedup:
+# CHECK-NEXT: shared session: ok
@@ -0,0 +1,76 @@
+# RUN: %PYTHON %s | FileCheck %s
+import mlir_tensorrt.compiler.api as compiler
+import mlir_tensorrt.compiler.ir as ir
+import mlir_tensorrt.runtime.api as runtime
+import numpy as np
+
+ASM = """
+func.func @main(%arg0: tensor<2x3x4xf32> {plan.aliasing_output = 0 : i64}) -> tensor<2x3x4xf32> {
+  %1 = stablehlo.add %arg0, %arg0 : (tensor<2x3x4xf32>, tensor<2x3x4xf32>) -> tensor<2x3x4xf32>
+  func.return %1 : tensor<2x3x4xf32>
+}
+"""
+
+
+def output_aliases():
+    with ir.Context() as context:
+        m = ir.Module.parse(ASM)
+        client = compiler.CompilerClient(context)
+        opts = compiler.StableHLOToExecutableOptions(
+            client,
+            ["--tensorrt-builder-opt-level=3", "--tensorrt-strongly-typed=false"],
+        )
+        exe = compiler.compiler_stablehlo_to_executable(client, m.operation, opts)
+
+    sig = exe.get_signature("main")
+    print("output alias: ", sig.get_output_alias(0))
+    try:
+        sig.get_output_alias(1)
+    except Exception as e:
+        print("Exception caught: ", e)
+
+    client = runtime.RuntimeClient()
+    stream = client.create_stream()
+    devices = client.get_devices()
+
+    if len(devices) == 0:
+        return
+
+    session_options = runtime.RuntimeSessionOptions(num_devices=1, device_id=0)
+    session = runtime.RuntimeSession(session_options, exe)
+
+    arg0 = client.create_memref(
+        np.arange(0.0, 24.0, dtype=np.float32).reshape(2, 3, 4).data,
+        device=devices[0],
+        stream=stream,
+    )
+    arg1 = client.create_memref(
+        np.zeros(shape=(2, 3, 4), dtype=np.float32).data,
+        device=devices[0],
+        stream=stream,
+    )
+
+    # The output must be passed the buffer of the donated input.
+    try:
+        session.execute_function(
+            "main", in_args=[arg0], out_args=[arg1], stream=stream
+        )
+    except Exception as e:
+        print("Exception caught: ", e)
+
+    # The donated input is updated in place.
+    session.execute_function("main", in_args=[arg0], out_args=[arg0], stream=stream)
+    data = np.asarray(client.copy_to_host(arg0, stream=stream))
+    stream.sync()
+    print(data)
+
+
+if __name__ == "__main__":
+    output_aliases()
+
+#      CHECK: output alias:  0
+#      CHECK: Exception caught: {{.*}}output argument index is out of range
+#      CHECK: Exception caught: {{.*}}output argument 0 is aliased to donated input argument 0 and must be passed the same buffer as that input
+#      CHECK:   [ 0.  2.  4.  6.]
+# CHECK-NEXT:   [ 8. 10. 12. 14.]
+# CHECK-NEXT:   [16. 18. 20. 22.]]
@@ -0,0 +1,103 @@
+# RUN: %PYTHON %s | FileCheck %s
+import asyncio
+
+import mlir_tensorrt.compiler.api as compiler
+import mlir_tensorrt.compiler.ir as ir
+import mlir_tensorrt.runtime.api as runtime
+import numpy as np
+
+ASM = """
+func.func @main(%arg0: tensor<2x3x4xf32>) -> tensor<2x3x4xf32> {
+  %1 = stablehlo.add %arg0, %arg0 : (tensor<2x3x4xf32>, tensor<2x3x4xf32>) -> tensor<2x3x4xf32>
+  func.return %1 : tensor<2x3x4xf32>
+}
+"""
+
+
+def compile_executable():
+    with ir.Context() as context:
+        m = ir.Module.parse(ASM)
+        client = compiler.CompilerClient(context)
+        opts = compiler.StableHLOToExecutableOptions(
+            client,
+            ["--tensorrt-builder-opt-level=0", "--tensorrt-strongly-typed=false"],
+        )
+        return compiler.compiler_stablehlo_to_executable(client, m.operation, opts)
+
+
+async def serve_request(client, device, exe, value):
+    session = runtime.RuntimeSession(runtime.RuntimeSessionOptions(), exe)
+    stream = client.create_stream()
+    host_input = client.create_memref(np.full((2, 3, 4), value, dtype=np.float32))
+    device_input = await client.copy_to_device_async(
+        host_input, device, stream=stream
+    )
+    device_output = client.create_memref(
+        np.zeros((2, 3, 4), dtype=np.float32), device=device, stream=stream
+    )
+    await session.execute_function_async(
+        "main", in_args=[device_input], out_args=[device_output], stream=stream
+    )
+    host_output = await client.copy_to_host_async(device_output, stream=stream)
+    stream.sync()
+    return np.asarray(host_output)[0, 0, 0]
+
+
+async def serve(client, device, exe):
+    results = await asyncio.gather(
+        *[serve_request(client, device, exe, i) for i in range(4)]
+    )
+    for result in results:
+        print(result)
+
+
+def test_futures():
+    exe = compile_executable()
+    client = runtime.RuntimeClient()
+    devices = client.get_devices()
+    if len(devices) == 0:
+        return
+
+    asyncio.run(serve(client, devices[0], exe))
+
+    # Futures can also be used without an event loop.
+    stream = client.create_stream()
+    device_memref = client.create_memref(
+        np.ones((2, 2), dtype=np.float32), device=devices[0], stream=stream
+    )
+    host_memref = client.create_memref(np.zeros((2, 2), dtype=np.float32))
+    future = client.copy_to_host_async(device_memref, host_memref, stream=stream)
+    print(future.result())
+    print(future.done())
+    stream.sync()
+    print(np.asarray(host_memref).sum())
+
+    # Concurrent host-to-device copies share the client's pinned staging
+    # memory. One of them is larger than a staging chunk.
+    streams = [client.create_stream() for _ in range(2)]
+    host_memrefs = [
+        client.create_memref(np.full((1 << 20,), 1.0, dtype=np.float32)),
+        client.create_memref(np.full((1 << 22,), 2.0, dtype=np.float32)),
+    ]
+    futures = [
+        client.copy_to_device_async(host, devices[0], stream=s)
+        for host, s in zip(host_memrefs, streams)
+    ]
+    for future, s in zip(futures, streams):
+        host_copy = client.copy_to_host(future.result(), stream=s)
+        s.sync()
+        print(np.asarray(host_copy).sum())
+
+
+if __name__ == "__main__":
+    test_futures()
+
+# CHECK: 0.0
+# CHECK-NEXT: 2.0
+# CHECK-NEXT: 4.0
+# CHECK-NEXT: 6.0
+# CHECK-NEXT: None
+# CHECK-NEXT: True
+# CHECK-NEXT: 4.0
+# CHECK-NEXT: 1048576.0
+# CHECK-NEXT: 8388608.0
@@ -0,0 +1,89 @@
+# RUN: %PYTHON %s | FileCheck %s
+import json
+
+import mlir_tensorrt.compiler.api as compiler
+import mlir_tensorrt.compiler.ir as ir
+import mlir_tensorrt.runtime.api as runtime
+import numpy as np
+
+ASM = """
+func.func @main(%arg0: tensor<2x3x4xf32>) -> tensor<2x3x4xf32> {
+  %1 = stablehlo.add %arg0, %arg0 : (tensor<2x3x4xf32>, tensor<2x3x4xf32>) -> tensor<2x3x4xf32>
+  func.return %1 : tensor<2x3x4xf32>
+}
+"""
+
+
+def compile_executable():
+    with ir.Context() as context:
+        m = ir.Module.parse(ASM)
+        client = compiler.CompilerClient(context)
+        opts = compiler.StableHLOToExecutableOptions(
+            client,
+            ["--tensorrt-builder-opt-level=0", "--tensorrt-strongly-typed=false"],
+        )
+        return compiler.compiler_stablehlo_to_executable(client, m.operation, opts)
+
+
+def test_profiler():
+    exe = compile_executable()
+    client = runtime.RuntimeClient()
+    devices = client.get_devices()
+    if len(devices) == 0:
+        return
+
+    session = runtime.RuntimeSession(
+        runtime.RuntimeSessionOptions(enable_profiling=True), exe
+    )
+    stream = client.create_stream()
+    data = np.ones((2, 3, 4), dtype=np.float32)
+    arg = client.create_memref(data, device=devices[0], stream=stream)
+    result = client.create_memref(
+        np.zeros_like(data), device=devices[0], stream=stream
+    )
+    for _ in range(3):
+        session.execute_function(
+            "main", in_args=[arg], out_args=[result], stream=stream
+        )
+    stream.sync()
+
+    summary = session.get_profile()
+    print(summary.splitlines()[0].split()[:3])
+    main_row = next(l for l in summary.splitlines() if l.startswith("main "))
+    print("main calls:", main_row.split()[1])
+
+    trace = json.loads(session.get_profile("chrome_trace"))
+    functions = [e for e in trace["traceEvents"] if e["cat"] == "function"]
+    builtins = [e for e in trace["traceEvents"] if e["cat"] == "builtin"]
+    print("function events:", len(functions))
+    print("enqueues:", sum(e["name"] == "trtrt_enqueue" for e in builtins))
+    print("dropped:", trace["otherData"]["droppedEvents"])
+
+    session.reset_profile()
+    trace = json.loads(session.get_profile("chrome_trace"))
+    print("after reset:", len(trace["traceEvents"]))
+
+    try:
+        session.get_profile("csv")
+    except ValueError as e:
+        print("error:", e)
+
+    # Sessions do not profile by default.
+    other = runtime.RuntimeSession(runtime.RuntimeSessionOptions(), exe)
+    try:
+        other.get_profile()
+    except runtime.MTRTException as e:
+        print("error:", "profiling is not enabled" in str(e))
+
+
+if __name__ == "__main__":
+    test_profiler()
+
+# CHECK: ['function', '/', 'builtin']
+# CHECK-NEXT: main calls: 3
+# CHECK-NEXT: function events: 3
+# CHECK-NEXT: enqueues: 3
+# CHECK-NEXT: dropped: 0
+# CHECK-NEXT: after reset: 0
+# CHECK-NEXT: error: expected the profile format to be "summary" or "chrome_trace"
+# CHECK-NEXT: error: True
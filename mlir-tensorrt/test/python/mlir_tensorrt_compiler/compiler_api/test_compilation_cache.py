@@ -0,0 +1,60 @@
+# RUN: %PYTHON %s 2>&1 | FileCheck %s
+# REQUIRES: host-has-at-least-1-gpus
+import os
+import tempfile
+
+import mlir_tensorrt.compiler.api as api
+from mlir_tensorrt.compiler.ir import *
+
+
+ASM = """
+func.func @main(%arg0: tensor<2x3x4xf32>) -> tensor<2x3x4xf32> {
+  %1 = stablehlo.add %arg0, %arg0 : (tensor<2x3x4xf32>, tensor<2x3x4xf32>) -> tensor<2x3x4xf32>
+  func.return %1 : tensor<2x3x4xf32>
+}
+"""
+
+
+def compile_twice(cache_dir):
+    with Context() as context:
+        client = api.CompilerClient(context)
+        client.enable_compilation_cache(cache_dir)
+        opts = api.StableHLOToExecutableOptions(
+            client,
+            ["--tensorrt-builder-opt-level=0", "--tensorrt-strongly-typed=false"],
+        )
+
+        serialized = []
+        for _ in range(2):
+            # The module is lowered in place on a miss, so parse it anew.
+            m = Module.parse(ASM)
+            exe = api.compiler_stablehlo_to_executable(client, m.operation, opts)
+            serialized.append(exe.serialize())
+
+        print(client.get_compilation_cache_statistics())
+        print("identical:", serialized[0] == serialized[1])
+        print("entries:", len(os.listdir(cache_dir)))
+
+
+def compile_in_new_client(cache_dir):
+    # A new client (e.g. after a restart) reuses the entry on disk.
+    with Context() as context:
+        client = api.CompilerClient(context)
+        client.enable_compilation_cache(cache_dir)
+        opts = api.StableHLOToExecutableOptions(
+            client,
+            ["--tensorrt-builder-opt-level=0", "--tensorrt-strongly-typed=false"],
+        )
+        m = Module.parse(ASM)
+        api.compiler_stablehlo_to_executable(client, m.operation, opts)
+        print(client.get_compilation_cache_statistics())
+
+
+with tempfile.TemporaryDirectory() as cache_dir:
+    compile_twice(cache_dir)
+    compile_in_new_client(cache_dir)
+
+# CHECK: {'hits': 1, 'misses': 1}
+# CHECK-NEXT: identical: True
+# CHECK-NEXT: entries: 1
+# CHECK-NEXT: {'hits': 1, 'misses': 0}